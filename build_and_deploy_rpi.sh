@@ -63,6 +63,12 @@ if [[ "${CLEAN_BUILD}" == "1" || "${cache_invalid}" == "1" ]]; then
   rm -rf "${BUILD_DIR}"
 fi
 
+HIP_CATALOG="${REPO_ROOT}/src/polemaster_simulation/hip_catalog.csv"
+if [[ ! -f "${HIP_CATALOG}" ]]; then
+  log "Downloading Hipparcos polar-cap catalog for pole_index.bin"
+  python3 "${REPO_ROOT}/tools/fetch_hip_catalog.py" --output "${HIP_CATALOG}"
+fi
+
 log "Configuring cross build"
 env QUARCS_QT_CLIENT_VERSION="${QUARCS_QT_CLIENT_VERSION}" \
 cmake -S "${REPO_ROOT}/src" -B "${BUILD_DIR}" \
@@ -7,6 +7,11 @@
 #include <QEventLoop>
 #include <QCoreApplication>
 #include <QPointer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QtConcurrent/QtConcurrentRun>
 #include <string>
 #include <limits>
 #include <cmath>
@@ -55,6 +60,15 @@ struct AutoFocusConfig {
     // 数据拟合参数
     double minRSquared = 0.1;                     // 最小拟合质量R²（进一步降低要求，确保使用拟合而不是插值）
     int minDataPoints = 5;                        // 最小数据点数量（降低要求）
+
+    // super-fine 自适应采样参数
+    double criticalFocusZoneSteps = 0.0;          // 临界焦区(步)，最佳位置置信区间窄于此值即停止；0 表示按 V 曲线宽度推算
+    int superFineMaxPoints = 9;                   // super-fine 最多采样点数（原固定网格点数）
+
+    // super-fine 多星 ROI 参数
+    bool useStarRoiFocus = true;                  // 第一帧选星后只读出各星小窗的外接子帧
+    int starRoiCount = 8;                         // 选用的星数 K
+    double starRoiMaxReadoutFraction = 0.25;      // 读出子帧最多占全幅面积的比例
     
     
     // 重试参数
@@ -147,6 +161,8 @@ AutoFocus::AutoFocus(MyClient *indiServer,
     , m_currentROI(0, 0, 0, 0)                    // 初始ROI区域
     , m_roiSize(g_autoFocusConfig.roiSize)         // ROI大小
     , m_roiCenter(0, 0)                            // ROI中心位置
+    , m_starRoiPlanTried(false)                    // 尚未尝试多星 ROI 选星
+    , m_starRoiSaturationAdu(58981.0)              // 16bit 满量程的 90%
     , m_waitingForMove(false)                      // 初始不等待电调移动
     , m_moveWaitStartTime(0)                       // 移动等待开始时间
     , m_moveWaitCount(0)                           // 移动等待计数
@@ -207,6 +223,8 @@ AutoFocus::AutoFocus(MyClient *indiServer,
     connect(m_captureCheckTimer, &QTimer::timeout, this, &AutoFocus::onCaptureCheckTimerTimeout);
     // 设置拍摄检查定时器间隔为100ms
     m_captureCheckTimer->setInterval(100);
+    // 后台 SNR 分析完成后在主线程记入结果
+    connect(&m_snrWatcher, &QFutureWatcherBase::finished, this, &AutoFocus::onSnrAnalysisFinished);
 }
 
 // ==================== 新增的优化方法实现 ====================
@@ -437,6 +455,15 @@ bool AutoFocus::initializeAutoFocusCommon()
     m_useROI = false;
     m_currentROI = QRect(0, 0, 0, 0);
     m_roiCenter = QPointF(0, 0);
+    m_starRoiPlan = focus::StarRoiPlan();
+    m_starRoiPlanTried = false;
+
+    // SNR 分析快照按轮次命名：上一轮残留或其他进程的快照不会被本轮覆盖/误读
+    m_snrRunTag = QString("%1_%2").arg(QCoreApplication::applicationPid()).arg(QDateTime::currentMSecsSinceEpoch());
+
+    // super-fine 模型只在本轮 super-fine 收敛后有效（上一轮被中断时可能残留）
+    m_superFineSampler.reset(focus::AdaptiveFocusSampler::Options());
+    m_superFineModelFit = focus::HyperbolaFit();
     
     // 初始化虚拟数据参数
     if (m_useVirtualData && !m_starSimulator) {
@@ -705,6 +732,9 @@ void AutoFocus::stopAutoFocus()
         
         // 重置拍摄检查状态
         m_captureCheckPending = false;
+
+        // 终止在途的 SNR 分析并等它退出，丢弃排队的点、删除快照
+        cancelSnrAnalysis();
         
         // 强制断开所有定时器连接，防止回调继续执行
         if (m_moveCheckTimer) {
@@ -795,6 +825,10 @@ void AutoFocus::stopAutoFocus()
         // m_currentLargeRangeShots 保持不变
         // m_currentLargeRangeStep 保持不变
         log("数据收集状态已重置（参数保留）");
+
+        // super-fine 模型与采样器属于本轮：不清掉的话下一轮拟合/收集阶段会拿到上一轮的顶点
+        m_superFineSampler.reset(focus::AdaptiveFocusSampler::Options());
+        m_superFineModelFit = focus::HyperbolaFit();
         
         // 切换到空闲状态
         changeState(AutoFocusState::IDLE);
@@ -1847,6 +1881,8 @@ void AutoFocus::finalizeCoarseFailure()
 void AutoFocus::startCoarseAdjustment()
 {
     emit focusSeriesReset(QStringLiteral("coarse"));
+    cancelSnrAnalysis();
+    m_focusTimeline.reset(QDateTime::currentMSecsSinceEpoch());
 
     changeState(AutoFocusState::COARSE_ADJUSTMENT);
     // 原“粗调”阶段：UI 文案改为“找星”
@@ -1932,7 +1968,18 @@ void AutoFocus::performCoarseDataCollection()
         return;
     }
 
+    // 由 processCurrentState 等到位后调用：上一段移动到此结束
+    m_focusTimeline.moveDone(QDateTime::currentMSecsSinceEpoch());
+
     if (m_coarseScanIndex >= m_coarseScanPositions.size()) {
+        // 收尾前取回最后一个点的分析
+        if (!joinSnrAnalysis()) {
+            return;
+        }
+        if (m_focusTimeline.size() > 0) {
+            reportFocusTimeline(QStringLiteral("coarse"));
+        }
+
         // 所有粗调采样点已完成，先检查是否存在任何有效 SNR
         if (!m_coarseHasValidSNR) {
             if (!m_scheduleTriggered && !m_coarseRetryPromptRequested && !m_isCoarseRetryScan) {
@@ -1987,30 +2034,47 @@ void AutoFocus::performCoarseDataCollection()
     // 发送电调位置同步信号
     emit m_wsThread->sendMessageToClient("FocusPosition:" + QString::number(current) + ":" + QString::number(current));
     // 拍摄一张图像并等待完成
+    const int point = m_focusTimeline.addPoint(target, QDateTime::currentMSecsSinceEpoch());
     if (!captureFullImage()) { handleError("拍摄图像失败"); return; }
     if (!waitForCaptureComplete()) { handleError("拍摄超时"); return; }
+    m_focusTimeline.exposureDone(point, QDateTime::currentMSecsSinceEpoch());
+
+    // SNR 分析交给工作线程，不等结果直接移向下一个点；结果在下一次提交或收尾时记入
+    submitSnrAnalysis(false, m_coarseScanIndex, target, point);
+    if (!m_isRunning) {
+        return;
+    }
 
-    // 通过 Python 脚本计算 avg_top50_snr
-    double snr = 0.0;
-    bool ok = detectSNRByPython(snr);
+    // 下一个位置
+    ++m_coarseScanIndex;
+    if (m_coarseScanIndex < m_coarseScanPositions.size()) {
+        m_focusTimeline.moveStarted(point, QDateTime::currentMSecsSinceEpoch());
+        beginMoveTo(m_coarseScanPositions[m_coarseScanIndex], "粗调扫描下一个点");
+    } else {
+        // 让下一轮调用处理收尾
+        Logger::Log("粗调采样完成，准备移动至最佳位置并进入精调", LogLevel::INFO, DeviceType::FOCUSER);
+    }
+}
+
+void AutoFocus::applyCoarseSnrSample(int scanIndex, int target, bool ok, double snr)
+{
     if (!ok || !std::isfinite(snr) || snr <= 0.0) {
         Logger::Log("该位置未识到有效 SNR 或 Python SNR 脚本执行失败，使用占位值 0", LogLevel::INFO, DeviceType::FOCUSER);
         emit starDetectionResult(false, 0.0);
+        ok = false;
         snr = 0.0;
     } else {
         Logger::Log(QString("粗调位置检测到 mean_peak_snr: %1").arg(snr).toStdString(),
                     LogLevel::INFO, DeviceType::FOCUSER);
         emit starDetectionResult(true, snr);
         // 标记本轮粗调存在至少一个 SNR>0 的有效位置
-        if (snr > 0.0) {
-            m_coarseHasValidSNR = true;
-        }
+        m_coarseHasValidSNR = true;
     }
 
     // 发送 SNR 结果到前端
     if (m_wsThread) {
         QString msg = QString("AutoFocusSNR:coarse:%1:%2:%3")
-                          .arg(m_coarseScanIndex + 1)
+                          .arg(scanIndex + 1)
                           .arg(target)
                           .arg(snr, 0, 'f', 6);
         emit m_wsThread->sendMessageToClient(msg);
@@ -2018,7 +2082,7 @@ void AutoFocus::performCoarseDataCollection()
 
   // 粗调阶段拍摄进度：当前第几张 / 总张数
   emit captureProgressChanged(QStringLiteral("coarse"),
-                              m_coarseScanIndex + 1,
+                              scanIndex + 1,
                               m_coarseScanPositions.size());
 
     // 记录数据（此处 hfr 字段存放 SNR，仅用于日志与调试，不参与拟合）
@@ -2029,7 +2093,7 @@ void AutoFocus::performCoarseDataCollection()
     // emit focusDataPointReady(target, fwhm, QStringLiteral("coarse"));
 
     Logger::Log(QString("粗调数据点%1/%2：位置=%3，SNR=%4，当前最佳SNR=%5")
-        .arg(m_coarseScanIndex+1).arg(m_coarseScanPositions.size()).arg(target).arg(snr).arg(m_coarseBestSNR).toStdString(), 
+        .arg(scanIndex+1).arg(m_coarseScanPositions.size()).arg(target).arg(snr).arg(m_coarseBestSNR).toStdString(), 
         LogLevel::INFO, DeviceType::FOCUSER);
 
     // 更新最佳 SNR 位置（只在识到有效 SNR 时）
@@ -2037,15 +2101,6 @@ void AutoFocus::performCoarseDataCollection()
         m_coarseBestSNR = snr;
         m_coarseBestPosition = target;
     }
-
-    // 下一个位置
-    ++m_coarseScanIndex;
-    if (m_coarseScanIndex < m_coarseScanPositions.size()) {
-        beginMoveTo(m_coarseScanPositions[m_coarseScanIndex], "粗调扫描下一个点");
-    } else {
-        // 让下一轮调用处理收尾
-        Logger::Log("粗调采样完成，准备移动至最佳位置并进入精调", LogLevel::INFO, DeviceType::FOCUSER);
-    }
 }
 
 
@@ -2063,7 +2118,17 @@ void AutoFocus::performFineDataCollection()
         emit focusDataPointReady(-1, -1, QStringLiteral("clear"));
     }
 
+    m_focusTimeline.moveDone(QDateTime::currentMSecsSinceEpoch());
+
     if (m_fineScanIndex >= m_fineScanPositions.size()) {
+        // 拟合前取回最后一个点的分析
+        if (!joinSnrAnalysis()) {
+            return;
+        }
+        if (m_focusTimeline.size() > 0) {
+            reportFocusTimeline(QStringLiteral("fine"));
+        }
+
         // 全部采样完毕 —— 优先尝试基于 SNR 的二次曲线拟合，得到更精确的 super-fine 起点；
         // 如拟合失败或质量较差，则退回到“直接取最大 SNR 点”的逻辑。
         if (!m_fineFocusData.isEmpty()) {
@@ -2178,12 +2243,29 @@ void AutoFocus::performFineDataCollection()
     emit m_wsThread->sendMessageToClient("FocusPosition:" + QString::number(current) + ":" + QString::number(current));
 
     // 拍摄并等待
+    const int point = m_focusTimeline.addPoint(target, QDateTime::currentMSecsSinceEpoch());
     if (!captureFullImage()) { handleError("拍摄图像失败"); return; }
     if (!waitForCaptureComplete()) { handleError("拍摄超时"); return; }
+    m_focusTimeline.exposureDone(point, QDateTime::currentMSecsSinceEpoch());
+
+    // 识别 SNR（工作线程），同时移向下一个点
+    submitSnrAnalysis(true, m_fineScanIndex, target, point);
+    if (!m_isRunning) {
+        return;
+    }
+
+    // 下一个点
+    ++m_fineScanIndex;
+    if (m_fineScanIndex < m_fineScanPositions.size()) {
+        m_focusTimeline.moveStarted(point, QDateTime::currentMSecsSinceEpoch());
+        beginMoveTo(m_fineScanPositions[m_fineScanIndex], "精调扫描下一个点");
+    } else {
+        log("精调采样已完成，等待拟合阶段");
+    }
+}
 
-    // 识别 SNR
-    double snr = 0.0;
-    bool ok = detectSNRByPython(snr);
+void AutoFocus::applyFineSnrSample(int scanIndex, int target, bool ok, double snr)
+{
     if (!ok || !(std::isfinite(snr) && snr > 0.0)) {
         log(QString("该位置 SNR 无效或未识到星，使用占位值 0"));
         emit starDetectionResult(false, 0.0);
@@ -2196,7 +2278,7 @@ void AutoFocus::performFineDataCollection()
     // 发送 SNR 结果到前端
     if (m_wsThread) {
         QString msg = QString("AutoFocusSNR:fine:%1:%2:%3")
-                          .arg(m_fineScanIndex + 1)
+                          .arg(scanIndex + 1)
                           .arg(target)
                           .arg(snr, 0, 'f', 6);
         emit m_wsThread->sendMessageToClient(msg);
@@ -2204,7 +2286,7 @@ void AutoFocus::performFineDataCollection()
 
   // 精调阶段拍摄进度
   emit captureProgressChanged(QStringLiteral("fine"),
-                              m_fineScanIndex + 1,
+                              scanIndex + 1,
                               m_fineScanPositions.size());
 
     // 记录数据点（在 fine 阶段 hfr 字段中暂存 SNR，只用于可视化）
@@ -2215,14 +2297,214 @@ void AutoFocus::performFineDataCollection()
     emit focusDataPointReady(target, snr, QStringLiteral("fine"));
 
     log(QString("精调数据点%1/%2：位置=%3，SNR=%4")
-        .arg(m_fineScanIndex+1).arg(m_fineScanPositions.size()).arg(target).arg(snr));
+        .arg(scanIndex+1).arg(m_fineScanPositions.size()).arg(target).arg(snr));
+}
 
-    // 下一个点
-    ++m_fineScanIndex;
-    if (m_fineScanIndex < m_fineScanPositions.size()) {
-        beginMoveTo(m_fineScanPositions[m_fineScanIndex], "精调扫描下一个点");
+void AutoFocus::submitSnrAnalysis(bool fine, int scanIndex, int position, int timelineIndex)
+{
+    PendingSnrAnalysis job;
+    job.fine = fine;
+    job.scanIndex = scanIndex;
+    job.position = position;
+    job.timelineIndex = timelineIndex;
+
+#if AUTOFOCUS_SNR_TEST_MODE
+    job.source = QString("/home/quarcs/FOCUSTEST/%1.fits").arg(m_testFileCounter);
+    m_testFileCounter = m_testFileCounter >= 10 ? 1 : m_testFileCounter + 1;
+#else
+    QFileInfo fi(m_lastCapturedImage);
+    if (m_lastCapturedImage.isEmpty() || !fi.exists() || fi.size() == 0) {
+        log(QString("错误：图像文件无效: %1").arg(m_lastCapturedImage));
+        job.done = true;
     } else {
-        log("精调采样已完成，等待拟合阶段");
+        // 下一张会覆盖同一个文件：分析读本点快照（每轮每点一个文件，分析结束后删除）
+        job.source = QString("%1/autofocus_snr_%2_%3_%4.fits")
+                         .arg(fi.absolutePath(), m_snrRunTag, fine ? QStringLiteral("fine") : QStringLiteral("coarse"))
+                         .arg(timelineIndex);
+        QFile::remove(job.source);
+        if (QFile::copy(m_lastCapturedImage, job.source)) {
+            job.ownsSnapshot = true;
+        } else {
+            log(QString("复制对焦帧快照失败，本点改为同步分析: %1").arg(job.source));
+            job.result.startMs = QDateTime::currentMSecsSinceEpoch();
+            double snr = 0.0;
+            job.result.ok = Tools::findSNRByPython_Process(m_lastCapturedImage, snr);
+            job.result.snr = snr;
+            job.result.endMs = QDateTime::currentMSecsSinceEpoch();
+            m_focusTimeline.addJoinWait(timelineIndex, job.result.endMs - job.result.startMs);
+            job.source = m_lastCapturedImage;
+            job.done = true;
+        }
+    }
+#endif
+
+    // 前面还有点没记入时排在其后，保证按采样顺序记入
+    m_queuedSnr.enqueue(job);
+    pumpSnrQueue();
+}
+
+void AutoFocus::pumpSnrQueue()
+{
+    while (!m_snrInFlight && !m_queuedSnr.isEmpty()) {
+        const PendingSnrAnalysis job = m_queuedSnr.dequeue();
+        if (job.done) {
+            recordSnrResult(job);
+        } else {
+            startSnrAnalysis(job);
+        }
+    }
+    if (m_snrInFlight || !m_snrResumePending) {
+        return;
+    }
+
+    // 阶段收尾在等的结果已全部记入：从这里继续该阶段
+    m_snrResumePending = false;
+    m_snrJoinWaitStartMs = 0;
+    if (!m_isRunning) {
+        return;
+    }
+    if (m_currentState == AutoFocusState::COARSE_ADJUSTMENT) {
+        performCoarseDataCollection();
+    } else if (m_currentState == AutoFocusState::FINE_ADJUSTMENT) {
+        performFineDataCollection();
+    }
+}
+
+void AutoFocus::startSnrAnalysis(const PendingSnrAnalysis &job)
+{
+    m_pendingSnr = job;
+    m_snrInFlight = true;
+    const QString source = job.source;
+    const std::atomic_bool *cancel = &m_snrCancel;
+    m_snrWatcher.setFuture(QtConcurrent::run([source, cancel]() {
+        SnrAnalysisResult r;
+        r.startMs = QDateTime::currentMSecsSinceEpoch();
+        double snr = 0.0;
+        r.ok = Tools::findSNRByPython_Process(source, snr, cancel) && std::isfinite(snr) && snr >= 0.0;
+        r.snr = snr;
+        r.endMs = QDateTime::currentMSecsSinceEpoch();
+        return r;
+    }));
+    log(QString("%1第%2点 SNR 分析已提交到后台: %3").arg(job.fine ? "精调" : "粗调").arg(job.scanIndex + 1).arg(source));
+}
+
+void AutoFocus::onSnrAnalysisFinished()
+{
+    // 已被 cancelSnrAnalysis 收回的分析不再记入
+    if (!m_snrInFlight) {
+        return;
+    }
+    PendingSnrAnalysis job = m_pendingSnr;
+    m_snrInFlight = false;
+    job.result = m_snrWatcher.result();
+    if (job.ownsSnapshot) {
+        QFile::remove(job.source);
+    }
+    recordSnrResult(job);
+    pumpSnrQueue();
+}
+
+void AutoFocus::recordSnrResult(const PendingSnrAnalysis &job)
+{
+    const SnrAnalysisResult &r = job.result;
+    if (r.endMs > 0) {
+        m_focusTimeline.analysisSpan(job.timelineIndex, r.startMs, r.endMs);
+    }
+    if (m_snrJoinWaitStartMs > 0) {
+        // 阶段收尾等待期间记入的点：等待时间记到该点上
+        const qint64 nowMs = QDateTime::currentMSecsSinceEpoch();
+        const qint64 waitMs = nowMs - m_snrJoinWaitStartMs;
+        m_focusTimeline.addJoinWait(job.timelineIndex, waitMs);
+        m_snrJoinWaitStartMs = nowMs;
+        if (waitMs > 0) {
+            log(QString("等待第%1点 SNR 分析结果 %2 ms").arg(job.scanIndex + 1).arg(waitMs));
+        }
+    }
+
+    if (!m_isRunning) {
+        return;
+    }
+    if (job.fine) {
+        applyFineSnrSample(job.scanIndex, job.position, r.ok, r.snr);
+    } else {
+        applyCoarseSnrSample(job.scanIndex, job.position, r.ok, r.snr);
+    }
+}
+
+bool AutoFocus::joinSnrAnalysis()
+{
+    if (!m_snrInFlight && m_queuedSnr.isEmpty()) {
+        return m_isRunning;
+    }
+    // 还有点没记入：不在这里等，最后一个结果记入后由 pumpSnrQueue 重新进入当前阶段
+    if (m_snrJoinWaitStartMs == 0) {
+        m_snrJoinWaitStartMs = QDateTime::currentMSecsSinceEpoch();
+    }
+    m_snrResumePending = true;
+    return false;
+}
+
+void AutoFocus::cancelSnrAnalysis()
+{
+    m_snrResumePending = false;
+    m_snrJoinWaitStartMs = 0;
+    for (const auto &job : m_queuedSnr) {
+        if (job.ownsSnapshot) {
+            QFile::remove(job.source);
+        }
+    }
+    m_queuedSnr.clear();
+    if (!m_snrInFlight) {
+        return;
+    }
+
+    // 脚本每 100 ms 检查一次取消标志，被 kill 后线程池任务随即返回，这里等待时间很短
+    m_snrCancel = true;
+    m_snrWatcher.waitForFinished();
+    m_snrCancel = false;
+    m_snrInFlight = false;
+    if (m_pendingSnr.ownsSnapshot) {
+        QFile::remove(m_pendingSnr.source);
+    }
+    log("在途 SNR 分析已终止");
+}
+
+void AutoFocus::reportFocusTimeline(const QString &phase)
+{
+    const focus::FocusTimeline::Report r = m_focusTimeline.report(QDateTime::currentMSecsSinceEpoch());
+
+    QJsonArray points;
+    for (const auto &p : r.points) {
+        QJsonObject obj;
+        obj["index"] = p.index;
+        obj["position"] = p.position;
+        obj["exposureMs"] = static_cast<double>(p.exposureMs);
+        obj["analysisMs"] = static_cast<double>(p.analysisMs);
+        obj["moveMs"] = static_cast<double>(p.moveMs);
+        obj["joinWaitMs"] = static_cast<double>(p.joinWaitMs);
+        obj["savedMs"] = static_cast<double>(p.savedMs);
+        points.append(obj);
+    }
+    QJsonObject root;
+    root["phase"] = phase;
+    root["points"] = points;
+    root["wallMs"] = static_cast<double>(r.wallMs);
+    root["sequentialMs"] = static_cast<double>(r.sequentialMs);
+    root["savedMs"] = static_cast<double>(r.savedMs);
+    root["savedPerPointSec"] = r.savedPerPointSec;
+
+    Logger::Log(QString("%1时间线：%2 点，耗时 %3 s，分析与移动并行省下 %4 s（每点 %5 s），join 等待 %6 s")
+                    .arg(phase == "fine" ? "精调" : "粗调")
+                    .arg(r.points.size())
+                    .arg(r.wallMs / 1000.0, 0, 'f', 1)
+                    .arg(r.savedMs / 1000.0, 0, 'f', 1)
+                    .arg(r.savedPerPointSec, 0, 'f', 2)
+                    .arg(r.joinWaitMs / 1000.0, 0, 'f', 1)
+                    .toStdString(),
+                LogLevel::INFO, DeviceType::FOCUSER);
+    if (m_wsThread) {
+        emit m_wsThread->sendMessageToClient(
+            "AutoFocusTimeline:" + QString::fromUtf8(QJsonDocument(root).toJson(QJsonDocument::Compact)));
     }
 }
 
@@ -2231,6 +2513,8 @@ void AutoFocus::performFineDataCollection()
 void AutoFocus::startFineAdjustment()
 {
     emit focusSeriesReset(QStringLiteral("fine"));
+    cancelSnrAnalysis();
+    m_focusTimeline.reset(QDateTime::currentMSecsSinceEpoch());
 
     changeState(AutoFocusState::FINE_ADJUSTMENT);
     // 原“精调”阶段：UI 文案改为“粗调”
@@ -2372,25 +2656,30 @@ void AutoFocus::startSuperFineAdjustment()
         m_superFineStepSpan = std::max(1, static_cast<int>(std::round(totalRange * 0.01)));
     }
 
-    m_superFineScanPositions.clear();
-    auto push_unique_sf = [&](int p) {
-        p = std::clamp(p, minPos, maxPos);
-        if (m_superFineScanPositions.isEmpty() || m_superFineScanPositions.back() != p)
-            m_superFineScanPositions.push_back(p);
-    };
+    // 采样位置不再预先铺成 9 点网格：从中心和两侧各两步开始，每采一个点按双曲线模型决定下一个点，
+    // 最佳位置的置信区间窄于临界焦区就停止（最多 superFineMaxPoints 个点）
+    focus::AdaptiveFocusSampler::Options samplerOptions;
+    samplerOptions.center = center;
+    samplerOptions.step = m_superFineStepSpan;
+    samplerOptions.minPosition = minPos;
+    samplerOptions.maxPosition = maxPos;
+    samplerOptions.criticalZoneSteps = g_autoFocusConfig.criticalFocusZoneSteps;
+    samplerOptions.maxSamples = g_autoFocusConfig.superFineMaxPoints;
+    m_superFineSampler.reset(samplerOptions);
+    m_superFineModelFit = focus::HyperbolaFit();
 
-    // 构造 9 个 super-fine 采样点：center, ±1..±4
-    push_unique_sf(center);
-    for (int k = 1; k <= 4; ++k) {
-        push_unique_sf(center - k * m_superFineStepSpan);
-        push_unique_sf(center + k * m_superFineStepSpan);
-    }
+    // 多星 ROI 方案在本阶段第一帧（全幅）上生成
+    m_starRoiPlan = focus::StarRoiPlan();
+    m_starRoiPlanTried = false;
 
-    std::sort(m_superFineScanPositions.begin(), m_superFineScanPositions.end());
+    m_superFineScanPositions.clear();
+    double firstPosition = center;
+    if (m_superFineSampler.next(firstPosition) == focus::AdaptiveFocusSampler::Decision::Sample)
+        m_superFineScanPositions.push_back(static_cast<int>(firstPosition));
     m_superFineScanIndex = 0;
 
-    log(QString("开始更细致精调：中心=%1，步距=%2，计划采样点数=%3")
-            .arg(center).arg(m_superFineStepSpan).arg(m_superFineScanPositions.size()));
+    log(QString("开始更细致精调：中心=%1，步距=%2，最多采样点数=%3（自适应）")
+            .arg(center).arg(m_superFineStepSpan).arg(g_autoFocusConfig.superFineMaxPoints));
 
     if (!m_superFineScanPositions.isEmpty()) {
         const int firstTarget = m_superFineScanPositions.first();
@@ -2436,8 +2725,9 @@ void AutoFocus::processSuperFineAdjustment()
     validHfrValues.reserve(shotsPerPosition);
 
     for (int i = 0; i < shotsPerPosition; ++i) {
-        // 拍摄并等待完成
-        if (!captureFullImage()) {
+        // 拍摄并等待完成（已有多星 ROI 方案时只读出子帧）
+        const bool roiShot = m_starRoiPlan.ok;
+        if (!(roiShot ? captureStarRoiImage() : captureFullImage())) {
             log(QString("super-fine 第 %1/%2 张拍摄图像失败，本次拍摄丢弃，继续后续拍摄")
                     .arg(i + 1).arg(shotsPerPosition));
             continue;
@@ -2448,9 +2738,31 @@ void AutoFocus::processSuperFineAdjustment()
             continue;
         }
 
-        // 使用 calculatestars.py 计算当前帧的 median_HFR
+        // 本阶段第一帧（全幅）上选星；方案可用时所有点都在各星窗口内测 HFR，
+        // 否则沿用 calculatestars.py 计算整帧 median_HFR
+        if (!m_starRoiPlanTried) {
+            m_starRoiPlanTried = true;
+            planStarRoiFromLastFrame();
+        }
         double hfrFrame = 0.0;
-        bool okHfr = detectMedianHFRByPython(hfrFrame);
+        bool okHfr = false;
+        if (m_starRoiPlan.ok) {
+            okHfr = measureStarRoiHFR(hfrFrame);
+            if (!okHfr) {
+                m_starRoiPlan = focus::StarRoiPlan();
+                // ROI HFR 与整帧 median_HFR 口径不同，不能进同一条 V 曲线：已有 ROI 样本时整段重采
+                if (m_superFineSampler.attempts() > 0 || !validHfrValues.isEmpty()) {
+                    log("多星 ROI 测量失败，丢弃已采的 ROI HFR，本阶段改用全幅 + Python median_HFR 从头采样");
+                    startSuperFineAdjustment();
+                    m_starRoiPlanTried = true;  // 重采期间不再选星
+                    return;
+                }
+                log("多星 ROI 测量失败，本阶段改用全幅 + Python median_HFR");
+                okHfr = detectMedianHFRByPython(hfrFrame);
+            }
+        } else {
+            okHfr = detectMedianHFRByPython(hfrFrame);
+        }
 
         if (!okHfr) {
             // 严重错误（例如图像文件无效），记录日志但不加入有效集合
@@ -2500,20 +2812,46 @@ void AutoFocus::processSuperFineAdjustment()
     m_dataCollectionCount++;
     emit focusDataPointReady(target, hfr, QStringLiteral("super_fine"));
 
+    // 按已有数据重新拟合双曲线，决定下一个点或停止
+    m_superFineSampler.addSample(target, hfr);
+    double nextPosition = 0.0;
+    const focus::AdaptiveFocusSampler::Decision decision = m_superFineSampler.next(nextPosition);
+    const focus::HyperbolaFit &model = m_superFineSampler.fit();
+    const bool moreSamples = decision == focus::AdaptiveFocusSampler::Decision::Sample;
+    const int plannedTotal = moreSamples ? g_autoFocusConfig.superFineMaxPoints : m_superFineScanIndex + 1;
+
     log(QString("super-fine 数据点%1/%2：位置=%3，HFR=%4")
-        .arg(m_superFineScanIndex+1).arg(m_superFineScanPositions.size()).arg(target).arg(hfr));
+        .arg(m_superFineScanIndex+1).arg(plannedTotal).arg(target).arg(hfr));
+    if (model.ok) {
+        log(QString("super-fine V 曲线模型：best=%1 ±%2（2σ），minHFR=%3，半宽=%4，临界焦区=%5 步")
+                .arg(model.c, 0, 'f', 1)
+                .arg(m_superFineSampler.confidenceHalfWidth(), 0, 'f', 1)
+                .arg(model.a, 0, 'f', 3)
+                .arg(model.b, 0, 'f', 1)
+                .arg(m_superFineSampler.zoneSteps(), 0, 'f', 1));
+    }
 
   // 超精细精调阶段拍摄进度
   emit captureProgressChanged(QStringLiteral("super_fine"),
                               m_superFineScanIndex + 1,
-                              m_superFineScanPositions.size());
+                              plannedTotal);
 
     // 下一个点
     ++m_superFineScanIndex;
-    if (m_superFineScanIndex < m_superFineScanPositions.size()) {
-        beginMoveTo(m_superFineScanPositions[m_superFineScanIndex], "super-fine 扫描下一个点");
+    if (moreSamples) {
+        m_superFineScanPositions.push_back(static_cast<int>(nextPosition));
+        beginMoveTo(m_superFineScanPositions[m_superFineScanIndex],
+                    QString("super-fine 下一个点（%1）").arg(QString::fromLatin1(m_superFineSampler.reason())));
     } else {
-        log("super-fine 采样已完成，等待拟合阶段");
+        // 采样数用完而未收敛时，模型顶点落在已采样范围内才采用，否则交给二次拟合/插值
+        const auto range = std::minmax_element(m_superFineScanPositions.begin(), m_superFineScanPositions.end());
+        if (model.ok && (decision == focus::AdaptiveFocusSampler::Decision::Converged ||
+                         (model.c >= *range.first && model.c <= *range.second))) {
+            m_superFineModelFit = model;
+        }
+        log(QString("super-fine 采样结束（%1），共%2点，等待拟合阶段")
+                .arg(QString::fromLatin1(m_superFineSampler.reason()))
+                .arg(m_superFineSampler.attempts()));
     }
 }
 
@@ -2768,10 +3106,19 @@ void AutoFocus::processFittingData()
         return;
     }
 
-    log("开始拟合对焦数据（抛物线二次曲线）...");
-
-    // Step 5: 拟合二次曲线
-    FitResult result = fitFocusData();
+    // Step 5: super-fine 自适应采样留下了收敛的 V 曲线模型时直接用它（顶点即最佳位置，
+    // 以顶点处的二次近似供前端画曲线）；否则拟合二次曲线
+    FitResult result;
+    if (m_superFineModelFit.ok) {
+        log("使用 super-fine 的 V 曲线（双曲线）模型确定最佳位置...");
+        m_superFineModelFit.toParabola(result.a, result.b, result.c);
+        result.bestPosition = m_superFineModelFit.c;
+        result.minHFR = m_superFineModelFit.a;
+        m_superFineModelFit = focus::HyperbolaFit();
+    } else {
+        log("开始拟合对焦数据（抛物线二次曲线）...");
+        result = fitFocusData();
+    }
 
     // Step 6: 检查拟合结果是否有效
     bool isResultValid = true;
@@ -4882,6 +5229,142 @@ bool AutoFocus::isROIValid(const QRect& roi) const
     return roi.isValid() && roi.width() > 0 && roi.height() > 0;
 }
 
+/**
+ * @brief 从刚拍的全幅帧生成多星 ROI 方案
+ *
+ * 本地 C++ 识星后选 K 颗分散、不饱和、孤立的星（focus::planStarRois），
+ * 之后每次曝光只读出这些星小窗的外接子帧，读出和分析的像素量随星数而不是传感器尺寸变化
+ *
+ * @return bool 方案是否可用；不可用时本阶段按全幅 + Python median_HFR 处理
+ */
+bool AutoFocus::planStarRoiFromLastFrame()
+{
+    m_starRoiPlan = focus::StarRoiPlan();
+
+#if AUTOFOCUS_SNR_TEST_MODE
+    // 测试模式下 HFR 来自固定测试文件，与实际拍摄的帧无关
+    return false;
+#else
+    if (!g_autoFocusConfig.useStarRoiFocus) {
+        return false;
+    }
+    if (m_useSdkMainCamera) {
+        log("SDK 主相机拍摄通路暂不支持 ROI，多星 ROI 模式不启用");
+        return false;
+    }
+
+    const QByteArray path = m_lastCapturedImage.toLocal8Bit();
+    cv::Mat image;
+    if (Tools::readFits(path.constData(), image) != 0 || image.empty()) {
+        log(QString("多星 ROI：读取首帧失败（%1），按全幅处理").arg(m_lastCapturedImage));
+        return false;
+    }
+
+    std::vector<Tools::FocusedStar> stars;
+    if (Tools::DetectFocusedStarsFromFITS(path.constData(), stars) != 0 || stars.empty()) {
+        log("多星 ROI：首帧未识别到星点，按全幅处理");
+        return false;
+    }
+
+    m_starRoiSaturationAdu = 0.9 * (image.depth() == CV_8U ? 255.0 : 65535.0);
+
+    std::vector<focus::StarCandidate> candidates;
+    candidates.reserve(stars.size());
+    for (const Tools::FocusedStar &s : stars) {
+        candidates.push_back({s.x, s.y, s.flux, s.localMax, s.hfr, s.snr});
+    }
+
+    focus::StarRoiOptions options;
+    options.imageWidth = image.cols;
+    options.imageHeight = image.rows;
+    options.starCount = g_autoFocusConfig.starRoiCount;
+    options.maxReadoutFraction = g_autoFocusConfig.starRoiMaxReadoutFraction;
+    options.saturationAdu = m_starRoiSaturationAdu;
+    m_starRoiPlan = focus::planStarRois(candidates, options);
+
+    if (!m_starRoiPlan.ok) {
+        log(QString("多星 ROI：%1 颗候选中可用 %2 颗，不足以启用，按全幅处理")
+                .arg(stars.size()).arg(m_starRoiPlan.usableCandidates));
+        return false;
+    }
+
+    const focus::RoiRect &r = m_starRoiPlan.readout;
+    log(QString("多星 ROI：%1 颗候选中选 %2 颗，窗口 %3px，读出子帧 x=%4, y=%5, w=%6, h=%7（全幅的 %8%）")
+            .arg(stars.size())
+            .arg(m_starRoiPlan.stars.size())
+            .arg(m_starRoiPlan.windowSize)
+            .arg(r.x).arg(r.y).arg(r.width).arg(r.height)
+            .arg(m_starRoiPlan.readoutFraction * 100.0, 0, 'f', 1));
+    return true;
+#endif
+}
+
+/**
+ * @brief 按多星 ROI 方案的读出子帧拍摄
+ */
+bool AutoFocus::captureStarRoiImage()
+{
+    const focus::RoiRect &r = m_starRoiPlan.readout;
+    const bool previousUseROI = m_useROI;
+    m_currentROI = QRect(r.x, r.y, r.width, r.height);
+    m_useROI = true;
+    const bool ok = captureImage(m_defaultExposureTime, true);
+    m_useROI = previousUseROI;
+    return ok;
+}
+
+/**
+ * @brief 在多星 ROI 方案的各窗口内测量 HFR
+ *
+ * 子帧（尺寸等于读出区域）按读出区域左上角换算坐标；相机没有应用 ROI 而返回全幅时按全幅坐标测量。
+ * 每次测量后窗口跟随星的质心移动
+ *
+ * @param hfr 各星 HFR 的中位数（饱和星不计入）
+ * @return bool 是否有足够的星给出有效 HFR
+ */
+bool AutoFocus::measureStarRoiHFR(double &hfr)
+{
+    if (!m_isRunning || !m_starRoiPlan.ok) {
+        return false;
+    }
+
+    cv::Mat image;
+    if (Tools::readFits(m_lastCapturedImage.toLocal8Bit().constData(), image) != 0 || image.empty()) {
+        log(QString("多星 ROI：读取图像失败: %1").arg(m_lastCapturedImage));
+        return false;
+    }
+    if (image.depth() == CV_8U) {
+        image.convertTo(image, CV_16U);
+    }
+
+    int originX = 0;
+    int originY = 0;
+    const focus::RoiRect &readout = m_starRoiPlan.readout;
+    if (image.cols == readout.width && image.rows == readout.height) {
+        originX = readout.x;
+        originY = readout.y;
+    } else if (image.cols != m_starRoiPlan.imageWidth || image.rows != m_starRoiPlan.imageHeight) {
+        log(QString("多星 ROI：图像尺寸 %1x%2 与读出子帧 %3x%4 / 全幅 %5x%6 都不一致")
+                .arg(image.cols).arg(image.rows)
+                .arg(readout.width).arg(readout.height)
+                .arg(m_starRoiPlan.imageWidth).arg(m_starRoiPlan.imageHeight));
+        return false;
+    }
+
+    const focus::RoiHfrResult result = focus::measureRoiHfr(image.ptr<uint16_t>(), image.cols, image.rows,
+                                                            originX, originY, m_starRoiPlan, m_starRoiSaturationAdu);
+    log(QString("多星 ROI HFR: %1（有效 %2 / 饱和 %3 / 失败 %4）")
+            .arg(result.medianHfr)
+            .arg(result.measured).arg(result.saturated).arg(result.failed));
+    if (!result.ok) {
+        return false;
+    }
+
+    hfr = result.medianHfr;
+    m_lastHFR = hfr;
+    return true;
+}
+
 /**
  * @brief 统一等待电调移动完成
  * 
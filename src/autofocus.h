@@ -9,6 +9,10 @@
 #include <QString>
 #include <QSettings>
 #include <QCoreApplication>
+#include <QFuture>
+#include <QFutureWatcher>
+#include <QQueue>
+#include <atomic>
 #include <stellarsolver.h> // 包含FITSImage定义
 #include "myclient.h"
 #include "tools.h"
@@ -19,6 +23,9 @@
 // SDK：注意本工程的“SDK连接”是按设备分别启用的（非全局模式）
 #include "sdks/SdkCommon.h"
 #include "sdks/SdkManager.h"
+#include "focus/FocusTimeline.h"
+#include "focus/VCurveFocus.h"
+#include "focus/StarRoi.h"
 
 // 自动对焦状态枚举
 enum class AutoFocusState {
@@ -212,6 +219,7 @@ private slots:
     void onMoveCheckTimerTimeout();         // 电调移动检查定时器回调
     void onCaptureCheckTimerTimeout();      // 拍摄完成检查定时器回调
     void forceStopAllWaiting();             // 强制停止所有等待状态
+    void onSnrAnalysisFinished();           // 后台 SNR 分析完成（m_snrWatcher）
 
 private:
     // 公共初始化逻辑：设备检查 + 成员状态重置 + 行程范围与当前位置读取
@@ -257,6 +265,35 @@ private:
     int m_coarseScanIndex;                 // 粗调扫描索引
     QVector<int> m_fineScanPositions;      // 精调扫描位置序列
     int m_fineScanIndex;                   // 精调扫描索引
+
+    // 粗调/精调流水线：第 N 点的 SNR 分析在线程池里跑，与移向第 N+1 点、第 N+1 点曝光并行；
+    // 同一时刻最多一个分析在途，其余按采样顺序排队；结果由 m_snrWatcher 的 finished 信号记入，
+    // 阶段收尾时若还有未记入的点，等最后一个结果记入后再继续该阶段（不在主线程里轮询等待）
+    struct SnrAnalysisResult {
+        bool ok = false;
+        double snr = 0.0;
+        qint64 startMs = 0;
+        qint64 endMs = 0;
+    };
+    struct PendingSnrAnalysis {
+        bool fine = false;          // false=粗调，true=精调
+        int scanIndex = -1;
+        int position = 0;
+        int timelineIndex = -1;
+        QString source;             // 分析的文件
+        bool ownsSnapshot = false;  // source 为本点快照，分析结束后删除
+        bool done = false;          // 已同步得到结果（图像无效/快照失败），轮到时直接记入
+        SnrAnalysisResult result;
+    };
+    PendingSnrAnalysis m_pendingSnr;              // 在途分析（m_snrInFlight 为 true 时有效）
+    bool m_snrInFlight = false;
+    QQueue<PendingSnrAnalysis> m_queuedSnr;       // 等待启动或记入的点
+    QFutureWatcher<SnrAnalysisResult> m_snrWatcher;
+    std::atomic_bool m_snrCancel{false};          // 停止时置位：后台脚本被终止
+    bool m_snrResumePending = false;              // 阶段收尾在等结果，全部记入后继续当前阶段
+    qint64 m_snrJoinWaitStartMs = 0;              // 阶段收尾开始等待的时间（计入时间线 joinWait）
+    QString m_snrRunTag;                          // 快照文件名中的本轮标识（pid + 启动时间）
+    focus::FocusTimeline m_focusTimeline;  // 当前粗调/精调阶段的逐点时间线
     int m_coarseStepSpan;                  // 粗调步进（= 总行程 / m_coarseDivisionCount）
     int m_fineStepSpan;                    // 精调步进（= 粗调步进/10）
     int m_coarseDivisionCount;             // 粗调分段数（默认 10）
@@ -285,10 +322,12 @@ private:
     int  m_fineHFRCurrentTargetPosition;   // 当前目标采样位置
 
     // 更细致精调（super-fine）扫描数据
-    QVector<int> m_superFineScanPositions;   // super-fine 扫描位置序列
+    QVector<int> m_superFineScanPositions;   // super-fine 已下发的采样位置（由自适应采样逐点追加）
     int m_superFineScanIndex;                // super-fine 扫描索引
     int m_superFineStepSpan;                 // super-fine 步进
     QVector<FocusDataPoint> m_superFineFocusData; // 仅 super-fine 数据（用于最终拟合）
+    focus::AdaptiveFocusSampler m_superFineSampler; // 按双曲线模型决定下一个采样点、何时停止
+    focus::HyperbolaFit m_superFineModelFit;        // 采样结束时的模型，拟合阶段优先使用（用后清空）
 
     int m_currentLargeRangeShots;
     double m_currentLargeRangeStep;
@@ -328,6 +367,9 @@ private:
     QRect m_currentROI;                     // 当前ROI区域
     int m_roiSize;                          // ROI大小（正方形）
     QPointF m_roiCenter;                    // ROI中心位置
+    focus::StarRoiPlan m_starRoiPlan;       // 多星 ROI 方案（ok=false 表示按全幅处理）
+    bool m_starRoiPlanTried;                // 本阶段是否已用第一帧尝试过选星
+    double m_starRoiSaturationAdu;          // 饱和阈值（按第一帧位深的 90% 满量程）
     
     // 电调位置限制
     int m_focuserMinPosition;               // 电调最小位置
@@ -398,6 +440,11 @@ private:
     void updateROICenter(const QPointF& starPosition); // 根据星点位置更新ROI中心
     QRect calculateROI(const QPointF& center, int size); // 计算ROI区域
     bool isROIValid(const QRect& roi) const;       // 检查ROI是否有效
+
+    // 多星 ROI 模式（super-fine）：第一帧全幅选 K 颗星，之后只读出各星小窗的外接子帧并在窗内测 HFR
+    bool planStarRoiFromLastFrame();                // 从刚拍的全幅帧选星并生成 ROI 方案
+    bool captureStarRoiImage();                     // 按方案的读出子帧拍摄
+    bool measureStarRoiHFR(double &hfr);            // 在各星窗口内测 HFR，返回中位数
     
     // 电调控制方法
     void moveFocuser(int steps);                    // 移动电调
@@ -444,6 +491,15 @@ private:
     // 数据收集辅助方法
     void performCoarseDataCollection();
     void performFineDataCollection();
+    void submitSnrAnalysis(bool fine, int scanIndex, int position, int timelineIndex);
+    bool joinSnrAnalysis();                                   // 全部结果已记入返回 true；否则登记收尾续跑并返回 false
+    void pumpSnrQueue();                                      // 按顺序记入已有结果、启动下一个分析，必要时续跑收尾
+    void startSnrAnalysis(const PendingSnrAnalysis &job);
+    void recordSnrResult(const PendingSnrAnalysis &job);
+    void cancelSnrAnalysis();                                 // 终止在途分析、丢弃队列并删除快照
+    void applyCoarseSnrSample(int scanIndex, int position, bool ok, double snr);
+    void applyFineSnrSample(int scanIndex, int position, bool ok, double snr);
+    void reportFocusTimeline(const QString &phase);           // 发送 AutoFocusTimeline:<json>
     
     // 数据收集和处理
     void collectFocusData();
@@ -25,6 +25,8 @@
 #include <algorithm>
 #include <limits>
 
+#include "devices/DeviceStateAwait.h"
+
 
 
 namespace {
@@ -374,6 +376,7 @@ bool PolarAlignment::startPolarAlignment()
     
     // 初始化校准状态和参数
     currentState = PolarAlignmentState::INITIALIZING;
+    trackingSession.reset();
     currentMeasurementIndex = 0;
     currentAdjustmentAttempt = 0;
     currentRAAngle = config.raRotationAngle;
@@ -2362,7 +2365,27 @@ bool PolarAlignment::solveImage(const QString& imageFile)
         Logger::Log("PolarAlignment: 使用模式2解析，参考位置 - RA: " + std::to_string(lastRA) + "°, DEC: " + std::to_string(lastDEC) + "°", LogLevel::INFO, DeviceType::MAIN);
     }
     
-    // 调用图像解析功能
+    // 调用图像解析功能（附带本地识星星表，solve-field 只做匹配）
+    solver::XyList starList;
+    const bool haveStarList = Tools::DetectSolveStarList(imageFile, starList);
+
+    // 画面只移动了几个角分时先做近先验跟踪解析（几十毫秒）；要求全局解析/重锚时跳过
+    const bool allowTracking = !forceGlobalSolveOnce && imageGuideMode != PolarImageGuidanceMode::REANCHOR_SOLVE;
+    if (haveStarList && allowTracking && Tools::TrackSolve(imageFile, starList, trackingSession)) {
+        Logger::Log("PolarAlignment: 跟踪解析成功，跳过完整解析", LogLevel::INFO, DeviceType::MAIN);
+        lastSolveModeUsed = solveMode;
+        return true;
+    }
+    // 三点法的画面通常离天极不远：先试极冠星型索引（不在极冠内时几毫秒内失败），再走 solve-field
+    if (haveStarList && focalLength > 0 && cameraWidth > 0.0 && cameraHeight > 0.0) {
+        const MinMaxFOV fov = Tools::calculateFOV(focalLength, cameraWidth, cameraHeight);
+        if (Tools::PoleIndexSolve(imageFile, starList, fov.minFOV, fov.maxFOV, config.latitude < 0.0 ? -1 : 1)) {
+            Logger::Log("PolarAlignment: 极区索引解析成功，跳过 solve-field", LogLevel::INFO, DeviceType::MAIN);
+            lastSolveModeUsed = solveMode;
+            Tools::AnchorTracking(imageFile, starList, trackingSession);
+            return true;
+        }
+    }
     bool ret = Tools::PlateSolve(imageFile,
                                  focalLength,
                                  cameraWidth,
@@ -2373,7 +2396,8 @@ bool PolarAlignment::solveImage(const QString& imageFile)
                                  lastDEC,
                                  -1.0,
                                  QString(),
-                                 solveTimeoutMs);
+                                 solveTimeoutMs,
+                                 haveStarList ? &starList : nullptr);
     if(!ret)
     {
         Logger::Log("PolarAlignment: 图像解析命令执行失败", LogLevel::WARNING, DeviceType::MAIN);
@@ -2383,6 +2407,8 @@ bool PolarAlignment::solveImage(const QString& imageFile)
     
     Logger::Log("PolarAlignment: 图像开始解析", LogLevel::INFO, DeviceType::MAIN);
     lastSolveModeUsed = solveMode;
+    if (haveStarList && Tools::isSolveImageFinish())
+        Tools::AnchorTracking(imageFile, starList, trackingSession);
     return true;
 }
 
@@ -2420,13 +2446,7 @@ bool PolarAlignment::moveTelescope(double ra, double dec)
         indiServer->getTelescopeStatus(dpMount, currentStat);
         if (currentStat == "Moving") {
             Logger::Log("PolarAlignment: 赤道仪正在移动中，等待完成后再发送新命令", LogLevel::WARNING, DeviceType::MAIN);
-            int waitTime = 0;
-            while (currentStat == "Moving" && waitTime < 30000) { // 最多等待30秒
-                QThread::msleep(500);
-                waitTime += 500;
-                indiServer->getTelescopeStatus(dpMount, currentStat);
-            }
-            if (waitTime >= 30000) {
+            if (!waitForMountIdle(30000)) { // 最多等待30秒
                 Logger::Log("PolarAlignment: 等待赤道仪移动完成超时(30s)", LogLevel::ERROR, DeviceType::MAIN);
                 return false;
             }
@@ -2472,13 +2492,7 @@ bool PolarAlignment::moveTelescopeToAbsolutePosition(double ra, double dec)
         if(currentStat == "Moving") {
             Logger::Log("PolarAlignment: 赤道仪正在移动中，等待完成后再发送绝对位置移动命令", LogLevel::WARNING, DeviceType::MAIN);
             // 等待当前移动完成
-            int waitTime = 0;
-            while(currentStat == "Moving" && waitTime < 30000) { // 最多等待30秒
-                QThread::msleep(500);
-                waitTime += 500;
-                indiServer->getTelescopeStatus(dpMount, currentStat);
-            }
-            if(waitTime >= 30000) {
+            if (!waitForMountIdle(30000)) { // 最多等待30秒
                 Logger::Log("PolarAlignment: 等待赤道仪移动完成超时", LogLevel::ERROR, DeviceType::MAIN);
                 return false;
             }
@@ -2722,33 +2736,31 @@ bool PolarAlignment::waitForSolveComplete()
 bool PolarAlignment::waitForMovementComplete()
 {
     Logger::Log("PolarAlignment: 等待移动完成", LogLevel::INFO, DeviceType::MAIN);
-    
-    movementTimer.start(config.movementTimeout);
-    QEventLoop loop;
-    QTimer checkTimer;
-    checkTimer.setInterval(500);
-    
-    connect(&checkTimer, &QTimer::timeout, [&]() {
-        if (!dpMount) {
-            loop.quit();
-            return;
-        }
-        
+    if (!dpMount)
+        return true;
+
+    const bool idle = waitForMountIdle(config.movementTimeout);
+    if (idle)
+        Logger::Log("PolarAlignment: 移动完成", LogLevel::INFO, DeviceType::MAIN);
+    else
+        Logger::Log("PolarAlignment: 等待移动完成超时", LogLevel::WARNING, DeviceType::MAIN);
+    return idle;
+}
+
+bool PolarAlignment::waitForMountIdle(int timeoutMs)
+{
+    // 坐标属性状态一变即由总线唤醒；总线还没有该赤道仪状态时按 getTelescopeStatus 口径判断，
+    // awaitDeviceState 每 200ms 也会复核一次，兼顾不上报坐标属性的驱动
+    auto idle = [this](const devices::DeviceState &state) {
+        if (dpMount == nullptr)
+            return true;
+        if (state.mount.eqState != devices::PropState::Unknown)
+            return !state.mount.moving();
         QString status;
         indiServer->getTelescopeStatus(dpMount, status);
-        if (status == "Idle") {
-            Logger::Log("PolarAlignment: 移动完成", LogLevel::INFO, DeviceType::MAIN);
-            loop.quit();
-        }
-    });
-    
-    connect(&movementTimer, &QTimer::timeout, &loop, &QEventLoop::quit);
-    checkTimer.start();
-    loop.exec();
-    checkTimer.stop();
-    movementTimer.stop();
-    
-    return !movementTimer.isActive();
+        return status == "Idle";
+    };
+    return devices::awaitDeviceState(devices::DeviceRole::Mount, idle, timeoutMs);
 }
 
 bool PolarAlignment::isAnalysisSuccessful(const SloveResults& result)
@@ -763,6 +763,13 @@ private:
      * @return 是否成功完成
      */
     bool waitForMovementComplete();
+
+    /**
+     * @brief 等待赤道仪静止（设备状态总线事件驱动；驱动不报坐标属性时退回 getTelescopeStatus）
+     * @param timeoutMs 超时（毫秒）
+     * @return 静止返回 true，超时返回 false
+     */
+    bool waitForMountIdle(int timeoutMs);
     
     // ==================== 辅助函数 ====================
     
@@ -1226,6 +1233,8 @@ private:
     bool imageGuideDriftVelocityValid = false;
     bool forceGlobalSolveOnce = false;
     int lastSolveModeUsed = 1;
+    // 近先验跟踪解析：完整解析成功后锚定，之后的帧先尝试跟踪，失败再完整解析
+    solver::TrackingSession trackingSession;
     bool imageGuideFreshSolveThisFrame = false;
     bool imageGuideReanchorNeedFreshSolve = false;
     bool imageGuidePerfReduced = false;
@@ -0,0 +1,265 @@
+#include "ConnectOrchestrator.h"
+
+#include <chrono>
+#include <set>
+#include <thread>
+#include <unordered_map>
+
+namespace devices {
+
+namespace {
+
+struct TaskState {
+    ConnectReport report;
+    int64_t attemptStartMs{-1};
+    int64_t retryAtMs{-1};   ///< >=0 表示在等重试
+    bool started{false};     ///< 本次尝试已调用 start
+};
+
+bool isFinal(ConnectStatus status)
+{
+    return status == ConnectStatus::Done || status == ConnectStatus::Failed || status == ConnectStatus::Skipped;
+}
+
+} // namespace
+
+const char* connectStatusName(ConnectStatus status)
+{
+    switch (status)
+    {
+    case ConnectStatus::Waiting: return "Waiting";
+    case ConnectStatus::Running: return "Running";
+    case ConnectStatus::Done:    return "Done";
+    case ConnectStatus::Failed:  return "Failed";
+    case ConnectStatus::Skipped: return "Skipped";
+    default:                     return "Unknown";
+    }
+}
+
+void ConnectOrchestrator::addTask(ConnectTask task)
+{
+    m_tasks.push_back(std::move(task));
+}
+
+std::vector<ConnectReport> ConnectOrchestrator::run(int overallTimeoutMs)
+{
+    const auto t0 = std::chrono::steady_clock::now();
+    auto elapsed = [&t0]() -> int64_t {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - t0).count();
+    };
+
+    const size_t count = m_tasks.size();
+    std::vector<TaskState> states(count);
+    std::unordered_map<std::string, size_t> indexByName;
+
+    auto finish = [&](size_t i, ConnectStatus status, const std::string& message) {
+        TaskState& st = states[i];
+        st.report.status = status;
+        st.report.endMs = elapsed();
+        if (st.report.startMs < 0)
+            st.report.startMs = st.report.endMs;
+        st.report.message = message;
+        if (m_onFinished)
+            m_onFinished(st.report);
+    };
+
+    // 校验：重名、未知依赖直接判失败，不影响其它任务
+    for (size_t i = 0; i < count; ++i)
+    {
+        states[i].report.name = m_tasks[i].name;
+        if (!indexByName.emplace(m_tasks[i].name, i).second)
+            finish(i, ConnectStatus::Failed, "duplicate task name");
+    }
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (isFinal(states[i].report.status))
+            continue;
+        for (const std::string& dep : m_tasks[i].dependsOn)
+        {
+            if (indexByName.find(dep) == indexByName.end())
+            {
+                finish(i, ConnectStatus::Failed, "unknown dependency " + dep);
+                break;
+            }
+        }
+    }
+
+    auto beginAttempt = [&](size_t i, int64_t now) {
+        TaskState& st = states[i];
+        st.attemptStartMs = now;
+        st.retryAtMs = -1;
+        st.started = false;
+    };
+
+    // 本次尝试失败：还有次数且补救成功则排队重试，否则判失败
+    auto attemptFailed = [&](size_t i, int64_t now, const std::string& why) {
+        const ConnectTask& task = m_tasks[i];
+        TaskState& st = states[i];
+        const int attempt = st.report.attempts;
+        const bool retry = attempt < task.maxAttempts && (!task.onAttemptFailed || task.onAttemptFailed(attempt));
+        if (!retry)
+        {
+            finish(i, ConnectStatus::Failed, why);
+            return;
+        }
+        st.report.message = why;
+        st.retryAtMs = now + (task.retryDelayMs > 0 ? task.retryDelayMs : 0);
+        st.started = false;
+    };
+
+    while (true)
+    {
+        const int64_t now = elapsed();
+        bool changed = false;
+        bool allFinal = true;
+        bool anyRunning = false;
+
+        if (overallTimeoutMs > 0 && now >= overallTimeoutMs)
+        {
+            for (size_t i = 0; i < count; ++i)
+            {
+                if (!isFinal(states[i].report.status))
+                    finish(i, ConnectStatus::Failed, "overall timeout");
+            }
+            break;
+        }
+
+        std::set<std::string> busyResources;
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (states[i].report.status == ConnectStatus::Running && !m_tasks[i].resource.empty())
+                busyResources.insert(m_tasks[i].resource);
+        }
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            const ConnectTask& task = m_tasks[i];
+            TaskState& st = states[i];
+
+            if (st.report.status == ConnectStatus::Waiting)
+            {
+                bool depsDone = true;
+                std::string failedDep;
+                for (const std::string& dep : task.dependsOn)
+                {
+                    const ConnectStatus depStatus = states[indexByName[dep]].report.status;
+                    if (depStatus == ConnectStatus::Failed || depStatus == ConnectStatus::Skipped)
+                    {
+                        failedDep = dep;
+                        break;
+                    }
+                    if (depStatus != ConnectStatus::Done)
+                        depsDone = false;
+                }
+                if (!failedDep.empty())
+                {
+                    finish(i, ConnectStatus::Skipped, "dependency " + failedDep + " not connected");
+                    changed = true;
+                    continue;
+                }
+                if (!depsDone || (!task.resource.empty() && busyResources.count(task.resource) > 0))
+                {
+                    allFinal = false;
+                    continue;
+                }
+                if (!task.resource.empty())
+                    busyResources.insert(task.resource);
+                st.report.status = ConnectStatus::Running;
+                st.report.startMs = now;
+                beginAttempt(i, now);
+                changed = true;
+            }
+
+            if (st.report.status != ConnectStatus::Running)
+                continue;
+
+            if (st.retryAtMs >= 0)
+            {
+                if (now < st.retryAtMs)
+                {
+                    allFinal = false;
+                    anyRunning = true;
+                    continue;
+                }
+                beginAttempt(i, now);
+            }
+
+            if (!st.started)
+            {
+                if (task.ready && !task.ready())
+                {
+                    if (task.timeoutMs > 0 && now - st.attemptStartMs >= task.timeoutMs)
+                    {
+                        ++st.report.attempts;
+                        attemptFailed(i, now, "not ready after " + std::to_string(task.timeoutMs) + " ms");
+                        changed = true;
+                    }
+                }
+                else
+                {
+                    ++st.report.attempts;
+                    st.started = true;
+                    changed = true;
+                    if (!task.start || !task.start(st.report.attempts))
+                        attemptFailed(i, now, "start failed");
+                }
+            }
+            else
+            {
+                const ConnectPoll result = task.poll ? task.poll() : ConnectPoll::Done;
+                if (result == ConnectPoll::Done)
+                {
+                    finish(i, ConnectStatus::Done, std::string());
+                    changed = true;
+                }
+                else if (result == ConnectPoll::Failed)
+                {
+                    attemptFailed(i, now, "device reported failure");
+                    changed = true;
+                }
+                else if (task.timeoutMs > 0 && now - st.attemptStartMs >= task.timeoutMs)
+                {
+                    attemptFailed(i, now, "timeout after " + std::to_string(task.timeoutMs) + " ms");
+                    changed = true;
+                }
+            }
+
+            if (!isFinal(st.report.status))
+            {
+                allFinal = false;
+                anyRunning = true;
+            }
+        }
+
+        if (allFinal)
+            break;
+
+        // 没有在跑的任务、这一轮也没有任何推进：剩下的只能是依赖环
+        if (!anyRunning && !changed)
+        {
+            for (size_t i = 0; i < count; ++i)
+            {
+                if (!isFinal(states[i].report.status))
+                    finish(i, ConnectStatus::Failed, "dependency cycle");
+            }
+            break;
+        }
+
+        // 有状态推进时立即再走一轮，让刚解锁的下游不必多等一个轮询间隔
+        if (changed)
+            continue;
+        if (m_idle)
+            m_idle(m_pollIntervalMs);
+        else
+            std::this_thread::sleep_for(std::chrono::milliseconds(m_pollIntervalMs));
+    }
+
+    m_elapsedMs = elapsed();
+    std::vector<ConnectReport> reports;
+    reports.reserve(count);
+    for (const TaskState& st : states)
+        reports.push_back(st.report);
+    return reports;
+}
+
+} // namespace devices
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace devices {
+
+enum class ConnectPoll {
+    Pending,
+    Done,
+    Failed,
+};
+
+enum class ConnectStatus {
+    Waiting,   ///< 依赖未完成
+    Running,
+    Done,
+    Failed,
+    Skipped,   ///< 依赖失败，未尝试
+};
+
+const char* connectStatusName(ConnectStatus status);
+
+// 一个设备的连接步骤。start/poll 都不应阻塞：INDI connectDevice 只是发出请求，
+// 结果由 poll 读 isConnected()；需要阻塞的操作放到自己的执行线程里，poll 查 future。
+struct ConnectTask {
+    std::string name;                     ///< 唯一名，通常是设备名
+    std::vector<std::string> dependsOn;   ///< 这些任务 Done 后才开始
+    std::string resource;                 ///< 非空时同 resource 的任务串行（共享串口/USB 控制器）
+    int timeoutMs{5000};                  ///< 单次尝试超时（含 ready 等待）
+    int maxAttempts{2};
+    int retryDelayMs{200};
+
+    std::function<bool()> ready;                 ///< 可选：前置条件（如 CONNECTION 属性已到），满足前不 start
+    std::function<bool(int attempt)> start;      ///< 发起第 attempt 次（从 1 开始）连接；false 视为本次失败
+    std::function<ConnectPoll()> poll;
+    std::function<bool(int attempt)> onAttemptFailed;  ///< 可选：重试前补救（断开释放串口、纠正端口）；false 放弃重试
+};
+
+struct ConnectReport {
+    std::string name;
+    ConnectStatus status{ConnectStatus::Waiting};
+    int attempts{0};
+    int64_t startMs{-1};      ///< 相对 run() 开始；未开始为 -1
+    int64_t endMs{-1};
+    std::string message;
+
+    int64_t durationMs() const { return (startMs >= 0 && endMs >= startMs) ? endMs - startMs : 0; }
+};
+
+// 设备连接编排：按依赖图并发推进各设备的连接步骤，单次尝试超时、重试、失败向下游传播。
+// run() 在调用线程里轮询（不开线程），各任务的等待时间重叠，总耗时约为关键路径而不是各设备之和。
+class ConnectOrchestrator
+{
+public:
+    void addTask(ConnectTask task);
+    bool empty() const { return m_tasks.empty(); }
+
+    void setPollIntervalMs(int ms) { m_pollIntervalMs = ms > 0 ? ms : 1; }
+    // 两次轮询之间的等待；默认 sleep，调用方可换成处理事件
+    void setIdle(std::function<void(int ms)> idle) { m_idle = std::move(idle); }
+    // 任务结束（Done/Failed/Skipped）时回调，用于向界面报告单设备耗时
+    void setOnFinished(std::function<void(const ConnectReport&)> cb) { m_onFinished = std::move(cb); }
+
+    // overallTimeoutMs <= 0 不设总超时；返回顺序与 addTask 一致
+    std::vector<ConnectReport> run(int overallTimeoutMs = 0);
+    int64_t elapsedMs() const { return m_elapsedMs; }
+
+private:
+    std::vector<ConnectTask> m_tasks;
+    int m_pollIntervalMs{50};
+    std::function<void(int)> m_idle;
+    std::function<void(const ConnectReport&)> m_onFinished;
+    int64_t m_elapsedMs{0};
+};
+
+} // namespace devices
@@ -0,0 +1,82 @@
+#include "DeviceStateAwait.h"
+
+#include <QEventLoop>
+#include <QTimer>
+
+#include <atomic>
+
+namespace devices {
+
+bool awaitDeviceState(DeviceRole role,
+                      const Predicate& predicate,
+                      int timeoutMs,
+                      const std::function<bool()>& abort,
+                      DeviceState* out)
+{
+    DeviceStateBus& bus = DeviceStateBus::instance();
+    DeviceState state = bus.snapshot(role);
+    if (predicate && predicate(state))
+    {
+        if (out != nullptr)
+            *out = state;
+        return true;
+    }
+    if (!predicate || timeoutMs <= 0 || (abort && abort()))
+    {
+        if (out != nullptr)
+            *out = state;
+        return false;
+    }
+
+    QEventLoop loop;
+    bool satisfied = false;
+    auto recheck = [&]() {
+        state = bus.snapshot(role);
+        if (predicate(state))
+        {
+            satisfied = true;
+            loop.quit();
+        }
+        else if (abort && abort())
+        {
+            loop.quit();
+        }
+    };
+
+    // 高频属性（坐标每秒数次）合并成一次复核
+    std::atomic<bool> queued{false};
+    const int token = bus.subscribe([&, role](DeviceRole changed, const DeviceState&) {
+        if (changed != role || queued.exchange(true))
+            return;
+        QMetaObject::invokeMethod(&loop, [&]() {
+            queued = false;
+            recheck();
+        }, Qt::QueuedConnection);
+    });
+
+    QTimer deadline;
+    deadline.setSingleShot(true);
+    QObject::connect(&deadline, &QTimer::timeout, &loop, &QEventLoop::quit);
+    // 兜底复核：abort 标志，以及 predicate 里自带的回退判断（驱动不上报相应属性时）
+    QTimer recheckTimer;
+    recheckTimer.setInterval(200);
+    QObject::connect(&recheckTimer, &QTimer::timeout, &loop, recheck);
+
+    deadline.start(timeoutMs);
+    recheckTimer.start();
+    // 订阅前可能刚好变化过
+    recheck();
+    if (!satisfied && !(abort && abort()))
+        loop.exec();
+
+    // unsubscribe 返回后不会再有新的投递；已投递未执行的随 loop 析构丢弃
+    bus.unsubscribe(token);
+    recheckTimer.stop();
+    deadline.stop();
+
+    if (out != nullptr)
+        *out = state;
+    return satisfied;
+}
+
+} // namespace devices
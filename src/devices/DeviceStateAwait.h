@@ -0,0 +1,19 @@
+#pragma once
+
+#include "DeviceStateBus.h"
+
+#include <functional>
+
+namespace devices {
+
+// 在调用线程的事件循环里等待 role 的状态满足 predicate（主线程/有事件循环的线程用）：
+// - 总线回调把复核投递（QueuedConnection）到本线程，状态一变立即检查，不再定时轮询
+// - 另外每 200ms 兜底复核一次 predicate 与 abort；abort 返回 true 即放弃等待（如用户停止流程）
+// 满足返回 true；超时或中止返回 false。out 为返回时的状态
+bool awaitDeviceState(DeviceRole role,
+                      const Predicate& predicate,
+                      int timeoutMs,
+                      const std::function<bool()>& abort = {},
+                      DeviceState* out = nullptr);
+
+} // namespace devices
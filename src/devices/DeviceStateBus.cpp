@@ -0,0 +1,226 @@
+#include "DeviceStateBus.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <vector>
+
+namespace devices {
+
+namespace {
+
+int64_t nowMs()
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+// 未绑定 INDI 设备的角色（SDK 相机等）使用的内部键，'@' 不会出现在 INDI 设备名里
+std::string roleSlotKey(DeviceRole role)
+{
+    return std::string("@") + roleName(role);
+}
+
+} // namespace
+
+const char* roleName(DeviceRole role)
+{
+    switch (role)
+    {
+    case DeviceRole::Mount:      return "Mount";
+    case DeviceRole::MainCamera: return "MainCamera";
+    case DeviceRole::Guider:     return "Guider";
+    case DeviceRole::Focuser:    return "Focuser";
+    case DeviceRole::PoleCamera: return "PoleCamera";
+    default:                     return "Unknown";
+    }
+}
+
+DeviceStateBus& DeviceStateBus::instance()
+{
+    static DeviceStateBus bus;
+    return bus;
+}
+
+std::string DeviceStateBus::keyForRoleLocked(DeviceRole role) const
+{
+    const int index = static_cast<int>(role);
+    if (index < 0 || index >= static_cast<int>(DeviceRole::Count))
+        return std::string();
+    return m_roles[index].empty() ? roleSlotKey(role) : m_roles[index];
+}
+
+void DeviceStateBus::bindRole(DeviceRole role, const std::string& deviceName)
+{
+    const int index = static_cast<int>(role);
+    if (index < 0 || index >= static_cast<int>(DeviceRole::Count))
+        return;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_roles[index] == deviceName)
+            return;
+        m_roles[index] = deviceName;
+    }
+    m_cv.notify_all();
+}
+
+std::string DeviceStateBus::deviceForRole(DeviceRole role) const
+{
+    const int index = static_cast<int>(role);
+    if (index < 0 || index >= static_cast<int>(DeviceRole::Count))
+        return std::string();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_roles[index];
+}
+
+void DeviceStateBus::update(const std::string& deviceName, const Mutator& mutator)
+{
+    if (deviceName.empty() || !mutator)
+        return;
+    DeviceState copy;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        DeviceState& state = m_states[deviceName];
+        state.deviceName = deviceName;
+        mutator(state);
+        ++state.version;
+        state.updatedMs = nowMs();
+        copy = state;
+    }
+    m_cv.notify_all();
+    notify(deviceName, copy);
+}
+
+void DeviceStateBus::updateRole(DeviceRole role, const Mutator& mutator)
+{
+    std::string key;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        key = keyForRoleLocked(role);
+    }
+    update(key, mutator);
+}
+
+DeviceState DeviceStateBus::snapshot(DeviceRole role) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_states.find(keyForRoleLocked(role));
+    return it == m_states.end() ? DeviceState() : it->second;
+}
+
+bool DeviceStateBus::hasState(DeviceRole role) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_states.count(keyForRoleLocked(role)) > 0;
+}
+
+bool DeviceStateBus::waitFor(DeviceRole role, const Predicate& predicate, int timeoutMs, DeviceState* out)
+{
+    if (!predicate)
+        return false;
+    std::unique_lock<std::mutex> lock(m_mutex);
+    const uint64_t generation = m_cancelGeneration;
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs > 0 ? timeoutMs : 0);
+    bool satisfied = false;
+    DeviceState current;
+
+    auto evaluate = [&]() {
+        if (m_cancelGeneration != generation)
+            return true;
+        auto it = m_states.find(keyForRoleLocked(role));
+        current = it == m_states.end() ? DeviceState() : it->second;
+        satisfied = predicate(current);
+        return satisfied;
+    };
+
+    m_cv.wait_until(lock, deadline, evaluate);
+    if (out != nullptr)
+        *out = current;
+    return satisfied && m_cancelGeneration == generation;
+}
+
+void DeviceStateBus::cancelWaits()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ++m_cancelGeneration;
+    }
+    m_cv.notify_all();
+}
+
+int DeviceStateBus::subscribe(Listener listener)
+{
+    if (!listener)
+        return 0;
+    std::lock_guard<std::mutex> lock(m_listenerMutex);
+    const int token = m_nextToken++;
+    m_listeners[token] = std::move(listener);
+    return token;
+}
+
+void DeviceStateBus::unsubscribe(int token)
+{
+    std::lock_guard<std::mutex> lock(m_listenerMutex);
+    m_listeners.erase(token);
+}
+
+void DeviceStateBus::notify(const std::string& key, const DeviceState& state)
+{
+    std::vector<DeviceRole> roles;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (int i = 0; i < static_cast<int>(DeviceRole::Count); ++i)
+        {
+            const DeviceRole role = static_cast<DeviceRole>(i);
+            if (keyForRoleLocked(role) == key)
+                roles.push_back(role);
+        }
+    }
+    if (roles.empty())
+        return;
+
+    std::lock_guard<std::mutex> lock(m_listenerMutex);
+    for (const DeviceRole role : roles)
+    {
+        for (const auto& entry : m_listeners)
+            entry.second(role, state);
+    }
+}
+
+void DeviceStateBus::clear()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_states.clear();
+        for (auto& name : m_roles)
+            name.clear();
+        ++m_cancelGeneration;
+    }
+    m_cv.notify_all();
+}
+
+namespace cond {
+
+Predicate mountIdle()
+{
+    return [](const DeviceState& state) {
+        return state.mount.eqState != PropState::Unknown && !state.mount.moving();
+    };
+}
+
+Predicate exposureDone(uint64_t afterSeq)
+{
+    return [afterSeq](const DeviceState& state) { return state.camera.imageSeq > afterSeq; };
+}
+
+Predicate focuserAt(int position, int tolerance)
+{
+    return [position, tolerance](const DeviceState& state) {
+        return state.focuser.hasPosition && state.focuser.state != PropState::Busy &&
+               std::abs(state.focuser.position - position) <= tolerance;
+    };
+}
+
+} // namespace cond
+
+} // namespace devices
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+
+namespace devices {
+
+// 与 INDI IPState 一一对应（不依赖 INDI 头，便于单测）
+enum class PropState {
+    Unknown,
+    Idle,
+    Ok,
+    Busy,
+    Alert,
+};
+
+enum class DeviceRole {
+    Mount,
+    MainCamera,
+    Guider,
+    Focuser,
+    PoleCamera,
+    Count,
+};
+
+const char* roleName(DeviceRole role);
+
+struct MountSnapshot {
+    bool hasCoord{false};
+    double raHours{0.0};
+    double decDeg{0.0};
+    PropState eqState{PropState::Unknown};   ///< EQUATORIAL_EOD_COORD 状态：Busy 表示 GOTO 中
+    PropState motionNS{PropState::Unknown};  ///< TELESCOPE_MOTION_NS
+    PropState motionWE{PropState::Unknown};  ///< TELESCOPE_MOTION_WE
+    bool parked{false};
+    bool tracking{false};
+    int pierSide{-1};                        ///< -1 未知，0 WEST，1 EAST
+
+    bool moving() const
+    {
+        return eqState == PropState::Busy || motionNS == PropState::Busy || motionWE == PropState::Busy;
+    }
+};
+
+struct CameraSnapshot {
+    PropState exposureState{PropState::Unknown};  ///< CCD_EXPOSURE 状态
+    double exposureLeftSec{0.0};
+    uint64_t imageSeq{0};                         ///< 每出一张图 +1
+    std::string lastImagePath;
+};
+
+struct FocuserSnapshot {
+    bool hasPosition{false};
+    int position{0};
+    PropState state{PropState::Unknown};          ///< ABS_FOCUS_POSITION 状态
+};
+
+struct DeviceState {
+    std::string deviceName;
+    uint64_t version{0};      ///< 每次更新 +1
+    int64_t updatedMs{0};     ///< steady_clock 毫秒
+    MountSnapshot mount;
+    CameraSnapshot camera;
+    FocuserSnapshot focuser;
+};
+
+using Predicate = std::function<bool(const DeviceState&)>;
+using Mutator = std::function<void(DeviceState&)>;
+using Listener = std::function<void(DeviceRole, const DeviceState&)>;
+
+// 设备状态总线：
+// - 由 MyClient::updateProperty/newProperty 与 SDK 回调按设备名写入，设备绑定角色后按角色读取
+// - waitFor 供工作线程阻塞等待条件（条件变量，状态一变即唤醒，不再轮询）
+// - subscribe 的回调在写入线程执行，且不持有状态锁；回调内不得 subscribe/unsubscribe
+// - 主线程等待请用 DeviceStateAwait.h 的 awaitDeviceState（事件循环，不阻塞界面）
+class DeviceStateBus
+{
+public:
+    static DeviceStateBus& instance();
+
+    // deviceName 为空表示解绑；绑定/解绑同样唤醒等待者
+    void bindRole(DeviceRole role, const std::string& deviceName);
+    std::string deviceForRole(DeviceRole role) const;
+
+    void update(const std::string& deviceName, const Mutator& mutator);
+    // SDK 直连设备没有 INDI 设备名：角色未绑定时写入该角色自己的槽位
+    void updateRole(DeviceRole role, const Mutator& mutator);
+
+    DeviceState snapshot(DeviceRole role) const;
+    bool hasState(DeviceRole role) const;
+
+    // 条件满足返回 true；超时或 cancelWaits() 返回 false。out 为返回时的状态
+    bool waitFor(DeviceRole role, const Predicate& predicate, int timeoutMs, DeviceState* out = nullptr);
+    // 让所有正在 waitFor 的线程立即返回 false（停止流程/关闭时）
+    void cancelWaits();
+
+    int subscribe(Listener listener);
+    // 返回后保证该回调不再被调用
+    void unsubscribe(int token);
+
+    void clear();
+
+private:
+    DeviceStateBus() = default;
+
+    std::string keyForRoleLocked(DeviceRole role) const;
+    void notify(const std::string& key, const DeviceState& state);
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::map<std::string, DeviceState> m_states;
+    std::string m_roles[static_cast<int>(DeviceRole::Count)];
+    uint64_t m_cancelGeneration{0};
+
+    std::mutex m_listenerMutex;  // 回调期间持有，unsubscribe 借此等待正在执行的回调结束
+    std::map<int, Listener> m_listeners;
+    int m_nextToken{1};
+};
+
+// 常用等待条件
+namespace cond {
+
+// 赤道仪静止（GOTO 与手动移动都已结束）；从未收到坐标属性时视为未知，不满足
+Predicate mountIdle();
+// 在 afterSeq 之后又出了一张图
+Predicate exposureDone(uint64_t afterSeq);
+// 调焦器到达 position（±tolerance）且不再忙
+Predicate focuserAt(int position, int tolerance);
+
+} // namespace cond
+
+} // namespace devices
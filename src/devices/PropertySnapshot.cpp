@@ -0,0 +1,52 @@
+#include "PropertySnapshot.h"
+
+namespace devices {
+
+int PropertySnapshotStore::slotFor(const std::string& deviceName)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_byName.find(deviceName);
+    if (it != m_byName.end())
+        return it->second;
+    const int slot = static_cast<int>(m_slots.size());
+    m_slots.emplace_back();
+    m_byName.emplace(deviceName, slot);
+    return slot;
+}
+
+int PropertySnapshotStore::findSlot(const std::string& deviceName) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_byName.find(deviceName);
+    return it == m_byName.end() ? -1 : it->second;
+}
+
+PropertySnapshot PropertySnapshotStore::snapshot(int slot) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (slot < 0 || slot >= static_cast<int>(m_slots.size()))
+        return PropertySnapshot();
+    return m_slots[slot];
+}
+
+void PropertySnapshotStore::reset(int slot)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (slot >= 0 && slot < static_cast<int>(m_slots.size()))
+        m_slots[slot] = PropertySnapshot();
+}
+
+void PropertySnapshotStore::clear()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto& slot : m_slots)
+        slot = PropertySnapshot();
+}
+
+uint64_t PropertySnapshotStore::version() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_version;
+}
+
+} // namespace devices
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace devices {
+
+// 带版本的属性值：version 全局单调递增，值真正变化时才更新；0 表示从未收到
+template <typename T>
+struct Versioned {
+    T value{};
+    uint64_t version{0};
+
+    bool valid() const { return version != 0; }
+};
+
+struct EqCoord {
+    double raHours{0.0};
+    double decDeg{0.0};
+
+    bool operator==(const EqCoord& other) const { return raHours == other.raHours && decDeg == other.decDeg; }
+    bool operator!=(const EqCoord& other) const { return !(*this == other); }
+};
+
+// 每台设备一份的扁平快照，只收定时器里高频读取的属性
+struct PropertySnapshot {
+    // 赤道仪
+    Versioned<EqCoord> eqCoord;     ///< EQUATORIAL_EOD_COORD（JNow，小时/度）
+    Versioned<bool> eqBusy;         ///< EQUATORIAL_EOD_COORD 状态为 Busy（GOTO 中）
+    Versioned<bool> parked;         ///< TELESCOPE_PARK
+    Versioned<bool> tracking;       ///< TELESCOPE_TRACK_STATE
+    Versioned<int> pierSide;        ///< TELESCOPE_PIER_SIDE：0 WEST，1 EAST，-1 都未选中
+    // 相机
+    Versioned<double> ccdTemperature;  ///< CCD_TEMPERATURE
+    // 调焦器
+    Versioned<int> focusPosition;   ///< ABS_FOCUS_POSITION
+};
+
+// 属性快照存储：
+// - 写入方（INDI 回调线程）按设备名取槽位并 set，值不变时不升版本
+// - 读取方持槽位号直接按下标读，不做属性名/设备名的字符串查找
+// - 槽位一经分配不回收（设备数很少），reset 只清空值
+class PropertySnapshotStore
+{
+public:
+    // 设备名 -> 槽位；不存在时分配
+    int slotFor(const std::string& deviceName);
+    // 只查不分配；不存在返回 -1
+    int findSlot(const std::string& deviceName) const;
+
+    // 返回值是否变化（变化才升版本）
+    template <typename T>
+    bool set(int slot, Versioned<T> PropertySnapshot::*field, const T& value)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (slot < 0 || slot >= static_cast<int>(m_slots.size()))
+            return false;
+        Versioned<T>& entry = m_slots[slot].*field;
+        if (entry.valid() && entry.value == value)
+            return false;
+        entry.value = value;
+        entry.version = ++m_version;
+        return true;
+    }
+
+    template <typename T>
+    Versioned<T> get(int slot, Versioned<T> PropertySnapshot::*field) const
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (slot < 0 || slot >= static_cast<int>(m_slots.size()))
+            return Versioned<T>();
+        return m_slots[slot].*field;
+    }
+
+    PropertySnapshot snapshot(int slot) const;
+    // 设备断开/属性被删除时清空该设备的值，读取方随即回退到直接读属性
+    void reset(int slot);
+    void clear();
+
+    uint64_t version() const;
+
+private:
+    mutable std::mutex m_mutex;
+    std::vector<PropertySnapshot> m_slots;
+    std::unordered_map<std::string, int> m_byName;
+    uint64_t m_version{0};
+};
+
+} // namespace devices
@@ -0,0 +1,204 @@
+#include "FitsMemoryReader.h"
+
+#include <cstring>
+
+namespace fits {
+
+namespace {
+
+void setError(std::string* error, const std::string& message, int status = 0)
+{
+    if (error == nullptr)
+        return;
+    *error = message;
+    if (status != 0)
+    {
+        char text[FLEN_STATUS] = {0};
+        fits_get_errstatus(status, text);
+        *error += std::string(" (") + text + ")";
+    }
+}
+
+// 结构性/压缩相关关键字由写盘端重新生成，不进模板
+bool isStructuralKey(const char* key)
+{
+    static const char* const exact[] = {
+        "SIMPLE", "BITPIX", "NAXIS", "EXTEND", "BZERO", "BSCALE", "END", "XTENSION",
+        "PCOUNT", "GCOUNT", "TFIELDS", "THEAP", "EXTNAME", "CHECKSUM", "DATASUM",
+        "COMMENT", "HISTORY", "",
+    };
+    for (const char* name : exact)
+    {
+        if (std::strcmp(key, name) == 0)
+            return true;
+    }
+    static const char* const prefixes[] = {
+        "NAXIS", "TTYPE", "TFORM", "TUNIT", "ZIMAGE", "ZBITPIX", "ZNAXIS", "ZTILE", "ZCMPTYPE",
+        "ZNAME", "ZVAL", "ZQUANTIZ", "ZDITHER", "ZSIMPLE", "ZEXTEND", "ZBLOCKED", "ZTENSION",
+        "ZPCOUNT", "ZGCOUNT", "ZHECKSUM", "ZDATASUM",
+    };
+    for (const char* prefix : prefixes)
+    {
+        if (std::strncmp(key, prefix, std::strlen(prefix)) == 0)
+            return true;
+    }
+    return false;
+}
+
+void copyHeader(fitsfile* fptr, HeaderTemplate& header)
+{
+    int status = 0;
+    int keyCount = 0;
+    if (fits_get_hdrspace(fptr, &keyCount, nullptr, &status) != 0)
+        return;
+
+    for (int i = 1; i <= keyCount; ++i)
+    {
+        char name[FLEN_KEYWORD] = {0};
+        char value[FLEN_VALUE] = {0};
+        char comment[FLEN_COMMENT] = {0};
+        status = 0;
+        if (fits_read_keyn(fptr, i, name, value, comment, &status) != 0 || isStructuralKey(name) || value[0] == '\0')
+            continue;
+
+        char type = 0;
+        if (fits_get_keytype(value, &type, &status) != 0)
+            continue;
+        switch (type)
+        {
+        case 'C': {
+            char text[FLEN_VALUE] = {0};
+            if (fits_read_key(fptr, TSTRING, name, text, nullptr, &status) == 0)
+                header.setString(name, text, comment);
+            break;
+        }
+        case 'L': {
+            int flag = 0;
+            if (fits_read_key(fptr, TLOGICAL, name, &flag, nullptr, &status) == 0)
+                header.setLogical(name, flag != 0, comment);
+            break;
+        }
+        case 'I': {
+            LONGLONG number = 0;
+            if (fits_read_key(fptr, TLONGLONG, name, &number, nullptr, &status) == 0)
+                header.setLong(name, static_cast<long long>(number), comment);
+            break;
+        }
+        case 'F': {
+            double number = 0.0;
+            if (fits_read_key(fptr, TDOUBLE, name, &number, nullptr, &status) == 0)
+                header.setDouble(name, number, comment);
+            break;
+        }
+        default:
+            break;
+        }
+    }
+}
+
+} // namespace
+
+bool readFitsFromMemory(const void* data, size_t size, SdkFrameData& frame, HeaderTemplate* header, std::string* error)
+{
+    if (data == nullptr || size < 2880)
+    {
+        setError(error, "FITS buffer is empty or shorter than one block");
+        return false;
+    }
+
+    // READONLY 下 CFITSIO 不会 realloc，缓冲区仍归调用方（INDI BLOB）所有
+    void* buffer = const_cast<void*>(data);
+    size_t bufferSize = size;
+    fitsfile* fptr = nullptr;
+    int status = 0;
+    if (fits_open_memfile(&fptr, "indi_blob.fits", READONLY, &buffer, &bufferSize, 0, nullptr, &status) != 0)
+    {
+        setError(error, "fits_open_memfile failed", status);
+        return false;
+    }
+
+    // 主 HDU 无数据（压缩图像/扩展图像）时往后找第一个图像 HDU
+    int naxis = 0;
+    long naxes[3] = {0, 0, 0};
+    int hduCount = 0;
+    fits_get_num_hdus(fptr, &hduCount, &status);
+    for (int hdu = 1; hdu <= hduCount && status == 0; ++hdu)
+    {
+        int hduType = 0;
+        if (fits_movabs_hdu(fptr, hdu, &hduType, &status) != 0)
+            break;
+        if (hduType != IMAGE_HDU && !fits_is_compressed_image(fptr, &status))
+            continue;
+        fits_get_img_dim(fptr, &naxis, &status);
+        if (naxis > 0)
+            break;
+    }
+    if (status != 0 || naxis <= 0)
+    {
+        setError(error, "no image HDU in FITS buffer", status);
+        status = 0;
+        fits_close_file(fptr, &status);
+        return false;
+    }
+
+    int bitpix = 0;
+    fits_get_img_equivtype(fptr, &bitpix, &status);
+    fits_get_img_size(fptr, 3, naxes, &status);
+    if (status != 0 || naxis != 2 || naxes[0] <= 0 || naxes[1] <= 0)
+    {
+        setError(error, "only single-plane 2D images are supported (NAXIS=" + std::to_string(naxis) + ")", status);
+        status = 0;
+        fits_close_file(fptr, &status);
+        return false;
+    }
+    if (bitpix != BYTE_IMG && bitpix != USHORT_IMG && bitpix != SHORT_IMG)
+    {
+        setError(error, "unsupported BITPIX " + std::to_string(bitpix));
+        status = 0;
+        fits_close_file(fptr, &status);
+        return false;
+    }
+
+    const long width = naxes[0];
+    const long height = naxes[1];
+    const LONGLONG pixelCount = static_cast<LONGLONG>(width) * height;
+    long firstPixel[2] = {1, 1};
+    SdkFrameData decoded;
+    decoded.width = static_cast<int>(width);
+    decoded.height = static_cast<int>(height);
+    decoded.channels = 1;
+
+    if (bitpix == BYTE_IMG)
+    {
+        auto raw = std::make_shared<std::vector<unsigned char>>(static_cast<size_t>(pixelCount));
+        fits_read_pix(fptr, TBYTE, firstPixel, pixelCount, nullptr, raw->data(), nullptr, &status);
+        decoded.bpp = 8;
+        decoded.rawBytes = raw->size();
+        decoded.rawBuffer = std::move(raw);
+    }
+    else
+    {
+        decoded.pixels.resize(static_cast<size_t>(pixelCount));
+        fits_read_pix(fptr, TUSHORT, firstPixel, pixelCount, nullptr, decoded.pixels.data(), nullptr, &status);
+        // SHORT_IMG（无 BZERO 的有符号 16bit）里的负值按 TUSHORT 读会被截到 0 并报 NUM_OVERFLOW，像素仍然可用
+        if (status == NUM_OVERFLOW)
+            status = 0;
+        decoded.bpp = 16;
+    }
+    if (status != 0)
+    {
+        setError(error, "fits_read_pix failed", status);
+        status = 0;
+        fits_close_file(fptr, &status);
+        return false;
+    }
+
+    if (header != nullptr)
+        copyHeader(fptr, *header);
+
+    fits_close_file(fptr, &status);
+    frame = std::move(decoded);
+    return true;
+}
+
+} // namespace fits
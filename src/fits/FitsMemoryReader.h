@@ -0,0 +1,22 @@
+#pragma once
+
+#include "FitsWriter.h"
+
+#include <cstddef>
+#include <string>
+
+namespace fits {
+
+// 从内存中的 FITS 字节流（INDI BLOB）解码图像，不落盘：
+// - fits_open_memfile 只读打开；压缩图像（.fits.fz）自动定位到第一个含图像数据的 HDU
+// - 16bit 按 BZERO 还原为无符号放入 frame.pixels；8bit 放入 frame.rawBuffer（bpp=8），
+//   与 SDK 取帧的 SdkFrameData 约定一致，下游（归档 FitsWriter、saveFitsAsPNG_FromSdkFrame）直接可用
+// - 只支持单通道 2D 整数图像；NAXIS=3/浮点图像返回 false，调用方回退到按文件读取
+// header 非空时复制驱动写的非结构性关键字（EXPTIME/DATE-OBS/CCD-TEMP/GAIN ...），归档时原样写回
+bool readFitsFromMemory(const void* data,
+                        size_t size,
+                        SdkFrameData& frame,
+                        HeaderTemplate* header = nullptr,
+                        std::string* error = nullptr);
+
+} // namespace fits
@@ -0,0 +1,460 @@
+#include "FitsWriter.h"
+
+#include "../Logger.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <filesystem>
+
+namespace fits {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double msSince(Clock::time_point t0)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+}
+
+int cfitsioCompressionType(Compression c)
+{
+    switch (c) {
+        case Compression::Rice: return RICE_1;
+        case Compression::Gzip: return GZIP_1;
+        default: return 0;
+    }
+}
+
+std::string cfitsioErrorText(const std::string& stage, int status)
+{
+    char text[FLEN_STATUS] = {0};
+    fits_get_errstatus(status, text);
+    return stage + " failed, status=" + std::to_string(status) + " (" + text + ")";
+}
+
+// 写入核心：所有入口（SdkFrameData / cv::Mat / 后台队列）最终都走这里，保证头、压缩与原子替换行为一致
+bool writeImage(int bitpix,
+                int datatype,
+                long width,
+                long height,
+                const void* pixels,
+                const std::string& path,
+                const HeaderTemplate& header,
+                const WriteOptions& options,
+                WriteResult& r)
+{
+    const auto t0 = Clock::now();
+    r.path = path;
+    r.compression = options.compression;
+
+    const std::string tmpPath = options.atomicReplace ? (path + ".part") : path;
+    // '!' 前缀：目标已存在时由 CFITSIO 覆盖
+    const std::string createName = "!" + tmpPath;
+
+    fitsfile* fptr = nullptr;
+    int status = 0;
+    long naxes[2] = {width, height};
+
+    auto fail = [&](const std::string& stage) {
+        r.success = false;
+        r.error = cfitsioErrorText(stage, status);
+        if (fptr) {
+            int closeStatus = 0;
+            fits_close_file(fptr, &closeStatus);
+        }
+        std::error_code ec;
+        std::filesystem::remove(tmpPath, ec);
+        r.timing.totalMs = msSince(t0);
+        return false;
+    };
+
+    if (fits_create_file(&fptr, createName.c_str(), &status)) {
+        fptr = nullptr;
+        return fail("fits_create_file");
+    }
+    if (options.compression != Compression::None &&
+        fits_set_compression_type(fptr, cfitsioCompressionType(options.compression), &status)) {
+        return fail("fits_set_compression_type");
+    }
+    if (fits_create_img(fptr, bitpix, 2, naxes, &status)) {
+        return fail("fits_create_img");
+    }
+    r.timing.createMs = msSince(t0);
+
+    const auto tHeader = Clock::now();
+    status = header.apply(fptr);
+    if (status) {
+        return fail("fits_update_key");
+    }
+    r.timing.headerMs = msSince(tHeader);
+
+    const auto tPixels = Clock::now();
+    long fpixel[2] = {1, 1};
+    if (fits_write_pix(fptr, datatype, fpixel, width * height, const_cast<void*>(pixels), &status)) {
+        return fail("fits_write_pix");
+    }
+    r.timing.pixelsMs = msSince(tPixels);
+
+    const auto tClose = Clock::now();
+    if (fits_close_file(fptr, &status)) {
+        fptr = nullptr;
+        return fail("fits_close_file");
+    }
+    fptr = nullptr;
+
+    if (options.atomicReplace) {
+        std::error_code ec;
+        std::filesystem::rename(tmpPath, path, ec);
+        if (ec) {
+            std::filesystem::remove(tmpPath, ec);
+            r.success = false;
+            r.error = "rename " + tmpPath + " -> " + path + " failed";
+            r.timing.totalMs = msSince(t0);
+            return false;
+        }
+    }
+    r.timing.closeMs = msSince(tClose);
+
+    std::error_code sizeEc;
+    const auto bytes = std::filesystem::file_size(path, sizeEc);
+    r.timing.fileBytes = sizeEc ? 0 : static_cast<uint64_t>(bytes);
+    r.timing.totalMs = msSince(t0);
+    r.success = true;
+    return true;
+}
+
+} // namespace
+
+Compression compressionFromString(const std::string& name)
+{
+    std::string n = name;
+    std::transform(n.begin(), n.end(), n.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    if (n == "rice" || n == "rice_1")
+        return Compression::Rice;
+    if (n == "gzip" || n == "gzip_1")
+        return Compression::Gzip;
+    return Compression::None;
+}
+
+const char* compressionName(Compression c)
+{
+    switch (c) {
+        case Compression::Rice: return "rice";
+        case Compression::Gzip: return "gzip";
+        default: return "none";
+    }
+}
+
+HeaderTemplate::Card& HeaderTemplate::upsert(const std::string& key)
+{
+    for (auto& c : m_cards) {
+        if (c.key == key)
+            return c;
+    }
+    m_cards.emplace_back();
+    m_cards.back().key = key;
+    return m_cards.back();
+}
+
+void HeaderTemplate::setString(const std::string& key, const std::string& value, const std::string& comment)
+{
+    Card& c = upsert(key);
+    c.kind = Card::Kind::String;
+    c.s = value;
+    c.comment = comment;
+}
+
+void HeaderTemplate::setDouble(const std::string& key, double value, const std::string& comment)
+{
+    Card& c = upsert(key);
+    c.kind = Card::Kind::Double;
+    c.d = value;
+    c.comment = comment;
+}
+
+void HeaderTemplate::setLong(const std::string& key, long long value, const std::string& comment)
+{
+    Card& c = upsert(key);
+    c.kind = Card::Kind::Long;
+    c.l = value;
+    c.comment = comment;
+}
+
+void HeaderTemplate::setLogical(const std::string& key, bool value, const std::string& comment)
+{
+    Card& c = upsert(key);
+    c.kind = Card::Kind::Logical;
+    c.l = value ? 1 : 0;
+    c.comment = comment;
+}
+
+bool HeaderTemplate::contains(const std::string& key) const
+{
+    return std::any_of(m_cards.begin(), m_cards.end(), [&](const Card& c) { return c.key == key; });
+}
+
+int HeaderTemplate::apply(fitsfile* fptr) const
+{
+    int status = 0;
+    for (const Card& c : m_cards) {
+        char* key = const_cast<char*>(c.key.c_str());
+        char* comment = c.comment.empty() ? nullptr : const_cast<char*>(c.comment.c_str());
+        switch (c.kind) {
+            case Card::Kind::String:
+                fits_update_key(fptr, TSTRING, key, const_cast<char*>(c.s.c_str()), comment, &status);
+                break;
+            case Card::Kind::Double: {
+                double v = c.d;
+                fits_update_key(fptr, TDOUBLE, key, &v, comment, &status);
+                break;
+            }
+            case Card::Kind::Long: {
+                LONGLONG v = c.l;
+                fits_update_key(fptr, TLONGLONG, key, &v, comment, &status);
+                break;
+            }
+            case Card::Kind::Logical: {
+                int v = c.l ? 1 : 0;
+                fits_update_key(fptr, TLOGICAL, key, &v, comment, &status);
+                break;
+            }
+        }
+        if (status)
+            break;
+    }
+    return status;
+}
+
+bool writeFrame(const SdkFrameData& frame,
+                const std::string& path,
+                const HeaderTemplate& header,
+                const WriteOptions& options,
+                WriteResult* out)
+{
+    WriteResult local;
+    WriteResult& r = out ? *out : local;
+    r.path = path;
+
+    const bool hasVecPixels = !frame.pixels.empty();
+    const bool hasRawPixels = (frame.rawBuffer != nullptr && frame.rawBytes > 0);
+    if (frame.width <= 0 || frame.height <= 0 || (!hasVecPixels && !hasRawPixels)) {
+        r.success = false;
+        r.error = "invalid frame: size=" + std::to_string(frame.width) + "x" + std::to_string(frame.height) +
+                  " pixels=" + std::to_string(frame.pixels.size()) +
+                  " rawBytes=" + std::to_string(frame.rawBytes) +
+                  " bpp=" + std::to_string(frame.bpp) +
+                  " ch=" + std::to_string(frame.channels);
+        return false;
+    }
+
+    const size_t pixelCount = static_cast<size_t>(frame.width) * static_cast<size_t>(frame.height);
+    if (hasVecPixels) {
+        if (frame.pixels.size() < pixelCount) {
+            r.success = false;
+            r.error = "pixels too small: need " + std::to_string(pixelCount) +
+                      " have " + std::to_string(frame.pixels.size());
+            return false;
+        }
+        return writeImage(USHORT_IMG, TUSHORT, frame.width, frame.height, frame.pixels.data(),
+                          path, header, options, r);
+    }
+
+    if (frame.channels != 1 || (frame.bpp != 16 && frame.bpp != 8)) {
+        r.success = false;
+        r.error = "unsupported rawBuffer format: bpp=" + std::to_string(frame.bpp) +
+                  " channels=" + std::to_string(frame.channels);
+        return false;
+    }
+    const size_t needBytes = pixelCount * (frame.bpp == 16 ? sizeof(uint16_t) : sizeof(uint8_t));
+    if (frame.rawBuffer->size() < needBytes || frame.rawBytes < needBytes) {
+        r.success = false;
+        r.error = "rawBuffer too small: needBytes=" + std::to_string(needBytes) +
+                  " rawBytes=" + std::to_string(frame.rawBytes) +
+                  " bufSize=" + std::to_string(frame.rawBuffer->size());
+        return false;
+    }
+    if (frame.bpp == 8) {
+        return writeImage(BYTE_IMG, TBYTE, frame.width, frame.height, frame.rawBuffer->data(),
+                          path, header, options, r);
+    }
+    return writeImage(USHORT_IMG, TUSHORT, frame.width, frame.height, frame.rawBuffer->data(),
+                      path, header, options, r);
+}
+
+bool writeMat(const cv::Mat& image,
+              const std::string& path,
+              const HeaderTemplate& header,
+              const WriteOptions& options,
+              WriteResult* out)
+{
+    WriteResult local;
+    WriteResult& r = out ? *out : local;
+    r.path = path;
+
+    if (image.empty() || image.channels() != 1 ||
+        (image.depth() != CV_8U && image.depth() != CV_16U)) {
+        r.success = false;
+        r.error = "unsupported Mat: empty=" + std::string(image.empty() ? "true" : "false") +
+                  " channels=" + std::to_string(image.channels()) +
+                  " depth=" + std::to_string(image.depth());
+        return false;
+    }
+
+    // fits_write_pix 需要连续内存；ROI 子图先整理为连续
+    const cv::Mat src = image.isContinuous() ? image : image.clone();
+    if (src.depth() == CV_8U) {
+        return writeImage(BYTE_IMG, TBYTE, src.cols, src.rows, src.data, path, header, options, r);
+    }
+    return writeImage(USHORT_IMG, TUSHORT, src.cols, src.rows, src.data, path, header, options, r);
+}
+
+FitsWriter::FitsWriter(size_t capacity)
+    : m_capacity(std::max<size_t>(1, capacity))
+{
+    m_thread = std::thread(&FitsWriter::run, this);
+}
+
+FitsWriter::~FitsWriter()
+{
+    stop();
+}
+
+uint64_t FitsWriter::submit(Job job, int timeoutMs)
+{
+    if (!job.frame || job.path.empty())
+        return 0;
+
+    std::unique_lock<std::mutex> lk(m_mutex);
+    auto hasRoom = [this]() {
+        return m_stopping || (m_queue.size() + (m_busy ? 1 : 0)) < m_capacity;
+    };
+    if (timeoutMs < 0) {
+        m_cvNotFull.wait(lk, hasRoom);
+    } else if (!m_cvNotFull.wait_for(lk, std::chrono::milliseconds(timeoutMs), hasRoom)) {
+        Logger::Log("FitsWriter | queue full (" + std::to_string(m_capacity) + "), submit timed out after " +
+                        std::to_string(timeoutMs) + "ms: " + job.path,
+                    LogLevel::WARNING, DeviceType::MAIN);
+        return 0;
+    }
+    if (m_stopping)
+        return 0;
+
+    QueuedJob q;
+    q.id = m_nextId++;
+    q.job = std::move(job);
+    q.enqueuedAt = Clock::now();
+    const uint64_t id = q.id;
+    m_queue.push_back(std::move(q));
+    lk.unlock();
+    m_cvNotEmpty.notify_one();
+    return id;
+}
+
+size_t FitsWriter::pending() const
+{
+    std::lock_guard<std::mutex> lk(m_mutex);
+    return m_queue.size() + (m_busy ? 1 : 0);
+}
+
+bool FitsWriter::saturated() const
+{
+    return pending() >= m_capacity;
+}
+
+bool FitsWriter::isPendingPath(const std::string& path) const
+{
+    std::lock_guard<std::mutex> lk(m_mutex);
+    if (m_busy && m_activePath == path)
+        return true;
+    return std::any_of(m_queue.begin(), m_queue.end(), [&](const QueuedJob& q) { return q.job.path == path; });
+}
+
+bool FitsWriter::waitIdle(int timeoutMs)
+{
+    std::unique_lock<std::mutex> lk(m_mutex);
+    auto idle = [this]() { return m_queue.empty() && !m_busy; };
+    if (timeoutMs < 0) {
+        m_cvNotFull.wait(lk, idle);
+        return true;
+    }
+    return m_cvNotFull.wait_for(lk, std::chrono::milliseconds(timeoutMs), idle);
+}
+
+FitsWriter::Stats FitsWriter::stats() const
+{
+    std::lock_guard<std::mutex> lk(m_mutex);
+    return m_stats;
+}
+
+void FitsWriter::stop()
+{
+    {
+        std::lock_guard<std::mutex> lk(m_mutex);
+        m_stopping = true;
+    }
+    m_cvNotEmpty.notify_all();
+    m_cvNotFull.notify_all();
+    if (m_thread.joinable())
+        m_thread.join();
+}
+
+void FitsWriter::run()
+{
+    for (;;) {
+        QueuedJob q;
+        {
+            std::unique_lock<std::mutex> lk(m_mutex);
+            m_cvNotEmpty.wait(lk, [this]() { return m_stopping || !m_queue.empty(); });
+            // stop() 后仍把已排队的任务写完，避免退出时丢图
+            if (m_queue.empty())
+                return;
+            q = std::move(m_queue.front());
+            m_queue.pop_front();
+            m_busy = true;
+            m_activePath = q.job.path;
+        }
+
+        WriteResult r;
+        r.jobId = q.id;
+        const double queueMs = msSince(q.enqueuedAt);
+        writeFrame(*q.job.frame, q.job.path, q.job.header, q.job.options, &r);
+        r.timing.queueMs = queueMs;
+
+        if (r.success) {
+            Logger::Log("FitsWriter | saved " + r.path +
+                            " | compression=" + compressionName(r.compression) +
+                            " bytes=" + std::to_string(r.timing.fileBytes) +
+                            " queueMs=" + std::to_string(static_cast<int>(r.timing.queueMs)) +
+                            " createMs=" + std::to_string(static_cast<int>(r.timing.createMs)) +
+                            " pixelsMs=" + std::to_string(static_cast<int>(r.timing.pixelsMs)) +
+                            " closeMs=" + std::to_string(static_cast<int>(r.timing.closeMs)) +
+                            " totalMs=" + std::to_string(static_cast<int>(r.timing.totalMs)),
+                        LogLevel::INFO, DeviceType::MAIN);
+        } else {
+            Logger::Log("FitsWriter | failed " + r.path + " | " + r.error, LogLevel::ERROR, DeviceType::MAIN);
+        }
+
+        if (q.job.onDone)
+            q.job.onDone(r);
+
+        {
+            std::lock_guard<std::mutex> lk(m_mutex);
+            if (r.success) {
+                ++m_stats.written;
+                m_stats.lastTotalMs = r.timing.totalMs;
+                m_stats.avgTotalMs += (r.timing.totalMs - m_stats.avgTotalMs) / static_cast<double>(m_stats.written);
+                m_stats.maxTotalMs = std::max(m_stats.maxTotalMs, r.timing.totalMs);
+            } else {
+                ++m_stats.failed;
+            }
+            m_stats.maxQueueMs = std::max(m_stats.maxQueueMs, r.timing.queueMs);
+            m_busy = false;
+            m_activePath.clear();
+        }
+        m_cvNotFull.notify_all();
+    }
+}
+
+} // namespace fits
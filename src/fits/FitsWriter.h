@@ -0,0 +1,175 @@
+#pragma once
+
+#include "../sdks/SdkCommon.h"
+
+#include <fitsio.h>
+#include <opencv2/core/core.hpp>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace fits {
+
+// FITS 压缩方式（CFITSIO tile compression，fits_set_compression_type）
+// - None：普通主 HDU 图像
+// - Rice：RICE_1，16bit 整数图像无损，压缩/解压都快（推荐）
+// - Gzip：GZIP_1，压缩率略高但更慢
+// 压缩后图像位于第 1 个扩展 HDU，读取端需用 fits_open_image/fits_open_data 定位（Tools::readFits 已适配）。
+enum class Compression {
+    None,
+    Rice,
+    Gzip,
+};
+
+// "none"/"rice"/"gzip"（大小写不敏感），无法识别时返回 None
+Compression compressionFromString(const std::string& name);
+const char* compressionName(Compression c);
+
+// 头关键字模板：拍摄前/完成时在主线程一次性生成（望远镜、相机、滤镜、坐标等），写盘线程只负责落盘。
+// 按插入顺序写出；同名关键字再次 set 时覆盖原值。
+class HeaderTemplate
+{
+public:
+    struct Card {
+        enum class Kind { String, Double, Long, Logical };
+        std::string key;
+        Kind kind{Kind::String};
+        std::string s;
+        double d{0.0};
+        long long l{0};
+        std::string comment;
+    };
+
+    void setString(const std::string& key, const std::string& value, const std::string& comment = std::string());
+    void setDouble(const std::string& key, double value, const std::string& comment = std::string());
+    void setLong(const std::string& key, long long value, const std::string& comment = std::string());
+    void setLogical(const std::string& key, bool value, const std::string& comment = std::string());
+
+    bool contains(const std::string& key) const;
+    bool empty() const { return m_cards.empty(); }
+    const std::vector<Card>& cards() const { return m_cards; }
+
+    // 写入当前 HDU；返回 CFITSIO status（0 成功）
+    int apply(fitsfile* fptr) const;
+
+private:
+    Card& upsert(const std::string& key);
+    std::vector<Card> m_cards;
+};
+
+struct WriteOptions {
+    Compression compression{Compression::None};
+    // 先写 "<path>.part" 再 rename：读取方（前端、图库扫描、解析）永远看不到写了一半的文件
+    bool atomicReplace{true};
+};
+
+// 单个文件的分段耗时（毫秒）
+struct WriteTiming {
+    double queueMs{0.0};   ///< 排队等待（同步写入为 0）
+    double createMs{0.0};  ///< fits_create_file + 压缩设置 + fits_create_img
+    double headerMs{0.0};  ///< 头关键字
+    double pixelsMs{0.0};  ///< fits_write_pix（含压缩）
+    double closeMs{0.0};   ///< fits_close_file + rename
+    double totalMs{0.0};   ///< 从开始写到落盘完成（不含排队）
+    uint64_t fileBytes{0}; ///< 最终文件大小
+};
+
+struct WriteResult {
+    uint64_t jobId{0};
+    bool success{false};
+    std::string path;
+    std::string error;
+    Compression compression{Compression::None};
+    WriteTiming timing;
+};
+
+// 同步写入：在调用线程完成（/dev/shm 预览图等需要立刻读回的场景）
+// SdkFrameData 支持 pixels(16bit) 与 rawBuffer(8/16bit 单通道) 两种来源，与 SaveQhyFrameDataToFits 语义一致
+bool writeFrame(const SdkFrameData& frame,
+                const std::string& path,
+                const HeaderTemplate& header,
+                const WriteOptions& options,
+                WriteResult* out = nullptr);
+// cv::Mat 需为单通道 CV_8U/CV_16U
+bool writeMat(const cv::Mat& image,
+              const std::string& path,
+              const HeaderTemplate& header,
+              const WriteOptions& options,
+              WriteResult* out = nullptr);
+
+// 后台写盘服务（write-behind）：
+// - 单独线程串行写盘，调用方只交出帧的 shared_ptr（不复制像素）
+// - 有界队列：pending() 达到 capacity() 时 submit() 阻塞等待，调用方可先查 saturated() 自行推迟下一次曝光
+// - 每个文件的结果与分段耗时通过 onDone 回调返回（在写盘线程调用，需要时由调用方切回主线程）
+class FitsWriter
+{
+public:
+    using DoneCallback = std::function<void(const WriteResult&)>;
+
+    struct Job {
+        std::shared_ptr<const SdkFrameData> frame;
+        std::string path;
+        HeaderTemplate header;
+        WriteOptions options;
+        DoneCallback onDone;
+    };
+
+    struct Stats {
+        uint64_t written{0};
+        uint64_t failed{0};
+        double lastTotalMs{0.0};
+        double avgTotalMs{0.0};
+        double maxTotalMs{0.0};
+        double maxQueueMs{0.0};
+    };
+
+    explicit FitsWriter(size_t capacity = 4);
+    ~FitsWriter(); // 写完已排队任务后退出
+
+    FitsWriter(const FitsWriter&) = delete;
+    FitsWriter& operator=(const FitsWriter&) = delete;
+
+    // 入队；队列满时最多等待 timeoutMs（<0 无限等待）。返回任务 id，超时/已停止/参数无效返回 0
+    uint64_t submit(Job job, int timeoutMs = -1);
+
+    size_t capacity() const { return m_capacity; }
+    size_t pending() const;     ///< 排队中 + 正在写
+    bool saturated() const;     ///< pending() >= capacity()
+    bool isPendingPath(const std::string& path) const;
+    bool waitIdle(int timeoutMs);
+    Stats stats() const;
+
+    // 停止接收新任务，写完剩余任务后结束线程（可重复调用）
+    void stop();
+
+private:
+    struct QueuedJob {
+        uint64_t id{0};
+        Job job;
+        std::chrono::steady_clock::time_point enqueuedAt;
+    };
+
+    void run();
+
+    const size_t m_capacity;
+    mutable std::mutex m_mutex;
+    std::condition_variable m_cvNotEmpty;
+    std::condition_variable m_cvNotFull;
+    std::deque<QueuedJob> m_queue;
+    std::string m_activePath;
+    bool m_busy{false};
+    bool m_stopping{false};
+    uint64_t m_nextId{1};
+    Stats m_stats;
+    std::thread m_thread;
+};
+
+} // namespace fits
@@ -0,0 +1,96 @@
+#include "FocusTimeline.h"
+
+#include <algorithm>
+
+namespace focus {
+
+int64_t FocusTimeline::span(int64_t startMs, int64_t endMs)
+{
+    if (startMs < 0 || endMs < 0)
+        return 0;
+    return std::max<int64_t>(0, endMs - startMs);
+}
+
+void FocusTimeline::reset(int64_t startMs)
+{
+    m_points.clear();
+    m_startMs = startMs;
+}
+
+int FocusTimeline::addPoint(int position, int64_t exposureStartMs)
+{
+    Point p;
+    p.position = position;
+    p.exposureStartMs = exposureStartMs;
+    m_points.push_back(p);
+    return size() - 1;
+}
+
+void FocusTimeline::exposureDone(int index, int64_t nowMs)
+{
+    if (validIndex(index))
+        m_points[index].exposureEndMs = nowMs;
+}
+
+void FocusTimeline::analysisSpan(int index, int64_t startMs, int64_t endMs)
+{
+    if (!validIndex(index))
+        return;
+    m_points[index].analysisStartMs = startMs;
+    m_points[index].analysisEndMs = std::max(startMs, endMs);
+}
+
+void FocusTimeline::addJoinWait(int index, int64_t waitMs)
+{
+    if (validIndex(index) && waitMs > 0)
+        m_points[index].joinWaitMs += waitMs;
+}
+
+void FocusTimeline::moveStarted(int index, int64_t nowMs)
+{
+    if (!validIndex(index))
+        return;
+    m_points[index].moveStartMs = nowMs;
+    m_points[index].moveEndMs = -1;
+}
+
+void FocusTimeline::moveDone(int64_t nowMs)
+{
+    for (auto it = m_points.rbegin(); it != m_points.rend(); ++it) {
+        if (it->moveStartMs >= 0 && it->moveEndMs < 0) {
+            it->moveEndMs = std::max(nowMs, it->moveStartMs);
+            return;
+        }
+    }
+}
+
+FocusTimeline::Report FocusTimeline::report(int64_t nowMs) const
+{
+    Report r;
+    if (m_startMs < 0)
+        return r;
+    r.wallMs = std::max<int64_t>(0, nowMs - m_startMs);
+    for (int i = 0; i < size(); ++i) {
+        const Point& p = m_points[i];
+        PointReport pr;
+        pr.index = i + 1;
+        pr.position = p.position;
+        pr.exposureMs = span(p.exposureStartMs, p.exposureEndMs);
+        pr.analysisMs = span(p.analysisStartMs, p.analysisEndMs);
+        pr.moveMs = span(p.moveStartMs, p.moveEndMs);
+        pr.joinWaitMs = std::min(p.joinWaitMs, pr.analysisMs);
+        pr.savedMs = pr.analysisMs - pr.joinWaitMs;
+        r.exposureMs += pr.exposureMs;
+        r.analysisMs += pr.analysisMs;
+        r.moveMs += pr.moveMs;
+        r.joinWaitMs += pr.joinWaitMs;
+        r.savedMs += pr.savedMs;
+        r.points.push_back(pr);
+    }
+    r.sequentialMs = r.wallMs + r.savedMs;
+    if (!r.points.empty())
+        r.savedPerPointSec = r.savedMs / 1000.0 / static_cast<double>(r.points.size());
+    return r;
+}
+
+} // namespace focus
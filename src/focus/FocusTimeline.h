@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace focus {
+
+// 对焦扫描（粗调/精调）按采样点记录的时间线。
+// 流水线下第 N 点的分析（识星/SNR）与移向第 N+1 点、第 N+1 点曝光并行，只有等结果（join）的部分占用墙钟；
+// 串行时同一点的分析要整段排在移动之前，因此：
+//   savedMs      = 分析耗时 - join 等待
+//   sequentialMs = wallMs + savedMs（同样的点串行执行的估计耗时）
+class FocusTimeline
+{
+public:
+    struct PointReport {
+        int index{0};
+        int position{0};
+        int64_t exposureMs{0};
+        int64_t analysisMs{0};
+        int64_t moveMs{0};          ///< 采完本点后移向下一点
+        int64_t joinWaitMs{0};
+        int64_t savedMs{0};
+    };
+
+    struct Report {
+        int64_t wallMs{0};          ///< reset 到 report 的墙钟时间
+        int64_t sequentialMs{0};
+        int64_t savedMs{0};
+        int64_t exposureMs{0};
+        int64_t analysisMs{0};
+        int64_t moveMs{0};
+        int64_t joinWaitMs{0};
+        double savedPerPointSec{0.0};
+        std::vector<PointReport> points;
+    };
+
+    void reset(int64_t startMs);
+    bool started() const { return m_startMs >= 0; }
+    int size() const { return static_cast<int>(m_points.size()); }
+
+    // 开始在 position 曝光，返回点序号
+    int addPoint(int position, int64_t exposureStartMs);
+    void exposureDone(int index, int64_t nowMs);
+    // 分析在工作线程里计时，结果取回时一起记录
+    void analysisSpan(int index, int64_t startMs, int64_t endMs);
+    void addJoinWait(int index, int64_t waitMs);
+    // 采完 index 后开始移向下一点；moveDone 结束最近一个进行中的移动（没有则忽略）
+    void moveStarted(int index, int64_t nowMs);
+    void moveDone(int64_t nowMs);
+
+    Report report(int64_t nowMs) const;
+
+private:
+    struct Point {
+        int position{0};
+        int64_t exposureStartMs{-1};
+        int64_t exposureEndMs{-1};
+        int64_t analysisStartMs{-1};
+        int64_t analysisEndMs{-1};
+        int64_t moveStartMs{-1};
+        int64_t moveEndMs{-1};
+        int64_t joinWaitMs{0};
+    };
+
+    static int64_t span(int64_t startMs, int64_t endMs);
+    bool validIndex(int index) const { return index >= 0 && index < size(); }
+
+    std::vector<Point> m_points;
+    int64_t m_startMs{-1};
+};
+
+} // namespace focus
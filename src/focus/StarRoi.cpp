@@ -0,0 +1,311 @@
+#include "StarRoi.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace focus {
+
+namespace {
+
+double median(std::vector<double>& values)
+{
+    if (values.empty())
+        return 0.0;
+    const size_t mid = values.size() / 2;
+    std::nth_element(values.begin(), values.begin() + mid, values.end());
+    double m = values[mid];
+    if (values.size() % 2 == 0) {
+        const double lower = *std::max_element(values.begin(), values.begin() + mid);
+        m = 0.5 * (m + lower);
+    }
+    return m;
+}
+
+int alignDown(int v, int a) { return a > 1 ? (v / a) * a : v; }
+int alignUp(int v, int a) { return a > 1 ? ((v + a - 1) / a) * a : v; }
+
+RoiRect windowAt(double x, double y, int size, const RoiRect& bounds)
+{
+    RoiRect r;
+    r.width = std::min(size, bounds.width);
+    r.height = std::min(size, bounds.height);
+    r.x = static_cast<int>(std::lround(x)) - r.width / 2;
+    r.y = static_cast<int>(std::lround(y)) - r.height / 2;
+    r.x = std::clamp(r.x, bounds.x, bounds.x + bounds.width - r.width);
+    r.y = std::clamp(r.y, bounds.y, bounds.y + bounds.height - r.height);
+    return r;
+}
+
+double dist2(const StarCandidate& a, const StarCandidate& b)
+{
+    const double dx = a.x - b.x;
+    const double dy = a.y - b.y;
+    return dx * dx + dy * dy;
+}
+
+} // namespace
+
+bool RoiRect::contains(const RoiRect& other) const
+{
+    return other.x >= x && other.y >= y && other.x + other.width <= x + width &&
+           other.y + other.height <= y + height;
+}
+
+StarRoiPlan planStarRois(const std::vector<StarCandidate>& candidates, const StarRoiOptions& options)
+{
+    StarRoiPlan plan;
+    const int W = options.imageWidth;
+    const int H = options.imageHeight;
+    plan.imageWidth = W;
+    plan.imageHeight = H;
+    plan.readout = RoiRect{0, 0, W, H};
+    if (W <= 0 || H <= 0)
+        return plan;
+    const int minStars = std::max(1, options.minStars);
+    const int K = std::max(minStars, options.starCount);
+
+    // 饱和、低信噪比、画面外的星先排除
+    std::vector<size_t> good;
+    for (size_t i = 0; i < candidates.size(); ++i) {
+        const StarCandidate& c = candidates[i];
+        if (!std::isfinite(c.x) || !std::isfinite(c.y) || c.x < 0.0 || c.y < 0.0 || c.x >= W || c.y >= H)
+            continue;
+        if (c.snr > 0.0 && c.snr < options.minSnr)
+            continue;
+        if (c.peak > 0.0 && c.peak >= options.saturationAdu)
+            continue;
+        good.push_back(i);
+    }
+    if (static_cast<int>(good.size()) < minStars)
+        return plan;
+
+    int window = options.windowSize;
+    if (window <= 0) {
+        std::vector<double> hfrs;
+        for (size_t i : good) {
+            if (candidates[i].hfr > 0.0 && std::isfinite(candidates[i].hfr))
+                hfrs.push_back(candidates[i].hfr);
+        }
+        window = hfrs.empty() ? 64 : std::clamp(static_cast<int>(std::lround(16.0 * median(hfrs))), 32, 128);
+    }
+    window = std::min({alignUp(window, 2), W, H});
+    plan.windowSize = window;
+    const double half = window / 2.0;
+
+    // 离边缘太近或窗口里有相当亮度的近邻（含饱和星）的不用
+    const double neighbour2 = (0.75 * window) * (0.75 * window);
+    std::vector<StarCandidate> usable;
+    for (size_t i : good) {
+        const StarCandidate& c = candidates[i];
+        if (c.x - half - options.edgeMargin < 0.0 || c.y - half - options.edgeMargin < 0.0 ||
+            c.x + half + options.edgeMargin > W || c.y + half + options.edgeMargin > H)
+            continue;
+        bool isolated = true;
+        for (size_t j = 0; j < candidates.size() && isolated; ++j) {
+            if (j == i)
+                continue;
+            const StarCandidate& o = candidates[j];
+            if (dist2(c, o) < neighbour2 && (c.flux <= 0.0 || o.flux >= 0.1 * c.flux))
+                isolated = false;
+        }
+        if (isolated)
+            usable.push_back(c);
+    }
+    plan.usableCandidates = static_cast<int>(usable.size());
+    if (plan.usableCandidates < minStars)
+        return plan;
+
+    // 读出区域：面积不超过 maxReadoutFraction，放在可用星最多的位置，并列时靠近画面中心
+    const double fraction = std::clamp(options.maxReadoutFraction, 0.0, 1.0);
+    const double side = std::sqrt(fraction);
+    const int rw = std::clamp(static_cast<int>(std::lround(W * side)), std::min(W, window + 2 * options.edgeMargin), W);
+    const int rh = std::clamp(static_cast<int>(std::lround(H * side)), std::min(H, window + 2 * options.edgeMargin), H);
+    const int stepX = std::max(std::max(1, options.alignment), rw / 8);
+    const int stepY = std::max(std::max(1, options.alignment), rh / 8);
+    auto positions = [](int extent, int size, int step) {
+        std::vector<int> out;
+        for (int p = 0; p + size <= extent; p += step)
+            out.push_back(p);
+        if (out.empty() || out.back() != extent - size)
+            out.push_back(std::max(0, extent - size));
+        return out;
+    };
+
+    RoiRect region{0, 0, rw, rh};
+    int bestCount = -1;
+    double bestCentre = std::numeric_limits<double>::infinity();
+    for (int y0 : positions(H, rh, stepY)) {
+        for (int x0 : positions(W, rw, stepX)) {
+            const RoiRect r{x0, y0, rw, rh};
+            int count = 0;
+            for (const StarCandidate& s : usable) {
+                if (r.contains(windowAt(s.x, s.y, window, RoiRect{0, 0, W, H})))
+                    ++count;
+            }
+            count = std::min(count, K);
+            const double dx = x0 + rw / 2.0 - W / 2.0;
+            const double dy = y0 + rh / 2.0 - H / 2.0;
+            const double centre = dx * dx + dy * dy;
+            if (count > bestCount || (count == bestCount && centre < bestCentre)) {
+                bestCount = count;
+                bestCentre = centre;
+                region = r;
+            }
+        }
+    }
+    if (bestCount < minStars)
+        return plan;
+
+    // 区域内按最远点采样：从最亮的星开始，每次取离已选星最远的一颗
+    std::vector<StarCandidate> pool;
+    for (const StarCandidate& s : usable) {
+        if (region.contains(windowAt(s.x, s.y, window, RoiRect{0, 0, W, H})))
+            pool.push_back(s);
+    }
+    std::sort(pool.begin(), pool.end(), [](const StarCandidate& a, const StarCandidate& b) {
+        return a.flux != b.flux ? a.flux > b.flux : a.snr > b.snr;
+    });
+    std::vector<double> nearest(pool.size(), std::numeric_limits<double>::infinity());
+    std::vector<bool> taken(pool.size(), false);
+    size_t pick = 0;
+    while (static_cast<int>(plan.stars.size()) < K) {
+        const size_t last = pick;
+        taken[last] = true;
+        plan.stars.push_back(pool[last]);
+        double farthest = -1.0;
+        bool found = false;
+        for (size_t i = 0; i < pool.size(); ++i) {
+            if (taken[i])
+                continue;
+            nearest[i] = std::min(nearest[i], dist2(pool[i], pool[last]));
+            if (nearest[i] > farthest) {       // pool 按亮度排序，距离相同时保留更亮的
+                farthest = nearest[i];
+                pick = i;
+                found = true;
+            }
+        }
+        if (!found)
+            break;
+    }
+
+    int x0 = W, y0 = H, x1 = 0, y1 = 0;
+    for (const StarCandidate& s : plan.stars) {
+        const RoiRect w = windowAt(s.x, s.y, window, RoiRect{0, 0, W, H});
+        plan.windows.push_back(w);
+        x0 = std::min(x0, w.x);
+        y0 = std::min(y0, w.y);
+        x1 = std::max(x1, w.x + w.width);
+        y1 = std::max(y1, w.y + w.height);
+    }
+    x0 = alignDown(x0, options.alignment);
+    y0 = alignDown(y0, options.alignment);
+    x1 = std::min(W, alignUp(x1, options.alignment));
+    y1 = std::min(H, alignUp(y1, options.alignment));
+    plan.readout = RoiRect{x0, y0, x1 - x0, y1 - y0};
+    plan.readoutFraction = static_cast<double>(plan.readout.area()) / (static_cast<double>(W) * H);
+    plan.ok = static_cast<int>(plan.stars.size()) >= minStars;
+    return plan;
+}
+
+WindowMeasure measureWindow(const uint16_t* pixels, int frameWidth, int frameHeight,
+                            int originX, int originY, const RoiRect& window)
+{
+    WindowMeasure m;
+    if (!pixels || frameWidth <= 0 || frameHeight <= 0)
+        return m;
+    const int x0 = std::max(window.x, originX);
+    const int y0 = std::max(window.y, originY);
+    const int x1 = std::min(window.x + window.width, originX + frameWidth);
+    const int y1 = std::min(window.y + window.height, originY + frameHeight);
+    if (x1 - x0 < 5 || y1 - y0 < 5)
+        return m;
+
+    auto at = [&](int x, int y) {
+        return static_cast<double>(pixels[static_cast<size_t>(y - originY) * frameWidth + (x - originX)]);
+    };
+
+    // 背景与噪声：窗口边缘一圈
+    std::vector<double> border;
+    border.reserve(2 * ((x1 - x0) + (y1 - y0)));
+    for (int x = x0; x < x1; ++x) {
+        border.push_back(at(x, y0));
+        border.push_back(at(x, y1 - 1));
+    }
+    for (int y = y0 + 1; y < y1 - 1; ++y) {
+        border.push_back(at(x0, y));
+        border.push_back(at(x1 - 1, y));
+    }
+    const double background = median(border);
+    for (double& v : border)
+        v = std::abs(v - background);
+    double sigma = 1.4826 * median(border);
+    if (!(sigma > 0.0))
+        sigma = 1.0;
+    const double threshold = background + 2.0 * sigma;
+
+    double sum = 0.0, sx = 0.0, sy = 0.0;
+    int count = 0;
+    for (int y = y0; y < y1; ++y) {
+        for (int x = x0; x < x1; ++x) {
+            const double v = at(x, y);
+            m.peak = std::max(m.peak, v);
+            if (v <= threshold)
+                continue;
+            const double w = v - background;
+            sum += w;
+            sx += w * x;
+            sy += w * y;
+            ++count;
+        }
+    }
+    // 峰值要明显高于噪声（5σ）才算窗口里有星，否则只是噪声像素过阈值
+    if (count < 3 || !(sum > 0.0) || m.peak - background < 5.0 * sigma)
+        return m;
+
+    m.x = sx / sum;
+    m.y = sy / sum;
+    double sr = 0.0;
+    for (int y = y0; y < y1; ++y) {
+        for (int x = x0; x < x1; ++x) {
+            const double v = at(x, y);
+            if (v <= threshold)
+                continue;
+            sr += (v - background) * std::hypot(x - m.x, y - m.y);
+        }
+    }
+    m.flux = sum;
+    m.hfr = sr / sum;
+    m.ok = std::isfinite(m.hfr) && m.hfr > 0.0;
+    return m;
+}
+
+RoiHfrResult measureRoiHfr(const uint16_t* pixels, int frameWidth, int frameHeight, int originX, int originY,
+                           StarRoiPlan& plan, double saturationAdu, bool recenter)
+{
+    RoiHfrResult result;
+    std::vector<double> hfrs;
+    hfrs.reserve(plan.windows.size());
+    for (RoiRect& window : plan.windows) {
+        const WindowMeasure m = measureWindow(pixels, frameWidth, frameHeight, originX, originY, window);
+        if (!m.ok) {
+            ++result.failed;
+            continue;
+        }
+        if (m.peak >= saturationAdu) {
+            ++result.saturated;
+        } else {
+            hfrs.push_back(m.hfr);
+        }
+        if (recenter)
+            window = windowAt(m.x, m.y, window.width, plan.readout);
+    }
+    result.measured = static_cast<int>(hfrs.size());
+    result.medianHfr = median(hfrs);
+    // 离焦较远时暗星可能测不出来，至少要有三分之一的窗口给出有效 HFR
+    const int needed = std::max(1, (static_cast<int>(plan.windows.size()) + 2) / 3);
+    result.ok = result.measured >= needed;
+    return result;
+}
+
+} // namespace focus
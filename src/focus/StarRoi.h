@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace focus {
+
+// 第一帧全幅识星得到的候选星
+struct StarCandidate {
+    double x{0.0};
+    double y{0.0};
+    double flux{0.0};
+    double peak{0.0};       ///< 峰值 ADU；<= 0 表示未知
+    double hfr{0.0};
+    double snr{0.0};        ///< <= 0 表示未知
+};
+
+struct RoiRect {
+    int x{0};
+    int y{0};
+    int width{0};
+    int height{0};
+
+    long long area() const { return static_cast<long long>(width) * height; }
+    bool contains(const RoiRect& other) const;
+};
+
+struct StarRoiOptions {
+    int imageWidth{0};
+    int imageHeight{0};
+    int starCount{8};                   ///< K
+    int minStars{3};                    ///< 可用星少于此数时不启用 ROI 模式
+    int windowSize{0};                  ///< 每颗星的方窗边长；0 表示按中位 HFR 推算（16×HFR，32..128）
+    double saturationAdu{58981.0};      ///< 峰值 ≥ 此值视为饱和（默认 16bit 满量程的 90%）
+    double minSnr{5.0};
+    double maxReadoutFraction{0.25};    ///< 读出子帧最多占全幅的面积比例
+    int edgeMargin{16};
+    int alignment{4};                   ///< 子帧起点/尺寸对齐（相机 ROI 一般要求 4 的倍数）
+};
+
+// ROI 方案：K 颗分散、不饱和、孤立的星，每颗一个小窗；相机一次只读出各窗口并集的外接子帧
+struct StarRoiPlan {
+    bool ok{false};
+    int imageWidth{0};
+    int imageHeight{0};
+    int windowSize{0};
+    RoiRect readout;                    ///< 全幅坐标
+    std::vector<RoiRect> windows;       ///< 全幅坐标，均在 readout 内
+    std::vector<StarCandidate> stars;
+    int usableCandidates{0};
+    double readoutFraction{1.0};        ///< readout 面积 / 全幅面积
+};
+
+// 选星：先过滤饱和、低信噪比、靠边、有近邻的星；在不超过 maxReadoutFraction 的子帧里
+// 找可用星最多（并列时离画面中心最近）的位置，再在子帧内按最远点采样选 K 颗，使星分散在子帧各处
+StarRoiPlan planStarRois(const std::vector<StarCandidate>& candidates, const StarRoiOptions& options);
+
+struct WindowMeasure {
+    bool ok{false};
+    double x{0.0};          ///< 质心（全幅坐标）
+    double y{0.0};
+    double hfr{0.0};
+    double flux{0.0};
+    double peak{0.0};
+};
+
+// 在一帧（左上角位于全幅 originX/originY，可以是子帧也可以是全幅）中测量 window 内的星：
+// 窗口边缘一圈像素的中位数作背景、MAD 估噪声，高于背景 2σ 的像素按通量加权求质心和 HFR = Σ(I·r)/ΣI
+WindowMeasure measureWindow(const uint16_t* pixels, int frameWidth, int frameHeight,
+                            int originX, int originY, const RoiRect& window);
+
+struct RoiHfrResult {
+    bool ok{false};
+    double medianHfr{0.0};
+    int measured{0};
+    int saturated{0};
+    int failed{0};
+};
+
+// 测量方案内所有窗口，返回有效星 HFR 的中位数（饱和星不计入）；
+// recenter 时把窗口移到新质心（仍限制在 readout 内），跟住对焦过程中的缓慢漂移
+RoiHfrResult measureRoiHfr(const uint16_t* pixels, int frameWidth, int frameHeight, int originX, int originY,
+                           StarRoiPlan& plan, double saturationAdu, bool recenter = true);
+
+} // namespace focus
@@ -0,0 +1,421 @@
+#include "VCurveFocus.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace focus {
+
+namespace {
+
+// 3x3 对称矩阵求逆（余子式），奇异时返回 false
+bool invert3(const double m[3][3], double out[3][3])
+{
+    const double c00 = m[1][1] * m[2][2] - m[1][2] * m[2][1];
+    const double c01 = m[1][2] * m[2][0] - m[1][0] * m[2][2];
+    const double c02 = m[1][0] * m[2][1] - m[1][1] * m[2][0];
+    const double det = m[0][0] * c00 + m[0][1] * c01 + m[0][2] * c02;
+    const double scale = std::abs(m[0][0] * m[1][1] * m[2][2]) + 1e-300;
+    if (!std::isfinite(det) || std::abs(det) < 1e-13 * scale)
+        return false;
+    const double inv = 1.0 / det;
+    out[0][0] = c00 * inv;
+    out[0][1] = (m[0][2] * m[2][1] - m[0][1] * m[2][2]) * inv;
+    out[0][2] = (m[0][1] * m[1][2] - m[0][2] * m[1][1]) * inv;
+    out[1][0] = c01 * inv;
+    out[1][1] = (m[0][0] * m[2][2] - m[0][2] * m[2][0]) * inv;
+    out[1][2] = (m[0][2] * m[1][0] - m[0][0] * m[1][2]) * inv;
+    out[2][0] = c02 * inv;
+    out[2][1] = (m[0][1] * m[2][0] - m[0][0] * m[2][1]) * inv;
+    out[2][2] = (m[0][0] * m[1][1] - m[0][1] * m[1][0]) * inv;
+    return true;
+}
+
+// 模型对 (a, b, c) 的偏导
+void gradient(double a, double b, double c, double x, double g[3])
+{
+    const double u = (x - c) / b;
+    const double s = std::sqrt(1.0 + u * u);
+    g[0] = s;
+    g[1] = -a * u * u / (b * s);
+    g[2] = -a * u / (b * s);
+}
+
+// 信息矩阵 JᵀJ
+void information(const std::vector<FocusSample>& pts, double a, double b, double c, double m[3][3])
+{
+    for (int i = 0; i < 3; ++i)
+        for (int j = 0; j < 3; ++j)
+            m[i][j] = 0.0;
+    for (const FocusSample& p : pts) {
+        double g[3];
+        gradient(a, b, c, p.position, g);
+        for (int i = 0; i < 3; ++i)
+            for (int j = 0; j < 3; ++j)
+                m[i][j] += g[i] * g[j];
+    }
+}
+
+double residualSum(const std::vector<FocusSample>& pts, double a, double b, double c)
+{
+    double rss = 0.0;
+    for (const FocusSample& p : pts) {
+        const double u = (p.position - c) / b;
+        const double r = p.hfr - a * std::sqrt(1.0 + u * u);
+        rss += r * r;
+    }
+    return rss;
+}
+
+std::vector<FocusSample> validSamples(const std::vector<FocusSample>& samples)
+{
+    std::vector<FocusSample> pts;
+    pts.reserve(samples.size());
+    for (const FocusSample& s : samples) {
+        if (std::isfinite(s.position) && std::isfinite(s.hfr) && s.hfr > 0.0)
+            pts.push_back(s);
+    }
+    std::sort(pts.begin(), pts.end(),
+              [](const FocusSample& l, const FocusSample& r) { return l.position < r.position; });
+    return pts;
+}
+
+} // namespace
+
+double HyperbolaFit::at(double x) const
+{
+    if (b <= 0.0)
+        return a;
+    const double u = (x - c) / b;
+    return a * std::sqrt(1.0 + u * u);
+}
+
+void HyperbolaFit::toParabola(double& pa, double& pb, double& pc) const
+{
+    pa = b > 0.0 ? a / (2.0 * b * b) : 0.0;
+    pb = -2.0 * pa * c;
+    pc = a + pa * c * c;
+}
+
+double HyperbolaFit::toleranceZoneSteps(double tolerance) const
+{
+    if (!ok || tolerance <= 0.0)
+        return 0.0;
+    const double k = 1.0 + tolerance;
+    return 2.0 * b * std::sqrt(k * k - 1.0);
+}
+
+HyperbolaFit fitHyperbola(const std::vector<FocusSample>& samples)
+{
+    HyperbolaFit fit;
+    std::vector<FocusSample> pts = validSamples(samples);
+    const int n = static_cast<int>(pts.size());
+    fit.samples = n;
+    if (n < 4)
+        return fit;
+
+    // 位置减去均值再拟合，电调读数上万步时法方程也不会病态
+    double origin = 0.0;
+    for (const FocusSample& p : pts)
+        origin += p.position;
+    origin /= n;
+    for (FocusSample& p : pts)
+        p.position -= origin;
+
+    // 初值：最小点（有左右邻点时取三点抛物线顶点）、a 略低于最小 HFR、b 由坡上各点反解取中位数
+    size_t best = 0;
+    for (size_t i = 1; i < pts.size(); ++i) {
+        if (pts[i].hfr < pts[best].hfr)
+            best = i;
+    }
+    double c = pts[best].position;
+    if (best > 0 && best + 1 < pts.size()) {
+        const FocusSample& l = pts[best - 1];
+        const FocusSample& m = pts[best];
+        const FocusSample& r = pts[best + 1];
+        const double den = (l.position - m.position) * (l.position - r.position) * (m.position - r.position);
+        const double A = (r.position * (m.hfr - l.hfr) + m.position * (l.hfr - r.hfr) + l.position * (r.hfr - m.hfr));
+        const double B = (r.position * r.position * (l.hfr - m.hfr) + m.position * m.position * (r.hfr - l.hfr) +
+                          l.position * l.position * (m.hfr - r.hfr));
+        if (std::abs(den) > 0.0 && A / den > 0.0)
+            c = std::clamp(-B / (2.0 * A), l.position, r.position);
+    }
+    double a = pts[best].hfr * 0.98;
+    std::vector<double> widths;
+    for (const FocusSample& p : pts) {
+        const double k = p.hfr / a;
+        if (k > 1.02 && std::abs(p.position - c) > 0.0)
+            widths.push_back(std::abs(p.position - c) / std::sqrt(k * k - 1.0));
+    }
+    double b = pts.back().position - pts.front().position;
+    if (!widths.empty()) {
+        std::nth_element(widths.begin(), widths.begin() + widths.size() / 2, widths.end());
+        b = widths[widths.size() / 2];
+    }
+    if (!(b > 0.0))
+        b = 1.0;
+
+    // Levenberg-Marquardt（对角缩放），a、b 必须保持为正
+    double rss = residualSum(pts, a, b, c);
+    double lambda = 1e-3;
+    int iter = 0;
+    for (; iter < 200; ++iter) {
+        double m[3][3];
+        double g[3] = {0.0, 0.0, 0.0};
+        information(pts, a, b, c, m);
+        for (const FocusSample& p : pts) {
+            double d[3];
+            gradient(a, b, c, p.position, d);
+            const double r = p.hfr - a * d[0];
+            for (int i = 0; i < 3; ++i)
+                g[i] += d[i] * r;
+        }
+
+        bool improved = false;
+        while (lambda < 1e12) {
+            double damped[3][3];
+            for (int i = 0; i < 3; ++i)
+                for (int j = 0; j < 3; ++j)
+                    damped[i][j] = m[i][j] + (i == j ? lambda * m[i][i] : 0.0);
+            double inv[3][3];
+            if (!invert3(damped, inv)) {
+                lambda *= 10.0;
+                continue;
+            }
+            double step[3];
+            for (int i = 0; i < 3; ++i)
+                step[i] = inv[i][0] * g[0] + inv[i][1] * g[1] + inv[i][2] * g[2];
+            const double na = a + step[0];
+            const double nb = b + step[1];
+            const double nc = c + step[2];
+            const double nrss = (na > 0.0 && nb > 0.0) ? residualSum(pts, na, nb, nc) : INFINITY;
+            if (nrss < rss) {
+                const double change = rss - nrss;
+                a = na;
+                b = nb;
+                c = nc;
+                rss = nrss;
+                lambda = std::max(lambda / 10.0, 1e-12);
+                improved = change > 1e-14 * (rss + 1e-300);
+                break;
+            }
+            lambda *= 10.0;
+        }
+        if (!improved)
+            break;
+    }
+
+    double m[3][3];
+    double cov[3][3];
+    information(pts, a, b, c, m);
+    if (!std::isfinite(a) || !std::isfinite(b) || !std::isfinite(c) || a <= 0.0 || b <= 0.0 || !invert3(m, cov))
+        return fit;
+
+    const double variance = rss / (n - 3);
+    fit.ok = true;
+    fit.a = a;
+    fit.b = b;
+    fit.c = c + origin;
+    fit.sigmaA = std::sqrt(std::max(0.0, variance * cov[0][0]));
+    fit.sigmaB = std::sqrt(std::max(0.0, variance * cov[1][1]));
+    fit.sigmaC = std::sqrt(std::max(0.0, variance * cov[2][2]));
+    fit.rms = std::sqrt(rss / n);
+    fit.iterations = iter;
+    return fit;
+}
+
+double criticalFocusZoneSteps(double focalRatio, double micronsPerStep, double wavelengthNm)
+{
+    if (focalRatio <= 0.0 || micronsPerStep <= 0.0 || wavelengthNm <= 0.0)
+        return 0.0;
+    return 4.88 * (wavelengthNm / 1000.0) * focalRatio * focalRatio / micronsPerStep;
+}
+
+void AdaptiveFocusSampler::reset(const Options& options)
+{
+    m_options = options;
+    if (!(m_options.step > 0.0))
+        m_options.step = 1.0;
+    if (m_options.maxPosition < m_options.minPosition)
+        std::swap(m_options.minPosition, m_options.maxPosition);
+    m_options.minSamples = std::max(4, m_options.minSamples);
+    m_options.maxSamples = std::max(m_options.minSamples, m_options.maxSamples);
+    m_samples.clear();
+    m_attempted.clear();
+    m_fit = HyperbolaFit();
+    m_reason = "";
+}
+
+void AdaptiveFocusSampler::addSample(double position, double hfr)
+{
+    m_attempted.push_back(position);
+    if (std::isfinite(hfr) && hfr > 0.0) {
+        m_samples.push_back({position, hfr});
+        m_fit = fitHyperbola(m_samples);
+    }
+}
+
+double AdaptiveFocusSampler::zoneSteps() const
+{
+    if (m_options.criticalZoneSteps > 0.0)
+        return m_options.criticalZoneSteps;
+    // 曲线很平（b 很大）时模型区间会很宽，上限取两个步距，不比原固定网格的分辨率差
+    return std::min(m_fit.toleranceZoneSteps(m_options.zoneTolerance), 2.0 * m_options.step);
+}
+
+double AdaptiveFocusSampler::confidenceHalfWidth() const
+{
+    return m_fit.ok ? m_options.confidenceZ * m_fit.sigmaC : -1.0;
+}
+
+bool AdaptiveFocusSampler::attempted(double position) const
+{
+    const double near = std::max(0.5, 0.5 * m_options.step);
+    for (double p : m_attempted) {
+        if (std::abs(p - position) < near)
+            return true;
+    }
+    return false;
+}
+
+double AdaptiveFocusSampler::clampPosition(double position) const
+{
+    return std::clamp(std::round(position), m_options.minPosition, m_options.maxPosition);
+}
+
+// 向 side（-1 左 / +1 右）已采样的最外侧再外推两步
+bool AdaptiveFocusSampler::expandSide(int side, const FocusSample& best, double& position) const
+{
+    double outer = best.position;
+    for (double p : m_attempted)
+        outer = side < 0 ? std::min(outer, p) : std::max(outer, p);
+    const double candidate = outer + side * 2.0 * m_options.step;
+    if (std::abs(candidate - m_options.center) > m_options.maxOffsetSteps * m_options.step + 0.5)
+        return false;
+    position = clampPosition(candidate);
+    return !attempted(position);
+}
+
+// 模型不可用时按坡二分：在最小点与左右邻点之间较大的空档取中点
+bool AdaptiveFocusSampler::bisect(const FocusSample& best, double& position) const
+{
+    const FocusSample* left = nullptr;
+    const FocusSample* right = nullptr;
+    for (const FocusSample& s : m_samples) {
+        if (s.position < best.position && (!left || s.position > left->position))
+            left = &s;
+        if (s.position > best.position && (!right || s.position < right->position))
+            right = &s;
+    }
+    const double leftGap = left ? best.position - left->position : 0.0;
+    const double rightGap = right ? right->position - best.position : 0.0;
+    const double first = leftGap >= rightGap ? -1.0 : 1.0;
+    for (double side : {first, -first}) {
+        const double gap = side < 0 ? leftGap : rightGap;
+        const double candidate = gap > 0.0 ? best.position + side * gap / 2.0 : best.position + side * m_options.step;
+        position = clampPosition(candidate);
+        if (!attempted(position))
+            return true;
+    }
+    return false;
+}
+
+// 在 c ± 4 步内（半步间隔）选加入后使 σc 最小的位置
+bool AdaptiveFocusSampler::mostInformative(double& position) const
+{
+    double m[3][3];
+    information(m_samples, m_fit.a, m_fit.b, m_fit.c, m);
+
+    bool found = false;
+    double bestVariance = INFINITY;
+    for (int k = -8; k <= 8; ++k) {
+        const double candidate = clampPosition(m_fit.c + k * 0.5 * m_options.step);
+        if (attempted(candidate))
+            continue;
+        double g[3];
+        gradient(m_fit.a, m_fit.b, m_fit.c, candidate, g);
+        double updated[3][3];
+        for (int i = 0; i < 3; ++i)
+            for (int j = 0; j < 3; ++j)
+                updated[i][j] = m[i][j] + g[i] * g[j];
+        double inv[3][3];
+        if (!invert3(updated, inv))
+            continue;
+        // 同样的方差减小时偏向离最佳位置近的点（远处更容易偏离双曲线）
+        const double variance = inv[2][2] * (1.0 + 1e-6 * std::abs(k));
+        if (variance < bestVariance) {
+            bestVariance = variance;
+            position = candidate;
+            found = true;
+        }
+    }
+    return found;
+}
+
+AdaptiveFocusSampler::Decision AdaptiveFocusSampler::next(double& position)
+{
+    if (attempts() >= m_options.maxSamples) {
+        m_reason = "sample budget used";
+        return Decision::Exhausted;
+    }
+
+    // 起始三点：中心与两侧各两步
+    for (int offset : {0, -2, 2}) {
+        position = clampPosition(m_options.center + offset * m_options.step);
+        if (!attempted(position)) {
+            m_reason = "initial";
+            return Decision::Sample;
+        }
+    }
+
+    if (m_samples.empty()) {
+        m_reason = "no valid HFR";
+        return Decision::Exhausted;
+    }
+
+    FocusSample best = m_samples.front();
+    for (const FocusSample& s : m_samples) {
+        if (s.hfr < best.hfr)
+            best = s;
+    }
+
+    // 两侧都要有明显高于最小值的点，模型的斜率才有约束
+    for (int side : {-1, 1}) {
+        bool onSlope = false;
+        for (const FocusSample& s : m_samples) {
+            if ((s.position - best.position) * side > 0.0 && s.hfr >= best.hfr * m_options.slopeRatio)
+                onSlope = true;
+        }
+        if (!onSlope && expandSide(side, best, position)) {
+            m_reason = side < 0 ? "bracket inner slope" : "bracket outer slope";
+            return Decision::Sample;
+        }
+    }
+
+    double lo = m_samples.front().position;
+    double hi = lo;
+    for (const FocusSample& s : m_samples) {
+        lo = std::min(lo, s.position);
+        hi = std::max(hi, s.position);
+    }
+
+    if (m_fit.ok && m_fit.c >= lo && m_fit.c <= hi) {
+        const double zone = zoneSteps();
+        if (static_cast<int>(m_samples.size()) >= m_options.minSamples && zone > 0.0 &&
+            2.0 * confidenceHalfWidth() <= zone) {
+            m_reason = "confidence interval inside critical focus zone";
+            return Decision::Converged;
+        }
+        if (mostInformative(position)) {
+            m_reason = "reduce best-position uncertainty";
+            return Decision::Sample;
+        }
+    } else if (bisect(best, position)) {
+        m_reason = "bisect around minimum";
+        return Decision::Sample;
+    }
+
+    m_reason = "no untried position";
+    return Decision::Exhausted;
+}
+
+} // namespace focus
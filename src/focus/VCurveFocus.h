@@ -0,0 +1,92 @@
+#pragma once
+
+#include <vector>
+
+namespace focus {
+
+struct FocusSample {
+    double position{0.0};
+    double hfr{0.0};
+};
+
+// V 曲线的双曲线模型：HFR(x) = a · sqrt(1 + ((x - c) / b)²)
+//   a 焦点处 HFR，b 曲线半宽（步，HFR 升到 √2·a 的偏离量），c 最佳位置
+// 离焦远处两侧是斜率 ±a/b 的直线，焦点附近是抛物线，比单一抛物线更贴合实测曲线
+struct HyperbolaFit {
+    bool ok{false};
+    double a{0.0};
+    double b{0.0};
+    double c{0.0};
+    double sigmaA{0.0};
+    double sigmaB{0.0};
+    double sigmaC{0.0};         ///< 最佳位置的 1σ（残差方差 × (JᵀJ)⁻¹）
+    double rms{0.0};            ///< 拟合残差均方根
+    int samples{0};
+    int iterations{0};
+
+    double at(double x) const;
+    // 焦点附近的二次近似 y = pa·x² + pb·x + pc（前端按抛物线画拟合曲线）
+    void toParabola(double& pa, double& pb, double& pc) const;
+    // HFR 不超过 (1 + tolerance)·a 的位置区间宽度（步）
+    double toleranceZoneSteps(double tolerance) const;
+};
+
+// Levenberg-Marquardt 拟合；少于 4 个有效点（hfr > 0）或不收敛时 ok = false
+HyperbolaFit fitHyperbola(const std::vector<FocusSample>& samples);
+
+// 临界焦区 CFZ = 4.88 · λ · F²（微米），按电调每步行程换算成步数
+double criticalFocusZoneSteps(double focalRatio, double micronsPerStep, double wavelengthNm = 550.0);
+
+// 自适应采样：不再固定扫完整个网格，每采一个点就重新拟合双曲线，
+// 按“两侧是否都已到坡上 → 模型能否收敛 → 哪个位置最能缩小最佳位置的不确定度”决定下一个点，
+// 最佳位置的置信区间（±z·σc）窄于临界焦区时停止
+class AdaptiveFocusSampler
+{
+public:
+    struct Options {
+        double center{0.0};
+        double step{1.0};               ///< 采样步距（步）
+        double minPosition{0.0};
+        double maxPosition{0.0};
+        double criticalZoneSteps{0.0};  ///< 临界焦区（步）；<= 0 时取模型上 HFR 升高 zoneTolerance 的区间宽度（不超过两步）
+        double zoneTolerance{0.1};
+        double confidenceZ{2.0};        ///< 置信区间 ±z·σc
+        double slopeRatio{1.15};        ///< 一侧有点的 HFR ≥ 最小值 × 此比例才算已到坡上
+        int maxOffsetSteps{6};          ///< 找坡时离中心最远的步数
+        int minSamples{5};
+        int maxSamples{9};              ///< 含失败的点；与原固定网格点数相同，保证曝光数不会变多
+    };
+
+    enum class Decision {
+        Sample,         ///< 到 next 给出的位置采样
+        Converged,      ///< 置信区间已窄于临界焦区
+        Exhausted,      ///< 采样数用完或无处可采，按已有数据拟合
+    };
+
+    void reset(const Options& options);
+    // hfr <= 0 表示该点无效：计入已采样数、不再重复采，但不参与拟合
+    void addSample(double position, double hfr);
+    Decision next(double& position);
+
+    const HyperbolaFit& fit() const { return m_fit; }
+    const std::vector<FocusSample>& samples() const { return m_samples; }
+    int attempts() const { return static_cast<int>(m_attempted.size()); }
+    double zoneSteps() const;               ///< 当前使用的临界焦区（步）
+    double confidenceHalfWidth() const;     ///< z·σc；模型无效时为 -1
+    const char* reason() const { return m_reason; }
+
+private:
+    bool attempted(double position) const;
+    double clampPosition(double position) const;
+    bool expandSide(int side, const FocusSample& best, double& position) const;
+    bool bisect(const FocusSample& best, double& position) const;
+    bool mostInformative(double& position) const;
+
+    Options m_options;
+    std::vector<FocusSample> m_samples;
+    std::vector<double> m_attempted;
+    HyperbolaFit m_fit;
+    const char* m_reason{""};
+};
+
+} // namespace focus
@@ -3,6 +3,7 @@
 #include <QFile>
 #include <QtGlobal>
 
+#include <algorithm>
 #include <cmath>
 #include <optional>
 #include <random>
@@ -123,7 +124,6 @@ void SimGuiderFrameSource::initStarFieldIfNeeded()
     guide.basePosPx = m_p.startPosPx;
     guide.peak = m_p.starPeak;
     guide.sigmaPx = m_p.psfSigmaPx;
-    guide.radiusPx = m_p.psfRadiusPx;
     m_fieldStars.push_back(guide);
 
     // 1) 其它背景星：随机分布，亮度/PSF 多样化，仿照真实导星画面“多星场”
@@ -156,87 +156,16 @@ void SimGuiderFrameSource::initStarFieldIfNeeded()
             s.peak = static_cast<uint16_t>(std::llround(randIn(22000.0, 52000.0)));
             s.sigmaPx = randIn(2.2, 3.6);
         }
-
-        s.radiusPx = std::max(6, static_cast<int>(std::llround(s.sigmaPx * 5.0)));
         m_fieldStars.push_back(s);
     }
 
     m_fieldReady = true;
 }
 
-void SimGuiderFrameSource::drawStarGaussian(cv::Mat& img16,
-                                           const QPointF& posPx,
-                                           uint16_t peak,
-                                           double sigmaPx,
-                                           int radiusPx)
-{
-    const int cx = static_cast<int>(std::llround(posPx.x()));
-    const int cy = static_cast<int>(std::llround(posPx.y()));
-    const double sigma2 = sigmaPx * sigmaPx;
-    const int R = radiusPx;
-
-    for (int dy = -R; dy <= R; ++dy)
-    {
-        const int yy = cy + dy;
-        if (yy < 0 || yy >= img16.rows) continue;
-        auto* row = img16.ptr<uint16_t>(yy);
-        for (int dx = -R; dx <= R; ++dx)
-        {
-            const int xx = cx + dx;
-            if (xx < 0 || xx >= img16.cols) continue;
-            const double r2 = static_cast<double>(dx * dx + dy * dy);
-            const double w = std::exp(-r2 / (2.0 * sigma2));
-            const int add = static_cast<int>(std::llround(static_cast<double>(peak) * w));
-            int v = static_cast<int>(row[xx]) + add;
-            if (v > 65535) v = 65535;
-            row[xx] = static_cast<uint16_t>(v);
-        }
-    }
-}
-
 cv::Mat SimGuiderFrameSource::renderFrame16U(double dtSec)
 {
     initStarFieldIfNeeded();
 
-    // 生成噪声背景
-    cv::Mat img(m_p.height, m_p.width, CV_16UC1);
-    img.setTo(cv::Scalar(static_cast<int>(m_p.noiseMean)));
-
-    // 轻微渐变（模拟真实画面中的亮度不均匀/暗角）
-    const double cx = (m_p.width - 1) * 0.5;
-    const double cy = (m_p.height - 1) * 0.5;
-    const double maxR = std::sqrt(cx * cx + cy * cy);
-    for (int y = 0; y < img.rows; ++y)
-    {
-        auto* row = img.ptr<uint16_t>(y);
-        for (int x = 0; x < img.cols; ++x)
-        {
-            const double dx = x - cx;
-            const double dy = y - cy;
-            const double r = std::sqrt(dx * dx + dy * dy) / maxR;
-            const double vignette = 1.0 - 0.35 * r; // 边缘更暗
-            int v = static_cast<int>(std::llround(static_cast<double>(row[x]) * vignette));
-            if (v < 0) v = 0;
-            row[x] = static_cast<uint16_t>(v);
-        }
-    }
-
-    // 高斯噪声
-    cv::Mat noise16s(m_p.height, m_p.width, CV_16SC1);
-    cv::randn(noise16s, 0.0, m_p.noiseStd);
-    for (int y = 0; y < img.rows; ++y)
-    {
-        auto* dst = img.ptr<uint16_t>(y);
-        const auto* n = noise16s.ptr<int16_t>(y);
-        for (int x = 0; x < img.cols; ++x)
-        {
-            int v = static_cast<int>(dst[x]) + static_cast<int>(n[x]);
-            if (v < 0) v = 0;
-            if (v > 65535) v = 65535;
-            dst[x] = static_cast<uint16_t>(v);
-        }
-    }
-
     // 漂移（右上：x+ y-）
     m_starPosPx.rx() += m_p.driftPxPerSec.x() * dtSec;
     m_starPosPx.ry() += m_p.driftPxPerSec.y() * dtSec;
@@ -250,12 +179,27 @@ cv::Mat SimGuiderFrameSource::renderFrame16U(double dtSec)
 
     // 整片星场随导星星点一起移动：delta = currentGuide - startGuide
     const QPointF delta = m_starPosPx - m_p.startPosPx;
+    std::vector<sim::StarStamp> stamps;
+    stamps.reserve(m_fieldStars.size());
     for (const auto& s : m_fieldStars)
     {
         const QPointF pos = s.basePosPx + delta;
-        drawStarGaussian(img, pos, s.peak, s.sigmaPx, s.radiusPx);
+        stamps.push_back({pos.x(), pos.y(), sim::fluxFromPeak(s.peak, s.sigmaPx), s.sigmaPx});
     }
 
+    // 背景 + 轻微暗角（边缘更暗）+ 噪声：总噪声保持 noiseStd，扣除背景自身的泊松部分后作为读出噪声
+    sim::SkyRenderOptions options;
+    options.width = m_p.width;
+    options.height = m_p.height;
+    options.backgroundE = std::max(0.0, m_p.noiseMean);
+    options.vignette = 0.35;
+    options.poisson = true;
+    options.readNoiseE = std::sqrt(std::max(0.0, m_p.noiseStd * m_p.noiseStd - options.backgroundE));
+    options.seed = m_p.randomSeed;
+    options.frameIndex = m_frameIndex++;
+
+    cv::Mat img(m_p.height, m_p.width, CV_16UC1);
+    m_renderer.render(options, stamps, img.ptr<uint16_t>(0), img.step1());
     return img;
 }
 
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "GuiderTypes.h"
+#include "../sim/SkyRenderer.h"
 
 #include <QElapsedTimer>
 #include <QMutex>
@@ -12,7 +13,7 @@
 namespace guiding {
 
 // 生成模拟导星帧（16bit FITS），用于无相机/无赤道仪的导星测试。
-// - 每次 generateNextFrame() 会把一颗模拟星点绘制到噪声背景上
+// - 每次 generateNextFrame() 用共享渲染器把整片星场（子像素 PSF）落到带暗角和泊松/读出噪声的背景上
 // - 星点位置由：基准漂移（右上）+ pending 脉冲响应 位移决定
 class SimGuiderFrameSource
 {
@@ -43,12 +44,13 @@ public:
         // 星点 PSF
         // 星点做得更“显眼”：更大 PSF + 更高峰值
         double psfSigmaPx = 2.8;
-        int psfRadiusPx = 14;
+        int psfRadiusPx = 14;   // 导星星点离画面边缘的最小距离（落星核半径由 sigma 决定）
         // 注意：GuidingStarDetector 会过滤 peak>=0.9*65535 的“近饱和星”
         uint16_t starPeak = 52000;
 
         // 背景噪声（16bit）
         // 降低背景与噪声，确保前端自动拉伸后星点仍清晰可见
+        // noiseStd 为总噪声：背景泊松噪声之外的部分作为读出噪声
         double noiseMean = 200.0;
         double noiseStd = 25.0;
 
@@ -82,14 +84,12 @@ private:
         QPointF basePosPx;
         uint16_t peak = 0;
         double sigmaPx = 1.6;
-        int radiusPx = 8;
     };
 
     static bool writeFits16U(const QString& path, const cv::Mat& image16);
     cv::Mat renderFrame16U(double dtSec);
     void applyPendingShift();
     void initStarFieldIfNeeded();
-    void drawStarGaussian(cv::Mat& img16, const QPointF& posPx, uint16_t peak, double sigmaPx, int radiusPx);
 
 private:
     mutable QMutex m_mutex;
@@ -104,6 +104,9 @@ private:
 
     bool m_fieldReady = false;
     std::vector<FieldStar> m_fieldStars;
+
+    sim::SkyRenderer m_renderer;
+    uint64_t m_frameIndex = 0;
 };
 
 } // namespace guiding
@@ -0,0 +1,489 @@
+#include "TileStats.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cmath>
+#include <thread>
+
+namespace image {
+
+namespace {
+
+// 每种 CFA 下 (x&1) + 2*(y&1) → 通道
+const int* channelMap(CfaLayout cfa)
+{
+    static const int mono[4] = {0, 0, 0, 0};
+    static const int rggb[4] = {ChannelR, ChannelG1, ChannelG2, ChannelB};
+    static const int grbg[4] = {ChannelG1, ChannelR, ChannelB, ChannelG2};
+    static const int gbrg[4] = {ChannelG1, ChannelB, ChannelR, ChannelG2};
+    static const int bggr[4] = {ChannelB, ChannelG1, ChannelG2, ChannelR};
+    switch (cfa) {
+    case CfaLayout::RGGB: return rggb;
+    case CfaLayout::GRBG: return grbg;
+    case CfaLayout::GBRG: return gbrg;
+    case CfaLayout::BGGR: return bggr;
+    case CfaLayout::Mono: break;
+    }
+    return mono;
+}
+
+// 单个瓦片的扫描：每行只有两个通道交替出现，按列奇偶拆开累加
+void scanTile(const uint16_t* data, size_t rowStride, int x0, int y0, int x1, int y1,
+              const int* map, int shift, RegionStats& out)
+{
+    uint64_t count[kMaxChannels] = {};
+    uint64_t sum[kMaxChannels] = {};
+    uint64_t sumSq[kMaxChannels] = {};
+    uint16_t minV[kMaxChannels] = {65535, 65535, 65535, 65535};
+    uint16_t maxV[kMaxChannels] = {0, 0, 0, 0};
+
+    for (int y = y0; y < y1; ++y) {
+        const uint16_t* row = data + static_cast<size_t>(y) * rowStride;
+        const int phaseRow = (y & 1) * 2;
+        for (int k = 0; k < 2; ++k) {
+            const int xs = x0 + k;  // 偶数/奇数列各走一遍，通道在该列序列上不变
+            if (xs >= x1)
+                continue;
+            const int c = map[phaseRow + (xs & 1)];
+            uint32_t* hist = out.histogram.data() + static_cast<size_t>(c) * out.bins;
+            uint64_t s = 0, sq = 0;
+            uint16_t lo = minV[c], hi = maxV[c];
+            int n = 0;
+            for (int x = xs; x < x1; x += 2, ++n) {
+                const uint16_t v = row[x];
+                s += v;
+                sq += static_cast<uint64_t>(v) * v;
+                lo = std::min(lo, v);
+                hi = std::max(hi, v);
+                ++hist[v >> shift];
+            }
+            count[c] += static_cast<uint64_t>(n);
+            sum[c] += s;
+            sumSq[c] += sq;
+            minV[c] = lo;
+            maxV[c] = hi;
+        }
+    }
+
+    for (int c = 0; c < out.channels; ++c) {
+        ChannelStats& ch = out.channel[c];
+        ch.count = count[c];
+        ch.sum = sum[c];
+        ch.sumSq = sumSq[c];
+        ch.minValue = minV[c];
+        ch.maxValue = maxV[c];
+    }
+}
+
+// 直方图 [lo, hi) 秩区间内的加权均值（bin 取中心值，边界 bin 按比例计入）
+double bandMean(const uint32_t* hist, int bins, double binWidth, double lo, double hi)
+{
+    double acc = 0.0, weight = 0.0, cum = 0.0;
+    for (int b = 0; b < bins && cum < hi; ++b) {
+        const double n = hist[b];
+        if (n <= 0.0)
+            continue;
+        const double take = std::min(cum + n, hi) - std::max(cum, lo);
+        if (take > 0.0) {
+            acc += take * (b + 0.5) * binWidth;
+            weight += take;
+        }
+        cum += n;
+    }
+    return weight > 0.0 ? acc / weight : 0.0;
+}
+
+} // namespace
+
+CfaLayout cfaLayoutFromName(const std::string& name)
+{
+    std::string s;
+    for (char c : name) {
+        if (!std::isspace(static_cast<unsigned char>(c)))
+            s.push_back(static_cast<char>(std::toupper(static_cast<unsigned char>(c))));
+    }
+    if (s == "RGGB")
+        return CfaLayout::RGGB;
+    if (s == "GRBG")
+        return CfaLayout::GRBG;
+    if (s == "GBRG")
+        return CfaLayout::GBRG;
+    if (s == "BGGR")
+        return CfaLayout::BGGR;
+    return CfaLayout::Mono;
+}
+
+// ---------------- ChannelStats ----------------
+
+void ChannelStats::merge(const ChannelStats& other)
+{
+    if (other.count == 0)
+        return;
+    count += other.count;
+    sum += other.sum;
+    sumSq += other.sumSq;
+    minValue = std::min(minValue, other.minValue);
+    maxValue = std::max(maxValue, other.maxValue);
+}
+
+double ChannelStats::mean() const
+{
+    return count ? static_cast<double>(sum) / static_cast<double>(count) : 0.0;
+}
+
+double ChannelStats::stdDev() const
+{
+    if (count == 0)
+        return 0.0;
+    const long double n = static_cast<long double>(count);
+    const long double m = static_cast<long double>(sum) / n;
+    const long double var = static_cast<long double>(sumSq) / n - m * m;
+    return var > 0.0L ? static_cast<double>(std::sqrt(var)) : 0.0;
+}
+
+// ---------------- RegionStats ----------------
+
+void RegionStats::reset(int channelCount, int binCount)
+{
+    channels = std::max(1, std::min(kMaxChannels, channelCount));
+    bins = std::max(1, binCount);
+    for (auto& ch : channel)
+        ch = ChannelStats();
+    histogram.assign(static_cast<size_t>(channels) * bins, 0u);
+}
+
+void RegionStats::merge(const RegionStats& other)
+{
+    if (other.empty())
+        return;
+    if (channels == 0) {
+        *this = other;
+        return;
+    }
+    if (other.channels != channels || other.bins != bins)
+        return;
+    for (int c = 0; c < channels; ++c)
+        channel[c].merge(other.channel[c]);
+    for (size_t i = 0; i < histogram.size(); ++i)
+        histogram[i] += other.histogram[i];
+}
+
+bool RegionStats::empty() const
+{
+    for (int c = 0; c < channels; ++c) {
+        if (channel[c].count)
+            return false;
+    }
+    return true;
+}
+
+ChannelStats RegionStats::combined() const
+{
+    ChannelStats all;
+    for (int c = 0; c < channels; ++c)
+        all.merge(channel[c]);
+    return all;
+}
+
+std::vector<uint32_t> RegionStats::combinedHistogram() const
+{
+    std::vector<uint32_t> all(static_cast<size_t>(std::max(0, bins)), 0u);
+    for (int c = 0; c < channels; ++c) {
+        const uint32_t* h = histogram.data() + static_cast<size_t>(c) * bins;
+        for (int b = 0; b < bins; ++b)
+            all[b] += h[b];
+    }
+    return all;
+}
+
+double RegionStats::percentile(int ch, double q) const
+{
+    if (bins <= 0 || channels <= 0)
+        return 0.0;
+    ChannelStats stats;
+    std::vector<uint32_t> merged;
+    const uint32_t* hist = nullptr;
+    if (ch < 0 || channels == 1) {
+        stats = combined();
+        merged = combinedHistogram();
+        hist = merged.data();
+    } else {
+        ch = std::min(ch, channels - 1);
+        stats = channel[ch];
+        hist = histogram.data() + static_cast<size_t>(ch) * bins;
+    }
+    if (stats.count == 0)
+        return 0.0;
+
+    const double binWidth = 65536.0 / bins;
+    const double target = std::max(0.0, std::min(1.0, q)) * static_cast<double>(stats.count);
+    double cum = 0.0;
+    double value = stats.maxValue;
+    for (int b = 0; b < bins; ++b) {
+        const double n = hist[b];
+        if (n > 0.0 && cum + n >= target) {
+            value = (b + (target - cum) / n) * binWidth;
+            break;
+        }
+        cum += n;
+    }
+    return std::max<double>(stats.minValue, std::min<double>(stats.maxValue, value));
+}
+
+// ---------------- 派生参数 ----------------
+
+void displayMeanStdDev(const RegionStats& stats, double* mean, double* stdDev)
+{
+    double m = 0.0, s = 0.0;
+    if (stats.channels <= 1) {
+        const ChannelStats all = stats.combined();
+        m = all.mean();
+        s = all.stdDev();
+    } else {
+        double meanSum = 0.0, varSum = 0.0;
+        int used = 0;
+        for (int c = 0; c < stats.channels; ++c) {
+            if (stats.channel[c].count == 0)
+                continue;
+            const double sd = stats.channel[c].stdDev();
+            meanSum += stats.channel[c].mean();
+            varSum += sd * sd;
+            ++used;
+        }
+        if (used > 0) {
+            m = meanSum / used;
+            s = std::sqrt(varSum / used);
+        }
+    }
+    if (mean)
+        *mean = m;
+    if (stdDev)
+        *stdDev = s;
+}
+
+StretchLevels autoStretch(const RegionStats& stats)
+{
+    StretchLevels out;
+    const ChannelStats all = stats.combined();
+    if (all.count == 0)
+        return out;
+
+    double mean = 0.0, sigma = 0.0;
+    displayMeanStdDev(stats, &mean, &sigma);
+
+    constexpr long long maxValue = 65535;
+    double bx = mean - sigma * 3.0;
+    double wx = mean + sigma * 5.0;
+    if (bx == wx)
+        wx = bx + 10.0;
+    bx = std::max(0.0, std::min<double>(maxValue, bx));
+    wx = std::max(0.0, std::min<double>(maxValue, wx));
+
+    long long bi = std::llround(bx);
+    long long wi = std::llround(wx);
+    if (wi <= bi) {
+        if (all.maxValue > all.minValue) {
+            bi = all.minValue;
+            wi = all.maxValue;
+        } else {
+            wi = bi + 1;
+        }
+    }
+    bi = std::max(0LL, std::min(maxValue, bi));
+    wi = std::max(0LL, std::min(maxValue, wi));
+    if (wi <= bi) {
+        wi = std::min(maxValue, bi + 1);
+        if (wi <= bi)
+            bi = std::max(0LL, wi - 1);
+    }
+
+    // 过曝保护：画面整体接近饱和时保留一个明显更亮的窗口，避免“高亮满屏”被拉成近黑
+    if (mean >= maxValue * 0.85 || all.minValue >= static_cast<uint16_t>(maxValue * 0.75)) {
+        wi = maxValue;
+        bi = std::min(bi, maxValue / 2);
+    }
+
+    out.black = static_cast<uint16_t>(bi);
+    out.white = static_cast<uint16_t>(wi);
+    return out;
+}
+
+WhiteBalance whiteBalance(const RegionStats& stats, uint16_t offset)
+{
+    WhiteBalance wb;
+    if (stats.channels < kMaxChannels || stats.bins <= 0) {
+        wb.reason = "mono";
+        return wb;
+    }
+
+    const double binWidth = 65536.0 / stats.bins;
+    for (int c = 0; c < kMaxChannels; ++c) {
+        const double n = static_cast<double>(stats.channel[c].count);
+        if (n <= 0.0) {
+            wb.reason = "empty channel";
+            return wb;
+        }
+        const uint32_t* hist = stats.histogram.data() + static_cast<size_t>(c) * stats.bins;
+        const double level = bandMean(hist, stats.bins, binWidth, 0.15 * n, 0.85 * n);
+        wb.level[c] = std::max(0.0, level - offset);
+    }
+
+    const double r = wb.level[ChannelR];
+    const double g1 = wb.level[ChannelG1];
+    const double g2 = wb.level[ChannelG2];
+    const double b = wb.level[ChannelB];
+    if (r <= 32.0 || g1 <= 32.0 || g2 <= 32.0 || b <= 32.0) {
+        wb.reason = "signal too low";
+        return wb;
+    }
+    const double g = (g1 + g2) * 0.5;
+    if (std::fabs(g1 - g2) / g > 0.12) {
+        wb.reason = "G1/G2 mismatch";
+        return wb;
+    }
+
+    wb.gainR = std::max(0.1, std::min(3.0, g / r));
+    wb.gainB = std::max(0.1, std::min(3.0, g / b));
+    wb.applied = true;
+    return wb;
+}
+
+// ---------------- TileStatsGrid ----------------
+
+bool TileStatsGrid::build(const uint16_t* data, int width, int height, size_t rowStride, CfaLayout cfa,
+                          const TileStatsOptions& options)
+{
+    m_levels.clear();
+    if (!data || width <= 0 || height <= 0 || rowStride < static_cast<size_t>(width))
+        return false;
+
+    const int bits = std::max(4, std::min(16, options.histogramBits));
+    m_width = width;
+    m_height = height;
+    m_tileSize = std::max(16, options.tileSize);
+    m_cfa = cfa;
+    m_channels = (cfa == CfaLayout::Mono) ? 1 : kMaxChannels;
+    m_bins = 1 << bits;
+    const int shift = 16 - bits;
+    const int* map = channelMap(cfa);
+
+    Level base;
+    base.nx = (width + m_tileSize - 1) / m_tileSize;
+    base.ny = (height + m_tileSize - 1) / m_tileSize;
+    base.nodes.resize(static_cast<size_t>(base.nx) * base.ny);
+    for (auto& node : base.nodes)
+        node.reset(m_channels, m_bins);
+
+    const int tileCount = base.nx * base.ny;
+    int threads = options.threads > 0 ? options.threads : static_cast<int>(std::thread::hardware_concurrency());
+    threads = std::max(1, std::min(threads, tileCount));
+
+    std::atomic<int> nextTile{0};
+    auto worker = [&] {
+        for (int t = nextTile.fetch_add(1); t < tileCount; t = nextTile.fetch_add(1)) {
+            const int tx = t % base.nx;
+            const int ty = t / base.nx;
+            const int x0 = tx * m_tileSize;
+            const int y0 = ty * m_tileSize;
+            scanTile(data, rowStride, x0, y0, std::min(width, x0 + m_tileSize), std::min(height, y0 + m_tileSize),
+                     map, shift, base.nodes[static_cast<size_t>(t)]);
+        }
+    };
+    std::vector<std::thread> pool;
+    pool.reserve(static_cast<size_t>(threads - 1));
+    for (int t = 1; t < threads; ++t)
+        pool.emplace_back(worker);
+    worker();
+    for (auto& th : pool)
+        th.join();
+    m_levels.push_back(std::move(base));
+
+    // 逐层 2×2 合并直到 1×1
+    while (m_levels.back().nx > 1 || m_levels.back().ny > 1) {
+        const Level& lower = m_levels.back();
+        Level upper;
+        upper.nx = (lower.nx + 1) / 2;
+        upper.ny = (lower.ny + 1) / 2;
+        upper.nodes.resize(static_cast<size_t>(upper.nx) * upper.ny);
+        for (int y = 0; y < upper.ny; ++y) {
+            for (int x = 0; x < upper.nx; ++x) {
+                RegionStats& node = upper.nodes[static_cast<size_t>(y) * upper.nx + x];
+                node.reset(m_channels, m_bins);
+                for (int dy = 0; dy < 2; ++dy) {
+                    for (int dx = 0; dx < 2; ++dx) {
+                        const int cx = 2 * x + dx, cy = 2 * y + dy;
+                        if (cx < lower.nx && cy < lower.ny)
+                            node.merge(lower.nodes[static_cast<size_t>(cy) * lower.nx + cx]);
+                    }
+                }
+            }
+        }
+        m_levels.push_back(std::move(upper));
+    }
+    return true;
+}
+
+size_t TileStatsGrid::bytes() const
+{
+    size_t total = 0;
+    for (const auto& level : m_levels) {
+        for (const auto& node : level.nodes)
+            total += sizeof(RegionStats) + node.histogram.size() * sizeof(uint32_t);
+    }
+    return total;
+}
+
+const RegionStats& TileStatsGrid::tile(int tx, int ty) const
+{
+    const Level& base = m_levels.front();
+    tx = std::max(0, std::min(base.nx - 1, tx));
+    ty = std::max(0, std::min(base.ny - 1, ty));
+    return base.nodes[static_cast<size_t>(ty) * base.nx + tx];
+}
+
+const RegionStats& TileStatsGrid::global() const
+{
+    return m_levels.back().nodes.front();
+}
+
+RegionStats TileStatsGrid::region(int x, int y, int w, int h) const
+{
+    RegionStats out;
+    out.reset(m_channels, m_bins);
+    if (m_levels.empty() || w <= 0 || h <= 0)
+        return out;
+    const int x0 = std::max(0, x), y0 = std::max(0, y);
+    const int x1 = std::min(m_width, x + w), y1 = std::min(m_height, y + h);
+    if (x1 <= x0 || y1 <= y0)
+        return out;
+
+    const int tx0 = x0 / m_tileSize, ty0 = y0 / m_tileSize;
+    const int tx1 = (x1 - 1) / m_tileSize + 1, ty1 = (y1 - 1) / m_tileSize + 1;
+    collect(levels() - 1, 0, 0, tx0, ty0, tx1, ty1, out);
+    return out;
+}
+
+void TileStatsGrid::collect(int level, int nodeX, int nodeY, int tx0, int ty0, int tx1, int ty1,
+                            RegionStats& out) const
+{
+    const Level& lv = m_levels[static_cast<size_t>(level)];
+    if (nodeX >= lv.nx || nodeY >= lv.ny)
+        return;
+    // 该节点覆盖的瓦片范围
+    const int span = 1 << level;
+    const int nx0 = nodeX * span, ny0 = nodeY * span;
+    const int nx1 = std::min(nx0 + span, tilesX()), ny1 = std::min(ny0 + span, tilesY());
+    if (nx1 <= tx0 || nx0 >= tx1 || ny1 <= ty0 || ny0 >= ty1)
+        return;
+    if (nx0 >= tx0 && nx1 <= tx1 && ny0 >= ty0 && ny1 <= ty1) {
+        out.merge(lv.nodes[static_cast<size_t>(nodeY) * lv.nx + nodeX]);
+        return;
+    }
+    for (int dy = 0; dy < 2; ++dy) {
+        for (int dx = 0; dx < 2; ++dx)
+            collect(level - 1, 2 * nodeX + dx, 2 * nodeY + dy, tx0, ty0, tx1, ty1, out);
+    }
+}
+
+} // namespace image
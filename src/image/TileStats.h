@@ -0,0 +1,129 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace image {
+
+// Bayer 相位：四个位置 (x&1, y&1) 各属哪个颜色通道；Mono 只有一个通道
+enum class CfaLayout { Mono, RGGB, GRBG, GBRG, BGGR };
+
+// 大小写不敏感；空、"null"、"MONO" 或无法识别时返回 Mono
+CfaLayout cfaLayoutFromName(const std::string& name);
+
+constexpr int kMaxChannels = 4;
+enum Channel { ChannelR = 0, ChannelG1 = 1, ChannelG2 = 2, ChannelB = 3 };  ///< G1 为偶数行上的绿像素
+
+struct ChannelStats {
+    uint64_t count{0};
+    uint64_t sum{0};
+    uint64_t sumSq{0};              ///< 16bit 下单通道约 40 亿像素以内不溢出
+    uint16_t minValue{65535};
+    uint16_t maxValue{0};
+
+    void merge(const ChannelStats& other);
+    double mean() const;
+    double stdDev() const;
+};
+
+struct TileStatsOptions {
+    int tileSize{512};              ///< 与瓦片金字塔最高精度层（z=maxZoomLevel）的瓦片一一对应
+    int histogramBits{10};          ///< 每通道 2^bits 个 bin，均分 0..65535（10 → 每 bin 64 ADU）
+    int threads{0};                 ///< 0 表示 hardware_concurrency
+};
+
+// 一块区域的统计：单个瓦片，或若干瓦片合并后的结果（合并是逐项相加，与直接统计该区域完全一致）
+struct RegionStats {
+    int channels{0};
+    int bins{0};
+    ChannelStats channel[kMaxChannels];
+    std::vector<uint32_t> histogram;    ///< channels×bins，按通道连续存放
+
+    void reset(int channelCount, int binCount);
+    void merge(const RegionStats& other);
+    bool empty() const;
+
+    ChannelStats combined() const;                  ///< 所有通道合在一起
+    std::vector<uint32_t> combinedHistogram() const;
+    // 分位数 q∈[0,1]；channel<0 表示所有通道；bin 内按线性插值，结果钳制在该通道 min..max 内
+    double percentile(int channel, double q) const;
+};
+
+// 显示用的均值/标准差：Mono 即原始统计；彩色 RAW 取各通道均值的平均、各通道方差的平均，
+// 去掉 Bayer 通道间的电平差（否则标准差被拉大，拉伸偏灰）
+void displayMeanStdDev(const RegionStats& stats, double* mean, double* stdDev);
+
+struct StretchLevels {
+    uint16_t black{0};
+    uint16_t white{65535};
+};
+
+// 与 Tools::GetAutoStretch(mode=0) 同一口径：黑点 mean−3σ、白点 mean+5σ（均值/σ 取 displayMeanStdDev）；
+// 整数域四舍五入并保证白点 > 黑点，区间反转时回退到 min/max；画面接近饱和时保留更亮的窗口
+StretchLevels autoStretch(const RegionStats& stats);
+
+struct WhiteBalance {
+    double gainR{1.0};
+    double gainB{1.0};
+    bool applied{false};            ///< false 时增益为 1/1，reason 说明原因
+    std::string reason;
+    double level[kMaxChannels]{};   ///< 各通道扣除 offset 后的中亮度均值
+};
+
+// 灰度世界白平衡：各通道直方图取 15%..85% 分位之间的均值（扣除 offset）作为该通道电平，
+// gainR = G/R、gainB = G/B 钳制到 0.1..3；信号过低或 G1/G2 失衡（>12%）时不做白平衡
+WhiteBalance whiteBalance(const RegionStats& stats, uint16_t offset = 0);
+
+// 按瓦片网格统计一幅 16bit 图像，并把相邻 2×2 块逐层合并成四叉树：
+// 顶层即整幅图像的统计，任意视口按“完全落在视口内的最大块”拼出来，只需合并 O(周长) 个节点
+class TileStatsGrid
+{
+public:
+    // 一次扫描（按瓦片多线程），rowStride 以像素计；CFA 相位按图像绝对坐标确定
+    // 尺寸非法时返回 false
+    bool build(const uint16_t* data,
+               int width,
+               int height,
+               size_t rowStride,
+               CfaLayout cfa,
+               const TileStatsOptions& options = TileStatsOptions());
+
+    bool empty() const { return m_levels.empty(); }
+    int width() const { return m_width; }
+    int height() const { return m_height; }
+    int tileSize() const { return m_tileSize; }
+    int tilesX() const { return m_levels.empty() ? 0 : m_levels.front().nx; }
+    int tilesY() const { return m_levels.empty() ? 0 : m_levels.front().ny; }
+    int levels() const { return static_cast<int>(m_levels.size()); }
+    int channels() const { return m_channels; }
+    int bins() const { return m_bins; }
+    CfaLayout cfa() const { return m_cfa; }
+    size_t bytes() const;
+
+    const RegionStats& tile(int tx, int ty) const;
+    const RegionStats& global() const;
+
+    // 像素矩形 [x, x+w)×[y, y+h)，向外取整到整瓦片（与前端按瓦片请求的范围一致）；矩形与图像不相交时返回空统计
+    RegionStats region(int x, int y, int w, int h) const;
+
+private:
+    struct Level {
+        int nx{0};
+        int ny{0};
+        std::vector<RegionStats> nodes;
+    };
+
+    void collect(int level, int nodeX, int nodeY, int tx0, int ty0, int tx1, int ty1, RegionStats& out) const;
+
+    int m_width{0};
+    int m_height{0};
+    int m_tileSize{0};
+    int m_channels{0};
+    int m_bins{0};
+    CfaLayout m_cfa{CfaLayout::Mono};
+    std::vector<Level> m_levels;    ///< [0] 单瓦片，逐层 2×2 合并，末层 1×1
+};
+
+} // namespace image
@@ -458,10 +458,6 @@ MainWindow::MainWindow(QObject *parent) : QObject(parent)
     glCameraSize_width = 0.0;
     glCameraSize_height = 0.0;
 
-    system_timer = new QTimer(this); // 用于对系统的监测
-    connect(system_timer, &QTimer::timeout, this, &MainWindow::updateCPUInfo);
-    system_timer->start(3000);
-
     Logger::Initialize();
     getHostAddress();
     initializeStorageAndWebPaths();
@@ -854,6 +850,8 @@ void MainWindow::onTimeout()
     // TODO(PHD2): PHD2 数据轮询已停用（导星改为 INDI 直出图），如需恢复再启用 ShowPHDdata()
     // ShowPHDdata();
 
+    syncDeviceStateBusRoles();
+
     // 显示赤道仪指向
     mountDisplayCounter++;
     if (dpMount != NULL)
@@ -862,23 +860,38 @@ void MainWindow::onTimeout()
         {
             if (mountDisplayCounter >= 5)
             {
+                const bool fullPush = (++mountFullPushCounter >= 10);
+                if (fullPush)
+                    mountFullPushCounter = 0;
+                // 快照无效（驱动未上报）时版本为 0，照常每轮推送
+                auto changed = [fullPush](uint64_t version, uint64_t &pushed) {
+                    const bool push = fullPush || version == 0 || version != pushed;
+                    pushed = version;
+                    return push;
+                };
+                devices::Versioned<devices::EqCoord> coordVersion;
+                devices::Versioned<bool> parkVersion;
+                indi_Client->readSnapshot(dpMount, &devices::PropertySnapshot::eqCoord, coordVersion);
+                indi_Client->readSnapshot(dpMount, &devices::PropertySnapshot::parked, parkVersion);
 
                 double RA_HOURS, DEC_DEGREE;
                 indi_Client->getTelescopeRADECJNOW(dpMount, RA_HOURS, DEC_DEGREE);
                 double CurrentRA_Degree = Tools::HourToDegree(RA_HOURS);
                 double CurrentDEC_Degree = DEC_DEGREE;
 
-                emit wsThread->sendMessageToClient("TelescopeRADEC:"
-                    + QString::number(CurrentRA_Degree)
-                    + ":" + QString::number(CurrentDEC_Degree));
+                if (changed(coordVersion.version, pushedMountCoordVersion))
+                    emit wsThread->sendMessageToClient("TelescopeRADEC:"
+                        + QString::number(CurrentRA_Degree)
+                        + ":" + QString::number(CurrentDEC_Degree));
 
                 // Logger::Log("当前指向:RA:" + std::to_string(RA_HOURS) + " 小时,DEC:" + std::to_string(CurrentDEC_Degree) + " 度", LogLevel::INFO, DeviceType::MAIN);
 
                 // 直接每次执行原"慢速"查询内容
                 bool isParked = false;
                 indi_Client->getTelescopePark(dpMount, isParked);
-                emit wsThread->sendMessageToClient(
-                    isParked ? "TelescopePark:ON" : "TelescopePark:OFF");
+                if (changed(parkVersion.version, pushedMountParkVersion))
+                    emit wsThread->sendMessageToClient(
+                        isParked ? "TelescopePark:ON" : "TelescopePark:OFF");
 
                 QString NewTelescopePierSide;
                 indi_Client->getTelescopePierSide(dpMount, NewTelescopePierSide);
@@ -922,8 +935,12 @@ void MainWindow::onTimeout()
                     indi_Client->getTelescopeTrackEnable(dpMount, isTrack);
                 }
 
-                emit wsThread->sendMessageToClient(isTrack ? "TelescopeTrack:ON"
-                                                           : "TelescopeTrack:OFF");
+                // 在上面可能的关跟踪之后再取版本
+                devices::Versioned<bool> trackVersion;
+                indi_Client->readSnapshot(dpMount, &devices::PropertySnapshot::tracking, trackVersion);
+                if (changed(trackVersion.version, pushedMountTrackVersion))
+                    emit wsThread->sendMessageToClient(isTrack ? "TelescopeTrack:ON"
+                                                               : "TelescopeTrack:OFF");
 
                 if (!FirstRecordTelescopePierSide)
                 {
@@ -1007,17 +1024,14 @@ void MainWindow::onTimeout()
             if (isMainCameraSDK)
             {
                 // SDK 模式：在 SDK 线程异步获取温度，避免阻塞主线程（与 GetSingleFrame 可能竞争设备锁）
+                // 命令在连接时已预解析（prepareSdkMainCameraPollCommands）：按驱动名 + 句柄 + id 直接分派
                 SdkSerialExecutor *mainExec = sdkMainCameraExecutor();
-                if (mainExec && mainExec->isRunning() && sdkMainCameraHandle != nullptr)
+                const std::shared_ptr<const SdkCommand> tempCmd = sdkMainTempCmd;
+                if (mainExec && mainExec->isRunning() && sdkMainCameraHandle != nullptr && tempCmd)
                 {
                     const SdkDeviceHandle handleSnap = sdkMainCameraHandle;
-                    mainExec->post([this, handleSnap]() {
-                        SdkCommand getTempCmd;
-                        getTempCmd.type = SdkCommandType::Custom;
-                        getTempCmd.name = "GetCurrentTemperature";
-                        getTempCmd.payload = std::any();
-                        // 直接通过设备句柄调用，无需指定驱动名称
-                        SdkResult tempRes = SdkManager::instance().callByHandle(handleSnap, getTempCmd);
+                    mainExec->post([this, handleSnap, tempCmd, driverName = sdkMainCameraDriver]() {
+                        SdkResult tempRes = SdkManager::instance().call(driverName, handleSnap, *tempCmd);
 
                         // 回到主线程更新UI
                         if (tempRes.success && tempRes.payload.has_value()) {
@@ -48,6 +48,7 @@
 #include <vector>
 #include <string>
 #include <memory>
+#include <map>
 #include <set>
 #include <unordered_set>
 #include <algorithm>
@@ -83,6 +84,15 @@ namespace fs = std::filesystem;
 
 #include "sdks/SdkSerialExecutor.h"
 #include "sdks/SdkCommon.h"  // SDK 通用类型（SdkFrameData, SdkChipInfo, SdkAreaInfo 等）
+#include "fits/FitsWriter.h"  // 后台 FITS 写盘服务（归档写入/压缩/头模板）
+#include "storage/FileExportEngine.h"  // 进程内文件导出（U 盘复制/续传/校验）
+#include "storage/ImageCatalog.h"      // 图库索引（增量对账/inotify/分页查询/缩略图）
+#include "solver/PlateSolveService.h"   // 常驻解析服务（进程内 StellarSolver，索引常驻内存）
+#include "devices/DeviceStateBus.h"     // 设备状态总线（INDI/SDK 回调写入，事件驱动等待）
+#include "schedule/SchedulePlanner.h"  // 计划表预排（星历、中天/翻转时刻、步骤时间线）
+#include "schedule/StagePipeline.h"    // 计划表执行阶段的依赖/并行规则与每行开销统计
+#include "telemetry/SystemTelemetry.h" // 系统遥测（/proc 采样、按子系统的线程 CPU、压缩增量）
+#include "image/TileStats.h"       // 按瓦片统计直方图/min/max/和，四叉树合并出全局与任意视口的拉伸/白平衡参数
 
 class QThread;
 
@@ -170,12 +180,16 @@ public:
 
 /**********************  版本/构建信息 & 系统信息  **********************/
 public:
-    QTimer *system_timer = nullptr; // 系统信息定时器
+    // 系统遥测：独立线程直接读 /proc、/sys、statvfs（不再每次 fork cat/top），按线程名统计各子系统 CPU
+    std::unique_ptr<telemetry::TelemetryService> telemetryService;
 
     /**
-     * @brief 更新 CPU 信息到状态/日志
+     * @brief 把一次遥测采样上报前端（主线程）
+     * @param sample 采样结果
+     * @param delta  压缩增量 JSON（无变化时为空）
+     * @note 兼容旧消息 updateCPUInfo:<温度>:<占用>，另发 SystemTelemetry:<增量 JSON>
      */
-    void updateCPUInfo();
+    void updateCPUInfo(const telemetry::TelemetrySample &sample, const QString &delta);
 
     /**
      * @brief 获取构建日期字符串（用于 QT_Client_Version）
@@ -434,6 +448,9 @@ public:
     // 单点 SDK 相机扫描（ScanQHYCCD）。后续在此加"一次/缓存/共享"以降 EP0 频次（见 doc §7）。
     SdkResult sdkScanQhyCameras(const QString& driverName);
 
+    // 主相机注册到 SdkManager 后预解析周期轮询用的命令（温度），轮询时不再按名字分派
+    void prepareSdkMainCameraPollCommands(const std::string& driverName);
+
     // 按需打开相机池中某个槽位的相机（M2：SDK 只 open 被分配的相机）。
     // 已打开则直接返回其句柄；未打开才真正 OpenQHYCCD 并存回池。失败返回 nullptr。
     SdkDeviceHandle ensureSdkCameraOpen(int poolIndex, const QString& role);
@@ -558,6 +575,11 @@ public:
     QTimer *sdkMainLiveTimer = nullptr;
     std::atomic_bool sdkMainLiveLoopOn{false};
     std::atomic_bool sdkMainLiveFrameInFlight{false};
+    // Live 取帧命令（预解析命令 id，仅在主相机 SDK 执行线程内使用）：每帧复用，避免重复按名字分派
+    SdkCommand sdkMainLiveGetFrameCmd{SdkCommandType::Custom, "GetLiveFrame", {}};
+    // 温度轮询命令：主相机注册到 SdkManager 时预解析一次（prepareSdkMainCameraPollCommands），轮询按 id 分派
+    std::shared_ptr<const SdkCommand> sdkMainTempCmd;
+    std::string sdkMainCameraDriver;        // 与 sdkMainTempCmd 同时设置
     // SDK Live（主相机）后处理定时器（主线程）：从“最新帧邮箱”取最新帧，按限帧刷新前端（FITS->PNG/瓦片）
     QTimer *sdkMainLiveProcessTimer = nullptr;
     // Live 拉帧退避（ms since epoch）：用于在 BeginLive 初期/失败时降低 GetLiveFrame 频率，避免刷爆驱动
@@ -596,11 +618,39 @@ public:
     void FocusingLooping();
     
     /**
-     * @brief 保存 SDK 模式下获取的 SdkFrameData 为 FITS 文件
+     * @brief 保存 SDK 模式下获取的 SdkFrameData 为 FITS 文件（同步，供 /dev/shm 预览等立即读回的场景）
      * @param frame SDK 相机帧数据
      * @param filepath FITS 文件保存路径
+     * @param header 头关键字模板（可为空）
+     */
+    void SaveQhyFrameDataToFits(const SdkFrameData& frame, const std::string& filepath,
+                                const fits::HeaderTemplate& header = fits::HeaderTemplate());
+
+    // 后台 FITS 写盘服务：SDK 全幅帧归档时直接从内存帧写到最终目录（可选压缩），不再复制 /dev/shm 预览文件
+    std::unique_ptr<fits::FitsWriter> fitsWriter;
+    QString fitsSaveCompression = "none";   // 归档 FITS 压缩方式：none/rice/gzip（MainCamera/FitsCompression）
+    // 最近一次主相机 SDK 全幅帧及其头模板（与 lastMainCaptureFitsPath 对应；INDI 出图时清空）
+    std::shared_ptr<const SdkFrameData> lastMainCaptureFrame;
+    fits::HeaderTemplate lastMainCaptureHeader;
+
+    /**
+     * @brief 生成主相机 FITS 头模板（相机/望远镜/焦距/增益/温度/站点等，主线程调用）
+     * @param exposureStartMs 曝光开始时间（ms since epoch，写 DATE-OBS）
+     * @param exposureMs 曝光时长（ms）
      */
-    void SaveQhyFrameDataToFits(const SdkFrameData& frame, const std::string& filepath);
+    fits::HeaderTemplate buildMainCameraFitsHeader(qint64 exposureStartMs, int exposureMs) const;
+
+    /**
+     * @brief 把最近一次主相机 SDK 帧交给后台写盘服务，直接写到归档路径
+     * @return 已入队返回 true；无内存帧/队列已满/写盘服务已停止返回 false（调用方回退到 saveImageFile 复制）
+     *
+     * 不在主线程等待队列空位：队列已满时发送 FitsWriteThrottled:<pending>:<capacity> 后直接返回 false。
+     * 写完后回主线程发送 CaptureImageSaveStatus 与 FitsWriteTiming，再调用 onSaved（成功时 path 为归档路径，失败为空）。
+     */
+    bool submitMainCaptureArchive(const QString &destinationPath,
+                                  const QString &functionName,
+                                  const fits::HeaderTemplate &header,
+                                  std::function<void(const QString &path)> onSaved = nullptr);
     
     // SDK 曝光定时器相关
     QTimer *sdkExposureTimer = nullptr;           // SDK 曝光图像获取定时器
@@ -748,9 +798,15 @@ public:
         QString levelMode = "full";    // 瓦片层级模式：full=全层级，minmax=仅最小层+最大层
 
         // 直方图（用于前端拉伸/显示）
-        int histogramBins = 0;                 // bin 数（建议 256）
+        int histogramBins = 0;                 // bin 数（按瓦片统计时为 1024，每 bin 64 ADU）
         uint64_t histogramTotal = 0;           // 总像素数
-        std::vector<uint32_t> histogram;       // bin 计数
+        std::vector<uint32_t> histogram;       // bin 计数（所有通道合计）
+        int histogramChannels = 0;             // 分通道直方图的通道数（彩色 RAW 为 4：R/G1/G2/B；Mono 为 0）
+        std::vector<uint32_t> channelHistogram; // histogramChannels×histogramBins，按通道连续存放
+
+        // 逐瓦片统计（与 z=maxZoomLevel 层瓦片一一对应），用于按视口合并出局部拉伸/白平衡参数；非 16bit 图像为空
+        QString statsMode = "neutral";         // tiles=后端按瓦片统计得出，neutral=中性参数（前端自行优化）
+        std::shared_ptr<const image::TileStatsGrid> tileStats;
     };
 
 
@@ -770,8 +826,8 @@ public:
      * @param image16 16位原始图像
      * @param cfa CFA模式
      * @param maxMergeFactor 最低精度层的合并倍数（2^N，范围建议[1,16]）
-     * @param enableHistogram 是否统计直方图（为 false 时仅计算 min/max/mean/stdDev/blackLevel/whiteLevel）；默认 false
-     * @return GPM元数据
+     * @param enableHistogram 是否把直方图写入 GPM（统计本身与逐瓦片统计同一遍扫描完成，此开关只决定是否导出/发送）；默认 false
+     * @return GPM元数据（tileStats 保存逐瓦片统计，供视口参数使用）
      */
     TileGPM calculateGPM(const cv::Mat& image16, const QString& cfa, int maxMergeFactor = 16, bool enableHistogram = false);
 
@@ -863,6 +919,23 @@ public:
      * @param gpm GPM（包含 sessionId 与 histogram 字段）
      */
     void sendHistogramToClient(const TileGPM& gpm);
+    // 前端 getHistogram：按当前帧的逐瓦片统计发送直方图
+    void sendCurrentHistogramToClient();
+    // 由逐瓦片统计的顶层节点填 GPM 的直方图字段（合计与分通道）
+    static void fillGpmHistogram(TileGPM& gpm, const image::TileStatsGrid& stats);
+    // 拉伸窗口相对上次推送直方图时变化超过 1% 返回 true 并记下新窗口（只在出图线程调用）
+    bool histogramStretchChanged(uint16_t blackLevel, uint16_t whiteLevel);
+    uint16_t lastHistogramBlackLevel = 0;
+    uint16_t lastHistogramWhiteLevel = 0;
+
+    /**
+     * @brief 按当前视口从逐瓦片统计合并出局部拉伸/白平衡参数并发送给前端
+     * @param sessionId/frameId 当前帧（前端按此丢弃旧帧的参数）
+     * @param stats 当前帧的逐瓦片统计
+     * @param x,y,w,h 视口矩形（原图像素）
+     */
+    void sendViewportStatsToClient(const QString& sessionId, quint64 frameId, const image::TileStatsGrid& stats,
+                                   int x, int y, int w, int h);
     void emitCaptureTrace(const QString& stage, qint64 startedAtMs = -1, const QString& detail = QString());
 
     /**
@@ -913,6 +986,7 @@ public:
         QString cfa;
         uint16_t blackLevel = 0;
         uint16_t whiteLevel = 65535;
+        std::shared_ptr<const image::TileStatsGrid> tileStats; // 逐瓦片统计（视口拉伸/白平衡参数）
     };
     mutable std::mutex tileFrameMutex;
     TileFrameState tileFrame;
@@ -1508,6 +1582,15 @@ public:
     // 计划任务表：避免 Refocus=ON 时在 startSetCFW <-> AutoFocus 回调之间无限重入
     // 语义：记录“已经为哪个 schedule_currentNum 行触发过一次 Refocus（自动对焦）”
     int schedule_refocusTriggeredIndex = -1;
+    // 已为哪一行执行过计划内的中天翻转（每行最多一次）
+    int schedule_flipDoneIndex = -1;
+    schedule::Plan schedulePlan;     // 当前计划表的预排时间线（每开始一行重排剩余行）
+    // 流水线执行：转动时已下发滤镜的行 / 滤镜已确认到位的行
+    int schedule_filterPrefetchIndex = -1;
+    int schedule_filterSettledIndex = -1;
+    QElapsedTimer scheduleFilterElapsed;     // 转动时下发滤镜的起点（等待到位的超时）
+    uint64_t scheduleSolveId = 0;            // 正在解析的计划表帧（PlateSolveService 请求 id），0 表示空闲
+    std::map<int, schedule::OverheadTracker> scheduleOverhead;  // 行号 -> 阶段区间，行结束且尾部写盘/解析完成后上报
     int expTime_ms = 0;              // 当前拍摄时间（ms）
     int exposureDelayElapsed_ms = 0; // 曝光延迟已过去的时间（ms）
 
@@ -1532,6 +1615,49 @@ public:
      */
     void nextSchedule();
 
+    /**
+     * @brief 从 fromIndex 行起按当前时刻重排计划表时间线（高度曲线、中天/翻转、各步骤预计起止），
+     *        结果存入 schedulePlan 并以 SchedulePlan:<json> 发给前端做甘特图预览
+     * @param fromIndex 起始行
+     */
+    void rebuildSchedulePlan(int fromIndex);
+
+    /**
+     * @brief 按预排的中天时刻和实际时钟判断：下一帧是否会跨过子午线限位，需要先翻转
+     * @return 需要在这一帧前翻转返回 true
+     */
+    bool scheduleMeridianFlipDue();
+
+    /**
+     * @brief 两帧之间执行中天翻转：等目标过中天后重新 GOTO 同一目标，完成后按原流程继续拍摄
+     */
+    void startScheduleMeridianFlip();
+
+    /**
+     * @brief 转动开始时就下发本行滤镜（滤镜轮与赤道仪互不影响），startSetCFW 只需等待到位
+     */
+    void prefetchScheduleFilter();
+
+    /**
+     * @brief 滤镜是否已到位且不在转动中
+     * @param pos 槽位编号（1 起）
+     */
+    bool scheduleFilterInPosition(int pos);
+
+    /**
+     * @brief 计划表帧已归档：结束写盘区间，提交后台解析（与下一帧曝光并行）
+     * @param row 计划表行
+     * @param frame 帧号（1 起）
+     * @param path 归档路径；写盘失败为空
+     */
+    void scheduleFrameSaved(int row, int frame, const QString &path);
+
+    /**
+     * @brief 行已结束且尾部写盘/解析都完成时，发送 ScheduleOverhead:<json>（各阶段耗时与流水线省掉的开销）
+     * @param row 计划表行
+     */
+    void reportScheduleOverhead(int row);
+
     /**
      * @brief 启动赤道仪转动
      * @param ra 赤经（小时）
@@ -1606,6 +1732,22 @@ public:
      */
     bool WaitForFocuserToComplete();
 
+    /**
+     * @brief 设备状态总线有变化（已切回主线程）：正在等待赤道仪/拍摄的计划表步骤立即复核，
+     *        不必等到下一次 1s 定时
+     * @param role devices::DeviceRole
+     */
+    void onDeviceStateChanged(int role);
+
+    /**
+     * @brief 按 dpMount/dpMainCamera 等指针对齐设备状态总线的角色绑定
+     *        （绑定/解绑散落在多处，统一在 onTimeout 里对齐，名字不变时无开销）
+     */
+    void syncDeviceStateBusRoles();
+
+    int deviceStateBusToken = 0;   // DeviceStateBus 订阅句柄
+    QElapsedTimer connectAllElapsedTimer;  // ConnectAllDeviceOnce 起点，用于上报端到端连接耗时
+
     /**
      * @brief 计算计划表步骤的进度
      * @param stepNumber 步骤编号（1=等待，2=转动，3=滤镜，4-N=拍摄）
@@ -1741,6 +1883,11 @@ public:
     int MoveFileToUSB();
 
     int mountDisplayCounter = 0;   // 挂载显示计数
+    // 赤道仪状态推送：按属性快照版本只推变化的值，每 10 轮全量补推一次（新连上的前端）
+    int mountFullPushCounter = 0;
+    uint64_t pushedMountCoordVersion = 0;
+    uint64_t pushedMountParkVersion = 0;
+    uint64_t pushedMountTrackVersion = 0;
     int MainCameraStatusCounter = 0;// 主相机状态计数
     int glMainCameraBinning = 1;   // 主相机 bin
 
@@ -1805,11 +1952,87 @@ public:
     long long getTotalSize(const QStringList &filePaths);
 
     /**
-     * @brief 移动图像到 U 盘（并删除原始）
+     * @brief 复制图像到 U 盘（交给导出引擎异步执行，逐文件回报 HasMoveImgnNUmber，整体进度回报 UsbExportProgress）
      * @param RemoveImgPath 路径列表
      */
     void CopyImagesToUsb(QStringList RemoveImgPath, QString usbName = "");
 
+    /**
+     * @brief 取消正在进行的 U 盘导出（正在复制的文件保留 .part，可续传）
+     */
+    void CancelUsbExport();
+
+    /**
+     * @brief 续传上一次未完成的 U 盘导出（已完成的文件跳过，中断的文件从 .part 末尾继续）
+     */
+    void ResumeUsbExport();
+
+    // U 盘导出引擎：进程内 copy_file_range/sendfile 复制，每个设备串行写，字节级进度
+    std::unique_ptr<storage::FileExportEngine> exportEngine;
+    uint64_t usbExportBatchId = 0;     // 最近一次 U 盘导出批次（用于取消/续传）
+    int usbExportSucceeded = 0;        // 当前批次已成功的文件数（HasMoveImgnNUmber 计数）
+    bool usbExportVerify = false;      // 导出后重读校验（MainCamera/UsbExportVerify）
+
+    // 图库索引（ImageSaveBasePath 下 CaptureImage/ScheduleImage/solveFailedImage）：
+    // 持久化在 <ImageSaveBasePath>/.quarcs_catalog.idx，启动时增量对账，之后由 inotify 与写盘回调维护
+    std::unique_ptr<storage::ImageCatalog> imageCatalog;
+
+    /**
+     * @brief 归档写盘完成后登记到图库（可在任意线程调用）
+     * @param path 文件绝对路径（不在 ImageSaveBasePath 下时忽略）
+     * @param thumbnail JPEG 缩略图（可为空）
+     */
+    void recordCatalogImage(const std::string &path, const std::vector<unsigned char> *thumbnail = nullptr);
+
+    /**
+     * @brief 图库元数据读取（DATE-OBS/OBJECT/FILTER/EXPTIME/IMAGETYP，只读头不读像素），在索引线程调用
+     * @return 非 FITS 或打不开返回 false
+     */
+    static bool readCatalogMeta(const std::string &path, storage::ImageMeta *meta);
+
+    /**
+     * @brief 查询图库：QueryImageCatalog:{json} -> ImageCatalogPage:{json}
+     * @param queryJson category/folder/object/filter/minExposure/maxExposure/from/to/newestFirst/offset/limit
+     */
+    void QueryImageCatalog(const QString &queryJson);
+
+    /**
+     * @brief 分类下的文件夹摘要：ImageCatalogFolders:{json}（文件数/字节数/最近拍摄时间）
+     */
+    void GetImageCatalogFolders(const QString &category);
+
+    /**
+     * @brief 读取缩略图：ImageThumbnail:{"path":..,"jpeg":base64}（无缩略图时 jpeg 为空）
+     * @param relPath 相对 ImageSaveBasePath 的路径（category/folder/name）
+     */
+    void GetImageThumbnail(const QString &relPath);
+
+    /**
+     * @brief 把一批文件交给导出引擎，进度/结果通过 WebSocket 回报
+     * @param items 源 -> 目标列表
+     * @param functionName 函数名（用于日志）
+     * @return 已提交返回 true
+     */
+    bool submitUsbExport(std::vector<storage::ExportItem> items, const QString &functionName);
+
+    /**
+     * @brief 确保目录存在且当前进程可写；不可写时用一次 sudo 创建并改属主，之后的复制都在进程内完成
+     * @param dirPath 目录
+     * @param functionName 函数名（用于日志）
+     * @return 目录存在返回 true（仍不可写时，复制失败会逐个回退到 sudo cp）
+     */
+    bool prepareWritableDirectory(const QString &dirPath, const QString &functionName);
+
+    /**
+     * @brief 以 sudo -S 执行命令（仅作为进程内操作失败时的回退）
+     * @param args sudo 之后的参数
+     * @param errorOutput 失败时的 stderr（可为空）
+     * @return 退出码为 0 返回 true
+     *
+     * 不访问成员，可在导出工作线程中调用（阻塞到命令结束）。
+     */
+    static bool runPrivilegedCommand(const QStringList &args, QString *errorOutput = nullptr);
+
     /**
      * @brief 判断挂载点是否只读
      * @param mountPoint 挂载点
@@ -1818,12 +2041,11 @@ public:
     bool isMountReadOnly(const QString &mountPoint);
 
     /**
-     * @brief 重新以可写方式挂载
+     * @brief 重新以可写方式挂载（保留 nosuid/nodev/noexec 等现有挂载选项，只去掉只读）
      * @param mountPoint 挂载点
-     * @param password 提权密码
      * @return 成功返回 true
      */
-    bool remountReadWrite(const QString &mountPoint, const QString &password);
+    bool remountReadWrite(const QString &mountPoint);
 
     /**
      * @brief 获取指定目录图像文件
@@ -163,22 +163,28 @@ inline bool sdkGetCfwPosition0(SdkDeviceHandle handle, int &pos0, std::string *e
     }
 }
 
-inline bool sdkSetCfwPosition0AndWait(SdkDeviceHandle handle, int targetPos0, int timeoutMs, std::string *errMsg = nullptr)
+// 只下发换位命令，不等待到位（调用方用 sdkGetCfwPosition0 轮询）
+inline bool sdkSetCfwPosition0(SdkDeviceHandle handle, int targetPos0, std::string *errMsg = nullptr)
 {
-    {
-        SdkCommand cmd;
-        cmd.type = SdkCommandType::Custom;
-        cmd.name = "SetCFWPosition";
-        cmd.payload = targetPos0;
+    SdkCommand cmd;
+    cmd.type = SdkCommandType::Custom;
+    cmd.name = "SetCFWPosition";
+    cmd.payload = targetPos0;
 
-        SdkResult res = SdkManager::instance().callByHandle(handle, cmd);
-        if (!res.success)
-        {
-            if (errMsg)
-                *errMsg = res.message;
-            return false;
-        }
+    SdkResult res = SdkManager::instance().callByHandle(handle, cmd);
+    if (!res.success)
+    {
+        if (errMsg)
+            *errMsg = res.message;
+        return false;
     }
+    return true;
+}
+
+inline bool sdkSetCfwPosition0AndWait(SdkDeviceHandle handle, int targetPos0, int timeoutMs, std::string *errMsg = nullptr)
+{
+    if (!sdkSetCfwPosition0(handle, targetPos0, errMsg))
+        return false;
 
     QElapsedTimer t;
     t.start();
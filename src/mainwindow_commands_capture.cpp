@@ -23,6 +23,7 @@ bool MainWindow::handleCaptureCommand(const QString &message, const QStringList
             command == QLatin1String("SetUsbTraffic") ||
             command == QLatin1String("SetMainCameraAutoSave") ||
             command == QLatin1String("SetMainCameraSaveFailedParse") ||
+            command == QLatin1String("SetFitsCompression") ||
             command == QLatin1String("SetMainCameraSaveFolder") ||
             command == QLatin1String("SetMainCameraTileBuildMode") ||
             command == QLatin1String("SetMainCameraTileLevelMode") ||
@@ -552,6 +553,14 @@ bool MainWindow::handleCaptureCommand(const QString &message, const QStringList
         Logger::Log("Set MainCamera Auto Save to " + std::string(mainCameraAutoSave ? "true" : "false"), LogLevel::DEBUG, DeviceType::MAIN);
         Tools::saveParameter("MainCamera", "AutoSave", parts[1].trimmed());
     }
+    else if (parts.size() == 2 && parts[0].trimmed() == "SetFitsCompression")
+    {
+        // 归档 FITS 压缩方式：none/rice/gzip（仅影响后台写盘的归档文件，/dev/shm 预览始终不压缩）
+        fitsSaveCompression = QString::fromLatin1(
+            fits::compressionName(fits::compressionFromString(parts[1].trimmed().toStdString())));
+        Logger::Log("Set FITS compression to " + fitsSaveCompression.toStdString(), LogLevel::DEBUG, DeviceType::MAIN);
+        Tools::saveParameter("MainCamera", "FitsCompression", fitsSaveCompression);
+    }
     else if (parts.size() == 2 && parts[0].trimmed() == "SetMainCameraSaveFailedParse")
     {
         mainCameraSaveFailedParse = (parts[1].trimmed() == "true" || parts[1].trimmed() == "1");
@@ -1078,10 +1078,16 @@ bool MainWindow::handleFileAndStorageCommand(const QString &message, const QStri
     const QString command = parts.isEmpty() ? message.trimmed() : parts[0].trimmed();
     if (!(
             command == QLatin1String("ShowAllImageFolder") ||
+            command == QLatin1String("CancelUsbExport") ||
+            command == QLatin1String("ResumeUsbExport") ||
+            command == QLatin1String("SetUsbExportVerify") ||
             command == QLatin1String("MoveFileToUSB") ||
             command == QLatin1String("DeleteFile") ||
             command == QLatin1String("USBCheck") ||
             command == QLatin1String("GetImageFiles") ||
+            command == QLatin1String("QueryImageCatalog") ||
+            command == QLatin1String("GetImageCatalogFolders") ||
+            command == QLatin1String("GetImageThumbnail") ||
             command == QLatin1String("GetDownloadManifest") ||
             command == QLatin1String("ClearDownloadLinks") ||
             command == QLatin1String("GetUSBFiles") ||
@@ -1120,6 +1126,21 @@ bool MainWindow::handleFileAndStorageCommand(const QString &message, const QStri
         CopyImagesToUsb(ImagePath, usbName);
         Logger::Log("MoveFileToUSB finish!", LogLevel::DEBUG, DeviceType::MAIN);
     }
+    else if (message == "CancelUsbExport")
+    {
+        CancelUsbExport();
+    }
+    else if (message == "ResumeUsbExport")
+    {
+        ResumeUsbExport();
+    }
+    else if (parts.size() == 2 && parts[0].trimmed() == "SetUsbExportVerify")
+    {
+        // 导出后丢弃缓存重读目标做 XXH64 比对（更慢，但能发现劣质 U 盘的静默写坏）
+        usbExportVerify = (parts[1].trimmed() == "true" || parts[1].trimmed() == "1");
+        Logger::Log("Set USB export verify to " + std::string(usbExportVerify ? "true" : "false"), LogLevel::DEBUG, DeviceType::MAIN);
+        Tools::saveParameter("MainCamera", "UsbExportVerify", usbExportVerify ? "true" : "false");
+    }
     else if (parts[0].trimmed() == "DeleteFile")
     {
         Logger::Log("DeleteFile ...", LogLevel::DEBUG, DeviceType::MAIN);
@@ -1143,6 +1164,19 @@ bool MainWindow::handleFileAndStorageCommand(const QString &message, const QStri
         GetImageFiles(FolderPath);
         Logger::Log("GetImageFiles finish!", LogLevel::DEBUG, DeviceType::MAIN);
     }
+    else if (parts[0].trimmed() == "QueryImageCatalog")
+    {
+        // QueryImageCatalog:{"category":"CaptureImage","object":"m31","offset":0,"limit":100,...}
+        QueryImageCatalog(message.section(':', 1));
+    }
+    else if (parts.size() == 2 && parts[0].trimmed() == "GetImageCatalogFolders")
+    {
+        GetImageCatalogFolders(parts[1].trimmed());
+    }
+    else if (parts.size() >= 2 && parts[0].trimmed() == "GetImageThumbnail")
+    {
+        GetImageThumbnail(message.section(':', 1).trimmed());
+    }
     else if (parts[0].trimmed() == "GetDownloadManifest")
     {
         // 格式：
@@ -1421,6 +1455,11 @@ bool MainWindow::handleFileAndStorageCommand(const QString &message, const QStri
         // 视口变化：调度“按需补瓦片”（不会阻塞主线程；会做合并/节流）
         scheduleViewportTileGeneration();
     }
+    else if (message == "getHistogram")
+    {
+        Logger::Log("getHistogram ...", LogLevel::DEBUG, DeviceType::CAMERA);
+        sendCurrentHistogramToClient();
+    }
     else if (parts[0].trimmed() == "queryTileBatchReady" && (parts.size() == 3 || parts.size() == 4))
     {
         const QString sessionId = parts[1].trimmed();
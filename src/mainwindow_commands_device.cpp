@@ -443,12 +443,14 @@ bool MainWindow::handleSystemCommand(const QString &message, const QStringList &
     else if (message == "RestartRaspberryPi")
     {
         Logger::Log("RestartRaspberryPi ...", LogLevel::DEBUG, DeviceType::MAIN);
+        Tools::flushConfig();  // 配置是防抖写盘的，重启前先落盘
         system("reboot");
         Logger::Log("RestartRaspberryPi finish!", LogLevel::DEBUG, DeviceType::MAIN);
     }
     else if (message == "ShutdownRaspberryPi")
     {
         Logger::Log("ShutdownRaspberryPi ...", LogLevel::DEBUG, DeviceType::MAIN);
+        Tools::flushConfig();
         system("shutdown -h now");
         Logger::Log("ShutdownRaspberryPi finish!", LogLevel::DEBUG, DeviceType::MAIN);
     }
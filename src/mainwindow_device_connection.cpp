@@ -1,4 +1,5 @@
 #include "mainwindow_command_support.h"
+#include "devices/ConnectOrchestrator.h"
 
 namespace
 {
@@ -45,6 +46,19 @@ void MainWindow::bindDeviceToRole(int slot, INDI::BaseDevice *device)
     AfterDeviceConnect(device);
 }
 
+void MainWindow::syncDeviceStateBusRoles()
+{
+    auto nameOf = [](INDI::BaseDevice *dp) {
+        return (dp != nullptr && dp->getDeviceName() != nullptr) ? std::string(dp->getDeviceName()) : std::string();
+    };
+    devices::DeviceStateBus &bus = devices::DeviceStateBus::instance();
+    bus.bindRole(devices::DeviceRole::Mount, nameOf(dpMount));
+    bus.bindRole(devices::DeviceRole::MainCamera, nameOf(dpMainCamera));
+    bus.bindRole(devices::DeviceRole::Guider, nameOf(dpGuider));
+    bus.bindRole(devices::DeviceRole::Focuser, nameOf(dpFocuser));
+    bus.bindRole(devices::DeviceRole::PoleCamera, nameOf(dpPoleScope));
+}
+
 // 自动决策旁路 —— 当前【封堵】：一律返回「无决策」，所有角色都走用户手动选择。
 //
 // 将来要恢复任何自动决策规则（"只有一台就绑给该角色"、"名字里带 POLEMASTER 的
@@ -73,6 +87,18 @@ SdkResult MainWindow::sdkScanQhyCameras(const QString& driverName)
     return SdkManager::instance().call(driverName.toStdString(), nullptr, scanCmd);
 }
 
+void MainWindow::prepareSdkMainCameraPollCommands(const std::string& driverName)
+{
+    auto tempCmd = std::make_shared<SdkCommand>(SdkCommand{SdkCommandType::Custom, "GetCurrentTemperature", {}});
+    if (!SdkManager::instance().resolveCommand(driverName, *tempCmd))
+    {
+        Logger::Log("prepareSdkMainCameraPollCommands | GetCurrentTemperature not resolved for driver " + driverName,
+                    LogLevel::WARNING, DeviceType::CAMERA);
+    }
+    sdkMainCameraDriver = driverName;
+    sdkMainTempCmd = std::move(tempCmd);
+}
+
 // 按需打开相机池中某槽位的相机（M2）。
 // 背景：扫描（ScanQHYCCD + GetQHYCCDId）只枚举、不占用设备；真正的排他是 OpenQHYCCD。
 // 旧流程"扫到几台就 open 全部"会把本该留给 INDI 的相机也占住，是混用时双开冲突的自造根源。
@@ -230,6 +256,7 @@ void MainWindow::reportSdkCameraCandidates()
 void MainWindow::ConnectAllDeviceOnce()
 {
     Logger::Log("Connecting all devices once.", LogLevel::INFO, DeviceType::MAIN);
+    connectAllElapsedTimer.start();
     
     // 防御性检查：确保 indi_Client 已经初始化
     if (indi_Client == nullptr)
@@ -477,6 +504,10 @@ void MainWindow::ConnectAllDeviceOnce()
                             Logger::Log("ConnectAllDeviceOnce | Failed to register MainCamera to SdkManager: " + regRes.message,
                                         LogLevel::WARNING, DeviceType::CAMERA);
                         }
+                        else
+                        {
+                            prepareSdkMainCameraPollCommands(driverName.toStdString());
+                        }
                     }
 
                     AfterDeviceConnect(nullptr);
@@ -1255,6 +1286,32 @@ void MainWindow::continueConnectAllDeviceOnce()
     };
 
     // 第一阶段：仅处理 INDI 设备（isSDKConnect == false）
+    // connectDevice 只是向驱动发请求：先给每台设备配好串口/波特率并登记为连接任务，
+    // 再由 ConnectOrchestrator 并发等待（原先逐台 connect 后各自最多 5s+5s 串行等待）。
+    // 同一串口的设备串行；QHY 等相机驱动自带的滤镜轮等相机连上后再连。
+    devices::ConnectOrchestrator connectOrchestrator;
+    connectOrchestrator.setPollIntervalMs(100);
+    connectOrchestrator.setOnFinished([this](const devices::ConnectReport &report) {
+        Logger::Log("continueConnectAllDeviceOnce | connect " + report.name + " " +
+                        devices::connectStatusName(report.status) + " in " + std::to_string(report.durationMs()) +
+                        "ms, attempts=" + std::to_string(report.attempts) +
+                        (report.message.empty() ? std::string() : ", " + report.message),
+                    report.status == devices::ConnectStatus::Done ? LogLevel::INFO : LogLevel::WARNING,
+                    DeviceType::MAIN);
+        emit wsThread->sendMessageToClient("ConnectTiming:" + QString::fromStdString(report.name) + ":" +
+                                           devices::connectStatusName(report.status) + ":" +
+                                           QString::number(report.durationMs()) + ":" +
+                                           QString::number(report.attempts));
+    });
+    QMap<QString, QString> ccdDeviceByDriverExec;  // driverExec -> 该驱动的相机设备名（滤镜轮依赖它）
+    for (int i = 0; i < indi_Client->GetDeviceCount(); i++)
+    {
+        INDI::BaseDevice *device = indi_Client->GetDeviceFromList(i);
+        if (device != nullptr && (device->getDriverInterface() & INDI::BaseDevice::CCD_INTERFACE))
+            ccdDeviceByDriverExec.insert(QString::fromUtf8(device->getDriverExec()),
+                                         QString::fromUtf8(device->getDeviceName()));
+    }
+
     for (int i = 0; i < indi_Client->GetDeviceCount(); i++)
     {
         // 修复：检查系统设备列表索引是否有效
@@ -1374,117 +1431,111 @@ void MainWindow::continueConnectAllDeviceOnce()
             sendSerialPortOptions(driverType);
         }
 
-        int baudRateToUse = getBaudRateForDeviceIndex(device, i);
-        Logger::Log("ConnectAllDeviceOnce | setBaudRate for device " + deviceName + " -> " + std::to_string(baudRateToUse),
-                    LogLevel::INFO, DeviceType::MAIN);
-        indi_Client->setBaudRate(device, baudRateToUse);
-        indi_Client->connectDevice(deviceName.c_str());
-
-        int waitTime = 0;
-        while (device != nullptr && !device->isConnected() && waitTime < 5)
+        devices::ConnectTask task;
+        task.name = deviceName;
+        task.timeoutMs = 5000;
+        task.maxAttempts = 2;
+        task.retryDelayMs = 200;
+        if (driverType == "Mount" || driverType == "Focuser")
         {
-            Logger::Log("Wait for Connect" + deviceName, LogLevel::INFO, DeviceType::MAIN);
-            QThread::msleep(1000); // 等待1秒
-            waitTime++;
+            QString devicePort;
+            indi_Client->getDevicePort(device, devicePort);
+            if (!devicePort.isEmpty())
+                task.resource = "serial:" + devicePort.toStdString();
         }
-
-        if (device == nullptr || !device->isConnected())
+        if ((device->getDriverInterface() & INDI::BaseDevice::FILTER_INTERFACE) &&
+            !(device->getDriverInterface() & INDI::BaseDevice::CCD_INTERFACE))
         {
+            const QString ccdName = ccdDeviceByDriverExec.value(driverExec);
+            if (!ccdName.isEmpty())
+                task.dependsOn.push_back(ccdName.toStdString());
+        }
+        // 驱动的 CONNECTION 属性到达前发 connect 会被丢弃
+        task.ready = [device]() {
+            return device->getProperty("CONNECTION").isValid();
+        };
+        task.start = [this, device, deviceName, i, getBaudRateForDeviceIndex](int attempt) {
+            const int baudRateToUse = getBaudRateForDeviceIndex(device, i);
+            Logger::Log("ConnectAllDeviceOnce | " + std::string(attempt > 1 ? "retry " : "") + "setBaudRate for device " +
+                            deviceName + " -> " + std::to_string(baudRateToUse),
+                        LogLevel::INFO, DeviceType::MAIN);
+            indi_Client->setBaudRate(device, baudRateToUse);
+            indi_Client->connectDevice(deviceName.c_str());
+            return true;
+        };
+        task.poll = [device]() {
+            return device->isConnected() ? devices::ConnectPoll::Done : devices::ConnectPoll::Pending;
+        };
+        task.onAttemptFailed = [this, device, deviceName](int) -> bool {
             Logger::Log("ConnectDriver | Device (" + deviceName + ") is not connected,try to update port", LogLevel::WARNING, DeviceType::MAIN);
-            
-            // 修复：连接失败后，先断开设备以释放可能占用的串口，避免端口被占用导致重试失败
+
+            // 连接失败后先断开设备以释放可能占用的串口，避免端口被占用导致重试失败
             // 即使连接失败，INDI 驱动可能已经部分打开了串口（tty_connect），需要显式断开以确保端口完全释放
-            if (device != nullptr)
+            indi_Client->disconnectDevice(device->getDeviceName());
+            Logger::Log("ConnectAllDeviceOnce | Disconnected device to release port before retry: " + deviceName,
+                        LogLevel::INFO, DeviceType::MAIN);
+
+            // 特殊处理(电调和赤道仪)：串口被识别成别的设备时换到探测出的正确串口
+            if (device->getDriverInterface() & INDI::BaseDevice::FOCUSER_INTERFACE || device->getDriverInterface() & INDI::BaseDevice::TELESCOPE_INTERFACE)
             {
-                indi_Client->disconnectDevice(device->getDeviceName());
-                Logger::Log("ConnectAllDeviceOnce | Disconnected device to release port before retry: " + deviceName, 
-                            LogLevel::INFO, DeviceType::MAIN);
-                QThread::msleep(200); // 短暂等待，确保端口完全释放
-            }
-            
-            // 特殊处理(电调和赤道仪)
-            // 修复：使用已检查的device指针，避免重复调用GetDeviceFromList
-            if (device != nullptr && (device->getDriverInterface() & INDI::BaseDevice::FOCUSER_INTERFACE || device->getDriverInterface() & INDI::BaseDevice::TELESCOPE_INTERFACE)){
                 QString DevicePort;
                 indi_Client->getDevicePort(device, DevicePort);
                 QString DeviceType = detector.detectDeviceTypeForPort(DevicePort);
 
                 // 获取设备类型
                 QString DriverType = "";
-                // 修复：使用已检查的device指针
-                if (device != nullptr) {
-                    for(int j = 0; j < systemdevicelist.system_devices.size(); j++)
+                for (int j = 0; j < systemdevicelist.system_devices.size(); j++)
+                {
+                    if (indiDriverNamesEquivalent(systemdevicelist.system_devices[j].DriverIndiName,
+                                                  QString::fromUtf8(device->getDriverExec())))
                     {
-                        if (indiDriverNamesEquivalent(systemdevicelist.system_devices[j].DriverIndiName,
-                                                      QString::fromUtf8(device->getDriverExec())))
-                        {
-                            DriverType = systemdevicelist.system_devices[j].Description;
-                        }
+                        DriverType = systemdevicelist.system_devices[j].Description;
                     }
-                    // 处理电调和赤道仪的连接
-                    if (DeviceType != "Focuser" && DriverType == "Focuser")
+                }
+                if (DeviceType != "Focuser" && DriverType == "Focuser")
+                {
+                    QString realFocuserPort = detector.getFocuserPort();
+                    if (realFocuserPort.isEmpty())
                     {
-                        // 识别到当前设备是电调，但是设备的串口不是电调的串口,需更新
-                        // 正确的串口是detector.getFocuserPort()
-                        QString realFocuserPort = detector.getFocuserPort();
-                        if (!realFocuserPort.isEmpty())
-                        {
-                            indi_Client->setDevicePort(device, realFocuserPort);
-                            // 同步更新覆盖值，保证后续连接与前端显示一致
-                            focuserSerialPortOverride = realFocuserPort;
-                            Logger::Log("ConnectDriver | Focuser Device (" + std::string(device->getDeviceName()) + ") Port is updated to: " + realFocuserPort.toStdString(), LogLevel::INFO, DeviceType::MAIN);
-
-                            // 自动纠正串口后，同步当前串口与候选列表到前端
-                            sendSerialPortOptions(DriverType);
-                        }
-                        else
-                        {
-                            Logger::Log("No matched Focuser port found by detector.", LogLevel::WARNING, DeviceType::MAIN);
-                            continue;
-                        }
-                    }else if (DeviceType != "Mount" && DriverType == "Mount")
+                        Logger::Log("No matched Focuser port found by detector.", LogLevel::WARNING, DeviceType::MAIN);
+                        return false;
+                    }
+                    indi_Client->setDevicePort(device, realFocuserPort);
+                    // 同步更新覆盖值，保证后续连接与前端显示一致
+                    focuserSerialPortOverride = realFocuserPort;
+                    Logger::Log("ConnectDriver | Focuser Device (" + deviceName + ") Port is updated to: " + realFocuserPort.toStdString(), LogLevel::INFO, DeviceType::MAIN);
+                    sendSerialPortOptions(DriverType);
+                }
+                else if (DeviceType != "Mount" && DriverType == "Mount")
+                {
+                    QString realMountPort = detector.getMountPort();
+                    if (realMountPort.isEmpty())
                     {
-                        // 识别到当前设备是赤道仪，但是设备的串口不是赤道仪的串口,需更新
-                        // 正确的串口是detector.getMountPort()
-                        QString realMountPort = detector.getMountPort();
-                        if (!realMountPort.isEmpty())
-                        {
-                            indi_Client->setDevicePort(device, realMountPort);
-                            // 同步更新覆盖值，保证后续连接与前端显示一致
-                            mountSerialPortOverride = realMountPort;
-                            Logger::Log("ConnectDriver | Mount Device (" + std::string(device->getDeviceName()) + ") Port is updated to: " + realMountPort.toStdString(), LogLevel::INFO, DeviceType::MAIN);
-
-                            // 自动纠正串口后，同步当前串口与候选列表到前端
-                            sendSerialPortOptions(DriverType);
-                        }
-                        else
-                        {
-                            Logger::Log("No matched Mount port found by detector.", LogLevel::WARNING, DeviceType::MAIN);
-                            continue;
-                        }
-                    }else{
-                        Logger::Log("ConnectDriver | Device (" + std::string(device->getDeviceName()) + ") Port is not updated.", LogLevel::WARNING, DeviceType::MAIN);
+                        Logger::Log("No matched Mount port found by detector.", LogLevel::WARNING, DeviceType::MAIN);
+                        return false;
                     }
+                    indi_Client->setDevicePort(device, realMountPort);
+                    // 同步更新覆盖值，保证后续连接与前端显示一致
+                    mountSerialPortOverride = realMountPort;
+                    Logger::Log("ConnectDriver | Mount Device (" + deviceName + ") Port is updated to: " + realMountPort.toStdString(), LogLevel::INFO, DeviceType::MAIN);
+                    sendSerialPortOptions(DriverType);
                 }
-            }
-            // 修复：使用已检查的device指针和deviceName
-            if (device != nullptr && !deviceName.empty()) {
-                int retryBaudRate = getBaudRateForDeviceIndex(device, i);
-                Logger::Log("ConnectAllDeviceOnce | retry setBaudRate for device " + deviceName + " -> " + std::to_string(retryBaudRate),
-                            LogLevel::INFO, DeviceType::MAIN);
-                indi_Client->setBaudRate(device, retryBaudRate);
-                indi_Client->connectDevice(deviceName.c_str());
-        
-                int waitTime = 0;
-                while (device != nullptr && !device->isConnected() && waitTime < 5)
+                else
                 {
-                    // 修复：使用已检查的deviceName变量
-                    Logger::Log("Wait for Connect" + deviceName, LogLevel::INFO, DeviceType::MAIN);
-                    QThread::msleep(1000); // 等待1秒
-                    waitTime++;
+                    Logger::Log("ConnectDriver | Device (" + deviceName + ") Port is not updated.", LogLevel::WARNING, DeviceType::MAIN);
                 }
             }
-        }
+            return true;
+        };
+        connectOrchestrator.addTask(std::move(task));
+    }
+
+    if (!connectOrchestrator.empty())
+    {
+        connectOrchestrator.run(30000);
+        Logger::Log("continueConnectAllDeviceOnce | INDI devices connect phase took " +
+                        std::to_string(connectOrchestrator.elapsedMs()) + "ms",
+                    LogLevel::INFO, DeviceType::MAIN);
     }
 
     // 注意：SDK 连接已在 ConnectAllDeviceOnce() 的最开始执行，这里不再重复执行，
@@ -1899,9 +1950,15 @@ void MainWindow::continueConnectAllDeviceOnce()
                     LogLevel::INFO, DeviceType::MAIN);
     }
     
+    // 端到端耗时（点击“全部连接”到完成），供前端展示与启动基准脚本采集
+    const qint64 connectAllMs = connectAllElapsedTimer.isValid() ? connectAllElapsedTimer.elapsed() : -1;
+    emit wsThread->sendMessageToClient("ConnectAllTiming:" + QString::number(connectAllMs));
+
     // 发送全部连接完成消息，通知前端可以关闭进度条
     emit wsThread->sendMessageToClient("ConnectAllDeviceComplete");
-    Logger::Log("continueConnectAllDeviceOnce | All devices connection process completed", LogLevel::INFO, DeviceType::MAIN);
+    Logger::Log("continueConnectAllDeviceOnce | All devices connection process completed in " +
+                    std::to_string(connectAllMs) + "ms",
+                LogLevel::INFO, DeviceType::MAIN);
 }
 
 void MainWindow::BindingDevice(QString DeviceType, int DeviceIndex)
@@ -2050,6 +2107,10 @@ void MainWindow::BindingDevice(QString DeviceType, int DeviceIndex)
                 Logger::Log("AllocateDevice | Failed to register MainCamera to SdkManager: " + regRes.message,
                             LogLevel::WARNING, DeviceType::CAMERA);
             }
+            else
+            {
+                prepareSdkMainCameraPollCommands(driverName.toStdString());
+            }
         }
         // 注意：DriverIndiName 语义为“驱动名”（例如 indi_qhy_ccd），不能被 cameraId 覆盖；
         // SDK 相机的唯一标识（cameraId）只写入 DeviceIndiName。
@@ -3893,7 +3954,19 @@ void MainWindow::AfterDeviceConnect(INDI::BaseDevice *dp)
         Logger::Log("CCD CFA Info - OffsetX: " + std::to_string(offsetX) + ", OffsetY: " + std::to_string(offsetY) + ", CFA: " + MainCameraCFA.toStdString(), LogLevel::INFO, DeviceType::MAIN);
         emit wsThread->sendMessageToClient("MainCameraCFA:" + (MainCameraCFA.isEmpty() ? QStringLiteral("null") : MainCameraCFA));
         emit wsThread->sendMessageToClient("MainCameraCFASource:INDI");
-        indi_Client->setCCDUploadModeToLacal(dpMainCamera);
+        // QUARCS_INDI_BLOB=1：图像以 BLOB 直接发给客户端并在内存解码（远程 INDI 服务器时必须用这条路径）；
+        // 默认仍由驱动写到 /dev/shm 再回读
+        if (qgetenv("QUARCS_INDI_BLOB") == "1" &&
+            indi_Client->setCCDUploadModeToClient(dpMainCamera) == QHYCCD_SUCCESS)
+        {
+            indi_Client->setBlobIngestion(dpMainCamera->getDeviceName(), "/dev/shm/ccd_simulator.fits");
+            Logger::Log("MainCamera upload mode: client (in-memory BLOB)", LogLevel::INFO, DeviceType::CAMERA);
+        }
+        else
+        {
+            indi_Client->setBlobIngestion(dpMainCamera->getDeviceName(), "");
+            indi_Client->setCCDUploadModeToLacal(dpMainCamera);
+        }
         indi_Client->setCCDUpload(dpMainCamera, "/dev/shm", "ccd_simulator");
 
         // 计算需要的binning以达到548像素以下
@@ -5348,12 +5421,13 @@ void MainWindow::onSdkMainLiveTimerTimeout()
                 std::chrono::steady_clock::now().time_since_epoch()).count();
 
         // 1) 取一帧 Live
-        SdkCommand getCmd;
-        getCmd.type = SdkCommandType::Custom;
         // Live 取帧：始终取完整帧（用于写入“最新帧邮箱”与共享内存）
         // 注意：后处理（FITS/PNG/瓦片）由主线程的 sdkMainLiveProcessTimer 独立执行，不影响取帧速率
-        getCmd.name = "GetLiveFrame";
-        getCmd.payload = std::any();
+        // 命令对象跨帧复用：首次（或驱动重开后）预解析命令 id，此后 call() 按下标直接分派
+        SdkCommand& getCmd = sdkMainLiveGetFrameCmd;
+        if (getCmd.idOwner == nullptr) {
+            SdkManager::instance().resolveCommand(dev.driverName, getCmd);
+        }
 
         SdkResult frameRes = SdkManager::instance().call(dev.driverName, dev.handle, getCmd);
         const long long acquireEndNs =
@@ -5402,15 +5476,13 @@ void MainWindow::onSdkMainLiveTimerTimeout()
         // 成功出帧：取消退避
         sdkMainLiveNextPollMs = 0;
 
-        SdkFrameData frame;
-        try {
-            frame = std::any_cast<SdkFrameData>(frameRes.payload);
-        } catch (const std::bad_any_cast&) {
-            throttledFrameLog("LiveFrame | payload any_cast failed", LogLevel::WARNING);
+        if (!frameRes.frame) {
+            throttledFrameLog("LiveFrame | result carries no frame", LogLevel::WARNING);
             sdkMainLiveNextPollMs = QDateTime::currentMSecsSinceEpoch() + 120;
             sdkMainLiveFrameInFlight = false;
             return;
         }
+        SdkFrameData frame = std::move(*frameRes.frame);
         const bool hasFrameData =
             (!frame.pixels.empty()) || (frame.rawBuffer != nullptr && frame.rawBytes > 0);
         if (frame.width <= 0 || frame.height <= 0 || !hasFrameData)
@@ -5671,6 +5743,8 @@ void MainWindow::onSdkMainLiveProcessTimerTimeout()
 
     const std::string fitsPath = "/dev/shm/ccd_simulator.fits";
     SaveQhyFrameDataToFits(frame, fitsPath);
+    // Live 帧的 rawBuffer 属于驱动双缓冲池，不能长期持有；归档回退为复制预览文件
+    lastMainCaptureFrame.reset();
 
     // 复用前端协议：用 ExposureCompleted 作为“刷新一帧”的信号
     emit wsThread->sendMessageToClient("ExposureCompleted");
@@ -618,7 +618,7 @@ void MainWindow::onSdkGuiderExposureTimerTimeout()
                         " msg=" + frameRes.message,
                     LogLevel::INFO, DeviceType::GUIDER);
 
-        QMetaObject::invokeMethod(this, [this, frameRes, expected, getFrameCostMs, workerTotalMs, timerFiredAtMs, captureRole]() mutable {
+        QMetaObject::invokeMethod(this, [this, frameRes = std::move(frameRes), expected, getFrameCostMs, workerTotalMs, timerFiredAtMs, captureRole]() mutable {
             QElapsedTimer mainPerf;
             mainPerf.start();
             sdkGuiderFrameTaskInFlight = false;
@@ -646,7 +646,7 @@ void MainWindow::onSdkGuiderExposureTimerTimeout()
 
             if (frameRes.success)
             {
-                SdkFrameData frame = std::any_cast<SdkFrameData>(frameRes.payload);
+                SdkFrameData frame = frameRes.frame ? std::move(*frameRes.frame) : SdkFrameData{};
                 const bool hasFrameData =
                     (!frame.pixels.empty()) || (frame.rawBuffer != nullptr && frame.rawBytes > 0);
                 if (frame.width <= 0 || frame.height <= 0 || !hasFrameData)
@@ -232,11 +232,14 @@ int MainWindow::saveFitsAsPNG_FromSdkFrame_Worker(std::shared_ptr<SdkFrameData>
         return rc;
     }
 
-    const std::string fitsPath = "/dev/shm/ccd_simulator.fits";
-    SaveQhyFrameDataToFits(*frame, fitsPath);
-    const QString destinationPath = QStringLiteral("/dev/shm/ccd_simulator_original.fits");
-    QFile::remove(destinationPath);
-    QFile::copy(QString::fromStdString(fitsPath), destinationPath);
+    // 预览 FITS（ccd_simulator.fits，含头模板）已由调用方在主线程写好；这里直接从内存帧写原图副本，
+    // 不再重写预览文件再整文件复制
+    const std::string originalPath = "/dev/shm/ccd_simulator_original.fits";
+    fits::WriteResult r;
+    if (!fits::writeFrame(*frame, originalPath, fits::HeaderTemplate(), fits::WriteOptions(), &r)) {
+        Logger::Log("saveFitsAsPNG_FromSdkFrame_Worker | write original failed: " + r.error,
+                    LogLevel::WARNING, DeviceType::CAMERA);
+    }
     return 0;
 }
 
@@ -348,7 +351,7 @@ int MainWindow::processImageForFrontend(const cv::Mat& inputImage16, const QStri
         return -1;
     }
 
-    // 自动图像优化已前端化：后端主链路不再按帧计算自动白平衡增益。
+    // 自动拉伸/白平衡参数由 calculateGPM 的逐瓦片统计一并得出（不再单独扫全图）。
     Logger::Log("MainCameraImagePipeLine | mainwindow.cpp | saveFitsAsPNG | tileSourceImageSize = " +
                     std::to_string(tileSourceImage.cols) + "x" + std::to_string(tileSourceImage.rows),
                 LogLevel::INFO, DeviceType::CAMERA);
@@ -382,10 +385,10 @@ int MainWindow::processImageForFrontend(const cv::Mat& inputImage16, const QStri
         return -1;
     }
 
-    // GPM 仅保留图像与瓦片元数据；自动优化参数改由前端基于 Z=0 计算。
+    // GPM：瓦片元数据 + 逐瓦片统计合并出的全局拉伸/白平衡参数与直方图，前端无需再拉 Z0 重算。
     int maxMergeFactor = 16;
     const qint64 gpmCalcStartMs = QDateTime::currentMSecsSinceEpoch();
-    TileGPM gpm = calculateGPM(tileSourceImage, effectiveCameraCFA, maxMergeFactor, /*enableHistogram=*/false);
+    TileGPM gpm = calculateGPM(tileSourceImage, effectiveCameraCFA, maxMergeFactor, /*enableHistogram=*/true);
     emitCaptureTrace(QStringLiteral("backend_calculate_gpm_done"), gpmCalcStartMs,
                      QString("sessionCandidate=live_%1,image=%2x%3,maxZoom=%4")
                          .arg(QString::number(static_cast<qulonglong>(epochAtStart)))
@@ -423,6 +426,7 @@ int MainWindow::processImageForFrontend(const cv::Mat& inputImage16, const QStri
         tileFrame.cfa = effectiveCameraCFA;
         tileFrame.blackLevel = gpm.blackLevel;
         tileFrame.whiteLevel = gpm.whiteLevel;
+        tileFrame.tileStats = gpm.tileStats;
         tileFrameImage16 = std::make_shared<cv::Mat>(tileSourceImage); // 共享底层buffer（ref-count）
         tileFramePreviewImage16 = std::make_shared<cv::Mat>(image16);
     }
@@ -443,6 +447,10 @@ int MainWindow::processImageForFrontend(const cv::Mat& inputImage16, const QStri
         return -1;
     }
     sendGPMToClient(gpm);
+    // 直方图文件不逐帧写：只在拉伸窗口明显变化时推送，其余时候前端用 getHistogram 按需索取
+    if (histogramStretchChanged(gpm.blackLevel, gpm.whiteLevel)) {
+        sendHistogramToClient(gpm);
+    }
     emitCaptureTrace(QStringLiteral("backend_tilegpm_sent"), currentCaptureTraceStartedAtMs,
                      QString("sessionId=%1,frameId=%2,serverNowMs=%3")
                          .arg(gpm.sessionId)
@@ -952,265 +960,64 @@ MainWindow::TileGPM MainWindow::calculateGPM(const cv::Mat& image16, const QStri
     gpm.histogramBins = 0;
     gpm.histogramTotal = 0;
     gpm.histogram.clear();
-    Logger::Log("MainCameraImagePipeLine | mainwindow.cpp | calculateGPM | auto optimization metadata disabled on backend; returning neutral display params",
-                LogLevel::INFO, DeviceType::CAMERA);
-    return gpm;
+    gpm.histogramChannels = 0;
+    gpm.channelHistogram.clear();
+    gpm.statsMode = QStringLiteral("neutral");
 
-    auto tryComputeColorLumaStats = [&](double& meanLumaOut, double& stdLumaOut, size_t& sampleCountOut) -> bool {
-        if (image16.type() != CV_16UC1 || image16.rows < 2 || image16.cols < 2) {
-            return false;
-        }
+    if (image16.empty()) {
+        return gpm;
+    }
 
+    if (image16.type() == CV_16UC1) {
+        // 一遍扫描（按瓦片多线程）得到每个瓦片的分通道直方图/min/max/和，再逐层 2×2 合并：
+        // 顶层即全图统计，视口参数由 sendViewportStatsToClient 按瓦片合并得出，不再各自扫全图。
+        // 瓦片网格与 z=maxZoomLevel 层的瓦片一一对应（同一 tileSize，CFA 相位按原图绝对坐标）。
+        QElapsedTimer statsTimer;
+        statsTimer.start();
+        image::TileStatsOptions statsOptions;
+        statsOptions.tileSize = (tilePyramidTileSize > 0) ? tilePyramidTileSize : 512;
         const QString normalizedCfa = normalizeCfaPattern(cfa);
-        std::vector<cv::Point> rOffsets;
-        std::vector<cv::Point> gOffsets;
-        std::vector<cv::Point> bOffsets;
-        if (normalizedCfa == "RGGB") {
-            rOffsets = { cv::Point(0, 0) };
-            gOffsets = { cv::Point(1, 0), cv::Point(0, 1) };
-            bOffsets = { cv::Point(1, 1) };
-        } else if (normalizedCfa == "GRBG") {
-            gOffsets = { cv::Point(0, 0), cv::Point(1, 1) };
-            rOffsets = { cv::Point(1, 0) };
-            bOffsets = { cv::Point(0, 1) };
-        } else if (normalizedCfa == "GBRG") {
-            gOffsets = { cv::Point(0, 0), cv::Point(1, 1) };
-            bOffsets = { cv::Point(1, 0) };
-            rOffsets = { cv::Point(0, 1) };
-        } else if (normalizedCfa == "BGGR") {
-            bOffsets = { cv::Point(0, 0) };
-            gOffsets = { cv::Point(1, 0), cv::Point(0, 1) };
-            rOffsets = { cv::Point(1, 1) };
-        } else {
-            return false;
+        auto grid = std::make_shared<image::TileStatsGrid>();
+        if (!grid->build(image16.ptr<uint16_t>(0), image16.cols, image16.rows, image16.step1(),
+                         image::cfaLayoutFromName(normalizedCfa.toStdString()), statsOptions)) {
+            Logger::Log("calculateGPM | tile stats build failed, returning neutral display params",
+                        LogLevel::WARNING, DeviceType::CAMERA);
+            return gpm;
         }
 
-        const int rows = image16.rows;
-        const int cols = image16.cols;
-        const int sampleStep = std::max(2, static_cast<int>(std::floor(std::min(rows, cols) / 200.0)) * 2);
-
-        long double sumLuma = 0.0L;
-        long double sumSqLuma = 0.0L;
-        size_t sampleCount = 0;
-
-        auto rawPixelAt = [&](int y, int x) -> double {
-            if (y < 0 || y >= rows || x < 0 || x >= cols) return 0.0;
-            return static_cast<double>(image16.at<uint16_t>(y, x));
-        };
-
-        for (int y = 0; y < rows; y += sampleStep) {
-            for (int x = 0; x < cols; x += sampleStep) {
-                if ((y % (sampleStep * 2)) != 0 || (x % (sampleStep * 2)) != 0) continue;
-
-                double r = 0.0;
-                double g1 = 0.0;
-                double g2 = 0.0;
-                double b = 0.0;
-
-                for (const auto& pos : rOffsets) r += rawPixelAt(y + pos.y, x + pos.x);
-                for (const auto& pos : bOffsets) b += rawPixelAt(y + pos.y, x + pos.x);
-                if (gOffsets.size() >= 1) g1 = rawPixelAt(y + gOffsets[0].y, x + gOffsets[0].x);
-                if (gOffsets.size() >= 2) g2 = rawPixelAt(y + gOffsets[1].y, x + gOffsets[1].x);
-                const double g = (g1 + g2) * 0.5;
-                const double luma = (r + 2.0 * g + b) * 0.25;
-
-                sumLuma += static_cast<long double>(luma);
-                sumSqLuma += static_cast<long double>(luma) * static_cast<long double>(luma);
-                ++sampleCount;
+        const image::RegionStats& all = grid->global();
+        const image::ChannelStats combined = all.combined();
+        gpm.globalMin = static_cast<double>(combined.minValue);
+        gpm.globalMax = static_cast<double>(combined.maxValue);
+        // 彩色 RAW：均值/σ 取各通道的平均（去掉 Bayer 通道间电平差），与旧版“亮度块统计”同一目的
+        image::displayMeanStdDev(all, &gpm.globalMean, &gpm.globalStdDev);
+
+        const image::StretchLevels levels = image::autoStretch(all);
+        gpm.blackLevel = levels.black;
+        gpm.whiteLevel = levels.white;
+
+        if (grid->channels() > 1) {
+            const uint16_t offset = static_cast<uint16_t>(std::clamp(std::lround(ImageOffset), 0l, 65535l));
+            const image::WhiteBalance wb = image::whiteBalance(all, offset);
+            gpm.gainR = wb.gainR;
+            gpm.gainB = wb.gainB;
+            if (!wb.applied) {
+                Logger::Log("calculateGPM | white balance skipped: " + wb.reason, LogLevel::INFO, DeviceType::CAMERA);
             }
         }
 
-        if (sampleCount == 0) {
-            return false;
-        }
-
-        const long double dn = static_cast<long double>(sampleCount);
-        const long double meanLuma = sumLuma / dn;
-        long double varLuma = (sumSqLuma / dn) - meanLuma * meanLuma;
-        if (varLuma < 0.0L) varLuma = 0.0L;
-
-        meanLumaOut = static_cast<double>(meanLuma);
-        stdLumaOut = static_cast<double>(std::sqrt(varLuma));
-        sampleCountOut = sampleCount;
-        return true;
-    };
-
-    // 目标：尽量把全局统计/拉伸/直方图合并到“一次全图扫描”里（对 CV_16UC1 生效）
-    // 性能：若不需要直方图且图像很大，则采用“子采样统计”（把耗时压到 ~10ms 级别）
-    if (image16.type() == CV_16UC1) {
-        const size_t nTotal = image16.total();
-        gpm.histogramTotal = enableHistogram ? static_cast<uint64_t>(nTotal) : 0;
-        gpm.histogramBins = enableHistogram ? 65536 : 0;
-        std::vector<uint32_t> hist;
         if (enableHistogram) {
-            static constexpr int HIST_BINS = 65536;
-            hist.assign(static_cast<size_t>(HIST_BINS), 0u);
-        }
-
-        uint16_t minV = std::numeric_limits<uint16_t>::max();
-        uint16_t maxV = 0;
-        uint64_t sum = 0;
-        unsigned __int128 sumSq = 0; // 防溢出：n*65535^2 可能接近 1e17
-
-        size_t n = nTotal;
-        if (!enableHistogram && nTotal > 2'000'000) {
-            // 目标采样点数（约 1e6），用于快速估计 mean/stddev/min/max
-            constexpr long double TARGET = 1'000'000.0L;
-            const long double ratio = static_cast<long double>(nTotal) / TARGET;
-            const int step = std::max(1, static_cast<int>(std::sqrt(std::max(1.0L, ratio))));
-            n = 0;
-            for (int r = 0; r < image16.rows; r += step) {
-                const uint16_t* row = image16.ptr<uint16_t>(r);
-                for (int c = 0; c < image16.cols; c += step) {
-                    const uint16_t v = row[c];
-                    if (v < minV) minV = v;
-                    if (v > maxV) maxV = v;
-                    sum += v;
-                    sumSq += static_cast<unsigned __int128>(v) * static_cast<unsigned __int128>(v);
-                    ++n;
-                }
-            }
-            Logger::Log("GPM | subsample stats: total=" + std::to_string(nTotal) +
-                            ", sampled=" + std::to_string(n) + ", step=" + std::to_string(step),
-                        LogLevel::DEBUG, DeviceType::CAMERA);
-        } else {
-            if (image16.isContinuous()) {
-                const uint16_t* p = image16.ptr<uint16_t>(0);
-                for (size_t i = 0; i < n; ++i) {
-                    const uint16_t v = p[i];
-                    if (enableHistogram) ++hist[v];
-                    if (v < minV) minV = v;
-                    if (v > maxV) maxV = v;
-                    sum += v;
-                    sumSq += static_cast<unsigned __int128>(v) * static_cast<unsigned __int128>(v);
-                }
-            } else {
-                for (int r = 0; r < image16.rows; ++r) {
-                    const uint16_t* row = image16.ptr<uint16_t>(r);
-                    for (int c = 0; c < image16.cols; ++c) {
-                        const uint16_t v = row[c];
-                        if (enableHistogram) ++hist[v];
-                        if (v < minV) minV = v;
-                        if (v > maxV) maxV = v;
-                        sum += v;
-                        sumSq += static_cast<unsigned __int128>(v) * static_cast<unsigned __int128>(v);
-                    }
-                }
-            }
+            fillGpmHistogram(gpm, *grid);
         }
 
-        gpm.globalMin = static_cast<double>(minV);
-        gpm.globalMax = static_cast<double>(maxV);
-        if (enableHistogram) gpm.histogram = std::move(hist);
-
-        // mean/stdDev（由 sum/sumSq 推导）
-        const long double dn = static_cast<long double>(std::max<size_t>(1, n));
-        const long double mean = static_cast<long double>(sum) / dn;
-        const long double ex2 = static_cast<long double>(sumSq) / dn;
-        long double var = ex2 - mean * mean;
-        if (var < 0) var = 0; // 防浮点误差导致负数
-        const long double stdDev = std::sqrt(var);
-        gpm.globalMean = static_cast<double>(mean);
-        gpm.globalStdDev = static_cast<double>(stdDev);
-        Logger::Log("MainCameraImagePipeLine | mainwindow.cpp | calculateGPM | rawMean = " +
-                        std::to_string(gpm.globalMean),
+        gpm.statsMode = QStringLiteral("tiles");
+        gpm.tileStats = grid;
+        Logger::Log("MainCameraImagePipeLine | mainwindow.cpp | calculateGPM | tileStats = " +
+                        std::to_string(grid->tilesX()) + "x" + std::to_string(grid->tilesY()) +
+                        " tiles, " + std::to_string(grid->levels()) + " levels, " +
+                        std::to_string(grid->bytes() / 1024) + " KiB, " +
+                        std::to_string(statsTimer.elapsed()) + " ms",
                     LogLevel::INFO, DeviceType::CAMERA);
-        Logger::Log("MainCameraImagePipeLine | mainwindow.cpp | calculateGPM | rawStdDev = " +
-                        std::to_string(gpm.globalStdDev),
-                    LogLevel::INFO, DeviceType::CAMERA);
-
-        const bool isColorRaw =
-            !normalizeCfaPattern(cfa).isEmpty() &&
-            normalizeCfaPattern(cfa) != "null";
-        if (isColorRaw) {
-            double meanLuma = 0.0;
-            double stdLuma = 0.0;
-            size_t lumaSamples = 0;
-            if (tryComputeColorLumaStats(meanLuma, stdLuma, lumaSamples)) {
-                gpm.globalMean = meanLuma;
-                gpm.globalStdDev = stdLuma;
-                Logger::Log("GPM | color RAW luma stats override: meanLuma=" + std::to_string(meanLuma) +
-                                ", stdLuma=" + std::to_string(stdLuma) +
-                                ", sampledBlocks=" + std::to_string(lumaSamples),
-                            LogLevel::INFO, DeviceType::CAMERA);
-                Logger::Log("MainCameraImagePipeLine | mainwindow.cpp | calculateGPM | meanLuma = " +
-                                std::to_string(meanLuma),
-                            LogLevel::INFO, DeviceType::CAMERA);
-                Logger::Log("MainCameraImagePipeLine | mainwindow.cpp | calculateGPM | stdLuma = " +
-                                std::to_string(stdLuma),
-                            LogLevel::INFO, DeviceType::CAMERA);
-                Logger::Log("MainCameraImagePipeLine | mainwindow.cpp | calculateGPM | lumaSampleCount = " +
-                                std::to_string(lumaSamples),
-                            LogLevel::INFO, DeviceType::CAMERA);
-            } else {
-                Logger::Log("GPM | color RAW luma stats unavailable, fallback to direct RAW stats",
-                            LogLevel::WARNING, DeviceType::CAMERA);
-            }
-        }
-
-        // black/white（等价于 Tools::GetAutoStretch(mode=0)，但不再额外扫描图像）
-        {
-            constexpr int a = 3;
-            constexpr int b = 5;
-            const long double stretchMean = static_cast<long double>(gpm.globalMean);
-            const long double stretchStdDev = static_cast<long double>(gpm.globalStdDev);
-            long double bx = stretchMean - stretchStdDev * a;
-            long double wx = stretchMean + stretchStdDev * b;
-            if (bx == wx) wx = bx + 10;
-
-            const uint16_t maxValue = 65535;
-            if (bx < 0) bx = 0;
-            if (bx > maxValue) bx = maxValue;
-            if (wx < 0) wx = 0;
-            if (wx > maxValue) wx = maxValue;
-
-            // 关键修复：
-            // - bx/wx 可能是小数，直接 static_cast<uint16_t> 会截断为 0，导致 B==W==0（前端回退到 0-65535）
-            // - 这里改为“先在整数域四舍五入”，并保证 white > black（至少相差 1）
-            long long bi = std::llround(bx);
-            long long wi = std::llround(wx);
-
-            // 若区间过窄/反转，优先回退到 min/max（对低信号帧更稳）
-            if (wi <= bi) {
-                if (maxV > minV) {
-                    bi = static_cast<long long>(minV);
-                    wi = static_cast<long long>(maxV);
-                } else {
-                    wi = bi + 1;
-                }
-            }
-
-            // 再次钳制到 16bit 范围，并保证 wi > bi
-            bi = std::max<long long>(0, std::min<long long>(maxValue, bi));
-            wi = std::max<long long>(0, std::min<long long>(maxValue, wi));
-            if (wi <= bi) {
-                wi = std::min<long long>(maxValue, bi + 1);
-                if (wi <= bi) bi = std::max<long long>(0, wi - 1);
-            }
-
-            // 过曝保护：当画面整体接近饱和时，保留一个明显更亮的窗口，
-            // 避免前端把“高亮满屏”拉成近黑。
-            if (stretchMean >= static_cast<long double>(maxValue) * 0.85L ||
-                minV >= static_cast<uint16_t>(maxValue * 0.75)) {
-                wi = maxValue;
-                bi = std::min<long long>(bi, maxValue / 2);
-            }
-
-            uint16_t B = static_cast<uint16_t>(bi);
-            uint16_t W = static_cast<uint16_t>(wi);
-            if (B >= maxValue && W >= maxValue) {
-                B = 0;
-                W = maxValue;
-            }
-            gpm.blackLevel = B;
-            gpm.whiteLevel = W;
-            Logger::Log("MainCameraImagePipeLine | mainwindow.cpp | calculateGPM | blackLevel = " +
-                            std::to_string(gpm.blackLevel),
-                        LogLevel::INFO, DeviceType::CAMERA);
-            Logger::Log("MainCameraImagePipeLine | mainwindow.cpp | calculateGPM | whiteLevel = " +
-                            std::to_string(gpm.whiteLevel),
-                        LogLevel::INFO, DeviceType::CAMERA);
-        }
     } else {
         // 兼容路径：非 16UC1 时，保留原策略（可按需扩展 8bit/3通道）
         cv::Scalar mean, stdDev;
@@ -1227,6 +1034,7 @@ MainWindow::TileGPM MainWindow::calculateGPM(const cv::Mat& image16, const QStri
         Tools::GetAutoStretch(image16, 0, B, W);
         gpm.blackLevel = B;
         gpm.whiteLevel = W;
+        gpm.statsMode = QStringLiteral("full");
     }
 
     Logger::Log("GPM calculated: min=" + std::to_string(gpm.globalMin) + 
@@ -1242,6 +1050,12 @@ MainWindow::TileGPM MainWindow::calculateGPM(const cv::Mat& image16, const QStri
     Logger::Log("MainCameraImagePipeLine | mainwindow.cpp | calculateGPM | globalMeanStdDev = " +
                     std::to_string(gpm.globalMean) + "," + std::to_string(gpm.globalStdDev),
                 LogLevel::INFO, DeviceType::CAMERA);
+    Logger::Log("MainCameraImagePipeLine | mainwindow.cpp | calculateGPM | blackWhite = " +
+                    std::to_string(gpm.blackLevel) + "," + std::to_string(gpm.whiteLevel),
+                LogLevel::INFO, DeviceType::CAMERA);
+    Logger::Log("MainCameraImagePipeLine | mainwindow.cpp | calculateGPM | gainRB = " +
+                    std::to_string(gpm.gainR) + "," + std::to_string(gpm.gainB),
+                LogLevel::INFO, DeviceType::CAMERA);
 
     return gpm;
 }
@@ -1433,6 +1247,18 @@ void MainWindow::generateViewportTiles_Once(quint64 epoch, quint64 requestSeq, i
                     " forceFullImageForCappedMode=" + std::string(forceFullImageForCappedMode ? "true" : "false"),
                 LogLevel::INFO, DeviceType::CAMERA);
 
+    // 视口拉伸/白平衡参数：由逐瓦片统计按视口合并，微秒级，先于瓦片写盘发出
+    if (st.tileStats && !st.tileStats->empty()) {
+        const double viewLeft = std::max(0.0, visibleX - visibleWidth / 2.0);
+        const double viewTop = std::max(0.0, visibleY - visibleHeight / 2.0);
+        const double viewRight = std::min(static_cast<double>(W), viewLeft + visibleWidth);
+        const double viewBottom = std::min(static_cast<double>(H), viewTop + visibleHeight);
+        sendViewportStatsToClient(st.sessionId, st.frameId, *st.tileStats,
+                                  static_cast<int>(std::floor(viewLeft)), static_cast<int>(std::floor(viewTop)),
+                                  static_cast<int>(std::ceil(viewRight - viewLeft)),
+                                  static_cast<int>(std::ceil(viewBottom - viewTop)));
+    }
+
     QElapsedTimer timer;
     timer.start();
 
@@ -2515,12 +2341,14 @@ MainWindow::TileGPM MainWindow::generateTilePyramid(const cv::Mat& image16, cons
     gpmJson["frameId"] = QString::number(static_cast<qulonglong>(gpm.frameId));
     gpmJson["buildMode"] = gpm.buildMode;
     gpmJson["levelMode"] = gpm.levelMode;
+    gpmJson["statsMode"] = gpm.statsMode;
 
         // 直方图（可选）
         // 注意：完整 65536 bins 写入 JSON 会非常大；这里只写入基础信息，详细直方图走 WebSocket B64 通道
         if (gpm.histogramBins > 0 && !gpm.histogram.empty()) {
             gpmJson["histogramBins"] = gpm.histogramBins;
             gpmJson["histogramTotal"] = QString::number(static_cast<qulonglong>(gpm.histogramTotal));
+            gpmJson["histogramChannels"] = gpm.histogramChannels;
         }
 
     QJsonDocument gpmDoc(gpmJson);
@@ -2587,8 +2415,11 @@ void MainWindow::sendGPMToClient(const TileGPM& gpm)
     // - v3(追加): ...:{frameId}
     // - v4(追加): ...:{buildMode}
     // - v5(追加): ...:{levelMode}
+    // - v6(追加): ...:{statsMode}:{globalMin}:{globalMax}:{globalMean}:{globalStdDev}
+    //   statsMode=tiles 时 blackLevel/whiteLevel/gainR/gainB 为后端逐瓦片统计得出的自动参数，前端可直接使用；
+    //   neutral 时仍为中性参数（0/65535/1/1）
     // 说明：追加字段放在末尾，旧前端按前 11 段解析不会受影响。
-    QString gpmMessage = QString("TileGPM:%1:%2:%3:%4:%5:%6:%7:%8:%9:%10:%11:%12:%13:%14:%15:%16")
+    QString gpmMessage = QString("TileGPM:%1:%2:%3:%4:%5:%6:%7:%8:%9:%10:%11:%12:%13:%14:%15:%16:%17:%18:%19:%20:%21")
         .arg(gpm.sessionId)
         .arg(gpm.imageWidth)
         .arg(gpm.imageHeight)
@@ -2604,7 +2435,12 @@ void MainWindow::sendGPMToClient(const TileGPM& gpm)
         .arg(gpm.previewBinningFactor)
         .arg(QString::number(static_cast<qulonglong>(gpm.frameId)))
         .arg(gpm.buildMode)
-        .arg(gpm.levelMode);
+        .arg(gpm.levelMode)
+        .arg(gpm.statsMode)
+        .arg(gpm.globalMin)
+        .arg(gpm.globalMax)
+        .arg(gpm.globalMean, 0, 'f', 2)
+        .arg(gpm.globalStdDev, 0, 'f', 2);
 
     emit wsThread->sendMessageToClient(gpmMessage);
     Logger::Log("GPM sent to client: " + gpmMessage.toStdString(), LogLevel::INFO, DeviceType::CAMERA);
@@ -2835,6 +2671,52 @@ void MainWindow::sendCurrentTileGenerationCompleteSnapshotToClient(const QString
     emit wsThread->sendMessageToClient(message);
 }
 
+void MainWindow::fillGpmHistogram(TileGPM& gpm, const image::TileStatsGrid& stats)
+{
+    const image::RegionStats& all = stats.global();
+    gpm.histogramBins = stats.bins();
+    gpm.histogramTotal = all.combined().count;
+    gpm.histogram = all.combinedHistogram();
+    gpm.histogramChannels = 0;
+    gpm.channelHistogram.clear();
+    if (stats.channels() > 1) {
+        gpm.histogramChannels = stats.channels();
+        gpm.channelHistogram = all.histogram;
+    }
+}
+
+bool MainWindow::histogramStretchChanged(uint16_t blackLevel, uint16_t whiteLevel)
+{
+    // 自动拉伸的黑/白点随噪声逐帧抖动几个 ADU；变化超过上次窗口宽度的 1% 才算拉伸参数变了
+    const int span = std::max(1, static_cast<int>(lastHistogramWhiteLevel) - static_cast<int>(lastHistogramBlackLevel));
+    const int tolerance = std::max(1, span / 100);
+    if (std::abs(static_cast<int>(blackLevel) - static_cast<int>(lastHistogramBlackLevel)) <= tolerance &&
+        std::abs(static_cast<int>(whiteLevel) - static_cast<int>(lastHistogramWhiteLevel)) <= tolerance) {
+        return false;
+    }
+    lastHistogramBlackLevel = blackLevel;
+    lastHistogramWhiteLevel = whiteLevel;
+    return true;
+}
+
+void MainWindow::sendCurrentHistogramToClient()
+{
+    TileGPM gpm{};
+    std::shared_ptr<const image::TileStatsGrid> stats;
+    {
+        std::lock_guard<std::mutex> lk(tileFrameMutex);
+        gpm.sessionId = tileFrame.sessionId;
+        gpm.frameId = tileFrame.frameId;
+        stats = tileFrame.tileStats;
+    }
+    if (!stats || stats->empty()) {
+        Logger::Log("getHistogram | no tile stats for the current frame", LogLevel::DEBUG, DeviceType::CAMERA);
+        return;
+    }
+    fillGpmHistogram(gpm, *stats);
+    sendHistogramToClient(gpm);
+}
+
 void MainWindow::sendHistogramToClient(const TileGPM& gpm)
 {
     if (gpm.sessionId.isEmpty() || gpm.histogramBins <= 0 || gpm.histogram.empty()) {
@@ -2857,6 +2739,7 @@ void MainWindow::sendHistogramToClient(const TileGPM& gpm)
     
     // 写入文件头和数据（便于前端解析）
     // 文件格式：[bins(4字节)][total(8字节)][histogram数据(bins*4字节)]
+    //          彩色 RAW 追加：[channels(4字节)][分通道直方图(channels*bins*4字节，R/G1/G2/B)]；旧前端只读前段不受影响
     QDataStream out(&binFile);
     out.setByteOrder(QDataStream::LittleEndian);
     
@@ -2870,6 +2753,14 @@ void MainWindow::sendHistogramToClient(const TileGPM& gpm)
     for (uint32_t count : gpm.histogram) {
         out << static_cast<quint32>(count);
     }
+
+    if (gpm.histogramChannels > 0 &&
+        gpm.channelHistogram.size() == static_cast<size_t>(gpm.histogramChannels) * gpm.histogramBins) {
+        out << static_cast<quint32>(gpm.histogramChannels);
+        for (uint32_t count : gpm.channelHistogram) {
+            out << static_cast<quint32>(count);
+        }
+    }
     
     qint64 fileSize = binFile.size();
     binFile.close();
@@ -2877,7 +2768,7 @@ void MainWindow::sendHistogramToClient(const TileGPM& gpm)
     Logger::Log("Histogram saved to file: " + histogramFilePath.toStdString() + 
                 ", size: " + std::to_string(fileSize) + " bytes" +
                 ", bins: " + std::to_string(gpm.histogramBins),
-                LogLevel::INFO, DeviceType::CAMERA);
+                LogLevel::DEBUG, DeviceType::CAMERA);
     
     // 3. 构建下载 URL（nginx 需 alias /img/capture-tiles/ -> /dev/shm/capture-tiles/）
     QString histogramUrl = QString("/img/capture-tiles/%1").arg(histogramFileName);
@@ -2894,12 +2785,61 @@ void MainWindow::sendHistogramToClient(const TileGPM& gpm)
     
     Logger::Log("Histogram URL sent to client: session=" + gpm.sessionId.toStdString() +
                 ", url=" + histogramUrl.toStdString(),
-                LogLevel::INFO, DeviceType::CAMERA);
+                LogLevel::DEBUG, DeviceType::CAMERA);
     
-    // 5. 每帧独立 histogram 文件；保留最近几帧，兼顾前端异步下载与 tmpfs 占用。
+    // 5. 每次发送独立 histogram 文件；保留最近几份，兼顾前端异步下载与 tmpfs 占用。
     cleanupOldHistogramFiles(5);
 }
 
+void MainWindow::sendViewportStatsToClient(const QString& sessionId, quint64 frameId, const image::TileStatsGrid& stats,
+                                           int x, int y, int w, int h)
+{
+    if (sessionId.isEmpty() || stats.empty() || w <= 0 || h <= 0) {
+        return;
+    }
+
+    const image::RegionStats region = stats.region(x, y, w, h);
+    if (region.empty()) {
+        return;
+    }
+    double mean = 0.0;
+    double stdDev = 0.0;
+    image::displayMeanStdDev(region, &mean, &stdDev);
+    const image::StretchLevels levels = image::autoStretch(region);
+    double gainR = 1.0;
+    double gainB = 1.0;
+    if (stats.channels() > 1) {
+        const uint16_t offset = static_cast<uint16_t>(std::clamp(std::lround(ImageOffset), 0l, 65535l));
+        const image::WhiteBalance wb = image::whiteBalance(region, offset);
+        gainR = wb.gainR;
+        gainB = wb.gainB;
+    }
+
+    // 格式: TileViewportStats:{sessionId}:{frameId}:{x}:{y}:{w}:{h}:{blackLevel}:{whiteLevel}:{gainR}:{gainB}:{mean}:{stdDev}
+    // 说明：x/y/w/h 为实际参与统计的区域（视口向外取整到 z=maxZoomLevel 层的整瓦片，原图像素）
+    const int T = stats.tileSize();
+    const int rx = std::max(0, x) / T * T;
+    const int ry = std::max(0, y) / T * T;
+    const int rw = std::min(stats.width(), ((std::min(stats.width(), x + w) - 1) / T + 1) * T) - rx;
+    const int rh = std::min(stats.height(), ((std::min(stats.height(), y + h) - 1) / T + 1) * T) - ry;
+    const QString msg = QString("TileViewportStats:%1:%2:%3:%4:%5:%6:%7:%8:%9:%10:%11:%12")
+        .arg(sessionId)
+        .arg(QString::number(static_cast<qulonglong>(frameId)))
+        .arg(rx)
+        .arg(ry)
+        .arg(rw)
+        .arg(rh)
+        .arg(levels.black)
+        .arg(levels.white)
+        .arg(gainR)
+        .arg(gainB)
+        .arg(mean, 0, 'f', 2)
+        .arg(stdDev, 0, 'f', 2);
+    emit wsThread->sendMessageToClient(msg);
+    Logger::Log("MainCameraImagePipeLine | mainwindow.cpp | sendViewportStatsToClient | " + msg.toStdString(),
+                LogLevel::DEBUG, DeviceType::CAMERA);
+}
+
 void MainWindow::cleanupOldHistogramFiles(int keepCount)
 {
     // 直方图与瓦片同在 tmpfs（tilePyramidPath）
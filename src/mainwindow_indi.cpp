@@ -96,7 +96,17 @@ void MainWindow::initINDIClient()
             {
                 if (dpMainCamera->getDeviceName() == devname)
                 {
-                    lastMainCaptureFitsPath = QString::fromStdString(filename);
+                    // BLOB 模式下帧已在内存解码：显示/归档直接用它；文件模式只有路径，归档走 saveImageFile 复制
+                    fits::HeaderTemplate blobHeader;
+                    std::shared_ptr<SdkFrameData> blobFrame = indi_Client->takeBlobFrame(devname, &blobHeader);
+                    // 本回调在 INDI 线程：最近一帧的缓存只在 MainWindow 线程读写（归档/计划保存都在那边取用）
+                    QMetaObject::invokeMethod(this, [this, path = QString::fromStdString(filename), blobFrame,
+                                                     header = std::move(blobHeader)]() mutable {
+                        lastMainCaptureFitsPath = path;
+                        lastMainCaptureFrame = blobFrame;
+                        if (blobFrame)
+                            lastMainCaptureHeader = std::move(header);
+                    }, Qt::QueuedConnection);
                     glMainCameraStatu = "Displaying";
                     ShootStatus = "Completed";
                     if (autoFocuserIsROI && isAutoFocus)
@@ -120,13 +130,18 @@ void MainWindow::initINDIClient()
                     // 说明这可能是 ROI 停止时的残留帧，应该丢弃或按 ROI 处理
                     if (glIsFocusingLooping == false && !isFocusLoopShooting)
                     {
-                        // 读取 FITS 获取图像尺寸，判断是否为 ROI 残留帧
+                        // 读取 FITS 获取图像尺寸，判断是否为 ROI 残留帧（内存帧直接取尺寸）
                         fitsfile *fptr = nullptr;
                         int status = 0;
                         long naxes[2] = {0, 0};
                         int naxis = 0;
 
-                        if (fits_open_file(&fptr, filename.c_str(), READONLY, &status) == 0)
+                        if (blobFrame)
+                        {
+                            naxes[0] = blobFrame->width;
+                            naxes[1] = blobFrame->height;
+                        }
+                        else if (fits_open_file(&fptr, filename.c_str(), READONLY, &status) == 0)
                         {
                             fits_get_img_dim(fptr, &naxis, &status);
                             if (naxis == 2)
@@ -174,13 +189,17 @@ void MainWindow::initINDIClient()
                                 return;
                             }
                         }
-                        saveFitsAsPNG(QString::fromStdString(filename), true);
+                        if (blobFrame)
+                            saveFitsAsPNG_FromSdkFrame(blobFrame, true);
+                        else
+                            saveFitsAsPNG(QString::fromStdString(filename), true);
 
                         // 如果自动保存开启，自动保存图像
                         if (mainCameraAutoSave && isScheduleRunning == false)
                         {
                             Logger::Log("Auto Save enabled, saving captured image...", LogLevel::INFO, DeviceType::MAIN);
-                            CaptureImageSave();
+                            // 排在上面的缓存更新之后执行，保存的是这一帧
+                            QMetaObject::invokeMethod(this, [this]() { CaptureImageSave(); }, Qt::QueuedConnection);
                         }
                     }
                     else
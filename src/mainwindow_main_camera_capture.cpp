@@ -87,8 +87,9 @@ void MainWindow::SDK_BurstCapture(int Exp_ms, int frames)
 
     const int expMsSnap = Exp_ms;
     const int framesSnap = frames;
+    const qint64 burstStartMs = QDateTime::currentMSecsSinceEpoch(); // FITS DATE-OBS
 
-    mainExec->post([this, expMsSnap, framesSnap]() mutable {
+    mainExec->post([this, expMsSnap, framesSnap, burstStartMs]() mutable {
         QString failReason;
         bool cancelled = false;
         std::shared_ptr<SdkFrameData> outFrame = std::make_shared<SdkFrameData>();
@@ -182,6 +183,8 @@ void MainWindow::SDK_BurstCapture(int Exp_ms, int frames)
         const auto maxWait = std::chrono::milliseconds(
             std::max(15000, expMsSnap * framesSnap + 15000));
         bool firstFrameLogged = false;
+        // 取帧命令在循环外构造，首次拿到设备后预解析命令 id，循环内不再按名字分派
+        SdkCommand getCmd{SdkCommandType::Custom, "GetLiveFrame", {}};
 
         while (okFrames < framesSnap)
         {
@@ -193,29 +196,25 @@ void MainWindow::SDK_BurstCapture(int Exp_ms, int frames)
                 break;
             }
 
-            SdkCommand getCmd;
-            getCmd.type = SdkCommandType::Custom;
-            getCmd.name = "GetLiveFrame";
-            getCmd.payload = std::any();
-
             SdkDeviceInfo dev;
             if (!waitMainCameraReady(8000, dev)) {
                 std::this_thread::sleep_for(std::chrono::milliseconds(20));
                 continue;
             }
+            if (getCmd.idOwner == nullptr) {
+                SdkManager::instance().resolveCommand(dev.driverName, getCmd);
+            }
             SdkResult frameRes = SdkManager::instance().call(dev.driverName, dev.handle, getCmd);
             if (!frameRes.success) {
                 std::this_thread::sleep_for(std::chrono::milliseconds(1));
                 continue;
             }
 
-            SdkFrameData frame;
-            try {
-                frame = std::any_cast<SdkFrameData>(frameRes.payload);
-            } catch (const std::bad_any_cast&) {
+            if (!frameRes.frame) {
                 std::this_thread::sleep_for(std::chrono::milliseconds(1));
                 continue;
             }
+            SdkFrameData frame = std::move(*frameRes.frame);
             const bool hasFrameData =
                 (!frame.pixels.empty()) || (frame.rawBuffer != nullptr && frame.rawBytes > 0);
             if (frame.width <= 0 || frame.height <= 0 || !hasFrameData) {
@@ -309,7 +308,7 @@ void MainWindow::SDK_BurstCapture(int Exp_ms, int frames)
             outFrame->pixels[p] = static_cast<uint16_t>(accum[p] / static_cast<uint32_t>(okFrames));
         }
 
-        QMetaObject::invokeMethod(this, [this, outFrame]() {
+        QMetaObject::invokeMethod(this, [this, outFrame, burstStartMs, expMsSnap, okFrames]() {
             sdkBurstActive = false;
             sdkBurstCancelRequested = false;
 
@@ -321,11 +320,20 @@ void MainWindow::SDK_BurstCapture(int Exp_ms, int frames)
             }
 
             const std::string fitsPath = "/dev/shm/ccd_simulator.fits";
-            SaveQhyFrameDataToFits(*outFrame, fitsPath);
+            fits::HeaderTemplate header = buildMainCameraFitsHeader(burstStartMs, expMsSnap);
+            header.setLong("STACKCNT", okFrames, "Live frames averaged");
+            SaveQhyFrameDataToFits(*outFrame, fitsPath, header);
+            lastMainCaptureFitsPath = QString::fromStdString(fitsPath);
+            lastMainCaptureFrame = outFrame;
+            lastMainCaptureHeader = header;
 
             glMainCameraStatu = "Displaying";
             ShootStatus = "Completed";
             emit wsThread->sendMessageToClient("ExposureCompleted");
+            devices::DeviceStateBus::instance().updateRole(devices::DeviceRole::MainCamera, [&](devices::DeviceState &state) {
+                ++state.camera.imageSeq;
+                state.camera.lastImagePath = fitsPath;
+            });
             emitCaptureTrace(QStringLiteral("backend_exposure_completed"), currentCaptureTraceStartedAtMs,
                              QStringLiteral("source=sdk_burst"));
 
@@ -786,99 +794,20 @@ void MainWindow::abortMainCameraCapture()
     Logger::Log("abortMainCameraCapture finished.", LogLevel::INFO, DeviceType::CAMERA);
 }
 
-void MainWindow::SaveQhyFrameDataToFits(const SdkFrameData& frame, const std::string& filepath)
+void MainWindow::SaveQhyFrameDataToFits(const SdkFrameData& frame, const std::string& filepath,
+                                        const fits::HeaderTemplate& header)
 {
-    const bool hasVecPixels = !frame.pixels.empty();
-    const bool hasRawPixels = (frame.rawBuffer != nullptr && frame.rawBytes > 0);
-    if (frame.width <= 0 || frame.height <= 0 || (!hasVecPixels && !hasRawPixels))
+    // 写入逻辑统一在 fits::writeFrame（与后台归档写盘共用）：先写 .part 再 rename，读取方不会读到半个文件
+    fits::WriteResult r;
+    if (!fits::writeFrame(frame, filepath, header, fits::WriteOptions(), &r))
     {
-        Logger::Log("SaveQhyFrameDataToFits | invalid frame, skip write. size=" +
-                        std::to_string(frame.width) + "x" + std::to_string(frame.height) +
-                        " pixels=" + std::to_string(frame.pixels.size()) +
-                        " raw=" + std::string(hasRawPixels ? "true" : "false") +
-                        " rawBytes=" + std::to_string(frame.rawBytes) +
-                        " bpp=" + std::to_string(frame.bpp) +
-                        " ch=" + std::to_string(frame.channels),
+        Logger::Log("SaveQhyFrameDataToFits | " + r.error + " | path=" + filepath,
                     LogLevel::ERROR, DeviceType::CAMERA);
         return;
     }
-
-    fitsfile *fptr;
-    int status = 0;
-    long naxes[2] = {static_cast<long>(frame.width), static_cast<long>(frame.height)};
-    const long fpixel[2] = {1, 1};
-
-    remove(filepath.c_str());
-
-    fits_create_file(&fptr, filepath.c_str(), &status);
-    if (status) {
-        Logger::Log("SaveQhyFrameDataToFits | fits_create_file failed, status=" + std::to_string(status),
-                   LogLevel::ERROR, DeviceType::CAMERA);
-        return;
-    }
-
-    int bitpix = USHORT_IMG;
-    int datatype = TUSHORT;
-    long nelements = static_cast<long>(static_cast<long long>(frame.width) * static_cast<long long>(frame.height));
-    const void* srcPtr = nullptr;
-
-    if (hasVecPixels) {
-        bitpix = USHORT_IMG;
-        datatype = TUSHORT;
-        nelements = static_cast<long>(frame.pixels.size());
-        srcPtr = frame.pixels.data();
-    } else {
-        if (frame.channels != 1 || (frame.bpp != 16 && frame.bpp != 8)) {
-            Logger::Log("SaveQhyFrameDataToFits | unsupported rawBuffer format: bpp=" +
-                            std::to_string(frame.bpp) + " channels=" + std::to_string(frame.channels),
-                        LogLevel::ERROR, DeviceType::CAMERA);
-            fits_close_file(fptr, &status);
-            return;
-        }
-        const size_t pixelCount = static_cast<size_t>(frame.width) * static_cast<size_t>(frame.height);
-        const size_t needBytes = pixelCount * (frame.bpp == 16 ? sizeof(uint16_t) : sizeof(uint8_t));
-        if (frame.rawBuffer->size() < needBytes || frame.rawBytes < needBytes) {
-            Logger::Log("SaveQhyFrameDataToFits | rawBuffer too small: needBytes=" +
-                            std::to_string(needBytes) + " rawBytes=" + std::to_string(frame.rawBytes) +
-                            " bufSize=" + std::to_string(frame.rawBuffer->size()),
-                        LogLevel::ERROR, DeviceType::CAMERA);
-            fits_close_file(fptr, &status);
-            return;
-        }
-        nelements = static_cast<long>(pixelCount);
-        if (frame.bpp == 8) {
-            bitpix = BYTE_IMG;
-            datatype = TBYTE;
-        } else {
-            bitpix = USHORT_IMG;
-            datatype = TUSHORT;
-        }
-        srcPtr = frame.rawBuffer->data();
-    }
-
-    fits_create_img(fptr, bitpix, 2, naxes, &status);
-    if (status) {
-        Logger::Log("SaveQhyFrameDataToFits | fits_create_img failed, status=" + std::to_string(status),
-                   LogLevel::ERROR, DeviceType::CAMERA);
-        fits_close_file(fptr, &status);
-        return;
-    }
-
-    fits_write_pix(fptr, datatype, const_cast<long*>(fpixel), nelements,
-                   const_cast<void*>(srcPtr), &status);
-    if (status) {
-        Logger::Log("SaveQhyFrameDataToFits | fits_write_pix failed, status=" + std::to_string(status),
-                   LogLevel::ERROR, DeviceType::CAMERA);
-    }
-
-    fits_close_file(fptr, &status);
-    if (status) {
-        Logger::Log("SaveQhyFrameDataToFits | fits_close_file failed, status=" + std::to_string(status),
-                   LogLevel::ERROR, DeviceType::CAMERA);
-    } else {
-        Logger::Log("SaveQhyFrameDataToFits | FITS saved successfully: " + filepath,
-                   LogLevel::INFO, DeviceType::CAMERA);
-    }
+    Logger::Log("SaveQhyFrameDataToFits | FITS saved successfully: " + filepath +
+                    " | totalMs=" + std::to_string(static_cast<int>(r.timing.totalMs)),
+                LogLevel::INFO, DeviceType::CAMERA);
 }
 
 void MainWindow::onSdkExposureTimerTimeout()
@@ -980,7 +909,7 @@ void MainWindow::onSdkExposureTimerTimeout()
 
         QMetaObject::invokeMethod(
             this,
-            [this, frameRes, isRoiSnap, expected]() mutable {
+            [this, frameRes = std::move(frameRes), isRoiSnap, expected]() mutable {
                 sdkFrameTaskInFlight = false;
 
                 if (sdkMainCameraHandle == nullptr)
@@ -997,15 +926,13 @@ void MainWindow::onSdkExposureTimerTimeout()
                 {
                     Logger::Log("onSdkExposureTimerTimeout | GetSingleFrame success", LogLevel::INFO, DeviceType::CAMERA);
 
-                    SdkFrameData frame;
-                    try {
-                        frame = std::any_cast<SdkFrameData>(frameRes.payload);
-                    } catch (const std::bad_any_cast&) {
-                        Logger::Log("onSdkExposureTimerTimeout | payload any_cast failed",
+                    if (!frameRes.frame) {
+                        Logger::Log("onSdkExposureTimerTimeout | result carries no frame",
                                     LogLevel::WARNING, DeviceType::CAMERA);
                         glMainCameraStatu = "IDLE";
                         return;
                     }
+                    SdkFrameData frame = std::move(*frameRes.frame);
                     Logger::Log("onSdkExposureTimerTimeout | Frame size: " +
                                     std::to_string(frame.width) + "x" + std::to_string(frame.height),
                                 LogLevel::INFO, DeviceType::CAMERA);
@@ -1033,6 +960,8 @@ void MainWindow::onSdkExposureTimerTimeout()
 
                     if (isRoiSnap)
                     {
+                        // ROI 帧覆盖同一个 FITS 路径：缓存的全幅帧已与文件不对应，归档回退为复制该文件
+                        lastMainCaptureFrame.reset();
                         SaveQhyFrameDataToFits(*framePtr, fitsPath);
                         saveFitsAsJPG(QString::fromStdString(fitsPath), true);
                         Logger::Log("onSdkExposureTimerTimeout | ROI mode, saveFitsAsJPG complete",
@@ -1040,11 +969,19 @@ void MainWindow::onSdkExposureTimerTimeout()
                     }
                     else
                     {
-                        SaveQhyFrameDataToFits(*framePtr, fitsPath);
+                        const fits::HeaderTemplate header =
+                            buildMainCameraFitsHeader(sdkExposureStartTime, static_cast<int>(expected));
+                        SaveQhyFrameDataToFits(*framePtr, fitsPath, header);
                         lastMainCaptureFitsPath = QString::fromStdString(fitsPath);
+                        lastMainCaptureFrame = framePtr;
+                        lastMainCaptureHeader = header;
 
                         ShootStatus = "Completed";
                         emit wsThread->sendMessageToClient("ExposureCompleted");
+                        devices::DeviceStateBus::instance().updateRole(devices::DeviceRole::MainCamera, [&](devices::DeviceState &state) {
+                            ++state.camera.imageSeq;
+                            state.camera.lastImagePath = fitsPath;
+                        });
                         emitCaptureTrace(QStringLiteral("backend_exposure_completed"), currentCaptureTraceStartedAtMs,
                                          QStringLiteral("source=sdk_timer"));
                         Logger::Log("onSdkExposureTimerTimeout | Full resolution mode, ExposureCompleted",
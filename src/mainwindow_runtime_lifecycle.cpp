@@ -35,6 +35,71 @@ void MainWindow::initializeRuntimeWorkersAndTimers()
     sdkPoleCamExec = std::make_unique<SdkSerialExecutor>(QStringLiteral("SdkPoleCameraWorker"));
     sdkFocuserExec = std::make_unique<SdkSerialExecutor>(QStringLiteral("SdkFocuserWorker"));
 
+    // 后台 FITS 写盘（归档）：队列上限即计划任务可领先存储的帧数
+    fitsWriter = std::make_unique<fits::FitsWriter>(4);
+    // U 盘导出：3 个工作线程，同一设备同时只写一个文件（本地盘/多个 U 盘之间可并行）
+    exportEngine = std::make_unique<storage::FileExportEngine>(3, 1);
+
+    // 设备状态总线：INDI/SDK 回调线程写入，变化切回主线程让等待中的计划表步骤立即复核
+    syncDeviceStateBusRoles();
+    deviceStateBusToken = devices::DeviceStateBus::instance().subscribe(
+        [this](devices::DeviceRole role, const devices::DeviceState &) {
+            QMetaObject::invokeMethod(this, [this, role]() {
+                onDeviceStateChanged(static_cast<int>(role));
+            }, Qt::QueuedConnection);
+        });
+
+    // 常驻解析服务：索引目录可用 QUARCS_ASTROMETRY_INDEX_DIRS（冒号分隔）覆盖，
+    // 索引预载按需开启：QUARCS_SOLVER_PRELOAD_MB（默认 0 不预载），QUARCS_SOLVER_PRELOAD_FIELD_ARCMIN 只预载与该视场相称的尺度，
+    // QUARCS_SOLVER_MLOCK=1 时锁定在内存
+    {
+        solver::SolveServiceConfig solveConfig;
+        const QString dirs = qEnvironmentVariableIsSet("QUARCS_ASTROMETRY_INDEX_DIRS")
+                                 ? QString::fromLocal8Bit(qgetenv("QUARCS_ASTROMETRY_INDEX_DIRS"))
+                                 : QStringLiteral("/usr/local/astrometry/data:/usr/share/astrometry");
+        for (const QString &dir : dirs.split(':', Qt::SkipEmptyParts))
+            solveConfig.indexFolders.push_back(dir.trimmed().toStdString());
+        bool ok = false;
+        const int preloadMb = qEnvironmentVariableIntValue("QUARCS_SOLVER_PRELOAD_MB", &ok);
+        if (ok && preloadMb >= 0)
+            solveConfig.preloadBudgetMb = static_cast<size_t>(preloadMb);
+        const double fieldArcmin = qgetenv("QUARCS_SOLVER_PRELOAD_FIELD_ARCMIN").toDouble(&ok);
+        if (ok && fieldArcmin > 0.0)
+            solveConfig.preloadFieldArcmin = fieldArcmin;
+        solveConfig.lockPreloaded = qgetenv("QUARCS_SOLVER_MLOCK") == "1";
+        solver::PlateSolveService::instance().start(solveConfig);
+    }
+
+    // 图库索引：载入上次的索引后在后台线程增量对账并开始 inotify 监听，浏览图库不再每次遍历目录
+    imageCatalog = std::make_unique<storage::ImageCatalog>(
+        ImageSaveBasePath,
+        std::vector<std::string>{"CaptureImage", "ScheduleImage", "solveFailedImage"},
+        ImageSaveBasePath + "/.quarcs_catalog.idx",
+        &MainWindow::readCatalogMeta);
+    std::string catalogError;
+    if (!imageCatalog->open(&catalogError))
+    {
+        Logger::Log("Image catalog unavailable, fallback to directory listing: " + catalogError, LogLevel::WARNING, DeviceType::MAIN);
+        imageCatalog.reset();
+    }
+    else
+    {
+        imageCatalog->startWatching(300);
+    }
+
+    // 系统遥测：3 秒一次（与原 system_timer 相同），应用所在分区的可用空间随采样缓存，供 Box_Space 直接读取
+    {
+        telemetry::SystemSampler::Options telemetryOptions;
+        telemetryOptions.diskPaths.push_back(QCoreApplication::applicationDirPath().toStdString());
+        telemetryService = std::make_unique<telemetry::TelemetryService>(telemetryOptions, 3000);
+        telemetryService->start([this](const telemetry::TelemetrySample &sample, const std::string &delta) {
+            const QString deltaText = QString::fromStdString(delta);
+            QMetaObject::invokeMethod(this, [this, sample, deltaText]() {
+                updateCPUInfo(sample, deltaText);
+            }, Qt::QueuedConnection);
+        });
+    }
+
     emit wsThread->sendMessageToClient("ServerInitSuccess");
     Logger::Log("ServerInitSuccess", LogLevel::INFO, DeviceType::MAIN);
 }
@@ -52,6 +117,18 @@ void MainWindow::shutdownRuntimeWorkersAndTimers()
     if (focusMoveTimer)
         focusMoveTimer->stop();
 
+    // 已投递但未执行的上报随对象析构丢弃，这里只需等采样线程退出
+    if (telemetryService)
+    {
+        telemetryService->stop();
+        telemetryService.reset();
+    }
+
+    // 先退订再放行阻塞等待者，之后不会再有投递到本对象的总线回调
+    devices::DeviceStateBus::instance().unsubscribe(deviceStateBusToken);
+    deviceStateBusToken = 0;
+    devices::DeviceStateBus::instance().cancelWaits();
+
     cleanupQhySdkPoolAndResource("MainWindow::~MainWindow", "All");
 
     sdkPoleCamExec.reset();
@@ -61,6 +138,33 @@ void MainWindow::shutdownRuntimeWorkersAndTimers()
     sdkFocuserExec.reset();
 
     cleanupSdkMainLiveShm();
+
+    // 导出中断时保留 .part，下次 ResumeUsbExport/重新导出会从断点继续
+    if (exportEngine)
+    {
+        exportEngine->stop();
+        exportEngine.reset();
+    }
+
+    // 写完已排队的归档文件再退出，避免关机/重启时丢图
+    if (fitsWriter)
+    {
+        fitsWriter->stop();
+        fitsWriter.reset();
+    }
+
+    // 正在解析的请求被 abort，排队的请求以 Cancelled 结束
+    solver::PlateSolveService::instance().stop();
+
+    // 写盘回调会登记图库，所以在写盘服务之后停
+    if (imageCatalog)
+    {
+        imageCatalog->stop();
+        imageCatalog.reset();
+    }
+
+    // 配置修改是防抖写盘的，退出前写出最后的修改
+    Tools::flushConfig();
 }
 
 MainWindow::~MainWindow()
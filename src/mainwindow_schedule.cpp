@@ -1,5 +1,34 @@
 #include "mainwindow_command_support.h"
 
+namespace {
+
+bool isValidObservatoryLocation(double latitude, double longitude)
+{
+    return std::isfinite(latitude) &&
+           std::isfinite(longitude) &&
+           std::abs(latitude) <= 90.0 &&
+           std::abs(longitude) <= 180.0 &&
+           !(latitude == 0.0 && longitude == 0.0) &&
+           latitude != -1.0 &&
+           longitude != -1.0;
+}
+
+qint64 scheduleNowMs()
+{
+    return QDateTime::currentMSecsSinceEpoch();
+}
+
+// 两点角距（度）
+double angularSeparationDeg(double ra1Deg, double dec1Deg, double ra2Deg, double dec2Deg)
+{
+    const double d2r = M_PI / 180.0;
+    const double c = std::sin(dec1Deg * d2r) * std::sin(dec2Deg * d2r) +
+                     std::cos(dec1Deg * d2r) * std::cos(dec2Deg * d2r) * std::cos((ra1Deg - ra2Deg) * d2r);
+    return std::acos(std::max(-1.0, std::min(1.0, c))) / d2r;
+}
+
+} // namespace
+
 void MainWindow::ScheduleTabelData(QString message)
 {
     ScheduleTargetNames.clear();
@@ -9,6 +38,10 @@ void MainWindow::ScheduleTabelData(QString message)
     schedule_currentShootNum = 0;
     // 新任务计划表开始时，重置 Refocus 触发记录，避免旧任务残留导致本次不触发
     schedule_refocusTriggeredIndex = -1;
+    schedule_flipDoneIndex = -1;
+    schedule_filterPrefetchIndex = -1;
+    schedule_filterSettledIndex = -1;
+    scheduleOverhead.clear();
     QStringList ColDataList = message.split('[');
     for (int i = 1; i < ColDataList.size(); ++i)
     {
@@ -185,6 +218,9 @@ void MainWindow::startSchedule()
         StopSchedule = false;
         isScheduleRunning = true;
         emit wsThread->sendMessageToClient("ScheduleRunning:true");
+        // 每开始一行按当前时刻重排剩余行：前面各步骤的实际耗时会修正后面的中天/翻转时刻
+        rebuildSchedulePlan(schedule_currentNum);
+        scheduleOverhead[schedule_currentNum].reset(scheduleNowMs());
         startTimeWaiting();
     }
     else
@@ -206,6 +242,166 @@ void MainWindow::nextSchedule()
     startSchedule();
 }
 
+void MainWindow::rebuildSchedulePlan(int fromIndex)
+{
+    const QDateTime now = QDateTime::currentDateTime();
+    std::vector<schedule::TargetSpec> specs;
+    specs.reserve(m_scheduList.size());
+    for (int i = 0; i < m_scheduList.size(); ++i)
+    {
+        const ScheduleData &row = m_scheduList[i];
+        schedule::TargetSpec spec;
+        spec.name = row.shootTarget.toStdString();
+        spec.raHours = row.targetRa;
+        spec.decDeg = row.targetDec;
+        // 与 WaitForTimeToComplete 相同语义：hh:mm 指今天，已过去则不等待
+        if (row.shootTime.length() == 5 && row.shootTime[2] == ':')
+        {
+            const QDateTime at(now.date(), QTime::fromString(row.shootTime, "hh:mm"));
+            if (at.isValid() && at > now)
+                spec.notBeforeUnix = at.toMSecsSinceEpoch() / 1000.0;
+        }
+        spec.exposureMs = row.exposureTime;
+        spec.repeat = row.repeatNumber;
+        spec.exposureDelayMs = row.exposureDelay;
+        spec.filter = row.filterNumber.toInt();
+        spec.refocus = row.resetFocusing && schedule_refocusTriggeredIndex != i;
+        specs.push_back(spec);
+    }
+
+    schedule::Site site;
+    site.valid = isValidObservatoryLocation(observatorylatitude, observatorylongitude);
+    site.latitudeDeg = observatorylatitude;
+    site.longitudeDeg = observatorylongitude;
+
+    schedulePlan = schedule::buildPlan(specs, site, now.toMSecsSinceEpoch() / 1000.0, schedule::PlanOptions(),
+                                       static_cast<size_t>(qMax(0, fromIndex)));
+
+    auto toMs = [](double unixSec) { return static_cast<qint64>(unixSec * 1000.0); };
+    QJsonArray targetsJson;
+    for (const schedule::TargetPlan &tp : schedulePlan.targets)
+    {
+        QJsonObject t;
+        t["index"] = tp.index;
+        t["name"] = m_scheduList[tp.index].shootTarget;
+        t["start"] = toMs(tp.startUnix);
+        t["end"] = toMs(tp.endUnix);
+
+        QJsonArray steps;
+        for (const schedule::PlanStep &step : tp.steps)
+        {
+            QJsonObject st;
+            st["kind"] = schedule::stepKindName(step.kind);
+            st["frame"] = step.frame;
+            st["start"] = toMs(step.startUnix);
+            st["end"] = toMs(step.endUnix);
+            steps.append(st);
+        }
+        t["steps"] = steps;
+
+        if (schedulePlan.site.valid)
+        {
+            QJsonArray altitude;
+            for (const schedule::AltitudeSample &sample : tp.altitude)
+                altitude.append(QJsonArray{toMs(sample.unix), qRound(sample.altDeg * 10.0) / 10.0});
+            t["altitude"] = altitude;
+            t["minAlt"] = tp.minAltDeg;
+            t["maxAlt"] = tp.maxAltDeg;
+            t["lowAltitude"] = tp.lowAltitude;
+            t["transit"] = toMs(tp.transitUnix);
+            t["transitAlt"] = tp.transitAltDeg;
+            t["flipBeforeFrame"] = tp.flipBeforeFrame;
+            t["flipAt"] = tp.flipBeforeFrame > 0 ? toMs(tp.flipUnix) : 0;
+        }
+        targetsJson.append(t);
+
+        Logger::Log(QString("SchedulePlan | row %1 %2: %3 - %4 (%5 min)%6%7")
+                        .arg(tp.index)
+                        .arg(m_scheduList[tp.index].shootTarget)
+                        .arg(QDateTime::fromMSecsSinceEpoch(toMs(tp.startUnix)).toString("hh:mm:ss"))
+                        .arg(QDateTime::fromMSecsSinceEpoch(toMs(tp.endUnix)).toString("hh:mm:ss"))
+                        .arg(tp.durationSec() / 60.0, 0, 'f', 1)
+                        .arg(tp.flipBeforeFrame > 0 ? QString(", flip before frame %1").arg(tp.flipBeforeFrame) : QString())
+                        .arg(tp.lowAltitude ? QString(", min alt %1").arg(tp.minAltDeg, 0, 'f', 1) : QString())
+                        .toStdString(),
+                    LogLevel::INFO, DeviceType::MAIN);
+    }
+
+    QJsonObject payload;
+    payload["start"] = toMs(schedulePlan.startUnix);
+    payload["end"] = toMs(schedulePlan.endUnix);
+    payload["siteValid"] = schedulePlan.site.valid;
+    payload["targets"] = targetsJson;
+    emit wsThread->sendMessageToClient("SchedulePlan:" + QString::fromUtf8(QJsonDocument(payload).toJson(QJsonDocument::Compact)));
+}
+
+bool MainWindow::scheduleMeridianFlipDue()
+{
+    if (dpMount == NULL || schedule_flipDoneIndex == schedule_currentNum)
+        return false;
+    const schedule::TargetPlan *tp = schedulePlan.target(schedule_currentNum);
+    if (tp == nullptr)
+        return false;
+
+    const double frameSec = schedule_ExpTime / 1000.0 + schedulePlan.options.downloadSec;
+    if (!schedule::flipDueBeforeNextFrame(*tp, schedulePlan.options, QDateTime::currentMSecsSinceEpoch() / 1000.0, frameSec))
+        return false;
+
+    if (!isAutoFlip)
+    {
+        // 每行只提示一次；未开启自动翻转时保持原行为继续拍摄
+        schedule_flipDoneIndex = schedule_currentNum;
+        Logger::Log("scheduleMeridianFlipDue | next frame crosses the meridian limit but auto flip is off, continue without flip",
+                    LogLevel::WARNING, DeviceType::MAIN);
+        return false;
+    }
+    return true;
+}
+
+void MainWindow::startScheduleMeridianFlip()
+{
+    schedule_flipDoneIndex = schedule_currentNum;
+    const schedule::TargetPlan *tp = schedulePlan.target(schedule_currentNum);
+    const qint64 transitMs = tp != nullptr ? static_cast<qint64>(tp->transitUnix * 1000.0) : 0;
+
+    Logger::Log(QString("startScheduleMeridianFlip | row %1 before frame %2, transit at %3")
+                    .arg(schedule_currentNum)
+                    .arg(schedule_currentShootNum + 1)
+                    .arg(QDateTime::fromMSecsSinceEpoch(transitMs).toString("hh:mm:ss"))
+                    .toStdString(),
+                LogLevel::INFO, DeviceType::MAIN);
+    emit wsThread->sendMessageToClient(
+        "ScheduleStepState:" +
+        QString::number(schedule_currentNum) + ":" +
+        "flip:" +
+        QString::number(schedule_currentShootNum) + ":" +
+        QString::number(schedule_RepeatNum) + ":" +
+        "0");
+
+    // 目标过中天前 GOTO 不会换侧：先等到中天（按 1s 轮询以便响应停止），再重新 GOTO 同一目标，
+    // startMountGoto 完成后经 startSetCFW 回到 startCapture，已拍张数不清零
+    timewaitingTimer.stop();
+    timewaitingTimer.disconnect();
+    timewaitingTimer.setSingleShot(true);
+    connect(&timewaitingTimer, &QTimer::timeout, [this, transitMs]()
+            {
+        if (StopSchedule)
+        {
+            StopSchedule = false;
+            qDebug("Schedule is stop!");
+            return;
+        }
+
+        const qint64 remainingMs = transitMs - QDateTime::currentMSecsSinceEpoch();
+        if (remainingMs > 0)
+        {
+            timewaitingTimer.start(static_cast<int>(qMin<qint64>(remainingMs, 1000)));
+            return;
+        }
+        startMountGoto(m_scheduList[schedule_currentNum].targetRa, m_scheduList[schedule_currentNum].targetDec); });
+    timewaitingTimer.start(0);
+}
+
 void MainWindow::startTimeWaiting()
 {
     qDebug() << "startTimeWaiting...";
@@ -241,7 +437,8 @@ void MainWindow::startTimeWaiting()
         {
             timewaitingTimer.start(1000);
         } });
-    timewaitingTimer.start(1000);
+    // 没有时间约束（或已到点）时立即进入转动，不空等一个轮询周期
+    timewaitingTimer.start(0);
 }
 
 void MainWindow::startMountGoto(double ra, double dec)
@@ -278,10 +475,12 @@ void MainWindow::startMountGoto(double ra, double dec)
 
     pauseGuidingBeforeMountMove();
 
+    scheduleOverhead[schedule_currentNum].begin(schedule::Stage::Slew, 0, scheduleNowMs());
     performObservation(
         lst, CurrentDEC_Degree,
         ra, dec,
         observatorylongitude, observatorylatitude);
+    prefetchScheduleFilter();
 
     sleep(2);
 
@@ -318,6 +517,7 @@ void MainWindow::startMountGoto(double ra, double dec)
         {
             telescopeTimer.stop();
             qDebug() << "Mount Goto Complete!";
+            scheduleOverhead[schedule_currentNum].end(schedule::Stage::Slew, 0, scheduleNowMs());
 
             if (MountGotoError) {
                 MountGotoError = false;
@@ -403,6 +603,41 @@ void MainWindow::startGuiding()
 void MainWindow::startSetCFW(int pos)
 {
     qDebug() << "startSetCFW...";
+    // 自动对焦结束后回到这里
+    scheduleOverhead[schedule_currentNum].end(schedule::Stage::Focus, 0, scheduleNowMs());
+
+    // 转动时已下发的滤镜：等到位再继续（对焦与曝光都要在目标滤镜下进行）
+    if (schedule_filterPrefetchIndex == schedule_currentNum)
+    {
+        const bool inPosition = scheduleFilterInPosition(pos);
+        if (!inPosition && scheduleFilterElapsed.elapsed() < 10000)
+        {
+            filterTimer.stop();
+            filterTimer.disconnect();
+            filterTimer.setSingleShot(true);
+            connect(&filterTimer, &QTimer::timeout, [this, pos]()
+                    {
+                if (StopSchedule)
+                {
+                    StopSchedule = false;
+                    qDebug("Schedule is stop!");
+                    return;
+                }
+                startSetCFW(pos); });
+            filterTimer.start(200);
+            return;
+        }
+        scheduleOverhead[schedule_currentNum].end(schedule::Stage::Filter, 0, scheduleNowMs());
+        schedule_filterPrefetchIndex = -1;
+        if (inPosition)
+        {
+            schedule_filterSettledIndex = schedule_currentNum;
+        }
+        else
+        {
+            Logger::Log("startSetCFW | filter prefetched during slew did not settle in 10 s, set it again", LogLevel::WARNING, DeviceType::MAIN);
+        }
+    }
 
     if (schedule_currentNum >= 0 && schedule_currentNum < m_scheduList.size() &&
         m_scheduList[schedule_currentNum].resetFocusing &&
@@ -411,10 +646,27 @@ void MainWindow::startSetCFW(int pos)
         qDebug() << "Refocus is ON, starting autofocus before setting CFW...";
         Logger::Log("计划任务表: Refocus为ON，在执行拍摄前先执行自动对焦（仅最后一步精调）", LogLevel::INFO, DeviceType::MAIN);
         schedule_refocusTriggeredIndex = schedule_currentNum;
+        scheduleOverhead[schedule_currentNum].begin(schedule::Stage::Focus, 0, scheduleNowMs());
         startScheduleAutoFocus();
         return;
     }
 
+    if (schedule_filterSettledIndex == schedule_currentNum)
+    {
+        qDebug() << "CFW already in position (moved during slew)";
+        m_scheduList[schedule_currentNum].progress = calculateScheduleProgress(3, 1.0);
+        emit wsThread->sendMessageToClient("UpdateScheduleProcess:" + QString::number(schedule_currentNum) + ":" + QString::number(m_scheduList[schedule_currentNum].progress));
+        emit wsThread->sendMessageToClient(
+            "ScheduleStepState:" +
+            QString::number(schedule_currentNum) + ":" +
+            "filter:" +
+            "0:" +
+            "0:" +
+            "100");
+        startCapture(schedule_ExpTime);
+        return;
+    }
+
     if (isFilterOnCamera)
     {
         if (!isMainCameraSDK() && dpMainCamera != NULL)
@@ -520,6 +772,191 @@ void MainWindow::startSetCFW(int pos)
     }
 }
 
+void MainWindow::prefetchScheduleFilter()
+{
+    const int pos = schedule_CFWpos;
+    if (pos <= 0 || schedule_filterSettledIndex == schedule_currentNum ||
+        !schedule::mayOverlap(schedule::Stage::Slew, schedule::Stage::Filter))
+        return;
+
+    bool issued = false;
+    std::string err;
+    if (isFilterOnCamera)
+    {
+        if (!isMainCameraSDK() && dpMainCamera != NULL)
+            issued = indi_Client->setCFWPosition(dpMainCamera, pos) == QHYCCD_SUCCESS;
+        else if (isMainCameraSDK() && sdkMainCameraHandle != nullptr)
+            issued = sdkSetCfwPosition0(sdkMainCameraHandle, toSdkCfwPos0(pos), &err);
+    }
+    else if (dpCFW != NULL)
+    {
+        issued = indi_Client->setCFWPosition(dpCFW, pos) == QHYCCD_SUCCESS;
+    }
+
+    // 下发失败就按原流程在转动完成后再设
+    if (!issued)
+    {
+        if (!err.empty())
+            Logger::Log("prefetchScheduleFilter | SDK set CFW failed: " + err, LogLevel::WARNING, DeviceType::MAIN);
+        return;
+    }
+    Logger::Log("prefetchScheduleFilter | CFW -> " + std::to_string(pos) + " during slew", LogLevel::INFO, DeviceType::MAIN);
+    schedule_filterPrefetchIndex = schedule_currentNum;
+    scheduleFilterElapsed.start();
+    scheduleOverhead[schedule_currentNum].begin(schedule::Stage::Filter, 0, scheduleNowMs());
+    emit wsThread->sendMessageToClient(
+        "ScheduleStepState:" +
+        QString::number(schedule_currentNum) + ":" +
+        "filter:" +
+        "0:" +
+        "0:" +
+        "50");
+}
+
+bool MainWindow::scheduleFilterInPosition(int pos)
+{
+    INDI::BaseDevice *dp = NULL;
+    if (isFilterOnCamera)
+    {
+        if (isMainCameraSDK())
+        {
+            int cur0 = -1;
+            // 设备已断开时不再等待，交给后续流程处理
+            if (sdkMainCameraHandle == nullptr)
+                return true;
+            return sdkGetCfwPosition0(sdkMainCameraHandle, cur0) && cur0 == toSdkCfwPos0(pos);
+        }
+        dp = dpMainCamera;
+    }
+    else
+    {
+        dp = dpCFW;
+    }
+    if (dp == NULL)
+        return true;
+
+    // 本地属性值在下发时就已改成目标位，要同时看状态不再是 Busy
+    INDI::PropertyNumber slot = dp->getProperty("FILTER_SLOT");
+    if (!slot.isValid())
+        return true;
+    return static_cast<int>(slot[0].getValue()) == pos && slot.getState() != IPS_BUSY;
+}
+
+void MainWindow::scheduleFrameSaved(int row, int frame, const QString &path)
+{
+    auto tracker = scheduleOverhead.find(row);
+    if (tracker == scheduleOverhead.end())
+        return;
+    tracker->second.end(schedule::Stage::Write, frame, scheduleNowMs());
+
+    solver::PlateSolveService &service = solver::PlateSolveService::instance();
+    if (!path.isEmpty() && service.available() && row < m_scheduList.size() &&
+        qgetenv("QUARCS_SCHEDULE_SOLVE") != "0")
+    {
+        if (scheduleSolveId != 0)
+        {
+            // 上一帧还在解析：跳过本帧而不排队，解析始终只落后一帧
+            tracker->second.noteSkippedSolve();
+        }
+        else
+        {
+            const double targetRaDeg = m_scheduList[row].targetRa * 15.0;
+            const double targetDecDeg = m_scheduList[row].targetDec;
+
+            solver::SolveRequest request;
+            request.imagePath = path.toStdString();
+            request.usePosition = true;
+            request.raDeg = targetRaDeg;
+            request.decDeg = targetDecDeg;
+            request.radiusDeg = 5.0;
+            if (glFocalLength > 0 && glCameraSize_width > 0)
+            {
+                const double fovDeg = 2.0 * std::atan(glCameraSize_width / (2.0 * glFocalLength)) * 180.0 / M_PI;
+                request.scaleLowDeg = fovDeg * 0.8;
+                request.scaleHighDeg = fovDeg * 1.2;
+            }
+            request.timeoutMs = 30000;
+            request.writeWcs = false;
+            request.tag = "schedule";
+
+            tracker->second.begin(schedule::Stage::Solve, frame, scheduleNowMs());
+            scheduleSolveId = service.submit(request, [this, row, frame, targetRaDeg, targetDecDeg](const solver::SolveResult &r) {
+                // 求解线程回调：切回主线程
+                QMetaObject::invokeMethod(this, [this, row, frame, targetRaDeg, targetDecDeg, r]() {
+                    scheduleSolveId = 0;
+                    auto it = scheduleOverhead.find(row);
+                    if (it != scheduleOverhead.end())
+                        it->second.end(schedule::Stage::Solve, frame, scheduleNowMs());
+
+                    const double offsetArcmin = r.solved() ? angularSeparationDeg(r.raDeg, r.decDeg, targetRaDeg, targetDecDeg) * 60.0 : 0.0;
+                    Logger::Log(QString("scheduleFrameSaved | row %1 frame %2 solve %3 in %4 ms, offset %5 arcmin")
+                                    .arg(row).arg(frame)
+                                    .arg(solver::solveStatusName(r.status))
+                                    .arg(r.timing.totalMs, 0, 'f', 0)
+                                    .arg(offsetArcmin, 0, 'f', 1)
+                                    .toStdString(),
+                                LogLevel::INFO, DeviceType::MAIN);
+                    emit wsThread->sendMessageToClient(
+                        "ScheduleFrameSolve:" +
+                        QString::number(row) + ":" +
+                        QString::number(frame) + ":" +
+                        QString::fromLatin1(solver::solveStatusName(r.status)) + ":" +
+                        QString::number(r.raDeg, 'f', 5) + ":" +
+                        QString::number(r.decDeg, 'f', 5) + ":" +
+                        QString::number(offsetArcmin, 'f', 1));
+                    reportScheduleOverhead(row);
+                }, Qt::QueuedConnection);
+            });
+            if (scheduleSolveId == 0)
+                tracker->second.end(schedule::Stage::Solve, frame, scheduleNowMs());
+        }
+    }
+
+    reportScheduleOverhead(row);
+}
+
+void MainWindow::reportScheduleOverhead(int row)
+{
+    auto it = scheduleOverhead.find(row);
+    if (it == scheduleOverhead.end() || !it->second.finished() || !it->second.idle())
+        return;
+
+    const schedule::OverheadTracker::Report r = it->second.report();
+    scheduleOverhead.erase(it);
+
+    QJsonObject stages;
+    for (int i = 0; i < schedule::kStageCount; ++i)
+    {
+        if (r.stageCount[i] == 0)
+            continue;
+        QJsonObject stage;
+        stage["ms"] = static_cast<qint64>(r.stageMs[i]);
+        stage["count"] = r.stageCount[i];
+        stages[schedule::stageName(static_cast<schedule::Stage>(i))] = stage;
+    }
+    QJsonObject payload;
+    payload["row"] = row;
+    payload["target"] = row < m_scheduList.size() ? m_scheduList[row].shootTarget : QString();
+    payload["wallMs"] = static_cast<qint64>(r.wallMs);
+    payload["exposureMs"] = static_cast<qint64>(r.exposureMs);
+    payload["overheadMs"] = static_cast<qint64>(r.overheadMs);
+    payload["idleMs"] = static_cast<qint64>(r.idleMs);
+    payload["sequentialMs"] = static_cast<qint64>(r.sequentialMs);
+    payload["removedMs"] = static_cast<qint64>(r.removedMs);
+    payload["skippedSolves"] = r.skippedSolves;
+    payload["stages"] = stages;
+
+    Logger::Log(QString("ScheduleOverhead | row %1: wall %2 s, exposure %3 s, overhead %4 s, removed by overlap %5 s")
+                    .arg(row)
+                    .arg(r.wallMs / 1000.0, 0, 'f', 1)
+                    .arg(r.exposureMs / 1000.0, 0, 'f', 1)
+                    .arg(r.overheadMs / 1000.0, 0, 'f', 1)
+                    .arg(r.removedMs / 1000.0, 0, 'f', 1)
+                    .toStdString(),
+                LogLevel::INFO, DeviceType::MAIN);
+    emit wsThread->sendMessageToClient("ScheduleOverhead:" + QString::fromUtf8(QJsonDocument(payload).toJson(QJsonDocument::Compact)));
+}
+
 void MainWindow::startExposureDelay()
 {
     qDebug() << "startExposureDelay...";
@@ -603,6 +1040,18 @@ void MainWindow::startExposureDelay()
 void MainWindow::startCapture(int ExpTime)
 {
     qDebug() << "startCapture...";
+    // 背压：后台 FITS 写盘队列已满时推迟下一次曝光，避免存储跟不上时帧在内存里越积越多
+    if (fitsWriter && fitsWriter->saturated())
+    {
+        Logger::Log("startCapture | FITS writer queue full (" + std::to_string(fitsWriter->pending()) +
+                        "), delay next exposure",
+                    LogLevel::INFO, DeviceType::MAIN);
+        QTimer::singleShot(200, this, [this, ExpTime]() {
+            if (isScheduleRunning && !StopSchedule)
+                startCapture(ExpTime);
+        });
+        return;
+    }
     captureTimer.stop();
     captureTimer.disconnect();
     exposureDelayTimer.stop();
@@ -612,6 +1061,7 @@ void MainWindow::startCapture(int ExpTime)
     qDebug() << "ShootStatus: " << ShootStatus;
     startMainCameraCapture(ExpTime);
     schedule_currentShootNum++;
+    scheduleOverhead[schedule_currentNum].begin(schedule::Stage::Exposure, schedule_currentShootNum, scheduleNowMs());
 
     captureTimer.setSingleShot(true);
     expTime_ms = 0;
@@ -630,6 +1080,7 @@ void MainWindow::startCapture(int ExpTime)
         {
             captureTimer.stop();
             qDebug() << "Capture" << schedule_currentShootNum << "Complete!";
+            scheduleOverhead[schedule_currentNum].end(schedule::Stage::Exposure, schedule_currentShootNum, scheduleNowMs());
             ScheduleImageSave(m_scheduList[schedule_currentNum].shootTarget, schedule_currentShootNum);
 
             int currentStep = 3 + schedule_currentShootNum;
@@ -657,7 +1108,12 @@ void MainWindow::startCapture(int ExpTime)
 
             if (schedule_currentShootNum < schedule_RepeatNum)
             {
-                if (schedule_ExposureDelay > 0)
+                if (scheduleMeridianFlipDue())
+                {
+                    // 下一帧会跨过子午线限位：在两帧之间翻转，翻转耗时顶替曝光间隔
+                    startScheduleMeridianFlip();
+                }
+                else if (schedule_ExposureDelay > 0)
                 {
                     startExposureDelay();
                 }
@@ -672,6 +1128,9 @@ void MainWindow::startCapture(int ExpTime)
                 m_scheduList[schedule_currentNum].progress = 100;
                 emit wsThread->sendMessageToClient("UpdateScheduleProcess:" + QString::number(schedule_currentNum) + ":" + QString::number(m_scheduList[schedule_currentNum].progress));
                 qDebug() << "Capture Goto Complete...";
+                // 最后一帧的写盘/解析不挡下一行转动，各自完成后再出本行报告
+                scheduleOverhead[schedule_currentNum].finish(scheduleNowMs());
+                reportScheduleOverhead(schedule_currentNum);
                 nextSchedule();
             }
 
@@ -685,6 +1144,7 @@ void MainWindow::startCapture(int ExpTime)
             {
                 captureTimer.stop();
                 abortMainCameraCapture();
+                scheduleOverhead[schedule_currentNum].end(schedule::Stage::Exposure, schedule_currentShootNum, scheduleNowMs());
                 Logger::Log(QString("计划任务表拍摄超时: 当前拍摄时间 %1ms, 超过最大超时时间 %2ms (曝光时间 %3ms + 1分钟)").arg(expTime_ms).arg(maxTimeout).arg(schedule_ExpTime).toStdString(),
                            LogLevel::WARNING, DeviceType::MAIN);
                 Logger::Log("Capture timeout! expTime_ms:" + std::to_string(expTime_ms) + ", maxTimeout:" + std::to_string(maxTimeout) + ", schedule_ExpTime:" + std::to_string(schedule_ExpTime), LogLevel::WARNING, DeviceType::MAIN);
@@ -705,6 +1165,8 @@ void MainWindow::startCapture(int ExpTime)
                 {
                     schedule_currentShootNum = 0;
                     qDebug() << "All captures completed or timeout, move to next schedule...";
+                    scheduleOverhead[schedule_currentNum].finish(scheduleNowMs());
+                    reportScheduleOverhead(schedule_currentNum);
                     m_scheduList[schedule_currentNum].progress = 100;
                     emit wsThread->sendMessageToClient("UpdateScheduleProcess:" + QString::number(schedule_currentNum) + ":" + QString::number(m_scheduList[schedule_currentNum].progress));
                     emit wsThread->sendMessageToClient(
@@ -746,6 +1208,22 @@ bool MainWindow::WaitForShootToComplete()
     return (ShootStatus != "InProgress");
 }
 
+void MainWindow::onDeviceStateChanged(int role)
+{
+    // 定时器回调本身先判断完成条件，提前触发只在条件已满足时进行，
+    // 否则会把“未完成”分支里按 1s 累计的曝光进度算错
+    if (role == static_cast<int>(devices::DeviceRole::Mount))
+    {
+        if (telescopeTimer.isActive() && dpMount != NULL && WaitForTelescopeToComplete())
+            telescopeTimer.start(0);
+    }
+    else if (role == static_cast<int>(devices::DeviceRole::MainCamera))
+    {
+        if (isScheduleRunning && captureTimer.isActive() && ShootStatus == "Completed")
+            captureTimer.start(0);
+    }
+}
+
 bool MainWindow::WaitForGuidingToComplete()
 {
     Logger::Log("Wait For Guiding To Complete..." + std::to_string(InGuiding), LogLevel::INFO, DeviceType::MAIN);
@@ -835,7 +1313,8 @@ int MainWindow::ScheduleImageSave(QString name, int num)
         resultFileName = QString("%1-%2.fits").arg(name).arg(actualNum);
         destinationPath = dirPath + "/" + resultFileName;
 
-        if (!QFile::exists(destinationPath))
+        if (!QFile::exists(destinationPath) &&
+            !(fitsWriter && fitsWriter->isPendingPath(destinationPath.toStdString())))
         {
             break;
         }
@@ -858,7 +1337,34 @@ int MainWindow::ScheduleImageSave(QString name, int num)
                    LogLevel::INFO, DeviceType::MAIN);
     }
 
+    const int row = schedule_currentNum;
+    scheduleOverhead[row].begin(schedule::Stage::Write, num, scheduleNowMs());
+
+    // SDK 帧仍在内存：带上计划任务的目标信息，后台直接写到计划目录（结果在写完后回报）
+    if (!isUSBSave && lastMainCaptureFrame)
+    {
+        fits::HeaderTemplate header = lastMainCaptureHeader;
+        header.setString("OBJECT", name.toStdString(), "Target name");
+        if (schedule_currentNum >= 0 && schedule_currentNum < m_scheduList.size())
+        {
+            const ScheduleData &target = m_scheduList[schedule_currentNum];
+            header.setDouble("RA", target.targetRa * 15.0, "Target RA [deg]");  // targetRa 以小时存放
+            header.setDouble("DEC", target.targetDec, "Target Dec [deg]");
+            if (!target.shootType.isEmpty())
+                header.setString("IMAGETYP", target.shootType.toStdString(), "Frame type");
+            if (!target.filterNumber.isEmpty())
+                header.setString("FILTER", target.filterNumber.toStdString(), "Filter wheel slot");
+        }
+        header.setLong("SEQNUM", actualNum, "Sequence number");
+        if (submitMainCaptureArchive(destinationPath, "ScheduleImageSave", header,
+                                     [this, row, num](const QString &path) { scheduleFrameSaved(row, num, path); }))
+        {
+            return 0;
+        }
+    }
+
     int saveResult = saveImageFile(sourcePath, destinationPath, "ScheduleImageSave", isUSBSave);
+    scheduleFrameSaved(row, num, saveResult == 0 ? destinationPath : QString());
     if (saveResult != 0)
     {
         return saveResult;
@@ -419,37 +419,20 @@ void MainWindow::sendRoiInfo()
     emit wsThread->sendMessageToClient("SetVisibleArea:" + QString::number(visibleX) + ":" + QString::number(visibleY) + ":" + QString::number(scale));
     emit wsThread->sendMessageToClient("SetSelectStars:" + QString::number(selectStarX) + ":" + QString::number(selectStarY));
 }
-void MainWindow::updateCPUInfo()
+void MainWindow::updateCPUInfo(const telemetry::TelemetrySample &sample, const QString &delta)
 {
-    // 获取CPU温度和使用率
-    QProcess process;
-    // 在树莓派上，可以通过读取 /sys/class/thermal/thermal_zone0/temp 文件来获取 CPU 温度
-    process.start("cat", QStringList() << "/sys/class/thermal/thermal_zone0/temp");
-    process.waitForFinished();
-    QString output = process.readAllStandardOutput();
-    float cpuTemp = output.toFloat() / 1000; // 转换为摄氏度
-    if (process.error() != QProcess::UnknownError)
-    {
-        cpuTemp = std::numeric_limits<float>::quiet_NaN(); // 如果获取失败，设置为 NaN
-    }
+    if (!wsThread)
+        return;
 
-    // 在树莓派上，可以通过运行 'top' 命令并解析输出来获取 CPU 使用率
-    process.start("sh", QStringList() << "-c" << "top -b -n1 | grep 'Cpu(s)' | awk '{print $2}' | cut -c 1-4");
-    process.waitForFinished();
-    output = process.readAllStandardOutput();
-    QStringList cpuUsages = output.split("\n");
-    float cpuUsage = 0;
-    if (cpuUsages.size() > 0)
-    {
-        cpuUsage = cpuUsages[0].toDouble();
-    }
-    if (process.error() != QProcess::UnknownError)
-    {
-        cpuUsage = std::numeric_limits<float>::quiet_NaN(); // 如果获取失败，设置为 NaN
-    }
+    // 旧前端只认温度和整机占用；温度读不到时与原实现一样发 NaN
+    const float cpuTemp = sample.cpuTempC >= 0.0 ? static_cast<float>(sample.cpuTempC)
+                                                 : std::numeric_limits<float>::quiet_NaN();
+    const float cpuUsage = static_cast<float>(sample.cpuPercent);
+    emit wsThread->sendMessageToClient("updateCPUInfo:" + QString::number(cpuTemp) + ":" + QString::number(cpuUsage, 'f', 1));
 
-    // Logger::Log("updateCPUInfo | CPU Temp: " + std::to_string(cpuTemp) + ", CPU Usage: " + std::to_string(cpuUsage), LogLevel::DEBUG, DeviceType::MAIN);
-    emit wsThread->sendMessageToClient("updateCPUInfo:" + QString::number(cpuTemp) + ":" + QString::number(cpuUsage));
+    // 各子系统线程占用、内存、磁盘、网速：只发变化的字段，定期全量
+    if (!delta.isEmpty())
+        emit wsThread->sendMessageToClient("SystemTelemetry:" + delta);
 }
 
 void MainWindow::getMainCameraParameters()
@@ -527,6 +510,13 @@ void MainWindow::getMainCameraParameters()
         if (it.key() == "SaveFailedParse") {
             mainCameraSaveFailedParse = (it.value() == "true");
         }
+        if (it.key() == "UsbExportVerify") {
+            usbExportVerify = (it.value() == "true");
+        }
+        if (it.key() == "FitsCompression") {
+            fitsSaveCompression = QString::fromLatin1(
+                fits::compressionName(fits::compressionFromString(it.value().trimmed().toStdString())));
+        }
         if (it.key() == "Temperature") {
             CameraTemperature = it.value().toDouble();
         }
@@ -614,7 +604,13 @@ void MainWindow::getCheckBoxSpace()
 #endif
     QFileInfo fi(path);
     quint64 freeBytes = 0;
-    if (fi.exists())
+    // 遥测线程每次采样都会 statvfs 应用目录，有缓存就直接用
+    const int64_t cached = telemetryService ? telemetryService->availableBytes(path.toStdString()) : -1;
+    if (cached >= 0)
+    {
+        freeBytes = static_cast<quint64>(cached);
+    }
+    else if (fi.exists())
     {
         QStorageInfo storage(path);
         freeBytes = static_cast<quint64>(storage.bytesAvailable());
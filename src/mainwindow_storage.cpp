@@ -1,5 +1,122 @@
 #include "mainwindow_command_support.h"
 
+#include <QDirIterator>
+#include <sys/mount.h>
+
+#include <mutex>
+#include <set>
+
+bool MainWindow::readCatalogMeta(const std::string &path, storage::ImageMeta *meta)
+{
+    const QString suffix = QFileInfo(QString::fromStdString(path)).suffix().toLower();
+    if (suffix != "fits" && suffix != "fit" && suffix != "fts" && suffix != "fz")
+        return false;
+
+    fitsfile *fptr = nullptr;
+    int status = 0;
+    if (fits_open_image(&fptr, path.c_str(), READONLY, &status))
+        return false;
+
+    char value[FLEN_VALUE];
+    auto readString = [&](const char *key) -> std::string {
+        int st = 0;
+        value[0] = '\0';
+        if (fits_read_key(fptr, TSTRING, key, value, nullptr, &st))
+            return std::string();
+        return QString::fromLatin1(value).trimmed().toStdString();
+    };
+
+    const QString dateObs = QString::fromStdString(readString("DATE-OBS"));
+    if (!dateObs.isEmpty())
+    {
+        QDateTime t = QDateTime::fromString(dateObs, Qt::ISODateWithMs);
+        if (!t.isValid())
+            t = QDateTime::fromString(dateObs, Qt::ISODate);
+        if (t.isValid())
+        {
+            t.setTimeSpec(Qt::UTC); // FITS 约定 DATE-OBS 为 UTC
+            meta->captureTimeMs = t.toMSecsSinceEpoch();
+        }
+    }
+    meta->object = readString("OBJECT");
+    meta->filter = readString("FILTER");
+    meta->imageType = readString("IMAGETYP");
+
+    double exposure = -1.0;
+    int st = 0;
+    if (fits_read_key(fptr, TDOUBLE, "EXPTIME", &exposure, nullptr, &st))
+    {
+        st = 0;
+        if (fits_read_key(fptr, TDOUBLE, "EXPOSURE", &exposure, nullptr, &st))
+            exposure = -1.0;
+    }
+    meta->exposureSec = exposure;
+
+    fits_close_file(fptr, &status);
+    return true;
+}
+
+namespace
+{
+
+// 图库缩略图：从内存帧跨步抽样到约 256 像素宽，按 0.5%/99.5% 分位拉伸成 8 位灰度 JPEG
+std::vector<unsigned char> makeCatalogThumbnail(const SdkFrameData &frame)
+{
+    std::vector<unsigned char> jpeg;
+    if (frame.width <= 0 || frame.height <= 0)
+        return jpeg;
+
+    const int channels = frame.channels > 0 ? static_cast<int>(frame.channels) : 1;
+    const bool fromPixels = !frame.pixels.empty();
+    const bool wide = fromPixels || frame.bpp > 8;
+    const size_t need = static_cast<size_t>(frame.width) * frame.height * channels * (wide ? 2 : 1);
+    if (fromPixels ? frame.pixels.size() * 2 < need : (!frame.rawBuffer || frame.rawBytes < need))
+        return jpeg;
+
+    const int step = std::max(1, (frame.width + 255) / 256);
+    const int tw = frame.width / step;
+    const int th = frame.height / step;
+    if (tw <= 0 || th <= 0)
+        return jpeg;
+
+    const uint16_t *p16 = fromPixels ? frame.pixels.data()
+                                     : reinterpret_cast<const uint16_t *>(frame.rawBuffer->data());
+    const unsigned char *p8 = fromPixels ? nullptr : frame.rawBuffer->data();
+    std::vector<uint16_t> samples(static_cast<size_t>(tw) * th);
+    for (int y = 0; y < th; ++y)
+    {
+        const size_t row = static_cast<size_t>(y) * step * frame.width;
+        for (int x = 0; x < tw; ++x)
+        {
+            const size_t idx = (row + static_cast<size_t>(x) * step) * channels; // 彩色取第一个通道
+            samples[static_cast<size_t>(y) * tw + x] = wide ? p16[idx] : static_cast<uint16_t>(p8[idx] << 8);
+        }
+    }
+
+    std::vector<uint16_t> sorted(samples);
+    const size_t loIdx = sorted.size() / 200;
+    const size_t hiIdx = sorted.size() - 1 - sorted.size() / 200;
+    std::nth_element(sorted.begin(), sorted.begin() + loIdx, sorted.end());
+    const double lo = sorted[loIdx];
+    std::nth_element(sorted.begin(), sorted.begin() + hiIdx, sorted.end());
+    const double hi = std::max(lo + 1.0, static_cast<double>(sorted[hiIdx]));
+
+    cv::Mat thumb(th, tw, CV_8UC1);
+    for (int y = 0; y < th; ++y)
+    {
+        unsigned char *dst = thumb.ptr<unsigned char>(y);
+        for (int x = 0; x < tw; ++x)
+        {
+            const double v = std::min(1.0, std::max(0.0, (samples[static_cast<size_t>(y) * tw + x] - lo) / (hi - lo)));
+            dst[x] = static_cast<unsigned char>(std::sqrt(v) * 255.0 + 0.5); // 开方拉伸，暗部更易看清
+        }
+    }
+    cv::imencode(".jpg", thumb, jpeg, {cv::IMWRITE_JPEG_QUALITY, 80});
+    return jpeg;
+}
+
+} // namespace
+
 int MainWindow::CaptureImageSave()
 {
     Logger::Log("CaptureImageSave...", LogLevel::INFO, DeviceType::MAIN);
@@ -68,14 +185,21 @@ int MainWindow::CaptureImageSave()
         return checkResult;
     }
 
-    // 检查文件是否已存在
-    if (QFile::exists(destinationPath))
+    // 检查文件是否已存在（含后台写盘队列中尚未落盘的同名文件）
+    if (QFile::exists(destinationPath) ||
+        (fitsWriter && fitsWriter->isPendingPath(destinationPath.toStdString())))
     {
         Logger::Log("The file already exists, there is no need to save it again:" + destinationPath.toStdString(), LogLevel::WARNING, DeviceType::MAIN);
         emit wsThread->sendMessageToClient("CaptureImageSaveStatus:Repeat");
         return 0;
     }
 
+    // SDK 帧仍在内存：后台直接写到目标路径，完成后再发送 CaptureImageSaveStatus
+    if (!isUSBSave && submitMainCaptureArchive(destinationPath, "CaptureImageSave", lastMainCaptureHeader))
+    {
+        return 0;
+    }
+
     // 使用通用函数保存文件
     int saveResult = saveImageFile(sourcePath, destinationPath, "CaptureImageSave", isUSBSave);
     if (saveResult != 0)
@@ -326,8 +450,7 @@ int MainWindow::checkStorageSpaceAndCreateDirectory(const QString &sourcePath,
 
         if (storageInfo.isReadOnly())
         {
-            const QString password = "quarcs";
-            if (!remountReadWrite(usb_mount_point, password))
+            if (!remountReadWrite(usb_mount_point))
             {
                 Logger::Log(functionName.toStdString() + " | Failed to remount USB as read-write.", LogLevel::WARNING, DeviceType::MAIN);
                 emit wsThread->sendMessageToClient("CaptureImageSaveStatus:USB-ReadOnly");
@@ -409,17 +532,12 @@ int MainWindow::checkStorageSpaceAndCreateDirectory(const QString &sourcePath,
             return 1;
         }
 
-        const QString password = "quarcs";
-        QProcess mkdirProcess;
-        mkdirProcess.start("sudo", {"-S", "mkdir", "-p", dirPathToCreate});
-        if (!mkdirProcess.waitForStarted() || !mkdirProcess.write((password + "\n").toUtf8()))
+        if (!prepareWritableDirectory(dirPathToCreate, functionName))
         {
             Logger::Log(functionName.toStdString() + " | Failed to create directory: " + dirPathToCreate.toStdString(), LogLevel::WARNING, DeviceType::MAIN);
             emit wsThread->sendMessageToClient("CaptureImageSaveStatus:Failed");
             return 1;
         }
-        mkdirProcess.closeWriteChannel();
-        mkdirProcess.waitForFinished(-1);
     }
     else
     {
@@ -469,26 +587,36 @@ int MainWindow::saveImageFile(const QString &sourcePath,
 {
     if (isUSBSave)
     {
-        // U盘保存使用sudo cp命令
-        const QString password = "quarcs";
-        QProcess cpProcess;
-        cpProcess.start("sudo", {"-S", "cp", sourcePath, destinationPath});
-        if (!cpProcess.waitForStarted() || !cpProcess.write((password + "\n").toUtf8()))
+        // U盘保存：进程内复制（copy_file_range/sendfile + fdatasync），不再每张图起一个 sudo cp
+        storage::CopyOptions options;
+        options.resume = false;
+        options.verify = usbExportVerify;
+        const storage::CopyResult r = storage::copyFile(sourcePath.toStdString(), destinationPath.toStdString(), options);
+        if (!r.ok() && (r.errorCode == EACCES || r.errorCode == EPERM))
         {
-            Logger::Log(functionName.toStdString() + " | Failed to execute sudo cp command.", LogLevel::WARNING, DeviceType::MAIN);
-            emit wsThread->sendMessageToClient("CaptureImageSaveStatus:Failed");
-            return 1;
+            // 目标目录当前用户不可写（例如 root 挂载的 U 盘）：回退到 sudo cp
+            Logger::Log(functionName.toStdString() + " | No write permission (" + r.error + "), fallback to sudo cp", LogLevel::WARNING, DeviceType::MAIN);
+            QString errorOutput;
+            if (!runPrivilegedCommand({"cp", "--preserve=timestamps", sourcePath, destinationPath}, &errorOutput))
+            {
+                Logger::Log(functionName.toStdString() + " | Failed to copy file to USB: " + errorOutput.toStdString(), LogLevel::WARNING, DeviceType::MAIN);
+                emit wsThread->sendMessageToClient("CaptureImageSaveStatus:Failed");
+                return 1;
+            }
         }
-        cpProcess.closeWriteChannel();
-        cpProcess.waitForFinished(-1);
-
-        if (cpProcess.exitCode() != 0)
+        else if (!r.ok())
         {
-            QByteArray stderrOutput = cpProcess.readAllStandardError();
-            Logger::Log(functionName.toStdString() + " | Failed to copy file to USB: " + QString::fromUtf8(stderrOutput).toStdString(), LogLevel::WARNING, DeviceType::MAIN);
+            Logger::Log(functionName.toStdString() + " | Failed to copy file to USB: " + r.error, LogLevel::WARNING, DeviceType::MAIN);
             emit wsThread->sendMessageToClient("CaptureImageSaveStatus:Failed");
             return 1;
         }
+        else
+        {
+            Logger::Log(functionName.toStdString() + " | USB copy " + std::string(r.method) + " " + std::to_string(r.fileBytes) +
+                            " bytes in " + std::to_string(static_cast<int>(r.ms)) + " ms" +
+                            (r.verified ? " (verified)" : ""),
+                        LogLevel::INFO, DeviceType::MAIN);
+        }
 
         Logger::Log(functionName.toStdString() + " | File saved to USB: " + destinationPath.toStdString(), LogLevel::INFO, DeviceType::MAIN);
     }
@@ -613,11 +741,139 @@ int MainWindow::saveImageFile(const QString &sourcePath,
         Logger::Log(functionName.toStdString() + " | File saved successfully to: " + std::string(destinationPathChar) +
                    " | File size: " + std::to_string(std::filesystem::file_size(destPath)) + " bytes",
                    LogLevel::INFO, DeviceType::MAIN);
+        recordCatalogImage(destinationPathChar);
     }
 
     return 0;
 }
 
+fits::HeaderTemplate MainWindow::buildMainCameraFitsHeader(qint64 exposureStartMs, int exposureMs) const
+{
+    fits::HeaderTemplate h;
+
+    const QDateTime startUtc = QDateTime::fromMSecsSinceEpoch(
+        exposureStartMs > 0 ? exposureStartMs : QDateTime::currentMSecsSinceEpoch(), Qt::UTC);
+    h.setString("DATE-OBS", startUtc.toString("yyyy-MM-ddTHH:mm:ss.zzz").toStdString(), "UTC start of exposure");
+    h.setDouble("EXPTIME", exposureMs / 1000.0, "Exposure time [s]");
+
+    if (systemdevicelist.system_devices.size() > DeviceSlot::MainCamera)
+    {
+        const QString camera = systemdevicelist.system_devices[DeviceSlot::MainCamera].DeviceIndiName.trimmed();
+        if (!camera.isEmpty())
+            h.setString("INSTRUME", camera.toStdString(), "Camera");
+    }
+    if (systemdevicelist.system_devices.size() > DeviceSlot::Mount)
+    {
+        const QString mount = systemdevicelist.system_devices[DeviceSlot::Mount].DeviceIndiName.trimmed();
+        if (!mount.isEmpty())
+            h.setString("TELESCOP", mount.toStdString(), "Mount");
+    }
+    if (glFocalLength > 0)
+        h.setDouble("FOCALLEN", glFocalLength, "Focal length [mm]");
+
+    h.setLong("XBINNING", glMainCameraBinning, "Binning factor X");
+    h.setLong("YBINNING", glMainCameraBinning, "Binning factor Y");
+    h.setDouble("GAIN", CameraGain, "Camera gain");
+    h.setLong("OFFSET", glOffsetValue, "Camera offset");
+    h.setDouble("CCD-TEMP", CameraTemperature, "Sensor temperature [C]");
+    if (!MainCameraCFA.isEmpty())
+    {
+        h.setString("BAYERPAT", MainCameraCFA.toStdString(), "Bayer pattern");
+        h.setLong("XBAYROFF", MainCameraCFAOffsetX, "Bayer X offset");
+        h.setLong("YBAYROFF", MainCameraCFAOffsetY, "Bayer Y offset");
+    }
+    if (observatorylatitude != -1 && observatorylongitude != -1)
+    {
+        h.setDouble("SITELAT", observatorylatitude, "Site latitude [deg]");
+        h.setDouble("SITELONG", observatorylongitude, "Site longitude [deg, east+]");
+    }
+    h.setString("SWCREATE", "QUARCS", "Capture software");
+    return h;
+}
+
+bool MainWindow::submitMainCaptureArchive(const QString &destinationPath,
+                                          const QString &functionName,
+                                          const fits::HeaderTemplate &header,
+                                          std::function<void(const QString &path)> onSaved)
+{
+    if (!fitsWriter || !lastMainCaptureFrame)
+        return false;
+
+    // 主线程上不能等队列空位：队列已满就不入队，告诉前端写盘被限流，由调用方回退到 saveImageFile 同步复制
+    if (fitsWriter->saturated())
+    {
+        Logger::Log(functionName.toStdString() + " | FITS writer queue full (" + std::to_string(fitsWriter->pending()) +
+                        "/" + std::to_string(fitsWriter->capacity()) + "), fallback to file copy",
+                    LogLevel::WARNING, DeviceType::MAIN);
+        emit wsThread->sendMessageToClient("FitsWriteThrottled:" + QString::number(static_cast<qulonglong>(fitsWriter->pending())) +
+                                           ":" + QString::number(static_cast<qulonglong>(fitsWriter->capacity())));
+        return false;
+    }
+
+    QString absoluteDestinationPath = destinationPath;
+    if (!QDir::isAbsolutePath(destinationPath))
+        absoluteDestinationPath = QDir::currentPath() + "/" + destinationPath;
+
+    const QString destDir = QFileInfo(absoluteDestinationPath).absolutePath();
+    if (!QDir().mkpath(destDir))
+    {
+        Logger::Log(functionName.toStdString() + " | Failed to create destination directory: " + destDir.toStdString(),
+                    LogLevel::ERROR, DeviceType::MAIN);
+        return false;
+    }
+
+    fits::FitsWriter::Job job;
+    job.frame = lastMainCaptureFrame;
+    job.path = absoluteDestinationPath.toStdString();
+    job.header = header;
+    job.options.compression = fits::compressionFromString(fitsSaveCompression.toStdString());
+    std::shared_ptr<const SdkFrameData> frame = lastMainCaptureFrame;
+    job.onDone = [this, functionName, frame, onSaved](const fits::WriteResult &r) {
+        // 写盘线程里顺手登记图库：帧还在内存，缩略图不必再读回 FITS
+        if (r.success)
+        {
+            const std::vector<unsigned char> thumbnail = makeCatalogThumbnail(*frame);
+            recordCatalogImage(r.path, thumbnail.empty() ? nullptr : &thumbnail);
+        }
+        // 写盘线程回调：切回主线程再碰 wsThread/成员
+        QMetaObject::invokeMethod(this, [this, functionName, r, onSaved]() {
+            if (!r.success)
+            {
+                Logger::Log(functionName.toStdString() + " | Background FITS write failed: " + r.path + " | " + r.error,
+                            LogLevel::ERROR, DeviceType::MAIN);
+                emit wsThread->sendMessageToClient("CaptureImageSaveStatus:Failed");
+                if (onSaved)
+                    onSaved(QString());
+                return;
+            }
+            Logger::Log(functionName.toStdString() + " | File saved successfully: " + r.path,
+                        LogLevel::INFO, DeviceType::MAIN);
+            emit wsThread->sendMessageToClient("CaptureImageSaveStatus:Success");
+            emit wsThread->sendMessageToClient(
+                "FitsWriteTiming:" + QFileInfo(QString::fromStdString(r.path)).fileName() + ":" +
+                QString::number(r.timing.totalMs, 'f', 1) + ":" +
+                QString::number(r.timing.queueMs, 'f', 1) + ":" +
+                QString::number(static_cast<qulonglong>(r.timing.fileBytes)) + ":" +
+                QString::fromLatin1(fits::compressionName(r.compression)));
+            if (onSaved)
+                onSaved(QString::fromStdString(r.path));
+        }, Qt::QueuedConnection);
+    };
+
+    // 不等待（timeoutMs=0）：上面已检查过空位，这里失败只可能是写盘服务已停止
+    if (fitsWriter->submit(std::move(job), 0) == 0)
+    {
+        Logger::Log(functionName.toStdString() + " | FITS writer rejected the job, fallback to file copy",
+                    LogLevel::WARNING, DeviceType::MAIN);
+        return false;
+    }
+    Logger::Log(functionName.toStdString() + " | Queued background FITS write: " + absoluteDestinationPath.toStdString() +
+                    " | compression=" + fitsSaveCompression.toStdString() +
+                    " | pending=" + std::to_string(fitsWriter->pending()),
+                LogLevel::INFO, DeviceType::MAIN);
+    return true;
+}
+
 void MainWindow::DeleteImage(QStringList DelImgPath)
 {
     std::string password = "quarcs"; // sudo 密码
@@ -641,6 +897,8 @@ void MainWindow::DeleteImage(QStringList DelImgPath)
             if (result == 0)
             {
                 Logger::Log("DeleteImage | Deleted file:" + DelImgPath[i].toStdString(), LogLevel::INFO, DeviceType::MAIN);
+                if (imageCatalog)
+                    imageCatalog->removePath(QFileInfo(path).absoluteFilePath().toStdString());
             }
             else
             {
@@ -665,6 +923,22 @@ std::string MainWindow::GetAllFile()
     std::string planString = "ScheduleImage{";
     std::string solveFailedImageString = "SolveFailedImage{";
 
+    // 图库索引已完成首次对账：直接用内存里的文件夹列表，不再遍历目录。
+    // 索引记录每个日期目录的 mtime，空目录同样列出（image_catalog_test 覆盖）；
+    // 与下面直接列目录的差别只在分类根下的散落文件和以 "." 开头的隐藏项，它们本就不是可浏览的日期文件夹
+    if (imageCatalog && imageCatalog->ready())
+    {
+        for (const auto &f : imageCatalog->folders("CaptureImage"))
+            captureString += f.name + ";";
+        for (const auto &f : imageCatalog->folders("ScheduleImage"))
+            planString += f.name + ";";
+        for (const auto &f : imageCatalog->folders("solveFailedImage"))
+            solveFailedImageString += f.name + ";";
+        resultString = captureString + "}:" + planString + "}:" + solveFailedImageString + '}';
+        Logger::Log("GetAllFile finish! (catalog)", LogLevel::INFO, DeviceType::MAIN);
+        return resultString;
+    }
+
     try
     {
         // 检查并处理 CaptureImage 目录
@@ -729,6 +1003,26 @@ void MainWindow::GetImageFiles(std::string ImageFolder)
     std::string basePath = ImageSaveBasePath + "/" + ImageFolder + "/";
     std::string ImageFilesNameString = "";
 
+    // ImageFolder 形如 CaptureImage/2025-01-01：命中图库时按拍摄时间排序返回，不再遍历目录
+    const size_t slash = ImageFolder.find('/');
+    if (imageCatalog && imageCatalog->ready() && slash != std::string::npos && ImageFolder.find('/', slash + 1) == std::string::npos)
+    {
+        storage::CatalogQuery q;
+        q.category = ImageFolder.substr(0, slash);
+        q.folder = ImageFolder.substr(slash + 1);
+        q.newestFirst = false;
+        q.limit = std::numeric_limits<size_t>::max();
+        const storage::CatalogPage page = imageCatalog->query(q);
+        if (page.total > 0)
+        {
+            for (const auto &e : page.entries)
+                ImageFilesNameString += e.name + ";";
+            emit wsThread->sendMessageToClient("ImageFilesName:" + QString::fromStdString(ImageFilesNameString));
+            Logger::Log("GetImageFiles finish! (catalog, " + std::to_string(page.total) + " files)", LogLevel::INFO, DeviceType::MAIN);
+            return;
+        }
+    }
+
     try
     {
         // 检查目录是否存在
@@ -774,6 +1068,95 @@ void MainWindow::GetImageFiles(std::string ImageFolder)
     Logger::Log("GetImageFiles finish!", LogLevel::INFO, DeviceType::MAIN);
 }
 
+void MainWindow::recordCatalogImage(const std::string &path, const std::vector<unsigned char> *thumbnail)
+{
+    if (imageCatalog)
+        imageCatalog->recordFile(path, thumbnail);
+}
+
+void MainWindow::QueryImageCatalog(const QString &queryJson)
+{
+    if (!imageCatalog || !imageCatalog->ready())
+    {
+        // 首次对账尚未完成：前端稍后重试或退回 ShowAllImageFolder/GetImageFiles
+        emit wsThread->sendMessageToClient("ImageCatalogPage:{\"ready\":false}");
+        return;
+    }
+
+    const QJsonObject obj = QJsonDocument::fromJson(queryJson.toUtf8()).object();
+    storage::CatalogQuery q;
+    q.category = obj.value("category").toString().toStdString();
+    q.folder = obj.value("folder").toString().toStdString();
+    q.object = obj.value("object").toString().toStdString();
+    q.filter = obj.value("filter").toString().toStdString();
+    q.minExposureSec = obj.value("minExposure").toDouble(-1.0);
+    q.maxExposureSec = obj.value("maxExposure").toDouble(-1.0);
+    q.fromMs = static_cast<int64_t>(obj.value("from").toDouble(0));
+    q.toMs = static_cast<int64_t>(obj.value("to").toDouble(0));
+    q.newestFirst = obj.value("newestFirst").toBool(true);
+    q.offset = static_cast<size_t>(std::max(0, obj.value("offset").toInt(0)));
+    q.limit = static_cast<size_t>(std::min(1000, std::max(1, obj.value("limit").toInt(100))));
+
+    const storage::CatalogPage page = imageCatalog->query(q);
+    QJsonArray entries;
+    for (const auto &e : page.entries)
+    {
+        QJsonObject item;
+        item["path"] = QString::fromStdString(e.relPath());
+        item["size"] = static_cast<double>(e.size);
+        item["time"] = static_cast<double>(e.meta.captureTimeMs);
+        item["object"] = QString::fromStdString(e.meta.object);
+        item["filter"] = QString::fromStdString(e.meta.filter);
+        item["exposure"] = e.meta.exposureSec;
+        item["type"] = QString::fromStdString(e.meta.imageType);
+        item["thumb"] = e.thumbOffset >= 0;
+        entries.append(item);
+    }
+    QJsonObject payload;
+    payload["ready"] = true;
+    payload["total"] = static_cast<double>(page.total);
+    payload["offset"] = static_cast<double>(q.offset);
+    payload["entries"] = entries;
+    emit wsThread->sendMessageToClient("ImageCatalogPage:" +
+                                       QString::fromUtf8(QJsonDocument(payload).toJson(QJsonDocument::Compact)));
+}
+
+void MainWindow::GetImageCatalogFolders(const QString &category)
+{
+    QJsonArray folders;
+    if (imageCatalog)
+    {
+        for (const auto &f : imageCatalog->folders(category.toStdString()))
+        {
+            QJsonObject item;
+            item["name"] = QString::fromStdString(f.name);
+            item["files"] = static_cast<double>(f.files);
+            item["bytes"] = static_cast<double>(f.bytes);
+            item["latest"] = static_cast<double>(f.latestCaptureMs);
+            folders.append(item);
+        }
+    }
+    QJsonObject payload;
+    payload["category"] = category;
+    payload["ready"] = imageCatalog && imageCatalog->ready();
+    payload["folders"] = folders;
+    emit wsThread->sendMessageToClient("ImageCatalogFolders:" +
+                                       QString::fromUtf8(QJsonDocument(payload).toJson(QJsonDocument::Compact)));
+}
+
+void MainWindow::GetImageThumbnail(const QString &relPath)
+{
+    std::vector<unsigned char> jpeg;
+    if (imageCatalog)
+        imageCatalog->readThumbnail(relPath.toStdString(), &jpeg);
+    QJsonObject payload;
+    payload["path"] = relPath;
+    payload["jpeg"] = QString::fromLatin1(
+        QByteArray(reinterpret_cast<const char *>(jpeg.data()), static_cast<int>(jpeg.size())).toBase64());
+    emit wsThread->sendMessageToClient("ImageThumbnail:" +
+                                       QString::fromUtf8(QJsonDocument(payload).toJson(QJsonDocument::Compact)));
+}
+
 QStringList MainWindow::parseString(const std::string &input, const std::string &imgFilePath)
 {
     QStringList paths;
@@ -856,23 +1239,100 @@ bool MainWindow::isMountReadOnly(const QString &mountPoint)
     return (fsinfo.f_flag & ST_RDONLY) != 0;
 }
 
-bool MainWindow::remountReadWrite(const QString &mountPoint, const QString &password)
+bool MainWindow::remountReadWrite(const QString &mountPoint)
 {
+    // 有 CAP_SYS_ADMIN（以 root 运行）时直接 remount，否则走 sudo mount。
+    // MS_REMOUNT 会用传入的标志整体替换每挂载点选项，必须把 statvfs 读到的 nosuid/nodev/... 带上，只清掉只读
+    const QByteArray mountPointBytes = mountPoint.toUtf8();
+    struct statvfs fsinfo;
+    if (::geteuid() == 0 && ::statvfs(mountPointBytes.constData(), &fsinfo) == 0)
+    {
+        unsigned long flags = MS_REMOUNT;
+        if (fsinfo.f_flag & ST_NOSUID)
+            flags |= MS_NOSUID;
+        if (fsinfo.f_flag & ST_NODEV)
+            flags |= MS_NODEV;
+        if (fsinfo.f_flag & ST_NOEXEC)
+            flags |= MS_NOEXEC;
+        if (fsinfo.f_flag & ST_SYNCHRONOUS)
+            flags |= MS_SYNCHRONOUS;
+        if (fsinfo.f_flag & ST_MANDLOCK)
+            flags |= MS_MANDLOCK;
+        if (fsinfo.f_flag & ST_NOATIME)
+            flags |= MS_NOATIME;
+        if (fsinfo.f_flag & ST_NODIRATIME)
+            flags |= MS_NODIRATIME;
+        if (fsinfo.f_flag & ST_RELATIME)
+            flags |= MS_RELATIME;
+        if (::mount(nullptr, mountPointBytes.constData(), nullptr, flags, nullptr) == 0)
+            return true;
+    }
+
+    QString errorOutput;
+    if (!runPrivilegedCommand({"mount", "-o", "remount,rw", mountPoint}, &errorOutput))
+    {
+        Logger::Log("remountReadWrite | Failed to execute command: sudo mount | " + errorOutput.toStdString(), LogLevel::WARNING, DeviceType::MAIN);
+        emit wsThread->sendMessageToClient("getUSBFail:Failed to execute command: sudo mount -o remount,rw usb.");
+        return false;
+    }
+    return true;
+}
+
+bool MainWindow::runPrivilegedCommand(const QStringList &args, QString *errorOutput)
+{
+    const QString password = "quarcs"; // sudo 密码
     QProcess process;
-    process.start("sudo", {"-S", "mount", "-o", "remount,rw", mountPoint});
+    process.start("sudo", QStringList{"-S"} + args);
     if (!process.waitForStarted() || !process.write((password + "\n").toUtf8()))
     {
-        Logger::Log("remountReadWrite | Failed to execute command: sudo mount", LogLevel::WARNING, DeviceType::MAIN);
-        emit wsThread->sendMessageToClient("getUSBFail:Failed to execute command: sudo mount -o remount,rw usb.");
+        if (errorOutput)
+            *errorOutput = "failed to start sudo " + args.join(' ');
         return false;
     }
     process.closeWriteChannel();
     process.waitForFinished(-1);
-    return process.exitCode() == 0;
+    if (process.exitStatus() != QProcess::NormalExit || process.exitCode() != 0)
+    {
+        if (errorOutput)
+            *errorOutput = QString::fromUtf8(process.readAllStandardError()).trimmed();
+        return false;
+    }
+    return true;
+}
+
+bool MainWindow::prepareWritableDirectory(const QString &dirPath, const QString &functionName)
+{
+    const QString absDir = QDir(dirPath).absolutePath();
+    const QByteArray absDirBytes = absDir.toUtf8();
+    if (QDir().mkpath(absDir) && ::access(absDirBytes.constData(), W_OK) == 0)
+        return true;
+
+    // 旧版本用 sudo mkdir/cp 建的目录属主为 root，或 U 盘以 root 挂载：提权建目录并改属主一次，
+    // 之后该目录下的复制都在进程内完成。vfat/exfat 不支持 chown，此时目录仍由 root 持有，复制失败时逐个回退 sudo cp
+    Logger::Log(functionName.toStdString() + " | Directory not writable in-process, preparing with sudo: " + absDir.toStdString(), LogLevel::INFO, DeviceType::MAIN);
+    QString errorOutput;
+    if (!runPrivilegedCommand({"mkdir", "-p", absDir}, &errorOutput))
+    {
+        Logger::Log(functionName.toStdString() + " | sudo mkdir failed: " + errorOutput.toStdString(), LogLevel::WARNING, DeviceType::MAIN);
+        return false;
+    }
+    const QString owner = QString("%1:%2").arg(::getuid()).arg(::getgid());
+    if (!runPrivilegedCommand({"chown", "-R", owner, absDir}, &errorOutput))
+    {
+        Logger::Log(functionName.toStdString() + " | sudo chown failed (copies will fall back to sudo cp): " + errorOutput.toStdString(), LogLevel::INFO, DeviceType::MAIN);
+    }
+    return QFileInfo(absDir).isDir();
 }
 
 void MainWindow::CopyImagesToUsb(QStringList CopyImgPath, QString usbName)
 {
+    if (exportEngine && usbExportBatchId != 0 && exportEngine->isActive(usbExportBatchId))
+    {
+        Logger::Log("CopyImagesToUsb | A USB export is already in progress.", LogLevel::WARNING, DeviceType::MAIN);
+        emit wsThread->sendMessageToClient("getUSBFail:USB export is already in progress!");
+        return;
+    }
+
     QString usb_mount_point = "";
 
     // 如果提供了U盘名，优先使用它从映射表中查找
@@ -963,15 +1423,13 @@ void MainWindow::CopyImagesToUsb(QStringList CopyImgPath, QString usbName)
         }
     }
 
-    const QString password = "quarcs"; // sudo 密码
-
     QStorageInfo storageInfo(usb_mount_point);
     if (storageInfo.isValid() && storageInfo.isReady())
     {
         if (storageInfo.isReadOnly())
         {
             // 处理1: 该路径为只读设备
-            if (!remountReadWrite(usb_mount_point, password))
+            if (!remountReadWrite(usb_mount_point))
             {
                 Logger::Log("CopyImagesToUsb | Failed to remount filesystem as read-write.", LogLevel::WARNING, DeviceType::MAIN);
                 return;
@@ -1020,6 +1478,7 @@ void MainWindow::CopyImagesToUsb(QStringList CopyImgPath, QString usbName)
         basePath.chop(1);
 
     int sumMoveImage = 0;
+    std::vector<storage::ExportItem> items;
     for (const auto &imgPath : CopyImgPath)
     {
         if (!imgPath.startsWith(basePath))
@@ -1083,45 +1542,196 @@ void MainWindow::CopyImagesToUsb(QStringList CopyImgPath, QString usbName)
             continue;
         }
 
-        QProcess process;
-        process.start("sudo", {"-S", "mkdir", "-p", destinationPath});
-        if (!process.waitForStarted() || !process.write((password + "\n").toUtf8()))
+        // 目录（旧版 cp -r 语义）展开为其中的文件，保持相对结构
+        QFileInfo imgInfo(imgPath);
+        if (imgInfo.isDir())
         {
-            Logger::Log("CopyImagesToUsb | Failed to execute command: sudo mkdir.", LogLevel::WARNING, DeviceType::MAIN);
-            emit wsThread->sendMessageToClient("HasMoveImgnNUmber:fail:" + QString::number(sumMoveImage));
-            continue;
+            const QString dirRoot = destinationPath + imgInfo.fileName() + "/";
+            QDirIterator it(imgPath, QDir::Files | QDir::NoDotAndDotDot, QDirIterator::Subdirectories);
+            while (it.hasNext())
+            {
+                const QString file = it.next();
+                const QString rel = QDir(imgPath).relativeFilePath(file);
+                items.push_back({file.toStdString(), (dirRoot + rel).toStdString()});
+            }
         }
-        process.closeWriteChannel();
-        process.waitForFinished(-1);
-
-        process.start("sudo", {"-S", "cp", "-r", imgPath, destinationPath});
-        if (!process.waitForStarted() || !process.write((password + "\n").toUtf8()))
+        else
         {
-            Logger::Log("CopyImagesToUsb | Failed to execute command: sudo cp.", LogLevel::WARNING, DeviceType::MAIN);
-            emit wsThread->sendMessageToClient("HasMoveImgnNUmber:fail:" + QString::number(sumMoveImage));
-            continue;
+            items.push_back({imgPath.toStdString(), (destinationPath + imgInfo.fileName()).toStdString()});
         }
-        process.closeWriteChannel();
-        process.waitForFinished(-1);
+    }
+
+    if (items.empty())
+    {
+        Logger::Log("CopyImagesToUsb | No valid files to export.", LogLevel::WARNING, DeviceType::MAIN);
+        emit wsThread->sendMessageToClient("getUSBFail:No valid files to move!");
+        return;
+    }
+
+    if (!prepareWritableDirectory(folderPath, "CopyImagesToUsb"))
+    {
+        emit wsThread->sendMessageToClient("getUSBFail:Failed to create folder on USB drive!");
+        return;
+    }
 
-        // Read the standard error output
-        QByteArray stderrOutput = process.readAllStandardError();
+    submitUsbExport(std::move(items), "CopyImagesToUsb");
+}
+
+bool MainWindow::submitUsbExport(std::vector<storage::ExportItem> items, const QString &functionName)
+{
+    if (!exportEngine || items.empty())
+        return false;
 
-        if (process.exitCode() == 0)
+    storage::CopyOptions options;
+    options.verify = usbExportVerify;
+
+    storage::FileExportEngine::Callbacks callbacks;
+    // 回调在导出线程：统一切回主线程再碰 wsThread/成员
+    callbacks.onFileDone = [this, functionName](const storage::ExportFileEvent &ev) {
+        QMetaObject::invokeMethod(this, [this, functionName, ev]() {
+            const storage::CopyResult &r = ev.result;
+            if (r.outcome == storage::CopyOutcome::Cancelled)
+                return; // 取消由 UsbExportFinished 统一回报
+            const QString src = QString::fromStdString(ev.item.source);
+            const QString dst = QString::fromStdString(ev.item.destination);
+            if (!r.ok())
+            {
+                Logger::Log(functionName.toStdString() + " | Error: " + r.error, LogLevel::WARNING, DeviceType::MAIN);
+                Logger::Log(functionName.toStdString() + " | Failed to copy file: " + src.toStdString() + " to " + dst.toStdString(), LogLevel::WARNING, DeviceType::MAIN);
+                emit wsThread->sendMessageToClient("HasMoveImgnNUmber:fail:" + QString::number(usbExportSucceeded));
+                return;
+            }
+            Logger::Log(functionName.toStdString() + " | Copied file: " + src.toStdString() + " to " + dst.toStdString() +
+                            " | " + storage::copyOutcomeName(r.outcome) + " " + r.method +
+                            " " + std::to_string(static_cast<int>(r.ms)) + " ms" + (r.verified ? " verified" : ""),
+                        LogLevel::INFO, DeviceType::MAIN);
+            usbExportSucceeded++;
+            emit wsThread->sendMessageToClient("HasMoveImgnNUmber:succeed:" + QString::number(usbExportSucceeded));
+        }, Qt::QueuedConnection);
+    };
+    // 目录属主为 root 且无法 chown（vfat/exfat 以 root 挂载）：在导出线程回退到 sudo cp，不占主线程。
+    // 同一目录只 sudo mkdir 一次（per-device 并发为 1，但不同设备的工作线程可能同时进来，集合加锁）
+    auto createdDirs = std::make_shared<std::pair<std::mutex, std::set<QString>>>();
+    callbacks.onPermissionDenied = [functionName, createdDirs](const storage::ExportItem &item, std::string *error) {
+        const QString src = QString::fromStdString(item.source);
+        const QString dst = QString::fromStdString(item.destination);
+        const QString dstDir = QFileInfo(dst).absolutePath();
+        Logger::Log(functionName.toStdString() + " | No write permission, fallback to sudo cp: " + item.destination,
+                    LogLevel::WARNING, DeviceType::MAIN);
+        QString errorOutput;
+        bool dirReady;
         {
-            Logger::Log("CopyImagesToUsb | Copied file: " + imgPath.toStdString() + " to " + destinationPath.toStdString(), LogLevel::INFO, DeviceType::MAIN);
+            std::lock_guard<std::mutex> lock(createdDirs->first);
+            dirReady = createdDirs->second.count(dstDir) > 0;
         }
-        else
+        if (!dirReady)
         {
-            Logger::Log("CopyImagesToUsb | Failed to copy file: " + imgPath.toStdString() + " to " + destinationPath.toStdString(), LogLevel::WARNING, DeviceType::MAIN);
-            // Print the error reason
-            Logger::Log("CopyImagesToUsb | Error: " + QString::fromUtf8(stderrOutput).toStdString(), LogLevel::WARNING, DeviceType::MAIN);
-            emit wsThread->sendMessageToClient("HasMoveImgnNUmber:fail:" + QString::number(sumMoveImage));
-            continue;
+            if (!runPrivilegedCommand({"mkdir", "-p", dstDir}, &errorOutput))
+            {
+                *error = "sudo mkdir: " + errorOutput.toStdString();
+                return false;
+            }
+            std::lock_guard<std::mutex> lock(createdDirs->first);
+            createdDirs->second.insert(dstDir);
+        }
+        if (!runPrivilegedCommand({"cp", "--preserve=timestamps", src, dst}, &errorOutput))
+        {
+            *error = "sudo cp: " + errorOutput.toStdString();
+            return false;
         }
-        sumMoveImage++;
-        emit wsThread->sendMessageToClient("HasMoveImgnNUmber:succeed:" + QString::number(sumMoveImage));
+        return true;
+    };
+    // UsbExportProgress:<batch>:<filesDone>:<filesTotal>:<bytesDone>:<bytesTotal>:<MB/s>:<etaSec(-1 未知)>
+    callbacks.onProgress = [this](const storage::ExportProgress &p) {
+        QMetaObject::invokeMethod(this, [this, p]() {
+            emit wsThread->sendMessageToClient(
+                "UsbExportProgress:" + QString::number(static_cast<qulonglong>(p.batchId)) + ":" +
+                QString::number(static_cast<qulonglong>(p.filesDone)) + ":" +
+                QString::number(static_cast<qulonglong>(p.filesTotal)) + ":" +
+                QString::number(static_cast<qulonglong>(p.bytesDone)) + ":" +
+                QString::number(static_cast<qulonglong>(p.bytesTotal)) + ":" +
+                QString::number(p.bytesPerSec / (1024.0 * 1024.0), 'f', 2) + ":" +
+                QString::number(p.etaSec < 0 ? -1 : static_cast<int>(std::ceil(p.etaSec))));
+        }, Qt::QueuedConnection);
+    };
+    // UsbExportFinished:<batch>:<filesDone>:<filesFailed>:<filesSkipped>:<cancelled 0/1>:<elapsedSec>
+    callbacks.onFinished = [this, functionName](const storage::ExportProgress &p) {
+        QMetaObject::invokeMethod(this, [this, functionName, p]() {
+            Logger::Log(functionName.toStdString() + " | Export finished: " + std::to_string(p.filesDone) + "/" + std::to_string(p.filesTotal) +
+                            " files (skipped " + std::to_string(p.filesSkipped) + ", failed " + std::to_string(p.filesFailed) + ")" +
+                            (p.cancelled ? " cancelled" : "") + " in " + std::to_string(static_cast<int>(p.elapsedSec)) + " s",
+                        LogLevel::INFO, DeviceType::MAIN);
+            emit wsThread->sendMessageToClient(
+                "UsbExportFinished:" + QString::number(static_cast<qulonglong>(p.batchId)) + ":" +
+                QString::number(static_cast<qulonglong>(p.filesDone)) + ":" +
+                QString::number(static_cast<qulonglong>(p.filesFailed)) + ":" +
+                QString::number(static_cast<qulonglong>(p.filesSkipped)) + ":" +
+                QString(p.cancelled ? "1" : "0") + ":" +
+                QString::number(p.elapsedSec, 'f', 1));
+        }, Qt::QueuedConnection);
+    };
+
+    const size_t fileCount = items.size();
+    usbExportSucceeded = 0;
+    const uint64_t batchId = exportEngine->submit(std::move(items), options, std::move(callbacks), 500);
+    if (batchId == 0)
+    {
+        Logger::Log(functionName.toStdString() + " | Export engine unavailable.", LogLevel::WARNING, DeviceType::MAIN);
+        emit wsThread->sendMessageToClient("getUSBFail:USB export is unavailable!");
+        return false;
+    }
+    usbExportBatchId = batchId;
+    Logger::Log(functionName.toStdString() + " | Export batch " + std::to_string(batchId) + " queued: " + std::to_string(fileCount) +
+                    " files, verify=" + std::string(usbExportVerify ? "true" : "false"),
+                LogLevel::INFO, DeviceType::MAIN);
+    return true;
+}
+
+void MainWindow::CancelUsbExport()
+{
+    if (!exportEngine || usbExportBatchId == 0 || !exportEngine->isActive(usbExportBatchId))
+    {
+        Logger::Log("CancelUsbExport | No USB export in progress.", LogLevel::INFO, DeviceType::MAIN);
+        return;
+    }
+    exportEngine->cancel(usbExportBatchId);
+    Logger::Log("CancelUsbExport | Cancel requested for batch " + std::to_string(usbExportBatchId), LogLevel::INFO, DeviceType::MAIN);
+}
+
+void MainWindow::ResumeUsbExport()
+{
+    if (!exportEngine || usbExportBatchId == 0)
+    {
+        emit wsThread->sendMessageToClient("getUSBFail:No USB export to resume!");
+        return;
+    }
+    if (exportEngine->isActive(usbExportBatchId))
+    {
+        Logger::Log("ResumeUsbExport | Export batch " + std::to_string(usbExportBatchId) + " is still running.", LogLevel::INFO, DeviceType::MAIN);
+        return;
     }
+
+    std::vector<storage::ExportItem> items = exportEngine->unfinishedItems(usbExportBatchId);
+    if (items.empty())
+    {
+        Logger::Log("ResumeUsbExport | Nothing left to export.", LogLevel::INFO, DeviceType::MAIN);
+        emit wsThread->sendMessageToClient("getUSBFail:No USB export to resume!");
+        return;
+    }
+
+    // U 盘可能在中断期间被拔掉：取目标路径上最近的已存在目录判断所在设备
+    QDir existingDir = QFileInfo(QString::fromStdString(items.front().destination)).absoluteDir();
+    while (!existingDir.exists() && !existingDir.isRoot())
+        existingDir.setPath(QFileInfo(existingDir.absolutePath()).absolutePath());
+    QStorageInfo storageInfo(existingDir.absolutePath());
+    if (!storageInfo.isValid() || !storageInfo.isReady() || !storageInfo.rootPath().startsWith("/media/"))
+    {
+        Logger::Log("ResumeUsbExport | USB drive is not available: " + items.front().destination, LogLevel::WARNING, DeviceType::MAIN);
+        emit wsThread->sendMessageToClient("getUSBFail:USB drive is not available!");
+        return;
+    }
+
+    submitUsbExport(std::move(items), "ResumeUsbExport");
 }
 
 void MainWindow::USBCheck()
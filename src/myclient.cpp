@@ -2,6 +2,7 @@
 
 #include <algorithm>
 #include <atomic>
+#include <cstdio>
 #include <cstring>
 #include <fstream>
 #include <iostream>
@@ -13,6 +14,8 @@
 
 #include <fitsio.h>
 #include "tools.h"
+#include "devices/DeviceStateBus.h"
+#include "fits/FitsMemoryReader.h"
 
 // #include "/usr/include/libindi/indiccd.h"
 #include "QThread"
@@ -52,6 +55,9 @@ void MyClient::newProperty(INDI::Property property)
 
     // qDebug() << "newProperty: " << property->getName();
     // qDebug("Recveing message from Server %s", baseDevice.messageQueue(messageID).c_str());
+
+    // 设备刚连上时的初值也进总线，等待方不必先轮询一次
+    publishDeviceState(property);
 }
 
 void MyClient::newDevice(INDI::BaseDevice baseDevice)
@@ -69,26 +75,16 @@ void MyClient::newDevice(INDI::BaseDevice baseDevice)
 
 void MyClient::updateProperty(INDI::Property property)
 {
+    publishDeviceState(property);
+
     if (property.getType() == INDI_BLOB)
     {
-        // CaptureTestTime = CaptureTestTimer.elapsed();
-        // qDebug() << "\033[32m" << "Exposure completed:" << CaptureTestTime << "milliseconds" << "\033[0m";
-        // qInfo() << "Exposure completed:" << CaptureTestTime << "milliseconds";
-        // CaptureTestTimer.invalidate();
-
-        // qInfo("Recveing image from Server size len name label format %d %d %s %s %s", property.getBLOB()->bp->size,property.getBLOB()->bp->bloblen,property.getBLOB()->bp->name,property.getBLOB()->bp->label,property.getBLOB()->bp->format);
-
-        // std::ofstream myfile;
-        // std::string filename="/dev/shm/ccd_simulator.fits";
-        // myfile.open(filename, std::ios::out | std::ios::binary);
-        // myfile.write(static_cast<char *>(property.getBLOB()->bp->blob), property.getBLOB()->bp->bloblen);
-        // myfile.close();
-
-        // QString devname_;
-        // Tools::readFitsHeadForDevName(filename,devname_);
-        // std::string devname = devname_.toStdString();
-
-        // receiveImage(filename, devname);
+        // UPLOAD_MODE=client 时图像以 BLOB 到达：内存解码后直接交给回调，不经驱动写盘/客户端回读
+        const std::string devname = property.getDeviceName() ? std::string(property.getDeviceName()) : std::string();
+        if (blobIngestionEnabled(devname))
+        {
+            ingestBlob(property);
+        }
     }
     else if (property.getType() == INDI_TEXT)
     {
@@ -122,6 +118,11 @@ void MyClient::updateProperty(INDI::Property property)
             }
 
             receiveImage(filePathStr, devname);
+            // 回调里已更新 ShootStatus 等，之后再通知总线，等待方醒来时看到的是完整状态
+            devices::DeviceStateBus::instance().update(devname, [&](devices::DeviceState &state) {
+                ++state.camera.imageSeq;
+                state.camera.lastImagePath = filePathStr;
+            });
             Logger::Log("indi_client | updateProperty | receiveImage | property=" +
                             propertyName +
                             " file=" + filePathStr + " dev=" + devname,
@@ -133,6 +134,266 @@ void MyClient::updateProperty(INDI::Property property)
     }
 }
 
+void MyClient::setBlobIngestion(const std::string &deviceName, const std::string &mirrorPath)
+{
+    std::lock_guard<std::mutex> lock(blobMutex);
+    if (mirrorPath.empty())
+    {
+        blobMirrorPaths.erase(deviceName);
+        pendingBlobFrames.erase(deviceName);
+    }
+    else
+    {
+        blobMirrorPaths[deviceName] = mirrorPath;
+    }
+}
+
+bool MyClient::blobIngestionEnabled(const std::string &deviceName) const
+{
+    std::lock_guard<std::mutex> lock(blobMutex);
+    return blobMirrorPaths.find(deviceName) != blobMirrorPaths.end();
+}
+
+std::shared_ptr<SdkFrameData> MyClient::takeBlobFrame(const std::string &deviceName, fits::HeaderTemplate *header)
+{
+    std::lock_guard<std::mutex> lock(blobMutex);
+    auto it = pendingBlobFrames.find(deviceName);
+    if (it == pendingBlobFrames.end())
+        return nullptr;
+    std::shared_ptr<SdkFrameData> frame = std::move(it->second.frame);
+    if (header != nullptr)
+        *header = std::move(it->second.header);
+    pendingBlobFrames.erase(it);
+    return frame;
+}
+
+void MyClient::ingestBlob(INDI::Property property)
+{
+    const std::string devname = property.getDeviceName() ? std::string(property.getDeviceName()) : std::string();
+    std::string mirrorPath;
+    {
+        std::lock_guard<std::mutex> lock(blobMutex);
+        auto it = blobMirrorPaths.find(devname);
+        if (it == blobMirrorPaths.end())
+            return;
+        mirrorPath = it->second;
+    }
+
+    INDI::PropertyBlob blob(property);
+    for (auto &element : blob)
+    {
+        const void *data = element.getBlob();
+        const size_t size = static_cast<size_t>(element.getBlobLen());
+        if (data == nullptr || size == 0)
+            continue;
+        const std::string format = element.getFormat() ? std::string(element.getFormat()) : std::string();
+        if (format.find(".fit") == std::string::npos)
+        {
+            Logger::Log("indi_client | ingestBlob | skip non-FITS blob format=" + format + " dev=" + devname,
+                        LogLevel::DEBUG, DeviceType::CAMERA);
+            continue;
+        }
+
+        CaptureTestTime = CaptureTestTimer.elapsed();
+        CaptureTestTimer.invalidate();
+
+        // 镜像文件：tmpfs 上一次顺序写，先写临时文件再 rename，读方不会看到半截文件
+        const std::string tmpPath = mirrorPath + ".part";
+        bool mirrored = false;
+        {
+            std::ofstream out(tmpPath, std::ios::out | std::ios::binary | std::ios::trunc);
+            out.write(static_cast<const char *>(data), static_cast<std::streamsize>(size));
+            out.close();
+            mirrored = out.good() && std::rename(tmpPath.c_str(), mirrorPath.c_str()) == 0;
+        }
+        if (!mirrored)
+        {
+            Logger::Log("indi_client | ingestBlob | failed to write mirror file " + mirrorPath,
+                        LogLevel::WARNING, DeviceType::CAMERA);
+        }
+
+        // 内存解码；失败（浮点/彩色 NAXIS=3 等）时不留帧，回调方按镜像文件走原有读取路径
+        auto frame = std::make_shared<SdkFrameData>();
+        fits::HeaderTemplate header;
+        std::string error;
+        const bool decoded = fits::readFitsFromMemory(data, size, *frame, &header, &error);
+        {
+            std::lock_guard<std::mutex> lock(blobMutex);
+            if (decoded)
+                pendingBlobFrames[devname] = BlobFrame{frame, std::move(header)};
+            else
+                pendingBlobFrames.erase(devname);
+        }
+        if (!decoded)
+        {
+            Logger::Log("indi_client | ingestBlob | in-memory decode failed, fall back to file: " + error,
+                        LogLevel::WARNING, DeviceType::CAMERA);
+        }
+        Logger::Log("indi_client | ingestBlob | dev=" + devname + " bytes=" + std::to_string(size) +
+                        " decoded=" + (decoded ? std::string("true") : std::string("false")) +
+                        " exposure=" + std::to_string(CaptureTestTime) + "ms",
+                    LogLevel::DEBUG, DeviceType::CAMERA);
+
+        if (!mirrored && !decoded)
+            continue;
+
+        receiveImage(mirrorPath, devname);
+        // 回调未取走的帧不留到下一张
+        takeBlobFrame(devname);
+        devices::DeviceStateBus::instance().update(devname, [&](devices::DeviceState &state) {
+            ++state.camera.imageSeq;
+            state.camera.lastImagePath = mirrorPath;
+        });
+        // 一个 CCD1 属性只带一帧
+        break;
+    }
+}
+
+namespace
+{
+devices::PropState toPropState(IPState state)
+{
+    switch (state)
+    {
+    case IPS_IDLE:  return devices::PropState::Idle;
+    case IPS_OK:    return devices::PropState::Ok;
+    case IPS_BUSY:  return devices::PropState::Busy;
+    case IPS_ALERT: return devices::PropState::Alert;
+    default:        return devices::PropState::Unknown;
+    }
+}
+}
+
+void MyClient::publishDeviceState(INDI::Property property)
+{
+    const char *rawName = property.getName();
+    const char *rawDevice = property.getDeviceName();
+    if (rawName == nullptr || rawDevice == nullptr)
+        return;
+    const std::string name(rawName);
+    const std::string device(rawDevice);
+    const devices::PropState state = toPropState(property.getState());
+    devices::DeviceStateBus &bus = devices::DeviceStateBus::instance();
+    using devices::PropertySnapshot;
+
+    if (property.getType() == INDI_NUMBER)
+    {
+        INDI::PropertyNumber number(property);
+        if (name == "EQUATORIAL_EOD_COORD" && number.count() >= 2)
+        {
+            const double ra = number[0].getValue();
+            const double dec = number[1].getValue();
+            const int slot = propertySnapshots.slotFor(device);
+            propertySnapshots.set(slot, &PropertySnapshot::eqCoord, devices::EqCoord{ra, dec});
+            propertySnapshots.set(slot, &PropertySnapshot::eqBusy, state == devices::PropState::Busy);
+            // 与 getTelescopeMoving 同口径，getTelescopeStatus 不必等下一次定时轮询；
+            // 先于总线通知更新，被唤醒的等待方读到的已是新状态
+            if (bus.deviceForRole(devices::DeviceRole::Mount) == device)
+                mountState.isMoving = (state == devices::PropState::Busy);
+            bus.update(device, [&](devices::DeviceState &s) {
+                s.mount.hasCoord = true;
+                s.mount.raHours = ra;
+                s.mount.decDeg = dec;
+                s.mount.eqState = state;
+            });
+        }
+        else if (name == "CCD_EXPOSURE" && number.count() >= 1)
+        {
+            const double left = number[0].getValue();
+            bus.update(device, [&](devices::DeviceState &s) {
+                s.camera.exposureState = state;
+                s.camera.exposureLeftSec = left;
+            });
+        }
+        else if (name == "CCD_TEMPERATURE" && number.count() >= 1)
+        {
+            propertySnapshots.set(propertySnapshots.slotFor(device), &PropertySnapshot::ccdTemperature,
+                                  number[0].getValue());
+        }
+        else if (name == "ABS_FOCUS_POSITION" && number.count() >= 1)
+        {
+            const int position = static_cast<int>(number[0].getValue());
+            propertySnapshots.set(propertySnapshots.slotFor(device), &PropertySnapshot::focusPosition, position);
+            bus.update(device, [&](devices::DeviceState &s) {
+                s.focuser.hasPosition = true;
+                s.focuser.position = position;
+                s.focuser.state = state;
+            });
+        }
+    }
+    else if (property.getType() == INDI_SWITCH)
+    {
+        INDI::PropertySwitch sw(property);
+        if (sw.count() < 2)
+            return;
+        const bool first = sw[0].getState() == ISS_ON;
+        const bool second = sw[1].getState() == ISS_ON;
+        if (name == "TELESCOPE_MOTION_NS")
+            bus.update(device, [&](devices::DeviceState &s) { s.mount.motionNS = (first || second) ? devices::PropState::Busy : state; });
+        else if (name == "TELESCOPE_MOTION_WE")
+            bus.update(device, [&](devices::DeviceState &s) { s.mount.motionWE = (first || second) ? devices::PropState::Busy : state; });
+        else if (name == "TELESCOPE_PARK")
+        {
+            // 两项都未选中时与 getTelescopePark 一样不更新
+            if (first || second)
+                propertySnapshots.set(propertySnapshots.slotFor(device), &PropertySnapshot::parked, first);
+            bus.update(device, [&](devices::DeviceState &s) { s.mount.parked = first; });
+        }
+        else if (name == "TELESCOPE_TRACK_STATE")
+        {
+            if (first || second)
+                propertySnapshots.set(propertySnapshots.slotFor(device), &PropertySnapshot::tracking, first);
+            bus.update(device, [&](devices::DeviceState &s) { s.mount.tracking = first; });
+        }
+        else if (name == "TELESCOPE_PIER_SIDE")
+        {
+            const int side = first ? 0 : (second ? 1 : -1);
+            propertySnapshots.set(propertySnapshots.slotFor(device), &PropertySnapshot::pierSide, side);
+            bus.update(device, [&](devices::DeviceState &s) { s.mount.pierSide = side; });
+        }
+    }
+}
+
+void MyClient::removeProperty(INDI::Property property)
+{
+    // 快照里的属性被删除（驱动断开/重建属性）时整台设备的快照作废，读取方回退到直接读属性，
+    // 直到新的 newProperty/updateProperty 重新填入
+    const char *rawName = property.getName();
+    const char *rawDevice = property.getDeviceName();
+    if (rawName == nullptr || rawDevice == nullptr)
+        return;
+    static const char *const kSnapshotProperties[] = {
+        "EQUATORIAL_EOD_COORD", "TELESCOPE_PARK", "TELESCOPE_TRACK_STATE",
+        "TELESCOPE_PIER_SIDE", "CCD_TEMPERATURE", "ABS_FOCUS_POSITION",
+    };
+    for (const char *tracked : kSnapshotProperties)
+    {
+        if (std::strcmp(rawName, tracked) == 0)
+        {
+            propertySnapshots.reset(propertySnapshots.findSlot(rawDevice));
+            return;
+        }
+    }
+}
+
+int MyClient::snapshotSlot(INDI::BaseDevice *dp)
+{
+    if (dp == nullptr)
+        return -1;
+    const char *deviceName = dp->getDeviceName();
+    if (deviceName == nullptr)
+        return -1;
+
+    std::lock_guard<std::mutex> lock(snapshotSlotMutex);
+    auto it = snapshotSlotCache.find(dp);
+    if (it != snapshotSlotCache.end() && it->second.deviceName == deviceName)
+        return it->second.slot;
+    const int slot = propertySnapshots.findSlot(deviceName);
+    if (slot >= 0)
+        snapshotSlotCache[dp] = SnapshotSlotEntry{deviceName, slot};
+    return slot;
+}
+
 //************************ device list management***********************************
 
 void MyClient::AddDevice(INDI::BaseDevice *device, const std::string &name)
@@ -461,6 +722,12 @@ uint32_t MyClient::setTemperature(INDI::BaseDevice *dp, double value)
 
 uint32_t MyClient::getTemperature(INDI::BaseDevice *dp, double &value)
 {
+    devices::Versioned<double> temperature;
+    if (readSnapshot(dp, &devices::PropertySnapshot::ccdTemperature, temperature))
+    {
+        value = temperature.value;
+        return QHYCCD_SUCCESS;
+    }
 
     const char *propertyName = "CCD_TEMPERATURE";
     INDI::PropertyNumber ccdTemperature = dp->getProperty(propertyName);
@@ -1179,6 +1446,24 @@ uint32_t MyClient::setCCDUploadModeToLacal(INDI::BaseDevice *dp)
     return QHYCCD_SUCCESS;
 }
 
+uint32_t MyClient::setCCDUploadModeToClient(INDI::BaseDevice *dp)
+{
+    INDI::PropertySwitch uploadmode = dp->getProperty("UPLOAD_MODE");
+
+    if (!uploadmode.isValid())
+    {
+        Logger::Log("indi_client | setCCDUploadModeToClient | Error: unable to find UPLOAD_MODE property...", LogLevel::WARNING, DeviceType::CAMERA);
+        return QHYCCD_ERROR;
+    }
+
+    uploadmode[0].setState(ISS_ON);
+    uploadmode[1].setState(ISS_OFF);
+    uploadmode[2].setState(ISS_OFF);
+
+    sendNewProperty(uploadmode);
+    return QHYCCD_SUCCESS;
+}
+
 uint32_t MyClient::setCCDUpload(INDI::BaseDevice *dp, QString Dir, QString Prefix)
 {
     INDI::PropertyText upload = dp->getProperty("UPLOAD_SETTINGS");
@@ -1596,6 +1881,16 @@ uint32_t MyClient::setTelescopeInfo(INDI::BaseDevice *dp, double telescope_apert
 
 uint32_t MyClient::getTelescopePierSide(INDI::BaseDevice *dp, QString &side)
 {
+    devices::Versioned<int> pier;
+    if (readSnapshot(dp, &devices::PropertySnapshot::pierSide, pier))
+    {
+        if (pier.value == 0)
+            side = "WEST";
+        else if (pier.value == 1)
+            side = "EAST";
+        return QHYCCD_SUCCESS;
+    }
+
     INDI::PropertySwitch property = dp->getProperty("TELESCOPE_PIER_SIDE");
 
     if (!property.isValid())
@@ -1684,6 +1979,14 @@ uint32_t MyClient::setTelescopeTrackRate(INDI::BaseDevice *dp, QString rate)
 
 uint32_t MyClient::getTelescopeTrackEnable(INDI::BaseDevice *dp, bool &enable)
 {
+    devices::Versioned<bool> tracking;
+    if (readSnapshot(dp, &devices::PropertySnapshot::tracking, tracking))
+    {
+        enable = tracking.value;
+        mountState.isTracking = tracking.value;
+        return QHYCCD_SUCCESS;
+    }
+
     INDI::PropertySwitch property = dp->getProperty("TELESCOPE_TRACK_STATE");
 
     if (!property.isValid())
@@ -1804,6 +2107,14 @@ uint32_t MyClient::setTelescopeParkPosition(INDI::BaseDevice *dp, double RA_DEGR
 */
 uint32_t MyClient::getTelescopePark(INDI::BaseDevice *dp, bool &isParked)
 {
+    devices::Versioned<bool> parked;
+    if (readSnapshot(dp, &devices::PropertySnapshot::parked, parked))
+    {
+        isParked = parked.value;
+        mountState.isParked = parked.value;
+        return QHYCCD_SUCCESS;
+    }
+
     INDI::PropertySwitch property = dp->getProperty("TELESCOPE_PARK");
 
     if (!property.isValid())
@@ -2014,6 +2325,13 @@ uint32_t MyClient::setTelescopeHomeInit(INDI::BaseDevice *dp, QString command)
 
 uint32_t MyClient::getTelescopeMoving(INDI::BaseDevice *dp)
 {
+    devices::Versioned<bool> busy;
+    if (readSnapshot(dp, &devices::PropertySnapshot::eqBusy, busy))
+    {
+        mountState.isMoving = busy.value;
+        return QHYCCD_SUCCESS;
+    }
+
     INDI::PropertyNumber eq = dp->getProperty("EQUATORIAL_EOD_COORD");
     if (eq.isValid())
     {
@@ -2680,6 +2998,14 @@ uint32_t MyClient::setTelescopeRADECJ2000(INDI::BaseDevice *dp, double RA_Hours,
 
 uint32_t MyClient::getTelescopeRADECJNOW(INDI::BaseDevice *dp, double &RA_Hours, double &DEC_Degree)
 {
+    devices::Versioned<devices::EqCoord> coord;
+    if (readSnapshot(dp, &devices::PropertySnapshot::eqCoord, coord))
+    {
+        RA_Hours = coord.value.raHours;
+        DEC_Degree = coord.value.decDeg;
+        return QHYCCD_SUCCESS;
+    }
+
     INDI::PropertyNumber property = dp->getProperty("EQUATORIAL_EOD_COORD");
 
     if (!property.isValid())
@@ -3450,6 +3776,13 @@ uint32_t MyClient::moveFocuserToAbsolutePosition(INDI::BaseDevice *dp, int posit
 
 uint32_t MyClient::getFocuserAbsolutePosition(INDI::BaseDevice *dp, int &position)
 {
+    devices::Versioned<int> focusPosition;
+    if (readSnapshot(dp, &devices::PropertySnapshot::focusPosition, focusPosition))
+    {
+        position = focusPosition.value;
+        return QHYCCD_SUCCESS;
+    }
+
     INDI::PropertyNumber property = dp->getProperty("ABS_FOCUS_POSITION");
 
     if (!property.isValid())
@@ -6,6 +6,9 @@
 
 #include <iostream>
 #include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
 #include <QElapsedTimer>
 #include <QObject>
 #include <QTimer>
@@ -13,6 +16,8 @@
 
 #include "Logger.h"
 #include "mountstate.h"
+#include "devices/PropertySnapshot.h"
+#include "fits/FitsWriter.h"
 
 // 回调函数类型定义
 using ImageReceivedCallback = std::function<void(const std::string& filename, const std::string& devname)>;
@@ -86,6 +91,8 @@ class MyClient : public INDI::BaseClient
         uint32_t setCCDReadMode(INDI::BaseDevice *dp,int value);
 
         uint32_t setCCDUploadModeToLacal(INDI::BaseDevice *dp);
+        // UPLOAD_MODE 切到 client：图像以 BLOB 发给本客户端，不再由驱动写盘（配合 setBlobIngestion 使用）
+        uint32_t setCCDUploadModeToClient(INDI::BaseDevice *dp);
 
         uint32_t setCCDUpload(INDI::BaseDevice *dp, QString Dir, QString Prefix);
 
@@ -190,6 +197,29 @@ class MyClient : public INDI::BaseClient
         uint32_t getAtmosphere(INDI::BaseDevice *dp,double &temperature, double &pressure, double &humidity);
 
         MountState mountState;
+
+        // 高频属性快照（updateProperty 写入）。值有效时读取方直接取，version 用于只在变化时推送界面
+        template <typename T>
+        bool readSnapshot(INDI::BaseDevice *dp, devices::Versioned<T> devices::PropertySnapshot::*field,
+                          devices::Versioned<T> &out)
+        {
+            const int slot = snapshotSlot(dp);
+            if (slot < 0)
+                return false;
+            out = propertySnapshots.get(slot, field);
+            return out.valid();
+        }
+
+        // 内存 BLOB 接收：
+        // - mirrorPath 非空时该设备的图像 BLOB 在 updateProperty 里直接按内存解码（fits::readFitsFromMemory），
+        //   原始字节同时写到 mirrorPath（tmpfs）供仍按文件工作的流程（解析、极轴校准、对焦）使用
+        // - mirrorPath 为空表示关闭，回到驱动写盘 + CCD_FILE_PATH 的路径
+        void setBlobIngestion(const std::string &deviceName, const std::string &mirrorPath);
+        bool blobIngestionEnabled(const std::string &deviceName) const;
+        // 取走 receiveImage 回调对应的已解码帧（只能取一次）；解码失败或未启用时返回空
+        std::shared_ptr<SdkFrameData> takeBlobFrame(const std::string &deviceName,
+                                                    fits::HeaderTemplate *header = nullptr);
+
         QTimer MountGotoTimer;
         double oldRA_Hours = 0;
         double oldDEC_Degree = 0;
@@ -239,6 +269,7 @@ class MyClient : public INDI::BaseClient
         // void newBLOB(IBLOB *bp) ;
         void newProperty(INDI::Property property) override;
         void updateProperty(INDI::Property property);
+        void removeProperty(INDI::Property property) override;
     private:
         // -------- INDI property compatibility utils --------
         // 兼容不同 INDI CCD 驱动的 Gain/Offset 属性位置：
@@ -250,6 +281,32 @@ class MyClient : public INDI::BaseClient
         static bool ResolveCcdGainWidget(INDI::BaseDevice *dp, INDI::PropertyNumber &prop, int &idx);
         static bool ResolveCcdOffsetWidget(INDI::BaseDevice *dp, INDI::PropertyNumber &prop, int &idx);
 
+        // 把关心的属性（坐标/运动/停放/跟踪/曝光/调焦位置）写入 devices::DeviceStateBus 与属性快照，
+        // 并同步 mountState.isMoving，供事件驱动的等待使用
+        void publishDeviceState(INDI::Property property);
+
+        // dp -> 快照槽位：按指针缓存，命中时只比较一次设备名防止指针复用
+        int snapshotSlot(INDI::BaseDevice *dp);
+
+        devices::PropertySnapshotStore propertySnapshots;
+        struct SnapshotSlotEntry {
+            std::string deviceName;
+            int slot;
+        };
+        std::mutex snapshotSlotMutex;
+        std::unordered_map<const INDI::BaseDevice *, SnapshotSlotEntry> snapshotSlotCache;
+
+        // 处理一个图像 BLOB：写镜像文件、内存解码、触发 receiveImage
+        void ingestBlob(INDI::Property property);
+
+        struct BlobFrame {
+            std::shared_ptr<SdkFrameData> frame;
+            fits::HeaderTemplate header;
+        };
+        mutable std::mutex blobMutex;
+        std::unordered_map<std::string, std::string> blobMirrorPaths;  // 设备名 -> 镜像文件路径
+        std::unordered_map<std::string, BlobFrame> pendingBlobFrames;  // 设备名 -> 待取的解码帧
+
         INDI::BaseDevice mSimpleCCD;
 
         // 存储设备的列表
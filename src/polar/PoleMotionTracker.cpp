@@ -0,0 +1,402 @@
+#include "PoleMotionTracker.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+
+namespace polar {
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+
+double normalizeAngle(double a)
+{
+    while (a <= -kPi) a += 2.0 * kPi;
+    while (a > kPi) a -= 2.0 * kPi;
+    return a;
+}
+
+bool finite(const Point2& p)
+{
+    return std::isfinite(p.x) && std::isfinite(p.y);
+}
+
+double dist2(const Point2& a, const Point2& b)
+{
+    const double dx = a.x - b.x;
+    const double dy = a.y - b.y;
+    return dx * dx + dy * dy;
+}
+
+// 按 motion 统计内点并写入 mask，返回内点数；sse 为内点残差平方和
+size_t scoreInliers(const std::vector<Point2>& src,
+                    const std::vector<Point2>& dst,
+                    const RigidMotion& motion,
+                    double thr2,
+                    std::vector<uint8_t>* mask,
+                    double& sse)
+{
+    size_t count = 0;
+    sse = 0.0;
+    for (size_t i = 0; i < src.size(); ++i) {
+        const double e2 = dist2(motion.apply(src[i]), dst[i]);
+        const bool in = e2 <= thr2;
+        if (mask)
+            (*mask)[i] = in ? 1 : 0;
+        if (in) {
+            ++count;
+            sse += e2;
+        }
+    }
+    return count;
+}
+
+} // namespace
+
+Point2 RigidMotion::apply(const Point2& p) const
+{
+    const double c = std::cos(angleRad);
+    const double s = std::sin(angleRad);
+    return {c * p.x - s * p.y + tx, s * p.x + c * p.y + ty};
+}
+
+RigidMotion RigidMotion::inverse() const
+{
+    const double c = std::cos(angleRad);
+    const double s = std::sin(angleRad);
+    RigidMotion inv;
+    inv.angleRad = -angleRad;
+    inv.tx = -(c * tx + s * ty);
+    inv.ty = -(-s * tx + c * ty);
+    return inv;
+}
+
+double RigidMotion::rotationDeg() const
+{
+    return angleRad * 180.0 / kPi;
+}
+
+bool fitRigid(const std::vector<Point2>& src,
+              const std::vector<Point2>& dst,
+              const std::vector<uint8_t>* mask,
+              RigidMotion& out)
+{
+    const size_t n = std::min(src.size(), dst.size());
+    double sx = 0.0, sy = 0.0, dx = 0.0, dy = 0.0;
+    size_t count = 0;
+    for (size_t i = 0; i < n; ++i) {
+        if (mask && !(*mask)[i])
+            continue;
+        sx += src[i].x;
+        sy += src[i].y;
+        dx += dst[i].x;
+        dy += dst[i].y;
+        ++count;
+    }
+    if (count < 2)
+        return false;
+    sx /= count;
+    sy /= count;
+    dx /= count;
+    dy /= count;
+
+    // 去质心后 θ = atan2(Σ a×b, Σ a·b)
+    double cross = 0.0, dot = 0.0;
+    for (size_t i = 0; i < n; ++i) {
+        if (mask && !(*mask)[i])
+            continue;
+        const double ax = src[i].x - sx, ay = src[i].y - sy;
+        const double bx = dst[i].x - dx, by = dst[i].y - dy;
+        cross += ax * by - ay * bx;
+        dot += ax * bx + ay * by;
+    }
+    if (std::fabs(cross) < 1e-12 && std::fabs(dot) < 1e-12)
+        return false;
+
+    out.angleRad = std::atan2(cross, dot);
+    const double c = std::cos(out.angleRad);
+    const double s = std::sin(out.angleRad);
+    out.tx = dx - (c * sx - s * sy);
+    out.ty = dy - (s * sx + c * sy);
+    return true;
+}
+
+bool estimateRigidRansac(const std::vector<Point2>& src,
+                         const std::vector<Point2>& dst,
+                         const RigidRansacOptions& options,
+                         RigidRansacResult& result)
+{
+    result.ok = false;
+    result.inliers = 0;
+    result.rmsPx = 0.0;
+    result.iterations = 0;
+    const size_t n = std::min(src.size(), dst.size());
+    result.inlierMask.assign(n, 0);
+    const size_t minInliers = std::max<size_t>(2, options.minInliers);
+    if (n < minInliers)
+        return false;
+
+    const double thr = std::max(0.1, options.inlierThresholdPx);
+    const double thr2 = thr * thr;
+    const double maxRotation = options.maxRotationDeg * kPi / 180.0;
+    std::mt19937 rng(options.seed);
+    std::uniform_int_distribution<size_t> pick(0, n - 1);
+
+    RigidMotion best;
+    size_t bestCount = 0;
+    double bestSse = std::numeric_limits<double>::infinity();
+    int needed = std::max(1, options.maxIterations);
+    int it = 0;
+    for (; it < needed; ++it) {
+        const size_t i = pick(rng);
+        size_t j = pick(rng);
+        if (i == j)
+            j = (j + 1) % n;
+
+        const double ax = src[j].x - src[i].x, ay = src[j].y - src[i].y;
+        const double bx = dst[j].x - dst[i].x, by = dst[j].y - dst[i].y;
+        const double la = std::hypot(ax, ay);
+        const double lb = std::hypot(bx, by);
+        // 刚体不改变两点间距：距离差超过阈值的样本对至少有一个是错配
+        if (la < 2.0 * thr || std::fabs(la - lb) > 2.0 * thr)
+            continue;
+
+        RigidMotion hyp;
+        hyp.angleRad = normalizeAngle(std::atan2(by, bx) - std::atan2(ay, ax));
+        if (std::fabs(hyp.angleRad) > maxRotation)
+            continue;
+        const double c = std::cos(hyp.angleRad);
+        const double s = std::sin(hyp.angleRad);
+        hyp.tx = dst[i].x - (c * src[i].x - s * src[i].y);
+        hyp.ty = dst[i].y - (s * src[i].x + c * src[i].y);
+
+        double sse = 0.0;
+        const size_t count = scoreInliers(src, dst, hyp, thr2, nullptr, sse);
+        if (count > bestCount || (count == bestCount && sse < bestSse)) {
+            best = hyp;
+            bestCount = count;
+            bestSse = sse;
+            // 按当前内点率更新所需迭代次数
+            const double w = static_cast<double>(count) / n;
+            if (w >= 1.0) {
+                needed = it + 1;
+            } else if (w > 0.0) {
+                const double k = std::log(1.0 - std::clamp(options.confidence, 0.5, 0.999999)) /
+                                 std::log(1.0 - w * w);
+                if (std::isfinite(k))
+                    needed = std::min(needed, std::max(it + 1, static_cast<int>(std::ceil(k))));
+            }
+        }
+    }
+    result.iterations = it;
+    if (bestCount < minInliers)
+        return false;
+
+    // 内点最小二乘精修，再按精修结果重新划分一次内点
+    RigidMotion refined = best;
+    double sse = 0.0;
+    scoreInliers(src, dst, best, thr2, &result.inlierMask, sse);
+    for (int pass = 0; pass < 2; ++pass) {
+        if (!fitRigid(src, dst, &result.inlierMask, refined))
+            return false;
+        result.inliers = scoreInliers(src, dst, refined, thr2, &result.inlierMask, sse);
+    }
+    if (result.inliers < minInliers)
+        return false;
+
+    result.motion = refined;
+    result.rmsPx = std::sqrt(sse / result.inliers);
+    result.ok = true;
+    return true;
+}
+
+PoleMotionTracker::PoleMotionTracker(const PoleTrackOptions& options)
+    : m_options(options)
+{
+}
+
+void PoleMotionTracker::setOptions(const PoleTrackOptions& options)
+{
+    m_options = options;
+}
+
+void PoleMotionTracker::reset()
+{
+    m_anchored = false;
+    m_anchorPts.clear();
+    m_points.clear();
+    m_lowStreak = 0;
+    m_result = PoleTrackResult();
+}
+
+bool PoleMotionTracker::usable(const Point2& p) const
+{
+    if (!finite(p))
+        return false;
+    const double m = m_options.edgeMarginPx;
+    if (m_options.imageWidth > 0 && (p.x < m || p.x > m_options.imageWidth - m))
+        return false;
+    if (m_options.imageHeight > 0 && (p.y < m || p.y > m_options.imageHeight - m))
+        return false;
+    return true;
+}
+
+bool PoleMotionTracker::farFromAll(const Point2& p, const std::vector<Point2>& points) const
+{
+    const double sep2 = m_options.minSeparationPx * m_options.minSeparationPx;
+    for (const Point2& q : points) {
+        if (dist2(p, q) < sep2)
+            return false;
+    }
+    return true;
+}
+
+bool PoleMotionTracker::anchor(const std::vector<Point2>& stars, const Point2& polePx, const Point2& lockStarPx)
+{
+    reset();
+    const size_t maxStars = static_cast<size_t>(std::max(2, m_options.maxStars));
+    m_points.reserve(maxStars);
+    m_anchorPts.reserve(maxStars);
+    for (const Point2& s : stars) {
+        if (m_points.size() >= maxStars)
+            break;
+        if (!usable(s) || !farFromAll(s, m_points))
+            continue;
+        m_points.push_back(s);
+    }
+    if (m_points.size() < std::max<size_t>(2, m_options.ransac.minInliers) || !finite(polePx)) {
+        m_points.clear();
+        return false;
+    }
+    m_anchorPts = m_points;
+    m_anchorPole = polePx;
+    m_anchorLock = finite(lockStarPx) ? lockStarPx : m_points.front();
+    m_anchored = true;
+
+    m_result.ok = true;
+    m_result.polePx = m_anchorPole;
+    m_result.lockStarPx = m_anchorLock;
+    m_result.tracked = m_points.size();
+    m_result.inliers = m_points.size();
+    m_result.confidence = 1.0;
+
+    // 预留逐帧缓冲，之后的 update 不再扩容
+    m_src.reserve(maxStars);
+    m_dst.reserve(maxStars);
+    m_index.reserve(maxStars);
+    m_nextAnchor.reserve(maxStars);
+    m_nextPoints.reserve(maxStars);
+    m_ransac.inlierMask.reserve(maxStars);
+    return true;
+}
+
+void PoleMotionTracker::replenish(const std::vector<Point2>& candidates, const RigidMotion& anchorToCurrent)
+{
+    const size_t maxStars = static_cast<size_t>(std::max(2, m_options.maxStars));
+    if (m_nextPoints.size() >= maxStars)
+        return;
+    const RigidMotion currentToAnchor = anchorToCurrent.inverse();
+    for (const Point2& c : candidates) {
+        if (m_nextPoints.size() >= maxStars)
+            break;
+        if (!usable(c) || !farFromAll(c, m_nextPoints))
+            continue;
+        m_nextPoints.push_back(c);
+        m_nextAnchor.push_back(currentToAnchor.apply(c));
+    }
+}
+
+const PoleTrackResult& PoleMotionTracker::update(const std::vector<Point2>& tracked,
+                                                 const std::vector<uint8_t>& status,
+                                                 const std::vector<Point2>& candidates)
+{
+    const Point2 lastPole = m_result.polePx;
+    const Point2 lastLock = m_result.lockStarPx;
+    m_result = PoleTrackResult();
+    m_result.polePx = lastPole;
+    m_result.lockStarPx = lastLock;
+
+    if (!m_anchored) {
+        m_result.solveRequested = true;
+        return m_result;
+    }
+
+    // 1. 光流成功且仍在画面内的星，向最近的识星结果吸附
+    const double snap2 = m_options.snapRadiusPx * m_options.snapRadiusPx;
+    m_src.clear();
+    m_dst.clear();
+    m_index.clear();
+    const size_t n = std::min({m_points.size(), tracked.size(), status.size()});
+    for (size_t i = 0; i < n; ++i) {
+        if (!status[i] || !usable(tracked[i]))
+            continue;
+        Point2 p = tracked[i];
+        double bestD2 = snap2;
+        const Point2* nearest = nullptr;
+        for (const Point2& c : candidates) {
+            const double d2 = dist2(c, p);
+            if (d2 <= bestD2) {
+                bestD2 = d2;
+                nearest = &c;
+            }
+        }
+        if (nearest) {
+            p = *nearest;
+            ++m_result.snapped;
+        }
+        m_src.push_back(m_anchorPts[i]);
+        m_dst.push_back(p);
+        m_index.push_back(i);
+    }
+    m_result.tracked = m_src.size();
+
+    // 2. 锚定帧 → 当前帧的刚体运动
+    if (estimateRigidRansac(m_src, m_dst, m_options.ransac, m_ransac)) {
+        const RigidMotion& motion = m_ransac.motion;
+        m_result.ok = true;
+        m_result.motion = motion;
+        m_result.inliers = m_ransac.inliers;
+        m_result.rmsPx = m_ransac.rmsPx;
+        m_result.polePx = motion.apply(m_anchorPole);
+        m_result.lockStarPx = motion.apply(m_anchorLock);
+        double bestD2 = snap2;
+        for (const Point2& c : candidates) {
+            const double d2 = dist2(c, m_result.lockStarPx);
+            if (d2 <= bestD2) {
+                bestD2 = d2;
+                m_result.lockStarPx = c;
+            }
+        }
+
+        // 置信度：内点率 × 内点数是否充足 × 残差相对阈值
+        const double inlierRatio = static_cast<double>(m_ransac.inliers) / std::max<size_t>(1, m_src.size());
+        const double countScore = std::min(1.0, static_cast<double>(m_ransac.inliers) /
+                                                    (2.0 * std::max<size_t>(2, m_options.ransac.minInliers)));
+        const double residualScore = 1.0 - 0.5 * std::min(1.0, m_ransac.rmsPx / std::max(0.1, m_options.ransac.inlierThresholdPx));
+        m_result.confidence = std::clamp(inlierRatio * std::sqrt(countScore) * residualScore, 0.0, 1.0);
+
+        // 3. 下一帧的跟踪星：保留内点（锚定坐标不变），剔除离群，再按识星结果补足
+        m_nextAnchor.clear();
+        m_nextPoints.clear();
+        for (size_t k = 0; k < m_src.size(); ++k) {
+            if (!m_ransac.inlierMask[k])
+                continue;
+            m_nextAnchor.push_back(m_anchorPts[m_index[k]]);
+            m_nextPoints.push_back(m_dst[k]);
+        }
+        replenish(candidates, motion);
+        m_anchorPts.swap(m_nextAnchor);
+        m_points.swap(m_nextPoints);
+    }
+
+    if (!m_result.ok || m_result.confidence < m_options.minConfidence)
+        ++m_lowStreak;
+    else
+        m_lowStreak = 0;
+    m_result.solveRequested = m_lowStreak >= std::max(1, m_options.lowConfidenceFrames);
+    return m_result;
+}
+
+} // namespace polar
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace polar {
+
+struct Point2 {
+    double x{0.0};
+    double y{0.0};
+};
+
+// 平面刚体运动：先绕原点旋转 angleRad，再平移 (tx, ty)
+struct RigidMotion {
+    double angleRad{0.0};
+    double tx{0.0};
+    double ty{0.0};
+
+    Point2 apply(const Point2& p) const;
+    RigidMotion inverse() const;
+    double rotationDeg() const;
+};
+
+// 最小二乘刚体拟合（二维 Kabsch）：mask 为空表示全部点参与；参与点少于 2 返回 false
+bool fitRigid(const std::vector<Point2>& src,
+              const std::vector<Point2>& dst,
+              const std::vector<uint8_t>* mask,
+              RigidMotion& out);
+
+struct RigidRansacOptions {
+    double inlierThresholdPx{2.0};
+    int maxIterations{200};
+    double confidence{0.995};      ///< 达到此置信度后按内点率提前结束
+    double maxRotationDeg{20.0};   ///< 假设旋转超过此值直接丢弃（调极轴时两帧之间不会转这么多）
+    size_t minInliers{4};
+    uint32_t seed{0x5eed};         ///< 固定种子，同样的输入得到同样的结果
+};
+
+struct RigidRansacResult {
+    bool ok{false};
+    RigidMotion motion;
+    std::vector<uint8_t> inlierMask;   ///< 与输入点一一对应；复用同一个结果对象时不再分配
+    size_t inliers{0};
+    double rmsPx{0.0};                 ///< 内点残差 RMS
+    int iterations{0};
+};
+
+// 两点最小样本 RANSAC + 内点最小二乘精修；内点少于 minInliers 时 ok=false
+bool estimateRigidRansac(const std::vector<Point2>& src,
+                         const std::vector<Point2>& dst,
+                         const RigidRansacOptions& options,
+                         RigidRansacResult& result);
+
+struct PoleTrackOptions {
+    int imageWidth{0};
+    int imageHeight{0};
+    int maxStars{30};
+    double snapRadiusPx{4.0};        ///< 光流结果向本帧识星结果吸附的半径
+    double minSeparationPx{14.0};    ///< 补星时与已有跟踪星的最小间距
+    double edgeMarginPx{8.0};        ///< 离边缘不足此距离的星不参与（光流窗口会出界）
+    RigidRansacOptions ransac;
+    double minConfidence{0.45};
+    int lowConfidenceFrames{2};      ///< 连续这么多帧置信度不足或跟踪失败后请求板解重新锚定
+};
+
+struct PoleTrackResult {
+    bool ok{false};
+    Point2 polePx;                   ///< 当前帧中的天极位置（失败时保持上一次的值）
+    Point2 lockStarPx;               ///< 当前帧中的锁定星位置
+    RigidMotion motion;              ///< 锚定帧 → 当前帧
+    size_t tracked{0};               ///< 光流成功的星数
+    size_t snapped{0};               ///< 其中吸附到识星结果的星数
+    size_t inliers{0};
+    double rmsPx{0.0};
+    double confidence{0.0};
+    bool solveRequested{false};
+};
+
+// 电子极轴镜实时调整阶段的多星跟踪：
+// 每颗跟踪星记住它在锚定帧（最近一次板解帧）中的坐标，每帧用锚定坐标与当前坐标做刚体 RANSAC，
+// 把板解得到的天极像素位置按同一运动推到当前帧。运动总是相对锚定帧估计，逐帧误差不累积；
+// 丢失或离群的星被剔除，按识星结果补星。置信度连续不足时置 solveRequested，由调用方板解后重新 anchor。
+// 不涉及图像：光流由调用方（PoleTrackingEngine）完成，这里只处理点。
+class PoleMotionTracker
+{
+public:
+    explicit PoleMotionTracker(const PoleTrackOptions& options = PoleTrackOptions());
+
+    void setOptions(const PoleTrackOptions& options);
+    const PoleTrackOptions& options() const { return m_options; }
+
+    void reset();
+
+    // 以板解帧为锚：stars 为该帧识星结果（亮星在前），polePx/lockStarPx 为该帧像素坐标；
+    // 可用星少于 ransac.minInliers 时返回 false
+    bool anchor(const std::vector<Point2>& stars, const Point2& polePx, const Point2& lockStarPx);
+    bool anchored() const { return m_anchored; }
+
+    // 上一帧中各跟踪星的位置（光流的输入点）
+    const std::vector<Point2>& trackPoints() const { return m_points; }
+
+    // tracked/status 与 trackPoints() 一一对应（status 非 0 表示光流成功）；candidates 为本帧识星结果，可为空。
+    // 失败时保留上一帧的跟踪星，调用方应继续以上一帧为参考
+    const PoleTrackResult& update(const std::vector<Point2>& tracked,
+                                  const std::vector<uint8_t>& status,
+                                  const std::vector<Point2>& candidates);
+
+    const PoleTrackResult& last() const { return m_result; }
+    int lowConfidenceStreak() const { return m_lowStreak; }
+
+private:
+    bool usable(const Point2& p) const;
+    bool farFromAll(const Point2& p, const std::vector<Point2>& points) const;
+    void replenish(const std::vector<Point2>& candidates, const RigidMotion& anchorToCurrent);
+
+    PoleTrackOptions m_options;
+    bool m_anchored{false};
+    Point2 m_anchorPole;
+    Point2 m_anchorLock;
+    std::vector<Point2> m_anchorPts;   ///< 跟踪星在锚定帧中的坐标
+    std::vector<Point2> m_points;      ///< 跟踪星在上一帧中的坐标
+    int m_lowStreak{0};
+    PoleTrackResult m_result;
+
+    // 逐帧复用的缓冲，稳态下 update 不分配内存
+    std::vector<Point2> m_src;
+    std::vector<Point2> m_dst;
+    std::vector<size_t> m_index;
+    std::vector<Point2> m_nextAnchor;
+    std::vector<Point2> m_nextPoints;
+    RigidRansacResult m_ransac;
+};
+
+} // namespace polar
@@ -0,0 +1,125 @@
+#include "PoleTrackingEngine.h"
+
+#include <opencv2/video/tracking.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+namespace polar {
+
+namespace {
+
+double elapsedMs(std::chrono::steady_clock::time_point since)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - since).count();
+}
+
+} // namespace
+
+PoleTrackingEngine::PoleTrackingEngine(const PoleTrackingEngineOptions& options)
+{
+    setOptions(options);
+}
+
+void PoleTrackingEngine::setOptions(const PoleTrackingEngineOptions& options)
+{
+    m_options = options;
+    m_options.windowPx = std::max(5, m_options.windowPx | 1);
+    m_tracker.setOptions(m_options.track);
+}
+
+void PoleTrackingEngine::reset()
+{
+    m_tracker.reset();
+    m_levels[0] = m_levels[1] = 0;
+    m_prev = 0;
+    m_loaded = 0;
+    m_pyramidMs = 0.0;
+    m_flowMs = 0.0;
+}
+
+int PoleTrackingEngine::pyramidLevels() const
+{
+    // 每层光流能跟上约半个窗口的位移，顶层再乘 2^levels
+    const double halfWindow = m_options.windowPx * 0.5;
+    const double ratio = std::max(1.0, m_options.maxMotionPx / halfWindow);
+    return std::clamp(static_cast<int>(std::ceil(std::log2(ratio))), 1, 5);
+}
+
+bool PoleTrackingEngine::loadSlot(const cv::Mat& gray8, int slot)
+{
+    if (gray8.empty() || gray8.type() != CV_8UC1)
+        return false;
+    if (gray8.data != m_gray[slot].data)
+        gray8.copyTo(m_gray[slot]);   // 尺寸不变时复用已有缓冲
+
+    const auto t0 = std::chrono::steady_clock::now();
+    const cv::Size win(m_options.windowPx, m_options.windowPx);
+    // vector<Mat> 中各层尺寸/类型不变时 buildOpticalFlowPyramid 原地覆盖，不重新分配
+    m_levels[slot] = cv::buildOpticalFlowPyramid(m_gray[slot], m_pyramid[slot], win, pyramidLevels(), true);
+    m_pyramidMs = elapsedMs(t0);
+    m_loaded = slot;
+    return true;
+}
+
+bool PoleTrackingEngine::anchor(const cv::Mat& gray8,
+                                const std::vector<Point2>& stars,
+                                const Point2& polePx,
+                                const Point2& lockStarPx)
+{
+    PoleTrackOptions trackOptions = m_options.track;
+    trackOptions.imageWidth = gray8.cols;
+    trackOptions.imageHeight = gray8.rows;
+    m_options.track = trackOptions;
+    m_tracker.setOptions(trackOptions);
+
+    int slot = 1 - m_prev;
+    if (!gray8.empty() && gray8.data == m_gray[m_loaded].data && m_levels[m_loaded] > 0)
+        slot = m_loaded;   // 刚跟踪过的帧：灰度和金字塔都已就绪
+    else if (!loadSlot(gray8, slot))
+        return false;
+    if (!m_tracker.anchor(stars, polePx, lockStarPx))
+        return false;
+    m_prev = slot;
+    return true;
+}
+
+const PoleTrackResult& PoleTrackingEngine::track(const cv::Mat& gray8, const std::vector<Point2>& candidates)
+{
+    const int slot = 1 - m_prev;
+    const std::vector<Point2>& points = m_tracker.trackPoints();
+    m_tracked.clear();
+    m_trackStatus.clear();
+
+    if (!m_tracker.anchored() || gray8.size() != m_gray[m_prev].size() || !loadSlot(gray8, slot) || points.empty())
+        return m_tracker.update(m_tracked, m_trackStatus, candidates);
+
+    m_prevPts.resize(points.size());
+    for (size_t i = 0; i < points.size(); ++i)
+        m_prevPts[i] = cv::Point2f(static_cast<float>(points[i].x), static_cast<float>(points[i].y));
+
+    const auto t0 = std::chrono::steady_clock::now();
+    const cv::Size win(m_options.windowPx, m_options.windowPx);
+    const cv::TermCriteria criteria(cv::TermCriteria::COUNT | cv::TermCriteria::EPS,
+                                    m_options.lkIterations,
+                                    m_options.lkEpsilon);
+    // 传入预建金字塔：上一帧的金字塔沿用，不再为两幅图各建一次
+    cv::calcOpticalFlowPyrLK(m_pyramid[m_prev], m_pyramid[slot], m_prevPts, m_nextPts, m_status, m_err,
+                             win, std::min(m_levels[m_prev], m_levels[slot]), criteria);
+    m_flowMs = elapsedMs(t0);
+
+    m_tracked.resize(m_nextPts.size());
+    m_trackStatus.resize(m_status.size());
+    for (size_t i = 0; i < m_nextPts.size(); ++i) {
+        m_tracked[i] = Point2{m_nextPts[i].x, m_nextPts[i].y};
+        m_trackStatus[i] = m_status[i];
+    }
+
+    const PoleTrackResult& result = m_tracker.update(m_tracked, m_trackStatus, candidates);
+    if (result.ok)
+        m_prev = slot;
+    return result;
+}
+
+} // namespace polar
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "PoleMotionTracker.h"
+
+#include <opencv2/core/core.hpp>
+
+#include <vector>
+
+namespace polar {
+
+struct PoleTrackingEngineOptions {
+    int windowPx{21};          ///< 光流窗口边长（奇数）
+    int maxMotionPx{72};       ///< 两帧间允许的最大位移，决定金字塔层数
+    int lkIterations{20};
+    double lkEpsilon{0.03};
+    PoleTrackOptions track;
+};
+
+// 电子极轴镜实时调整阶段的跟踪引擎：
+// - 两块 8bit 灰度缓冲与两套光流金字塔轮换，上一帧的金字塔直接复用，每帧只为新帧建一次金字塔；
+//   图像尺寸不变时缓冲和金字塔都不再分配
+// - 一次光流跟踪全部跟踪星，由 PoleMotionTracker 做锚定帧 → 当前帧的刚体 RANSAC 并推算天极
+// - 只有置信度连续不足时才置 solveRequested，调用方板解后再 anchor
+class PoleTrackingEngine
+{
+public:
+    explicit PoleTrackingEngine(const PoleTrackingEngineOptions& options = PoleTrackingEngineOptions());
+
+    void setOptions(const PoleTrackingEngineOptions& options);
+    const PoleTrackingEngineOptions& options() const { return m_options; }
+    void reset();
+
+    // 下一帧的灰度缓冲（不是上一帧那块）：把新帧直接转换到这里，track 时不再拷贝
+    cv::Mat& frameBuffer() { return m_gray[1 - m_prev]; }
+    // 最近一次 track/anchor 载入的帧；以它重新 anchor 时直接沿用已建好的金字塔
+    const cv::Mat& currentFrame() const { return m_gray[m_loaded]; }
+
+    // 以板解帧为锚（gray8 可以是 frameBuffer() 或 currentFrame()），stars 为该帧识星结果（亮星在前）
+    bool anchor(const cv::Mat& gray8, const std::vector<Point2>& stars, const Point2& polePx, const Point2& lockStarPx);
+    bool anchored() const { return m_tracker.anchored(); }
+
+    // 跟踪一帧：成功时本帧成为下一帧的参考；失败时保留上一帧，下一帧仍与它比较
+    const PoleTrackResult& track(const cv::Mat& gray8, const std::vector<Point2>& candidates);
+
+    // 当前跟踪星（最近一次成功帧中的位置）
+    const std::vector<Point2>& trackPoints() const { return m_tracker.trackPoints(); }
+    const PoleTrackResult& last() const { return m_tracker.last(); }
+    int lowConfidenceStreak() const { return m_tracker.lowConfidenceStreak(); }
+    double lastPyramidMs() const { return m_pyramidMs; }
+    double lastFlowMs() const { return m_flowMs; }
+
+private:
+    bool loadSlot(const cv::Mat& gray8, int slot);
+    int pyramidLevels() const;
+
+    PoleTrackingEngineOptions m_options;
+    PoleMotionTracker m_tracker;
+
+    cv::Mat m_gray[2];
+    std::vector<cv::Mat> m_pyramid[2];
+    int m_levels[2]{0, 0};
+    int m_prev{0};     ///< 下一帧光流的参考槽位
+    int m_loaded{0};   ///< 最近载入的槽位
+
+    std::vector<cv::Point2f> m_prevPts;
+    std::vector<cv::Point2f> m_nextPts;
+    std::vector<uchar> m_status;
+    std::vector<float> m_err;
+    std::vector<Point2> m_tracked;
+    std::vector<uint8_t> m_trackStatus;
+
+    double m_pyramidMs{0.0};
+    double m_flowMs{0.0};
+};
+
+} // namespace polar
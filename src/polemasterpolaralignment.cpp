@@ -22,11 +22,12 @@
 #include <cmath>
 #include <functional>
 #include <limits>
+#include <vector>
 #include <fitsio.h>
-#include <opencv2/video/tracking.hpp>
-#include <opencv2/calib3d.hpp>
 
 #include "Logger.h"
+#include "devices/DeviceStateAwait.h"
+#include "solver/BatchAstrometry.h"
 
 namespace {
 constexpr int kPoleMasterSolveTimeoutMs = 2000;
@@ -80,6 +81,29 @@ bool isFinitePoint(const QPointF &p)
     return std::isfinite(p.x()) && std::isfinite(p.y());
 }
 
+std::vector<polar::Point2> toTrackPoints(const QVector<QPointF> &points)
+{
+    std::vector<polar::Point2> out;
+    out.reserve(static_cast<size_t>(points.size()));
+    for (const QPointF &p : points)
+        out.push_back(polar::Point2{p.x(), p.y()});
+    return out;
+}
+
+QVector<QPointF> toQPoints(const std::vector<polar::Point2> &points)
+{
+    QVector<QPointF> out;
+    out.reserve(static_cast<int>(points.size()));
+    for (const polar::Point2 &p : points)
+        out.append(QPointF(p.x, p.y));
+    return out;
+}
+
+QPointF toQPointF(const polar::Point2 &p)
+{
+    return QPointF(p.x, p.y);
+}
+
 double normalizeSignedAngleDeg(double deg)
 {
     while (deg <= -180.0) deg += 360.0;
@@ -133,6 +157,59 @@ QVector<FixedPoleStar> fixedPoleStars(bool southernHemisphere)
     };
 }
 
+// 固定星预期位置与候选星天球坐标：.wcs 只读一次，整批做 TAN 投影，不再每颗星起一次
+// wcs-rd2xy / wcs-xy2rd 进程（SIP 畸变项忽略，在 45 px 匹配半径内可以接受）。
+// 读不到 .wcs 时 local=false，调用方退回逐点外部命令
+struct FixedStarProjection {
+    bool local = false;
+    std::vector<double> starX;
+    std::vector<double> starY;
+    std::vector<uint8_t> starFront;
+    std::vector<double> detectedRa;
+    std::vector<double> detectedDec;
+};
+
+FixedStarProjection projectFixedStars(const QString &wcsPath,
+                                      const QVector<FixedPoleStar> &stars,
+                                      const QVector<QPointF> &detectedStars)
+{
+    FixedStarProjection p;
+    solver::TanWcs wcs;
+    std::string error;
+    if (!solver::readWcsFile(wcsPath.toStdString(), &wcs, &error))
+    {
+        Logger::Log("PoleMasterPolarAlignment: local WCS unavailable (" + error + "), fallback to wcs-rd2xy",
+                    LogLevel::WARNING,
+                    DeviceType::MAIN);
+        return p;
+    }
+
+    const size_t starCount = static_cast<size_t>(stars.size());
+    std::vector<double> ra(starCount), dec(starCount);
+    for (size_t i = 0; i < starCount; ++i)
+    {
+        ra[i] = stars[static_cast<int>(i)].raDeg;
+        dec[i] = stars[static_cast<int>(i)].decDeg;
+    }
+    p.starX.resize(starCount);
+    p.starY.resize(starCount);
+    p.starFront.resize(starCount);
+    solver::skyToPixel(wcs, ra.data(), dec.data(), starCount, p.starX.data(), p.starY.data(), p.starFront.data());
+
+    const size_t detectedCount = static_cast<size_t>(detectedStars.size());
+    std::vector<double> x(detectedCount), y(detectedCount);
+    for (size_t i = 0; i < detectedCount; ++i)
+    {
+        x[i] = detectedStars[static_cast<int>(i)].x();
+        y[i] = detectedStars[static_cast<int>(i)].y();
+    }
+    p.detectedRa.resize(detectedCount);
+    p.detectedDec.resize(detectedCount);
+    solver::pixelToSky(wcs, x.data(), y.data(), detectedCount, p.detectedRa.data(), p.detectedDec.data());
+    p.local = true;
+    return p;
+}
+
 FixedStarMatchResult solveGlobalFixedStarMatch(const QVector<QVector<FixedStarCandidate>> &candidatesByStar,
                                                int detectedStarCount,
                                                int starCount,
@@ -208,11 +285,11 @@ FixedStarMatchResult solveGlobalFixedStarMatch(const QVector<QVector<FixedStarCa
     return result;
 }
 
+// gray8 已有同尺寸缓冲时原地写入（实时调整阶段每帧复用跟踪引擎的缓冲，不再分配）
 bool buildGray8FromFits(const QString &fitsPath, cv::Mat &gray8, int &imageW, int &imageH)
 {
     imageW = 0;
     imageH = 0;
-    gray8.release();
 
     cv::Mat image;
     const int status = Tools::readFits(fitsPath.toLocal8Bit().constData(), image);
@@ -229,7 +306,7 @@ bool buildGray8FromFits(const QString &fitsPath, cv::Mat &gray8, int &imageW, in
 
     if (gray.depth() == CV_8U)
     {
-        gray8 = gray.clone();
+        gray.copyTo(gray8);
     }
     else
     {
@@ -252,7 +329,7 @@ bool buildGray8FromFits(const QString &fitsPath, cv::Mat &gray8, int &imageW, in
             white = static_cast<uint16_t>(std::max<double>(black + 1, std::min(65535.0, maxVal)));
         }
 
-        gray8 = cv::Mat(image16.rows, image16.cols, CV_8UC1);
+        gray8.create(image16.rows, image16.cols, CV_8UC1);
         Tools::Bit16To8_Stretch(image16, gray8, black, white);
     }
 
@@ -460,6 +537,7 @@ bool PoleMasterPolarAlignment::start()
     calibrationFrames.clear();
     hasGuidingAnchorFrame = false;
     guidingAnchorFrame = SolveFrame();
+    trackingSession.reset();
     axisCenterPx = QPointF(-1.0, -1.0);
     axisRadiusPx = 0.0;
     axisResidualPx = 0.0;
@@ -470,16 +548,14 @@ bool PoleMasterPolarAlignment::start()
     lastDecDeg = startDecDeg;
     guidingTrackingInitialized = false;
     guidingLockStarPx = QPointF(-1.0, -1.0);
-    guidingPoleOffsetPx = QPointF(0.0, 0.0);
     guidingLockConfidence = 0.0;
     guidingLostFrames = 0;
     adaptiveGuidanceExposureMs = kGuidanceBootstrapExposureMs;
     adaptiveSolveExposureMs = 0;
     guidanceExposureBootstrapped = false;
     guidanceExposureSeededFromSolve = false;
-    previousGuideGray8.release();
-    previousSelectedTrackStars.clear();
-    guideGrayReady = false;
+    poleTracker.reset();
+    guidingSolveCount = 0;
     guidanceImageW = 0;
     guidanceImageH = 0;
     guidancePixelScaleArcsecPerPixel = 1.0;
@@ -1017,6 +1093,29 @@ bool PoleMasterPolarAlignment::solveImage(const QString &fitsPath)
                         DeviceType::MAIN);
         }
     }
+    // 用本地识星结果作为星表，solve-field 只做匹配，不再对整幅图重新提取
+    solver::XyList starList;
+    const bool haveStarList = Tools::DetectSolveStarList(fitsPath, starList);
+    // 实时调整阶段帧间只移动几个角分：先做近先验跟踪解析，失败再完整解析
+    if (haveStarList && currentState == PoleMasterAlignmentState::GUIDING_ADJUSTMENT &&
+        Tools::TrackSolve(fitsPath, starList, trackingSession))
+        return true;
+    // 极轴镜画面总在天极附近：先用预建的极冠星型索引在进程内解析（毫秒级），画面不在极冠内或匹配失败再走 solve-field
+    if (haveStarList)
+    {
+        double fovLowDeg = 0.0, fovHighDeg = 0.0;
+        if (config.focalLength > 0 && config.cameraWidth > 0.0 && config.cameraHeight > 0.0)
+        {
+            const MinMaxFOV fov = Tools::calculateFOV(config.focalLength, config.cameraWidth, config.cameraHeight);
+            fovLowDeg = fov.minFOV;
+            fovHighDeg = fov.maxFOV;
+        }
+        if (Tools::PoleIndexSolve(fitsPath, starList, fovLowDeg, fovHighDeg, config.latitude < 0.0 ? -1 : 1))
+        {
+            Tools::AnchorTracking(fitsPath, starList, trackingSession);
+            return true;
+        }
+    }
     const bool ok = Tools::PlateSolve(fitsPath,
                                       config.focalLength,
                                       config.cameraWidth,
@@ -1027,10 +1126,14 @@ bool PoleMasterPolarAlignment::solveImage(const QString &fitsPath)
                                       priorDecDeg,
                                       solveSearchRadiusDeg,
                                       backendConfigPath,
-                                      solveTimeoutMs);
+                                      solveTimeoutMs,
+                                      haveStarList ? &starList : nullptr);
     if (!ok) return false;
     QCoreApplication::processEvents();
-    return Tools::isSolveImageFinish();
+    if (!Tools::isSolveImageFinish()) return false;
+    if (haveStarList)
+        Tools::AnchorTracking(fitsPath, starList, trackingSession);
+    return true;
 }
 
 bool PoleMasterPolarAlignment::readSolveFrame(const QString &fitsPath, int exposureMs, SolveFrame &frame) const
@@ -1202,10 +1305,21 @@ QJsonArray PoleMasterPolarAlignment::fixedStarsToJson(const SolveFrame &frame) c
     inFrameList.reserve(stars.size());
     candidatesByStar.resize(stars.size());
 
+    const FixedStarProjection projection = projectFixedStars(frame.wcsPath, stars, frame.detectedStars);
+
     for (int i = 0; i < stars.size(); ++i)
     {
         QPointF expected;
-        const bool projected = skyToPixel(frame.wcsPath, stars[i].raDeg, stars[i].decDeg, expected);
+        bool projected = false;
+        if (projection.local)
+        {
+            expected = QPointF(projection.starX[i], projection.starY[i]);
+            projected = projection.starFront[i] != 0 && isFinitePoint(expected);
+        }
+        else
+        {
+            projected = skyToPixel(frame.wcsPath, stars[i].raDeg, stars[i].decDeg, expected);
+        }
         const bool inFrame = projected &&
             expected.x() >= 0.0 && expected.y() >= 0.0 &&
             expected.x() <= frame.imageW && expected.y() <= frame.imageH;
@@ -1224,11 +1338,10 @@ QJsonArray PoleMasterPolarAlignment::fixedStarsToJson(const SolveFrame &frame) c
             if (distancePx > kFixedStarMatchRadiusPx * 1.8)
                 continue;
 
-            bool ok = false;
-            const SphericalCoordinates sky = Tools::xy2rdByExternal(frame.wcsPath,
-                                                                    candidate.x(),
-                                                                    candidate.y(),
-                                                                    ok);
+            bool ok = projection.local;
+            const SphericalCoordinates sky = projection.local
+                ? SphericalCoordinates{projection.detectedRa[detectedIndex], projection.detectedDec[detectedIndex]}
+                : Tools::xy2rdByExternal(frame.wcsPath, candidate.x(), candidate.y(), ok);
             if (!ok || !std::isfinite(sky.ra) || !std::isfinite(sky.dec))
                 continue;
             const double distanceArcsec = angularDistanceArcsec(stars[i].raDeg, stars[i].decDeg,
@@ -1400,6 +1513,14 @@ void PoleMasterPolarAlignment::emitOverlay(const QString &phase, const SolveFram
     tracking["lockConfidence"] = frame ? frame->lockConfidence : guidingLockConfidence;
     tracking["selectedTrackStarCount"] = frame ? frame->selectedTrackStars.size() : 0;
     tracking["lostFrames"] = guidingLostFrames;
+    if (guidingTrackingInitialized)
+    {
+        const polar::PoleTrackResult &track = poleTracker.last();
+        tracking["inliers"] = static_cast<int>(track.inliers);
+        tracking["rmsPx"] = track.rmsPx;
+        tracking["rotationDeg"] = track.motion.rotationDeg();
+        tracking["solveCount"] = guidingSolveCount;
+    }
     root["tracking"] = tracking;
     root["quality"] = qualityJson(frame, warnings, qualityExtra);
     QJsonArray warningArr;
@@ -1486,6 +1607,13 @@ bool PoleMasterPolarAlignment::waitForMountIdle()
     QElapsedTimer timer;
     timer.start();
     QString status;
+    // 总线有赤道仪坐标状态时，事件驱动等到静止；没有（驱动不报该属性）再回退到轮询
+    if (devices::DeviceStateBus::instance().snapshot(devices::DeviceRole::Mount).mount.eqState !=
+        devices::PropState::Unknown)
+    {
+        devices::awaitDeviceState(devices::DeviceRole::Mount, devices::cond::mountIdle(),
+                                  config.movementTimeoutMs, [this]() { return !running; });
+    }
     while (timer.elapsed() < config.movementTimeoutMs)
     {
         indiServer->getTelescopeStatus(dpMount, status);
@@ -1680,207 +1808,52 @@ bool PoleMasterPolarAlignment::chooseInitialLockStar(const SolveFrame &frame, QP
     return true;
 }
 
-bool PoleMasterPolarAlignment::updateLockStarByTracking(const cv::Mat &currentGray8,
-                                                        const QVector<QPointF> &candidateStars,
-                                                        QPointF &updatedLockStar,
-                                                        double &confidence)
+polar::PoleTrackingEngineOptions PoleMasterPolarAlignment::trackingEngineOptions() const
 {
-    updatedLockStar = guidingLockStarPx;
-    confidence = guidingLockConfidence;
-    if (!guideGrayReady || previousGuideGray8.empty() || currentGray8.empty() || !isFinitePoint(guidingLockStarPx))
-        return false;
-
-    std::vector<cv::Point2f> prevPts(1, cv::Point2f(static_cast<float>(guidingLockStarPx.x()),
-                                                    static_cast<float>(guidingLockStarPx.y())));
-    std::vector<cv::Point2f> nextPts;
-    std::vector<uchar> status;
-    std::vector<float> err;
-    cv::calcOpticalFlowPyrLK(previousGuideGray8, currentGray8, prevPts, nextPts, status, err);
-    if (status.empty() || status[0] == 0)
-        return false;
-
-    const QPointF lkPoint(nextPts[0].x, nextPts[0].y);
-    if (!isFinitePoint(lkPoint))
-        return false;
-
-    const double adaptiveRadius = std::clamp(config.trackBaseRadiusPx + (1.0 - guidingLockConfidence) * 24.0,
-                                             config.trackBaseRadiusPx,
-                                             config.trackMaxRadiusPx);
-    bool found = false;
-    QPointF best = lkPoint;
-    double bestDist = adaptiveRadius;
-    for (const QPointF &s : candidateStars)
-    {
-        const double d = std::hypot(s.x() - lkPoint.x(), s.y() - lkPoint.y());
-        if (d <= bestDist)
-        {
-            bestDist = d;
-            best = s;
-            found = true;
-        }
-    }
-
-    if (found)
-    {
-        updatedLockStar = best;
-        confidence = std::clamp(1.0 - bestDist / std::max(1.0, adaptiveRadius), 0.4, 1.0);
-    }
-    else
-    {
-        if (lkPoint.x() < 0.0 || lkPoint.y() < 0.0 || lkPoint.x() >= currentGray8.cols || lkPoint.y() >= currentGray8.rows)
-            return false;
-        updatedLockStar = lkPoint;
-        confidence = std::max(0.15, guidingLockConfidence * 0.9);
-    }
-    return true;
+    polar::PoleTrackingEngineOptions options;
+    // 光流窗口按基础搜索半径取，金字塔层数按允许的最大帧间位移推算
+    options.windowPx = std::clamp(static_cast<int>(std::lround(config.trackBaseRadiusPx * 1.3)) | 1, 11, 31);
+    options.maxMotionPx = static_cast<int>(std::lround(std::max(config.trackMaxRadiusPx, config.trackBaseRadiusPx + 1.0)));
+    options.track.maxStars = std::max(8, config.trackMaxStars);
+    options.track.minSeparationPx = std::max(4.0, config.trackMinSeparationPx);
+    options.track.edgeMarginPx = options.windowPx;
+    return options;
 }
 
-bool PoleMasterPolarAlignment::updateLockStarByGlobalTracking(const cv::Mat &currentGray8,
-                                                              const QVector<QPointF> &candidateStars,
-                                                              QPointF &updatedLockStar,
-                                                              double &confidence)
+bool PoleMasterPolarAlignment::reanchorTrackingBySolve(SolveFrame &frame)
 {
-    updatedLockStar = guidingLockStarPx;
-    confidence = guidingLockConfidence;
-    if (!guideGrayReady || previousGuideGray8.empty() || currentGray8.empty() || !isFinitePoint(guidingLockStarPx))
-        return false;
-    if (previousSelectedTrackStars.size() < 4 || candidateStars.size() < 4)
-        return false;
-
-    std::vector<cv::Point2f> prevPts;
-    prevPts.reserve(static_cast<size_t>(previousSelectedTrackStars.size()));
-    for (const QPointF &p : previousSelectedTrackStars)
-        prevPts.emplace_back(static_cast<float>(p.x()), static_cast<float>(p.y()));
-
-    std::vector<cv::Point2f> trackedPts;
-    std::vector<uchar> status;
-    std::vector<float> err;
-    cv::calcOpticalFlowPyrLK(previousGuideGray8, currentGray8, prevPts, trackedPts, status, err);
-    if (trackedPts.size() != prevPts.size() || status.empty())
-        return false;
-
-    const double adaptiveRadius = std::clamp(config.trackBaseRadiusPx + (1.0 - guidingLockConfidence) * 24.0,
-                                             config.trackBaseRadiusPx,
-                                             std::max(config.trackMaxRadiusPx, config.trackBaseRadiusPx + 1.0));
-
-    std::vector<cv::Point2f> srcPts;
-    std::vector<cv::Point2f> dstPts;
-    srcPts.reserve(prevPts.size());
-    dstPts.reserve(prevPts.size());
-    for (size_t i = 0; i < prevPts.size(); ++i)
+    QElapsedTimer solveTimer;
+    solveTimer.start();
+    SolveFrame solved;
+    if (!solveImage(frame.fitsPath) || !readSolveFrame(frame.fitsPath, frame.exposureMs, solved))
     {
-        if (status[i] == 0)
-            continue;
-        const QPointF lkPoint(trackedPts[i].x, trackedPts[i].y);
-        if (!isFinitePoint(lkPoint))
-            continue;
-
-        bool found = false;
-        QPointF best = lkPoint;
-        double bestDist = adaptiveRadius;
-        for (const QPointF &s : candidateStars)
-        {
-            const double d = std::hypot(s.x() - lkPoint.x(), s.y() - lkPoint.y());
-            if (d <= bestDist)
-            {
-                bestDist = d;
-                best = s;
-                found = true;
-            }
-        }
-        if (!found)
-            continue;
-
-        srcPts.emplace_back(prevPts[i].x, prevPts[i].y);
-        dstPts.emplace_back(static_cast<float>(best.x()), static_cast<float>(best.y()));
-    }
-
-    if (srcPts.size() < 4 || dstPts.size() < 4)
-        return false;
-
-    cv::Mat inliers;
-    const cv::Mat affine = cv::estimateAffinePartial2D(srcPts, dstPts, inliers, cv::RANSAC, 3.0, 2000, 0.99, 10);
-    if (affine.empty() || affine.rows != 2 || affine.cols != 3)
-        return false;
-
-    cv::Matx23d A;
-    for (int r = 0; r < 2; ++r)
-        for (int c = 0; c < 3; ++c)
-            A(r, c) = affine.at<double>(r, c);
-
-    const double x = guidingLockStarPx.x();
-    const double y = guidingLockStarPx.y();
-    const QPointF transformed(A(0, 0) * x + A(0, 1) * y + A(0, 2),
-                              A(1, 0) * x + A(1, 1) * y + A(1, 2));
-    if (!isFinitePoint(transformed))
-        return false;
-
-    QPointF best = transformed;
-    double bestDist = std::max(8.0, adaptiveRadius * 1.4);
-    bool snapped = false;
-    for (const QPointF &s : candidateStars)
-    {
-        const double d = std::hypot(s.x() - transformed.x(), s.y() - transformed.y());
-        if (d <= bestDist)
-        {
-            bestDist = d;
-            best = s;
-            snapped = true;
-        }
-    }
-
-    int inlierCount = 0;
-    for (int i = 0; i < inliers.rows; ++i)
-    {
-        if (inliers.at<uchar>(i, 0) != 0)
-            ++inlierCount;
-    }
-    const double inlierRatio = srcPts.empty() ? 0.0 : static_cast<double>(inlierCount) / static_cast<double>(srcPts.size());
-    const double snapScore = snapped ? std::clamp(1.0 - bestDist / std::max(1.0, adaptiveRadius * 1.4), 0.2, 1.0) : 0.2;
-    updatedLockStar = best;
-    confidence = std::clamp(0.65 * inlierRatio + 0.35 * snapScore, 0.3, 1.0);
-    return true;
-}
-
-bool PoleMasterPolarAlignment::recoverTrackingWithoutSolve(const QVector<QPointF> &candidateStars)
-{
-    if (candidateStars.isEmpty())
+        Logger::Log("PoleMasterPolarAlignment: tracking re-anchor solve failed, fitsPath=" + frame.fitsPath.toStdString(),
+                    LogLevel::WARNING,
+                    DeviceType::MAIN);
         return false;
-
-    if (isFinitePoint(guidingLockStarPx))
-    {
-        const double maxRecoverRadius = std::max(config.trackMaxRadiusPx * 2.0, 40.0);
-        for (const QPointF &s : candidateStars)
-        {
-            if (std::hypot(s.x() - guidingLockStarPx.x(), s.y() - guidingLockStarPx.y()) <= maxRecoverRadius)
-            {
-                guidingLockStarPx = s;
-                guidingLockConfidence = 0.5;
-                guidingLostFrames = 0;
-                return true;
-            }
-        }
     }
 
-    const double cx = guidanceImageW * 0.5;
-    const double cy = guidanceImageH * 0.5;
-    double bestScore = std::numeric_limits<double>::infinity();
-    QPointF best(-1.0, -1.0);
-    for (const QPointF &s : candidateStars)
-    {
-        const double score = std::hypot(s.x() - cx, s.y() - cy);
-        if (score < bestScore)
-        {
-            bestScore = score;
-            best = s;
-        }
-    }
-    if (!isFinitePoint(best))
+    // 锁定星沿用跟踪结果；当前帧的灰度与金字塔已在 track 时建好，直接作为新锚
+    const polar::Point2 lock{guidingLockStarPx.x(), guidingLockStarPx.y()};
+    if (!poleTracker.anchor(poleTracker.currentFrame(),
+                            toTrackPoints(frame.detectedStars),
+                            polar::Point2{solved.truePolePx.x(), solved.truePolePx.y()},
+                            lock))
         return false;
 
-    guidingLockStarPx = best;
-    guidingLockConfidence = 0.35;
-    guidingLostFrames = 0;
+    frame.wcsPath = solved.wcsPath;
+    frame.raDeg = solved.raDeg;
+    frame.decDeg = solved.decDeg;
+    frame.pixelScaleArcsecPerPixel = solved.pixelScaleArcsecPerPixel;
+    frame.northAngleDeg = solved.northAngleDeg;
+    frame.northAngleValid = solved.northAngleValid;
+    guidancePixelScaleArcsecPerPixel = solved.pixelScaleArcsecPerPixel > 0.0 ? solved.pixelScaleArcsecPerPixel : guidancePixelScaleArcsecPerPixel;
+    ++guidingSolveCount;
+    Logger::Log("PoleMasterPolarAlignment: tracking re-anchored by solve #" + std::to_string(guidingSolveCount) +
+                    " solveMs=" + std::to_string(solveTimer.elapsed()) +
+                    " pole=(" + std::to_string(solved.truePolePx.x()) + "," + std::to_string(solved.truePolePx.y()) + ")",
+                LogLevel::INFO,
+                DeviceType::MAIN);
     return true;
 }
 
@@ -1911,24 +1884,29 @@ bool PoleMasterPolarAlignment::initGuidingTrackingFromLastSolve()
     if (!chooseInitialLockStar(initFrame, selectedLock))
         return false;
 
-    cv::Mat gray8;
+    poleTracker.setOptions(trackingEngineOptions());
+    poleTracker.reset();
+    cv::Mat &gray8 = poleTracker.frameBuffer();
     int imageW = 0;
     int imageH = 0;
     if (!buildGray8FromFits(anchor.fitsPath, gray8, imageW, imageH))
         return false;
+    if (!poleTracker.anchor(gray8,
+                            toTrackPoints(initFrame.selectedTrackStars),
+                            polar::Point2{anchor.truePolePx.x(), anchor.truePolePx.y()},
+                            polar::Point2{selectedLock.x(), selectedLock.y()}))
+        return false;
 
     guidingLockStarPx = selectedLock;
-    guidingPoleOffsetPx = anchor.truePolePx - guidingLockStarPx;
     guidingLockConfidence = 1.0;
     guidingLostFrames = 0;
-    previousGuideGray8 = gray8.clone();
-    guideGrayReady = !previousGuideGray8.empty();
-    previousSelectedTrackStars = initFrame.selectedTrackStars;
+    guidingSolveCount = 0;
     guidanceImageW = anchor.imageW;
     guidanceImageH = anchor.imageH;
     guidancePixelScaleArcsecPerPixel = anchor.pixelScaleArcsecPerPixel > 0.0 ? anchor.pixelScaleArcsecPerPixel : 1.0;
     guidingTrackingInitialized = true;
 
+    initFrame.selectedTrackStars = toQPoints(poleTracker.trackPoints());
     initFrame.trackedLockStarPx = guidingLockStarPx;
     initFrame.lockConfidence = guidingLockConfidence;
     initFrame.trackingMode = "tracking-init";
@@ -1984,7 +1962,8 @@ bool PoleMasterPolarAlignment::captureAndTrackGuideFrame(SolveFrame &frame)
         return false;
     const qint64 waitCaptureMs = captureWaitTimer.elapsed();
 
-    cv::Mat gray8;
+    // 直接转换到跟踪引擎的下一帧缓冲，尺寸不变时不再分配
+    cv::Mat &gray8 = poleTracker.frameBuffer();
     int imageW = 0;
     int imageH = 0;
     QElapsedTimer fitsProcessTimer;
@@ -1999,38 +1978,35 @@ bool PoleMasterPolarAlignment::captureAndTrackGuideFrame(SolveFrame &frame)
     frame.pixelScaleArcsecPerPixel = guidancePixelScaleArcsecPerPixel;
     frame.exposureMs = exposureMs;
     frame.frameId = QFileInfo(lastCapturedImage).completeBaseName();
-    frame.trackingMode = "tracking-fused";
     enrichFrameDiagnostics(frame);
 
-    const QVector<int> selectedIdx = selectTrackingStarIndices(frame);
-    for (int idx : selectedIdx)
-        frame.selectedTrackStars.append(frame.detectedStars[idx]);
-
     const int starCount = frame.detectedStars.size();
     if (starCount < starCountLow)
         adaptiveGuidanceExposureMs = std::min(exposureMax, adaptiveGuidanceExposureMs + upStep);
     else if (starCount > starCountHigh)
         adaptiveGuidanceExposureMs = std::max(exposureMin, adaptiveGuidanceExposureMs - downStep);
 
-    QPointF updatedLock;
-    double updatedConfidence = guidingLockConfidence;
-    const bool tracked = updateLockStarByGlobalTracking(gray8, frame.selectedTrackStars, updatedLock, updatedConfidence);
-    frame.trackingMode = "tracking-global";
-    if (tracked)
+    // 一次光流跟踪全部跟踪星，锚定帧 → 当前帧刚体 RANSAC 推算天极；置信度连续不足才板解重新锚定
+    QElapsedTimer trackTimer;
+    trackTimer.start();
+    const polar::PoleTrackResult &track = poleTracker.track(gray8, toTrackPoints(frame.detectedStars));
+    const qint64 trackMs = trackTimer.elapsed();
+    bool poleValid = track.ok;
+    frame.trackingMode = "tracking-rigid";
+    if (track.solveRequested)
     {
-        guidingLockStarPx = updatedLock;
-        guidingLockConfidence = updatedConfidence;
-        guidingLostFrames = 0;
+        frame.trackingMode = "tracking-solve";
+        poleValid = reanchorTrackingBySolve(frame);
     }
+
+    if (poleValid)
+        guidingLostFrames = 0;
     else
-    {
         ++guidingLostFrames;
-        frame.trackingMode = "tracking-recover";
-        if (!recoverTrackingWithoutSolve(frame.selectedTrackStars))
-        {
-            guidingLockConfidence = std::max(0.0, guidingLockConfidence - 0.2);
-        }
-    }
+
+    const polar::PoleTrackResult &current = poleTracker.last();
+    guidingLockStarPx = toQPointF(current.lockStarPx);
+    guidingLockConfidence = current.confidence;
 
     if (guidingLostFrames > std::max(2, config.trackLostFrameLimit))
     {
@@ -2042,34 +2018,39 @@ bool PoleMasterPolarAlignment::captureAndTrackGuideFrame(SolveFrame &frame)
                     std::string(simulationMode ? "sim" : "real") +
                     " exposureMs=" + std::to_string(exposureMs) +
                     " stars=" + std::to_string(starCount) +
+                    " tracked=" + std::to_string(current.tracked) +
+                    " inliers=" + std::to_string(current.inliers) +
+                    " rmsPx=" + std::to_string(current.rmsPx) +
+                    " confidence=" + std::to_string(current.confidence) +
                     " captureDispatchMs=" + std::to_string(captureDispatchMs) +
                     " waitCaptureMs=" + std::to_string(waitCaptureMs) +
                     " fitsProcessMs=" + std::to_string(fitsProcessMs) +
+                    " pyramidMs=" + std::to_string(poleTracker.lastPyramidMs()) +
+                    " flowMs=" + std::to_string(poleTracker.lastFlowMs()) +
+                    " trackMs=" + std::to_string(trackMs) +
                     " totalMs=" + std::to_string(totalTimer.elapsed()) +
                     " fitsPath=" + lastCapturedImage.toStdString(),
                 LogLevel::INFO,
                 DeviceType::MAIN);
 
-    if (!isFinitePoint(guidingLockStarPx))
+    if (!poleValid || !isFinitePoint(guidingLockStarPx))
         return false;
 
+    frame.selectedTrackStars = toQPoints(poleTracker.trackPoints());
     frame.trackedLockStarPx = guidingLockStarPx;
     frame.lockConfidence = guidingLockConfidence;
+    const QPointF trackedPole = toQPointF(current.polePx);
     if (simulationMode)
     {
         // In simulation, guide error should follow the synthetic pole truth used
-        // by frame generation, not the lock-star anchored offset model.
+        // by frame generation, not the tracked pole.
         const QPointF simulatedPole = simulationPoleForCurrentState();
-        frame.truePolePx = isFinitePoint(simulatedPole) ? simulatedPole
-                                                        : (guidingLockStarPx + guidingPoleOffsetPx);
+        frame.truePolePx = isFinitePoint(simulatedPole) ? simulatedPole : trackedPole;
     }
     else
     {
-        frame.truePolePx = guidingLockStarPx + guidingPoleOffsetPx;
+        frame.truePolePx = trackedPole;
     }
-    previousGuideGray8 = gray8.clone();
-    guideGrayReady = !previousGuideGray8.empty();
-    previousSelectedTrackStars = frame.selectedTrackStars;
     emitOverlay("guiding", &frame);
     return true;
 }
@@ -2742,10 +2723,21 @@ QJsonArray PoleMasterAlignmentSimulation::generatedFixedStarsToJson(const SimSol
     inFrameList.reserve(stars.size());
     candidatesByStar.resize(stars.size());
 
+    const FixedStarProjection projection = projectFixedStars(frame.wcsPath, stars, frame.detectedStars);
+
     for (int i = 0; i < stars.size(); ++i)
     {
         QPointF expected;
-        const bool projected = skyToPixelFromWcs(frame.wcsPath, stars[i].raDeg, stars[i].decDeg, expected);
+        bool projected = false;
+        if (projection.local)
+        {
+            expected = QPointF(projection.starX[i], projection.starY[i]);
+            projected = projection.starFront[i] != 0 && isFinitePoint(expected);
+        }
+        else
+        {
+            projected = skyToPixelFromWcs(frame.wcsPath, stars[i].raDeg, stars[i].decDeg, expected);
+        }
         const bool inFrame = projected &&
             expected.x() >= 0.0 && expected.y() >= 0.0 &&
             expected.x() <= frame.imageW && expected.y() <= frame.imageH;
@@ -2764,11 +2756,10 @@ QJsonArray PoleMasterAlignmentSimulation::generatedFixedStarsToJson(const SimSol
             if (distancePx > kFixedStarMatchRadiusPx * 1.8)
                 continue;
 
-            bool ok = false;
-            const SphericalCoordinates sky = Tools::xy2rdByExternal(frame.wcsPath,
-                                                                    candidate.x(),
-                                                                    candidate.y(),
-                                                                    ok);
+            bool ok = projection.local;
+            const SphericalCoordinates sky = projection.local
+                ? SphericalCoordinates{projection.detectedRa[detectedIndex], projection.detectedDec[detectedIndex]}
+                : Tools::xy2rdByExternal(frame.wcsPath, candidate.x(), candidate.y(), ok);
             if (!ok || !std::isfinite(sky.ra) || !std::isfinite(sky.dec))
                 continue;
             const double distanceArcsec = angularDistanceArcsec(stars[i].raDeg, stars[i].decDeg,
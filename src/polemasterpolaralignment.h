@@ -13,6 +13,7 @@
 
 #include "myclient.h"
 #include "tools.h"
+#include "polar/PoleTrackingEngine.h"
 
 enum class PoleMasterAlignmentState {
     IDLE = 0,
@@ -148,14 +149,10 @@ private:
     bool emitCurrentGuide(const SolveFrame &frame);
     bool initGuidingTrackingFromLastSolve();
     bool captureAndTrackGuideFrame(SolveFrame &frame);
-    bool recoverTrackingWithoutSolve(const QVector<QPointF> &candidateStars);
+    bool reanchorTrackingBySolve(SolveFrame &frame);
+    polar::PoleTrackingEngineOptions trackingEngineOptions() const;
     QVector<int> selectTrackingStarIndices(const SolveFrame &frame) const;
     bool chooseInitialLockStar(const SolveFrame &frame, QPointF &selected) const;
-    bool updateLockStarByGlobalTracking(const cv::Mat &currentGray8,
-                                        const QVector<QPointF> &candidateStars,
-                                        QPointF &updatedLockStar,
-                                        double &confidence);
-    bool updateLockStarByTracking(const cv::Mat &currentGray8, const QVector<QPointF> &candidateStars, QPointF &updatedLockStar, double &confidence);
     QString buildHint(double dx, double dy) const;
     QString simulationScriptPath() const;
     int simulationScriptIndexForState() const;
@@ -183,6 +180,8 @@ private:
     QVector<SolveFrame> calibrationFrames;
     SolveFrame guidingAnchorFrame;
     bool hasGuidingAnchorFrame = false;
+    // 实时调整阶段的近先验跟踪解析（完整解析成功后锚定）
+    solver::TrackingSession trackingSession;
     QPointF axisCenterPx{-1.0, -1.0};
     double axisRadiusPx = 0.0;
     double axisResidualPx = 0.0;
@@ -197,16 +196,15 @@ private:
     QString lastCaptureFailureDetail;
     bool guidingTrackingInitialized = false;
     QPointF guidingLockStarPx{-1.0, -1.0};
-    QPointF guidingPoleOffsetPx{0.0, 0.0};
     double guidingLockConfidence = 0.0;
     int guidingLostFrames = 0;
     int adaptiveGuidanceExposureMs = 1000;
     int adaptiveSolveExposureMs = 0;
     bool guidanceExposureBootstrapped = false;
     bool guidanceExposureSeededFromSolve = false;
-    cv::Mat previousGuideGray8;
-    QVector<QPointF> previousSelectedTrackStars;
-    bool guideGrayReady = false;
+    // 实时调整阶段的多星刚体跟踪（金字塔/缓冲复用），置信度不足时才板解重新锚定
+    polar::PoleTrackingEngine poleTracker;
+    int guidingSolveCount = 0;
     int guidanceImageW = 0;
     int guidanceImageH = 0;
     double guidancePixelScaleArcsecPerPixel = 1.0;
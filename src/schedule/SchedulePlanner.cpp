@@ -0,0 +1,184 @@
+#include "SchedulePlanner.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace schedule {
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+constexpr double kDegToRad = kPi / 180.0;
+constexpr double kSiderealRate = 1.00273790935;   // 恒星时/平太阳时
+
+void addStep(TargetPlan& plan, StepKind kind, int frame, double& cursor, double seconds)
+{
+    PlanStep step;
+    step.kind = kind;
+    step.frame = frame;
+    step.startUnix = cursor;
+    step.endUnix = cursor + std::max(0.0, seconds);
+    cursor = step.endUnix;
+    plan.steps.push_back(step);
+}
+
+void sampleAltitude(TargetPlan& plan, const TargetSpec& spec, const Site& site, const PlanOptions& options)
+{
+    const double step = options.sampleStepSec > 1.0 ? options.sampleStepSec : 1.0;
+    plan.altitude.clear();
+    for (double t = plan.startUnix;; t += step) {
+        const bool last = t >= plan.endUnix;
+        const double at = last ? plan.endUnix : t;
+        plan.altitude.push_back({at, altitudeDeg(at, spec.raHours, spec.decDeg, site)});
+        if (last)
+            break;
+    }
+    plan.minAltDeg = plan.maxAltDeg = plan.altitude.front().altDeg;
+    for (const AltitudeSample& s : plan.altitude) {
+        plan.minAltDeg = std::min(plan.minAltDeg, s.altDeg);
+        plan.maxAltDeg = std::max(plan.maxAltDeg, s.altDeg);
+    }
+    // 上中天落在窗口内时，曲线最高点就是中天高度
+    if (plan.transitUnix >= plan.startUnix && plan.transitUnix <= plan.endUnix)
+        plan.maxAltDeg = std::max(plan.maxAltDeg, plan.transitAltDeg);
+    plan.lowAltitude = plan.minAltDeg < options.minAltitudeDeg;
+}
+
+} // namespace
+
+const char* stepKindName(StepKind kind)
+{
+    switch (kind)
+    {
+    case StepKind::Wait:     return "wait";
+    case StepKind::Slew:     return "mount";
+    case StepKind::Focus:    return "focus";
+    case StepKind::Filter:   return "filter";
+    case StepKind::Exposure: return "exposure";
+    case StepKind::Delay:    return "delay";
+    case StepKind::Flip:     return "flip";
+    default:                 return "unknown";
+    }
+}
+
+const TargetPlan* Plan::target(int index) const
+{
+    for (const TargetPlan& t : targets) {
+        if (t.index == index)
+            return &t;
+    }
+    return nullptr;
+}
+
+double gmstHours(double unixSec)
+{
+    const double JD = 2440587.5 + unixSec / 86400.0;
+    const double T = (JD - 2451545.0) / 36525.0;
+    double gmst = 280.46061837 + 360.98564736629 * (JD - 2451545.0) + 0.000387933 * T * T - T * T * T / 38710000.0;
+    gmst = std::fmod(gmst, 360.0);
+    if (gmst < 0)
+        gmst += 360.0;
+    return gmst / 15.0;
+}
+
+double lstHours(double unixSec, double longitudeEastDeg)
+{
+    const double lst = std::fmod(gmstHours(unixSec) + longitudeEastDeg / 15.0, 24.0);
+    return lst < 0 ? lst + 24.0 : lst;
+}
+
+double hourAngleHours(double lst, double raHours)
+{
+    double ha = std::fmod(lst - raHours, 24.0);
+    if (ha < 0)
+        ha += 24.0;
+    if (ha >= 12.0)
+        ha -= 24.0;
+    return ha;
+}
+
+double altitudeDeg(double unixSec, double raHours, double decDeg, const Site& site)
+{
+    const double ha = hourAngleHours(lstHours(unixSec, site.longitudeDeg), raHours) * 15.0 * kDegToRad;
+    const double lat = site.latitudeDeg * kDegToRad;
+    const double dec = decDeg * kDegToRad;
+    const double s = std::sin(lat) * std::sin(dec) + std::cos(lat) * std::cos(dec) * std::cos(ha);
+    return std::asin(std::max(-1.0, std::min(1.0, s))) / kDegToRad;
+}
+
+double nextTransitUnix(double fromUnix, double raHours, double longitudeEastDeg)
+{
+    const double ha = hourAngleHours(lstHours(fromUnix, longitudeEastDeg), raHours);
+    const double siderealHours = ha <= 0 ? -ha : 24.0 - ha;
+    return fromUnix + siderealHours * 3600.0 / kSiderealRate;
+}
+
+Plan buildPlan(const std::vector<TargetSpec>& targets, const Site& site, double startUnix,
+               const PlanOptions& options, size_t first)
+{
+    Plan plan;
+    plan.site = site;
+    plan.options = options;
+    plan.startUnix = plan.endUnix = startUnix;
+
+    double cursor = startUnix;
+    int currentFilter = 0;   // 计划开始时滤镜位未知，第一行有滤镜就按一次换滤镜计
+
+    for (size_t i = first; i < targets.size(); ++i) {
+        const TargetSpec& spec = targets[i];
+        TargetPlan tp;
+        tp.index = static_cast<int>(i);
+        tp.startUnix = cursor;
+
+        if (spec.notBeforeUnix > cursor)
+            addStep(tp, StepKind::Wait, 0, cursor, spec.notBeforeUnix - cursor);
+        addStep(tp, StepKind::Slew, 0, cursor, options.slewSec);
+        // 执行顺序与 startSetCFW 一致：先对焦再换滤镜
+        if (spec.refocus)
+            addStep(tp, StepKind::Focus, 0, cursor, options.refocusSec);
+        if (spec.filter > 0 && spec.filter != currentFilter) {
+            addStep(tp, StepKind::Filter, 0, cursor, options.filterChangeSec);
+            currentFilter = spec.filter;
+        }
+
+        tp.exposureStartUnix = cursor;
+        if (site.valid) {
+            tp.eastAtStart = hourAngleHours(lstHours(cursor, site.longitudeDeg), spec.raHours) < 0;
+            tp.transitUnix = nextTransitUnix(cursor, spec.raHours, site.longitudeDeg);
+            tp.transitAltDeg = 90.0 - std::fabs(site.latitudeDeg - spec.decDeg);
+        }
+
+        const double frameSec = std::max(0, spec.exposureMs) / 1000.0 + options.downloadSec;
+        const int repeat = std::max(1, spec.repeat);
+        for (int k = 1; k <= repeat; ++k) {
+            if (tp.flipBeforeFrame == 0 && flipDueBeforeNextFrame(tp, options, cursor, frameSec)) {
+                // 翻转要等目标真正过了子午线，GOTO 才会换到另一侧
+                if (tp.transitUnix > cursor)
+                    addStep(tp, StepKind::Wait, k, cursor, tp.transitUnix - cursor);
+                tp.flipBeforeFrame = k;
+                tp.flipUnix = cursor;
+                addStep(tp, StepKind::Flip, k, cursor, options.flipSec);
+            }
+            addStep(tp, StepKind::Exposure, k, cursor, frameSec);
+            if (k < repeat && spec.exposureDelayMs > 0)
+                addStep(tp, StepKind::Delay, k, cursor, spec.exposureDelayMs / 1000.0);
+        }
+
+        tp.endUnix = cursor;
+        if (site.valid)
+            sampleAltitude(tp, spec, site, options);
+        plan.targets.push_back(std::move(tp));
+    }
+
+    plan.endUnix = cursor;
+    return plan;
+}
+
+bool flipDueBeforeNextFrame(const TargetPlan& target, const PlanOptions& options, double nowUnix, double frameSec)
+{
+    if (!target.eastAtStart || target.transitUnix <= 0)
+        return false;
+    return nowUnix + frameSec > target.transitUnix + options.pastMeridianMin * 60.0;
+}
+
+} // namespace schedule
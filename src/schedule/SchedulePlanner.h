@@ -0,0 +1,111 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace schedule {
+
+// 观测站（度，东经+、北纬+）；valid=false 时只排时长，不算高度/中天/翻转
+struct Site {
+    double latitudeDeg{0.0};
+    double longitudeDeg{0.0};
+    bool valid{false};
+};
+
+// 计划表的一行（与 ScheduleData 对应，时间约束已换算成绝对时刻）
+struct TargetSpec {
+    std::string name;
+    double raHours{0.0};
+    double decDeg{0.0};
+    double notBeforeUnix{0.0};   ///< 最早开始时刻（UTC 秒）；0 表示不等待
+    int exposureMs{1000};
+    int repeat{1};
+    int exposureDelayMs{0};
+    int filter{0};               ///< 滤镜位；<=0 表示不换
+    bool refocus{false};
+};
+
+// 各步骤的耗时估计（秒）和翻转规则
+struct PlanOptions {
+    double slewSec{60.0};            ///< GOTO + 稳定
+    double refocusSec{240.0};
+    double filterChangeSec{8.0};
+    double downloadSec{3.0};         ///< 每帧读出 + 保存
+    double flipSec{120.0};           ///< 翻转（重新 GOTO 到同一目标）
+    double pastMeridianMin{5.0};     ///< 过中天后赤道仪还能继续跟踪的分钟数，帧必须在此之前结束
+    double sampleStepSec{900.0};     ///< 高度曲线采样间隔
+    double minAltitudeDeg{15.0};     ///< 低于此高度标记 lowAltitude
+};
+
+enum class StepKind {
+    Wait,
+    Slew,
+    Focus,
+    Filter,
+    Exposure,
+    Delay,
+    Flip,
+};
+
+const char* stepKindName(StepKind kind);
+
+struct PlanStep {
+    StepKind kind{StepKind::Wait};
+    int frame{0};            ///< Exposure/Delay/Flip 对应的帧号（从 1 开始），其余为 0
+    double startUnix{0.0};
+    double endUnix{0.0};
+};
+
+struct AltitudeSample {
+    double unix{0.0};
+    double altDeg{0.0};
+};
+
+struct TargetPlan {
+    int index{0};                 ///< 计划表行号
+    double startUnix{0.0};
+    double endUnix{0.0};
+    double exposureStartUnix{0.0};
+    std::vector<PlanStep> steps;
+
+    // 以下仅 Site::valid 时有效
+    std::vector<AltitudeSample> altitude;   ///< 从开始到结束按 sampleStepSec 采样（含两端）
+    double minAltDeg{0.0};
+    double maxAltDeg{0.0};
+    bool lowAltitude{false};
+    double transitUnix{0.0};       ///< 开始拍摄后的下一次上中天；0 表示无效
+    double transitAltDeg{0.0};
+    bool eastAtStart{false};       ///< 开始拍摄时目标在子午线以东（时角<0），过中天后需要翻转
+    int flipBeforeFrame{0};        ///< 在第 N 帧开始前翻转；0 表示窗口内不需要
+    double flipUnix{0.0};
+
+    double durationSec() const { return endUnix - startUnix; }
+};
+
+struct Plan {
+    Site site;
+    PlanOptions options;
+    double startUnix{0.0};
+    double endUnix{0.0};
+    std::vector<TargetPlan> targets;
+
+    // 按计划表行号查找；不在计划内返回 nullptr
+    const TargetPlan* target(int index) const;
+};
+
+// 星历（与 MainWindow::computeGMST/computeLST 同一公式）
+double gmstHours(double unixSec);
+double lstHours(double unixSec, double longitudeEastDeg);
+double hourAngleHours(double lstHours, double raHours);   ///< 归一化到 [-12, 12)
+double altitudeDeg(double unixSec, double raHours, double decDeg, const Site& site);
+double nextTransitUnix(double fromUnix, double raHours, double longitudeEastDeg);
+
+// 从 startUnix 起为 targets[first..] 排时间线；之前的行不出现在结果里
+Plan buildPlan(const std::vector<TargetSpec>& targets, const Site& site, double startUnix,
+               const PlanOptions& options = PlanOptions(), size_t first = 0);
+
+// 执行期判断：按实际时钟，下一帧（frameSec 含读出）若会跨过 中天+pastMeridianMin，就应在这一帧前翻转
+bool flipDueBeforeNextFrame(const TargetPlan& target, const PlanOptions& options, double nowUnix, double frameSec);
+
+} // namespace schedule
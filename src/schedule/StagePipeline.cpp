@@ -0,0 +1,162 @@
+#include "StagePipeline.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace schedule {
+
+namespace {
+
+int slot(Stage stage)
+{
+    return static_cast<int>(stage);
+}
+
+} // namespace
+
+const char* stageName(Stage stage)
+{
+    switch (stage)
+    {
+    case Stage::Slew:     return "slew";
+    case Stage::Filter:   return "filter";
+    case Stage::Focus:    return "focus";
+    case Stage::Exposure: return "exposure";
+    case Stage::Write:    return "write";
+    case Stage::Solve:    return "solve";
+    default:              return "unknown";
+    }
+}
+
+bool dependsOn(Stage stage, Stage prerequisite)
+{
+    switch (stage)
+    {
+    case Stage::Focus:
+        return prerequisite == Stage::Slew || prerequisite == Stage::Filter;
+    case Stage::Exposure:
+        return prerequisite == Stage::Slew || prerequisite == Stage::Filter || prerequisite == Stage::Focus;
+    case Stage::Write:
+        return prerequisite == Stage::Exposure;
+    case Stage::Solve:
+        return prerequisite == Stage::Write;
+    default:
+        return false;
+    }
+}
+
+bool mayOverlap(Stage a, Stage b)
+{
+    if (a == b)
+        return false;   // 同一设备/同一工作线程
+    // Write/Solve 只占写盘线程和求解线程，与任何阶段都能并行（处理的是已经曝光完的帧）
+    if (a == Stage::Write || a == Stage::Solve || b == Stage::Write || b == Stage::Solve)
+        return true;
+    // 设备动作之间只有 Slew 与 Filter 是两台互不影响的设备
+    return (a == Stage::Slew && b == Stage::Filter) || (a == Stage::Filter && b == Stage::Slew);
+}
+
+void OverheadTracker::reset(int64_t startMs)
+{
+    m_spans.clear();
+    m_startMs = startMs;
+    m_finishMs = -1;
+    m_skippedSolves = 0;
+}
+
+void OverheadTracker::begin(Stage stage, int frame, int64_t nowMs)
+{
+    if (isOpen(stage, frame))
+        return;
+    m_spans.push_back({stage, frame, nowMs, -1});
+}
+
+void OverheadTracker::end(Stage stage, int frame, int64_t nowMs)
+{
+    for (Span& span : m_spans) {
+        if (span.stage == stage && span.frame == frame && span.endMs < 0) {
+            span.endMs = std::max(nowMs, span.startMs);
+            return;
+        }
+    }
+}
+
+bool OverheadTracker::isOpen(Stage stage, int frame) const
+{
+    for (const Span& span : m_spans) {
+        if (span.stage == stage && span.frame == frame && span.endMs < 0)
+            return true;
+    }
+    return false;
+}
+
+void OverheadTracker::finish(int64_t nowMs)
+{
+    if (m_finishMs < 0)
+        m_finishMs = nowMs;
+}
+
+bool OverheadTracker::idle() const
+{
+    for (const Span& span : m_spans) {
+        if (span.endMs < 0)
+            return false;
+    }
+    return true;
+}
+
+OverheadTracker::Report OverheadTracker::report() const
+{
+    Report r;
+    r.skippedSolves = m_skippedSolves;
+    if (m_startMs < 0)
+        return r;
+
+    int64_t endMs = m_finishMs;
+    if (endMs < 0) {
+        endMs = m_startMs;
+        for (const Span& span : m_spans)
+            endMs = std::max(endMs, span.endMs);
+    }
+    r.wallMs = endMs - m_startMs;
+
+    std::vector<std::pair<int64_t, int64_t>> clipped;
+    int64_t total = 0;
+    for (const Span& span : m_spans) {
+        if (span.endMs < 0)
+            continue;
+        const int64_t duration = span.endMs - span.startMs;
+        r.stageMs[slot(span.stage)] += duration;
+        ++r.stageCount[slot(span.stage)];
+        total += duration;
+        const int64_t a = std::max(span.startMs, m_startMs);
+        const int64_t b = std::min(span.endMs, endMs);
+        if (b > a)
+            clipped.emplace_back(a, b);
+    }
+
+    std::sort(clipped.begin(), clipped.end());
+    int64_t curStart = -1;
+    int64_t curEnd = -1;
+    for (const auto& iv : clipped) {
+        if (curEnd < 0 || iv.first > curEnd) {
+            if (curEnd >= 0)
+                r.busyMs += curEnd - curStart;
+            curStart = iv.first;
+            curEnd = iv.second;
+        } else {
+            curEnd = std::max(curEnd, iv.second);
+        }
+    }
+    if (curEnd >= 0)
+        r.busyMs += curEnd - curStart;
+
+    r.idleMs = std::max<int64_t>(0, r.wallMs - r.busyMs);
+    r.exposureMs = r.stageMs[slot(Stage::Exposure)];
+    r.overheadMs = std::max<int64_t>(0, r.wallMs - r.exposureMs);
+    r.sequentialMs = total + r.idleMs;
+    r.removedMs = std::max<int64_t>(0, r.sequentialMs - r.wallMs);
+    return r;
+}
+
+} // namespace schedule
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace schedule {
+
+// 计划表一行里的执行阶段
+enum class Stage {
+    Slew,
+    Filter,
+    Focus,
+    Exposure,
+    Write,     ///< 归档 FITS 写盘（后台写盘线程）
+    Solve,     ///< 已归档帧的解析（常驻求解服务）
+};
+
+constexpr int kStageCount = 6;
+
+const char* stageName(Stage stage);
+
+// 依赖规则（同一行内）：
+//   Filter   与 Slew 无关，在转动开始时一起下发
+//   Focus    在目标处、目标滤镜下对焦：等 Slew、Filter
+//   Exposure 等 Slew、Filter、Focus；与前几帧的 Write/Solve 并行
+//   Write    等本帧 Exposure；与下一帧曝光、下一行转动并行
+//   Solve    等本帧 Write；与下一帧曝光并行，同一时刻最多一个
+// 下一行的 Slew/Filter 只等本行最后一帧 Exposure，不等其 Write/Solve。
+//
+// prerequisite 必须在 stage 开始前完成（同一帧）
+bool dependsOn(Stage stage, Stage prerequisite);
+// a 进行中时可以开始 b（对称；Write/Solve 处理的是前一帧，因此可与下一帧的 Exposure 并行）
+bool mayOverlap(Stage a, Stage b);
+
+// 按阶段记录一行的执行区间，行结束后统计流水线省掉的等待：
+//   sequentialMs = 各阶段耗时之和 + 空闲（严格串行时的行耗时）
+//   removedMs    = sequentialMs - wallMs = 各阶段耗时之和 - 区间并集
+class OverheadTracker
+{
+public:
+    struct Report {
+        int64_t wallMs{0};          ///< 行开始到最后一帧曝光结束
+        int64_t busyMs{0};          ///< 所有阶段区间的并集（裁剪到行内）
+        int64_t idleMs{0};          ///< wallMs - busyMs（等待时间、状态轮询间隙）
+        int64_t exposureMs{0};
+        int64_t overheadMs{0};      ///< wallMs - exposureMs
+        int64_t sequentialMs{0};
+        int64_t removedMs{0};
+        int64_t stageMs[kStageCount]{};
+        int stageCount[kStageCount]{};
+        int skippedSolves{0};
+    };
+
+    void reset(int64_t startMs);
+    void begin(Stage stage, int frame, int64_t nowMs);
+    // 没有对应的进行中区间时忽略（便于在多个出口重复调用）
+    void end(Stage stage, int frame, int64_t nowMs);
+    bool isOpen(Stage stage, int frame) const;
+    // 最后一帧曝光结束：行的墙钟时间到此为止，尾部的 Write/Solve 继续计入阶段耗时
+    void finish(int64_t nowMs);
+    void noteSkippedSolve() { ++m_skippedSolves; }
+
+    bool started() const { return m_startMs >= 0; }
+    bool finished() const { return m_finishMs >= 0; }
+    bool idle() const;          ///< 没有进行中的区间
+    Report report() const;      ///< finish 之前调用按最后一个已结束区间计
+
+private:
+    struct Span {
+        Stage stage;
+        int frame;
+        int64_t startMs;
+        int64_t endMs;          ///< <0 表示进行中
+    };
+
+    std::vector<Span> m_spans;
+    int64_t m_startMs{-1};
+    int64_t m_finishMs{-1};
+    int m_skippedSolves{0};
+};
+
+} // namespace schedule
@@ -10,11 +10,10 @@
 #include <mutex>
 #include <memory>
 #include <atomic>
+#include <limits>
+#include <typeinfo>
 #include <unordered_map>
 
-// 使用注册宏将驱动名与实现绑定（只在此翻译单元生成一次）
-REGISTER_SDK_DRIVER(SDK_DRIVER_NAME_INDI_QHY_CCD, QhyCameraDriver)
-
 namespace {
 struct LiveBufferCache {
     // 说明：
@@ -102,8 +101,184 @@ static std::string qhyBayerIdToCfaString(unsigned int bayerId) {
 }
 } // namespace
 
+// 命令表：下标即命令 id（SdkCommandId）。
+// - 构造（驱动注册）时建立一次 name -> id 映射，此后调用方/SdkManager 可预解析 id，热路径按下标直接分派；
+// - 句柄非空、payload 类型在 executeById() 中按表统一校验一次，处理函数内直接取值。
+// 新增命令：在此表追加一行并实现对应的 cmdXxx 处理函数即可，commandList()/capabilities() 自动同步。
+const QhyCameraDriver::CommandEntry QhyCameraDriver::kCommandTable[] = {
+    {"GetSdkVersion", &QhyCameraDriver::cmdGetSdkVersion,
+     "获取 QHYCCD SDK 版本号字符串",
+     nullptr, nullptr, false, SdkCommandFlagNone},
+    {"GetFirmwareVersion", &QhyCameraDriver::cmdGetFirmwareVersion,
+     "获取当前相机固件版本信息",
+     nullptr, nullptr, true, SdkCommandFlagNone},
+    {"InitSdkResource", &QhyCameraDriver::cmdInitSdkResource,
+     "初始化 QHYCCD SDK 全局资源（无需句柄）",
+     nullptr, nullptr, false, SdkCommandFlagNone},
+    {"ReleaseSdkResource", &QhyCameraDriver::cmdReleaseSdkResource,
+     "释放 QHYCCD SDK 全局资源（无需句柄）",
+     nullptr, nullptr, false, SdkCommandFlagNone},
+    {"ScanCameras", &QhyCameraDriver::cmdScanCameras,
+     "扫描当前连接的 QHYCCD 相机数量",
+     nullptr, nullptr, false, SdkCommandFlagNone},
+    {"GetCameraIdByIndex", &QhyCameraDriver::cmdGetCameraIdByIndex,
+     "根据索引获取相机 ID，payload 传入 int 索引",
+     &typeid(int), "index", false, SdkCommandFlagNone},
+    {"SetReadMode", &QhyCameraDriver::cmdSetReadMode,
+     "设置读出模式（SetQHYCCDReadMode），payload 传入 int readMode（通常为 0）",
+     &typeid(int), "readMode", true, SdkCommandFlagKeyInit},
+    {"SetStreamMode", &QhyCameraDriver::cmdSetStreamMode,
+     "设置图像流模式，例如单帧模式，payload 传入 int 模式值",
+     &typeid(int), "mode", true, SdkCommandFlagKeyInit},
+    {"InitCamera", &QhyCameraDriver::cmdInitCamera,
+     "初始化相机（InitQHYCCD），需已打开相机句柄",
+     nullptr, nullptr, true, SdkCommandFlagKeyInit},
+    {"GetOverScanArea", &QhyCameraDriver::cmdGetOverScanArea,
+     "获取相机 OverScan 区域信息，返回 SdkAreaInfo",
+     nullptr, nullptr, true, SdkCommandFlagNone},
+    {"GetEffectiveArea", &QhyCameraDriver::cmdGetEffectiveArea,
+     "获取相机有效成像区域信息，返回 SdkAreaInfo",
+     nullptr, nullptr, true, SdkCommandFlagNone},
+    {"GetChipInfo", &QhyCameraDriver::cmdGetChipInfo,
+     "获取芯片物理尺寸、像素尺寸、最大分辨率等信息，返回 SdkChipInfo",
+     nullptr, nullptr, true, SdkCommandFlagNone},
+    {"SetDDR", &QhyCameraDriver::cmdSetDDR,
+     "设置相机 DDR 模式（CONTROL_DDR），payload 传入 double（通常为 1.0）",
+     &typeid(double), "ddr", true, SdkCommandFlagNone},
+    {"SetDebayerOnOff", &QhyCameraDriver::cmdSetDebayerOnOff,
+     "设置去拜耳开关（SetQHYCCDDebayerOnOff），payload 传入 bool",
+     &typeid(bool), "debayerOn", true, SdkCommandFlagNone},
+    {"SetUsbTraffic", &QhyCameraDriver::cmdSetUsbTraffic,
+     "设置 USB 传输级别，payload 传入 double usbTraffic",
+     &typeid(double), "usbTraffic", true, SdkCommandFlagNone},
+    {"SetGain", &QhyCameraDriver::cmdSetGain,
+     "设置增益，payload 传入 double gain",
+     &typeid(double), "gain", true, SdkCommandFlagNone},
+    {"SetOffset", &QhyCameraDriver::cmdSetOffset,
+     "设置偏置，payload 传入 double offset",
+     &typeid(double), "offset", true, SdkCommandFlagNone},
+    {"SetExposure", &QhyCameraDriver::cmdSetExposure,
+     "设置曝光时间（微秒），payload 传入 double exposure",
+     &typeid(double), "exposure", true, SdkCommandFlagNone},
+    {"GetUsbTraffic", &QhyCameraDriver::cmdGetUsbTraffic,
+     "获取 USBTraffic 的最小值/最大值/步进/当前值（SdkControlParamInfo）",
+     nullptr, nullptr, true, SdkCommandFlagNone},
+    {"GetGain", &QhyCameraDriver::cmdGetGain,
+     "获取增益的最小值/最大值/步进/当前值（SdkControlParamInfo）",
+     nullptr, nullptr, true, SdkCommandFlagNone},
+    {"GetOffset", &QhyCameraDriver::cmdGetOffset,
+     "获取偏置的最小值/最大值/步进/当前值（SdkControlParamInfo）",
+     nullptr, nullptr, true, SdkCommandFlagNone},
+    {"GetExposure", &QhyCameraDriver::cmdGetExposure,
+     "获取曝光时间（微秒）的最小值/最大值/步进/当前值（SdkControlParamInfo）",
+     nullptr, nullptr, true, SdkCommandFlagNone},
+    {"SetResolution", &QhyCameraDriver::cmdSetResolution,
+     "设置 ROI/分辨率，payload 传入 SdkAreaInfo",
+     &typeid(SdkAreaInfo), "roi", true, SdkCommandFlagNone},
+    {"SetBinMode", &QhyCameraDriver::cmdSetBinMode,
+     "设置 Bin 模式，payload 传入 std::pair<int,int> (binX, binY)",
+     &typeid(std::pair<int,int>), "binMode", true, SdkCommandFlagNone},
+    {"SetBitsMode", &QhyCameraDriver::cmdSetBitsMode,
+     "设置位深模式，payload 传入 int bits（一般为 16）",
+     &typeid(int), "bits", true, SdkCommandFlagNone},
+    {"GetBitsMode", &QhyCameraDriver::cmdGetBitsMode,
+     "获取位深模式的最小值/最大值/步进/当前值（SdkControlParamInfo）",
+     nullptr, nullptr, true, SdkCommandFlagNone},
+    {"StartSingleExposure", &QhyCameraDriver::cmdStartSingleExposure,
+     "启动单帧曝光（ExpQHYCCDSingleFrame）",
+     nullptr, nullptr, true, SdkCommandFlagCaptureTrace},
+    {"GetMemLength", &QhyCameraDriver::cmdGetMemLength,
+     "获取单帧图像所需的缓冲区长度，返回 uint32_t",
+     nullptr, nullptr, true, SdkCommandFlagNone},
+    {"GetSingleFrame", &QhyCameraDriver::cmdGetSingleFrame,
+     "读取单帧图像数据，SdkFrameData 经 SdkResult::frame 返回（16 位单通道）",
+     nullptr, nullptr, true, SdkCommandFlagNone},
+    {"BeginLive", &QhyCameraDriver::cmdBeginLive,
+     "进入 Live 连续采集（BeginQHYCCDLive），需先 SetStreamMode=1",
+     nullptr, nullptr, true, SdkCommandFlagNone},
+    {"GetLiveFrame", &QhyCameraDriver::cmdGetLiveFrame,
+     "读取一帧 Live 图像数据（GetQHYCCDLiveFrame），SdkFrameData 经 SdkResult::frame 返回",
+     nullptr, nullptr, true, SdkCommandFlagQuiet},
+    {"GetLiveFrameFast", &QhyCameraDriver::cmdGetLiveFrameFast,
+     "读取一帧 Live 图像数据（GetQHYCCDLiveFrame），复用缓冲区且不拷贝 pixels（仅经 SdkResult::frame 返回 meta）",
+     nullptr, nullptr, true, SdkCommandFlagQuiet},
+    {"StopLive", &QhyCameraDriver::cmdStopLive,
+     "停止 Live 连续采集（StopQHYCCDLive）",
+     nullptr, nullptr, true, SdkCommandFlagNone},
+    {"EnableBurstMode", &QhyCameraDriver::cmdEnableBurstMode,
+     "开启/关闭 Burst 子模式（EnableQHYCCDBurstMode），payload=bool",
+     &typeid(bool), "enable", true, SdkCommandFlagNone},
+    {"SetBurstStartEnd", &QhyCameraDriver::cmdSetBurstStartEnd,
+     "设置 Burst start/end（SetQHYCCDBurstModeStartEnd），payload=std::pair<int,int>",
+     &typeid(std::pair<int,int>), "startEnd", true, SdkCommandFlagNone},
+    {"ResetFrameCounter", &QhyCameraDriver::cmdResetFrameCounter,
+     "复位帧计数器（ResetQHYCCDFrameCounter）",
+     nullptr, nullptr, true, SdkCommandFlagNone},
+    {"SetBurstIDLE", &QhyCameraDriver::cmdSetBurstIDLE,
+     "进入 Burst IDLE 状态（SetQHYCCDBurstIDLE）",
+     nullptr, nullptr, true, SdkCommandFlagNone},
+    {"ReleaseBurstIDLE", &QhyCameraDriver::cmdReleaseBurstIDLE,
+     "释放 Burst IDLE 触发输出（ReleaseQHYCCDBurstIDLE）",
+     nullptr, nullptr, true, SdkCommandFlagNone},
+    {"SetBurstPatchNumber", &QhyCameraDriver::cmdSetBurstPatchNumber,
+     "设置 Burst 补包数据量（SetQHYCCDBurstModePatchNumber），payload=uint32_t",
+     &typeid(uint32_t), "patchNumber", true, SdkCommandFlagNone},
+    {"CheckSingleFrameModeAvailable", &QhyCameraDriver::cmdCheckSingleFrameModeAvailable,
+     "检测是否支持单帧模式（IsQHYCCDControlAvailable CAM_SINGLEFRAMEMODE），返回 bool",
+     nullptr, nullptr, true, SdkCommandFlagNone},
+    {"IsColorCamera", &QhyCameraDriver::cmdIsColorCamera,
+     "检测当前相机是否为彩色相机（CAM_IS_COLOR），返回 bool",
+     nullptr, nullptr, true, SdkCommandFlagNone},
+    {"GetCameraCfa", &QhyCameraDriver::cmdGetCameraCfa,
+     "按 CAM_IS_COLOR -> SetQHYCCDDebayerOnOff(true) -> CAM_COLOR 获取 CFA，返回 std::string",
+     nullptr, nullptr, true, SdkCommandFlagNone},
+    {"GetCurrentTemperature", &QhyCameraDriver::cmdGetCurrentTemperature,
+     "获取当前 CMOS/CCD 温度（CONTROL_CURTEMP），返回 double",
+     nullptr, nullptr, true, SdkCommandFlagQuiet},
+    {"SetCoolerTargetTemperature", &QhyCameraDriver::cmdSetCoolerTargetTemperature,
+     "设置制冷目标温度（CONTROL_COOLER），payload 传入 double 摄氏度",
+     &typeid(double), "targetTemperature", true, SdkCommandFlagNone},
+    {"GetCoolerTargetTemperature", &QhyCameraDriver::cmdGetCoolerTargetTemperature,
+     "获取制冷目标温度的最小值/最大值/步进/当前值（SdkControlParamInfo）",
+     nullptr, nullptr, true, SdkCommandFlagNone},
+    {"GetCoolerPower", &QhyCameraDriver::cmdGetCoolerPower,
+     "获取当前制冷 PWM 功率百分比（GetQHYCCDParam CONTROL_CURPWM），返回 double",
+     nullptr, nullptr, true, SdkCommandFlagQuiet},
+    {"CancelExposure", &QhyCameraDriver::cmdCancelExposure,
+     "取消当前曝光与读出（CancelQHYCCDExposingAndReadout）",
+     nullptr, nullptr, true, SdkCommandFlagNone},
+    {"IsCFWPlugged", &QhyCameraDriver::cmdIsCFWPlugged,
+     "检测相机是否连接了滤镜轮（CFW），返回 bool",
+     nullptr, nullptr, true, SdkCommandFlagNone},
+    {"GetCFWSlotsNum", &QhyCameraDriver::cmdGetCFWSlotsNum,
+     "获取滤镜轮的槽位数量（CONTROL_CFWSLOTSNUM），返回 int",
+     nullptr, nullptr, true, SdkCommandFlagNone},
+    {"GetCFWPosition", &QhyCameraDriver::cmdGetCFWPosition,
+     "获取当前滤镜轮位置（CONTROL_CFWPORT），返回 int（0 开始）",
+     nullptr, nullptr, true, SdkCommandFlagNone},
+    {"SetCFWPosition", &QhyCameraDriver::cmdSetCFWPosition,
+     "设置滤镜轮位置（CONTROL_CFWPORT），payload 传入 int 位置（0 开始）",
+     &typeid(int), "position", true, SdkCommandFlagNone},
+    {"SendOrderToCFW", &QhyCameraDriver::cmdSendOrderToCFW,
+     "发送自定义命令到滤镜轮，payload 传入 std::string order",
+     &typeid(std::string), "order", true, SdkCommandFlagNone},
+    {"GetCFWStatus", &QhyCameraDriver::cmdGetCFWStatus,
+     "获取滤镜轮状态字符串，返回 std::string",
+     nullptr, nullptr, true, SdkCommandFlagNone},
+};
+
+const size_t QhyCameraDriver::kCommandCount = sizeof(kCommandTable) / sizeof(kCommandTable[0]);
+
+// 使用注册宏将驱动名与实现绑定（只在此翻译单元生成一次）
+// 注意：注册器在静态初始化阶段构造驱动并读取命令表，必须定义在命令表之后。
+REGISTER_SDK_DRIVER(SDK_DRIVER_NAME_INDI_QHY_CCD, QhyCameraDriver)
+
 QhyCameraDriver::QhyCameraDriver()
 {
+    m_commandIds.reserve(kCommandCount);
+    for (size_t i = 0; i < kCommandCount; ++i) {
+        m_commandIds.emplace(kCommandTable[i].name, static_cast<SdkCommandId>(i));
+    }
 }
 
 QhyCameraDriver::~QhyCameraDriver()
@@ -118,61 +293,12 @@ std::vector<std::string> QhyCameraDriver::driverNames() const
 
 std::vector<SdkCommandInfo> QhyCameraDriver::commandList() const
 {
-    return {
-        {"GetSdkVersion",                "获取 QHYCCD SDK 版本号字符串"},
-        {"GetFirmwareVersion",           "获取当前相机固件版本信息"},
-        {"InitSdkResource",              "初始化 QHYCCD SDK 全局资源（无需句柄）"},
-        {"ReleaseSdkResource",           "释放 QHYCCD SDK 全局资源（无需句柄）"},
-        {"ScanCameras",                  "扫描当前连接的 QHYCCD 相机数量"},
-        {"GetCameraIdByIndex",           "根据索引获取相机 ID，payload 传入 int 索引"},
-        {"SetReadMode",                  "设置读出模式（SetQHYCCDReadMode），payload 传入 int readMode（通常为 0）"},
-        {"SetStreamMode",                "设置图像流模式，例如单帧模式，payload 传入 int 模式值"},
-        {"InitCamera",                   "初始化相机（InitQHYCCD），需已打开相机句柄"},
-        {"GetOverScanArea",              "获取相机 OverScan 区域信息，返回 SdkAreaInfo"},
-        {"GetEffectiveArea",             "获取相机有效成像区域信息，返回 SdkAreaInfo"},
-        {"GetChipInfo",                  "获取芯片物理尺寸、像素尺寸、最大分辨率等信息，返回 SdkChipInfo"},
-        {"SetDDR",                       "设置相机 DDR 模式（CONTROL_DDR），payload 传入 double（通常为 1.0）"},
-        {"SetDebayerOnOff",              "设置去拜耳开关（SetQHYCCDDebayerOnOff），payload 传入 bool"},
-        {"SetUsbTraffic",                "设置 USB 传输级别，payload 传入 double usbTraffic"},
-        {"SetGain",                      "设置增益，payload 传入 double gain"},
-        {"SetOffset",                    "设置偏置，payload 传入 double offset"},
-        {"SetExposure",                  "设置曝光时间（微秒），payload 传入 double exposure"},
-        {"GetUsbTraffic",                "获取 USBTraffic 的最小值/最大值/步进/当前值（SdkControlParamInfo）"},
-        {"GetGain",                      "获取增益的最小值/最大值/步进/当前值（SdkControlParamInfo）"},
-        {"GetOffset",                    "获取偏置的最小值/最大值/步进/当前值（SdkControlParamInfo）"},
-        {"GetExposure",                  "获取曝光时间（微秒）的最小值/最大值/步进/当前值（SdkControlParamInfo）"},
-        {"SetResolution",                "设置 ROI/分辨率，payload 传入 SdkAreaInfo"},
-        {"SetBinMode",                   "设置 Bin 模式，payload 传入 std::pair<int,int> (binX, binY)"},
-        {"SetBitsMode",                  "设置位深模式，payload 传入 int bits（一般为 16）"},
-        {"GetBitsMode",                  "获取位深模式的最小值/最大值/步进/当前值（SdkControlParamInfo）"},
-        {"StartSingleExposure",          "启动单帧曝光（ExpQHYCCDSingleFrame）"},
-        {"GetMemLength",                 "获取单帧图像所需的缓冲区长度，返回 uint32_t"},
-        {"GetSingleFrame",               "读取单帧图像数据，返回 SdkFrameData（16 位单通道）"},
-        {"BeginLive",                    "进入 Live 连续采集（BeginQHYCCDLive），需先 SetStreamMode=1"},
-        {"GetLiveFrame",                 "读取一帧 Live 图像数据（GetQHYCCDLiveFrame），返回 SdkFrameData"},
-        {"GetLiveFrameFast",             "读取一帧 Live 图像数据（GetQHYCCDLiveFrame），复用缓冲区且不拷贝 pixels（仅返回 meta）"},
-        {"StopLive",                     "停止 Live 连续采集（StopQHYCCDLive）"},
-        {"EnableBurstMode",              "开启/关闭 Burst 子模式（EnableQHYCCDBurstMode），payload=bool"},
-        {"SetBurstStartEnd",             "设置 Burst start/end（SetQHYCCDBurstModeStartEnd），payload=std::pair<int,int>"},
-        {"ResetFrameCounter",            "复位帧计数器（ResetQHYCCDFrameCounter）"},
-        {"SetBurstIDLE",                 "进入 Burst IDLE 状态（SetQHYCCDBurstIDLE）"},
-        {"ReleaseBurstIDLE",             "释放 Burst IDLE 触发输出（ReleaseQHYCCDBurstIDLE）"},
-        {"SetBurstPatchNumber",          "设置 Burst 补包数据量（SetQHYCCDBurstModePatchNumber），payload=uint32_t"},
-        {"CheckSingleFrameModeAvailable","检测是否支持单帧模式（IsQHYCCDControlAvailable CAM_SINGLEFRAMEMODE），返回 bool"},
-        {"IsColorCamera",                "检测当前相机是否为彩色相机（CAM_IS_COLOR），返回 bool"},
-        {"GetCameraCfa",                 "按 CAM_IS_COLOR -> SetQHYCCDDebayerOnOff(true) -> CAM_COLOR 获取 CFA，返回 std::string"},
-        {"GetCurrentTemperature",        "获取当前 CMOS/CCD 温度（CONTROL_CURTEMP），返回 double"},
-        {"SetCoolerTargetTemperature",   "设置制冷目标温度（CONTROL_COOLER），payload 传入 double 摄氏度"},
-        {"GetCoolerTargetTemperature",   "获取制冷目标温度的最小值/最大值/步进/当前值（SdkControlParamInfo）"},
-        {"GetCoolerPower",               "获取当前制冷 PWM 功率百分比（GetQHYCCDParam CONTROL_CURPWM），返回 double"},
-        {"CancelExposure",               "取消当前曝光与读出（CancelQHYCCDExposingAndReadout）"},
-        {"IsCFWPlugged",                 "检测相机是否连接了滤镜轮（CFW），返回 bool"},
-        {"GetCFWSlotsNum",               "获取滤镜轮的槽位数量（CONTROL_CFWSLOTSNUM），返回 int"},
-        {"GetCFWPosition",               "获取当前滤镜轮位置（CONTROL_CFWPORT），返回 int（0 开始）"},
-        {"SetCFWPosition",               "设置滤镜轮位置（CONTROL_CFWPORT），payload 传入 int 位置（0 开始）"},
-        {"SendOrderToCFW",               "发送自定义命令到滤镜轮，payload 传入 std::string order"},
-        {"GetCFWStatus",                 "获取滤镜轮状态字符串，返回 std::string"}
-    };
+    std::vector<SdkCommandInfo> list;
+    list.reserve(kCommandCount);
+    for (size_t i = 0; i < kCommandCount; ++i) {
+        list.push_back({kCommandTable[i].name, kCommandTable[i].description});
+    }
+    return list;
 }
 
 SdkResult QhyCameraDriver::makeResultFromRet(const std::string& action, unsigned int ret) const
@@ -248,1337 +374,1156 @@ SdkResult QhyCameraDriver::closeDevice(SdkDeviceHandle device)
     return makeResultFromRet("CloseQHYCCD", ret);
 }
 
+SdkCommandId QhyCameraDriver::resolveCommand(const std::string& name) const
+{
+    auto it = m_commandIds.find(name);
+    return (it != m_commandIds.end()) ? it->second : kSdkInvalidCommandId;
+}
+
+unsigned QhyCameraDriver::commandFlags(SdkCommandId id) const
+{
+    if (id < 0 || static_cast<size_t>(id) >= kCommandCount) {
+        return SdkCommandFlagNone;
+    }
+    return kCommandTable[id].flags;
+}
+
 SdkResult QhyCameraDriver::execute(SdkDeviceHandle device, const SdkCommand& cmd)
+{
+    // 未经 SdkManager 预解析的调用（直接持有驱动指针的场景）：此处解析一次
+    const SdkCommandId id = (cmd.idOwner == this) ? cmd.id : resolveCommand(cmd.name);
+    return executeById(device, id, cmd);
+}
+
+SdkResult QhyCameraDriver::executeById(SdkDeviceHandle device, SdkCommandId id, const SdkCommand& cmd)
 {
     SdkResult r;
 
-    qhyccd_handle *handle = static_cast<qhyccd_handle*>(device);
+    if (cmd.type != SdkCommandType::Custom || id < 0 || static_cast<size_t>(id) >= kCommandCount) {
+        // 默认：不支持的命令
+        r.success = false;
+        r.errorCode = SdkErrorCode::NotImplemented;
+        r.message = "Unsupported QHY command: " + cmd.name;
+        return r;
+    }
 
-    // 根据命令名称拆分具体功能
-    if (cmd.type == SdkCommandType::Custom) {
-        const std::string& name = cmd.name;
-
-        // 1. SDK 版本号
-        if (name == "GetSdkVersion") {
-            unsigned int YMDS[4] = {0};
-            unsigned char sVersion[80];
-            std::memset(sVersion, 0, sizeof(sVersion));
-            GetQHYCCDSDKVersion(&YMDS[0], &YMDS[1], &YMDS[2], &YMDS[3]);
-
-            char buf[80] = {0};
-            if ((YMDS[1] < 10) && (YMDS[2] < 10)) {
-                std::sprintf(buf, "V20%d0%d0%d_%d", YMDS[0], YMDS[1], YMDS[2], YMDS[3]);
-            } else if ((YMDS[1] < 10) && (YMDS[2] > 10)) {
-                std::sprintf(buf, "V20%d0%d%d_%d", YMDS[0], YMDS[1], YMDS[2], YMDS[3]);
-            } else if ((YMDS[1] > 10) && (YMDS[2] < 10)) {
-                std::sprintf(buf, "V20%d%d0%d_%d", YMDS[0], YMDS[1], YMDS[2], YMDS[3]);
-            } else {
-                std::sprintf(buf, "V20%d%d%d_%d", YMDS[0], YMDS[1], YMDS[2], YMDS[3]);
-            }
+    const CommandEntry& entry = kCommandTable[id];
+    qhyccd_handle *handle = static_cast<qhyccd_handle*>(device);
 
-            r.success = true;
-            r.message = std::string("QHYCCD SDK version: ") + buf;
-            r.payload = std::string(buf);
-            return r;
-        }
+    if (entry.needsHandle && !handle) {
+        r.success = false;
+        r.errorCode = SdkErrorCode::InvalidParameter;
+        r.message = std::string(entry.name) + " requires a valid device handle";
+        return r;
+    }
 
-        // 2. 固件版本（需要已打开的相机句柄）
-        if (name == "GetFirmwareVersion") {
-            if (!handle) {
-                r.success = false;
-                r.message = "GetFirmwareVersion requires a valid device handle";
-                return r;
-            }
-            unsigned char fwv[32]{};
-            unsigned char FWInfo[256]{};
-            unsigned int ret = GetQHYCCDFWVersion(handle, fwv);
-            if (ret == QHYCCD_SUCCESS) {
-                if ((fwv[0] >> 4) <= 9) {
-                    std::sprintf(reinterpret_cast<char*>(FWInfo),
-                                 "FW 20%d_%d_%d",
-                                 ((fwv[0] >> 4) + 0x10),
-                                 (fwv[0] & ~0xf0),
-                                 fwv[1]);
-                } else {
-                    std::sprintf(reinterpret_cast<char*>(FWInfo),
-                                 "FW 20%d_%d_%d",
-                                 (fwv[0] >> 4),
-                                 (fwv[0] & ~0xf0),
-                                 fwv[1]);
-                }
-                r.success = true;
-                r.message = std::string(reinterpret_cast<char*>(FWInfo));
-                r.payload = std::string(reinterpret_cast<char*>(FWInfo));
-            } else {
-                r.success = false;
-                r.message = "GetQHYCCDFWVersion failed, error code: " + std::to_string(ret);
-            }
-            return r;
-        }
+    if (entry.payloadType && cmd.payload.type() != *entry.payloadType) {
+        r.success = false;
+        r.errorCode = SdkErrorCode::InvalidParameter;
+        r.message = std::string("Invalid parameter type for ") + entry.payloadName;
+        return r;
+    }
 
-        // 3. 初始化 / 释放 SDK 资源（不依赖句柄）
-        if (name == "InitSdkResource") {
-            unsigned int ret = InitQHYCCDResource();
-            if (ret == QHYCCD_SUCCESS) {
-                m_resourceInited = true;
-            }
-            return makeResultFromRet("InitQHYCCDResource", ret);
-        }
+    return (this->*entry.handler)(handle, cmd);
+}
 
-        if (name == "ReleaseSdkResource") {
-            unsigned int ret = ReleaseQHYCCDResource();
-            if (ret == QHYCCD_SUCCESS) {
-                m_resourceInited = false;
-            }
-            return makeResultFromRet("ReleaseQHYCCDResource", ret);
-        }
+// 1. SDK 版本号
+SdkResult QhyCameraDriver::cmdGetSdkVersion(qhyccd_handle* /*handle*/, const SdkCommand& /*cmd*/)
+{
+    SdkResult r;
+    unsigned int YMDS[4] = {0};
+    unsigned char sVersion[80];
+    std::memset(sVersion, 0, sizeof(sVersion));
+    GetQHYCCDSDKVersion(&YMDS[0], &YMDS[1], &YMDS[2], &YMDS[3]);
+
+    char buf[80] = {0};
+    if ((YMDS[1] < 10) && (YMDS[2] < 10)) {
+        std::sprintf(buf, "V20%d0%d0%d_%d", YMDS[0], YMDS[1], YMDS[2], YMDS[3]);
+    } else if ((YMDS[1] < 10) && (YMDS[2] > 10)) {
+        std::sprintf(buf, "V20%d0%d%d_%d", YMDS[0], YMDS[1], YMDS[2], YMDS[3]);
+    } else if ((YMDS[1] > 10) && (YMDS[2] < 10)) {
+        std::sprintf(buf, "V20%d%d0%d_%d", YMDS[0], YMDS[1], YMDS[2], YMDS[3]);
+    } else {
+        std::sprintf(buf, "V20%d%d%d_%d", YMDS[0], YMDS[1], YMDS[2], YMDS[3]);
+    }
 
-        // 4. 扫描相机数量
-        if (name == "ScanCameras") {
-            int camCount = ScanQHYCCD();
-            r.success = (camCount >= 0);
-            r.message = "ScanQHYCCD, camera count = " + std::to_string(camCount);
-            r.payload = camCount;
-            return r;
-        }
+    r.success = true;
+    r.message = std::string("QHYCCD SDK version: ") + buf;
+    r.payload = std::string(buf);
+    return r;
+}
 
-        // 5. 根据索引获取 cameraId
-        if (name == "GetCameraIdByIndex") {
-            int index = 0;
-            if (!extractParam<int>(cmd.payload, index, r, "index")) {
-                return r;
-            }
-            char camId[32] = {0};
-            unsigned int ret = GetQHYCCDId(index, camId);
-            if (ret == QHYCCD_SUCCESS) {
-                r.success = true;
-                r.message = std::string("GetQHYCCDId success, index = ")
-                            + std::to_string(index) + ", id = " + camId;
-                r.payload = std::string(camId);
-            } else {
-                r.success = false;
-                r.message = "GetQHYCCDId failed, error code: " + std::to_string(ret);
-            }
-            return r;
+// 2. 固件版本（需要已打开的相机句柄）
+SdkResult QhyCameraDriver::cmdGetFirmwareVersion(qhyccd_handle* handle, const SdkCommand& /*cmd*/)
+{
+    SdkResult r;
+    unsigned char fwv[32]{};
+    unsigned char FWInfo[256]{};
+    unsigned int ret = GetQHYCCDFWVersion(handle, fwv);
+    if (ret == QHYCCD_SUCCESS) {
+        if ((fwv[0] >> 4) <= 9) {
+            std::sprintf(reinterpret_cast<char*>(FWInfo),
+                         "FW 20%d_%d_%d",
+                         ((fwv[0] >> 4) + 0x10),
+                         (fwv[0] & ~0xf0),
+                         fwv[1]);
+        } else {
+            std::sprintf(reinterpret_cast<char*>(FWInfo),
+                         "FW 20%d_%d_%d",
+                         (fwv[0] >> 4),
+                         (fwv[0] & ~0xf0),
+                         fwv[1]);
         }
+        r.success = true;
+        r.message = std::string(reinterpret_cast<char*>(FWInfo));
+        r.payload = std::string(reinterpret_cast<char*>(FWInfo));
+    } else {
+        r.success = false;
+        r.message = "GetQHYCCDFWVersion failed, error code: " + std::to_string(ret);
+    }
+    return r;
+}
 
-        // 5-扩展. 设置读出模式（SetQHYCCDReadMode）
-        if (name == "SetReadMode") {
-            if (!handle) {
-                r.success = false;
-                r.message = "SetReadMode requires a valid device handle";
-                return r;
-            }
-            int readMode = 0;
-            if (!extractParam<int>(cmd.payload, readMode, r, "readMode")) {
-                return r;
-            }
-            const auto t0 = std::chrono::steady_clock::now();
-            Logger::Log("QHYCCD SetReadMode | start | handle=" + std::to_string((uintptr_t)handle) +
-                        ", readMode=" + std::to_string(readMode),
-                        LogLevel::DEBUG, DeviceType::CAMERA);
-            unsigned int ret = SetQHYCCDReadMode(handle, static_cast<uint32_t>(readMode));
-            const auto dt = std::chrono::duration_cast<std::chrono::milliseconds>(
-                std::chrono::steady_clock::now() - t0).count();
-            Logger::Log("QHYCCD SetReadMode | finish | handle=" + std::to_string((uintptr_t)handle) +
-                        ", ret=" + std::to_string(ret) +
-                        ", costMs=" + std::to_string(dt),
-                        (ret == QHYCCD_SUCCESS) ? LogLevel::DEBUG : LogLevel::ERROR,
-                        DeviceType::CAMERA);
-            return makeResultFromRet("SetQHYCCDReadMode", ret);
-        }
+// 3. 初始化 / 释放 SDK 资源（不依赖句柄）
+SdkResult QhyCameraDriver::cmdInitSdkResource(qhyccd_handle* /*handle*/, const SdkCommand& /*cmd*/)
+{
+    unsigned int ret = InitQHYCCDResource();
+    if (ret == QHYCCD_SUCCESS) {
+        m_resourceInited = true;
+    }
+    return makeResultFromRet("InitQHYCCDResource", ret);
+}
 
-        // 6. 设置流模式（例：单帧模式）
-        if (name == "SetStreamMode") {
-            if (!handle) {
-                r.success = false;
-                r.message = "SetStreamMode requires a valid device handle";
-                return r;
-            }
-            int mode = 0;
-            if (!extractParam<int>(cmd.payload, mode, r, "mode")) {
-                return r;
-            }
-            const auto t0 = std::chrono::steady_clock::now();
-            Logger::Log("QHYCCD SetStreamMode | start | handle=" + std::to_string((uintptr_t)handle) +
-                        ", mode=" + std::to_string(mode),
-                        LogLevel::DEBUG, DeviceType::CAMERA);
-            unsigned int ret = SetQHYCCDStreamMode(handle, mode);
-            const auto dt = std::chrono::duration_cast<std::chrono::milliseconds>(
-                std::chrono::steady_clock::now() - t0).count();
-            Logger::Log("QHYCCD SetStreamMode | finish | handle=" + std::to_string((uintptr_t)handle) +
-                        ", ret=" + std::to_string(ret) +
-                        ", costMs=" + std::to_string(dt),
-                        (ret == QHYCCD_SUCCESS) ? LogLevel::DEBUG : LogLevel::ERROR,
-                        DeviceType::CAMERA);
-            return makeResultFromRet("SetQHYCCDStreamMode", ret);
-        }
+SdkResult QhyCameraDriver::cmdReleaseSdkResource(qhyccd_handle* /*handle*/, const SdkCommand& /*cmd*/)
+{
+    unsigned int ret = ReleaseQHYCCDResource();
+    if (ret == QHYCCD_SUCCESS) {
+        m_resourceInited = false;
+    }
+    return makeResultFromRet("ReleaseQHYCCDResource", ret);
+}
 
-        // 7. 初始化相机（InitQHYCCD）
-        if (name == "InitCamera") {
-            if (!handle) {
-                r.success = false;
-                r.message = "InitCamera requires a valid device handle";
-                return r;
-            }
-            const auto t0 = std::chrono::steady_clock::now();
-            Logger::Log("QHYCCD InitCamera | start | handle=" + std::to_string((uintptr_t)handle),
-                        LogLevel::DEBUG, DeviceType::CAMERA);
-            unsigned int ret = InitQHYCCD(handle);
-            const auto dt = std::chrono::duration_cast<std::chrono::milliseconds>(
-                std::chrono::steady_clock::now() - t0).count();
-            Logger::Log("QHYCCD InitCamera | finish | handle=" + std::to_string((uintptr_t)handle) +
-                        ", ret=" + std::to_string(ret) +
-                        ", costMs=" + std::to_string(dt),
-                        (ret == QHYCCD_SUCCESS) ? LogLevel::DEBUG : LogLevel::ERROR,
-                        DeviceType::CAMERA);
-            return makeResultFromRet("InitQHYCCD", ret);
-        }
+// 4. 扫描相机数量
+SdkResult QhyCameraDriver::cmdScanCameras(qhyccd_handle* /*handle*/, const SdkCommand& /*cmd*/)
+{
+    SdkResult r;
+    int camCount = ScanQHYCCD();
+    r.success = (camCount >= 0);
+    r.message = "ScanQHYCCD, camera count = " + std::to_string(camCount);
+    r.payload = camCount;
+    return r;
+}
 
-        // 8. 获取 OverScan 区域
-        if (name == "GetOverScanArea") {
-            if (!handle) {
-                r.success = false;
-                r.message = "GetOverScanArea requires a valid device handle";
-                return r;
-            }
-            SdkAreaInfo info;
-            unsigned int ret = GetQHYCCDOverScanArea(handle,
-                                                     &info.startX,
-                                                     &info.startY,
-                                                     &info.sizeX,
-                                                     &info.sizeY);
-            r = makeResultFromRet("GetQHYCCDOverScanArea", ret);
-            if (ret == QHYCCD_SUCCESS) {
-                r.payload = info;
-            }
-            return r;
-        }
+// 5. 根据索引获取 cameraId
+SdkResult QhyCameraDriver::cmdGetCameraIdByIndex(qhyccd_handle* /*handle*/, const SdkCommand& cmd)
+{
+    SdkResult r;
+    const int index = payloadAs<int>(cmd);
+    char camId[32] = {0};
+    unsigned int ret = GetQHYCCDId(index, camId);
+    if (ret == QHYCCD_SUCCESS) {
+        r.success = true;
+        r.message = std::string("GetQHYCCDId success, index = ")
+                    + std::to_string(index) + ", id = " + camId;
+        r.payload = std::string(camId);
+    } else {
+        r.success = false;
+        r.message = "GetQHYCCDId failed, error code: " + std::to_string(ret);
+    }
+    return r;
+}
 
-        // 9. 获取有效区域（EffectiveArea）
-        if (name == "GetEffectiveArea") {
-            if (!handle) {
-                r.success = false;
-                r.message = "GetEffectiveArea requires a valid device handle";
-                return r;
-            }
-            SdkAreaInfo info;
-            unsigned int ret = GetQHYCCDEffectiveArea(handle,
-                                                      &info.startX,
-                                                      &info.startY,
-                                                      &info.sizeX,
-                                                      &info.sizeY);
-            r = makeResultFromRet("GetQHYCCDEffectiveArea", ret);
-            if (ret == QHYCCD_SUCCESS) {
-                r.payload = info;
-            }
-            return r;
-        }
+// 5-扩展. 设置读出模式（SetQHYCCDReadMode）
+SdkResult QhyCameraDriver::cmdSetReadMode(qhyccd_handle* handle, const SdkCommand& cmd)
+{
+    const int readMode = payloadAs<int>(cmd);
+    const auto t0 = std::chrono::steady_clock::now();
+    Logger::Log("QHYCCD SetReadMode | start | handle=" + std::to_string((uintptr_t)handle) +
+                ", readMode=" + std::to_string(readMode),
+                LogLevel::DEBUG, DeviceType::CAMERA);
+    unsigned int ret = SetQHYCCDReadMode(handle, static_cast<uint32_t>(readMode));
+    const auto dt = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - t0).count();
+    Logger::Log("QHYCCD SetReadMode | finish | handle=" + std::to_string((uintptr_t)handle) +
+                ", ret=" + std::to_string(ret) +
+                ", costMs=" + std::to_string(dt),
+                (ret == QHYCCD_SUCCESS) ? LogLevel::DEBUG : LogLevel::ERROR,
+                DeviceType::CAMERA);
+    return makeResultFromRet("SetQHYCCDReadMode", ret);
+}
 
-        // 10. 获取芯片信息（ChipInfo）
-        if (name == "GetChipInfo") {
-            if (!handle) {
-                r.success = false;
-                r.message = "GetChipInfo requires a valid device handle";
-                return r;
-            }
-            SdkChipInfo info;
-            unsigned int ret = GetQHYCCDChipInfo(handle,
-                                                 &info.chipWidthMM,
-                                                 &info.chipHeightMM,
-                                                 &info.maxImageSizeX,
-                                                 &info.maxImageSizeY,
-                                                 &info.pixelWidthUM,
-                                                 &info.pixelHeightUM,
-                                                 &info.bpp);
-            r = makeResultFromRet("GetQHYCCDChipInfo", ret);
-            if (ret == QHYCCD_SUCCESS) {
-                r.payload = info;
-            }
-            return r;
-        }
+// 6. 设置流模式（例：单帧模式）
+SdkResult QhyCameraDriver::cmdSetStreamMode(qhyccd_handle* handle, const SdkCommand& cmd)
+{
+    const int mode = payloadAs<int>(cmd);
+    const auto t0 = std::chrono::steady_clock::now();
+    Logger::Log("QHYCCD SetStreamMode | start | handle=" + std::to_string((uintptr_t)handle) +
+                ", mode=" + std::to_string(mode),
+                LogLevel::DEBUG, DeviceType::CAMERA);
+    unsigned int ret = SetQHYCCDStreamMode(handle, mode);
+    const auto dt = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - t0).count();
+    Logger::Log("QHYCCD SetStreamMode | finish | handle=" + std::to_string((uintptr_t)handle) +
+                ", ret=" + std::to_string(ret) +
+                ", costMs=" + std::to_string(dt),
+                (ret == QHYCCD_SUCCESS) ? LogLevel::DEBUG : LogLevel::ERROR,
+                DeviceType::CAMERA);
+    return makeResultFromRet("SetQHYCCDStreamMode", ret);
+}
 
-        // 10-扩展. DDR（CONTROL_DDR）
-        if (name == "SetDDR") {
-            if (!handle) {
-                r.success = false;
-                r.message = "SetDDR requires a valid device handle";
-                return r;
-            }
-            double value = 0.0;
-            if (!extractParam<double>(cmd.payload, value, r, "ddr")) {
-                return r;
-            }
-            unsigned int ret = SetQHYCCDParam(handle, CONTROL_DDR, value);
-            return makeResultFromRet("SetQHYCCDParam CONTROL_DDR", ret);
-        }
+// 7. 初始化相机（InitQHYCCD）
+SdkResult QhyCameraDriver::cmdInitCamera(qhyccd_handle* handle, const SdkCommand& /*cmd*/)
+{
+    const auto t0 = std::chrono::steady_clock::now();
+    Logger::Log("QHYCCD InitCamera | start | handle=" + std::to_string((uintptr_t)handle),
+                LogLevel::DEBUG, DeviceType::CAMERA);
+    unsigned int ret = InitQHYCCD(handle);
+    const auto dt = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - t0).count();
+    Logger::Log("QHYCCD InitCamera | finish | handle=" + std::to_string((uintptr_t)handle) +
+                ", ret=" + std::to_string(ret) +
+                ", costMs=" + std::to_string(dt),
+                (ret == QHYCCD_SUCCESS) ? LogLevel::DEBUG : LogLevel::ERROR,
+                DeviceType::CAMERA);
+    return makeResultFromRet("InitQHYCCD", ret);
+}
 
-        // 10-扩展. Debayer 开关（SetQHYCCDDebayerOnOff）
-        if (name == "SetDebayerOnOff") {
-            if (!handle) {
-                r.success = false;
-                r.message = "SetDebayerOnOff requires a valid device handle";
-                return r;
-            }
-            bool on = false;
-            if (!extractParam<bool>(cmd.payload, on, r, "debayerOn")) {
-                return r;
-            }
-            // 部分单色机型/旧版 SDK 上直接调用 SetQHYCCDDebayerOnOff 可能触发底层崩溃。
-            // 只有在明确检测到彩色相机时才下发该调用；否则视为“无需处理”的成功 no-op。
-            const unsigned int colorRet = IsQHYCCDControlAvailable(handle, CAM_IS_COLOR);
-            if (colorRet != QHYCCD_SUCCESS) {
-                r.success = true;
-                r.message = "Skip SetQHYCCDDebayerOnOff: camera is monochrome or CAM_IS_COLOR unsupported";
-                return r;
-            }
-            unsigned int ret = SetQHYCCDDebayerOnOff(handle, on);
-            return makeResultFromRet(std::string("SetQHYCCDDebayerOnOff ") + (on ? "true" : "false"), ret);
-        }
+// 8. 获取 OverScan 区域
+SdkResult QhyCameraDriver::cmdGetOverScanArea(qhyccd_handle* handle, const SdkCommand& /*cmd*/)
+{
+    SdkResult r;
+    SdkAreaInfo info;
+    unsigned int ret = GetQHYCCDOverScanArea(handle,
+                                             &info.startX,
+                                             &info.startY,
+                                             &info.sizeX,
+                                             &info.sizeY);
+    r = makeResultFromRet("GetQHYCCDOverScanArea", ret);
+    if (ret == QHYCCD_SUCCESS) {
+        r.payload = info;
+    }
+    return r;
+}
 
-        // 11. 设置 USB 传输（CONTROL_USBTRAFFIC）
-        if (name == "SetUsbTraffic") {
-            if (!handle) {
-                r.success = false;
-                r.message = "SetUsbTraffic requires a valid device handle";
-                return r;
-            }
-            double value = 0.0;
-            if (!extractParam<double>(cmd.payload, value, r, "usbTraffic")) {
-                return r;
-            }
-            unsigned int ret = SetQHYCCDParam(handle, CONTROL_USBTRAFFIC, value);
-            return makeResultFromRet("SetQHYCCDParam CONTROL_USBTRAFFIC", ret);
-        }
+// 9. 获取有效区域（EffectiveArea）
+SdkResult QhyCameraDriver::cmdGetEffectiveArea(qhyccd_handle* handle, const SdkCommand& /*cmd*/)
+{
+    SdkResult r;
+    SdkAreaInfo info;
+    unsigned int ret = GetQHYCCDEffectiveArea(handle,
+                                              &info.startX,
+                                              &info.startY,
+                                              &info.sizeX,
+                                              &info.sizeY);
+    r = makeResultFromRet("GetQHYCCDEffectiveArea", ret);
+    if (ret == QHYCCD_SUCCESS) {
+        r.payload = info;
+    }
+    return r;
+}
 
-        // 11-扩展. 获取 USBTraffic 的范围及当前值（CONTROL_USBTRAFFIC）
-        if (name == "GetUsbTraffic") {
-            if (!handle) {
-                r.success = false;
-                r.message = "GetUsbTraffic requires a valid device handle";
-                return r;
-            }
-            double minV = 0.0, maxV = 0.0, stepV = 0.0;
-            uint32_t ret = GetQHYCCDParamMinMaxStep(handle, CONTROL_USBTRAFFIC, &minV, &maxV, &stepV);
-            double cur = GetQHYCCDParam(handle, CONTROL_USBTRAFFIC);
-            if (ret != QHYCCD_SUCCESS || cur == QHYCCD_ERROR) {
-                r.success = false;
-                r.message = "GetQHYCCDParamMinMaxStep/CONTROL_USBTRAFFIC failed";
-            } else {
-                SdkControlParamInfo info;
-                info.minValue = minV;
-                info.maxValue = maxV;
-                info.step     = stepV;
-                info.current  = cur;
-                r.success = true;
-                r.payload = info;
-                r.message = "USBTraffic param info acquired";
-            }
-            return r;
-        }
+// 10. 获取芯片信息（ChipInfo）
+SdkResult QhyCameraDriver::cmdGetChipInfo(qhyccd_handle* handle, const SdkCommand& /*cmd*/)
+{
+    SdkResult r;
+    SdkChipInfo info;
+    unsigned int ret = GetQHYCCDChipInfo(handle,
+                                         &info.chipWidthMM,
+                                         &info.chipHeightMM,
+                                         &info.maxImageSizeX,
+                                         &info.maxImageSizeY,
+                                         &info.pixelWidthUM,
+                                         &info.pixelHeightUM,
+                                         &info.bpp);
+    r = makeResultFromRet("GetQHYCCDChipInfo", ret);
+    if (ret == QHYCCD_SUCCESS) {
+        r.payload = info;
+    }
+    return r;
+}
 
-        // 12. 设置增益（CONTROL_GAIN）
-        if (name == "SetGain") {
-            if (!handle) {
-                r.success = false;
-                r.message = "SetGain requires a valid device handle";
-                return r;
-            }
-            double value = 0.0;
-            if (!extractParam<double>(cmd.payload, value, r, "gain")) {
-                return r;
-            }
-            unsigned int ret = SetQHYCCDParam(handle, CONTROL_GAIN, value);
-            return makeResultFromRet("SetQHYCCDParam CONTROL_GAIN", ret);
-        }
+// 10-扩展. DDR（CONTROL_DDR）
+SdkResult QhyCameraDriver::cmdSetDDR(qhyccd_handle* handle, const SdkCommand& cmd)
+{
+    const double value = payloadAs<double>(cmd);
+    unsigned int ret = SetQHYCCDParam(handle, CONTROL_DDR, value);
+    return makeResultFromRet("SetQHYCCDParam CONTROL_DDR", ret);
+}
 
-        // 12-扩展. 获取增益的范围及当前值（CONTROL_GAIN）
-        if (name == "GetGain") {
-            if (!handle) {
-                r.success = false;
-                r.message = "GetGain requires a valid device handle";
-                return r;
-            }
-            double minV = 0.0, maxV = 0.0, stepV = 0.0;
-            uint32_t ret = GetQHYCCDParamMinMaxStep(handle, CONTROL_GAIN, &minV, &maxV, &stepV);
-            double cur = GetQHYCCDParam(handle, CONTROL_GAIN);
-            if (ret != QHYCCD_SUCCESS || cur == QHYCCD_ERROR) {
-                r.success = false;
-                r.message = "GetQHYCCDParamMinMaxStep/CONTROL_GAIN failed";
-            } else {
-                SdkControlParamInfo info;
-                info.minValue = minV;
-                info.maxValue = maxV;
-                info.step     = stepV;
-                info.current  = cur;
-                r.success = true;
-                r.payload = info;
-                r.message = "Gain param info acquired";
-            }
-            return r;
-        }
+// 10-扩展. Debayer 开关（SetQHYCCDDebayerOnOff）
+SdkResult QhyCameraDriver::cmdSetDebayerOnOff(qhyccd_handle* handle, const SdkCommand& cmd)
+{
+    SdkResult r;
+    const bool on = payloadAs<bool>(cmd);
+    // 部分单色机型/旧版 SDK 上直接调用 SetQHYCCDDebayerOnOff 可能触发底层崩溃。
+    // 只有在明确检测到彩色相机时才下发该调用；否则视为“无需处理”的成功 no-op。
+    const unsigned int colorRet = IsQHYCCDControlAvailable(handle, CAM_IS_COLOR);
+    if (colorRet != QHYCCD_SUCCESS) {
+        r.success = true;
+        r.message = "Skip SetQHYCCDDebayerOnOff: camera is monochrome or CAM_IS_COLOR unsupported";
+        return r;
+    }
+    unsigned int ret = SetQHYCCDDebayerOnOff(handle, on);
+    return makeResultFromRet(std::string("SetQHYCCDDebayerOnOff ") + (on ? "true" : "false"), ret);
+}
 
-        // 13. 设置偏置（CONTROL_OFFSET）
-        if (name == "SetOffset") {
-            if (!handle) {
-                r.success = false;
-                r.message = "SetOffset requires a valid device handle";
-                return r;
-            }
-            double value = 0.0;
-            if (!extractParam<double>(cmd.payload, value, r, "offset")) {
-                return r;
-            }
-            unsigned int ret = SetQHYCCDParam(handle, CONTROL_OFFSET, value);
-            return makeResultFromRet("SetQHYCCDParam CONTROL_OFFSET", ret);
-        }
+// 11. 设置 USB 传输（CONTROL_USBTRAFFIC）
+SdkResult QhyCameraDriver::cmdSetUsbTraffic(qhyccd_handle* handle, const SdkCommand& cmd)
+{
+    const double value = payloadAs<double>(cmd);
+    unsigned int ret = SetQHYCCDParam(handle, CONTROL_USBTRAFFIC, value);
+    return makeResultFromRet("SetQHYCCDParam CONTROL_USBTRAFFIC", ret);
+}
 
-        // 13-扩展. 获取偏置的范围及当前值（CONTROL_OFFSET）
-        if (name == "GetOffset") {
-            if (!handle) {
-                r.success = false;
-                r.message = "GetOffset requires a valid device handle";
-                return r;
-            }
-            double minV = 0.0, maxV = 0.0, stepV = 0.0;
-            uint32_t ret = GetQHYCCDParamMinMaxStep(handle, CONTROL_OFFSET, &minV, &maxV, &stepV);
-            double cur = GetQHYCCDParam(handle, CONTROL_OFFSET);
-            if (ret != QHYCCD_SUCCESS || cur == QHYCCD_ERROR) {
-                r.success = false;
-                r.message = "GetQHYCCDParamMinMaxStep/CONTROL_OFFSET failed";
-            } else {
-                SdkControlParamInfo info;
-                info.minValue = minV;
-                info.maxValue = maxV;
-                info.step     = stepV;
-                info.current  = cur;
-                r.success = true;
-                r.payload = info;
-                r.message = "Offset param info acquired";
-            }
-            return r;
-        }
+// 12. 设置增益（CONTROL_GAIN）
+SdkResult QhyCameraDriver::cmdSetGain(qhyccd_handle* handle, const SdkCommand& cmd)
+{
+    const double value = payloadAs<double>(cmd);
+    unsigned int ret = SetQHYCCDParam(handle, CONTROL_GAIN, value);
+    return makeResultFromRet("SetQHYCCDParam CONTROL_GAIN", ret);
+}
 
-        // 14. 设置曝光时间（CONTROL_EXPOSURE，单位 us）
-        if (name == "SetExposure") {
-            if (!handle) {
-                r.success = false;
-                r.message = "SetExposure requires a valid device handle";
-                return r;
-            }
-            double value = 0.0;
-            if (!extractParam<double>(cmd.payload, value, r, "exposure")) {
-                return r;
-            }
-            unsigned int ret = SetQHYCCDParam(handle, CONTROL_EXPOSURE, value);
-            return makeResultFromRet("SetQHYCCDParam CONTROL_EXPOSURE", ret);
-        }
+// 13. 设置偏置（CONTROL_OFFSET）
+SdkResult QhyCameraDriver::cmdSetOffset(qhyccd_handle* handle, const SdkCommand& cmd)
+{
+    const double value = payloadAs<double>(cmd);
+    unsigned int ret = SetQHYCCDParam(handle, CONTROL_OFFSET, value);
+    return makeResultFromRet("SetQHYCCDParam CONTROL_OFFSET", ret);
+}
 
-        // 14-扩展. 获取曝光时间的范围及当前值（CONTROL_EXPOSURE）
-        if (name == "GetExposure") {
-            if (!handle) {
-                r.success = false;
-                r.message = "GetExposure requires a valid device handle";
-                return r;
-            }
-            double minV = 0.0, maxV = 0.0, stepV = 0.0;
-            uint32_t ret = GetQHYCCDParamMinMaxStep(handle, CONTROL_EXPOSURE, &minV, &maxV, &stepV);
-            double cur = GetQHYCCDParam(handle, CONTROL_EXPOSURE);
-            if (ret != QHYCCD_SUCCESS || cur == QHYCCD_ERROR) {
-                r.success = false;
-                r.message = "GetQHYCCDParamMinMaxStep/CONTROL_EXPOSURE failed";
-            } else {
-                SdkControlParamInfo info;
-                info.minValue = minV;
-                info.maxValue = maxV;
-                info.step     = stepV;
-                info.current  = cur;
-                r.success = true;
-                r.payload = info;
-                r.message = "Exposure param info acquired";
-            }
-            return r;
-        }
+// 14. 设置曝光时间（CONTROL_EXPOSURE，单位 us）
+SdkResult QhyCameraDriver::cmdSetExposure(qhyccd_handle* handle, const SdkCommand& cmd)
+{
+    const double value = payloadAs<double>(cmd);
+    unsigned int ret = SetQHYCCDParam(handle, CONTROL_EXPOSURE, value);
+    return makeResultFromRet("SetQHYCCDParam CONTROL_EXPOSURE", ret);
+}
 
-        // 15. 设置 ROI / 分辨率
-        if (name == "SetResolution") {
-            if (!handle) {
-                r.success = false;
-                r.message = "SetResolution requires a valid device handle";
-                return r;
-            }
-            SdkAreaInfo roi;
-            if (!extractParam<SdkAreaInfo>(cmd.payload, roi, r, "roi")) {
-                return r;
-            }
-            unsigned int ret = SetQHYCCDResolution(handle,
-                                                   roi.startX,
-                                                   roi.startY,
-                                                   roi.sizeX,
-                                                   roi.sizeY);
-            return makeResultFromRet("SetQHYCCDResolution", ret);
-        }
+// 11-扩展. 获取 USBTraffic 的范围及当前值（CONTROL_USBTRAFFIC）
+SdkResult QhyCameraDriver::cmdGetUsbTraffic(qhyccd_handle* handle, const SdkCommand& /*cmd*/)
+{
+    SdkResult r;
+    double minV = 0.0, maxV = 0.0, stepV = 0.0;
+    uint32_t ret = GetQHYCCDParamMinMaxStep(handle, CONTROL_USBTRAFFIC, &minV, &maxV, &stepV);
+    double cur = GetQHYCCDParam(handle, CONTROL_USBTRAFFIC);
+    if (ret != QHYCCD_SUCCESS || cur == QHYCCD_ERROR) {
+        r.success = false;
+        r.message = "GetQHYCCDParamMinMaxStep/CONTROL_USBTRAFFIC failed";
+    } else {
+        SdkControlParamInfo info;
+        info.minValue = minV;
+        info.maxValue = maxV;
+        info.step     = stepV;
+        info.current  = cur;
+        r.success = true;
+        r.payload = info;
+        r.message = "USBTraffic param info acquired";
+    }
+    return r;
+}
 
-        // 16. 设置 Bin 模式
-        if (name == "SetBinMode") {
-            if (!handle) {
-                r.success = false;
-                r.message = "SetBinMode requires a valid device handle";
-                return r;
-            }
-            std::pair<int,int> bin;
-            if (!extractParam<std::pair<int,int>>(cmd.payload, bin, r, "binMode")) {
-                return r;
-            }
-            unsigned int ret = SetQHYCCDBinMode(handle, bin.first, bin.second);
-            return makeResultFromRet("SetQHYCCDBinMode", ret);
-        }
+// 12-扩展. 获取增益的范围及当前值（CONTROL_GAIN）
+SdkResult QhyCameraDriver::cmdGetGain(qhyccd_handle* handle, const SdkCommand& /*cmd*/)
+{
+    SdkResult r;
+    double minV = 0.0, maxV = 0.0, stepV = 0.0;
+    uint32_t ret = GetQHYCCDParamMinMaxStep(handle, CONTROL_GAIN, &minV, &maxV, &stepV);
+    double cur = GetQHYCCDParam(handle, CONTROL_GAIN);
+    if (ret != QHYCCD_SUCCESS || cur == QHYCCD_ERROR) {
+        r.success = false;
+        r.message = "GetQHYCCDParamMinMaxStep/CONTROL_GAIN failed";
+    } else {
+        SdkControlParamInfo info;
+        info.minValue = minV;
+        info.maxValue = maxV;
+        info.step     = stepV;
+        info.current  = cur;
+        r.success = true;
+        r.payload = info;
+        r.message = "Gain param info acquired";
+    }
+    return r;
+}
 
-        // 17. 设置位深（BitsMode / CONTROL_TRANSFERBIT）
-        if (name == "SetBitsMode") {
-            if (!handle) {
-                r.success = false;
-                r.message = "SetBitsMode requires a valid device handle";
-                return r;
-            }
-            int bits = 16;
-            if (!extractParam<int>(cmd.payload, bits, r, "bits")) {
-                return r;
-            }
-            // 某些机型不暴露 CONTROL_TRANSFERBIT；对这些机型跳过位深设置，
-            // 避免在 SDK 内部走到不稳定分支。
-            const unsigned int availRet = IsQHYCCDControlAvailable(handle, CONTROL_TRANSFERBIT);
-            if (availRet == QHYCCD_ERROR) {
-                r.success = true;
-                r.message = "Skip SetQHYCCDBitsMode: CONTROL_TRANSFERBIT unsupported";
-                return r;
-            }
-            unsigned int ret = SetQHYCCDBitsMode(handle, bits);
-            return makeResultFromRet("SetQHYCCDBitsMode", ret);
-        }
+// 13-扩展. 获取偏置的范围及当前值（CONTROL_OFFSET）
+SdkResult QhyCameraDriver::cmdGetOffset(qhyccd_handle* handle, const SdkCommand& /*cmd*/)
+{
+    SdkResult r;
+    double minV = 0.0, maxV = 0.0, stepV = 0.0;
+    uint32_t ret = GetQHYCCDParamMinMaxStep(handle, CONTROL_OFFSET, &minV, &maxV, &stepV);
+    double cur = GetQHYCCDParam(handle, CONTROL_OFFSET);
+    if (ret != QHYCCD_SUCCESS || cur == QHYCCD_ERROR) {
+        r.success = false;
+        r.message = "GetQHYCCDParamMinMaxStep/CONTROL_OFFSET failed";
+    } else {
+        SdkControlParamInfo info;
+        info.minValue = minV;
+        info.maxValue = maxV;
+        info.step     = stepV;
+        info.current  = cur;
+        r.success = true;
+        r.payload = info;
+        r.message = "Offset param info acquired";
+    }
+    return r;
+}
 
-        // 17-扩展. 获取位深模式的范围及当前值（CONTROL_TRANSFERBIT）
-        if (name == "GetBitsMode") {
-            if (!handle) {
-                r.success = false;
-                r.message = "GetBitsMode requires a valid device handle";
-                return r;
-            }
-            double minV = 0.0, maxV = 0.0, stepV = 0.0;
-            uint32_t ret = GetQHYCCDParamMinMaxStep(handle, CONTROL_TRANSFERBIT, &minV, &maxV, &stepV);
-            double cur = GetQHYCCDParam(handle, CONTROL_TRANSFERBIT);
-            if (ret != QHYCCD_SUCCESS || cur == QHYCCD_ERROR) {
-                r.success = false;
-                r.message = "GetQHYCCDParamMinMaxStep/CONTROL_TRANSFERBIT failed";
-            } else {
-                SdkControlParamInfo info;
-                info.minValue = minV;
-                info.maxValue = maxV;
-                info.step     = stepV;
-                info.current  = cur;
-                r.success = true;
-                r.payload = info;
-                r.message = "BitsMode param info acquired";
-            }
-            return r;
-        }
+// 14-扩展. 获取曝光时间的范围及当前值（CONTROL_EXPOSURE）
+SdkResult QhyCameraDriver::cmdGetExposure(qhyccd_handle* handle, const SdkCommand& /*cmd*/)
+{
+    SdkResult r;
+    double minV = 0.0, maxV = 0.0, stepV = 0.0;
+    uint32_t ret = GetQHYCCDParamMinMaxStep(handle, CONTROL_EXPOSURE, &minV, &maxV, &stepV);
+    double cur = GetQHYCCDParam(handle, CONTROL_EXPOSURE);
+    if (ret != QHYCCD_SUCCESS || cur == QHYCCD_ERROR) {
+        r.success = false;
+        r.message = "GetQHYCCDParamMinMaxStep/CONTROL_EXPOSURE failed";
+    } else {
+        SdkControlParamInfo info;
+        info.minValue = minV;
+        info.maxValue = maxV;
+        info.step     = stepV;
+        info.current  = cur;
+        r.success = true;
+        r.payload = info;
+        r.message = "Exposure param info acquired";
+    }
+    return r;
+}
 
-        // 18. 单帧曝光（ExpQHYCCDSingleFrame）
-        if (name == "StartSingleExposure") {
-            if (!handle) {
-                r.success = false;
-                r.message = "StartSingleExposure requires a valid device handle";
-                return r;
-            }
-            Logger::Log("CaptureTrace | stage=qhy_start_single_exposure_sdk_call_enter"
-                            " | handle=" + std::to_string(reinterpret_cast<uintptr_t>(handle)) +
-                            " | thread=" + std::to_string(
-                                static_cast<unsigned long long>(std::hash<std::thread::id>{}(std::this_thread::get_id()))),
-                        LogLevel::INFO, DeviceType::CAMERA);
-            const auto sdkCallStart = std::chrono::steady_clock::now();
-            unsigned int ret = ExpQHYCCDSingleFrame(handle);
-            const auto sdkCallMs = std::chrono::duration_cast<std::chrono::milliseconds>(
-                                       std::chrono::steady_clock::now() - sdkCallStart).count();
-            Logger::Log("CaptureTrace | stage=qhy_start_single_exposure_sdk_call_return"
-                            " | handle=" + std::to_string(reinterpret_cast<uintptr_t>(handle)) +
-                            " | costMs=" + std::to_string(sdkCallMs) +
-                            " | ret=" + std::to_string(ret),
-                        (ret == QHYCCD_SUCCESS) ? LogLevel::INFO : LogLevel::ERROR,
-                        DeviceType::CAMERA);
-            // 注意：不要在驱动层 sleep/阻塞等待曝光完成。
-            // 上层（Qt 定时器）会根据曝光时间进行轮询/等待，这里只负责触发曝光。
-            return makeResultFromRet("ExpQHYCCDSingleFrame", ret);
-        }
+// 15. 设置 ROI / 分辨率
+SdkResult QhyCameraDriver::cmdSetResolution(qhyccd_handle* handle, const SdkCommand& cmd)
+{
+    const SdkAreaInfo roi = payloadAs<SdkAreaInfo>(cmd);
+    unsigned int ret = SetQHYCCDResolution(handle,
+                                           roi.startX,
+                                           roi.startY,
+                                           roi.sizeX,
+                                           roi.sizeY);
+    return makeResultFromRet("SetQHYCCDResolution", ret);
+}
 
-        // 19. 获取所需内存大小（GetQHYCCDMemLength）
-        if (name == "GetMemLength") {
-            if (!handle) {
-                r.success = false;
-                r.message = "GetMemLength requires a valid device handle";
-                return r;
-            }
-            uint32_t length = GetQHYCCDMemLength(handle);
-            r.success = (length > 0);
-            r.message = "GetQHYCCDMemLength, length = " + std::to_string(length);
-            r.payload = static_cast<uint32_t>(length);
-            return r;
-        }
+// 16. 设置 Bin 模式
+SdkResult QhyCameraDriver::cmdSetBinMode(qhyccd_handle* handle, const SdkCommand& cmd)
+{
+    const std::pair<int,int> bin = payloadAs<std::pair<int,int>>(cmd);
+    unsigned int ret = SetQHYCCDBinMode(handle, bin.first, bin.second);
+    return makeResultFromRet("SetQHYCCDBinMode", ret);
+}
 
-        // 20. 获取单帧图像（GetQHYCCDSingleFrame，返回 SdkFrameData）
-        if (name == "GetSingleFrame") {
-            if (!handle) {
-                r.success = false;
-                r.message = "GetSingleFrame requires a valid device handle";
-                return r;
-            }
+// 17. 设置位深（BitsMode / CONTROL_TRANSFERBIT）
+SdkResult QhyCameraDriver::cmdSetBitsMode(qhyccd_handle* handle, const SdkCommand& cmd)
+{
+    SdkResult r;
+    const int bits = payloadAs<int>(cmd);
+    // 某些机型不暴露 CONTROL_TRANSFERBIT；对这些机型跳过位深设置，
+    // 避免在 SDK 内部走到不稳定分支。
+    const unsigned int availRet = IsQHYCCDControlAvailable(handle, CONTROL_TRANSFERBIT);
+    if (availRet == QHYCCD_ERROR) {
+        r.success = true;
+        r.message = "Skip SetQHYCCDBitsMode: CONTROL_TRANSFERBIT unsupported";
+        return r;
+    }
+    unsigned int ret = SetQHYCCDBitsMode(handle, bits);
+    return makeResultFromRet("SetQHYCCDBitsMode", ret);
+}
 
-            // 关键修复：
-            // QHY SDK 的 GetQHYCCDSingleFrame() 在部分机型/驱动版本下会阻塞等待曝光完成，
-            // 如果上层“轮询定时器”在曝光未完成时调用它，会导致线程卡住（常见表现：Expected 100ms 但 Elapsed 60s+）。
-            // 用 GetQHYCCDExposureRemaining() 做一次非阻塞探测：
-            // - 返回值 > 100：曝光尚未结束（剩余时间），直接让上层继续轮询
-            // - 返回值 <= 100：认为曝光结束，可以尝试读取帧
-            //
-            // 备注：qhyccd.h 注释约定 “100 or less 100,it means exposoure is over”
-            uint32_t remaining = GetQHYCCDExposureRemaining(handle);
-            Logger::Log("QHYCCD GetSingleFrame | exposure remaining query: handle=" +
-                            std::to_string(reinterpret_cast<uintptr_t>(handle)) +
-                            " remaining=" + std::to_string(remaining),
-                        LogLevel::DEBUG, DeviceType::CAMERA);
-            // SDK 可能用 0xFFFFFFFF 表示错误（QHYCCD_ERROR）
-            if (remaining == QHYCCD_ERROR) {
-                r.success = false;
-                r.message = "GetQHYCCDExposureRemaining returned QHYCCD_ERROR (will retry)";
-                return r;
-            }
-            if (remaining > 100) {
-                r.success = false;
-                r.message = "Exposure not finished, remaining=" + std::to_string(remaining) + "ms (will retry)";
-                return r;
-            }
+// 17-扩展. 获取位深模式的范围及当前值（CONTROL_TRANSFERBIT）
+SdkResult QhyCameraDriver::cmdGetBitsMode(qhyccd_handle* handle, const SdkCommand& /*cmd*/)
+{
+    SdkResult r;
+    double minV = 0.0, maxV = 0.0, stepV = 0.0;
+    uint32_t ret = GetQHYCCDParamMinMaxStep(handle, CONTROL_TRANSFERBIT, &minV, &maxV, &stepV);
+    double cur = GetQHYCCDParam(handle, CONTROL_TRANSFERBIT);
+    if (ret != QHYCCD_SUCCESS || cur == QHYCCD_ERROR) {
+        r.success = false;
+        r.message = "GetQHYCCDParamMinMaxStep/CONTROL_TRANSFERBIT failed";
+    } else {
+        SdkControlParamInfo info;
+        info.minValue = minV;
+        info.maxValue = maxV;
+        info.step     = stepV;
+        info.current  = cur;
+        r.success = true;
+        r.payload = info;
+        r.message = "BitsMode param info acquired";
+    }
+    return r;
+}
 
-            uint32_t length = GetQHYCCDMemLength(handle);
-            Logger::Log("QHYCCD GetSingleFrame | mem length query: handle=" +
-                            std::to_string(reinterpret_cast<uintptr_t>(handle)) +
-                            " memLength=" + std::to_string(length),
-                        LogLevel::DEBUG, DeviceType::CAMERA);
-            if (length == 0) {
-                r.success = false;
-                r.message = "GetQHYCCDMemLength returned 0";
-                return r;
-            }
+// 18. 单帧曝光（ExpQHYCCDSingleFrame）
+SdkResult QhyCameraDriver::cmdStartSingleExposure(qhyccd_handle* handle, const SdkCommand& /*cmd*/)
+{
+    Logger::Log("CaptureTrace | stage=qhy_start_single_exposure_sdk_call_enter"
+                    " | handle=" + std::to_string(reinterpret_cast<uintptr_t>(handle)) +
+                    " | thread=" + std::to_string(
+                        static_cast<unsigned long long>(std::hash<std::thread::id>{}(std::this_thread::get_id()))),
+                LogLevel::INFO, DeviceType::CAMERA);
+    const auto sdkCallStart = std::chrono::steady_clock::now();
+    unsigned int ret = ExpQHYCCDSingleFrame(handle);
+    const auto sdkCallMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+                               std::chrono::steady_clock::now() - sdkCallStart).count();
+    Logger::Log("CaptureTrace | stage=qhy_start_single_exposure_sdk_call_return"
+                    " | handle=" + std::to_string(reinterpret_cast<uintptr_t>(handle)) +
+                    " | costMs=" + std::to_string(sdkCallMs) +
+                    " | ret=" + std::to_string(ret),
+                (ret == QHYCCD_SUCCESS) ? LogLevel::INFO : LogLevel::ERROR,
+                DeviceType::CAMERA);
+    // 注意：不要在驱动层 sleep/阻塞等待曝光完成。
+    // 上层（Qt 定时器）会根据曝光时间进行轮询/等待，这里只负责触发曝光。
+    return makeResultFromRet("ExpQHYCCDSingleFrame", ret);
+}
 
-            // 某些机型/SDK 版本下，GetQHYCCDMemLength() 在全幅/ROI/硬件 Bin 切换后可能短暂返回过小值，
-            // 直接把该长度传给 GetQHYCCDSingleFrame() 会导致 SDK 向外部缓冲区越界写，从而触发段错误。
-            // 另外，若相机处于 debayer/RGB 输出，SDK 可能返回 16-bit x 3 channels。
-            // 这里按“整幅 16-bit 3 通道”保守预留容量，先确保 SDK 写入安全；后续仍以返回的 roi/meta 校验有效字节。
-            uint32_t safeLength = length;
-            unsigned int chipRet = QHYCCD_ERROR;
-            double chipW = 0.0;
-            double chipH = 0.0;
-            double pixelW = 0.0;
-            double pixelH = 0.0;
-            unsigned int chipBpp = 0;
-            unsigned int maxImageX = 0;
-            unsigned int maxImageY = 0;
-            {
-                chipRet = GetQHYCCDChipInfo(handle,
-                                            &chipW,
-                                            &chipH,
-                                            &maxImageX,
-                                            &maxImageY,
-                                            &pixelW,
-                                            &pixelH,
-                                            &chipBpp);
-                if (chipRet == QHYCCD_SUCCESS && maxImageX > 0 && maxImageY > 0) {
-                    const unsigned long long fullFrameBytes =
-                        static_cast<unsigned long long>(maxImageX) *
-                        static_cast<unsigned long long>(maxImageY) *
-                        sizeof(uint16_t) *
-                        3ULL;
-                    if (fullFrameBytes > static_cast<unsigned long long>(safeLength) &&
-                        fullFrameBytes <= static_cast<unsigned long long>(std::numeric_limits<uint32_t>::max())) {
-                        safeLength = static_cast<uint32_t>(fullFrameBytes);
-                    }
-                }
-            }
-            Logger::Log("QHYCCD GetSingleFrame | chip info before read: handle=" +
-                            std::to_string(reinterpret_cast<uintptr_t>(handle)) +
-                            " chipRet=" + std::to_string(chipRet) +
-                            " maxImage=" + std::to_string(maxImageX) + "x" + std::to_string(maxImageY) +
-                            " chipMM=" + std::to_string(chipW) + "x" + std::to_string(chipH) +
-                            " pixelUM=" + std::to_string(pixelW) + "x" + std::to_string(pixelH) +
-                            " chipBpp=" + std::to_string(chipBpp) +
-                            " memLength=" + std::to_string(length) +
-                            " safeLength=" + std::to_string(safeLength),
-                        LogLevel::INFO, DeviceType::CAMERA);
-
-            auto buffer = std::make_shared<std::vector<unsigned char>>(static_cast<size_t>(safeLength));
-            std::memset(buffer->data(), 0, buffer->size());
-            Logger::Log("QHYCCD GetSingleFrame | about to call GetQHYCCDSingleFrame: handle=" +
-                            std::to_string(reinterpret_cast<uintptr_t>(handle)) +
-                            " bufferPtr=" + std::to_string(reinterpret_cast<uintptr_t>(buffer->data())) +
-                            " bufferSize=" + std::to_string(buffer->size()) +
-                            " remaining=" + std::to_string(remaining),
-                        LogLevel::INFO, DeviceType::CAMERA);
-
-            unsigned int roiSizeX = 0;
-            unsigned int roiSizeY = 0;
-            unsigned int bpp      = 0;
-            unsigned int channels = 0;
-
-            unsigned int ret = GetQHYCCDSingleFrame(handle,
-                                                    &roiSizeX,
-                                                    &roiSizeY,
-                                                    &bpp,
-                                                    &channels,
-                                                    buffer->data());
-            Logger::Log("QHYCCD GetSingleFrame | GetQHYCCDSingleFrame returned: ret=" +
-                            std::to_string(ret) +
-                            " roi=" + std::to_string(roiSizeX) + "x" + std::to_string(roiSizeY) +
-                            " bpp=" + std::to_string(bpp) +
-                            " channels=" + std::to_string(channels),
-                        LogLevel::INFO, DeviceType::CAMERA);
-            if (ret != QHYCCD_SUCCESS) {
-                r.success = false;
-                r.message = "GetQHYCCDSingleFrame failed, error code: " + std::to_string(ret);
-                return r;
-            }
+// 19. 获取所需内存大小（GetQHYCCDMemLength）
+SdkResult QhyCameraDriver::cmdGetMemLength(qhyccd_handle* handle, const SdkCommand& /*cmd*/)
+{
+    SdkResult r;
+    uint32_t length = GetQHYCCDMemLength(handle);
+    r.success = (length > 0);
+    r.message = "GetQHYCCDMemLength, length = " + std::to_string(length);
+    r.payload = static_cast<uint32_t>(length);
+    return r;
+}
 
-            // 关键校验：某些情况下 SDK 会返回 ret=0 但 roiSizeX/roiSizeY/bpp/channels 为 0，
-            // 这种帧是无效的，必须让上层继续轮询，而不是当作成功写入 FITS。
-            if (roiSizeX == 0 || roiSizeY == 0 || bpp == 0 || channels == 0) {
-                r.success = false;
-                r.message = "GetQHYCCDSingleFrame returned invalid frame meta: "
-                            "roi=" + std::to_string(roiSizeX) + "x" + std::to_string(roiSizeY) +
-                            " bpp=" + std::to_string(bpp) + " channels=" + std::to_string(channels) +
-                            " (will retry)";
-                return r;
-            }
+// 20. 获取单帧图像（GetQHYCCDSingleFrame，返回 SdkFrameData）
+SdkResult QhyCameraDriver::cmdGetSingleFrame(qhyccd_handle* handle, const SdkCommand& /*cmd*/)
+{
+    SdkResult r;
+    // 关键修复：
+    // QHY SDK 的 GetQHYCCDSingleFrame() 在部分机型/驱动版本下会阻塞等待曝光完成，
+    // 如果上层“轮询定时器”在曝光未完成时调用它，会导致线程卡住（常见表现：Expected 100ms 但 Elapsed 60s+）。
+    // 用 GetQHYCCDExposureRemaining() 做一次非阻塞探测：
+    // - 返回值 > 100：曝光尚未结束（剩余时间），直接让上层继续轮询
+    // - 返回值 <= 100：认为曝光结束，可以尝试读取帧
+    //
+    // 备注：qhyccd.h 注释约定 “100 or less 100,it means exposoure is over”
+    uint32_t remaining = GetQHYCCDExposureRemaining(handle);
+    Logger::Log("QHYCCD GetSingleFrame | exposure remaining query: handle=" +
+                    std::to_string(reinterpret_cast<uintptr_t>(handle)) +
+                    " remaining=" + std::to_string(remaining),
+                LogLevel::DEBUG, DeviceType::CAMERA);
+    // SDK 可能用 0xFFFFFFFF 表示错误（QHYCCD_ERROR）
+    if (remaining == QHYCCD_ERROR) {
+        r.success = false;
+        r.message = "GetQHYCCDExposureRemaining returned QHYCCD_ERROR (will retry)";
+        return r;
+    }
+    if (remaining > 100) {
+        r.success = false;
+        r.message = "Exposure not finished, remaining=" + std::to_string(remaining) + "ms (will retry)";
+        return r;
+    }
 
-            SdkFrameData frame;
-            frame.width    = static_cast<int>(roiSizeX);
-            frame.height   = static_cast<int>(roiSizeY);
-            frame.bpp      = bpp;
-            frame.channels = channels;
-
-            // PoleMaster may return 8-bit mono frames from single exposure.
-            // Keep the raw bit depth and let downstream FITS/preview code handle it.
-            if (channels != 1 || (bpp != 16 && bpp != 8)) {
-                r.success = false;
-                r.message = "GetSingleFrame unsupported format: bpp=" + std::to_string(bpp) +
-                            " channels=" + std::to_string(channels);
-                return r;
-            }
+    uint32_t length = GetQHYCCDMemLength(handle);
+    Logger::Log("QHYCCD GetSingleFrame | mem length query: handle=" +
+                    std::to_string(reinterpret_cast<uintptr_t>(handle)) +
+                    " memLength=" + std::to_string(length),
+                LogLevel::DEBUG, DeviceType::CAMERA);
+    if (length == 0) {
+        r.success = false;
+        r.message = "GetQHYCCDMemLength returned 0";
+        return r;
+    }
 
-            const size_t pixelCount = static_cast<size_t>(roiSizeX) * static_cast<size_t>(roiSizeY);
-            const size_t bytesNeeded = pixelCount * (bpp == 16 ? sizeof(uint16_t) : sizeof(uint8_t));
-            if (bytesNeeded > buffer->size()) {
-                r.success = false;
-                r.message = "GetSingleFrame buffer too small: need " + std::to_string(bytesNeeded) +
-                            " bytes, have " + std::to_string(buffer->size());
-                return r;
+    // 某些机型/SDK 版本下，GetQHYCCDMemLength() 在全幅/ROI/硬件 Bin 切换后可能短暂返回过小值，
+    // 直接把该长度传给 GetQHYCCDSingleFrame() 会导致 SDK 向外部缓冲区越界写，从而触发段错误。
+    // 另外，若相机处于 debayer/RGB 输出，SDK 可能返回 16-bit x 3 channels。
+    // 这里按“整幅 16-bit 3 通道”保守预留容量，先确保 SDK 写入安全；后续仍以返回的 roi/meta 校验有效字节。
+    uint32_t safeLength = length;
+    unsigned int chipRet = QHYCCD_ERROR;
+    double chipW = 0.0;
+    double chipH = 0.0;
+    double pixelW = 0.0;
+    double pixelH = 0.0;
+    unsigned int chipBpp = 0;
+    unsigned int maxImageX = 0;
+    unsigned int maxImageY = 0;
+    {
+        chipRet = GetQHYCCDChipInfo(handle,
+                                    &chipW,
+                                    &chipH,
+                                    &maxImageX,
+                                    &maxImageY,
+                                    &pixelW,
+                                    &pixelH,
+                                    &chipBpp);
+        if (chipRet == QHYCCD_SUCCESS && maxImageX > 0 && maxImageY > 0) {
+            const unsigned long long fullFrameBytes =
+                static_cast<unsigned long long>(maxImageX) *
+                static_cast<unsigned long long>(maxImageY) *
+                sizeof(uint16_t) *
+                3ULL;
+            if (fullFrameBytes > static_cast<unsigned long long>(safeLength) &&
+                fullFrameBytes <= static_cast<unsigned long long>(std::numeric_limits<uint32_t>::max())) {
+                safeLength = static_cast<uint32_t>(fullFrameBytes);
             }
-            frame.rawBuffer = buffer;
-            frame.rawBytes  = bytesNeeded;
-            Logger::Log("QHYCCD GetSingleFrame | frame prepared: bytesNeeded=" +
-                            std::to_string(bytesNeeded) +
-                            " rawBytes=" + std::to_string(frame.rawBytes) +
-                            " width=" + std::to_string(frame.width) +
-                            " height=" + std::to_string(frame.height),
-                        LogLevel::DEBUG, DeviceType::CAMERA);
-
-            r.success = true;
-            r.message = "GetQHYCCDSingleFrame success";
-            r.payload = frame;
-            return r;
         }
+    }
+    Logger::Log("QHYCCD GetSingleFrame | chip info before read: handle=" +
+                    std::to_string(reinterpret_cast<uintptr_t>(handle)) +
+                    " chipRet=" + std::to_string(chipRet) +
+                    " maxImage=" + std::to_string(maxImageX) + "x" + std::to_string(maxImageY) +
+                    " chipMM=" + std::to_string(chipW) + "x" + std::to_string(chipH) +
+                    " pixelUM=" + std::to_string(pixelW) + "x" + std::to_string(pixelH) +
+                    " chipBpp=" + std::to_string(chipBpp) +
+                    " memLength=" + std::to_string(length) +
+                    " safeLength=" + std::to_string(safeLength),
+                LogLevel::INFO, DeviceType::CAMERA);
+
+    auto buffer = std::make_shared<std::vector<unsigned char>>(static_cast<size_t>(safeLength));
+    std::memset(buffer->data(), 0, buffer->size());
+    Logger::Log("QHYCCD GetSingleFrame | about to call GetQHYCCDSingleFrame: handle=" +
+                    std::to_string(reinterpret_cast<uintptr_t>(handle)) +
+                    " bufferPtr=" + std::to_string(reinterpret_cast<uintptr_t>(buffer->data())) +
+                    " bufferSize=" + std::to_string(buffer->size()) +
+                    " remaining=" + std::to_string(remaining),
+                LogLevel::INFO, DeviceType::CAMERA);
+
+    unsigned int roiSizeX = 0;
+    unsigned int roiSizeY = 0;
+    unsigned int bpp      = 0;
+    unsigned int channels = 0;
+
+    unsigned int ret = GetQHYCCDSingleFrame(handle,
+                                            &roiSizeX,
+                                            &roiSizeY,
+                                            &bpp,
+                                            &channels,
+                                            buffer->data());
+    Logger::Log("QHYCCD GetSingleFrame | GetQHYCCDSingleFrame returned: ret=" +
+                    std::to_string(ret) +
+                    " roi=" + std::to_string(roiSizeX) + "x" + std::to_string(roiSizeY) +
+                    " bpp=" + std::to_string(bpp) +
+                    " channels=" + std::to_string(channels),
+                LogLevel::INFO, DeviceType::CAMERA);
+    if (ret != QHYCCD_SUCCESS) {
+        r.success = false;
+        r.message = "GetQHYCCDSingleFrame failed, error code: " + std::to_string(ret);
+        return r;
+    }
 
-        // 20-扩展. 进入 Live 模式（BeginQHYCCDLive）
-        if (name == "BeginLive") {
-            if (!handle) {
-                r.success = false;
-                r.message = "BeginLive requires a valid device handle";
-                return r;
-            }
-            unsigned int ret = BeginQHYCCDLive(handle);
-            return makeResultFromRet("BeginQHYCCDLive", ret);
-        }
+    // 关键校验：某些情况下 SDK 会返回 ret=0 但 roiSizeX/roiSizeY/bpp/channels 为 0，
+    // 这种帧是无效的，必须让上层继续轮询，而不是当作成功写入 FITS。
+    if (roiSizeX == 0 || roiSizeY == 0 || bpp == 0 || channels == 0) {
+        r.success = false;
+        r.message = "GetQHYCCDSingleFrame returned invalid frame meta: "
+                    "roi=" + std::to_string(roiSizeX) + "x" + std::to_string(roiSizeY) +
+                    " bpp=" + std::to_string(bpp) + " channels=" + std::to_string(channels) +
+                    " (will retry)";
+        return r;
+    }
 
-        // 20-扩展. 获取 Live 帧（GetQHYCCDLiveFrame，返回 SdkFrameData）
-        if (name == "GetLiveFrame") {
-            if (!handle) {
-                r.success = false;
-                r.message = "GetLiveFrame requires a valid device handle";
-                return r;
-            }
+    SdkFrameData frame;
+    frame.width    = static_cast<int>(roiSizeX);
+    frame.height   = static_cast<int>(roiSizeY);
+    frame.bpp      = bpp;
+    frame.channels = channels;
 
-            uint32_t length = GetQHYCCDMemLength(handle);
-            if (length == 0) {
-                r.success = false;
-                r.message = "GetQHYCCDMemLength returned 0";
-                return r;
-            }
+    // PoleMaster may return 8-bit mono frames from single exposure.
+    // Keep the raw bit depth and let downstream FITS/preview code handle it.
+    if (channels != 1 || (bpp != 16 && bpp != 8)) {
+        r.success = false;
+        r.message = "GetSingleFrame unsupported format: bpp=" + std::to_string(bpp) +
+                    " channels=" + std::to_string(channels);
+        return r;
+    }
 
-            // 性能优化：复用缓冲区，避免每帧分配/清零大内存（行为更接近官方 demo）
-            // 注意：SDK 会写满 buffer（至少写入 roi 对应的有效字节），这里不做 memset 以降低开销。
-            bool exclusive = true;
-            auto buffer = acquireLiveBuffer(handle, length, &exclusive);
-
-            unsigned int roiSizeX = 0;
-            unsigned int roiSizeY = 0;
-            unsigned int bpp      = 0;
-            unsigned int channels = 0;
-
-            unsigned int ret = GetQHYCCDLiveFrame(handle,
-                                                  &roiSizeX,
-                                                  &roiSizeY,
-                                                  &bpp,
-                                                  &channels,
-                                                  buffer->data());
-            if (ret != QHYCCD_SUCCESS) {
-                r.success = false;
-                r.message = "GetQHYCCDLiveFrame failed, error code: " + std::to_string(ret);
-                return r;
-            }
+    const size_t pixelCount = static_cast<size_t>(roiSizeX) * static_cast<size_t>(roiSizeY);
+    const size_t bytesNeeded = pixelCount * (bpp == 16 ? sizeof(uint16_t) : sizeof(uint8_t));
+    if (bytesNeeded > buffer->size()) {
+        r.success = false;
+        r.message = "GetSingleFrame buffer too small: need " + std::to_string(bytesNeeded) +
+                    " bytes, have " + std::to_string(buffer->size());
+        return r;
+    }
+    frame.rawBuffer = buffer;
+    frame.rawBytes  = bytesNeeded;
+    Logger::Log("QHYCCD GetSingleFrame | frame prepared: bytesNeeded=" +
+                    std::to_string(bytesNeeded) +
+                    " rawBytes=" + std::to_string(frame.rawBytes) +
+                    " width=" + std::to_string(frame.width) +
+                    " height=" + std::to_string(frame.height),
+                LogLevel::DEBUG, DeviceType::CAMERA);
 
-            // 防御：SDK 有时返回 ret=0 但 meta 为 0，这种帧无效
-            if (roiSizeX == 0 || roiSizeY == 0 || bpp == 0 || channels == 0) {
-                r.success = false;
-                r.message = "GetQHYCCDLiveFrame returned invalid frame meta: "
-                            "roi=" + std::to_string(roiSizeX) + "x" + std::to_string(roiSizeY) +
-                            " bpp=" + std::to_string(bpp) + " channels=" + std::to_string(channels);
-                return r;
-            }
+    r.success = true;
+    r.message = "GetQHYCCDSingleFrame success";
+    r.frame   = std::move(frame);
+    return r;
+}
 
-            // Live 模式下部分机型/驱动可能返回 8-bit 单通道；这里兼容并转换为 16-bit 单通道，
-            // 以复用现有 FITS/PNG 处理链路。
-            if (channels != 1 || (bpp != 16 && bpp != 8)) {
-                r.success = false;
-                r.message = "GetLiveFrame unsupported format: bpp=" + std::to_string(bpp) +
-                            " channels=" + std::to_string(channels);
-                return r;
-            }
+// 20-扩展. 进入 Live 模式（BeginQHYCCDLive）
+SdkResult QhyCameraDriver::cmdBeginLive(qhyccd_handle* handle, const SdkCommand& /*cmd*/)
+{
+    unsigned int ret = BeginQHYCCDLive(handle);
+    return makeResultFromRet("BeginQHYCCDLive", ret);
+}
 
-            const size_t pixelCount = static_cast<size_t>(roiSizeX) * static_cast<size_t>(roiSizeY);
-            const size_t bytesNeeded = pixelCount * (bpp == 16 ? sizeof(uint16_t) : sizeof(uint8_t));
-            if (bytesNeeded > buffer->size()) {
-                r.success = false;
-                r.message = "GetLiveFrame buffer too small: need " + std::to_string(bytesNeeded) +
-                            " bytes, have " + std::to_string(buffer->size());
-                return r;
-            }
+// 20-扩展. 获取 Live 帧（GetQHYCCDLiveFrame，返回 SdkFrameData）
+SdkResult QhyCameraDriver::cmdGetLiveFrame(qhyccd_handle* handle, const SdkCommand& /*cmd*/)
+{
+    SdkResult r;
+    uint32_t length = GetQHYCCDMemLength(handle);
+    if (length == 0) {
+        r.success = false;
+        r.message = "GetQHYCCDMemLength returned 0";
+        return r;
+    }
 
-            SdkFrameData frame;
-            frame.width    = static_cast<int>(roiSizeX);
-            frame.height   = static_cast<int>(roiSizeY);
-            frame.bpp      = bpp;
-            frame.channels = channels;
-
-            // 零拷贝路径：仅在 buffer 不会被下一帧覆盖时启用（exclusive=true）
-            // 约束：当前仅支持单通道（channels==1）的 8/16bit 原始数据直通到主线程写 FITS
-            if (exclusive && channels == 1 && (bpp == 16 || bpp == 8)) {
-                frame.rawBuffer = buffer;
-                frame.rawBytes  = bytesNeeded;
-            } else {
-                // 回退拷贝路径：保证在缓冲池被占满/格式不支持时仍可稳定出图
-                {
-                    const long long nowMs =
-                        std::chrono::duration_cast<std::chrono::milliseconds>(
-                            std::chrono::steady_clock::now().time_since_epoch()).count();
-                    long long expected = g_lastLiveCopyWarnMs.load(std::memory_order_relaxed);
-                    if (nowMs - expected >= 2000) {
-                        if (g_lastLiveCopyWarnMs.compare_exchange_strong(expected, nowMs, std::memory_order_relaxed)) {
-                            Logger::Log(
-                                std::string("QHYCCD GetLiveFrame | WARNING: fallback to COPY path (zero-copy disabled). ") +
-                                    "reason=" + (exclusive ? "format_or_other" : "buffer_pool_busy") +
-                                    " roi=" + std::to_string(roiSizeX) + "x" + std::to_string(roiSizeY) +
-                                    " bpp=" + std::to_string(bpp) +
-                                    " channels=" + std::to_string(channels) +
-                                    " memLength=" + std::to_string(length) +
-                                    " bytesNeeded=" + std::to_string(bytesNeeded),
-                                LogLevel::WARNING, DeviceType::CAMERA);
-                        }
-                    }
-                }
-                if (channels != 1 || (bpp != 16 && bpp != 8)) {
-                    r.success = false;
-                    r.message = "GetLiveFrame unsupported format: bpp=" + std::to_string(bpp) +
-                                " channels=" + std::to_string(channels);
-                    return r;
-                }
-                frame.pixels.resize(pixelCount);
-                frame.bpp      = 16;
-                frame.channels = 1;
-                if (bpp == 16) {
-                    const uint16_t* src = reinterpret_cast<const uint16_t*>(buffer->data());
-                    std::memcpy(frame.pixels.data(), src, pixelCount * sizeof(uint16_t));
-                } else {
-                    const uint8_t* src = reinterpret_cast<const uint8_t*>(buffer->data());
-                    // 8->16 展开：255 映射到 65535
-                    for (size_t i = 0; i < pixelCount; ++i) {
-                        frame.pixels[i] = static_cast<uint16_t>(src[i]) * 257;
-                    }
+    // 性能优化：复用缓冲区，避免每帧分配/清零大内存（行为更接近官方 demo）
+    // 注意：SDK 会写满 buffer（至少写入 roi 对应的有效字节），这里不做 memset 以降低开销。
+    bool exclusive = true;
+    auto buffer = acquireLiveBuffer(handle, length, &exclusive);
+
+    unsigned int roiSizeX = 0;
+    unsigned int roiSizeY = 0;
+    unsigned int bpp      = 0;
+    unsigned int channels = 0;
+
+    unsigned int ret = GetQHYCCDLiveFrame(handle,
+                                          &roiSizeX,
+                                          &roiSizeY,
+                                          &bpp,
+                                          &channels,
+                                          buffer->data());
+    if (ret != QHYCCD_SUCCESS) {
+        r.success = false;
+        r.message = "GetQHYCCDLiveFrame failed, error code: " + std::to_string(ret);
+        return r;
+    }
+
+    // 防御：SDK 有时返回 ret=0 但 meta 为 0，这种帧无效
+    if (roiSizeX == 0 || roiSizeY == 0 || bpp == 0 || channels == 0) {
+        r.success = false;
+        r.message = "GetQHYCCDLiveFrame returned invalid frame meta: "
+                    "roi=" + std::to_string(roiSizeX) + "x" + std::to_string(roiSizeY) +
+                    " bpp=" + std::to_string(bpp) + " channels=" + std::to_string(channels);
+        return r;
+    }
+
+    // Live 模式下部分机型/驱动可能返回 8-bit 单通道；这里兼容并转换为 16-bit 单通道，
+    // 以复用现有 FITS/PNG 处理链路。
+    if (channels != 1 || (bpp != 16 && bpp != 8)) {
+        r.success = false;
+        r.message = "GetLiveFrame unsupported format: bpp=" + std::to_string(bpp) +
+                    " channels=" + std::to_string(channels);
+        return r;
+    }
+
+    const size_t pixelCount = static_cast<size_t>(roiSizeX) * static_cast<size_t>(roiSizeY);
+    const size_t bytesNeeded = pixelCount * (bpp == 16 ? sizeof(uint16_t) : sizeof(uint8_t));
+    if (bytesNeeded > buffer->size()) {
+        r.success = false;
+        r.message = "GetLiveFrame buffer too small: need " + std::to_string(bytesNeeded) +
+                    " bytes, have " + std::to_string(buffer->size());
+        return r;
+    }
+
+    SdkFrameData frame;
+    frame.width    = static_cast<int>(roiSizeX);
+    frame.height   = static_cast<int>(roiSizeY);
+    frame.bpp      = bpp;
+    frame.channels = channels;
+
+    // 零拷贝路径：仅在 buffer 不会被下一帧覆盖时启用（exclusive=true）
+    // 约束：当前仅支持单通道（channels==1）的 8/16bit 原始数据直通到主线程写 FITS
+    if (exclusive && channels == 1 && (bpp == 16 || bpp == 8)) {
+        frame.rawBuffer = buffer;
+        frame.rawBytes  = bytesNeeded;
+    } else {
+        // 回退拷贝路径：保证在缓冲池被占满/格式不支持时仍可稳定出图
+        {
+            const long long nowMs =
+                std::chrono::duration_cast<std::chrono::milliseconds>(
+                    std::chrono::steady_clock::now().time_since_epoch()).count();
+            long long expected = g_lastLiveCopyWarnMs.load(std::memory_order_relaxed);
+            if (nowMs - expected >= 2000) {
+                if (g_lastLiveCopyWarnMs.compare_exchange_strong(expected, nowMs, std::memory_order_relaxed)) {
+                    Logger::Log(
+                        std::string("QHYCCD GetLiveFrame | WARNING: fallback to COPY path (zero-copy disabled). ") +
+                            "reason=" + (exclusive ? "format_or_other" : "buffer_pool_busy") +
+                            " roi=" + std::to_string(roiSizeX) + "x" + std::to_string(roiSizeY) +
+                            " bpp=" + std::to_string(bpp) +
+                            " channels=" + std::to_string(channels) +
+                            " memLength=" + std::to_string(length) +
+                            " bytesNeeded=" + std::to_string(bytesNeeded),
+                        LogLevel::WARNING, DeviceType::CAMERA);
                 }
             }
-
-            r.success = true;
-            r.message = "GetQHYCCDLiveFrame success";
-            r.payload = frame;
+        }
+        if (channels != 1 || (bpp != 16 && bpp != 8)) {
+            r.success = false;
+            r.message = "GetLiveFrame unsupported format: bpp=" + std::to_string(bpp) +
+                        " channels=" + std::to_string(channels);
             return r;
         }
-
-        // 20-扩展. 获取 Live 帧（Fast）：复用缓冲区且不拷贝 pixels（仅返回 meta）
-        // 适用场景：只想确认“持续出帧”，不做任何后处理/前端显示。
-        if (name == "GetLiveFrameFast") {
-            if (!handle) {
-                r.success = false;
-                r.message = "GetLiveFrameFast requires a valid device handle";
-                return r;
-            }
-
-            uint32_t length = GetQHYCCDMemLength(handle);
-            if (length == 0) {
-                r.success = false;
-                r.message = "GetQHYCCDMemLength returned 0";
-                return r;
+        frame.pixels.resize(pixelCount);
+        frame.bpp      = 16;
+        frame.channels = 1;
+        if (bpp == 16) {
+            const uint16_t* src = reinterpret_cast<const uint16_t*>(buffer->data());
+            std::memcpy(frame.pixels.data(), src, pixelCount * sizeof(uint16_t));
+        } else {
+            const uint8_t* src = reinterpret_cast<const uint8_t*>(buffer->data());
+            // 8->16 展开：255 映射到 65535
+            for (size_t i = 0; i < pixelCount; ++i) {
+                frame.pixels[i] = static_cast<uint16_t>(src[i]) * 257;
             }
+        }
+    }
 
-            // Fast 版本不返回像素，不需要零拷贝防覆盖保证；但仍复用缓冲池降低分配开销
-            auto buffer = acquireLiveBuffer(handle, length, nullptr);
-
-            unsigned int roiSizeX = 0;
-            unsigned int roiSizeY = 0;
-            unsigned int bpp      = 0;
-            unsigned int channels = 0;
-
-            unsigned int ret = GetQHYCCDLiveFrame(handle,
-                                                  &roiSizeX,
-                                                  &roiSizeY,
-                                                  &bpp,
-                                                  &channels,
-                                                  buffer->data());
-            if (ret != QHYCCD_SUCCESS) {
-                r.success = false;
-                r.message = "GetQHYCCDLiveFrame failed, error code: " + std::to_string(ret);
-                return r;
-            }
+    // Live 热路径：成功时不填 message（避免每帧一次字符串堆分配），帧按值移动进结果
+    r.success = true;
+    r.frame   = std::move(frame);
+    return r;
+}
 
-            if (roiSizeX == 0 || roiSizeY == 0 || bpp == 0 || channels == 0) {
-                r.success = false;
-                r.message = "GetQHYCCDLiveFrame returned invalid frame meta: "
-                            "roi=" + std::to_string(roiSizeX) + "x" + std::to_string(roiSizeY) +
-                            " bpp=" + std::to_string(bpp) + " channels=" + std::to_string(channels);
-                return r;
-            }
+// 20-扩展. 获取 Live 帧（Fast）：复用缓冲区且不拷贝 pixels（仅返回 meta）
+// 适用场景：只想确认“持续出帧”，不做任何后处理/前端显示。
+SdkResult QhyCameraDriver::cmdGetLiveFrameFast(qhyccd_handle* handle, const SdkCommand& /*cmd*/)
+{
+    SdkResult r;
+    uint32_t length = GetQHYCCDMemLength(handle);
+    if (length == 0) {
+        r.success = false;
+        r.message = "GetQHYCCDMemLength returned 0";
+        return r;
+    }
 
-            SdkFrameData frame;
-            frame.width    = static_cast<int>(roiSizeX);
-            frame.height   = static_cast<int>(roiSizeY);
-            frame.bpp      = bpp;
-            frame.channels = channels;
-            // pixels intentionally empty (no copy)
+    // Fast 版本不返回像素，不需要零拷贝防覆盖保证；但仍复用缓冲池降低分配开销
+    auto buffer = acquireLiveBuffer(handle, length, nullptr);
+
+    unsigned int roiSizeX = 0;
+    unsigned int roiSizeY = 0;
+    unsigned int bpp      = 0;
+    unsigned int channels = 0;
+
+    unsigned int ret = GetQHYCCDLiveFrame(handle,
+                                          &roiSizeX,
+                                          &roiSizeY,
+                                          &bpp,
+                                          &channels,
+                                          buffer->data());
+    if (ret != QHYCCD_SUCCESS) {
+        r.success = false;
+        r.message = "GetQHYCCDLiveFrame failed, error code: " + std::to_string(ret);
+        return r;
+    }
 
-            r.success = true;
-            r.message = "GetQHYCCDLiveFrame success (fast, no pixels copy)";
-            r.payload = frame;
-            return r;
-        }
+    if (roiSizeX == 0 || roiSizeY == 0 || bpp == 0 || channels == 0) {
+        r.success = false;
+        r.message = "GetQHYCCDLiveFrame returned invalid frame meta: "
+                    "roi=" + std::to_string(roiSizeX) + "x" + std::to_string(roiSizeY) +
+                    " bpp=" + std::to_string(bpp) + " channels=" + std::to_string(channels);
+        return r;
+    }
 
-        // 20-扩展. 停止 Live 模式（StopQHYCCDLive）
-        if (name == "StopLive") {
-            if (!handle) {
-                r.success = false;
-                r.message = "StopLive requires a valid device handle";
-                return r;
-            }
-            unsigned int ret = StopQHYCCDLive(handle);
-            return makeResultFromRet("StopQHYCCDLive", ret);
-        }
+    SdkFrameData frame;
+    frame.width    = static_cast<int>(roiSizeX);
+    frame.height   = static_cast<int>(roiSizeY);
+    frame.bpp      = bpp;
+    frame.channels = channels;
+    // pixels intentionally empty (no copy)
 
-        // 20-Burst. 开启/关闭 Burst 子模式（EnableQHYCCDBurstMode）
-        if (name == "EnableBurstMode") {
-            if (!handle) {
-                r.success = false;
-                r.message = "EnableBurstMode requires a valid device handle";
-                return r;
-            }
-            bool enable = false;
-            if (!extractParam<bool>(cmd.payload, enable, r, "enable")) {
-                return r;
-            }
-            unsigned int ret = EnableQHYCCDBurstMode(handle, enable);
-            return makeResultFromRet(std::string("EnableQHYCCDBurstMode ") + (enable ? "true" : "false"), ret);
-        }
+    r.success = true;
+    r.frame   = std::move(frame);
+    return r;
+}
 
-        // 20-Burst. 设置 start/end（SetQHYCCDBurstModeStartEnd）
-        if (name == "SetBurstStartEnd") {
-            if (!handle) {
-                r.success = false;
-                r.message = "SetBurstStartEnd requires a valid device handle";
-                return r;
-            }
-            std::pair<int,int> se;
-            if (!extractParam<std::pair<int,int>>(cmd.payload, se, r, "startEnd")) {
-                return r;
-            }
-            const int start = std::max(0, se.first);
-            const int end   = std::max(0, se.second);
-            unsigned int ret = SetQHYCCDBurstModeStartEnd(handle,
-                                                          static_cast<unsigned short>(start),
-                                                          static_cast<unsigned short>(end));
-            return makeResultFromRet("SetQHYCCDBurstModeStartEnd", ret);
-        }
+// 20-扩展. 停止 Live 模式（StopQHYCCDLive）
+SdkResult QhyCameraDriver::cmdStopLive(qhyccd_handle* handle, const SdkCommand& /*cmd*/)
+{
+    unsigned int ret = StopQHYCCDLive(handle);
+    return makeResultFromRet("StopQHYCCDLive", ret);
+}
 
-        // 20-Burst. Reset frame counter
-        if (name == "ResetFrameCounter") {
-            if (!handle) {
-                r.success = false;
-                r.message = "ResetFrameCounter requires a valid device handle";
-                return r;
-            }
-            unsigned int ret = ResetQHYCCDFrameCounter(handle);
-            return makeResultFromRet("ResetQHYCCDFrameCounter", ret);
-        }
+// 20-Burst. 开启/关闭 Burst 子模式（EnableQHYCCDBurstMode）
+SdkResult QhyCameraDriver::cmdEnableBurstMode(qhyccd_handle* handle, const SdkCommand& cmd)
+{
+    const bool enable = payloadAs<bool>(cmd);
+    unsigned int ret = EnableQHYCCDBurstMode(handle, enable);
+    return makeResultFromRet(std::string("EnableQHYCCDBurstMode ") + (enable ? "true" : "false"), ret);
+}
 
-        // 20-Burst. 进入 IDLE（SetQHYCCDBurstIDLE）
-        if (name == "SetBurstIDLE") {
-            if (!handle) {
-                r.success = false;
-                r.message = "SetBurstIDLE requires a valid device handle";
-                return r;
-            }
-            unsigned int ret = SetQHYCCDBurstIDLE(handle);
-            return makeResultFromRet("SetQHYCCDBurstIDLE", ret);
-        }
+// 20-Burst. 设置 start/end（SetQHYCCDBurstModeStartEnd）
+SdkResult QhyCameraDriver::cmdSetBurstStartEnd(qhyccd_handle* handle, const SdkCommand& cmd)
+{
+    const std::pair<int,int> se = payloadAs<std::pair<int,int>>(cmd);
+    const int start = std::max(0, se.first);
+    const int end   = std::max(0, se.second);
+    unsigned int ret = SetQHYCCDBurstModeStartEnd(handle,
+                                                  static_cast<unsigned short>(start),
+                                                  static_cast<unsigned short>(end));
+    return makeResultFromRet("SetQHYCCDBurstModeStartEnd", ret);
+}
 
-        // 20-Burst. 释放 IDLE（ReleaseQHYCCDBurstIDLE）
-        if (name == "ReleaseBurstIDLE") {
-            if (!handle) {
-                r.success = false;
-                r.message = "ReleaseBurstIDLE requires a valid device handle";
-                return r;
-            }
-            unsigned int ret = ReleaseQHYCCDBurstIDLE(handle);
-            return makeResultFromRet("ReleaseQHYCCDBurstIDLE", ret);
-        }
+// 20-Burst. Reset frame counter
+SdkResult QhyCameraDriver::cmdResetFrameCounter(qhyccd_handle* handle, const SdkCommand& /*cmd*/)
+{
+    unsigned int ret = ResetQHYCCDFrameCounter(handle);
+    return makeResultFromRet("ResetQHYCCDFrameCounter", ret);
+}
 
-        // 20-Burst. 设置补包数量（SetQHYCCDBurstModePatchNumber）
-        if (name == "SetBurstPatchNumber") {
-            if (!handle) {
-                r.success = false;
-                r.message = "SetBurstPatchNumber requires a valid device handle";
-                return r;
-            }
-            uint32_t v = 0;
-            if (!extractParam<uint32_t>(cmd.payload, v, r, "patchNumber")) {
-                return r;
-            }
-            unsigned int ret = SetQHYCCDBurstModePatchNumber(handle, v);
-            return makeResultFromRet("SetQHYCCDBurstModePatchNumber", ret);
-        }
+// 20-Burst. 进入 IDLE（SetQHYCCDBurstIDLE）
+SdkResult QhyCameraDriver::cmdSetBurstIDLE(qhyccd_handle* handle, const SdkCommand& /*cmd*/)
+{
+    unsigned int ret = SetQHYCCDBurstIDLE(handle);
+    return makeResultFromRet("SetQHYCCDBurstIDLE", ret);
+}
 
-        // 21. 检测是否支持单帧模式（CAM_SINGLEFRAMEMODE）
-        if (name == "CheckSingleFrameModeAvailable") {
-            if (!handle) {
-                r.success = false;
-                r.message = "CheckSingleFrameModeAvailable requires a valid device handle";
-                return r;
-            }
-            unsigned int ret = IsQHYCCDControlAvailable(handle, CAM_SINGLEFRAMEMODE);
-            bool available = (ret != QHYCCD_ERROR);
-            r.success = true;
-            r.payload = available;
-            r.message = available
-                        ? "CAM_SINGLEFRAMEMODE is available"
-                        : "CAM_SINGLEFRAMEMODE is NOT available";
-            return r;
-        }
+// 20-Burst. 释放 IDLE（ReleaseQHYCCDBurstIDLE）
+SdkResult QhyCameraDriver::cmdReleaseBurstIDLE(qhyccd_handle* handle, const SdkCommand& /*cmd*/)
+{
+    unsigned int ret = ReleaseQHYCCDBurstIDLE(handle);
+    return makeResultFromRet("ReleaseQHYCCDBurstIDLE", ret);
+}
 
-        // 22. 判断彩色 / 黑白相机（CAM_IS_COLOR）
-        if (name == "IsColorCamera") {
-            if (!handle) {
-                r.success = false;
-                r.message = "IsColorCamera requires a valid device handle";
-                return r;
-            }
-            unsigned int ret = IsQHYCCDControlAvailable(handle, CAM_IS_COLOR);
-            bool isColor = (ret == QHYCCD_SUCCESS);
-            r.success = true;
-            r.payload = isColor;
-            r.message = isColor
-                        ? "Color camera detected by CAM_IS_COLOR"
-                        : ("Monochrome camera or CAM_IS_COLOR not supported, ret=" + std::to_string(ret));
-            return r;
-        }
+// 20-Burst. 设置补包数量（SetQHYCCDBurstModePatchNumber）
+SdkResult QhyCameraDriver::cmdSetBurstPatchNumber(qhyccd_handle* handle, const SdkCommand& cmd)
+{
+    const uint32_t v = payloadAs<uint32_t>(cmd);
+    unsigned int ret = SetQHYCCDBurstModePatchNumber(handle, v);
+    return makeResultFromRet("SetQHYCCDBurstModePatchNumber", ret);
+}
 
-        // 22-扩展. 获取彩色相机 CFA（CAM_IS_COLOR -> 临时 DebayerOn -> CAM_COLOR -> 恢复 DebayerOff）
-        if (name == "GetCameraCfa") {
-            if (!handle) {
-                r.success = false;
-                r.message = "GetCameraCfa requires a valid device handle";
-                return r;
-            }
+// 21. 检测是否支持单帧模式（CAM_SINGLEFRAMEMODE）
+SdkResult QhyCameraDriver::cmdCheckSingleFrameModeAvailable(qhyccd_handle* handle, const SdkCommand& /*cmd*/)
+{
+    SdkResult r;
+    unsigned int ret = IsQHYCCDControlAvailable(handle, CAM_SINGLEFRAMEMODE);
+    bool available = (ret != QHYCCD_ERROR);
+    r.success = true;
+    r.payload = available;
+    r.message = available
+                ? "CAM_SINGLEFRAMEMODE is available"
+                : "CAM_SINGLEFRAMEMODE is NOT available";
+    return r;
+}
 
-            unsigned int colorRet = IsQHYCCDControlAvailable(handle, CAM_IS_COLOR);
-            if (colorRet != QHYCCD_SUCCESS) {
-                r.success = true;
-                r.payload = std::string();
-                r.message = "Camera is monochrome or CAM_IS_COLOR not supported";
-                return r;
-            }
+// 22. 判断彩色 / 黑白相机（CAM_IS_COLOR）
+SdkResult QhyCameraDriver::cmdIsColorCamera(qhyccd_handle* handle, const SdkCommand& /*cmd*/)
+{
+    SdkResult r;
+    unsigned int ret = IsQHYCCDControlAvailable(handle, CAM_IS_COLOR);
+    bool isColor = (ret == QHYCCD_SUCCESS);
+    r.success = true;
+    r.payload = isColor;
+    r.message = isColor
+                ? "Color camera detected by CAM_IS_COLOR"
+                : ("Monochrome camera or CAM_IS_COLOR not supported, ret=" + std::to_string(ret));
+    return r;
+}
 
-            unsigned int debayerRet = SetQHYCCDDebayerOnOff(handle, true);
-            if (debayerRet != QHYCCD_SUCCESS) {
-                r.success = false;
-                r.errorCode = SdkErrorCode::OperationFailed;
-                r.message = "SetQHYCCDDebayerOnOff(true) failed, error code: " + std::to_string(debayerRet);
-                return r;
-            }
+// 22-扩展. 获取彩色相机 CFA（CAM_IS_COLOR -> 临时 DebayerOn -> CAM_COLOR -> 恢复 DebayerOff）
+SdkResult QhyCameraDriver::cmdGetCameraCfa(qhyccd_handle* handle, const SdkCommand& /*cmd*/)
+{
+    SdkResult r;
+    unsigned int colorRet = IsQHYCCDControlAvailable(handle, CAM_IS_COLOR);
+    if (colorRet != QHYCCD_SUCCESS) {
+        r.success = true;
+        r.payload = std::string();
+        r.message = "Camera is monochrome or CAM_IS_COLOR not supported";
+        return r;
+    }
 
-            unsigned int bayerRet = IsQHYCCDControlAvailable(handle, CAM_COLOR);
-            const std::string cfa = qhyBayerIdToCfaString(bayerRet);
-            const unsigned int restoreRet = SetQHYCCDDebayerOnOff(handle, false);
-            if (restoreRet != QHYCCD_SUCCESS) {
-                Logger::Log("QHYCCD GetCameraCfa | failed to restore DebayerOff, error code: " +
-                                std::to_string(restoreRet),
-                            LogLevel::WARNING, DeviceType::CAMERA);
-            }
-            if (cfa.empty()) {
-                r.success = false;
-                r.errorCode = SdkErrorCode::OperationFailed;
-                r.message = "Unknown Bayer matrix code from CAM_COLOR: " + std::to_string(bayerRet);
-                return r;
-            }
+    unsigned int debayerRet = SetQHYCCDDebayerOnOff(handle, true);
+    if (debayerRet != QHYCCD_SUCCESS) {
+        r.success = false;
+        r.errorCode = SdkErrorCode::OperationFailed;
+        r.message = "SetQHYCCDDebayerOnOff(true) failed, error code: " + std::to_string(debayerRet);
+        return r;
+    }
 
-            r.success = true;
-            r.payload = cfa;
-            r.message = "CFA detected: " + cfa + " (Bayer code: " + std::to_string(bayerRet) + ")";
-            return r;
-        }
+    unsigned int bayerRet = IsQHYCCDControlAvailable(handle, CAM_COLOR);
+    const std::string cfa = qhyBayerIdToCfaString(bayerRet);
+    const unsigned int restoreRet = SetQHYCCDDebayerOnOff(handle, false);
+    if (restoreRet != QHYCCD_SUCCESS) {
+        Logger::Log("QHYCCD GetCameraCfa | failed to restore DebayerOff, error code: " +
+                        std::to_string(restoreRet),
+                    LogLevel::WARNING, DeviceType::CAMERA);
+    }
+    if (cfa.empty()) {
+        r.success = false;
+        r.errorCode = SdkErrorCode::OperationFailed;
+        r.message = "Unknown Bayer matrix code from CAM_COLOR: " + std::to_string(bayerRet);
+        return r;
+    }
 
-        // 23. 获取当前温度（CONTROL_CURTEMP）
-        if (name == "GetCurrentTemperature") {
-            if (!handle) {
-                r.success = false;
-                r.message = "GetCurrentTemperature requires a valid device handle";
-                return r;
-            }
-            double temp = GetQHYCCDParam(handle, CONTROL_CURTEMP);
-            r.success = true;
-            r.payload = temp;
-            r.message = "Current sensor temperature = " + std::to_string(temp) + " C";
-            return r;
-        }
+    r.success = true;
+    r.payload = cfa;
+    r.message = "CFA detected: " + cfa + " (Bayer code: " + std::to_string(bayerRet) + ")";
+    return r;
+}
 
-        // 24. 设置制冷目标温度（CONTROL_COOLER）
-        if (name == "SetCoolerTargetTemperature") {
-            if (!handle) {
-                r.success = false;
-                r.message = "SetCoolerTargetTemperature requires a valid device handle";
-                return r;
-            }
-            double target = 0.0;
-            if (!extractParam<double>(cmd.payload, target, r, "targetTemperature")) {
-                return r;
-            }
-            unsigned int ret = SetQHYCCDParam(handle, CONTROL_COOLER, target);
-            return makeResultFromRet("SetQHYCCDParam CONTROL_COOLER", ret);
-        }
+// 23. 获取当前温度（CONTROL_CURTEMP）
+SdkResult QhyCameraDriver::cmdGetCurrentTemperature(qhyccd_handle* handle, const SdkCommand& /*cmd*/)
+{
+    SdkResult r;
+    double temp = GetQHYCCDParam(handle, CONTROL_CURTEMP);
+    r.success = true;
+    r.payload = temp;
+    r.message = "Current sensor temperature = " + std::to_string(temp) + " C";
+    return r;
+}
 
-        // 24-扩展. 获取制冷目标温度的范围及当前值（CONTROL_COOLER）
-        if (name == "GetCoolerTargetTemperature") {
-            if (!handle) {
-                r.success = false;
-                r.message = "GetCoolerTargetTemperature requires a valid device handle";
-                return r;
-            }
-            double minV = 0.0, maxV = 0.0, stepV = 0.0;
-            uint32_t ret = GetQHYCCDParamMinMaxStep(handle, CONTROL_COOLER, &minV, &maxV, &stepV);
-            double cur = GetQHYCCDParam(handle, CONTROL_COOLER);
-            if (ret != QHYCCD_SUCCESS || cur == QHYCCD_ERROR) {
-                r.success = false;
-                r.message = "GetQHYCCDParamMinMaxStep/CONTROL_COOLER failed";
-            } else {
-                SdkControlParamInfo info;
-                info.minValue = minV;
-                info.maxValue = maxV;
-                info.step     = stepV;
-                info.current  = cur;
-                r.success = true;
-                r.payload = info;
-                r.message = "Cooler target temperature param info acquired";
-            }
-            return r;
-        }
+// 24. 设置制冷目标温度（CONTROL_COOLER）
+SdkResult QhyCameraDriver::cmdSetCoolerTargetTemperature(qhyccd_handle* handle, const SdkCommand& cmd)
+{
+    const double target = payloadAs<double>(cmd);
+    unsigned int ret = SetQHYCCDParam(handle, CONTROL_COOLER, target);
+    return makeResultFromRet("SetQHYCCDParam CONTROL_COOLER", ret);
+}
 
-        // 25. 获取当前制冷功率（CONTROL_CURPWM）
-        if (name == "GetCoolerPower") {
-            if (!handle) {
-                r.success = false;
-                r.message = "GetCoolerPower requires a valid device handle";
-                return r;
-            }
-            double power = GetQHYCCDParam(handle, CONTROL_CURPWM);
-            r.success = true;
-            r.payload = power;
-            r.message = "Current cooler power (PWM) = " + std::to_string(power);
-            return r;
-        }
+// 24-扩展. 获取制冷目标温度的范围及当前值（CONTROL_COOLER）
+SdkResult QhyCameraDriver::cmdGetCoolerTargetTemperature(qhyccd_handle* handle, const SdkCommand& /*cmd*/)
+{
+    SdkResult r;
+    double minV = 0.0, maxV = 0.0, stepV = 0.0;
+    uint32_t ret = GetQHYCCDParamMinMaxStep(handle, CONTROL_COOLER, &minV, &maxV, &stepV);
+    double cur = GetQHYCCDParam(handle, CONTROL_COOLER);
+    if (ret != QHYCCD_SUCCESS || cur == QHYCCD_ERROR) {
+        r.success = false;
+        r.message = "GetQHYCCDParamMinMaxStep/CONTROL_COOLER failed";
+    } else {
+        SdkControlParamInfo info;
+        info.minValue = minV;
+        info.maxValue = maxV;
+        info.step     = stepV;
+        info.current  = cur;
+        r.success = true;
+        r.payload = info;
+        r.message = "Cooler target temperature param info acquired";
+    }
+    return r;
+}
 
-        // 26. 取消当前曝光与读出
-        if (name == "CancelExposure") {
-            if (!handle) {
-                r.success = false;
-                r.message = "CancelExposure requires a valid device handle";
-                return r;
-            }
-            const auto t0 = std::chrono::steady_clock::now();
-            Logger::Log("QHYCCD CancelExposure | CancelQHYCCDExposingAndReadout enter: handle=" +
-                            std::to_string(reinterpret_cast<uintptr_t>(handle)),
-                        LogLevel::INFO, DeviceType::CAMERA);
-            unsigned int ret = CancelQHYCCDExposingAndReadout(handle);
-            const auto t1 = std::chrono::steady_clock::now();
-            const auto costMs = std::chrono::duration_cast<std::chrono::milliseconds>(t1 - t0).count();
-            Logger::Log("QHYCCD CancelExposure | CancelQHYCCDExposingAndReadout return: handle=" +
-                            std::to_string(reinterpret_cast<uintptr_t>(handle)) +
-                            " costMs=" + std::to_string(costMs) +
-                            " ret=" + std::to_string(ret),
-                        LogLevel::INFO, DeviceType::CAMERA);
-            SdkResult cancelResult = makeResultFromRet("CancelQHYCCDExposingAndReadout", ret);
-            cancelResult.message += " costMs=" + std::to_string(costMs);
-            return cancelResult;
-        }
+// 25. 获取当前制冷功率（CONTROL_CURPWM）
+SdkResult QhyCameraDriver::cmdGetCoolerPower(qhyccd_handle* handle, const SdkCommand& /*cmd*/)
+{
+    SdkResult r;
+    double power = GetQHYCCDParam(handle, CONTROL_CURPWM);
+    r.success = true;
+    r.payload = power;
+    r.message = "Current cooler power (PWM) = " + std::to_string(power);
+    return r;
+}
 
-        // 27. 检测滤镜轮（CFW）是否连接
-        if (name == "IsCFWPlugged") {
-            if (!handle) {
-                r.success = false;
-                r.message = "IsCFWPlugged requires a valid device handle";
-                return r;
-            }
-            unsigned int ret = IsQHYCCDCFWPlugged(handle);
-            bool plugged = (ret == QHYCCD_SUCCESS);
-            r.success = true;
-            r.payload = plugged;
-            r.message = plugged ? "CFW is plugged" : "CFW is not plugged";
-            return r;
-        }
+// 26. 取消当前曝光与读出
+SdkResult QhyCameraDriver::cmdCancelExposure(qhyccd_handle* handle, const SdkCommand& /*cmd*/)
+{
+    const auto t0 = std::chrono::steady_clock::now();
+    Logger::Log("QHYCCD CancelExposure | CancelQHYCCDExposingAndReadout enter: handle=" +
+                    std::to_string(reinterpret_cast<uintptr_t>(handle)),
+                LogLevel::INFO, DeviceType::CAMERA);
+    unsigned int ret = CancelQHYCCDExposingAndReadout(handle);
+    const auto t1 = std::chrono::steady_clock::now();
+    const auto costMs = std::chrono::duration_cast<std::chrono::milliseconds>(t1 - t0).count();
+    Logger::Log("QHYCCD CancelExposure | CancelQHYCCDExposingAndReadout return: handle=" +
+                    std::to_string(reinterpret_cast<uintptr_t>(handle)) +
+                    " costMs=" + std::to_string(costMs) +
+                    " ret=" + std::to_string(ret),
+                LogLevel::INFO, DeviceType::CAMERA);
+    SdkResult cancelResult = makeResultFromRet("CancelQHYCCDExposingAndReadout", ret);
+    cancelResult.message += " costMs=" + std::to_string(costMs);
+    return cancelResult;
+}
 
-        // 28. 获取滤镜轮槽位数量
-        if (name == "GetCFWSlotsNum") {
-            if (!handle) {
-                r.success = false;
-                r.message = "GetCFWSlotsNum requires a valid device handle";
-                return r;
-            }
-            double slotsNum = GetQHYCCDParam(handle, CONTROL_CFWSLOTSNUM);
-            if (slotsNum == QHYCCD_ERROR) {
-                r.success = false;
-                r.message = "GetQHYCCDParam CONTROL_CFWSLOTSNUM failed";
-            } else {
-                r.success = true;
-                r.payload = static_cast<int>(slotsNum);
-                r.message = "CFW slots number = " + std::to_string(static_cast<int>(slotsNum));
-            }
-            return r;
-        }
+// 27. 检测滤镜轮（CFW）是否连接
+SdkResult QhyCameraDriver::cmdIsCFWPlugged(qhyccd_handle* handle, const SdkCommand& /*cmd*/)
+{
+    SdkResult r;
+    unsigned int ret = IsQHYCCDCFWPlugged(handle);
+    bool plugged = (ret == QHYCCD_SUCCESS);
+    r.success = true;
+    r.payload = plugged;
+    r.message = plugged ? "CFW is plugged" : "CFW is not plugged";
+    return r;
+}
 
-        // 29. 获取当前滤镜轮位置
-        if (name == "GetCFWPosition") {
-            if (!handle) {
-                r.success = false;
-                r.message = "GetCFWPosition requires a valid device handle";
-                return r;
-            }
-            double pos = GetQHYCCDParam(handle, CONTROL_CFWPORT);
-            if (pos == QHYCCD_ERROR) {
-                r.success = false;
-                r.message = "GetQHYCCDParam CONTROL_CFWPORT failed";
-            } else {
-                // SDK 返回的位置是 ASCII 字符码（'0' = 48），需要转换为数字索引
-                int position = static_cast<int>(pos) - 48;
-                r.success = true;
-                r.payload = position;
-                r.message = "Current CFW position = " + std::to_string(position);
-            }
-            return r;
-        }
+// 28. 获取滤镜轮槽位数量
+SdkResult QhyCameraDriver::cmdGetCFWSlotsNum(qhyccd_handle* handle, const SdkCommand& /*cmd*/)
+{
+    SdkResult r;
+    double slotsNum = GetQHYCCDParam(handle, CONTROL_CFWSLOTSNUM);
+    if (slotsNum == QHYCCD_ERROR) {
+        r.success = false;
+        r.message = "GetQHYCCDParam CONTROL_CFWSLOTSNUM failed";
+    } else {
+        r.success = true;
+        r.payload = static_cast<int>(slotsNum);
+        r.message = "CFW slots number = " + std::to_string(static_cast<int>(slotsNum));
+    }
+    return r;
+}
 
-        // 30. 设置滤镜轮位置
-        if (name == "SetCFWPosition") {
-            if (!handle) {
-                r.success = false;
-                r.message = "SetCFWPosition requires a valid device handle";
-                return r;
-            }
-            int position = 0;
-            if (!extractParam<int>(cmd.payload, position, r, "position")) {
-                return r;
-            }
-            // SDK 需要 ASCII 字符码（'0' = 48），将数字索引转换为字符码
-            int asciiPos = position + 48;
-            unsigned int ret = SetQHYCCDParam(handle, CONTROL_CFWPORT, static_cast<double>(asciiPos));
-            if (ret == QHYCCD_SUCCESS) {
-                r.success = true;
-                r.message = "SetQHYCCDParam CONTROL_CFWPORT success, position set to " + std::to_string(position);
-            } else {
-                r.success = false;
-                r.message = "SetQHYCCDParam CONTROL_CFWPORT failed, error code: " + std::to_string(ret);
-            }
-            return r;
-        }
+// 29. 获取当前滤镜轮位置
+SdkResult QhyCameraDriver::cmdGetCFWPosition(qhyccd_handle* handle, const SdkCommand& /*cmd*/)
+{
+    SdkResult r;
+    double pos = GetQHYCCDParam(handle, CONTROL_CFWPORT);
+    if (pos == QHYCCD_ERROR) {
+        r.success = false;
+        r.message = "GetQHYCCDParam CONTROL_CFWPORT failed";
+    } else {
+        // SDK 返回的位置是 ASCII 字符码（'0' = 48），需要转换为数字索引
+        int position = static_cast<int>(pos) - 48;
+        r.success = true;
+        r.payload = position;
+        r.message = "Current CFW position = " + std::to_string(position);
+    }
+    return r;
+}
 
-        // 31. 发送自定义命令到滤镜轮
-        if (name == "SendOrderToCFW") {
-            if (!handle) {
-                r.success = false;
-                r.message = "SendOrderToCFW requires a valid device handle";
-                return r;
-            }
-            std::string order;
-            if (!extractParam<std::string>(cmd.payload, order, r, "order")) {
-                return r;
-            }
-            // 创建可修改的字符串缓冲区
-            std::vector<char> orderBuf(order.begin(), order.end());
-            orderBuf.push_back('\0');
-            unsigned int ret = SendOrder2QHYCCDCFW(handle, orderBuf.data(), static_cast<uint32_t>(order.length()));
-            if (ret == QHYCCD_SUCCESS) {
-                r.success = true;
-                r.message = "SendOrder2QHYCCDCFW success";
-            } else {
-                r.success = false;
-                r.message = "SendOrder2QHYCCDCFW failed, error code: " + std::to_string(ret);
-            }
-            return r;
-        }
+// 30. 设置滤镜轮位置
+SdkResult QhyCameraDriver::cmdSetCFWPosition(qhyccd_handle* handle, const SdkCommand& cmd)
+{
+    SdkResult r;
+    const int position = payloadAs<int>(cmd);
+    // SDK 需要 ASCII 字符码（'0' = 48），将数字索引转换为字符码
+    int asciiPos = position + 48;
+    unsigned int ret = SetQHYCCDParam(handle, CONTROL_CFWPORT, static_cast<double>(asciiPos));
+    if (ret == QHYCCD_SUCCESS) {
+        r.success = true;
+        r.message = "SetQHYCCDParam CONTROL_CFWPORT success, position set to " + std::to_string(position);
+    } else {
+        r.success = false;
+        r.message = "SetQHYCCDParam CONTROL_CFWPORT failed, error code: " + std::to_string(ret);
+    }
+    return r;
+}
 
-        // 32. 获取滤镜轮状态
-        if (name == "GetCFWStatus") {
-            if (!handle) {
-                r.success = false;
-                r.message = "GetCFWStatus requires a valid device handle";
-                return r;
-            }
-            char status[64] = {0};
-            unsigned int ret = GetQHYCCDCFWStatus(handle, status);
-            if (ret == QHYCCD_SUCCESS) {
-                r.success = true;
-                r.payload = std::string(status);
-                r.message = "CFW status: " + std::string(status);
-            } else {
-                r.success = false;
-                r.message = "GetQHYCCDCFWStatus failed, error code: " + std::to_string(ret);
-            }
-            return r;
-        }
+// 31. 发送自定义命令到滤镜轮
+SdkResult QhyCameraDriver::cmdSendOrderToCFW(qhyccd_handle* handle, const SdkCommand& cmd)
+{
+    SdkResult r;
+    const std::string order = payloadAs<std::string>(cmd);
+    // 创建可修改的字符串缓冲区
+    std::vector<char> orderBuf(order.begin(), order.end());
+    orderBuf.push_back('\0');
+    unsigned int ret = SendOrder2QHYCCDCFW(handle, orderBuf.data(), static_cast<uint32_t>(order.length()));
+    if (ret == QHYCCD_SUCCESS) {
+        r.success = true;
+        r.message = "SendOrder2QHYCCDCFW success";
+    } else {
+        r.success = false;
+        r.message = "SendOrder2QHYCCDCFW failed, error code: " + std::to_string(ret);
     }
+    return r;
+}
 
-    // 默认：不支持的命令
-    r.success = false;
-    r.errorCode = SdkErrorCode::NotImplemented;
-    r.message = "Unsupported QHY command: " + cmd.name;
+// 32. 获取滤镜轮状态
+SdkResult QhyCameraDriver::cmdGetCFWStatus(qhyccd_handle* handle, const SdkCommand& /*cmd*/)
+{
+    SdkResult r;
+    char status[64] = {0};
+    unsigned int ret = GetQHYCCDCFWStatus(handle, status);
+    if (ret == QHYCCD_SUCCESS) {
+        r.success = true;
+        r.payload = std::string(status);
+        r.message = "CFW status: " + std::string(status);
+    } else {
+        r.success = false;
+        r.message = "GetQHYCCDCFWStatus failed, error code: " + std::to_string(ret);
+    }
     return r;
 }
 
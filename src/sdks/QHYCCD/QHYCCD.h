@@ -7,6 +7,8 @@
 #include <vector>
 #include <string>
 #include <cstdint>
+#include <typeinfo>
+#include <unordered_map>
 
 // 对外可用的驱动名（两种别名）
 #define SDK_DRIVER_NAME_INDI_QHY_CCD "indi_qhy_ccd"
@@ -27,9 +29,14 @@ public:
     SdkResult openDevice(const std::any& openParam) override;
     // closeDevice：handle 为 SdkDeviceHandle（实际为 qhyccd_handle*）
     SdkResult closeDevice(SdkDeviceHandle handle) override;
-    // execute：所有自定义命令的统一入口
+    // execute：所有自定义命令的统一入口（按名字解析一次 id 后转 executeById）
     SdkResult execute(SdkDeviceHandle handle, const SdkCommand& cmd) override;
 
+    // 命令名 -> 命令表下标；热路径由调用方/SdkManager 预解析后走 executeById
+    SdkCommandId resolveCommand(const std::string& name) const override;
+    unsigned commandFlags(SdkCommandId id) const override;
+    SdkResult executeById(SdkDeviceHandle handle, SdkCommandId id, const SdkCommand& cmd) override;
+
     // 扫描可用设备（实现ISdkDriver的可选接口）
     SdkResult scanDevices(std::vector<SdkDeviceInfo>& outDevices) override;
     // 获取驱动能力描述
@@ -39,7 +46,27 @@ private:
     // SDK 全局资源是否已初始化
     bool m_resourceInited{false};
 
-    // 工具函数：从 std::any 中安全取出参数
+    // 命令处理函数签名：句柄非空与 payload 类型已由 executeById() 按命令表校验
+    using CommandHandler = SdkResult (QhyCameraDriver::*)(qhyccd_handle* handle, const SdkCommand& cmd);
+
+    // 命令表项：下标即 SdkCommandId
+    struct CommandEntry {
+        const char*           name;         ///< 命令名（与 SdkCommand.name 对应）
+        CommandHandler        handler;      ///< 处理函数
+        const char*           description;  ///< 命令说明（commandList 输出）
+        const std::type_info* payloadType;  ///< 期望的 payload 类型；nullptr 表示不需要参数
+        const char*           payloadName;  ///< payload 参数名（用于错误信息）
+        bool                  needsHandle;  ///< 是否要求有效的设备句柄
+        unsigned              flags;        ///< SdkCommandFlag 组合
+    };
+
+    static const CommandEntry kCommandTable[];
+    static const size_t       kCommandCount;
+
+    // 命令名 -> id（构造时由命令表生成一次）
+    std::unordered_map<std::string, SdkCommandId> m_commandIds;
+
+    // 工具函数：从 std::any 中安全取出参数（openDevice 等非命令表路径使用）
     template<typename T>
     bool extractParam(const std::any& anyValue, T& out, SdkResult& r, const char* name) const
     {
@@ -53,8 +80,70 @@ private:
         }
     }
 
+    // 取已校验类型的 payload（类型检查已在分派层完成，这里不再抛异常）
+    template<typename T>
+    static const T& payloadAs(const SdkCommand& cmd)
+    {
+        return *std::any_cast<T>(&cmd.payload);
+    }
+
     // 内部辅助：从 QHYCCD 错误码构造结果
     SdkResult makeResultFromRet(const std::string& action, unsigned int ret) const;
+
+    // 各命令处理函数（顺序与命令表一致）
+    SdkResult cmdGetSdkVersion(qhyccd_handle* handle, const SdkCommand& cmd);
+    SdkResult cmdGetFirmwareVersion(qhyccd_handle* handle, const SdkCommand& cmd);
+    SdkResult cmdInitSdkResource(qhyccd_handle* handle, const SdkCommand& cmd);
+    SdkResult cmdReleaseSdkResource(qhyccd_handle* handle, const SdkCommand& cmd);
+    SdkResult cmdScanCameras(qhyccd_handle* handle, const SdkCommand& cmd);
+    SdkResult cmdGetCameraIdByIndex(qhyccd_handle* handle, const SdkCommand& cmd);
+    SdkResult cmdSetReadMode(qhyccd_handle* handle, const SdkCommand& cmd);
+    SdkResult cmdSetStreamMode(qhyccd_handle* handle, const SdkCommand& cmd);
+    SdkResult cmdInitCamera(qhyccd_handle* handle, const SdkCommand& cmd);
+    SdkResult cmdGetOverScanArea(qhyccd_handle* handle, const SdkCommand& cmd);
+    SdkResult cmdGetEffectiveArea(qhyccd_handle* handle, const SdkCommand& cmd);
+    SdkResult cmdGetChipInfo(qhyccd_handle* handle, const SdkCommand& cmd);
+    SdkResult cmdSetDDR(qhyccd_handle* handle, const SdkCommand& cmd);
+    SdkResult cmdSetDebayerOnOff(qhyccd_handle* handle, const SdkCommand& cmd);
+    SdkResult cmdSetUsbTraffic(qhyccd_handle* handle, const SdkCommand& cmd);
+    SdkResult cmdSetGain(qhyccd_handle* handle, const SdkCommand& cmd);
+    SdkResult cmdSetOffset(qhyccd_handle* handle, const SdkCommand& cmd);
+    SdkResult cmdSetExposure(qhyccd_handle* handle, const SdkCommand& cmd);
+    SdkResult cmdGetUsbTraffic(qhyccd_handle* handle, const SdkCommand& cmd);
+    SdkResult cmdGetGain(qhyccd_handle* handle, const SdkCommand& cmd);
+    SdkResult cmdGetOffset(qhyccd_handle* handle, const SdkCommand& cmd);
+    SdkResult cmdGetExposure(qhyccd_handle* handle, const SdkCommand& cmd);
+    SdkResult cmdSetResolution(qhyccd_handle* handle, const SdkCommand& cmd);
+    SdkResult cmdSetBinMode(qhyccd_handle* handle, const SdkCommand& cmd);
+    SdkResult cmdSetBitsMode(qhyccd_handle* handle, const SdkCommand& cmd);
+    SdkResult cmdGetBitsMode(qhyccd_handle* handle, const SdkCommand& cmd);
+    SdkResult cmdStartSingleExposure(qhyccd_handle* handle, const SdkCommand& cmd);
+    SdkResult cmdGetMemLength(qhyccd_handle* handle, const SdkCommand& cmd);
+    SdkResult cmdGetSingleFrame(qhyccd_handle* handle, const SdkCommand& cmd);
+    SdkResult cmdBeginLive(qhyccd_handle* handle, const SdkCommand& cmd);
+    SdkResult cmdGetLiveFrame(qhyccd_handle* handle, const SdkCommand& cmd);
+    SdkResult cmdGetLiveFrameFast(qhyccd_handle* handle, const SdkCommand& cmd);
+    SdkResult cmdStopLive(qhyccd_handle* handle, const SdkCommand& cmd);
+    SdkResult cmdEnableBurstMode(qhyccd_handle* handle, const SdkCommand& cmd);
+    SdkResult cmdSetBurstStartEnd(qhyccd_handle* handle, const SdkCommand& cmd);
+    SdkResult cmdResetFrameCounter(qhyccd_handle* handle, const SdkCommand& cmd);
+    SdkResult cmdSetBurstIDLE(qhyccd_handle* handle, const SdkCommand& cmd);
+    SdkResult cmdReleaseBurstIDLE(qhyccd_handle* handle, const SdkCommand& cmd);
+    SdkResult cmdSetBurstPatchNumber(qhyccd_handle* handle, const SdkCommand& cmd);
+    SdkResult cmdCheckSingleFrameModeAvailable(qhyccd_handle* handle, const SdkCommand& cmd);
+    SdkResult cmdIsColorCamera(qhyccd_handle* handle, const SdkCommand& cmd);
+    SdkResult cmdGetCameraCfa(qhyccd_handle* handle, const SdkCommand& cmd);
+    SdkResult cmdGetCurrentTemperature(qhyccd_handle* handle, const SdkCommand& cmd);
+    SdkResult cmdSetCoolerTargetTemperature(qhyccd_handle* handle, const SdkCommand& cmd);
+    SdkResult cmdGetCoolerTargetTemperature(qhyccd_handle* handle, const SdkCommand& cmd);
+    SdkResult cmdGetCoolerPower(qhyccd_handle* handle, const SdkCommand& cmd);
+    SdkResult cmdCancelExposure(qhyccd_handle* handle, const SdkCommand& cmd);
+    SdkResult cmdIsCFWPlugged(qhyccd_handle* handle, const SdkCommand& cmd);
+    SdkResult cmdGetCFWSlotsNum(qhyccd_handle* handle, const SdkCommand& cmd);
+    SdkResult cmdGetCFWPosition(qhyccd_handle* handle, const SdkCommand& cmd);
+    SdkResult cmdSetCFWPosition(qhyccd_handle* handle, const SdkCommand& cmd);
+    SdkResult cmdSendOrderToCFW(qhyccd_handle* handle, const SdkCommand& cmd);
+    SdkResult cmdGetCFWStatus(qhyccd_handle* handle, const SdkCommand& cmd);
 };
 
 #endif // QHY_CAMERA_DRIVER_H
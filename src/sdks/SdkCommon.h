@@ -7,6 +7,8 @@
 #include <functional>
 #include <unordered_map>
 #include <any>
+#include <optional>
+#include <cstdint>
 
 /**
  * @file SdkCommon.h
@@ -105,6 +107,29 @@ enum class SdkErrorCode {
     NotImplemented       ///< 功能未实现（驱动未实现该功能）
 };
 
+class ISdkDriver;
+
+/**
+ * @typedef SdkCommandId
+ * @brief 驱动内部的稠密命令编号
+ *
+ * 由驱动在注册时根据命令名生成（见 ISdkDriver::resolveCommand），
+ * 仅对生成它的驱动有效；kSdkInvalidCommandId 表示未解析/未知命令。
+ */
+using SdkCommandId = int;
+constexpr SdkCommandId kSdkInvalidCommandId = -1;
+
+/**
+ * @enum SdkCommandFlag
+ * @brief 命令属性位（由驱动按命令声明，SdkManager 据此决定日志策略）
+ */
+enum SdkCommandFlag : unsigned {
+    SdkCommandFlagNone         = 0,
+    SdkCommandFlagQuiet        = 1u << 0, ///< 高频轮询命令（取帧/温度）：不打调用前后调试日志
+    SdkCommandFlagKeyInit      = 1u << 1, ///< 关键初始化命令：补充结束日志，便于定位崩溃前最后一步
+    SdkCommandFlagCaptureTrace = 1u << 2  ///< 拍摄链路追踪命令：输出 CaptureTrace 日志
+};
+
 /**
  * @struct SdkCommand
  * @brief 统一的命令结构
@@ -137,6 +162,33 @@ struct SdkCommand {
     SdkCommandType type;    ///< 命令类型（标准命令或自定义命令）
     std::string    name;    ///< 具体命令名称，例如 "GetTemperature"、"SetGain" 等
     std::any       payload; ///< 命令参数（可选），类型由驱动和调用方约定
+    // 预解析结果（可选）：由 SdkManager::resolveCommand() 填写。
+    // 热路径（Live 取帧等）复用同一个已解析的命令对象，分派时不再做字符串查找/比较；
+    // idOwner 与实际执行的驱动不一致时视为未解析，按 name 重新解析。
+    SdkCommandId      id{kSdkInvalidCommandId}; ///< 驱动内命令编号
+    const ISdkDriver* idOwner{nullptr};         ///< 生成 id 的驱动
+};
+
+/**
+ * @struct SdkFrameData
+ * @brief SDK 相机单帧数据
+ *
+ * 通过 SdkResult::frame 类型化通道返回（不经 std::any），调用方应 std::move 取出，
+ * 避免复制 pixels；rawBuffer 零拷贝路径下整帧只在 shared_ptr 间传递所有权。
+ */
+struct SdkFrameData {
+    int                     width{0};      ///< 图像宽度（像素）
+    int                     height{0};     ///< 图像高度（像素）
+    unsigned int            bpp{0};        ///< 位深度
+    unsigned int            channels{0};   ///< 通道数
+    std::vector<uint16_t>   pixels;        ///< 像素数据（16 位单通道）
+    // 零拷贝/共享缓冲区路径（可选）：
+    // - 当希望避免把 SDK buffer 再拷贝到 pixels 时，驱动可以把原始图像数据放在 rawBuffer 中，
+    //   并填写 rawBytes（有效字节数）。
+    // - 约定：若 pixels 为空且 rawBuffer!=nullptr，则消费端优先从 rawBuffer 读取数据。
+    // - rawBuffer 的生命周期由 shared_ptr 管理，确保跨线程传递时不会被提前释放。
+    std::shared_ptr<std::vector<unsigned char>> rawBuffer; ///< 原始像素 buffer（由 SDK 直接写入）
+    size_t                  rawBytes{0};   ///< rawBuffer 中的有效字节数（通常 = width*height*channels*(bpp/8)）
 };
 
 /**
@@ -151,6 +203,8 @@ struct SdkCommand {
  * if (result.success) {
  *     // 操作成功，从payload中提取返回数据
  *     double temperature = std::any_cast<double>(result.payload);
+ *     // 取帧类命令（GetSingleFrame/GetLiveFrame）的图像走 frame 通道，移动取出：
+ *     // SdkFrameData frame = std::move(*result.frame);
  * } else {
  *     // 操作失败，检查错误码和错误信息
  *     qDebug() << "错误:" << result.message.c_str();
@@ -165,6 +219,9 @@ struct SdkResult {
     SdkErrorCode errorCode{SdkErrorCode::Success}; ///< 错误码（成功时为Success）
     std::string  message;                           ///< 错误或描述信息（人类可读）
     std::any     payload;                           ///< 返回数据（类型由驱动和调用方约定）
+    // 帧数据通道（GetSingleFrame/GetLiveFrame 等）：按值内嵌，不经 std::any 的堆分配与 any_cast 整体复制。
+    // 结果可移动传递；配合驱动侧缓冲池，Live 稳态下每帧不产生堆分配。
+    std::optional<SdkFrameData> frame;             ///< 帧结果（非取帧命令为空）
 };
 
 /**
@@ -321,25 +378,6 @@ struct SdkFocuserOpenParam {
  * 以下类型定义用于相机和电调设备，通过统一管理避免应用层直接依赖驱动实现细节。
  */
 
-/**
- * @struct SdkFrameData
- * @brief SDK 相机单帧数据
- */
-struct SdkFrameData {
-    int                     width{0};      ///< 图像宽度（像素）
-    int                     height{0};     ///< 图像高度（像素）
-    unsigned int            bpp{0};        ///< 位深度
-    unsigned int            channels{0};   ///< 通道数
-    std::vector<uint16_t>   pixels;        ///< 像素数据（16 位单通道）
-    // 零拷贝/共享缓冲区路径（可选）：
-    // - 当希望避免把 SDK buffer 再拷贝到 pixels 时，驱动可以把原始图像数据放在 rawBuffer 中，
-    //   并填写 rawBytes（有效字节数）。
-    // - 约定：若 pixels 为空且 rawBuffer!=nullptr，则消费端优先从 rawBuffer 读取数据。
-    // - rawBuffer 的生命周期由 shared_ptr 管理，确保跨线程传递时不会被提前释放。
-    std::shared_ptr<std::vector<unsigned char>> rawBuffer; ///< 原始像素 buffer（由 SDK 直接写入）
-    size_t                  rawBytes{0};   ///< rawBuffer 中的有效字节数（通常 = width*height*channels*(bpp/8)）
-};
-
 /**
  * @struct SdkAreaInfo
  * @brief SDK 相机区域信息（如 OverScan / 有效区域）
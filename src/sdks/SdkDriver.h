@@ -24,6 +24,24 @@ public:
     // 执行具体命令：设备句柄 + 命令 + 结果
     virtual SdkResult execute(SdkDeviceHandle handle, const SdkCommand& cmd) = 0;
 
+    // （可选）命令名 -> 稠密命令编号。默认不支持，返回 kSdkInvalidCommandId（走 execute 按名字分派）
+    virtual SdkCommandId resolveCommand(const std::string& name) const {
+        (void)name;
+        return kSdkInvalidCommandId;
+    }
+
+    // （可选）命令属性位（SdkCommandFlag 组合），id 由 resolveCommand 返回
+    virtual unsigned commandFlags(SdkCommandId id) const {
+        (void)id;
+        return SdkCommandFlagNone;
+    }
+
+    // （可选）按已解析的命令编号执行；默认回落到 execute()
+    virtual SdkResult executeById(SdkDeviceHandle handle, SdkCommandId id, const SdkCommand& cmd) {
+        (void)id;
+        return execute(handle, cmd);
+    }
+
     // （可选）扫描设备：默认不实现，返回 NotImplemented 方便调用层判断
     virtual SdkResult scanDevices(std::vector<SdkDeviceInfo>& outDevices) {
         SdkResult r;
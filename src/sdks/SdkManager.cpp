@@ -6,11 +6,6 @@
 #include <thread>
 
 namespace {
-bool isSdkInitKeyCommand(const std::string& name)
-{
-    return name == "SetReadMode" || name == "SetStreamMode" || name == "InitCamera";
-}
-
 std::string handleToString(SdkDeviceHandle handle)
 {
     std::ostringstream oss;
@@ -119,10 +114,15 @@ SdkResult SdkManager::call(const std::string& driverName,
         return r;
     }
 
-    const bool skipNoisyLog = (command.name == "GetCurrentTemperature");
-    const bool keyInitCmd = isSdkInitKeyCommand(command.name);
+    // 命令编号：调用方已通过 resolveCommand() 预解析时直接复用，否则在此解析一次
+    const SdkCommandId commandId =
+        (command.idOwner == driver) ? command.id : driver->resolveCommand(command.name);
+    const unsigned flags = driver->commandFlags(commandId);
+    const bool skipNoisyLog = (flags & SdkCommandFlagQuiet) != 0;
+    const bool keyInitCmd = (flags & SdkCommandFlagKeyInit) != 0;
+    const bool captureTrace = (flags & SdkCommandFlagCaptureTrace) != 0;
 
-    // 记录调试日志（跳过温度查询命令以避免频繁打印）
+    // 记录调试日志（跳过取帧/温度等高频轮询命令，避免每帧拼接日志字符串）
     if (!skipNoisyLog) {
         const std::string preLog =
             "调用驱动: " + driverName +
@@ -140,7 +140,7 @@ SdkResult SdkManager::call(const std::string& driverName,
     // 执行命令（此时已释放锁，不会阻塞其他操作）
     const auto t0 = std::chrono::steady_clock::now();
     SdkResult execResult;
-    if (command.name == "StartSingleExposure") {
+    if (captureTrace) {
         const std::string traceLog =
             "CaptureTrace | stage=sdkmanager_start_single_exposure_driver_execute_enter" +
             std::string(" | driver=") + driverName +
@@ -154,7 +154,7 @@ SdkResult SdkManager::call(const std::string& driverName,
         }
     }
     try {
-        execResult = driver->execute(device, command);
+        execResult = driver->executeById(device, commandId, command);
     } catch (const std::exception& e) {
         execResult.success = false;
         execResult.errorCode = SdkErrorCode::OperationFailed;
@@ -166,7 +166,7 @@ SdkResult SdkManager::call(const std::string& driverName,
     }
     const auto dtMs = std::chrono::duration_cast<std::chrono::milliseconds>(
                           std::chrono::steady_clock::now() - t0).count();
-    if (command.name == "StartSingleExposure") {
+    if (captureTrace) {
         const std::string traceLog =
             "CaptureTrace | stage=sdkmanager_start_single_exposure_driver_execute_return" +
             std::string(" | driver=") + driverName +
@@ -203,6 +203,37 @@ SdkResult SdkManager::call(const std::string& driverName,
     return execResult;
 }
 
+/**
+ * @brief 预解析命令编号
+ * @param driverName 驱动名称
+ * @param command 要解析的命令（按 name 解析，结果写回 id/idOwner）
+ * @return 驱动识别该命令时返回true
+ *
+ * 功能说明：
+ * - 命令名到编号的映射由驱动在注册时建立，这里只做一次查找
+ * - 解析结果与驱动实例绑定（idOwner），换驱动后call()会自动按名字重新解析
+ */
+bool SdkManager::resolveCommand(const std::string& driverName, SdkCommand& command) const
+{
+    ISdkDriver* driver = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_drivers.find(driverName);
+        if (it != m_drivers.end())
+            driver = it->second;
+    }
+
+    if (!driver) {
+        command.id = kSdkInvalidCommandId;
+        command.idOwner = nullptr;
+        return false;
+    }
+
+    command.id = driver->resolveCommand(command.name);
+    command.idOwner = (command.id != kSdkInvalidCommandId) ? driver : nullptr;
+    return command.idOwner != nullptr;
+}
+
 /**
  * @brief 打开设备
  * @param driverName 驱动名称
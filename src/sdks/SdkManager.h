@@ -106,6 +106,26 @@ public:
                    SdkDeviceHandle device,
                    const SdkCommand& command);
 
+    /**
+     * @brief 预解析命令编号（填写 command.id / command.idOwner）
+     * @param driverName 驱动名称
+     * @param command 要解析的命令（按 name 解析）
+     * @return 驱动识别该命令时返回true
+     *
+     * 高频调用方（Live 取帧、温度轮询等）应构造一次命令并预解析，之后重复使用同一对象：
+     * call() 检测到已解析的 id 后直接按下标分派，不再做字符串比较。
+     *
+     * 使用示例：
+     * @code
+     * SdkCommand getCmd{SdkCommandType::Custom, "GetLiveFrame", {}};
+     * SdkManager::instance().resolveCommand("QHYCCD", getCmd);
+     * for (;;) {
+     *     SdkResult r = SdkManager::instance().call("QHYCCD", handle, getCmd);
+     * }
+     * @endcode
+     */
+    bool resolveCommand(const std::string& driverName, SdkCommand& command) const;
+
     /**
      * @brief 通过驱动名打开设备
      * @param driverName 驱动名称
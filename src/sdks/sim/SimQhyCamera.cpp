@@ -0,0 +1,761 @@
+#include "SimQhyCamera.h"
+#include "../LoggerAdapter.h"
+#include "../SdkManager.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <thread>
+
+namespace {
+
+// Live 缓冲池：与 QhyCameraDriver 相同的双缓冲策略（尺寸变化清池、优先复用未被外部持有的块），
+// 这样虚拟天文台压测到的零拷贝/回退拷贝路径与真机一致
+struct LiveBufferCache {
+    std::vector<std::shared_ptr<std::vector<unsigned char>>> buffers;
+    size_t length = 0;
+};
+
+std::mutex g_liveBufMu;
+std::unordered_map<const sim::VirtualCamera*, LiveBufferCache> g_liveBufByCamera;
+
+std::shared_ptr<std::vector<unsigned char>> acquireLiveBuffer(const sim::VirtualCamera* cam, size_t length)
+{
+    static constexpr size_t kMaxPool = 2;
+    std::lock_guard<std::mutex> lk(g_liveBufMu);
+    auto& c = g_liveBufByCamera[cam];
+    if (c.length != length) {
+        c.buffers.clear();
+        c.length = length;
+    }
+    for (auto& b : c.buffers) {
+        if (b.use_count() == 1)
+            return b;
+    }
+    if (c.buffers.size() < kMaxPool) {
+        c.buffers.push_back(std::make_shared<std::vector<unsigned char>>(length));
+        return c.buffers.back();
+    }
+    // 池满且都被持有：返回空，调用方改为渲染到 pixels（对应真机驱动的回退拷贝路径）
+    return nullptr;
+}
+
+void eraseLiveBuffer(const sim::VirtualCamera* cam)
+{
+    std::lock_guard<std::mutex> lk(g_liveBufMu);
+    g_liveBufByCamera.erase(cam);
+}
+
+SdkControlParamInfo paramInfo(double minValue, double maxValue, double step, double current)
+{
+    SdkControlParamInfo info;
+    info.minValue = minValue;
+    info.maxValue = maxValue;
+    info.step     = step;
+    info.current  = current;
+    return info;
+}
+
+} // namespace
+
+// 命令表：名称、说明、payload 类型与属性位照抄 QhyCameraDriver::kCommandTable（顺序一致），
+// 只是处理函数换成虚拟设备实现；对模拟设备无效果的设置类命令统一由 cmdAccept 应答。
+const SimQhyCameraDriver::CommandEntry SimQhyCameraDriver::kCommandTable[] = {
+    {"GetSdkVersion", &SimQhyCameraDriver::cmdGetSdkVersion,
+     "获取 QHYCCD SDK 版本号字符串（模拟）",
+     nullptr, nullptr, false, SdkCommandFlagNone},
+    {"GetFirmwareVersion", &SimQhyCameraDriver::cmdGetFirmwareVersion,
+     "获取当前相机固件版本信息（模拟）",
+     nullptr, nullptr, true, SdkCommandFlagNone},
+    {"InitSdkResource", &SimQhyCameraDriver::cmdAccept,
+     "初始化 SDK 全局资源（模拟：无操作）",
+     nullptr, nullptr, false, SdkCommandFlagNone},
+    {"ReleaseSdkResource", &SimQhyCameraDriver::cmdAccept,
+     "释放 SDK 全局资源（模拟：无操作）",
+     nullptr, nullptr, false, SdkCommandFlagNone},
+    {"ScanCameras", &SimQhyCameraDriver::cmdScanCameras,
+     "扫描虚拟相机数量",
+     nullptr, nullptr, false, SdkCommandFlagNone},
+    {"GetCameraIdByIndex", &SimQhyCameraDriver::cmdGetCameraIdByIndex,
+     "根据索引获取相机 ID，payload 传入 int 索引",
+     &typeid(int), "index", false, SdkCommandFlagNone},
+    {"SetReadMode", &SimQhyCameraDriver::cmdAccept,
+     "设置读出模式（模拟：无操作），payload 传入 int readMode",
+     &typeid(int), "readMode", true, SdkCommandFlagKeyInit},
+    {"SetStreamMode", &SimQhyCameraDriver::cmdAccept,
+     "设置图像流模式（模拟：无操作），payload 传入 int 模式值",
+     &typeid(int), "mode", true, SdkCommandFlagKeyInit},
+    {"InitCamera", &SimQhyCameraDriver::cmdAccept,
+     "初始化相机（模拟：无操作）",
+     nullptr, nullptr, true, SdkCommandFlagKeyInit},
+    {"GetOverScanArea", &SimQhyCameraDriver::cmdGetOverScanArea,
+     "获取相机 OverScan 区域信息，返回 SdkAreaInfo（模拟相机无 OverScan）",
+     nullptr, nullptr, true, SdkCommandFlagNone},
+    {"GetEffectiveArea", &SimQhyCameraDriver::cmdGetEffectiveArea,
+     "获取相机有效成像区域信息，返回 SdkAreaInfo",
+     nullptr, nullptr, true, SdkCommandFlagNone},
+    {"GetChipInfo", &SimQhyCameraDriver::cmdGetChipInfo,
+     "获取芯片物理尺寸、像素尺寸、最大分辨率等信息，返回 SdkChipInfo",
+     nullptr, nullptr, true, SdkCommandFlagNone},
+    {"SetDDR", &SimQhyCameraDriver::cmdAccept,
+     "设置相机 DDR 模式（模拟：无操作），payload 传入 double",
+     &typeid(double), "ddr", true, SdkCommandFlagNone},
+    {"SetDebayerOnOff", &SimQhyCameraDriver::cmdAccept,
+     "设置去拜耳开关（模拟：虚拟相机均为黑白，无操作），payload 传入 bool",
+     &typeid(bool), "debayerOn", true, SdkCommandFlagNone},
+    {"SetUsbTraffic", &SimQhyCameraDriver::cmdAccept,
+     "设置 USB 传输级别（模拟：无操作），payload 传入 double usbTraffic",
+     &typeid(double), "usbTraffic", true, SdkCommandFlagNone},
+    {"SetGain", &SimQhyCameraDriver::cmdSetGain,
+     "设置增益，payload 传入 double gain",
+     &typeid(double), "gain", true, SdkCommandFlagNone},
+    {"SetOffset", &SimQhyCameraDriver::cmdSetOffset,
+     "设置偏置，payload 传入 double offset",
+     &typeid(double), "offset", true, SdkCommandFlagNone},
+    {"SetExposure", &SimQhyCameraDriver::cmdSetExposure,
+     "设置曝光时间（微秒），payload 传入 double exposure",
+     &typeid(double), "exposure", true, SdkCommandFlagNone},
+    {"GetUsbTraffic", &SimQhyCameraDriver::cmdGetUsbTraffic,
+     "获取 USBTraffic 的最小值/最大值/步进/当前值（SdkControlParamInfo）",
+     nullptr, nullptr, true, SdkCommandFlagNone},
+    {"GetGain", &SimQhyCameraDriver::cmdGetGain,
+     "获取增益的最小值/最大值/步进/当前值（SdkControlParamInfo）",
+     nullptr, nullptr, true, SdkCommandFlagNone},
+    {"GetOffset", &SimQhyCameraDriver::cmdGetOffset,
+     "获取偏置的最小值/最大值/步进/当前值（SdkControlParamInfo）",
+     nullptr, nullptr, true, SdkCommandFlagNone},
+    {"GetExposure", &SimQhyCameraDriver::cmdGetExposure,
+     "获取曝光时间（微秒）的最小值/最大值/步进/当前值（SdkControlParamInfo）",
+     nullptr, nullptr, true, SdkCommandFlagNone},
+    {"SetResolution", &SimQhyCameraDriver::cmdSetResolution,
+     "设置 ROI/分辨率（未 Bin 像素，越界部分裁掉），payload 传入 SdkAreaInfo",
+     &typeid(SdkAreaInfo), "roi", true, SdkCommandFlagNone},
+    {"SetBinMode", &SimQhyCameraDriver::cmdSetBinMode,
+     "设置 Bin 模式，payload 传入 std::pair<int,int> (binX, binY)",
+     &typeid(std::pair<int,int>), "binMode", true, SdkCommandFlagNone},
+    {"SetBitsMode", &SimQhyCameraDriver::cmdAccept,
+     "设置位深模式（模拟：固定 16 位），payload 传入 int bits",
+     &typeid(int), "bits", true, SdkCommandFlagNone},
+    {"GetBitsMode", &SimQhyCameraDriver::cmdGetBitsMode,
+     "获取位深模式的最小值/最大值/步进/当前值（SdkControlParamInfo）",
+     nullptr, nullptr, true, SdkCommandFlagNone},
+    {"StartSingleExposure", &SimQhyCameraDriver::cmdStartSingleExposure,
+     "启动单帧曝光",
+     nullptr, nullptr, true, SdkCommandFlagCaptureTrace},
+    {"GetMemLength", &SimQhyCameraDriver::cmdGetMemLength,
+     "获取单帧图像所需的缓冲区长度，返回 uint32_t",
+     nullptr, nullptr, true, SdkCommandFlagNone},
+    {"GetSingleFrame", &SimQhyCameraDriver::cmdGetSingleFrame,
+     "读取单帧图像数据，SdkFrameData 经 SdkResult::frame 返回（16 位单通道）",
+     nullptr, nullptr, true, SdkCommandFlagNone},
+    {"BeginLive", &SimQhyCameraDriver::cmdBeginLive,
+     "进入 Live 连续采集",
+     nullptr, nullptr, true, SdkCommandFlagNone},
+    {"GetLiveFrame", &SimQhyCameraDriver::cmdGetLiveFrame,
+     "读取一帧 Live 图像数据，SdkFrameData 经 SdkResult::frame 返回",
+     nullptr, nullptr, true, SdkCommandFlagQuiet},
+    {"GetLiveFrameFast", &SimQhyCameraDriver::cmdGetLiveFrameFast,
+     "读取一帧 Live 图像数据，复用缓冲区且不返回像素（仅经 SdkResult::frame 返回 meta）",
+     nullptr, nullptr, true, SdkCommandFlagQuiet},
+    {"StopLive", &SimQhyCameraDriver::cmdStopLive,
+     "停止 Live 连续采集",
+     nullptr, nullptr, true, SdkCommandFlagNone},
+    {"EnableBurstMode", &SimQhyCameraDriver::cmdAccept,
+     "开启/关闭 Burst 子模式（模拟：无操作），payload=bool",
+     &typeid(bool), "enable", true, SdkCommandFlagNone},
+    {"SetBurstStartEnd", &SimQhyCameraDriver::cmdAccept,
+     "设置 Burst start/end（模拟：无操作），payload=std::pair<int,int>",
+     &typeid(std::pair<int,int>), "startEnd", true, SdkCommandFlagNone},
+    {"ResetFrameCounter", &SimQhyCameraDriver::cmdAccept,
+     "复位帧计数器（模拟：无操作）",
+     nullptr, nullptr, true, SdkCommandFlagNone},
+    {"SetBurstIDLE", &SimQhyCameraDriver::cmdAccept,
+     "进入 Burst IDLE 状态（模拟：无操作）",
+     nullptr, nullptr, true, SdkCommandFlagNone},
+    {"ReleaseBurstIDLE", &SimQhyCameraDriver::cmdAccept,
+     "释放 Burst IDLE 触发输出（模拟：无操作）",
+     nullptr, nullptr, true, SdkCommandFlagNone},
+    {"SetBurstPatchNumber", &SimQhyCameraDriver::cmdAccept,
+     "设置 Burst 补包数据量（模拟：无操作），payload=uint32_t",
+     &typeid(uint32_t), "patchNumber", true, SdkCommandFlagNone},
+    {"CheckSingleFrameModeAvailable", &SimQhyCameraDriver::cmdCheckSingleFrameModeAvailable,
+     "检测是否支持单帧模式，返回 bool",
+     nullptr, nullptr, true, SdkCommandFlagNone},
+    {"IsColorCamera", &SimQhyCameraDriver::cmdIsColorCamera,
+     "检测当前相机是否为彩色相机，返回 bool（虚拟相机均为黑白）",
+     nullptr, nullptr, true, SdkCommandFlagNone},
+    {"GetCameraCfa", &SimQhyCameraDriver::cmdGetCameraCfa,
+     "获取 CFA，返回 std::string（黑白相机为空）",
+     nullptr, nullptr, true, SdkCommandFlagNone},
+    {"GetCurrentTemperature", &SimQhyCameraDriver::cmdGetCurrentTemperature,
+     "获取当前传感器温度，返回 double",
+     nullptr, nullptr, true, SdkCommandFlagQuiet},
+    {"SetCoolerTargetTemperature", &SimQhyCameraDriver::cmdSetCoolerTargetTemperature,
+     "设置制冷目标温度，payload 传入 double 摄氏度",
+     &typeid(double), "targetTemperature", true, SdkCommandFlagNone},
+    {"GetCoolerTargetTemperature", &SimQhyCameraDriver::cmdGetCoolerTargetTemperature,
+     "获取制冷目标温度的最小值/最大值/步进/当前值（SdkControlParamInfo）",
+     nullptr, nullptr, true, SdkCommandFlagNone},
+    {"GetCoolerPower", &SimQhyCameraDriver::cmdGetCoolerPower,
+     "获取当前制冷功率百分比，返回 double",
+     nullptr, nullptr, true, SdkCommandFlagQuiet},
+    {"CancelExposure", &SimQhyCameraDriver::cmdCancelExposure,
+     "取消当前曝光与读出",
+     nullptr, nullptr, true, SdkCommandFlagNone},
+    {"IsCFWPlugged", &SimQhyCameraDriver::cmdIsCFWPlugged,
+     "检测相机是否连接了滤镜轮（CFW），返回 bool",
+     nullptr, nullptr, true, SdkCommandFlagNone},
+    {"GetCFWSlotsNum", &SimQhyCameraDriver::cmdGetCFWSlotsNum,
+     "获取滤镜轮的槽位数量，返回 int",
+     nullptr, nullptr, true, SdkCommandFlagNone},
+    {"GetCFWPosition", &SimQhyCameraDriver::cmdGetCFWPosition,
+     "获取当前滤镜轮位置，返回 int（0 开始；转动中失败）",
+     nullptr, nullptr, true, SdkCommandFlagNone},
+    {"SetCFWPosition", &SimQhyCameraDriver::cmdSetCFWPosition,
+     "设置滤镜轮位置，payload 传入 int 位置（0 开始）",
+     &typeid(int), "position", true, SdkCommandFlagNone},
+    {"SendOrderToCFW", &SimQhyCameraDriver::cmdAccept,
+     "发送自定义命令到滤镜轮（模拟：无操作），payload 传入 std::string order",
+     &typeid(std::string), "order", true, SdkCommandFlagNone},
+    {"GetCFWStatus", &SimQhyCameraDriver::cmdGetCFWStatus,
+     "获取滤镜轮状态字符串，返回 std::string",
+     nullptr, nullptr, true, SdkCommandFlagNone},
+};
+
+const size_t SimQhyCameraDriver::kCommandCount = sizeof(kCommandTable) / sizeof(kCommandTable[0]);
+
+// 注册器在静态初始化阶段读取命令表，必须定义在命令表之后
+REGISTER_SDK_DRIVER(SDK_DRIVER_NAME_INDI_QHY_CCD, SimQhyCameraDriver)
+
+SimQhyCameraDriver::SimQhyCameraDriver()
+{
+    m_commandIds.reserve(kCommandCount);
+    for (size_t i = 0; i < kCommandCount; ++i) {
+        m_commandIds.emplace(kCommandTable[i].name, static_cast<SdkCommandId>(i));
+    }
+}
+
+SimQhyCameraDriver::~SimQhyCameraDriver()
+{
+}
+
+std::vector<std::string> SimQhyCameraDriver::driverNames() const
+{
+    return { SDK_DRIVER_NAME_INDI_QHY_CCD, SDK_DRIVER_NAME_QHYCCD };
+}
+
+std::vector<SdkCommandInfo> SimQhyCameraDriver::commandList() const
+{
+    std::vector<SdkCommandInfo> list;
+    list.reserve(kCommandCount);
+    for (size_t i = 0; i < kCommandCount; ++i) {
+        list.push_back({kCommandTable[i].name, kCommandTable[i].description});
+    }
+    return list;
+}
+
+SdkResult SimQhyCameraDriver::ok(const std::string& message)
+{
+    SdkResult r;
+    r.success = true;
+    r.message = message;
+    return r;
+}
+
+SdkResult SimQhyCameraDriver::fail(const std::string& message, SdkErrorCode code)
+{
+    SdkResult r;
+    r.success = false;
+    r.errorCode = code;
+    r.message = message;
+    return r;
+}
+
+SdkResult SimQhyCameraDriver::openDevice(const std::any& openParam)
+{
+    const std::string* camId = std::any_cast<std::string>(&openParam);
+    if (!camId) {
+        return fail("Invalid parameter type for cameraId", SdkErrorCode::InvalidParameter);
+    }
+    sim::VirtualCamera* cam = sim::VirtualRig::instance().cameraById(*camId);
+    if (!cam) {
+        return fail("OpenQHYCCD failed for cameraId: " + *camId, SdkErrorCode::DeviceNotFound);
+    }
+    {
+        std::lock_guard<std::mutex> lk(m_openMutex);
+        if (!m_open.insert(cam).second) {
+            return fail("OpenQHYCCD failed for cameraId: " + *camId + " (already open)", SdkErrorCode::DeviceBusy);
+        }
+    }
+    Logger::Log("SimQHYCCD | open " + *camId + " " + std::to_string(cam->spec().width) + "x" +
+                    std::to_string(cam->spec().height) + (cam->filterWheel() ? " +CFW" : ""),
+                LogLevel::INFO, DeviceType::CAMERA);
+
+    SdkResult r = ok("OpenQHYCCD success for cameraId: " + *camId);
+    r.payload = static_cast<SdkDeviceHandle>(cam);
+    return r;
+}
+
+SdkResult SimQhyCameraDriver::closeDevice(SdkDeviceHandle device)
+{
+    auto* cam = static_cast<sim::VirtualCamera*>(device);
+    if (!cam) {
+        return fail("closeDevice: handle is null", SdkErrorCode::InvalidParameter);
+    }
+    cam->stopLive();
+    cam->cancelExposure();
+    eraseLiveBuffer(cam);
+    {
+        std::lock_guard<std::mutex> lk(m_openMutex);
+        m_open.erase(cam);
+    }
+    Logger::Log("SimQHYCCD | close " + cam->spec().id + ", frames rendered=" + std::to_string(cam->framesRendered()),
+                LogLevel::INFO, DeviceType::CAMERA);
+    return ok("CloseQHYCCD success");
+}
+
+SdkCommandId SimQhyCameraDriver::resolveCommand(const std::string& name) const
+{
+    auto it = m_commandIds.find(name);
+    return (it != m_commandIds.end()) ? it->second : kSdkInvalidCommandId;
+}
+
+unsigned SimQhyCameraDriver::commandFlags(SdkCommandId id) const
+{
+    if (id < 0 || static_cast<size_t>(id) >= kCommandCount) {
+        return SdkCommandFlagNone;
+    }
+    return kCommandTable[id].flags;
+}
+
+SdkResult SimQhyCameraDriver::execute(SdkDeviceHandle device, const SdkCommand& cmd)
+{
+    const SdkCommandId id = (cmd.idOwner == this) ? cmd.id : resolveCommand(cmd.name);
+    return executeById(device, id, cmd);
+}
+
+SdkResult SimQhyCameraDriver::executeById(SdkDeviceHandle device, SdkCommandId id, const SdkCommand& cmd)
+{
+    if (cmd.type != SdkCommandType::Custom || id < 0 || static_cast<size_t>(id) >= kCommandCount) {
+        return fail("Unsupported QHY command: " + cmd.name, SdkErrorCode::NotImplemented);
+    }
+
+    const CommandEntry& entry = kCommandTable[id];
+    auto* cam = static_cast<sim::VirtualCamera*>(device);
+
+    if (entry.needsHandle && !cam) {
+        return fail(std::string(entry.name) + " requires a valid device handle", SdkErrorCode::InvalidParameter);
+    }
+    if (entry.payloadType && cmd.payload.type() != *entry.payloadType) {
+        return fail(std::string("Invalid parameter type for ") + entry.payloadName, SdkErrorCode::InvalidParameter);
+    }
+    return (this->*entry.handler)(cam, cmd);
+}
+
+SdkResult SimQhyCameraDriver::cmdAccept(sim::VirtualCamera* /*cam*/, const SdkCommand& cmd)
+{
+    return ok(cmd.name + " success (simulated)");
+}
+
+SdkResult SimQhyCameraDriver::cmdGetSdkVersion(sim::VirtualCamera* /*cam*/, const SdkCommand& /*cmd*/)
+{
+    SdkResult r = ok("QHYCCD SDK version: V20240101_SIM");
+    r.payload = std::string("V20240101_SIM");
+    return r;
+}
+
+SdkResult SimQhyCameraDriver::cmdGetFirmwareVersion(sim::VirtualCamera* /*cam*/, const SdkCommand& /*cmd*/)
+{
+    SdkResult r = ok("FW 2024_1_1");
+    r.payload = std::string("FW 2024_1_1");
+    return r;
+}
+
+SdkResult SimQhyCameraDriver::cmdScanCameras(sim::VirtualCamera* /*cam*/, const SdkCommand& /*cmd*/)
+{
+    const int count = static_cast<int>(sim::VirtualRig::instance().cameraCount());
+    SdkResult r = ok("ScanQHYCCD, camera count = " + std::to_string(count));
+    r.payload = count;
+    return r;
+}
+
+SdkResult SimQhyCameraDriver::cmdGetCameraIdByIndex(sim::VirtualCamera* /*cam*/, const SdkCommand& cmd)
+{
+    const int index = payloadAs<int>(cmd);
+    sim::VirtualCamera* target = index >= 0 ? sim::VirtualRig::instance().camera(static_cast<size_t>(index)) : nullptr;
+    if (!target) {
+        return fail("GetQHYCCDId failed, index out of range: " + std::to_string(index));
+    }
+    SdkResult r = ok("GetQHYCCDId success, index = " + std::to_string(index) + ", id = " + target->spec().id);
+    r.payload = target->spec().id;
+    return r;
+}
+
+SdkResult SimQhyCameraDriver::cmdGetOverScanArea(sim::VirtualCamera* /*cam*/, const SdkCommand& /*cmd*/)
+{
+    SdkResult r = ok("GetQHYCCDOverScanArea success");
+    r.payload = SdkAreaInfo{};
+    return r;
+}
+
+SdkResult SimQhyCameraDriver::cmdGetEffectiveArea(sim::VirtualCamera* cam, const SdkCommand& /*cmd*/)
+{
+    SdkAreaInfo info;
+    info.sizeX = static_cast<unsigned int>(cam->spec().width);
+    info.sizeY = static_cast<unsigned int>(cam->spec().height);
+    SdkResult r = ok("GetQHYCCDEffectiveArea success");
+    r.payload = info;
+    return r;
+}
+
+SdkResult SimQhyCameraDriver::cmdGetChipInfo(sim::VirtualCamera* cam, const SdkCommand& /*cmd*/)
+{
+    const sim::VirtualCameraSpec& spec = cam->spec();
+    SdkChipInfo info;
+    info.chipWidthMM   = spec.width * spec.pixelUm / 1000.0;
+    info.chipHeightMM  = spec.height * spec.pixelUm / 1000.0;
+    info.pixelWidthUM  = spec.pixelUm;
+    info.pixelHeightUM = spec.pixelUm;
+    info.maxImageSizeX = static_cast<unsigned int>(spec.width);
+    info.maxImageSizeY = static_cast<unsigned int>(spec.height);
+    info.bpp           = 16;
+    SdkResult r = ok("GetQHYCCDChipInfo success");
+    r.payload = info;
+    return r;
+}
+
+SdkResult SimQhyCameraDriver::cmdSetGain(sim::VirtualCamera* cam, const SdkCommand& cmd)
+{
+    cam->setGain(std::clamp(payloadAs<double>(cmd), 0.0, 100.0));
+    return ok("SetQHYCCDParam CONTROL_GAIN success");
+}
+
+SdkResult SimQhyCameraDriver::cmdSetOffset(sim::VirtualCamera* cam, const SdkCommand& cmd)
+{
+    cam->setOffset(std::clamp(payloadAs<double>(cmd), 0.0, 255.0));
+    return ok("SetQHYCCDParam CONTROL_OFFSET success");
+}
+
+SdkResult SimQhyCameraDriver::cmdSetExposure(sim::VirtualCamera* cam, const SdkCommand& cmd)
+{
+    cam->setExposureUs(payloadAs<double>(cmd));
+    return ok("SetQHYCCDParam CONTROL_EXPOSURE success");
+}
+
+SdkResult SimQhyCameraDriver::cmdGetUsbTraffic(sim::VirtualCamera* /*cam*/, const SdkCommand& /*cmd*/)
+{
+    SdkResult r = ok("USBTraffic param info acquired");
+    r.payload = paramInfo(0.0, 60.0, 1.0, 30.0);
+    return r;
+}
+
+SdkResult SimQhyCameraDriver::cmdGetGain(sim::VirtualCamera* cam, const SdkCommand& /*cmd*/)
+{
+    SdkResult r = ok("Gain param info acquired");
+    r.payload = paramInfo(0.0, 100.0, 1.0, cam->gain());
+    return r;
+}
+
+SdkResult SimQhyCameraDriver::cmdGetOffset(sim::VirtualCamera* cam, const SdkCommand& /*cmd*/)
+{
+    SdkResult r = ok("Offset param info acquired");
+    r.payload = paramInfo(0.0, 255.0, 1.0, cam->offset());
+    return r;
+}
+
+SdkResult SimQhyCameraDriver::cmdGetExposure(sim::VirtualCamera* cam, const SdkCommand& /*cmd*/)
+{
+    SdkResult r = ok("Exposure param info acquired");
+    r.payload = paramInfo(1.0, 3600.0e6, 1.0, cam->exposureUs());
+    return r;
+}
+
+SdkResult SimQhyCameraDriver::cmdSetResolution(sim::VirtualCamera* cam, const SdkCommand& cmd)
+{
+    // 与真机一致地容忍越界（例如 Bin 2 后仍按全幅下发）：裁到传感器范围内
+    const SdkAreaInfo& roi = payloadAs<SdkAreaInfo>(cmd);
+    const int x = std::min(static_cast<int>(roi.startX), cam->spec().width - 1);
+    const int y = std::min(static_cast<int>(roi.startY), cam->spec().height - 1);
+    const int w = std::min(static_cast<int>(roi.sizeX), cam->spec().width - x);
+    const int h = std::min(static_cast<int>(roi.sizeY), cam->spec().height - y);
+    if (!cam->setRoi(x, y, w, h)) {
+        return fail("SetQHYCCDResolution failed: roi " + std::to_string(roi.startX) + "," + std::to_string(roi.startY) +
+                    " " + std::to_string(roi.sizeX) + "x" + std::to_string(roi.sizeY));
+    }
+    return ok("SetQHYCCDResolution success");
+}
+
+SdkResult SimQhyCameraDriver::cmdSetBinMode(sim::VirtualCamera* cam, const SdkCommand& cmd)
+{
+    const std::pair<int,int>& bin = payloadAs<std::pair<int,int>>(cmd);
+    if (!cam->setBin(bin.first, bin.second)) {
+        return fail("SetQHYCCDBinMode failed: " + std::to_string(bin.first) + "x" + std::to_string(bin.second));
+    }
+    return ok("SetQHYCCDBinMode success");
+}
+
+SdkResult SimQhyCameraDriver::cmdGetBitsMode(sim::VirtualCamera* /*cam*/, const SdkCommand& /*cmd*/)
+{
+    SdkResult r = ok("BitsMode param info acquired");
+    r.payload = paramInfo(8.0, 16.0, 8.0, 16.0);
+    return r;
+}
+
+SdkResult SimQhyCameraDriver::cmdStartSingleExposure(sim::VirtualCamera* cam, const SdkCommand& /*cmd*/)
+{
+    // 与真机驱动一致：只触发曝光，不在驱动层等待
+    cam->startExposure();
+    return ok("ExpQHYCCDSingleFrame success");
+}
+
+SdkResult SimQhyCameraDriver::cmdGetMemLength(sim::VirtualCamera* cam, const SdkCommand& /*cmd*/)
+{
+    const uint32_t length = static_cast<uint32_t>(cam->frameBytes());
+    SdkResult r;
+    r.success = (length > 0);
+    r.message = "GetQHYCCDMemLength, length = " + std::to_string(length);
+    r.payload = length;
+    return r;
+}
+
+SdkResult SimQhyCameraDriver::cmdGetSingleFrame(sim::VirtualCamera* cam, const SdkCommand& /*cmd*/)
+{
+    // 与真机驱动相同的判定：剩余 > 100ms 让上层继续轮询；≤ 100ms 视为曝光结束，读出前补足剩余时间
+    const double remaining = cam->remainingMs();
+    if (remaining > 100.0) {
+        return fail("Exposure not finished, remaining=" + std::to_string(static_cast<uint32_t>(remaining)) +
+                    "ms (will retry)");
+    }
+    if (remaining > 0.0) {
+        std::this_thread::sleep_for(std::chrono::duration<double, std::milli>(remaining));
+    }
+
+    auto buffer = std::make_shared<std::vector<unsigned char>>(cam->frameBytes());
+    sim::VirtualCamera::Frame meta;
+    if (!cam->readSingleFrame(reinterpret_cast<uint16_t*>(buffer->data()), &meta)) {
+        return fail("GetQHYCCDSingleFrame failed: no exposure in progress");
+    }
+
+    SdkFrameData frame;
+    frame.width     = meta.width;
+    frame.height    = meta.height;
+    frame.bpp       = 16;
+    frame.channels  = 1;
+    frame.rawBytes  = static_cast<size_t>(meta.width) * meta.height * sizeof(uint16_t);
+    frame.rawBuffer = std::move(buffer);
+
+    SdkResult r = ok("GetQHYCCDSingleFrame success");
+    r.frame = std::move(frame);
+    return r;
+}
+
+SdkResult SimQhyCameraDriver::cmdBeginLive(sim::VirtualCamera* cam, const SdkCommand& /*cmd*/)
+{
+    cam->beginLive();
+    return ok("BeginQHYCCDLive success");
+}
+
+SdkResult SimQhyCameraDriver::cmdGetLiveFrame(sim::VirtualCamera* cam, const SdkCommand& /*cmd*/)
+{
+    SdkResult r;
+    const size_t length = cam->frameBytes();
+    auto buffer = acquireLiveBuffer(cam, length);
+
+    SdkFrameData frame;
+    sim::VirtualCamera::Frame meta;
+    if (buffer) {
+        if (!cam->readLiveFrame(reinterpret_cast<uint16_t*>(buffer->data()), &meta)) {
+            r.message = "GetQHYCCDLiveFrame: no frame ready";
+            return r;
+        }
+        frame.rawBuffer = std::move(buffer);
+        frame.rawBytes  = length;
+    } else {
+        // 缓冲池被下游占满：渲染到 pixels（对应真机的回退拷贝路径，每帧一次分配）
+        frame.pixels.resize(length / sizeof(uint16_t));
+        if (!cam->readLiveFrame(frame.pixels.data(), &meta)) {
+            r.message = "GetQHYCCDLiveFrame: no frame ready";
+            return r;
+        }
+    }
+    frame.width    = meta.width;
+    frame.height   = meta.height;
+    frame.bpp      = 16;
+    frame.channels = 1;
+
+    // Live 热路径：成功时不填 message
+    r.success = true;
+    r.frame   = std::move(frame);
+    return r;
+}
+
+SdkResult SimQhyCameraDriver::cmdGetLiveFrameFast(sim::VirtualCamera* cam, const SdkCommand& /*cmd*/)
+{
+    SdkResult r;
+    const size_t length = cam->frameBytes();
+    auto buffer = acquireLiveBuffer(cam, length);
+    std::vector<unsigned char> scratch;
+    if (!buffer) {
+        scratch.resize(length);
+    }
+    unsigned char* out = buffer ? buffer->data() : scratch.data();
+
+    sim::VirtualCamera::Frame meta;
+    if (!cam->readLiveFrame(reinterpret_cast<uint16_t*>(out), &meta)) {
+        r.message = "GetQHYCCDLiveFrame: no frame ready";
+        return r;
+    }
+    SdkFrameData frame;
+    frame.width    = meta.width;
+    frame.height   = meta.height;
+    frame.bpp      = 16;
+    frame.channels = 1;
+
+    r.success = true;
+    r.frame   = std::move(frame);
+    return r;
+}
+
+SdkResult SimQhyCameraDriver::cmdStopLive(sim::VirtualCamera* cam, const SdkCommand& /*cmd*/)
+{
+    cam->stopLive();
+    return ok("StopQHYCCDLive success");
+}
+
+SdkResult SimQhyCameraDriver::cmdCheckSingleFrameModeAvailable(sim::VirtualCamera* /*cam*/, const SdkCommand& /*cmd*/)
+{
+    SdkResult r = ok("Single frame mode available");
+    r.payload = true;
+    return r;
+}
+
+SdkResult SimQhyCameraDriver::cmdIsColorCamera(sim::VirtualCamera* /*cam*/, const SdkCommand& /*cmd*/)
+{
+    SdkResult r = ok("Monochrome camera (simulated)");
+    r.payload = false;
+    return r;
+}
+
+SdkResult SimQhyCameraDriver::cmdGetCameraCfa(sim::VirtualCamera* /*cam*/, const SdkCommand& /*cmd*/)
+{
+    SdkResult r = ok("Camera is monochrome or CAM_IS_COLOR not supported");
+    r.payload = std::string();
+    return r;
+}
+
+SdkResult SimQhyCameraDriver::cmdGetCurrentTemperature(sim::VirtualCamera* cam, const SdkCommand& /*cmd*/)
+{
+    SdkResult r;
+    r.success = true;
+    r.payload = cam->temperatureC();
+    return r;
+}
+
+SdkResult SimQhyCameraDriver::cmdSetCoolerTargetTemperature(sim::VirtualCamera* cam, const SdkCommand& cmd)
+{
+    cam->setCoolerTarget(payloadAs<double>(cmd));
+    return ok("SetQHYCCDParam CONTROL_COOLER success");
+}
+
+SdkResult SimQhyCameraDriver::cmdGetCoolerTargetTemperature(sim::VirtualCamera* cam, const SdkCommand& /*cmd*/)
+{
+    SdkResult r = ok("Cooler target param info acquired");
+    r.payload = paramInfo(-50.0, 50.0, 0.5, cam->coolerTarget());
+    return r;
+}
+
+SdkResult SimQhyCameraDriver::cmdGetCoolerPower(sim::VirtualCamera* cam, const SdkCommand& /*cmd*/)
+{
+    SdkResult r;
+    r.success = true;
+    r.payload = cam->coolerPowerPercent();
+    return r;
+}
+
+SdkResult SimQhyCameraDriver::cmdCancelExposure(sim::VirtualCamera* cam, const SdkCommand& /*cmd*/)
+{
+    cam->cancelExposure();
+    return ok("CancelQHYCCDExposingAndReadout success");
+}
+
+SdkResult SimQhyCameraDriver::cmdIsCFWPlugged(sim::VirtualCamera* cam, const SdkCommand& /*cmd*/)
+{
+    const bool plugged = cam->filterWheel() != nullptr;
+    SdkResult r = ok(plugged ? "CFW is plugged" : "CFW is not plugged");
+    r.payload = plugged;
+    return r;
+}
+
+SdkResult SimQhyCameraDriver::cmdGetCFWSlotsNum(sim::VirtualCamera* cam, const SdkCommand& /*cmd*/)
+{
+    if (!cam->filterWheel()) {
+        return fail("GetQHYCCDParam CONTROL_CFWSLOTSNUM failed");
+    }
+    const int slots = cam->filterWheel()->slots();
+    SdkResult r = ok("CFW slots number = " + std::to_string(slots));
+    r.payload = slots;
+    return r;
+}
+
+SdkResult SimQhyCameraDriver::cmdGetCFWPosition(sim::VirtualCamera* cam, const SdkCommand& /*cmd*/)
+{
+    const int position = cam->filterWheel() ? cam->filterWheel()->position() : -1;
+    if (position < 0) {
+        // 转动中（或无滤镜轮）读不到槽位：上层按失败继续轮询
+        return fail("GetQHYCCDParam CONTROL_CFWPORT failed");
+    }
+    SdkResult r = ok("Current CFW position = " + std::to_string(position));
+    r.payload = position;
+    return r;
+}
+
+SdkResult SimQhyCameraDriver::cmdSetCFWPosition(sim::VirtualCamera* cam, const SdkCommand& cmd)
+{
+    const int position = payloadAs<int>(cmd);
+    // 滤镜轮属于整台虚拟设备，相机只持有只读指针；转动通过 VirtualRig 下发
+    if (!cam->filterWheel() || !sim::VirtualRig::instance().filterWheel().setPosition(position)) {
+        return fail("SetQHYCCDParam CONTROL_CFWPORT failed, position " + std::to_string(position));
+    }
+    return ok("SetQHYCCDParam CONTROL_CFWPORT success, position set to " + std::to_string(position));
+}
+
+SdkResult SimQhyCameraDriver::cmdGetCFWStatus(sim::VirtualCamera* cam, const SdkCommand& /*cmd*/)
+{
+    if (!cam->filterWheel()) {
+        return fail("GetQHYCCDCFWStatus failed: no CFW");
+    }
+    const int position = cam->filterWheel()->position();
+    const std::string status = position < 0 ? std::string("N") : std::to_string(position);
+    SdkResult r = ok("CFW status: " + status);
+    r.payload = status;
+    return r;
+}
+
+SdkResult SimQhyCameraDriver::scanDevices(std::vector<SdkDeviceInfo>& outDevices)
+{
+    outDevices.clear();
+    sim::VirtualRig& rig = sim::VirtualRig::instance();
+    for (size_t i = 0; i < rig.cameraCount(); ++i) {
+        SdkDeviceInfo info;
+        info.deviceId    = rig.camera(i)->spec().id;
+        info.driverName  = SDK_DRIVER_NAME_QHYCCD;
+        info.description = "QHYCCD Camera " + info.deviceId + " (simulated)";
+        info.state       = SdkDeviceState::Closed;
+        outDevices.push_back(info);
+    }
+    return ok("Scanned " + std::to_string(outDevices.size()) + " QHYCCD camera(s)");
+}
+
+SdkDeviceCapabilities SimQhyCameraDriver::capabilities() const
+{
+    SdkDeviceCapabilities caps;
+    caps.deviceType = SdkDeviceType::Camera;
+    auto cmdList = commandList();
+    caps.supportedCommands.reserve(cmdList.size());
+    for (const auto& cmd : cmdList) {
+        caps.supportedCommands.push_back(cmd.name);
+    }
+    caps.supportsMultiDevice = true;
+    return caps;
+}
@@ -0,0 +1,116 @@
+#ifndef SIM_QHY_CAMERA_DRIVER_H
+#define SIM_QHY_CAMERA_DRIVER_H
+
+#include "../SdkDriver.h"
+#include "../SdkCommon.h"
+#include "../../sim/VirtualRig.h"
+
+#include <mutex>
+#include <set>
+#include <string>
+#include <typeinfo>
+#include <unordered_map>
+#include <vector>
+
+// 与真实 QHY 驱动同名：虚拟天文台构建（QUARCS_VIRTUAL_OBSERVATORY=ON）用本驱动替换 sdks/QHYCCD，
+// MainWindow 按 "indi_qhy_ccd" 走完全相同的 SDK 连接/拍摄/导星/Live 流程
+#define SDK_DRIVER_NAME_INDI_QHY_CCD "indi_qhy_ccd"
+#define SDK_DRIVER_NAME_QHYCCD       "QHYCCD"
+
+// 模拟 QHY 相机 SDK 驱动：命令名、payload 类型、返回类型和命令属性位与 QhyCameraDriver 一一对应，
+// 设备行为（曝光/读出计时、Live 节拍、ROI/Bin、CFW 转动、制冷）由 sim::VirtualRig 提供。
+// 句柄即 sim::VirtualCamera*。
+class SimQhyCameraDriver : public ISdkDriver {
+public:
+    SimQhyCameraDriver();
+    ~SimQhyCameraDriver() override;
+
+    std::vector<std::string> driverNames() const override;
+    std::vector<SdkCommandInfo> commandList() const override;
+
+    // openDevice：openParam 期望为 std::string（cameraId），同一相机同时只能打开一次（与 OpenQHYCCD 一致）
+    SdkResult openDevice(const std::any& openParam) override;
+    SdkResult closeDevice(SdkDeviceHandle handle) override;
+    SdkResult execute(SdkDeviceHandle handle, const SdkCommand& cmd) override;
+
+    SdkCommandId resolveCommand(const std::string& name) const override;
+    unsigned commandFlags(SdkCommandId id) const override;
+    SdkResult executeById(SdkDeviceHandle handle, SdkCommandId id, const SdkCommand& cmd) override;
+
+    SdkResult scanDevices(std::vector<SdkDeviceInfo>& outDevices) override;
+    SdkDeviceCapabilities capabilities() const override;
+
+private:
+    using CommandHandler = SdkResult (SimQhyCameraDriver::*)(sim::VirtualCamera* cam, const SdkCommand& cmd);
+
+    // 命令表项：字段含义与 QhyCameraDriver::CommandEntry 相同，下标即 SdkCommandId
+    struct CommandEntry {
+        const char*           name;
+        CommandHandler        handler;
+        const char*           description;
+        const std::type_info* payloadType;
+        const char*           payloadName;
+        bool                  needsHandle;
+        unsigned              flags;
+    };
+
+    static const CommandEntry kCommandTable[];
+    static const size_t       kCommandCount;
+
+    std::unordered_map<std::string, SdkCommandId> m_commandIds;
+
+    std::mutex m_openMutex;
+    std::set<const sim::VirtualCamera*> m_open;
+
+    template<typename T>
+    static const T& payloadAs(const SdkCommand& cmd)
+    {
+        return *std::any_cast<T>(&cmd.payload);
+    }
+
+    static SdkResult ok(const std::string& message);
+    static SdkResult fail(const std::string& message, SdkErrorCode code = SdkErrorCode::OperationFailed);
+
+    // 只需应答成功的命令（读出模式、DDR、USB 流量、Burst 控制等，对模拟设备没有可观察的效果）
+    SdkResult cmdAccept(sim::VirtualCamera* cam, const SdkCommand& cmd);
+
+    SdkResult cmdGetSdkVersion(sim::VirtualCamera* cam, const SdkCommand& cmd);
+    SdkResult cmdGetFirmwareVersion(sim::VirtualCamera* cam, const SdkCommand& cmd);
+    SdkResult cmdScanCameras(sim::VirtualCamera* cam, const SdkCommand& cmd);
+    SdkResult cmdGetCameraIdByIndex(sim::VirtualCamera* cam, const SdkCommand& cmd);
+    SdkResult cmdGetOverScanArea(sim::VirtualCamera* cam, const SdkCommand& cmd);
+    SdkResult cmdGetEffectiveArea(sim::VirtualCamera* cam, const SdkCommand& cmd);
+    SdkResult cmdGetChipInfo(sim::VirtualCamera* cam, const SdkCommand& cmd);
+    SdkResult cmdSetGain(sim::VirtualCamera* cam, const SdkCommand& cmd);
+    SdkResult cmdSetOffset(sim::VirtualCamera* cam, const SdkCommand& cmd);
+    SdkResult cmdSetExposure(sim::VirtualCamera* cam, const SdkCommand& cmd);
+    SdkResult cmdGetUsbTraffic(sim::VirtualCamera* cam, const SdkCommand& cmd);
+    SdkResult cmdGetGain(sim::VirtualCamera* cam, const SdkCommand& cmd);
+    SdkResult cmdGetOffset(sim::VirtualCamera* cam, const SdkCommand& cmd);
+    SdkResult cmdGetExposure(sim::VirtualCamera* cam, const SdkCommand& cmd);
+    SdkResult cmdSetResolution(sim::VirtualCamera* cam, const SdkCommand& cmd);
+    SdkResult cmdSetBinMode(sim::VirtualCamera* cam, const SdkCommand& cmd);
+    SdkResult cmdGetBitsMode(sim::VirtualCamera* cam, const SdkCommand& cmd);
+    SdkResult cmdStartSingleExposure(sim::VirtualCamera* cam, const SdkCommand& cmd);
+    SdkResult cmdGetMemLength(sim::VirtualCamera* cam, const SdkCommand& cmd);
+    SdkResult cmdGetSingleFrame(sim::VirtualCamera* cam, const SdkCommand& cmd);
+    SdkResult cmdBeginLive(sim::VirtualCamera* cam, const SdkCommand& cmd);
+    SdkResult cmdGetLiveFrame(sim::VirtualCamera* cam, const SdkCommand& cmd);
+    SdkResult cmdGetLiveFrameFast(sim::VirtualCamera* cam, const SdkCommand& cmd);
+    SdkResult cmdStopLive(sim::VirtualCamera* cam, const SdkCommand& cmd);
+    SdkResult cmdCheckSingleFrameModeAvailable(sim::VirtualCamera* cam, const SdkCommand& cmd);
+    SdkResult cmdIsColorCamera(sim::VirtualCamera* cam, const SdkCommand& cmd);
+    SdkResult cmdGetCameraCfa(sim::VirtualCamera* cam, const SdkCommand& cmd);
+    SdkResult cmdGetCurrentTemperature(sim::VirtualCamera* cam, const SdkCommand& cmd);
+    SdkResult cmdSetCoolerTargetTemperature(sim::VirtualCamera* cam, const SdkCommand& cmd);
+    SdkResult cmdGetCoolerTargetTemperature(sim::VirtualCamera* cam, const SdkCommand& cmd);
+    SdkResult cmdGetCoolerPower(sim::VirtualCamera* cam, const SdkCommand& cmd);
+    SdkResult cmdCancelExposure(sim::VirtualCamera* cam, const SdkCommand& cmd);
+    SdkResult cmdIsCFWPlugged(sim::VirtualCamera* cam, const SdkCommand& cmd);
+    SdkResult cmdGetCFWSlotsNum(sim::VirtualCamera* cam, const SdkCommand& cmd);
+    SdkResult cmdGetCFWPosition(sim::VirtualCamera* cam, const SdkCommand& cmd);
+    SdkResult cmdSetCFWPosition(sim::VirtualCamera* cam, const SdkCommand& cmd);
+    SdkResult cmdGetCFWStatus(sim::VirtualCamera* cam, const SdkCommand& cmd);
+};
+
+#endif // SIM_QHY_CAMERA_DRIVER_H
@@ -0,0 +1,194 @@
+#include "SimQhyFocuser.h"
+#include "../LoggerAdapter.h"
+#include "../SdkManager.h"
+#include "../../sim/VirtualRig.h"
+
+REGISTER_SDK_DRIVER(SDK_DRIVER_NAME_INDI_QHY_FOCUSER, SimQhyFocuserDriver)
+
+namespace {
+
+SdkResult makeErr(const std::string &msg)
+{
+    SdkResult r;
+    r.success = false;
+    r.errorCode = SdkErrorCode::OperationFailed;
+    r.message = msg;
+    return r;
+}
+
+SdkResult makeOk(const std::string &msg)
+{
+    SdkResult r;
+    r.success = true;
+    r.message = msg;
+    return r;
+}
+
+template <typename T>
+const T *payloadIf(const SdkCommand &cmd)
+{
+    return std::any_cast<T>(&cmd.payload);
+}
+
+} // namespace
+
+std::vector<std::string> SimQhyFocuserDriver::driverNames() const
+{
+    return {SDK_DRIVER_NAME_INDI_QHY_FOCUSER, SDK_DRIVER_NAME_QHY_FOCUSER};
+}
+
+std::vector<SdkCommandInfo> SimQhyFocuserDriver::commandList() const
+{
+    return {
+        {"Handshake",      "握手：返回版本（模拟）"},
+        {"GetVersion",     "读取电调版本信息（模拟）"},
+        {"GetTemperature", "读取温度，返回 double 摄氏度（模拟）"},
+        {"GetPosition",    "读取当前位置（移动中为插值位置）"},
+        {"MoveRelative",   "相对移动，payload=SdkFocuserRelMoveParam"},
+        {"MoveAbsolute",   "绝对移动，payload=int target"},
+        {"Abort",          "停止移动"},
+        {"SetReverse",     "反向，payload=bool 或 int(0/1)"},
+        {"SyncPosition",   "同步当前位置，payload=int position"},
+        {"SetSpeed",       "设置速度，payload=int speed(0..8，0最快)"},
+        {"GetSpeed",       "获取速度，返回 int"},
+    };
+}
+
+SdkDeviceCapabilities SimQhyFocuserDriver::capabilities() const
+{
+    SdkDeviceCapabilities caps;
+    caps.deviceType = SdkDeviceType::Focuser;
+    auto cmds = commandList();
+    caps.supportedCommands.reserve(cmds.size());
+    for (const auto &cmd : cmds)
+        caps.supportedCommands.push_back(cmd.name);
+    return caps;
+}
+
+SdkResult SimQhyFocuserDriver::openDevice(const std::any &openParam)
+{
+    const auto *p = std::any_cast<SdkFocuserOpenParam>(&openParam);
+    if (!p)
+    {
+        SdkResult r = makeErr("Invalid parameter type for QhyFocuserOpenParam");
+        r.errorCode = SdkErrorCode::InvalidParameter;
+        return r;
+    }
+
+    sim::VirtualFocuser &focuser = sim::VirtualRig::instance().focuser();
+    Logger::Log("SimQFocuser | open (port " + p->port + " ignored), position=" + std::to_string(focuser.position()) +
+                    ", best=" + std::to_string(focuser.params().bestPosition),
+                LogLevel::INFO, DeviceType::FOCUSER);
+
+    SdkResult r = makeOk("Open simulated focuser: " + p->port);
+    r.payload = static_cast<SdkDeviceHandle>(&focuser);
+    return r;
+}
+
+SdkResult SimQhyFocuserDriver::closeDevice(SdkDeviceHandle handle)
+{
+    if (!handle)
+        return makeErr("closeDevice: handle is null");
+    // 虚拟电调属于进程内的 VirtualRig，关闭时只停下，不销毁（下次连接位置延续）
+    static_cast<sim::VirtualFocuser *>(handle)->abort();
+    return makeOk("Close focuser serial success");
+}
+
+SdkResult SimQhyFocuserDriver::execute(SdkDeviceHandle handle, const SdkCommand &cmd)
+{
+    if (!handle)
+        return makeErr("execute: handle is null");
+    if (cmd.type != SdkCommandType::Custom)
+        return makeErr("Unsupported command type for QHY focuser");
+
+    auto *focuser = static_cast<sim::VirtualFocuser *>(handle);
+    const std::string &name = cmd.name;
+
+    if (name == "Handshake" || name == "GetVersion")
+    {
+        SdkFocuserVersion version;
+        version.id = "QFocuser-SIM";
+        version.version = 20240101;
+        version.boardVersion = 1;
+        SdkResult r = makeOk(name + " success");
+        r.payload = version;
+        return r;
+    }
+
+    if (name == "GetTemperature")
+    {
+        SdkResult r = makeOk("GetTemperature success");
+        r.payload = focuser->temperatureC();
+        return r;
+    }
+
+    if (name == "GetPosition")
+    {
+        SdkResult r = makeOk("GetPosition success");
+        r.payload = focuser->position();
+        return r;
+    }
+
+    if (name == "MoveRelative")
+    {
+        const auto *p = payloadIf<SdkFocuserRelMoveParam>(cmd);
+        if (!p)
+            return makeErr("Invalid parameter type for SdkFocuserRelMoveParam");
+        const int steps = p->steps < 0 ? -p->steps : p->steps;
+        focuser->moveBy(p->outward ? steps : -steps);
+        return makeOk("Command ack, idx=2");
+    }
+
+    if (name == "MoveAbsolute")
+    {
+        const auto *target = payloadIf<int>(cmd);
+        if (!target)
+            return makeErr("Invalid parameter type for target");
+        focuser->moveTo(*target);
+        return makeOk("Command ack, idx=6");
+    }
+
+    if (name == "Abort")
+    {
+        focuser->abort();
+        return makeOk("Abort sent");
+    }
+
+    if (name == "SetReverse")
+    {
+        if (const auto *b = payloadIf<bool>(cmd))
+            focuser->setReverse(*b);
+        else if (const auto *i = payloadIf<int>(cmd))
+            focuser->setReverse(*i != 0);
+        else
+            return makeErr("SetReverse payload must be bool or int");
+        return makeOk("Command ack, idx=7");
+    }
+
+    if (name == "SyncPosition")
+    {
+        const auto *pos = payloadIf<int>(cmd);
+        if (!pos)
+            return makeErr("Invalid parameter type for position");
+        focuser->sync(*pos);
+        return makeOk("Command ack, idx=11");
+    }
+
+    if (name == "SetSpeed")
+    {
+        const auto *speed = payloadIf<int>(cmd);
+        if (!speed)
+            return makeErr("Invalid parameter type for speed");
+        focuser->setSpeed(*speed);
+        return makeOk("Command ack, idx=13");
+    }
+
+    if (name == "GetSpeed")
+    {
+        SdkResult r = makeOk("GetSpeed (cached)");
+        r.payload = focuser->speed();
+        return r;
+    }
+
+    return makeErr("Unsupported QHY focuser command: " + cmd.name);
+}
@@ -0,0 +1,29 @@
+#ifndef SIM_QHY_FOCUSER_DRIVER_H
+#define SIM_QHY_FOCUSER_DRIVER_H
+
+#include "../SdkDriver.h"
+#include "../SdkCommon.h"
+
+#include <string>
+#include <vector>
+
+// 与真实 QHY 电调驱动同名，虚拟天文台构建中替换 sdks/QHYCCD/QHYFocuser
+#define SDK_DRIVER_NAME_INDI_QHY_FOCUSER "indi_qhy_focuser"
+#define SDK_DRIVER_NAME_QHY_FOCUSER      "QFocuser"
+
+// 模拟 QHY 电调驱动：命令名与 payload 类型同 QhyFocuserDriver，设备为 sim::VirtualRig 的电调
+// （句柄即 sim::VirtualFocuser*）。打开参数仍要求 SdkFocuserOpenParam，但不访问串口；
+// 移动按速度档匀速进行，GetPosition 在移动中返回插值位置，与真机轮询节奏一致。
+class SimQhyFocuserDriver : public ISdkDriver
+{
+public:
+    std::vector<std::string> driverNames() const override;
+    std::vector<SdkCommandInfo> commandList() const override;
+    SdkDeviceCapabilities capabilities() const override;
+
+    SdkResult openDevice(const std::any &openParam) override;
+    SdkResult closeDevice(SdkDeviceHandle handle) override;
+    SdkResult execute(SdkDeviceHandle handle, const SdkCommand &cmd) override;
+};
+
+#endif // SIM_QHY_FOCUSER_DRIVER_H
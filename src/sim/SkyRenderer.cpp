@@ -0,0 +1,335 @@
+#include "SkyRenderer.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <thread>
+
+namespace sim {
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+// λ 不小于此值时泊松用正态近似
+constexpr double kPoissonNormalLambda = 16.0;
+
+} // namespace
+
+// ---------------- CounterRng ----------------
+
+uint64_t CounterRng::mix(uint64_t a, uint64_t b)
+{
+    uint64_t z = a + 0x9E3779B97F4A7C15ULL * (b + 1);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+uint64_t CounterRng::next()
+{
+    return mix(m_key, m_counter++);
+}
+
+double CounterRng::uniform()
+{
+    return (static_cast<double>(next() >> 11) + 0.5) * (1.0 / 9007199254740992.0);
+}
+
+double CounterRng::normal()
+{
+    const double u1 = uniform();
+    const double u2 = uniform();
+    return std::sqrt(-2.0 * std::log(u1)) * std::cos(2.0 * kPi * u2);
+}
+
+void CounterRng::normalPair(double* a, double* b)
+{
+    const double r = std::sqrt(-2.0 * std::log(uniform()));
+    const double t = 2.0 * kPi * uniform();
+    *a = r * std::cos(t);
+    *b = r * std::sin(t);
+}
+
+uint32_t CounterRng::poisson(double lambda)
+{
+    if (!(lambda > 0.0))
+        return 0;
+    if (lambda >= kPoissonNormalLambda) {
+        const double k = std::floor(lambda + std::sqrt(lambda) * normal() + 0.5);
+        return k <= 0.0 ? 0u : static_cast<uint32_t>(std::min(k, 4294967295.0));
+    }
+    const double limit = std::exp(-lambda);
+    uint32_t k = 0;
+    double p = uniform();
+    while (p > limit) {
+        ++k;
+        p *= uniform();
+    }
+    return k;
+}
+
+// ---------------- PsfKernelCache ----------------
+
+PsfKernelCache::PsfKernelCache(int subpixelSteps, double radiusSigma, int sigmaQuant)
+    : m_steps(std::max(1, subpixelSteps)),
+      m_radiusSigma(std::max(1.0, radiusSigma)),
+      m_sigmaQuant(std::max(1, sigmaQuant))
+{
+}
+
+const PsfKernelCache::Profile& PsfKernelCache::profile(double sigmaPx)
+{
+    const int key = std::max(1, static_cast<int>(std::lround(sigmaPx * m_sigmaQuant)));
+    auto it = m_profiles.find(key);
+    if (it != m_profiles.end())
+        return *it->second;
+
+    const double sigma = static_cast<double>(key) / m_sigmaQuant;
+    auto prof = std::make_unique<Profile>();
+    prof->radius = std::max(1, static_cast<int>(std::ceil(m_radiusSigma * sigma + 0.5)));
+    const int size = 2 * prof->radius + 1;
+    prof->weights.resize(static_cast<size_t>(m_steps) * size);
+
+    const double inv = 1.0 / (sigma * std::sqrt(2.0));
+    for (int p = 0; p < m_steps; ++p) {
+        // 相位 p 对应星心相对像素中心的偏移
+        const double offset = static_cast<double>(p) / m_steps - 0.5;
+        float* w = prof->weights.data() + static_cast<size_t>(p) * size;
+        double sum = 0.0;
+        for (int i = -prof->radius; i <= prof->radius; ++i) {
+            const double v = 0.5 * (std::erf((i + 0.5 - offset) * inv) - std::erf((i - 0.5 - offset) * inv));
+            w[i + prof->radius] = static_cast<float>(v);
+            sum += v;
+        }
+        for (int i = 0; i < size; ++i)
+            w[i] = static_cast<float>(w[i] / sum);
+    }
+
+    Profile& ref = *prof;
+    m_profiles.emplace(key, std::move(prof));
+    return ref;
+}
+
+int PsfKernelCache::phaseIndex(double offset, int* carry) const
+{
+    int p = static_cast<int>(std::lround((offset + 0.5) * m_steps));
+    *carry = 0;
+    if (p >= m_steps) {
+        p -= m_steps;
+        *carry = 1;
+    } else if (p < 0) {
+        p = 0;
+    }
+    return p;
+}
+
+// ---------------- 辅助换算 ----------------
+
+double fluxFromPeak(double peak, double sigmaPx)
+{
+    return peak * 2.0 * kPi * sigmaPx * sigmaPx;
+}
+
+double sigmaFromHfr(double hfr)
+{
+    return hfr / std::sqrt(2.0 * std::log(2.0));
+}
+
+// ---------------- SkyRenderer ----------------
+
+SkyRenderer::SkyRenderer(int subpixelSteps, double radiusSigma)
+    : m_cache(subpixelSteps, radiusSigma)
+{
+}
+
+void SkyRenderer::prepare(const SkyRenderOptions& options, const std::vector<StarStamp>& stars)
+{
+    const int bandRows = std::max(1, options.bandRows);
+    const int bands = (options.height + bandRows - 1) / bandRows;
+    m_bandStars.resize(static_cast<size_t>(bands));
+    for (auto& b : m_bandStars)
+        b.clear();
+    m_prepared.clear();
+    m_prepared.reserve(stars.size());
+
+    for (const StarStamp& s : stars) {
+        if (!(s.flux > 0.0) || !std::isfinite(s.x) || !std::isfinite(s.y) || !(s.sigmaPx > 0.0))
+            continue;
+        Prepared p;
+        p.profile = &m_cache.profile(s.sigmaPx);
+        const int r = p.profile->radius;
+
+        const double fx = std::floor(s.x + 0.5);
+        const double fy = std::floor(s.y + 0.5);
+        // 远在画面外的星直接跳过，也避免坐标转 int 溢出
+        if (fx + r < 0.0 || fx - r >= options.width || fy + r < 0.0 || fy - r >= options.height)
+            continue;
+        int carry = 0;
+        p.cx = static_cast<int>(fx);
+        p.cy = static_cast<int>(fy);
+        p.phaseX = m_cache.phaseIndex(s.x - fx, &carry);
+        p.cx += carry;
+        p.phaseY = m_cache.phaseIndex(s.y - fy, &carry);
+        p.cy += carry;
+        p.flux = static_cast<float>(s.flux);
+
+        const int y0 = std::max(0, p.cy - r);
+        const int y1 = std::min(options.height - 1, p.cy + r);
+        if (y0 > y1 || p.cx + r < 0 || p.cx - r >= options.width)
+            continue;
+        const uint32_t index = static_cast<uint32_t>(m_prepared.size());
+        m_prepared.push_back(p);
+        for (int b = y0 / bandRows; b <= y1 / bandRows; ++b)
+            m_bandStars[static_cast<size_t>(b)].push_back(index);
+    }
+}
+
+void SkyRenderer::renderBand(const SkyRenderOptions& options, int band, float* rows) const
+{
+    const int w = options.width;
+    const int bandRows = std::max(1, options.bandRows);
+    const int y0 = band * bandRows;
+    const int y1 = std::min(options.height, y0 + bandRows);
+
+    // 背景与暗角
+    const float bg = static_cast<float>(std::max(0.0, options.backgroundE));
+    if (options.vignette > 0.0 && bg > 0.0f) {
+        const double cx = (w - 1) * 0.5;
+        const double cy = (options.height - 1) * 0.5;
+        const double maxR = std::max(1e-9, std::sqrt(cx * cx + cy * cy));
+        const double k = options.vignette / maxR;
+        for (int y = y0; y < y1; ++y) {
+            float* row = rows + static_cast<size_t>(y - y0) * w;
+            const double dy2 = (y - cy) * (y - cy);
+            for (int x = 0; x < w; ++x) {
+                const double dx = x - cx;
+                row[x] = static_cast<float>(bg * (1.0 - k * std::sqrt(dx * dx + dy2)));
+            }
+        }
+    } else {
+        std::fill(rows, rows + static_cast<size_t>(y1 - y0) * w, bg);
+    }
+
+    // 落星：核外积累加，只写本行带内的行
+    for (uint32_t index : m_bandStars[static_cast<size_t>(band)]) {
+        const Prepared& p = m_prepared[index];
+        const int r = p.profile->radius;
+        const int size = 2 * r + 1;
+        const float* wx = p.profile->weights.data() + static_cast<size_t>(p.phaseX) * size;
+        const float* wy = p.profile->weights.data() + static_cast<size_t>(p.phaseY) * size;
+        const int jy0 = std::max(-r, y0 - p.cy);
+        const int jy1 = std::min(r, y1 - 1 - p.cy);
+        const int ix0 = std::max(-r, -p.cx);
+        const int ix1 = std::min(r, w - 1 - p.cx);
+        if (ix0 > ix1)
+            continue;
+        for (int j = jy0; j <= jy1; ++j) {
+            const float a = p.flux * wy[j + r];
+            float* dst = rows + static_cast<size_t>(p.cy + j - y0) * w + p.cx;
+            for (int i = ix0; i <= ix1; ++i)
+                dst[i] += a * wx[i + r];
+        }
+    }
+}
+
+template <typename Fn>
+void SkyRenderer::forEachBand(const SkyRenderOptions& options, Fn&& fn)
+{
+    const int bandRows = std::max(1, options.bandRows);
+    const int bands = static_cast<int>(m_bandStars.size());
+    int threads = options.threads > 0 ? options.threads : static_cast<int>(std::thread::hardware_concurrency());
+    threads = std::max(1, std::min(threads, bands));
+
+    std::atomic<int> nextBand{0};
+    auto worker = [&] {
+        std::vector<float> rows(static_cast<size_t>(bandRows) * options.width);
+        for (int band = nextBand.fetch_add(1); band < bands; band = nextBand.fetch_add(1)) {
+            renderBand(options, band, rows.data());
+            fn(band, rows.data());
+        }
+    };
+
+    std::vector<std::thread> pool;
+    pool.reserve(static_cast<size_t>(threads - 1));
+    for (int t = 1; t < threads; ++t)
+        pool.emplace_back(worker);
+    worker();
+    for (auto& th : pool)
+        th.join();
+}
+
+void SkyRenderer::render(const SkyRenderOptions& options, const std::vector<StarStamp>& stars,
+                         uint16_t* out, size_t strideElems)
+{
+    if (!out || options.width <= 0 || options.height <= 0)
+        return;
+    const size_t stride = strideElems ? strideElems : static_cast<size_t>(options.width);
+    prepare(options, stars);
+
+    const int w = options.width;
+    const int bandRows = std::max(1, options.bandRows);
+    const uint64_t frameKey = CounterRng::mix(options.seed, options.frameIndex);
+    const double invGain = 1.0 / std::max(1e-9, options.gainEPerAdu);
+    const double readNoise = std::max(0.0, options.readNoiseE);
+    const double readVar = readNoise * readNoise;
+    const double saturation = std::min(65535.0, std::max(0.0, options.saturationAdu));
+
+    const bool noisy = options.poisson || readNoise > 0.0;
+
+    // 一个像素：加噪声、换算 ADU、截断；n 为该像素分到的标准正态
+    auto pixel = [&](float value, double n, CounterRng& rng) -> uint16_t {
+        double e = std::max(0.0f, value);
+        if (options.poisson && e >= kPoissonNormalLambda) {
+            // 两个独立高斯之和：一次采样合并散粒噪声与读出噪声
+            e += std::sqrt(e + readVar) * n;
+        } else {
+            if (options.poisson)
+                e = rng.poisson(e);
+            e += readNoise * n;
+        }
+        const double adu = std::floor(options.biasAdu + e * invGain + 0.5);
+        return static_cast<uint16_t>(std::min(saturation, std::max(0.0, adu)));
+    };
+
+    forEachBand(options, [&](int band, const float* rows) {
+        const int y0 = band * bandRows;
+        const int y1 = std::min(options.height, y0 + bandRows);
+        for (int y = y0; y < y1; ++y) {
+            const float* src = rows + static_cast<size_t>(y - y0) * w;
+            uint16_t* dst = out + static_cast<size_t>(y) * stride;
+            const uint64_t rowBase = static_cast<uint64_t>(y) * static_cast<uint64_t>(w);
+            if (!noisy) {
+                CounterRng unused(0);
+                for (int x = 0; x < w; ++x)
+                    dst[x] = pixel(src[x], 0.0, unused);
+                continue;
+            }
+            // 行内相邻两个像素共用一次 Box-Muller（key 由左像素序号派生，与行带划分无关）
+            for (int x = 0; x < w; x += 2) {
+                CounterRng rng(CounterRng::mix(frameKey, rowBase + static_cast<uint64_t>(x)));
+                double n0 = 0.0;
+                double n1 = 0.0;
+                rng.normalPair(&n0, &n1);
+                dst[x] = pixel(src[x], n0, rng);
+                if (x + 1 < w)
+                    dst[x + 1] = pixel(src[x + 1], n1, rng);
+            }
+        }
+    });
+}
+
+void SkyRenderer::renderElectrons(const SkyRenderOptions& options, const std::vector<StarStamp>& stars, float* out)
+{
+    if (!out || options.width <= 0 || options.height <= 0)
+        return;
+    prepare(options, stars);
+    const int bandRows = std::max(1, options.bandRows);
+    forEachBand(options, [&](int band, const float* rows) {
+        const int y0 = band * bandRows;
+        const int y1 = std::min(options.height, y0 + bandRows);
+        std::copy(rows, rows + static_cast<size_t>(y1 - y0) * options.width,
+                  out + static_cast<size_t>(y0) * options.width);
+    });
+}
+
+} // namespace sim
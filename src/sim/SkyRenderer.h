@@ -0,0 +1,125 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace sim {
+
+// 计数器型随机数：结果只由 (key, counter) 决定，不依赖调用顺序。
+// 每个像素用 (种子, 帧号, 像素序号) 派生自己的 key，行带怎么分、几个线程渲染，同一帧的噪声都逐位一致。
+class CounterRng
+{
+public:
+    explicit CounterRng(uint64_t key) : m_key(key) {}
+
+    static uint64_t mix(uint64_t a, uint64_t b);   ///< 两个 64 位数混合成一个 key（SplitMix64 终结函数）
+
+    uint64_t next();
+    double uniform();                   ///< (0, 1)
+    double normal();                    ///< 标准正态（Box-Muller）
+    void normalPair(double* a, double* b);  ///< 一次 Box-Muller 得到两个独立标准正态
+    // λ < 16 用乘法法精确采样，否则用正态近似（λ 大时误差可忽略）
+    uint32_t poisson(double lambda);
+
+private:
+    uint64_t m_key;
+    uint64_t m_counter{0};
+};
+
+// 像素积分高斯 PSF 的子像素核缓存。
+// 高斯可分离：按 sigma（量化到 1/sigmaQuant px）缓存每个子像素相位的一维像素积分权重，
+// 落点时只做 flux·wx[i]·wy[j] 的外积累加，不再逐像素算 exp。
+class PsfKernelCache
+{
+public:
+    struct Profile {
+        int radius{0};                          ///< 核覆盖 [-radius, radius]（相对星心所在像素）
+        std::vector<float> weights;             ///< subpixelSteps 个相位 × (2·radius+1)，每个相位和为 1
+    };
+
+    explicit PsfKernelCache(int subpixelSteps = 16, double radiusSigma = 4.0, int sigmaQuant = 50);
+
+    int subpixelSteps() const { return m_steps; }
+    // 返回的引用在缓存对象生命周期内有效
+    const Profile& profile(double sigmaPx);
+    // 相对像素中心的偏移 [-0.5, 0.5) → 最近的相位下标；舍入到 +0.5 时 carry 置 1，取下一像素的 0 相位
+    int phaseIndex(double offset, int* carry) const;
+    size_t size() const { return m_profiles.size(); }
+
+private:
+    int m_steps;
+    double m_radiusSigma;
+    int m_sigmaQuant;
+    std::unordered_map<int, std::unique_ptr<Profile>> m_profiles;
+};
+
+// 一颗星的落点：flux 为总电子数
+struct StarStamp {
+    double x{0.0};          ///< 像素中心坐标（0 为第一个像素的中心）
+    double y{0.0};
+    double flux{0.0};
+    double sigmaPx{1.5};
+};
+
+// 峰值 ADU（增益 1 e/ADU 时）换算成高斯总通量
+double fluxFromPeak(double peak, double sigmaPx);
+// 高斯 PSF 的半通量半径：HFR = σ·√(2 ln 2)
+double sigmaFromHfr(double hfr);
+
+struct SkyRenderOptions {
+    int width{0};
+    int height{0};
+    double backgroundE{0.0};            ///< 每像素天光 + 暗流（电子）
+    double vignette{0.0};               ///< 暗角：背景在对角处乘 (1 - vignette)，按到中心的距离线性过渡
+    bool poisson{true};                 ///< 光子散粒噪声
+    double readNoiseE{0.0};             ///< 读出噪声（电子，高斯）
+    double gainEPerAdu{1.0};
+    double biasAdu{0.0};
+    double saturationAdu{65535.0};
+    uint64_t seed{0};
+    uint64_t frameIndex{0};             ///< 同一种子下逐帧递增，得到不同但可复现的噪声
+    int threads{0};                     ///< 0 = 硬件线程数
+    int bandRows{64};                   ///< 每个行带的行数（线程按行带领取任务）
+};
+
+// 合成星空渲染器：落星（子像素核缓存）→ 背景/暗角 → 泊松 + 读出噪声 → 16 位量化。
+// 按行带多线程：星点先按覆盖的行带分桶，各线程领取行带、在自己的浮点行缓冲里累加后直接写输出，
+// 互不重叠，不需要加锁。同一对象不要并发调用 render。
+class SkyRenderer
+{
+public:
+    explicit SkyRenderer(int subpixelSteps = 16, double radiusSigma = 4.0);
+
+    // out 为 height 行、每行 strideElems 个 uint16（0 表示紧密排列，等于 width）
+    void render(const SkyRenderOptions& options, const std::vector<StarStamp>& stars,
+                uint16_t* out, size_t strideElems = 0);
+
+    // 只落星和背景（电子数，无噪声、无量化、无饱和截断），供需要自定色调曲线的调用方
+    void renderElectrons(const SkyRenderOptions& options, const std::vector<StarStamp>& stars, float* out);
+
+    PsfKernelCache& kernels() { return m_cache; }
+
+private:
+    struct Prepared {
+        const PsfKernelCache::Profile* profile{nullptr};
+        int cx{0};
+        int cy{0};
+        int phaseX{0};
+        int phaseY{0};
+        float flux{0.0f};
+    };
+
+    void prepare(const SkyRenderOptions& options, const std::vector<StarStamp>& stars);
+    void renderBand(const SkyRenderOptions& options, int band, float* rows) const;
+    template <typename Fn>
+    void forEachBand(const SkyRenderOptions& options, Fn&& fn);
+
+    PsfKernelCache m_cache;
+    std::vector<Prepared> m_prepared;
+    std::vector<std::vector<uint32_t>> m_bandStars;   ///< 行带 → 覆盖它的星（m_prepared 下标）
+};
+
+} // namespace sim
@@ -0,0 +1,554 @@
+#include "VirtualRig.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+
+namespace sim {
+
+namespace {
+
+constexpr double kAmbientC = 20.0;
+constexpr double kCoolerDeltaMaxC = 40.0;    ///< 制冷最大温差
+constexpr double kCoolerTauMs = 60000.0;
+constexpr double kSkyEPerSec = 25.0;         ///< L 滤镜下每像素天光（电子/秒，未 Bin）
+constexpr double kDarkEPerSec = 0.5;
+constexpr double kReadNoiseE = 3.0;
+constexpr double kGuiderHfrPx = 1.8;         ///< 不随电调的相机固定星像大小
+constexpr double kSeeingJitterPx = 0.25;     ///< 逐帧整体抖动（视宁度 + 跟踪误差）
+
+double clampd(double v, double lo, double hi)
+{
+    return std::max(lo, std::min(hi, v));
+}
+
+} // namespace
+
+ClockMs steadyClockMs()
+{
+    const auto t0 = std::chrono::steady_clock::now();
+    return [t0]() {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    };
+}
+
+// ---------------- VirtualFocuser ----------------
+
+VirtualFocuser::VirtualFocuser(const Params& params, ClockMs clock)
+    : m_params(params), m_clock(std::move(clock)),
+      m_from(params.startPosition), m_target(params.startPosition),
+      m_stepsPerSec(params.stepsPerSec)
+{
+}
+
+int VirtualFocuser::positionLocked(double now) const
+{
+    if (m_from == m_target)
+        return m_target;
+    const double travelled = std::max(0.0, now - m_startMs) * m_stepsPerSec / 1000.0;
+    const int distance = std::abs(m_target - m_from);
+    if (travelled >= distance)
+        return m_target;
+    const int moved = static_cast<int>(travelled);
+    return m_target > m_from ? m_from + moved : m_from - moved;
+}
+
+int VirtualFocuser::position() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return positionLocked(m_clock());
+}
+
+bool VirtualFocuser::moving() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return positionLocked(m_clock()) != m_target;
+}
+
+void VirtualFocuser::moveTo(int target)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const double now = m_clock();
+    m_from = positionLocked(now);
+    m_target = target;
+    m_startMs = now;
+    m_stepsPerSec = m_params.stepsPerSec / (1 + m_speed);
+}
+
+void VirtualFocuser::moveBy(int delta)
+{
+    int from = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        from = positionLocked(m_clock());
+        if (m_reverse)
+            delta = -delta;
+    }
+    moveTo(from + delta);
+}
+
+void VirtualFocuser::abort()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_from = m_target = positionLocked(m_clock());
+}
+
+void VirtualFocuser::sync(int position)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_from = m_target = position;
+}
+
+void VirtualFocuser::setSpeed(int speed)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_speed = std::max(0, std::min(8, speed));
+}
+
+int VirtualFocuser::speed() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_speed;
+}
+
+void VirtualFocuser::setReverse(bool reverse)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_reverse = reverse;
+}
+
+bool VirtualFocuser::reversed() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_reverse;
+}
+
+double VirtualFocuser::hfrAt(int position) const
+{
+    const double defocus = m_params.hfrPxPerStep * (position - m_params.bestPosition);
+    return std::sqrt(m_params.hfrMinPx * m_params.hfrMinPx + defocus * defocus);
+}
+
+// ---------------- VirtualFilterWheel ----------------
+
+VirtualFilterWheel::VirtualFilterWheel(int slots, double msPerSlot, ClockMs clock)
+    : m_slots(std::max(1, slots)), m_msPerSlot(msPerSlot), m_clock(std::move(clock))
+{
+}
+
+int VirtualFilterWheel::position() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_clock() < m_arriveMs ? -1 : m_position;
+}
+
+bool VirtualFilterWheel::moving() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_clock() < m_arriveMs;
+}
+
+bool VirtualFilterWheel::setPosition(int position)
+{
+    if (position < 0 || position >= m_slots)
+        return false;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    // 轮子只朝一个方向转（与 QHY CFW 一致）：从当前目标槽位顺序转到新槽位
+    const int slots = (position - m_position + m_slots) % m_slots;
+    const double now = m_clock();
+    m_arriveMs = std::max(now, m_arriveMs) + slots * m_msPerSlot;
+    m_position = position;
+    return true;
+}
+
+double VirtualFilterWheel::throughput(int position) const
+{
+    static const double kThroughput[] = {1.0, 0.32, 0.36, 0.30, 0.05, 0.06, 0.04};
+    if (position >= 0 && position < static_cast<int>(sizeof(kThroughput) / sizeof(kThroughput[0])))
+        return kThroughput[position];
+    return 1.0;
+}
+
+// ---------------- VirtualCamera ----------------
+
+VirtualCamera::VirtualCamera(const VirtualCameraSpec& spec, ClockMs clock,
+                             const VirtualFocuser* focuser, const VirtualFilterWheel* wheel)
+    : m_spec(spec), m_clock(std::move(clock)), m_focuser(focuser), m_wheel(wheel),
+      m_roiW(spec.width), m_roiH(spec.height)
+{
+    // 星场只在构造时生成一次：亮度按幂律分布（少数亮星 + 大量暗星），整个会话位置固定，
+    // 导星和跟踪看到的是同一片天
+    CounterRng rng(CounterRng::mix(spec.seed, 0x5EEDF1E1DULL));
+    m_field.reserve(static_cast<size_t>(std::max(0, spec.starCount)));
+    for (int i = 0; i < spec.starCount; ++i) {
+        Field f;
+        f.x = rng.uniform() * spec.width - 0.5;
+        f.y = rng.uniform() * spec.height - 0.5;
+        f.ePerSec = 150.0 + 2.0e5 * std::pow(rng.uniform(), 6.0);
+        m_field.push_back(f);
+    }
+    m_temperatureAtMs = m_clock();
+}
+
+void VirtualCamera::setExposureUs(double us)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_exposureUs = std::max(0.0, us);
+}
+
+double VirtualCamera::exposureUs() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_exposureUs;
+}
+
+void VirtualCamera::setGain(double gain)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_gain = gain;
+}
+
+double VirtualCamera::gain() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_gain;
+}
+
+void VirtualCamera::setOffset(double offset)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_offset = offset;
+}
+
+double VirtualCamera::offset() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_offset;
+}
+
+bool VirtualCamera::setRoi(int x, int y, int w, int h)
+{
+    if (x < 0 || y < 0 || w <= 0 || h <= 0 || x + w > m_spec.width || y + h > m_spec.height)
+        return false;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_roiX = x;
+    m_roiY = y;
+    m_roiW = w;
+    m_roiH = h;
+    return true;
+}
+
+bool VirtualCamera::setBin(int bx, int by)
+{
+    if (bx < 1 || bx > 4 || by < 1 || by > 4)
+        return false;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_binX = bx;
+    m_binY = by;
+    return true;
+}
+
+int VirtualCamera::outputWidth() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_roiW / m_binX;
+}
+
+int VirtualCamera::outputHeight() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_roiH / m_binY;
+}
+
+double VirtualCamera::readoutMs() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const double pixels = static_cast<double>(m_roiW / m_binX) * (m_roiH / m_binY);
+    return pixels / (m_spec.readoutMpxPerSec * 1000.0);
+}
+
+void VirtualCamera::startExposure()
+{
+    const double readout = readoutMs();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_exposing = true;
+    m_exposureEndMs = m_clock() + m_exposureUs / 1000.0 + readout;
+}
+
+bool VirtualCamera::exposing() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_exposing;
+}
+
+double VirtualCamera::remainingMs() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_exposing ? std::max(0.0, m_exposureEndMs - m_clock()) : 0.0;
+}
+
+void VirtualCamera::cancelExposure()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_exposing = false;
+}
+
+bool VirtualCamera::readSingleFrame(uint16_t* out, Frame* frame)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_exposing || m_clock() < m_exposureEndMs)
+            return false;
+        m_exposing = false;
+    }
+    render(out, frame);
+    return true;
+}
+
+void VirtualCamera::beginLive()
+{
+    const double readout = readoutMs();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_live = true;
+    m_nextLiveMs = m_clock() + std::max(m_exposureUs / 1000.0, readout);
+}
+
+void VirtualCamera::stopLive()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_live = false;
+}
+
+bool VirtualCamera::live() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_live;
+}
+
+bool VirtualCamera::readLiveFrame(uint16_t* out, Frame* frame)
+{
+    const double readout = readoutMs();
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const double now = m_clock();
+        if (!m_live || now < m_nextLiveMs)
+            return false;
+        // 取帧慢于节拍时不补发积压的帧：相机只保留最新一帧，下一拍从现在算起
+        const double period = std::max(m_exposureUs / 1000.0, readout);
+        m_nextLiveMs += period;
+        if (m_nextLiveMs < now)
+            m_nextLiveMs = now + period;
+    }
+    render(out, frame);
+    return true;
+}
+
+void VirtualCamera::updateTemperatureLocked(double now) const
+{
+    const double target = std::max(m_coolerTarget, kAmbientC - kCoolerDeltaMaxC);
+    const double dt = std::max(0.0, now - m_temperatureAtMs);
+    m_temperature += (target - m_temperature) * (1.0 - std::exp(-dt / kCoolerTauMs));
+    m_temperatureAtMs = now;
+}
+
+void VirtualCamera::setCoolerTarget(double celsius)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    updateTemperatureLocked(m_clock());
+    m_coolerTarget = celsius;
+}
+
+double VirtualCamera::coolerTarget() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_coolerTarget;
+}
+
+double VirtualCamera::temperatureC() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    updateTemperatureLocked(m_clock());
+    return m_temperature;
+}
+
+double VirtualCamera::coolerPowerPercent() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    updateTemperatureLocked(m_clock());
+    return clampd((kAmbientC - m_temperature) * 100.0 / kCoolerDeltaMaxC, 0.0, 100.0);
+}
+
+uint64_t VirtualCamera::framesRendered() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_frameIndex;
+}
+
+void VirtualCamera::render(uint16_t* out, Frame* frame)
+{
+    // 锁内只取参数快照，渲染在锁外（渲染器自己一把锁），不挡住查询剩余时间/温度的调用
+    SkyRenderOptions options;
+    int roiX = 0, roiY = 0, binX = 1, binY = 1;
+    double exposureSec = 0.0;
+    uint64_t index = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        roiX = m_roiX;
+        roiY = m_roiY;
+        binX = m_binX;
+        binY = m_binY;
+        options.width = m_roiW / m_binX;
+        options.height = m_roiH / m_binY;
+        exposureSec = m_exposureUs / 1e6;
+        // 增益每 100 档 e/ADU 缩小 10 倍；偏置每档 4 ADU
+        options.gainEPerAdu = std::pow(10.0, -m_gain / 100.0);
+        options.biasAdu = 20.0 + 4.0 * m_offset;
+        index = ++m_frameIndex;
+    }
+
+    const double throughput = m_wheel ? m_wheel->throughput(std::max(0, m_wheel->position())) : 1.0;
+    const double hfr = m_focuser ? m_focuser->hfrNow() : kGuiderHfrPx;
+    const double sigma = sigmaFromHfr(hfr) / binX;
+
+    CounterRng jitter(CounterRng::mix(m_spec.seed, index));
+    double dx = 0.0, dy = 0.0;
+    jitter.normalPair(&dx, &dy);
+    dx *= kSeeingJitterPx;
+    dy *= kSeeingJitterPx;
+
+    std::vector<StarStamp> stars;
+    stars.reserve(m_field.size());
+    const double margin = 6.0 * sigma;
+    for (const Field& f : m_field) {
+        StarStamp s;
+        // 未 Bin 像素中心坐标 → Bin 后像素中心坐标
+        s.x = (f.x + dx - roiX + 0.5) / binX - 0.5;
+        s.y = (f.y + dy - roiY + 0.5) / binY - 0.5;
+        if (s.x < -margin || s.y < -margin || s.x > options.width + margin || s.y > options.height + margin)
+            continue;
+        s.flux = f.ePerSec * exposureSec * throughput;
+        s.sigmaPx = sigma;
+        stars.push_back(s);
+    }
+
+    options.backgroundE = (kSkyEPerSec * throughput + kDarkEPerSec) * exposureSec * binX * binY;
+    options.vignette = 0.15;
+    options.poisson = true;
+    options.readNoiseE = kReadNoiseE;
+    options.seed = m_spec.seed;
+    options.frameIndex = index;
+
+    {
+        std::lock_guard<std::mutex> lock(m_renderMutex);
+        m_renderer.render(options, stars, out);
+    }
+    if (frame) {
+        frame->width = options.width;
+        frame->height = options.height;
+        frame->index = index;
+    }
+}
+
+// ---------------- VirtualRig ----------------
+
+bool parseFrameSize(const std::string& text, int* width, int* height)
+{
+    const size_t sep = text.find_first_of("xX");
+    if (sep == std::string::npos || sep == 0 || sep + 1 >= text.size())
+        return false;
+    char* end = nullptr;
+    const long w = std::strtol(text.c_str(), &end, 10);
+    if (end != text.c_str() + sep)
+        return false;
+    const long h = std::strtol(text.c_str() + sep + 1, &end, 10);
+    if (*end != '\0' || w <= 0 || h <= 0 || w > 65535 || h > 65535)
+        return false;
+    *width = static_cast<int>(w);
+    *height = static_cast<int>(h);
+    return true;
+}
+
+VirtualRigConfig VirtualRigConfig::defaults()
+{
+    VirtualRigConfig config;
+
+    VirtualCameraSpec main;
+    main.id = "QHY268M-SIM0001";
+    main.width = 6280;
+    main.height = 4210;
+    main.pixelUm = 3.76;
+    main.filterWheel = true;
+    main.followsFocuser = true;
+    main.starCount = 600;
+    main.readoutMpxPerSec = 120.0;
+    main.seed = 1;
+    config.cameras.push_back(main);
+
+    VirtualCameraSpec guider;
+    guider.id = "QHY5III178M-SIM0002";
+    guider.width = 3072;
+    guider.height = 2048;
+    guider.pixelUm = 2.4;
+    guider.starCount = 120;
+    guider.readoutMpxPerSec = 150.0;
+    guider.seed = 2;
+    config.cameras.push_back(guider);
+    return config;
+}
+
+VirtualRigConfig VirtualRigConfig::fromEnvironment()
+{
+    VirtualRigConfig config = defaults();
+    int w = 0, h = 0;
+    if (const char* v = std::getenv("QUARCS_VO_MAIN_SIZE"); v && parseFrameSize(v, &w, &h)) {
+        config.cameras[0].width = w;
+        config.cameras[0].height = h;
+    }
+    if (const char* v = std::getenv("QUARCS_VO_GUIDER_SIZE"); v && parseFrameSize(v, &w, &h)) {
+        config.cameras[1].width = w;
+        config.cameras[1].height = h;
+    }
+    if (const char* v = std::getenv("QUARCS_VO_SEED"); v && *v) {
+        const uint64_t seed = std::strtoull(v, nullptr, 10);
+        for (size_t i = 0; i < config.cameras.size(); ++i)
+            config.cameras[i].seed = CounterRng::mix(seed, i);
+    }
+    if (const char* v = std::getenv("QUARCS_VO_BEST_FOCUS"); v && *v)
+        config.focuser.bestPosition = std::atoi(v);
+    return config;
+}
+
+VirtualRig::VirtualRig(const VirtualRigConfig& config, ClockMs clock)
+    : m_focuser(config.focuser, clock),
+      m_wheel(config.filterSlots, config.filterMsPerSlot, clock)
+{
+    for (const VirtualCameraSpec& spec : config.cameras) {
+        m_cameras.push_back(std::make_unique<VirtualCamera>(
+            spec, clock,
+            spec.followsFocuser ? &m_focuser : nullptr,
+            spec.filterWheel ? &m_wheel : nullptr));
+    }
+}
+
+VirtualRig& VirtualRig::instance()
+{
+    static VirtualRig rig(VirtualRigConfig::fromEnvironment());
+    return rig;
+}
+
+VirtualCamera* VirtualRig::camera(size_t index)
+{
+    return index < m_cameras.size() ? m_cameras[index].get() : nullptr;
+}
+
+VirtualCamera* VirtualRig::cameraById(const std::string& id)
+{
+    for (auto& camera : m_cameras) {
+        if (camera->spec().id == id)
+            return camera.get();
+    }
+    return nullptr;
+}
+
+} // namespace sim
@@ -0,0 +1,231 @@
+#pragma once
+
+#include "SkyRenderer.h"
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace sim {
+
+// 虚拟天文台的“硬件”：相机（含制冷）、滤镜轮、电调。
+// 只描述设备行为（曝光/读出耗时、移动速度、到位判定、焦点与星像大小的关系），不关心 SDK 协议；
+// sdks/sim 下的驱动把 QHY 命令翻译成这里的调用。时间全部取自注入的单调时钟，测试可以用假时钟快进。
+
+using ClockMs = std::function<double()>;   ///< 单调时钟（毫秒）
+
+ClockMs steadyClockMs();
+
+// 电调：匀速移动，位置按时间插值；焦点附近星像 HFR 呈 V 曲线
+class VirtualFocuser
+{
+public:
+    struct Params {
+        double stepsPerSec{2000.0};     ///< 速度档 0（最快）时的移动速度
+        int startPosition{28500};       ///< 上电位置（故意离焦，给自动对焦留活）
+        int bestPosition{30000};        ///< 最佳焦点
+        double hfrMinPx{1.6};           ///< 焦点处 HFR
+        double hfrPxPerStep{0.0015};    ///< 离焦 1 步 HFR 增加量（V 曲线渐近斜率）
+        double temperatureC{12.5};
+    };
+
+    VirtualFocuser(const Params& params, ClockMs clock);
+
+    int position() const;               ///< 当前位置（移动中按时间插值）
+    bool moving() const;
+    void moveTo(int target);
+    void moveBy(int delta);             ///< 正数向外；反向开启时方向取反
+    void abort();                       ///< 停在当前插值位置
+    void sync(int position);            ///< 不移动，只改写当前位置读数
+
+    void setSpeed(int speed);           ///< 0..8，0 最快；速度 = stepsPerSec / (1 + speed)
+    int speed() const;
+    void setReverse(bool reverse);
+    bool reversed() const;
+
+    // HFR(pos) = sqrt(hfrMin² + (slope·(pos - best))²)
+    double hfrAt(int position) const;
+    double hfrNow() const { return hfrAt(position()); }
+    double temperatureC() const { return m_params.temperatureC; }
+    const Params& params() const { return m_params; }
+
+private:
+    int positionLocked(double now) const;
+
+    Params m_params;
+    ClockMs m_clock;
+    mutable std::mutex m_mutex;
+    int m_from{0};
+    int m_target{0};
+    double m_startMs{0.0};
+    double m_stepsPerSec{2000.0};
+    int m_speed{0};
+    bool m_reverse{false};
+};
+
+// 滤镜轮：转一格固定耗时，转动中读不到位置（与 QHY CFW 转动中不回报槽位一致）
+class VirtualFilterWheel
+{
+public:
+    VirtualFilterWheel(int slots, double msPerSlot, ClockMs clock);
+
+    int slots() const { return m_slots; }
+    int position() const;               ///< 0 开始；转动中返回 -1
+    bool moving() const;
+    bool setPosition(int position);     ///< 越界返回 false，位置不变
+    // 槽位透过率（相对 L 的通量比例）：L, R, G, B, Ha, OIII, SII, 其余为 1
+    double throughput(int position) const;
+
+private:
+    int m_slots;
+    double m_msPerSlot;
+    ClockMs m_clock;
+    mutable std::mutex m_mutex;
+    int m_position{0};
+    double m_arriveMs{0.0};
+};
+
+struct VirtualCameraSpec {
+    std::string id;                     ///< 相机 ID（与 QHY SDK 的 "型号-序列号" 形式一致）
+    int width{0};
+    int height{0};
+    double pixelUm{3.76};
+    bool filterWheel{false};            ///< 是否带滤镜轮（相机直连 CFW）
+    bool followsFocuser{false};         ///< 星像大小是否随电调位置变化（主相机为 true）
+    int starCount{400};
+    double readoutMpxPerSec{100.0};     ///< 读出速度：决定单帧读出时间与 Live 帧间隔下限
+    uint64_t seed{1};
+};
+
+// 相机：单帧曝光/读出计时、Live 节拍、ROI/Bin、增益/偏置、制冷，帧由 SkyRenderer 渲染。
+// 同一相机的调用可来自不同线程（SDK 执行线程与取消曝光），内部加锁；渲染在锁外进行。
+class VirtualCamera
+{
+public:
+    struct Frame {
+        int width{0};
+        int height{0};
+        uint64_t index{0};              ///< 本相机第几帧（从 1 开始）
+    };
+
+    VirtualCamera(const VirtualCameraSpec& spec, ClockMs clock,
+                  const VirtualFocuser* focuser, const VirtualFilterWheel* wheel);
+
+    const VirtualCameraSpec& spec() const { return m_spec; }
+    const VirtualFilterWheel* filterWheel() const { return m_wheel; }
+
+    void setExposureUs(double us);
+    double exposureUs() const;
+    void setGain(double gain);
+    double gain() const;
+    void setOffset(double offset);
+    double offset() const;
+    bool setRoi(int x, int y, int w, int h);   ///< 以未 Bin 像素计，越界返回 false
+    bool setBin(int bx, int by);               ///< 1..4
+    int outputWidth() const;
+    int outputHeight() const;
+    size_t frameBytes() const { return static_cast<size_t>(outputWidth()) * outputHeight() * sizeof(uint16_t); }
+
+    // 单帧：开始曝光后 exposure + 读出时间内 remainingMs() > 0
+    void startExposure();
+    bool exposing() const;
+    double remainingMs() const;
+    void cancelExposure();
+    // 读出单帧：曝光未开始或未结束返回 false；out 至少 frameBytes() 字节
+    bool readSingleFrame(uint16_t* out, Frame* frame);
+
+    // Live：按 max(曝光, 读出) 的节拍出帧，节拍未到返回 false
+    void beginLive();
+    void stopLive();
+    bool live() const;
+    bool readLiveFrame(uint16_t* out, Frame* frame);
+
+    // 制冷：温度以 60s 时间常数趋近目标（不低于环境温度 - 40），功率与温差成正比
+    void setCoolerTarget(double celsius);
+    double coolerTarget() const;
+    double temperatureC() const;
+    double coolerPowerPercent() const;
+
+    double readoutMs() const;
+    uint64_t framesRendered() const;
+
+private:
+    struct Field {
+        double x;                       ///< 全幅未 Bin 像素坐标
+        double y;
+        double ePerSec;                 ///< L 滤镜下每秒电子数
+    };
+
+    void render(uint16_t* out, Frame* frame);
+    void updateTemperatureLocked(double now) const;
+
+    VirtualCameraSpec m_spec;
+    ClockMs m_clock;
+    const VirtualFocuser* m_focuser;
+    const VirtualFilterWheel* m_wheel;
+    std::vector<Field> m_field;
+
+    mutable std::mutex m_mutex;
+    double m_exposureUs{1e6};
+    double m_gain{0.0};
+    double m_offset{10.0};
+    int m_roiX{0};
+    int m_roiY{0};
+    int m_roiW{0};
+    int m_roiH{0};
+    int m_binX{1};
+    int m_binY{1};
+    bool m_exposing{false};
+    double m_exposureEndMs{0.0};
+    bool m_live{false};
+    double m_nextLiveMs{0.0};
+    uint64_t m_frameIndex{0};
+
+    double m_coolerTarget{20.0};
+    mutable double m_temperature{20.0};
+    mutable double m_temperatureAtMs{0.0};
+
+    std::mutex m_renderMutex;           ///< SkyRenderer 不可并发使用
+    SkyRenderer m_renderer;
+};
+
+struct VirtualRigConfig {
+    std::vector<VirtualCameraSpec> cameras;
+    int filterSlots{7};
+    double filterMsPerSlot{400.0};
+    VirtualFocuser::Params focuser;
+
+    // 主相机 QHY268M（带 7 位滤镜轮、随电调对焦）+ 导星相机 QHY5III178M
+    static VirtualRigConfig defaults();
+    // 在默认值上叠加环境变量：
+    // QUARCS_VO_MAIN_SIZE=宽x高、QUARCS_VO_GUIDER_SIZE=宽x高、QUARCS_VO_SEED=种子、QUARCS_VO_BEST_FOCUS=步数
+    static VirtualRigConfig fromEnvironment();
+};
+
+// "3200x2136" → (3200, 2136)；格式不对返回 false
+bool parseFrameSize(const std::string& text, int* width, int* height);
+
+class VirtualRig
+{
+public:
+    explicit VirtualRig(const VirtualRigConfig& config, ClockMs clock = steadyClockMs());
+
+    // 进程内共享的虚拟设备（首次调用时按环境变量配置），相机驱动和电调驱动都从这里取设备
+    static VirtualRig& instance();
+
+    size_t cameraCount() const { return m_cameras.size(); }
+    VirtualCamera* camera(size_t index);
+    VirtualCamera* cameraById(const std::string& id);
+    VirtualFocuser& focuser() { return m_focuser; }
+    VirtualFilterWheel& filterWheel() { return m_wheel; }
+
+private:
+    VirtualFocuser m_focuser;
+    VirtualFilterWheel m_wheel;
+    std::vector<std::unique_ptr<VirtualCamera>> m_cameras;
+};
+
+} // namespace sim
@@ -0,0 +1,263 @@
+#include "BatchAstrometry.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace solver {
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+constexpr double kDeg = kPi / 180.0;
+constexpr double kArcsec = kDeg / 3600.0;
+constexpr double kJ2000 = 2451545.0;
+constexpr double kUnixEpochJd = 2440587.5;
+
+double wrap360(double deg)
+{
+    const double r = std::fmod(deg, 360.0);
+    return r < 0.0 ? r + 360.0 : r;
+}
+
+double clampUnit(double v)
+{
+    return std::max(-1.0, std::min(1.0, v));
+}
+
+void multiply(const double a[3][3], const double b[3][3], double out[3][3])
+{
+    double t[3][3];
+    for (int i = 0; i < 3; ++i) {
+        for (int j = 0; j < 3; ++j)
+            t[i][j] = a[i][0] * b[0][j] + a[i][1] * b[1][j] + a[i][2] * b[2][j];
+    }
+    for (int i = 0; i < 3; ++i) {
+        for (int j = 0; j < 3; ++j)
+            out[i][j] = t[i][j];
+    }
+}
+
+// 与 TanWcs 相同的切点基向量，批量投影时只算一次
+struct TanBasis {
+    double r[3];
+    double e[3];
+    double n[3];
+};
+
+TanBasis tanBasis(const TanWcs& wcs)
+{
+    TanBasis b;
+    const double ra = wcs.crval[0] * kDeg;
+    const double dec = wcs.crval[1] * kDeg;
+    b.r[0] = std::cos(dec) * std::cos(ra);
+    b.r[1] = std::cos(dec) * std::sin(ra);
+    b.r[2] = std::sin(dec);
+
+    double ex = -b.r[1];
+    double ey = b.r[0];
+    double norm = std::hypot(ex, ey);
+    if (norm < 1e-15) {
+        ex = 0.0;
+        ey = 1.0;
+        norm = 1.0;
+    }
+    b.e[0] = ex / norm;
+    b.e[1] = ey / norm;
+    b.e[2] = 0.0;
+    b.n[0] = b.r[1] * b.e[2] - b.r[2] * b.e[1];
+    b.n[1] = b.r[2] * b.e[0] - b.r[0] * b.e[2];
+    b.n[2] = b.r[0] * b.e[1] - b.r[1] * b.e[0];
+    return b;
+}
+
+} // namespace
+
+void precessionMatrix(double jd, double m[3][3])
+{
+    const double T = (jd - kJ2000) / 36525.0;
+    const double zeta = (2306.2181 * T + 0.30188 * T * T + 0.017998 * T * T * T) * kArcsec;
+    const double z = (2306.2181 * T + 1.09468 * T * T + 0.018203 * T * T * T) * kArcsec;
+    const double theta = (2004.3109 * T - 0.42665 * T * T - 0.041833 * T * T * T) * kArcsec;
+    const double cz = std::cos(zeta), sz = std::sin(zeta);
+    const double cZ = std::cos(z), sZ = std::sin(z);
+    const double ct = std::cos(theta), st = std::sin(theta);
+
+    m[0][0] = cz * cZ * ct - sz * sZ;
+    m[0][1] = -sz * cZ * ct - cz * sZ;
+    m[0][2] = -cZ * st;
+    m[1][0] = cz * sZ * ct + sz * cZ;
+    m[1][1] = -sz * sZ * ct + cz * cZ;
+    m[1][2] = -sZ * st;
+    m[2][0] = cz * st;
+    m[2][1] = -sz * st;
+    m[2][2] = ct;
+}
+
+void nutationMatrix(double jd, double m[3][3])
+{
+    // 章动主项（Meeus 22 章低精度式），精度约 0.5"，远小于导星/极轴校准用到的量级
+    const double T = (jd - kJ2000) / 36525.0;
+    const double omega = (125.04452 - 1934.136261 * T) * kDeg;
+    const double L = (280.4665 + 36000.7698 * T) * kDeg;
+    const double Lm = (218.3165 + 481267.8813 * T) * kDeg;
+    const double dpsi = (-17.20 * std::sin(omega) - 1.32 * std::sin(2 * L) - 0.23 * std::sin(2 * Lm) +
+                         0.21 * std::sin(2 * omega)) * kArcsec;
+    const double deps = (9.20 * std::cos(omega) + 0.57 * std::cos(2 * L) + 0.10 * std::cos(2 * Lm) -
+                         0.09 * std::cos(2 * omega)) * kArcsec;
+    const double eps = (23.439291 - 0.0130042 * T) * kDeg + deps;
+    const double ce = std::cos(eps), se = std::sin(eps);
+
+    // 一阶小角近似：N = Rx(-eps) Rz(-dpsi) Rx(eps0)
+    m[0][0] = 1.0;
+    m[0][1] = -dpsi * ce;
+    m[0][2] = -dpsi * se;
+    m[1][0] = dpsi * ce;
+    m[1][1] = 1.0;
+    m[1][2] = -deps;
+    m[2][0] = dpsi * se;
+    m[2][1] = deps;
+    m[2][2] = 1.0;
+}
+
+TimeContext TimeContext::at(double unixSec, double latitudeDeg, double longitudeDeg)
+{
+    TimeContext ctx;
+    ctx.unixSec = unixSec;
+    ctx.latitudeDeg = latitudeDeg;
+    ctx.longitudeDeg = longitudeDeg;
+    ctx.sinLat = std::sin(latitudeDeg * kDeg);
+    ctx.cosLat = std::cos(latitudeDeg * kDeg);
+
+    const double wholeSec = std::floor(unixSec);
+    ctx.jd = kUnixEpochJd + wholeSec / 86400.0;
+    ctx.daysSinceJ2000 = ctx.jd - kJ2000;
+
+    double secOfDay = std::fmod(unixSec, 86400.0);
+    if (secOfDay < 0.0)
+        secOfDay += 86400.0;
+    const double ut = secOfDay / 3600.0;
+    ctx.lstDeg = wrap360(100.46 + 0.985647 * ctx.daysSinceJ2000 + longitudeDeg + 15.0 * ut);
+
+    const double jdExact = kUnixEpochJd + unixSec / 86400.0;
+    const double T = (jdExact - kJ2000) / 36525.0;
+    ctx.gmstDeg = wrap360(280.46061837 + 360.98564736629 * (jdExact - kJ2000) + 0.000387933 * T * T -
+                          T * T * T / 38710000.0);
+
+    precessionMatrix(ctx.jd, ctx.precession);
+    nutationMatrix(ctx.jd, ctx.nutation);
+    multiply(ctx.nutation, ctx.precession, ctx.toDate);
+    return ctx;
+}
+
+void raDecToAltAz(const TimeContext& ctx, const double* raDeg, const double* decDeg, size_t n,
+                  double* altDeg, double* azDeg)
+{
+    const double sinLat = ctx.sinLat;
+    const double cosLat = ctx.cosLat;
+    const double lst = ctx.lstDeg;
+    for (size_t i = 0; i < n; ++i) {
+        const double h = (lst - raDeg[i]) * kDeg;
+        const double dec = decDeg[i] * kDeg;
+        const double sd = std::sin(dec), cd = std::cos(dec);
+        const double sh = std::sin(h), ch = std::cos(h);
+        const double sinAlt = sinLat * sd + cosLat * cd * ch;
+        const double az = std::atan2(-cd * sh, cosLat * sd - sinLat * cd * ch) / kDeg;
+        altDeg[i] = std::asin(clampUnit(sinAlt)) / kDeg;
+        azDeg[i] = az < 0.0 ? az + 360.0 : az;
+    }
+}
+
+void altAzToRaDec(const TimeContext& ctx, const double* altDeg, const double* azDeg, size_t n,
+                  double* raDeg, double* decDeg)
+{
+    const double sinLat = ctx.sinLat;
+    const double cosLat = ctx.cosLat;
+    const double lst = ctx.lstDeg;
+    for (size_t i = 0; i < n; ++i) {
+        const double alt = altDeg[i] * kDeg;
+        const double az = azDeg[i] * kDeg;
+        const double sa = std::sin(alt), ca = std::cos(alt);
+        const double sz = std::sin(az), cz = std::cos(az);
+        const double sinDec = sinLat * sa + cosLat * ca * cz;
+        const double h = std::atan2(-sz * ca, cosLat * sa - sinLat * ca * cz) / kDeg;
+        decDeg[i] = std::asin(clampUnit(sinDec)) / kDeg;
+        raDeg[i] = std::fmod(lst - h + 720.0, 360.0);
+    }
+}
+
+void precessToDate(const TimeContext& ctx, const double* raDeg, const double* decDeg, size_t n,
+                   double* raOut, double* decOut)
+{
+    const double (&m)[3][3] = ctx.toDate;
+    for (size_t i = 0; i < n; ++i) {
+        const double ra = raDeg[i] * kDeg;
+        const double dec = decDeg[i] * kDeg;
+        const double cd = std::cos(dec);
+        const double x = cd * std::cos(ra), y = cd * std::sin(ra), z = std::sin(dec);
+        const double px = m[0][0] * x + m[0][1] * y + m[0][2] * z;
+        const double py = m[1][0] * x + m[1][1] * y + m[1][2] * z;
+        const double pz = m[2][0] * x + m[2][1] * y + m[2][2] * z;
+        const double r = std::atan2(py, px) / kDeg;
+        raOut[i] = r < 0.0 ? r + 360.0 : r;
+        decOut[i] = std::asin(clampUnit(pz)) / kDeg;
+    }
+}
+
+void skyToPixel(const TanWcs& wcs, const double* raDeg, const double* decDeg, size_t n,
+                double* x, double* y, uint8_t* onFront)
+{
+    const TanBasis b = tanBasis(wcs);
+    const double det = wcs.cd[0][0] * wcs.cd[1][1] - wcs.cd[0][1] * wcs.cd[1][0];
+    const double invDet = det != 0.0 ? 1.0 / det : 0.0;
+    const double i00 = wcs.cd[1][1] * invDet, i01 = -wcs.cd[0][1] * invDet;
+    const double i10 = -wcs.cd[1][0] * invDet, i11 = wcs.cd[0][0] * invDet;
+    const bool usable = det != 0.0;
+    for (size_t i = 0; i < n; ++i) {
+        const double ra = raDeg[i] * kDeg;
+        const double dec = decDeg[i] * kDeg;
+        const double cd = std::cos(dec);
+        const double px = cd * std::cos(ra), py = cd * std::sin(ra), pz = std::sin(dec);
+        const double w = px * b.r[0] + py * b.r[1] + pz * b.r[2];
+        const bool front = usable && w > 0.0;
+        const double scale = front ? 1.0 / (w * kDeg) : 0.0;
+        const double u = (px * b.e[0] + py * b.e[1] + pz * b.e[2]) * scale;
+        const double v = (px * b.n[0] + py * b.n[1] + pz * b.n[2]) * scale;
+        x[i] = front ? wcs.crpix[0] + i00 * u + i01 * v : -1.0;
+        y[i] = front ? wcs.crpix[1] + i10 * u + i11 * v : -1.0;
+        onFront[i] = front ? 1 : 0;
+    }
+}
+
+void pixelToSky(const TanWcs& wcs, const double* x, const double* y, size_t n,
+                double* raDeg, double* decDeg)
+{
+    const TanBasis b = tanBasis(wcs);
+    for (size_t i = 0; i < n; ++i) {
+        const double dx = x[i] - wcs.crpix[0];
+        const double dy = y[i] - wcs.crpix[1];
+        const double u = (wcs.cd[0][0] * dx + wcs.cd[0][1] * dy) * kDeg;
+        const double v = (wcs.cd[1][0] * dx + wcs.cd[1][1] * dy) * kDeg;
+        const double p0 = b.r[0] + u * b.e[0] + v * b.n[0];
+        const double p1 = b.r[1] + u * b.e[1] + v * b.n[1];
+        const double p2 = b.r[2] + u * b.e[2] + v * b.n[2];
+        const double norm = std::sqrt(p0 * p0 + p1 * p1 + p2 * p2);
+        const double ra = std::atan2(p1, p0) / kDeg;
+        raDeg[i] = ra < 0.0 ? ra + 360.0 : ra;
+        decDeg[i] = std::asin(clampUnit(p2 / norm)) / kDeg;
+    }
+}
+
+void linearPixelToSky(const LinearWcs& wcs, const double* x, const double* y, size_t n,
+                      double* raDeg, double* decDeg)
+{
+    for (size_t i = 0; i < n; ++i) {
+        const double dx = x[i] - wcs.crpix[0];
+        const double dy = y[i] - wcs.crpix[1];
+        const double ra = wcs.crval[0] + wcs.cd[0][0] * dx + wcs.cd[0][1] * dy;
+        const double dec = wcs.crval[1] + wcs.cd[1][0] * dx + wcs.cd[1][1] * dy;
+        raDeg[i] = ra;
+        decDeg[i] = dec;
+    }
+}
+
+} // namespace solver
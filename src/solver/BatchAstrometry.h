@@ -0,0 +1,64 @@
+#pragma once
+
+#include "TanWcs.h"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace solver {
+
+// 一次观测时刻的预计算量：批量换算共用，不再逐点从 QDateTime 重算儒略日和恒星时
+// 恒星时与 Tools::getLST_Degree 同一公式（100.46 + 0.985647·d + 经度 + 15·UT），
+// 儒略日按整秒、UT 含毫秒，与 Tools 的 getJDFromDate 取整方式一致
+struct TimeContext {
+    double unixSec{0.0};
+    double jd{0.0};                 ///< 儒略日（整秒）
+    double daysSinceJ2000{0.0};     ///< jd - 2451545.0
+    double lstDeg{0.0};             ///< 地方恒星时 [0,360)
+    double gmstDeg{0.0};            ///< IAU 1982 格林尼治平恒星时 [0,360)（与 Tools::calculateGST 同式）
+    double latitudeDeg{0.0};
+    double longitudeDeg{0.0};
+    double sinLat{0.0};
+    double cosLat{1.0};
+    double precession[3][3]{{1, 0, 0}, {0, 1, 0}, {0, 0, 1}};   ///< J2000 → 当日平赤道（IAU 1976）
+    double nutation[3][3]{{1, 0, 0}, {0, 1, 0}, {0, 0, 1}};     ///< 当日平赤道 → 真赤道（主项，~0.5"）
+    double toDate[3][3]{{1, 0, 0}, {0, 1, 0}, {0, 0, 1}};       ///< nutation · precession
+
+    static TimeContext at(double unixSec, double latitudeDeg, double longitudeDeg);
+};
+
+// 以下批量函数输入输出都是结构数组（SoA）、单位为度；循环体内无分支、无分配，
+// 同一个 TimeContext / TanWcs 的三角函数只算一次。输出数组可与输入数组相同。
+
+// 赤道（当日 RA/DEC）→ 地平。方位角从北向东 [0,360)，与 Tools::ra_dec_to_alt_az 约定相同；
+// 用 atan2 代替 acos + 象限判断，天顶附近不再失去精度
+void raDecToAltAz(const TimeContext& ctx, const double* raDeg, const double* decDeg, size_t n,
+                  double* altDeg, double* azDeg);
+// 地平 → 赤道（当日 RA/DEC），RA [0,360)
+void altAzToRaDec(const TimeContext& ctx, const double* altDeg, const double* azDeg, size_t n,
+                  double* raDeg, double* decDeg);
+// J2000 → 当日真赤道（岁差 + 章动主项），RA [0,360)
+void precessToDate(const TimeContext& ctx, const double* raDeg, const double* decDeg, size_t n,
+                   double* raOut, double* decOut);
+
+// TAN 投影批量版，结果与 TanWcs::skyToPixel / pixelToSky 一致（切点基向量只算一次）。
+// onFront[i] = 0 表示该点在切平面背面，对应 x/y 置为 -1
+void skyToPixel(const TanWcs& wcs, const double* raDeg, const double* decDeg, size_t n,
+                double* x, double* y, uint8_t* onFront);
+void pixelToSky(const TanWcs& wcs, const double* x, const double* y, size_t n,
+                double* raDeg, double* decDeg);
+
+// Tools::pixelToRaDec 的线性近似（RA/DEC 直接线性于像素偏移）批量版
+struct LinearWcs {
+    double crpix[2]{0.0, 0.0};
+    double crval[2]{0.0, 0.0};
+    double cd[2][2]{{0.0, 0.0}, {0.0, 0.0}};
+};
+void linearPixelToSky(const LinearWcs& wcs, const double* x, const double* y, size_t n,
+                      double* raDeg, double* decDeg);
+
+// 单独给出矩阵，便于检查和复用
+void precessionMatrix(double jd, double m[3][3]);
+void nutationMatrix(double jd, double m[3][3]);
+
+} // namespace solver
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdio>
+#include <string>
+
+namespace solver {
+
+// 手写 FITS 头用的小工具（.wcs / .xyls 共用），只覆盖固定格式卡片
+namespace fits {
+
+// 数值右对齐到第 30 列，字符串从第 11 列的引号开始左对齐
+inline std::string card(const char* key, const std::string& value, const char* comment = nullptr)
+{
+    char buf[81];
+    const char* fmt = (!value.empty() && value[0] == '\'') ? "%-8.8s= %-20s%s%s" : "%-8.8s= %20s%s%s";
+    std::snprintf(buf, sizeof(buf), fmt, key, value.c_str(), comment ? " / " : "", comment ? comment : "");
+    std::string s(buf);
+    s.resize(80, ' ');
+    return s;
+}
+
+inline std::string number(double v)
+{
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%.15G", v);
+    std::string s(buf);
+    if (s.find_first_of(".E") == std::string::npos)
+        s += ".";
+    return s;
+}
+
+inline std::string quoted(const char* v)
+{
+    char buf[72];
+    std::snprintf(buf, sizeof(buf), "'%-8s'", v);
+    return buf;
+}
+
+// 追加 END 并补齐到 2880 字节块
+inline void finishHeader(std::string& header)
+{
+    std::string end = "END";
+    end.resize(80, ' ');
+    header += end;
+    header.resize(((header.size() + 2879) / 2880) * 2880, ' ');
+}
+
+} // namespace fits
+} // namespace solver
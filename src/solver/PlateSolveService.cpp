@@ -0,0 +1,522 @@
+#include "PlateSolveService.h"
+
+#include "../Logger.h"
+#include "../sdks/SdkSerialExecutor.h"
+#include "../tools.h"
+
+#include <stellarsolver.h>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+namespace solver {
+
+namespace {
+
+int64_t nowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+double msSince(int64_t startNs)
+{
+    return (nowNs() - startNs) / 1e6;
+}
+
+bool isIndexFile(const char* name)
+{
+    const size_t n = std::strlen(name);
+    return std::strncmp(name, "index-", 6) == 0 && n > 5 && std::strcmp(name + n - 5, ".fits") == 0;
+}
+
+// index-4107.fits / index-5206-03.fits → 尺度 07 / 06；无法识别返回 -1
+int indexScale(const char* name)
+{
+    if (std::strncmp(name, "index-", 6) != 0)
+        return -1;
+    int number = 0;
+    for (int i = 0; i < 4; ++i) {
+        const char c = name[6 + i];
+        if (c < '0' || c > '9')
+            return -1;
+        number = number * 10 + (c - '0');
+    }
+    return number % 100;
+}
+
+// 尺度 n 的索引四边形直径约为 2·√2^n .. 2·√2^(n+1) 角分（astrometry.net 41xx/42xx/52xx 系列）
+bool indexScaleUseful(int scale, double fieldArcmin)
+{
+    if (fieldArcmin <= 0.0 || scale < 0)
+        return true;
+    const double lo = 2.0 * std::pow(2.0, scale * 0.5);
+    const double hi = lo * std::sqrt(2.0);
+    return hi >= fieldArcmin * 0.1 && lo <= fieldArcmin;
+}
+
+std::string wcsPathFor(const std::string& imagePath)
+{
+    const size_t slash = imagePath.find_last_of('/');
+    const size_t dot = imagePath.find_last_of('.');
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash))
+        return imagePath + ".wcs";
+    return imagePath.substr(0, dot) + ".wcs";
+}
+
+constexpr size_t kMaxFinishedResults = 32;
+
+} // namespace
+
+const char* solveStatusName(SolveStatus status)
+{
+    switch (status) {
+    case SolveStatus::Solved: return "solved";
+    case SolveStatus::Failed: return "failed";
+    case SolveStatus::Timeout: return "timeout";
+    case SolveStatus::Cancelled: return "cancelled";
+    case SolveStatus::Error: return "error";
+    }
+    return "unknown";
+}
+
+PlateSolveService& PlateSolveService::instance()
+{
+    static PlateSolveService service;
+    return service;
+}
+
+PlateSolveService::~PlateSolveService()
+{
+    stop();
+}
+
+bool PlateSolveService::start(const SolveServiceConfig& config)
+{
+    if (m_running.load())
+        return true;
+    m_config = config;
+    m_exec = std::make_unique<SdkSerialExecutor>(QStringLiteral("PlateSolveWorker"));
+    if (!m_exec->isRunning()) {
+        m_exec.reset();
+        Logger::Log("PlateSolveService | worker thread failed to start", LogLevel::ERROR, DeviceType::MAIN);
+        return false;
+    }
+    m_running.store(true);
+    // 预载放在求解线程里做：启动不阻塞主线程，第一次求解自然排在预载之后
+    m_exec->post([this]() { preloadIndexes(); });
+    return true;
+}
+
+void PlateSolveService::stop()
+{
+    if (!m_running.exchange(false))
+        return;
+    std::deque<Job> dropped;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        dropped.swap(m_queue);
+        m_activeCancelled = true;
+        if (m_activeSolver)
+            m_activeSolver->abort();
+    }
+    for (const auto& job : dropped) {
+        SolveResult r;
+        r.id = job.id;
+        r.imagePath = job.request.imagePath;
+        r.status = SolveStatus::Cancelled;
+        r.error = "service stopped";
+        finish(job, r);
+    }
+    m_exec.reset(); // 等待正在运行的求解结束
+    releaseIndexes();
+}
+
+uint64_t PlateSolveService::submit(SolveRequest request, Callback callback)
+{
+    if (!m_running.load())
+        return 0;
+    Job job;
+    job.request = std::move(request);
+    job.callback = std::move(callback);
+    job.submittedNs = nowNs();
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        job.id = m_nextId++;
+        m_queue.push_back(job);
+    }
+    m_exec->post([this]() { drainOne(); });
+    return job.id;
+}
+
+bool PlateSolveService::cancel(uint64_t id)
+{
+    Job removed;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_activeId == id) {
+            m_activeCancelled = true;
+            if (m_activeSolver)
+                m_activeSolver->abort();
+            return true;
+        }
+        auto it = std::find_if(m_queue.begin(), m_queue.end(), [id](const Job& j) { return j.id == id; });
+        if (it == m_queue.end())
+            return false;
+        removed = std::move(*it);
+        m_queue.erase(it);
+    }
+    SolveResult r;
+    r.id = removed.id;
+    r.imagePath = removed.request.imagePath;
+    r.status = SolveStatus::Cancelled;
+    r.timing.totalMs = r.timing.queueMs = msSince(removed.submittedNs);
+    finish(removed, r);
+    return true;
+}
+
+bool PlateSolveService::wait(uint64_t id, int timeoutMs, SolveResult* out)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    const bool done = m_cv.wait_for(lock, std::chrono::milliseconds(std::max(0, timeoutMs)),
+                                    [&] { return m_done.count(id) > 0; });
+    if (!done)
+        return false;
+    if (out)
+        *out = m_done[id];
+    m_done.erase(id);
+    return true;
+}
+
+SolveResult PlateSolveService::solve(const SolveRequest& request)
+{
+    SolveResult r;
+    r.imagePath = request.imagePath;
+    const uint64_t id = submit(request);
+    if (id == 0) {
+        r.error = "plate solve service not running";
+        return r;
+    }
+    r.id = id;
+    // 求解器自身有时限；这里多给一点余量覆盖读图与排队
+    if (!wait(id, request.timeoutMs + 3000, &r)) {
+        cancel(id);
+        if (!wait(id, 2000, &r)) {
+            r.status = SolveStatus::Timeout;
+            r.error = "no result after cancel";
+        } else if (r.status == SolveStatus::Cancelled) {
+            r.status = SolveStatus::Timeout;
+        }
+    }
+    return r;
+}
+
+bool PlateSolveService::lastSolved(const std::string& imagePath, SolveResult* out) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_lastByImage.find(imagePath);
+    if (it == m_lastByImage.end())
+        return false;
+    if (out)
+        *out = it->second;
+    return true;
+}
+
+void PlateSolveService::publish(const SolveResult& result)
+{
+    if (!result.solved() || result.imagePath.empty())
+        return;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_lastByImage[result.imagePath] = result;
+}
+
+void PlateSolveService::forget(const std::string& imagePath)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_lastByImage.erase(imagePath);
+}
+
+size_t PlateSolveService::pending() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_queue.size() + (m_activeId != 0 ? 1 : 0);
+}
+
+void PlateSolveService::drainOne()
+{
+    Job job;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_queue.empty())
+            return; // 已被取消
+        job = std::move(m_queue.front());
+        m_queue.pop_front();
+        m_activeId = job.id;
+        m_activeCancelled = false;
+    }
+
+    SolveResult r = runJob(job);
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_activeId = 0;
+        m_activeSolver = nullptr;
+    }
+    finish(job, r);
+}
+
+SolveResult PlateSolveService::runJob(const Job& job)
+{
+    const SolveRequest& req = job.request;
+    SolveResult r;
+    r.id = job.id;
+    r.imagePath = req.imagePath;
+    const int64_t startNs = nowNs();
+    r.timing.queueMs = (startNs - job.submittedNs) / 1e6;
+
+    // 同一路径重新解析：旧结果作废（图像文件已被新曝光覆盖）
+    forget(req.imagePath);
+
+    // 给了星表时只需要图像尺寸：不读 FITS，求解器跳过提取直接匹配
+    const bool fromStars = !req.stars.empty() && req.stars.imageWidth > 0 && req.stars.imageHeight > 0;
+    loadFitsResult image{false, FITSImage::Statistic(), nullptr};
+    if (fromStars) {
+        image.imageStats.width = req.stars.imageWidth;
+        image.imageStats.height = req.stars.imageHeight;
+        image.imageStats.channels = 1;
+        image.imageStats.dataType = TUSHORT;
+        image.imageStats.bytesPerPixel = 2;
+        image.imageStats.samples_per_channel = static_cast<uint32_t>(req.stars.imageWidth) * req.stars.imageHeight;
+    } else {
+        image = Tools::loadFits(QString::fromStdString(req.imagePath));
+        r.timing.loadMs = msSince(startNs);
+        if (!image.success || !image.imageBuffer) {
+            r.status = SolveStatus::Error;
+            r.error = "failed to load " + req.imagePath;
+            r.timing.totalMs = msSince(job.submittedNs);
+            return r;
+        }
+    }
+
+    const int64_t solveStartNs = nowNs();
+    bool ok = false;
+    FITSImage::Solution solution;
+    {
+        StellarSolver solver(SSolver::SOLVE, image.imageStats, image.imageBuffer);
+        solver.setProperty("ExtractorType", SSolver::EXTRACTOR_INTERNAL);
+        solver.setProperty("SolverType", SSolver::SOLVER_STELLARSOLVER);
+
+        SSolver::Parameters params;
+        params.multiAlgorithm = SSolver::MULTI_AUTO;
+        params.inParallel = true;
+        params.autoDownsample = true;
+        params.search_radius = req.radiusDeg > 0.0 ? req.radiusDeg : 2.0;
+        params.solverTimeLimit = std::max(1, static_cast<int>(std::ceil(req.timeoutMs / 1000.0)));
+        solver.setParameters(params);
+
+        QStringList folders;
+        for (const auto& f : m_config.indexFolders)
+            folders << QString::fromStdString(f);
+        solver.setIndexFolderPaths(folders);
+        if (!req.indexFiles.empty()) {
+            QStringList files;
+            for (const auto& f : resolveIndexFiles(req.indexFiles))
+                files << QString::fromStdString(f);
+            solver.setIndexFilePaths(files);
+        }
+        if (req.scaleLowDeg > 0.0 && req.scaleHighDeg > 0.0)
+            solver.setSearchScale(req.scaleLowDeg, req.scaleHighDeg, SSolver::DEG_WIDTH);
+        if (req.usePosition)
+            solver.setSearchPositionInDegrees(req.raDeg, req.decDeg);
+        solver.setLogLevel(SSolver::LOG_NONE);
+        solver.setSSLogLevel(SSolver::LOG_OFF);
+        if (fromStars) {
+            // 与内置提取器同一坐标约定（0 基像素）；按 flux 降序给出，匹配先用最亮的星
+            QList<FITSImage::Star> starList;
+            starList.reserve(static_cast<int>(req.stars.stars.size()));
+            for (const XyStar& s : req.stars.stars) {
+                FITSImage::Star star{};
+                star.x = static_cast<float>(s.x);
+                star.y = static_cast<float>(s.y);
+                star.flux = static_cast<float>(s.flux);
+                star.mag = static_cast<float>(s.flux > 0.0 ? -2.5 * std::log10(s.flux) : 0.0);
+                starList.append(star);
+            }
+            solver.setStarList(starList);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_activeCancelled) {
+                delete[] image.imageBuffer;
+                r.status = SolveStatus::Cancelled;
+                r.timing.totalMs = msSince(job.submittedNs);
+                return r;
+            }
+            m_activeSolver = &solver;
+        }
+        ok = solver.solve();
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_activeSolver = nullptr;
+        }
+        if (ok)
+            solution = solver.getSolution();
+    }
+    delete[] image.imageBuffer;
+    r.timing.solveMs = msSince(solveStartNs);
+
+    bool cancelled = false;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        cancelled = m_activeCancelled;
+    }
+    if (cancelled) {
+        r.status = SolveStatus::Cancelled;
+    } else if (!ok) {
+        r.status = r.timing.solveMs >= req.timeoutMs ? SolveStatus::Timeout : SolveStatus::Failed;
+        r.error = "no solution";
+    } else {
+        r.status = SolveStatus::Solved;
+        r.raDeg = solution.ra;
+        r.decDeg = solution.dec;
+        r.orientationDeg = solution.orientation;
+        r.pixelScaleArcsec = solution.pixscale;
+        r.mirrored = solution.parity == FITSImage::NEGATIVE;
+        r.wcs = TanWcs::fromSolution(solution.ra, solution.dec, solution.orientation, solution.pixscale, r.mirrored,
+                                     image.imageStats.width, image.imageStats.height);
+        if (req.writeWcs) {
+            const int64_t writeStartNs = nowNs();
+            r.wcsPath = wcsPathFor(req.imagePath);
+            std::string err;
+            if (!writeWcsFile(r.wcsPath, r.wcs, &err)) {
+                Logger::Log("PlateSolveService | " + err, LogLevel::WARNING, DeviceType::MAIN);
+                r.wcsPath.clear();
+            }
+            r.timing.writeMs = msSince(writeStartNs);
+        }
+    }
+    r.timing.totalMs = msSince(job.submittedNs);
+
+    Logger::Log("PlateSolveService | #" + std::to_string(r.id) + (req.tag.empty() ? "" : " [" + req.tag + "]") + " " +
+                    solveStatusName(r.status) + " " + req.imagePath +
+                    (fromStars ? " stars=" + std::to_string(req.stars.stars.size()) : std::string()) +
+                    (r.solved() ? " RA=" + std::to_string(r.raDeg) + " DEC=" + std::to_string(r.decDeg) +
+                                      " scale=" + std::to_string(r.pixelScaleArcsec) + "\"/px"
+                                : std::string()) +
+                    " | queue=" + std::to_string(static_cast<int>(r.timing.queueMs)) +
+                    " load=" + std::to_string(static_cast<int>(r.timing.loadMs)) +
+                    " solve=" + std::to_string(static_cast<int>(r.timing.solveMs)) +
+                    " write=" + std::to_string(static_cast<int>(r.timing.writeMs)) +
+                    " total=" + std::to_string(static_cast<int>(r.timing.totalMs)) + " ms",
+                r.solved() ? LogLevel::INFO : LogLevel::WARNING, DeviceType::MAIN);
+    return r;
+}
+
+void PlateSolveService::finish(const Job& job, const SolveResult& result)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (result.solved())
+            m_lastByImage[result.imagePath] = result;
+        m_done[result.id] = result;
+        // 没人 wait 的结果只保留最近几条
+        while (m_done.size() > kMaxFinishedResults)
+            m_done.erase(m_done.begin());
+    }
+    m_cv.notify_all();
+    if (job.callback)
+        job.callback(result);
+}
+
+std::vector<std::string> PlateSolveService::resolveIndexFiles(const std::vector<std::string>& names) const
+{
+    std::vector<std::string> out;
+    for (const auto& name : names) {
+        if (!name.empty() && name[0] == '/') {
+            out.push_back(name);
+            continue;
+        }
+        for (const auto& folder : m_config.indexFolders) {
+            const std::string path = folder + "/" + name;
+            if (::access(path.c_str(), R_OK) == 0) {
+                out.push_back(path);
+                break;
+            }
+        }
+    }
+    return out;
+}
+
+void PlateSolveService::preloadIndexes()
+{
+    if (m_config.preloadBudgetMb == 0)
+        return;
+
+    struct Candidate {
+        std::string path;
+        size_t size;
+    };
+    std::vector<Candidate> files;
+    for (const auto& folder : m_config.indexFolders) {
+        DIR* dir = ::opendir(folder.c_str());
+        if (!dir)
+            continue;
+        while (struct dirent* de = ::readdir(dir)) {
+            if (!isIndexFile(de->d_name) || !indexScaleUseful(indexScale(de->d_name), m_config.preloadFieldArcmin))
+                continue;
+            const std::string path = folder + "/" + de->d_name;
+            struct stat st;
+            if (::stat(path.c_str(), &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0)
+                files.push_back({path, static_cast<size_t>(st.st_size)});
+        }
+        ::closedir(dir);
+    }
+    // 小文件（大尺度索引）优先：同样的预算能覆盖更多视场范围
+    std::sort(files.begin(), files.end(), [](const Candidate& a, const Candidate& b) { return a.size < b.size; });
+
+    const uint64_t budget = static_cast<uint64_t>(m_config.preloadBudgetMb) << 20;
+    const int64_t startNs = nowNs();
+    size_t locked = 0;
+    for (const auto& f : files) {
+        if (!m_running.load())
+            break;
+        if (m_preloadedBytes + f.size > budget)
+            continue;
+        const int fd = ::open(f.path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0)
+            continue;
+        // MAP_POPULATE 读入页缓存；映射一直保留到 stop()，求解器每次打开索引都命中内存
+        void* addr = ::mmap(nullptr, f.size, PROT_READ, MAP_SHARED | MAP_POPULATE, fd, 0);
+        ::close(fd);
+        if (addr == MAP_FAILED)
+            continue;
+        ::madvise(addr, f.size, MADV_WILLNEED);
+        if (m_config.lockPreloaded && ::mlock(addr, f.size) == 0)
+            ++locked;
+        m_mappings.push_back({addr, f.size});
+        m_preloadedBytes += f.size;
+    }
+    Logger::Log("PlateSolveService | preloaded " + std::to_string(m_mappings.size()) + "/" + std::to_string(files.size()) +
+                    " index files (" + std::to_string(m_preloadedBytes >> 20) + " MB" +
+                    (m_config.lockPreloaded ? ", locked " + std::to_string(locked) : std::string()) + ") in " +
+                    std::to_string(static_cast<int>(msSince(startNs))) + " ms",
+                LogLevel::INFO, DeviceType::MAIN);
+}
+
+void PlateSolveService::releaseIndexes()
+{
+    for (const auto& m : m_mappings)
+        ::munmap(m.addr, m.length);
+    m_mappings.clear();
+    m_preloadedBytes = 0;
+}
+
+} // namespace solver
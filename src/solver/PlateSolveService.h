@@ -0,0 +1,158 @@
+#pragma once
+
+#include "TanWcs.h"
+#include "XyList.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+class SdkSerialExecutor;
+class StellarSolver;
+
+namespace solver {
+
+struct SolveRequest {
+    std::string imagePath;          ///< FITS 路径（给了 stars 时只用来定位 .wcs 与缓存键）
+    // 已检测的星表：非空时直接做四边形匹配，不读 FITS、不重新提取星点
+    XyList stars;
+    // 视场约束（图像宽度方向，度）；<=0 表示不限
+    double scaleLowDeg{0.0};
+    double scaleHighDeg{0.0};
+    // 位置先验（度）；usePosition=false 时全天搜索
+    bool usePosition{false};
+    double raDeg{0.0};
+    double decDeg{0.0};
+    double radiusDeg{2.0};
+    // 只用这些索引文件（文件名或绝对路径）；空表示用全部已配置目录
+    std::vector<std::string> indexFiles;
+    int timeoutMs{10000};
+    bool writeWcs{true};            ///< 在图像旁写 <name>.wcs（与 solve-field 产物兼容）
+    std::string tag;                ///< 调用方标识（日志）
+};
+
+enum class SolveStatus {
+    Solved,
+    Failed,    ///< 求解器未找到解
+    Timeout,
+    Cancelled,
+    Error,     ///< 读图/服务不可用等，调用方可回退到 solve-field
+};
+
+const char* solveStatusName(SolveStatus status);
+
+// 各阶段耗时（ms）
+struct SolveTiming {
+    double queueMs{0.0};
+    double loadMs{0.0};   ///< 读 FITS 到内存（给了星表时为 0）
+    double solveMs{0.0};  ///< 提取星点 + 索引匹配
+    double writeMs{0.0};  ///< 写 .wcs
+    double totalMs{0.0};  ///< 提交到完成
+};
+
+struct SolveResult {
+    uint64_t id{0};
+    SolveStatus status{SolveStatus::Error};
+    std::string error;
+    std::string imagePath;
+    std::string wcsPath;
+    double raDeg{0.0};
+    double decDeg{0.0};
+    double orientationDeg{0.0};
+    double pixelScaleArcsec{0.0};
+    bool mirrored{false};
+    TanWcs wcs;
+    SolveTiming timing;
+
+    bool solved() const { return status == SolveStatus::Solved; }
+};
+
+struct SolveServiceConfig {
+    std::vector<std::string> indexFolders;  ///< 索引目录（index-*.fits）
+    // 常驻映射的索引总量上限（MB）；默认 0 不预载（小内存设备上预载会推迟首次求解并长期占用内存）
+    size_t preloadBudgetMb{0};
+    // 只预载与该视场宽度（角分）相称的索引尺度（四边形直径在视场的 10%..100% 之间）；0 表示不按尺度筛选
+    double preloadFieldArcmin{0.0};
+    bool lockPreloaded{false};              ///< mlock 预载的索引（需要 RLIMIT_MEMLOCK 足够）
+};
+
+// 常驻求解服务：
+// - 一个专用线程串行执行 StellarSolver（内部自行并行），无进程启动与 stdout 解析开销
+// - 可选：启动时把（与视场相称的）索引文件 mmap 常驻（可选 mlock），每次求解打开索引只命中页缓存
+// - 队列接口：submit 返回请求 id，可 cancel（排队中直接移除，运行中 abort）、wait，结果带分阶段耗时
+// - 最近一次成功的结果按图像路径缓存，Tools::ReadSolveResult 可直接取用，不再调用 wcsinfo
+class PlateSolveService
+{
+public:
+    using Callback = std::function<void(const SolveResult&)>;
+
+    static PlateSolveService& instance();
+
+    bool start(const SolveServiceConfig& config);
+    void stop();
+    bool available() const { return m_running.load(); }
+
+    // 返回请求 id（服务未启动返回 0）；callback 在求解线程调用
+    uint64_t submit(SolveRequest request, Callback callback = {});
+    bool cancel(uint64_t id);
+    // 等待结果；超时返回 false（请求仍在进行，可 cancel）
+    bool wait(uint64_t id, int timeoutMs, SolveResult* out);
+    // submit + wait，超时自动 cancel
+    SolveResult solve(const SolveRequest& request);
+
+    bool lastSolved(const std::string& imagePath, SolveResult* out) const;
+    // 由服务外得到的解（如近先验跟踪解析）登记到同一缓存，ReadSolveResult 同样直接取用
+    void publish(const SolveResult& result);
+    void forget(const std::string& imagePath);
+
+    size_t pending() const;
+    uint64_t preloadedBytes() const { return m_preloadedBytes; }
+
+private:
+    PlateSolveService() = default;
+    ~PlateSolveService();
+
+    struct Job {
+        uint64_t id{0};
+        SolveRequest request;
+        Callback callback;
+        int64_t submittedNs{0};
+    };
+    struct Mapping {
+        void* addr{nullptr};
+        size_t length{0};
+    };
+
+    void drainOne();
+    SolveResult runJob(const Job& job);
+    void finish(const Job& job, const SolveResult& result);
+    void preloadIndexes();
+    void releaseIndexes();
+    std::vector<std::string> resolveIndexFiles(const std::vector<std::string>& names) const;
+
+    SolveServiceConfig m_config;
+    std::unique_ptr<SdkSerialExecutor> m_exec;
+    std::atomic<bool> m_running{false};
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::deque<Job> m_queue;
+    uint64_t m_nextId{1};
+    uint64_t m_activeId{0};
+    StellarSolver* m_activeSolver{nullptr};
+    bool m_activeCancelled{false};
+    std::map<uint64_t, SolveResult> m_done;              // 最近完成的结果（供 wait）
+    std::map<std::string, SolveResult> m_lastByImage;    // 最近成功解析（按图像路径）
+
+    std::vector<Mapping> m_mappings;
+    uint64_t m_preloadedBytes{0};
+};
+
+} // namespace solver
@@ -0,0 +1,674 @@
+#include "PoleIndex.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace solver {
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+constexpr double kDeg = kPi / 180.0;
+
+constexpr char kMagic[4] = {'Q', 'P', 'I', 'X'};
+constexpr uint32_t kVersion = 1;
+constexpr int kCodeBins = 128;          // 形状码网格每轴格数
+constexpr double kMinSideGap = 0.01;    // 相邻边长差 < a*kMinSideGap 时顶点顺序不稳定，丢弃
+constexpr double kMinShortRatio = 0.15; // c/a 太小的细长三角形对噪声敏感，丢弃
+constexpr double kCapCellDeg = 1.0;
+
+struct Point {
+    double x{0.0};
+    double y{0.0};
+};
+
+using Vec3 = std::array<double, 3>;
+
+Vec3 toXyz(double raDeg, double decDeg)
+{
+    const double ra = raDeg * kDeg;
+    const double dec = decDeg * kDeg;
+    return {std::cos(dec) * std::cos(ra), std::cos(dec) * std::sin(ra), std::sin(dec)};
+}
+
+double angleDeg(const Vec3& a, const Vec3& b)
+{
+    const double dx = a[0] - b[0];
+    const double dy = a[1] - b[1];
+    const double dz = a[2] - b[2];
+    return 2.0 * std::asin(std::min(1.0, 0.5 * std::sqrt(dx * dx + dy * dy + dz * dz))) / kDeg;
+}
+
+int hemisphereOf(const SkyStar& s)
+{
+    return s.decDeg >= 0.0 ? 1 : -1;
+}
+
+// 以天极为原点的方位等距平面（度）
+Point capPlane(double raDeg, double decDeg)
+{
+    const double rho = 90.0 - std::fabs(decDeg);
+    return {rho * std::cos(raDeg * kDeg), rho * std::sin(raDeg * kDeg)};
+}
+
+// 三角形顶点按对边从长到短排序，返回 false 表示形状退化或顶点顺序不稳定
+// side(i,j) 给出顶点 i、j 间的边长
+template <typename SideFn>
+bool orderTriangle(SideFn side, int order[3], double* a, double* r1, double* r2)
+{
+    struct Opposite {
+        double len;
+        int vertex;
+    } opp[3] = {{side(1, 2), 0}, {side(0, 2), 1}, {side(0, 1), 2}};
+    std::sort(opp, opp + 3, [](const Opposite& l, const Opposite& r) { return l.len > r.len; });
+    if (!(opp[0].len > 0.0))
+        return false;
+    const double la = opp[0].len;
+    if (opp[0].len - opp[1].len < kMinSideGap * la || opp[1].len - opp[2].len < kMinSideGap * la)
+        return false;
+    if (opp[2].len < kMinShortRatio * la || opp[1].len + opp[2].len < 1.02 * la)
+        return false;
+    for (int k = 0; k < 3; ++k)
+        order[k] = opp[k].vertex;
+    *a = la;
+    *r1 = opp[1].len / la;
+    *r2 = opp[2].len / la;
+    return true;
+}
+
+uint16_t quantizeCode(double r)
+{
+    return static_cast<uint16_t>(std::lround(std::clamp(r, 0.0, 1.0) * 65535.0));
+}
+
+int codeBin(double r)
+{
+    return std::clamp(static_cast<int>(r * kCodeBins), 0, kCodeBins - 1);
+}
+
+// 以 tangent 为切点、CD 为单位阵的 TAN：像素坐标即中间世界坐标（度）
+TanWcs tangentFrame(double raDeg, double decDeg)
+{
+    TanWcs t;
+    t.crval[0] = raDeg;
+    t.crval[1] = decDeg;
+    t.cd[0][0] = 1.0;
+    t.cd[1][1] = 1.0;
+    return t;
+}
+
+// 三对点确定 TAN 假设：先以三星方向之和为切点，CD 由两条边精确解出（含镜像），再把切点挪到画面中心；
+// 明显偏离相似变换（剪切/各向异性）的直接拒绝
+bool hypothesisWcs(const Point px[3], const SkyStar* sky[3], int width, int height, TanWcs* out)
+{
+    Vec3 sum{0.0, 0.0, 0.0};
+    for (int k = 0; k < 3; ++k) {
+        const Vec3 v = toXyz(sky[k]->raDeg, sky[k]->decDeg);
+        sum[0] += v[0];
+        sum[1] += v[1];
+        sum[2] += v[2];
+    }
+    const double norm = std::sqrt(sum[0] * sum[0] + sum[1] * sum[1] + sum[2] * sum[2]);
+    if (!(norm > 0.0))
+        return false;
+    const double tanDec = std::asin(std::clamp(sum[2] / norm, -1.0, 1.0)) / kDeg;
+    double tanRa = std::atan2(sum[1], sum[0]) / kDeg;
+    if (tanRa < 0.0)
+        tanRa += 360.0;
+
+    const TanWcs frame = tangentFrame(tanRa, tanDec);
+    Point uv[3];
+    for (int k = 0; k < 3; ++k)
+        if (!frame.skyToPixel(sky[k]->raDeg, sky[k]->decDeg, &uv[k].x, &uv[k].y))
+            return false;
+
+    // [du1 du2; dv1 dv2] = CD * [dx1 dx2; dy1 dy2]
+    const double x11 = px[1].x - px[0].x, x12 = px[2].x - px[0].x;
+    const double x21 = px[1].y - px[0].y, x22 = px[2].y - px[0].y;
+    const double det = x11 * x22 - x12 * x21;
+    if (std::fabs(det) < 1e-9)
+        return false;
+    const double i11 = x22 / det, i12 = -x12 / det, i21 = -x21 / det, i22 = x11 / det;
+    const double u1 = uv[1].x - uv[0].x, u2 = uv[2].x - uv[0].x;
+    const double v1 = uv[1].y - uv[0].y, v2 = uv[2].y - uv[0].y;
+    TanWcs w;
+    w.cd[0][0] = u1 * i11 + u2 * i21;
+    w.cd[0][1] = u1 * i12 + u2 * i22;
+    w.cd[1][0] = v1 * i11 + v2 * i21;
+    w.cd[1][1] = v1 * i12 + v2 * i22;
+
+    const double n0 = std::hypot(w.cd[0][0], w.cd[1][0]);
+    const double n1 = std::hypot(w.cd[0][1], w.cd[1][1]);
+    if (!(n0 > 0.0) || !(n1 > 0.0) || std::fabs(n0 / n1 - 1.0) > 0.05)
+        return false;
+    if (std::fabs(w.cd[0][0] * w.cd[0][1] + w.cd[1][0] * w.cd[1][1]) > 0.05 * n0 * n1)
+        return false;
+
+    // (u,v) = CD*(p - p0) + uv0，切点 (0,0) 对应的像素即 CRPIX
+    const double cdDet = w.cd[0][0] * w.cd[1][1] - w.cd[0][1] * w.cd[1][0];
+    w.crpix[0] = px[0].x - (w.cd[1][1] * uv[0].x - w.cd[0][1] * uv[0].y) / cdDet;
+    w.crpix[1] = px[0].y - (-w.cd[1][0] * uv[0].x + w.cd[0][0] * uv[0].y) / cdDet;
+    w.crval[0] = tanRa;
+    w.crval[1] = tanDec;
+    if (!w.valid())
+        return false;
+
+    // 光轴在画面中心：切点移到中心（后续精修固定 CRPIX，切点偏离光轴会留下透视残差），
+    // 新切点处的 CD 由两条 100 像素基线经原假设换算后重新求出
+    const double cx = 0.5 * (width + 1);
+    const double cy = 0.5 * (height + 1);
+    const SkyPoint center = w.pixelToSky(cx, cy);
+    const TanWcs centered = tangentFrame(center.raDeg, center.decDeg);
+    TanWcs c = centered;
+    const double base = 100.0;
+    for (int axis = 0; axis < 2; ++axis) {
+        const SkyPoint p = w.pixelToSky(cx + (axis == 0 ? base : 0.0), cy + (axis == 1 ? base : 0.0));
+        double u = 0, v = 0;
+        if (!centered.skyToPixel(p.raDeg, p.decDeg, &u, &v))
+            return false;
+        c.cd[0][axis] = u / base;
+        c.cd[1][axis] = v / base;
+    }
+    c.crpix[0] = cx;
+    c.crpix[1] = cy;
+    c.imageWidth = width;
+    c.imageHeight = height;
+    *out = c;
+    return c.valid();
+}
+
+// 星点的像素网格（CSR），验证假设时按半径查有无星点
+class PixelGrid
+{
+public:
+    PixelGrid(const std::vector<Point>& points, int width, int height, double cellPx)
+        : m_points(points), m_cell(std::max(1.0, cellPx))
+    {
+        m_cols = static_cast<int>(width / m_cell) + 2;
+        m_rows = static_cast<int>(height / m_cell) + 2;
+        m_start.assign(size_t(m_cols) * m_rows + 1, 0);
+        for (const Point& p : points)
+            ++m_start[cellOf(p.x, p.y) + 1];
+        for (size_t i = 1; i < m_start.size(); ++i)
+            m_start[i] += m_start[i - 1];
+        m_items.resize(points.size());
+        std::vector<uint32_t> fill(m_start.begin(), m_start.end() - 1);
+        for (size_t i = 0; i < points.size(); ++i)
+            m_items[fill[cellOf(points[i].x, points[i].y)]++] = static_cast<uint32_t>(i);
+    }
+
+    bool any(double x, double y, double radius) const
+    {
+        const double r2 = radius * radius;
+        const int cx = std::clamp(static_cast<int>(x / m_cell), 0, m_cols - 1);
+        const int cy = std::clamp(static_cast<int>(y / m_cell), 0, m_rows - 1);
+        const int reach = static_cast<int>(std::ceil(radius / m_cell));
+        for (int gy = std::max(0, cy - reach); gy <= std::min(m_rows - 1, cy + reach); ++gy) {
+            for (int gx = std::max(0, cx - reach); gx <= std::min(m_cols - 1, cx + reach); ++gx) {
+                const size_t c = size_t(gy) * m_cols + gx;
+                for (uint32_t k = m_start[c]; k < m_start[c + 1]; ++k) {
+                    const Point& p = m_points[m_items[k]];
+                    const double dx = p.x - x;
+                    const double dy = p.y - y;
+                    if (dx * dx + dy * dy <= r2)
+                        return true;
+                }
+            }
+        }
+        return false;
+    }
+
+private:
+    size_t cellOf(double x, double y) const
+    {
+        const int cx = std::clamp(static_cast<int>(x / m_cell), 0, m_cols - 1);
+        const int cy = std::clamp(static_cast<int>(y / m_cell), 0, m_rows - 1);
+        return size_t(cy) * m_cols + cx;
+    }
+
+    const std::vector<Point>& m_points;
+    double m_cell;
+    int m_cols{0};
+    int m_rows{0};
+    std::vector<uint32_t> m_start;
+    std::vector<uint32_t> m_items;
+};
+
+template <typename T>
+void writePod(std::ofstream& out, const T& v)
+{
+    out.write(reinterpret_cast<const char*>(&v), sizeof(T));
+}
+
+template <typename T>
+bool readPod(std::ifstream& in, T* v)
+{
+    return static_cast<bool>(in.read(reinterpret_cast<char*>(v), sizeof(T)));
+}
+
+double elapsedMs(std::chrono::steady_clock::time_point since)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - since).count();
+}
+
+} // namespace
+
+bool PoleIndex::build(const StarCatalog& catalog, const PoleIndexOptions& options)
+{
+    std::vector<SkyStar> stars;
+    for (double poleDec : {90.0, -90.0})
+        for (const SkyStar& s : catalog.cone(0.0, poleDec, options.capRadiusDeg))
+            stars.push_back(s);
+    return build(stars, options);
+}
+
+bool PoleIndex::build(const std::vector<SkyStar>& input, const PoleIndexOptions& options)
+{
+    m_options = options;
+    m_stars.clear();
+    m_triangles.clear();
+
+    // 只留极冠内够亮的星，最多 65535 颗；北在前、各自最亮在前
+    for (const SkyStar& s : input) {
+        if (!std::isfinite(s.raDeg) || !std::isfinite(s.decDeg) || s.mag > options.maxMag)
+            continue;
+        if (90.0 - std::fabs(s.decDeg) > options.capRadiusDeg)
+            continue;
+        m_stars.push_back(s);
+    }
+    std::sort(m_stars.begin(), m_stars.end(), [](const SkyStar& a, const SkyStar& b) { return a.mag < b.mag; });
+    if (m_stars.size() > std::numeric_limits<uint16_t>::max())
+        m_stars.resize(std::numeric_limits<uint16_t>::max());
+    std::stable_sort(m_stars.begin(), m_stars.end(),
+                     [](const SkyStar& a, const SkyStar& b) { return hemisphereOf(a) > hemisphereOf(b); });
+
+    std::vector<Vec3> xyz;
+    xyz.reserve(m_stars.size());
+    for (const SkyStar& s : m_stars)
+        xyz.push_back(toXyz(s.raDeg, s.decDeg));
+
+    std::unordered_set<uint64_t> seen;
+    const double minField = std::max(0.1, options.minFieldDeg);
+    const double maxField = std::max(minField, options.maxFieldDeg);
+    const size_t neighbors = static_cast<size_t>(std::max(2, options.neighbors));
+
+    for (int hemi : {1, -1}) {
+        std::vector<uint16_t> members;
+        for (size_t i = 0; i < m_stars.size(); ++i)
+            if (hemisphereOf(m_stars[i]) == hemi)
+                members.push_back(static_cast<uint16_t>(i));
+
+        // 每倍频程一档：视场宽 F..2F 的画面由这一档的三角形覆盖
+        for (double field = minField;; field *= 2.0) {
+            // 均匀化：视场/4 的格子里只保留最亮的 starsPerCell 颗
+            const double cell = field / 4.0;
+            std::unordered_map<uint64_t, int> perCell;
+            std::vector<uint16_t> subset;
+            for (uint16_t i : members) {
+                const Point p = capPlane(m_stars[i].raDeg, m_stars[i].decDeg);
+                const uint64_t key = (uint64_t(uint32_t(int32_t(std::floor(p.x / cell)))) << 32) | uint32_t(int32_t(std::floor(p.y / cell)));
+                if (perCell[key]++ < options.starsPerCell)
+                    subset.push_back(i);
+            }
+
+            const double maxSide = 0.75 * field;
+            const double minLongest = field / 8.0;
+            std::vector<std::pair<double, uint16_t>> near;
+            for (uint16_t s : subset) {
+                near.clear();
+                for (uint16_t t : subset) {
+                    if (t == s)
+                        continue;
+                    const double d = angleDeg(xyz[s], xyz[t]);
+                    if (d <= maxSide)
+                        near.push_back({d, t});
+                }
+                const size_t k = std::min(neighbors, near.size());
+                std::partial_sort(near.begin(), near.begin() + k, near.end());
+                for (size_t p = 0; p < k; ++p) {
+                    for (size_t q = p + 1; q < k; ++q) {
+                        uint16_t v[3] = {s, near[p].second, near[q].second};
+                        std::sort(v, v + 3);
+                        const uint64_t key = (uint64_t(v[0]) << 32) | (uint64_t(v[1]) << 16) | v[2];
+                        if (!seen.insert(key).second)
+                            continue;
+                        int order[3];
+                        double a = 0, r1 = 0, r2 = 0;
+                        auto side = [&](int i, int j) { return angleDeg(xyz[v[i]], xyz[v[j]]); };
+                        if (!orderTriangle(side, order, &a, &r1, &r2) || a < minLongest || a > maxSide)
+                            continue;
+                        Triangle t;
+                        for (int n = 0; n < 3; ++n)
+                            t.star[n] = v[order[n]];
+                        t.code[0] = quantizeCode(r1);
+                        t.code[1] = quantizeCode(r2);
+                        t.longestMdeg = static_cast<uint16_t>(std::min(65535L, std::lround(a * 1000.0)));
+                        m_triangles.push_back(t);
+                    }
+                }
+            }
+            if (field >= maxField)
+                break;
+        }
+    }
+
+    finalize();
+    return !m_triangles.empty();
+}
+
+void PoleIndex::finalize()
+{
+    // 形状码二维网格（CSR）
+    m_bucketStart.assign(size_t(kCodeBins) * kCodeBins + 1, 0);
+    auto bucketOf = [](const Triangle& t) {
+        return size_t(codeBin(t.code[0] / 65535.0)) * kCodeBins + codeBin(t.code[1] / 65535.0);
+    };
+    for (const Triangle& t : m_triangles)
+        ++m_bucketStart[bucketOf(t) + 1];
+    for (size_t i = 1; i < m_bucketStart.size(); ++i)
+        m_bucketStart[i] += m_bucketStart[i - 1];
+    m_bucketTriangles.resize(m_triangles.size());
+    std::vector<uint32_t> fill(m_bucketStart.begin(), m_bucketStart.end() - 1);
+    for (size_t i = 0; i < m_triangles.size(); ++i)
+        m_bucketTriangles[fill[bucketOf(m_triangles[i])]++] = static_cast<uint32_t>(i);
+
+    // 两个极冠的方位等距网格
+    for (int h = 0; h < 2; ++h) {
+        CapGrid& g = m_capGrid[h];
+        g.cellDeg = kCapCellDeg;
+        g.cells = static_cast<int>(std::ceil(2.0 * m_options.capRadiusDeg / g.cellDeg)) + 1;
+        g.start.assign(size_t(g.cells) * g.cells + 1, 0);
+        g.stars.clear();
+    }
+    auto capCell = [&](const CapGrid& g, const SkyStar& s) {
+        const Point p = capPlane(s.raDeg, s.decDeg);
+        const int cx = std::clamp(static_cast<int>((p.x + m_options.capRadiusDeg) / g.cellDeg), 0, g.cells - 1);
+        const int cy = std::clamp(static_cast<int>((p.y + m_options.capRadiusDeg) / g.cellDeg), 0, g.cells - 1);
+        return size_t(cy) * g.cells + cx;
+    };
+    for (const SkyStar& s : m_stars) {
+        CapGrid& g = m_capGrid[hemisphereOf(s) > 0 ? 0 : 1];
+        ++g.start[capCell(g, s) + 1];
+    }
+    for (int h = 0; h < 2; ++h) {
+        CapGrid& g = m_capGrid[h];
+        for (size_t i = 1; i < g.start.size(); ++i)
+            g.start[i] += g.start[i - 1];
+        g.stars.resize(g.start.back());
+    }
+    std::vector<uint32_t> fillCap[2] = {{m_capGrid[0].start.begin(), m_capGrid[0].start.end() - 1},
+                                        {m_capGrid[1].start.begin(), m_capGrid[1].start.end() - 1}};
+    for (size_t i = 0; i < m_stars.size(); ++i) {
+        const int h = hemisphereOf(m_stars[i]) > 0 ? 0 : 1;
+        m_capGrid[h].stars[fillCap[h][capCell(m_capGrid[h], m_stars[i])]++] = static_cast<uint16_t>(i);
+    }
+
+    m_catalog = StarCatalog();
+    for (const SkyStar& s : m_stars)
+        m_catalog.add(s);
+}
+
+void PoleIndex::starsNear(int hemisphere, double raDeg, double decDeg, double radiusDeg,
+                          std::vector<uint16_t>& out) const
+{
+    out.clear();
+    const CapGrid& g = m_capGrid[hemisphere > 0 ? 0 : 1];
+    if (g.cells <= 0)
+        return;
+    // 离天极 20° 内方位等距投影的径向失真 < 2.1%，放宽 5% 足够
+    const Point c = capPlane(raDeg, decDeg);
+    const double r = radiusDeg * 1.05 + g.cellDeg;
+    const double half = m_options.capRadiusDeg;
+    const int x0 = std::clamp(static_cast<int>((c.x - r + half) / g.cellDeg), 0, g.cells - 1);
+    const int x1 = std::clamp(static_cast<int>((c.x + r + half) / g.cellDeg), 0, g.cells - 1);
+    const int y0 = std::clamp(static_cast<int>((c.y - r + half) / g.cellDeg), 0, g.cells - 1);
+    const int y1 = std::clamp(static_cast<int>((c.y + r + half) / g.cellDeg), 0, g.cells - 1);
+    for (int y = y0; y <= y1; ++y)
+        for (int x = x0; x <= x1; ++x) {
+            const size_t cell = size_t(y) * g.cells + x;
+            out.insert(out.end(), g.stars.begin() + g.start[cell], g.stars.begin() + g.start[cell + 1]);
+        }
+}
+
+size_t PoleIndex::bytes() const
+{
+    return sizeof(kMagic) + sizeof(uint32_t) * 3 + sizeof(double) * 4 + sizeof(int32_t) * 2 +
+           m_stars.size() * 3 * sizeof(double) + m_triangles.size() * 6 * sizeof(uint16_t);
+}
+
+bool PoleIndex::save(const std::string& path, std::string* error) const
+{
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        if (error)
+            *error = "cannot write " + path;
+        return false;
+    }
+    out.write(kMagic, sizeof(kMagic));
+    writePod(out, kVersion);
+    writePod(out, m_options.capRadiusDeg);
+    writePod(out, m_options.maxMag);
+    writePod(out, m_options.minFieldDeg);
+    writePod(out, m_options.maxFieldDeg);
+    writePod(out, int32_t(m_options.starsPerCell));
+    writePod(out, int32_t(m_options.neighbors));
+    writePod(out, uint32_t(m_stars.size()));
+    writePod(out, uint32_t(m_triangles.size()));
+    for (const SkyStar& s : m_stars) {
+        writePod(out, s.raDeg);
+        writePod(out, s.decDeg);
+        writePod(out, s.mag);
+    }
+    for (const Triangle& t : m_triangles) {
+        writePod(out, t.star[0]);
+        writePod(out, t.star[1]);
+        writePod(out, t.star[2]);
+        writePod(out, t.code[0]);
+        writePod(out, t.code[1]);
+        writePod(out, t.longestMdeg);
+    }
+    out.flush();
+    if (!out) {
+        if (error)
+            *error = "write failed: " + path;
+        return false;
+    }
+    return true;
+}
+
+bool PoleIndex::load(const std::string& path, std::string* error)
+{
+    auto fail = [&](const std::string& why) {
+        if (error)
+            *error = why;
+        return false;
+    };
+    std::ifstream in(path, std::ios::binary);
+    if (!in)
+        return fail("cannot open " + path);
+
+    char magic[4];
+    uint32_t version = 0;
+    if (!in.read(magic, sizeof(magic)) || std::memcmp(magic, kMagic, sizeof(kMagic)) != 0)
+        return fail("not a pole index: " + path);
+    if (!readPod(in, &version) || version != kVersion)
+        return fail("unsupported pole index version " + std::to_string(version));
+
+    PoleIndexOptions options;
+    int32_t starsPerCell = 0, neighbors = 0;
+    uint32_t starCount = 0, triangleCount = 0;
+    if (!readPod(in, &options.capRadiusDeg) || !readPod(in, &options.maxMag) || !readPod(in, &options.minFieldDeg) ||
+        !readPod(in, &options.maxFieldDeg) || !readPod(in, &starsPerCell) || !readPod(in, &neighbors) ||
+        !readPod(in, &starCount) || !readPod(in, &triangleCount))
+        return fail("truncated header: " + path);
+    if (starCount > std::numeric_limits<uint16_t>::max() || !(options.capRadiusDeg > 0.0 && options.capRadiusDeg <= 90.0))
+        return fail("corrupt header: " + path);
+    options.starsPerCell = starsPerCell;
+    options.neighbors = neighbors;
+
+    std::vector<SkyStar> stars(starCount);
+    for (SkyStar& s : stars)
+        if (!readPod(in, &s.raDeg) || !readPod(in, &s.decDeg) || !readPod(in, &s.mag))
+            return fail("truncated star table: " + path);
+    std::vector<Triangle> triangles(triangleCount);
+    for (Triangle& t : triangles) {
+        if (!readPod(in, &t.star[0]) || !readPod(in, &t.star[1]) || !readPod(in, &t.star[2]) ||
+            !readPod(in, &t.code[0]) || !readPod(in, &t.code[1]) || !readPod(in, &t.longestMdeg))
+            return fail("truncated triangle table: " + path);
+        if (t.star[0] >= starCount || t.star[1] >= starCount || t.star[2] >= starCount)
+            return fail("corrupt triangle table: " + path);
+    }
+
+    m_options = options;
+    m_stars.swap(stars);
+    m_triangles.swap(triangles);
+    finalize();
+    return true;
+}
+
+PoleSolveResult PoleIndex::solve(const XyList& stars, const PoleSolveOptions& options) const
+{
+    const auto t0 = std::chrono::steady_clock::now();
+    PoleSolveResult result;
+    auto fail = [&](const std::string& why) {
+        result.error = why;
+        result.elapsedMs = elapsedMs(t0);
+        return result;
+    };
+    const int width = stars.imageWidth;
+    const int height = stars.imageHeight;
+    if (m_triangles.empty())
+        return fail("empty index");
+    if (width <= 0 || height <= 0)
+        return fail("image size unknown");
+    if (stars.stars.size() < std::max<size_t>(4, options.minVerified))
+        return fail("too few stars");
+
+    std::vector<Point> det;
+    det.reserve(stars.stars.size());
+    for (const XyStar& s : stars.stars)
+        det.push_back({s.x + 1.0, s.y + 1.0});
+    const PixelGrid grid(det, width + 1, height + 1, options.verifyRadiusPx);
+
+    // 像素尺度范围（度/像素），未知时不限
+    double scaleLo = 0.0;
+    double scaleHi = std::numeric_limits<double>::infinity();
+    if (options.fieldLowDeg > 0.0 && options.fieldHighDeg >= options.fieldLowDeg) {
+        scaleLo = 0.95 * options.fieldLowDeg / width;
+        scaleHi = 1.05 * options.fieldHighDeg / width;
+    }
+
+    const double halfDiagPx = 0.5 * std::hypot(width, height);
+    std::vector<uint16_t> nearby;
+    // 验证：视场内的索引星按假设投影到像素面，数有星点落在半径内的个数
+    auto verify = [&](const TanWcs& w, int hemi) {
+        const SkyPoint center = w.pixelToSky(0.5 * (width + 1), 0.5 * (height + 1));
+        starsNear(hemi, center.raDeg, center.decDeg, halfDiagPx * w.pixelScaleArcsec() / 3600.0, nearby);
+        size_t hits = 0;
+        for (uint16_t i : nearby) {
+            double x = 0, y = 0;
+            if (!w.skyToPixel(m_stars[i].raDeg, m_stars[i].decDeg, &x, &y))
+                continue;
+            if (x < 0.5 || y < 0.5 || x > width + 0.5 || y > height + 0.5)
+                continue;
+            if (grid.any(x, y, options.verifyRadiusPx))
+                ++hits;
+        }
+        return hits;
+    };
+
+    const size_t pattern = std::min(det.size(), std::max<size_t>(3, options.patternStars));
+    const double minSidePx = 0.05 * std::max(width, height);
+    const double tol = options.codeTolerance;
+    const size_t strong = 2 * options.minVerified;
+    TanWcs best;
+    size_t bestScore = 0;
+    int bestHemi = 0;
+
+    // 最亮的星组成的三角形先试
+    for (size_t k = 2; k < pattern && bestScore < strong && result.hypotheses < options.maxHypotheses; ++k) {
+        for (size_t j = 1; j < k && bestScore < strong; ++j) {
+            for (size_t i = 0; i < j && bestScore < strong; ++i) {
+                const size_t v[3] = {i, j, k};
+                int order[3];
+                double aPx = 0, r1 = 0, r2 = 0;
+                auto side = [&](int p, int q) { return std::hypot(det[v[p]].x - det[v[q]].x, det[v[p]].y - det[v[q]].y); };
+                if (!orderTriangle(side, order, &aPx, &r1, &r2) || aPx < minSidePx)
+                    continue;
+                const Point px[3] = {det[v[order[0]]], det[v[order[1]]], det[v[order[2]]]};
+
+                for (int b0 = codeBin(r1 - tol); b0 <= codeBin(r1 + tol); ++b0) {
+                    for (int b1 = codeBin(r2 - tol); b1 <= codeBin(r2 + tol); ++b1) {
+                        const size_t bucket = size_t(b0) * kCodeBins + b1;
+                        for (uint32_t n = m_bucketStart[bucket]; n < m_bucketStart[bucket + 1]; ++n) {
+                            const Triangle& t = m_triangles[m_bucketTriangles[n]];
+                            if (std::fabs(t.code[0] / 65535.0 - r1) > tol || std::fabs(t.code[1] / 65535.0 - r2) > tol)
+                                continue;
+                            const int hemi = hemisphereOf(m_stars[t.star[0]]);
+                            if (options.hemisphere != 0 && hemi != options.hemisphere)
+                                continue;
+                            const double scale = t.longestMdeg / 1000.0 / aPx;
+                            if (scale < scaleLo || scale > scaleHi)
+                                continue;
+                            if (++result.hypotheses > options.maxHypotheses)
+                                break;
+                            const SkyStar* sky[3] = {&m_stars[t.star[0]], &m_stars[t.star[1]], &m_stars[t.star[2]]};
+                            TanWcs w;
+                            if (!hypothesisWcs(px, sky, width, height, &w))
+                                continue;
+                            const double s = w.pixelScaleArcsec() / 3600.0;
+                            if (s < scaleLo || s > scaleHi)
+                                continue;
+                            const size_t score = verify(w, hemi);
+                            if (score > bestScore) {
+                                bestScore = score;
+                                best = w;
+                                bestHemi = hemi;
+                                if (bestScore >= strong)
+                                    break;
+                            }
+                        }
+                        if (bestScore >= strong || result.hypotheses > options.maxHypotheses)
+                            break;
+                    }
+                    if (bestScore >= strong || result.hypotheses > options.maxHypotheses)
+                        break;
+                }
+            }
+        }
+    }
+    result.verified = bestScore;
+    if (bestScore < options.minVerified)
+        return fail("no pole index match (best " + std::to_string(bestScore) + ", " +
+                    std::to_string(result.hypotheses) + " hypotheses)");
+
+    // 以最佳假设为先验、索引星为星表，交给 TrackingSession 做最小二乘精修与复核
+    TrackingSession session(options.refine);
+    session.anchor(best, stars, &m_catalog);
+    if (!session.usingCatalog())
+        return fail("too few index stars in field");
+    TrackingResult refined = session.track(stars);
+    if (!refined.ok)
+        return fail("refine failed: " + refined.error);
+    // 假设偏差较大时第一轮只配上一部分星，以精修结果为先验再配一轮
+    const TrackingResult again = session.track(stars);
+    if (again.ok && again.matched >= refined.matched)
+        refined = again;
+
+    result.ok = true;
+    result.wcs = refined.wcs;
+    result.hemisphere = bestHemi;
+    result.matched = refined.matched;
+    result.rmsPx = refined.rmsPx;
+    result.elapsedMs = elapsedMs(t0);
+    return result;
+}
+
+} // namespace solver
@@ -0,0 +1,100 @@
+#pragma once
+
+#include "TanWcs.h"
+#include "TrackingSolver.h"
+#include "XyList.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace solver {
+
+struct PoleIndexOptions {
+    double capRadiusDeg{15.0};    ///< 只收录离天极这么近的星（南北各一块）
+    double maxMag{9.0};
+    double minFieldDeg{3.0};      ///< 支持的视场宽边范围：按 min..max 每倍频程一档生成三角形
+    double maxFieldDeg{16.0};
+    int starsPerCell{3};          ///< 每档按 视场/2 的格子均匀取星，每格保留最亮的若干颗
+    int neighbors{6};             ///< 每颗星与最近的若干邻星组成三角形
+};
+
+struct PoleSolveOptions {
+    double fieldLowDeg{0.0};      ///< 视场宽边范围（度）；都为 0 表示像素尺度未知
+    double fieldHighDeg{0.0};
+    int hemisphere{0};            ///< 1 北天极、-1 南天极、0 两边都试
+    size_t patternStars{16};      ///< 用最亮的若干星点组三角形
+    double codeTolerance{0.01};   ///< 三角形形状码（边长比）的容差
+    double verifyRadiusPx{6.0};   ///< 假设验证时星点与投影索引星的匹配半径
+    size_t minVerified{8};
+    size_t maxHypotheses{20000};
+    TrackingOptions refine;       ///< 最佳假设交给 TrackingSession 做最小二乘精修时的参数
+};
+
+struct PoleSolveResult {
+    bool ok{false};
+    std::string error;
+    TanWcs wcs;
+    int hemisphere{0};
+    size_t verified{0};           ///< 最佳假设验证时的匹配数
+    size_t matched{0};            ///< 精修后的匹配数
+    double rmsPx{0.0};
+    size_t hypotheses{0};
+    double elapsedMs{0.0};
+};
+
+// 天极区域专用星型索引：南北天极 capRadiusDeg 内的亮星，按视场分档生成三角形，
+// 形状码 (b/a, c/a)（a≥b≥c 为边长）与旋转、缩放、镜像无关，装进二维网格做近邻查找。
+// solve() 用最亮星点组成的三角形查表得到对应假设，按三点确定 TAN WCS，投影视场内索引星快速验证，
+// 最佳假设再交给 TrackingSession（以索引星为星表）最小二乘精修与复核。不启动外部进程。
+class PoleIndex
+{
+public:
+    // 从星表的两个极冠取星建索引；可用三角形为 0 时返回 false
+    bool build(const StarCatalog& catalog, const PoleIndexOptions& options = PoleIndexOptions());
+    bool build(const std::vector<SkyStar>& stars, const PoleIndexOptions& options = PoleIndexOptions());
+
+    // 二进制文件（小端）：魔数 QPIX、版本、参数、星（double ra/dec/mag，读回与建库结果逐位一致）、三角形（uint16 顶点与量化形状码）
+    bool save(const std::string& path, std::string* error = nullptr) const;
+    bool load(const std::string& path, std::string* error = nullptr);
+
+    bool empty() const { return m_triangles.empty(); }
+    size_t starCount() const { return m_stars.size(); }
+    size_t triangleCount() const { return m_triangles.size(); }
+    size_t bytes() const;
+    const PoleIndexOptions& options() const { return m_options; }
+    const StarCatalog& catalog() const { return m_catalog; }
+
+    PoleSolveResult solve(const XyList& stars, const PoleSolveOptions& options = PoleSolveOptions()) const;
+
+private:
+    struct Triangle {
+        uint16_t star[3];       ///< 顶点：依次为最长边、中边、最短边的对角顶点
+        uint16_t code[2];       ///< b/a、c/a 量化到 0..65535
+        uint16_t longestMdeg;   ///< 最长边（毫度）
+    };
+
+    // 极区平面网格：以天极为原点的方位等距坐标（度），用于按视场取索引星
+    struct CapGrid {
+        double cellDeg{1.0};
+        int cells{0};
+        std::vector<uint32_t> start;
+        std::vector<uint16_t> stars;
+    };
+
+    void finalize();
+    void starsNear(int hemisphere, double raDeg, double decDeg, double radiusDeg, std::vector<uint16_t>& out) const;
+
+    PoleIndexOptions m_options;
+    std::vector<SkyStar> m_stars;
+    std::vector<Triangle> m_triangles;
+
+    // 由 m_stars/m_triangles 派生，load/build 后重建
+    std::vector<uint32_t> m_bucketStart;
+    std::vector<uint32_t> m_bucketTriangles;
+    CapGrid m_capGrid[2];       ///< [0] 北、[1] 南
+    StarCatalog m_catalog;
+};
+
+} // namespace solver
@@ -0,0 +1,260 @@
+#include "TanWcs.h"
+#include "FitsHeader.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+
+namespace solver {
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+constexpr double kDeg = kPi / 180.0;
+
+void radecToXyz(double raDeg, double decDeg, double xyz[3])
+{
+    const double ra = raDeg * kDeg;
+    const double dec = decDeg * kDeg;
+    xyz[0] = std::cos(dec) * std::cos(ra);
+    xyz[1] = std::cos(dec) * std::sin(ra);
+    xyz[2] = std::sin(dec);
+}
+
+// 切点处的东、北单位向量
+void tangentBasis(const double r[3], double east[3], double north[3])
+{
+    double ex = -r[1];
+    double ey = r[0];
+    double norm = std::hypot(ex, ey);
+    if (norm < 1e-15) {
+        // 切点在天极：取 RA=0 方向为参考
+        ex = 0.0;
+        ey = 1.0;
+        norm = 1.0;
+    }
+    east[0] = ex / norm;
+    east[1] = ey / norm;
+    east[2] = 0.0;
+    // north = r x east
+    north[0] = r[1] * east[2] - r[2] * east[1];
+    north[1] = r[2] * east[0] - r[0] * east[2];
+    north[2] = r[0] * east[1] - r[1] * east[0];
+}
+
+} // namespace
+
+bool TanWcs::valid() const
+{
+    const double det = cd[0][0] * cd[1][1] - cd[0][1] * cd[1][0];
+    return std::isfinite(det) && det != 0.0 && std::isfinite(crval[0]) && std::isfinite(crval[1]);
+}
+
+SkyPoint TanWcs::pixelToSky(double x, double y) const
+{
+    const double dx = x - crpix[0];
+    const double dy = y - crpix[1];
+    const double u = (cd[0][0] * dx + cd[0][1] * dy) * kDeg;
+    const double v = (cd[1][0] * dx + cd[1][1] * dy) * kDeg;
+
+    double r[3], e[3], n[3];
+    radecToXyz(crval[0], crval[1], r);
+    tangentBasis(r, e, n);
+    double p[3];
+    for (int i = 0; i < 3; ++i)
+        p[i] = r[i] + u * e[i] + v * n[i];
+    const double norm = std::sqrt(p[0] * p[0] + p[1] * p[1] + p[2] * p[2]);
+
+    SkyPoint s;
+    s.raDeg = std::atan2(p[1], p[0]) / kDeg;
+    if (s.raDeg < 0.0)
+        s.raDeg += 360.0;
+    s.decDeg = std::asin(std::max(-1.0, std::min(1.0, p[2] / norm))) / kDeg;
+    return s;
+}
+
+bool TanWcs::skyToPixel(double raDeg, double decDeg, double* x, double* y) const
+{
+    double r[3], e[3], n[3], p[3];
+    radecToXyz(crval[0], crval[1], r);
+    tangentBasis(r, e, n);
+    radecToXyz(raDeg, decDeg, p);
+    const double w = p[0] * r[0] + p[1] * r[1] + p[2] * r[2];
+    if (w <= 0.0)
+        return false;
+    const double u = (p[0] * e[0] + p[1] * e[1] + p[2] * e[2]) / w / kDeg;
+    const double v = (p[0] * n[0] + p[1] * n[1] + p[2] * n[2]) / w / kDeg;
+
+    const double det = cd[0][0] * cd[1][1] - cd[0][1] * cd[1][0];
+    if (det == 0.0)
+        return false;
+    *x = crpix[0] + (cd[1][1] * u - cd[0][1] * v) / det;
+    *y = crpix[1] + (-cd[1][0] * u + cd[0][0] * v) / det;
+    return true;
+}
+
+double TanWcs::pixelScaleArcsec() const
+{
+    return std::sqrt(std::fabs(cd[0][0] * cd[1][1] - cd[0][1] * cd[1][0])) * 3600.0;
+}
+
+double TanWcs::orientationDeg() const
+{
+    const double det = cd[0][0] * cd[1][1] - cd[0][1] * cd[1][0];
+    const double parity = det >= 0.0 ? 1.0 : -1.0;
+    const double t = parity * cd[0][0] + cd[1][1];
+    const double a = parity * cd[1][0] - cd[0][1];
+    return -std::atan2(a, t) / kDeg;
+}
+
+bool TanWcs::mirrored() const
+{
+    return cd[0][0] * cd[1][1] - cd[0][1] * cd[1][0] > 0.0;
+}
+
+TanWcs TanWcs::fromSolution(double raDeg, double decDeg, double orientationDeg, double pixelScaleArcsec,
+                            bool mirrored, int imageWidth, int imageHeight)
+{
+    // orientationDeg() 的逆：atan2(A, T) = -orientation
+    TanWcs w;
+    const double s = pixelScaleArcsec / 3600.0;
+    const double phi = -orientationDeg * kDeg;
+    const double c = std::cos(phi);
+    const double sn = std::sin(phi);
+    if (mirrored) {
+        w.cd[0][0] = s * c;
+        w.cd[0][1] = -s * sn;
+        w.cd[1][0] = s * sn;
+        w.cd[1][1] = s * c;
+    } else {
+        w.cd[0][0] = -s * c;
+        w.cd[0][1] = -s * sn;
+        w.cd[1][0] = -s * sn;
+        w.cd[1][1] = s * c;
+    }
+    w.crval[0] = raDeg;
+    w.crval[1] = decDeg;
+    w.crpix[0] = 0.5 + imageWidth / 2.0;
+    w.crpix[1] = 0.5 + imageHeight / 2.0;
+    w.imageWidth = imageWidth;
+    w.imageHeight = imageHeight;
+    return w;
+}
+
+double angularSeparationDeg(double ra1Deg, double dec1Deg, double ra2Deg, double dec2Deg)
+{
+    double a[3], b[3];
+    radecToXyz(ra1Deg, dec1Deg, a);
+    radecToXyz(ra2Deg, dec2Deg, b);
+    const double cx = a[1] * b[2] - a[2] * b[1];
+    const double cy = a[2] * b[0] - a[0] * b[2];
+    const double cz = a[0] * b[1] - a[1] * b[0];
+    const double dot = a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+    return std::atan2(std::sqrt(cx * cx + cy * cy + cz * cz), dot) / kDeg;
+}
+
+bool writeWcsFile(const std::string& path, const TanWcs& wcs, std::string* error)
+{
+    // 手写最小 FITS 主头（NAXIS=0），与 solve-field 产出的 .wcs 关键字一致
+    std::string h;
+    h += fits::card("SIMPLE", "T", "Standard FITS file");
+    h += fits::card("BITPIX", "8");
+    h += fits::card("NAXIS", "0", "No image data");
+    h += fits::card("EXTEND", "T");
+    h += fits::card("WCSAXES", "2");
+    h += fits::card("CTYPE1", fits::quoted("RA---TAN"), "TAN (gnomic) projection");
+    h += fits::card("CTYPE2", fits::quoted("DEC--TAN"), "TAN (gnomic) projection");
+    h += fits::card("EQUINOX", "2000.0", "Equatorial coordinates definition (yr)");
+    h += fits::card("LONPOLE", "180.0");
+    h += fits::card("LATPOLE", "0.0");
+    h += fits::card("CRVAL1", fits::number(wcs.crval[0]), "RA  of reference point");
+    h += fits::card("CRVAL2", fits::number(wcs.crval[1]), "DEC of reference point");
+    h += fits::card("CRPIX1", fits::number(wcs.crpix[0]), "X reference pixel");
+    h += fits::card("CRPIX2", fits::number(wcs.crpix[1]), "Y reference pixel");
+    h += fits::card("CUNIT1", fits::quoted("deg"), "X pixel scale units");
+    h += fits::card("CUNIT2", fits::quoted("deg"), "Y pixel scale units");
+    h += fits::card("CD1_1", fits::number(wcs.cd[0][0]), "Transformation matrix");
+    h += fits::card("CD1_2", fits::number(wcs.cd[0][1]));
+    h += fits::card("CD2_1", fits::number(wcs.cd[1][0]));
+    h += fits::card("CD2_2", fits::number(wcs.cd[1][1]));
+    h += fits::card("IMAGEW", std::to_string(wcs.imageWidth), "Image width,  in pixels.");
+    h += fits::card("IMAGEH", std::to_string(wcs.imageHeight), "Image height, in pixels.");
+    fits::finishHeader(h);
+
+    const std::string tmp = path + ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        if (!out || !out.write(h.data(), static_cast<std::streamsize>(h.size()))) {
+            if (error)
+                *error = "write " + tmp + ": " + std::strerror(errno);
+            return false;
+        }
+    }
+    if (std::rename(tmp.c_str(), path.c_str()) != 0) {
+        if (error)
+            *error = "rename " + path + ": " + std::strerror(errno);
+        std::remove(tmp.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool readWcsFile(const std::string& path, TanWcs* wcs, std::string* error)
+{
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        if (error)
+            *error = "open " + path + ": " + std::strerror(errno);
+        return false;
+    }
+    std::map<std::string, double> values;
+    char card[80];
+    bool ended = false;
+    while (!ended && in.read(card, sizeof(card))) {
+        const std::string c(card, sizeof(card));
+        std::string key = c.substr(0, 8);
+        key.erase(key.find_last_not_of(' ') + 1);
+        if (key == "END") {
+            ended = true;
+        } else if (c.compare(8, 2, "= ") == 0 && c[10] != '\'') {
+            char* end = nullptr;
+            const std::string v = c.substr(10, 70);
+            const double d = std::strtod(v.c_str(), &end);
+            if (end != v.c_str())
+                values[key] = d;
+        }
+    }
+    const char* required[] = {"CRVAL1", "CRVAL2", "CRPIX1", "CRPIX2", "CD1_1", "CD1_2", "CD2_1", "CD2_2"};
+    for (const char* k : required) {
+        if (!values.count(k)) {
+            if (error)
+                *error = std::string(k) + " missing in " + path;
+            return false;
+        }
+    }
+    TanWcs w;
+    w.crval[0] = values["CRVAL1"];
+    w.crval[1] = values["CRVAL2"];
+    w.crpix[0] = values["CRPIX1"];
+    w.crpix[1] = values["CRPIX2"];
+    w.cd[0][0] = values["CD1_1"];
+    w.cd[0][1] = values["CD1_2"];
+    w.cd[1][0] = values["CD2_1"];
+    w.cd[1][1] = values["CD2_2"];
+    w.imageWidth = values.count("IMAGEW") ? static_cast<int>(values["IMAGEW"]) : 0;
+    w.imageHeight = values.count("IMAGEH") ? static_cast<int>(values["IMAGEH"]) : 0;
+    if (!w.valid()) {
+        if (error)
+            *error = "degenerate CD in " + path;
+        return false;
+    }
+    *wcs = w;
+    return true;
+}
+
+} // namespace solver
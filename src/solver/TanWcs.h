@@ -0,0 +1,51 @@
+#pragma once
+
+#include <string>
+
+namespace solver {
+
+// 天球坐标（度）
+struct SkyPoint {
+    double raDeg{0.0};
+    double decDeg{0.0};
+};
+
+// TAN（日心/切平面投影）WCS，约定与 astrometry.net 的 tan_t 相同：
+// - 像素坐标为 FITS 1 基（左下像素中心为 (1,1)）
+// - 中间世界坐标 (u,v)（度）= CD * (pixel - CRPIX)，u 指向东、v 指向北
+struct TanWcs {
+    double crval[2]{0.0, 0.0}; ///< 切点 RA/DEC（度）
+    double crpix[2]{0.0, 0.0}; ///< 切点像素（1 基）
+    double cd[2][2]{{0.0, 0.0}, {0.0, 0.0}}; ///< 度/像素
+    int imageWidth{0};
+    int imageHeight{0};
+
+    bool valid() const;
+
+    SkyPoint pixelToSky(double x, double y) const;
+    // 点在切平面背面（离切点 >90°）时返回 false
+    bool skyToPixel(double raDeg, double decDeg, double* x, double* y) const;
+
+    double pixelScaleArcsec() const;
+    // 与 astrometry.net tan_get_orientation 相同（wcsinfo 的 orientation）
+    double orientationDeg() const;
+    // CD 行列式 > 0：相对正常天空视图左右镜像
+    bool mirrored() const;
+    double fieldWidthDeg() const { return imageWidth * pixelScaleArcsec() / 3600.0; }
+    double fieldHeightDeg() const { return imageHeight * pixelScaleArcsec() / 3600.0; }
+
+    // 由解算摘要（中心、方向、像素尺度、镜像）构造：切点放在图像中心
+    static TanWcs fromSolution(double raDeg, double decDeg, double orientationDeg, double pixelScaleArcsec,
+                               bool mirrored, int imageWidth, int imageHeight);
+};
+
+// 两点的球面角距（度）
+double angularSeparationDeg(double ra1Deg, double dec1Deg, double ra2Deg, double dec2Deg);
+
+// 写成 astrometry.net 兼容的 .wcs（仅头的 FITS 文件，含 IMAGEW/IMAGEH），wcsinfo/wcs-xy2rd 可直接读取
+bool writeWcsFile(const std::string& path, const TanWcs& wcs, std::string* error = nullptr);
+
+// 读取 .wcs（solve-field 或 writeWcsFile 产物）的 TAN 部分：CRVAL/CRPIX/CD 与 IMAGEW/IMAGEH；SIP 项忽略
+bool readWcsFile(const std::string& path, TanWcs* wcs, std::string* error = nullptr);
+
+} // namespace solver
@@ -0,0 +1,503 @@
+#include "TrackingSolver.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <limits>
+#include <numeric>
+
+namespace solver {
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+constexpr double kDeg = kPi / 180.0;
+
+struct Point {
+    double x{0.0};
+    double y{0.0};
+};
+
+// 2 维 k-d 树（隐式存储在下标数组里），只支持半径内最近邻
+class KdTree
+{
+public:
+    explicit KdTree(const std::vector<Point>& points)
+        : m_points(points), m_index(points.size())
+    {
+        std::iota(m_index.begin(), m_index.end(), 0);
+        build(0, m_index.size(), 0);
+    }
+
+    // 返回 radius 内最近点的下标，没有返回 -1
+    int nearest(double x, double y, double radius, double* dist2 = nullptr) const
+    {
+        int best = -1;
+        double bestD2 = radius * radius;
+        search(0, m_index.size(), 0, x, y, best, bestD2);
+        if (dist2 && best >= 0)
+            *dist2 = bestD2;
+        return best;
+    }
+
+private:
+    void build(size_t lo, size_t hi, int axis)
+    {
+        if (hi - lo <= 1)
+            return;
+        const size_t mid = lo + (hi - lo) / 2;
+        std::nth_element(m_index.begin() + lo, m_index.begin() + mid, m_index.begin() + hi, [&](int a, int b) {
+            return axis == 0 ? m_points[a].x < m_points[b].x : m_points[a].y < m_points[b].y;
+        });
+        build(lo, mid, axis ^ 1);
+        build(mid + 1, hi, axis ^ 1);
+    }
+
+    void search(size_t lo, size_t hi, int axis, double x, double y, int& best, double& bestD2) const
+    {
+        if (lo >= hi)
+            return;
+        const size_t mid = lo + (hi - lo) / 2;
+        const Point& p = m_points[m_index[mid]];
+        const double dx = p.x - x;
+        const double dy = p.y - y;
+        const double d2 = dx * dx + dy * dy;
+        if (d2 < bestD2) {
+            bestD2 = d2;
+            best = m_index[mid];
+        }
+        const double split = axis == 0 ? x - p.x : y - p.y;
+        const bool leftFirst = split < 0.0;
+        search(leftFirst ? lo : mid + 1, leftFirst ? mid : hi, axis ^ 1, x, y, best, bestD2);
+        if (split * split < bestD2)
+            search(leftFirst ? mid + 1 : lo, leftFirst ? hi : mid, axis ^ 1, x, y, best, bestD2);
+    }
+
+    const std::vector<Point>& m_points;
+    std::vector<int> m_index;
+};
+
+// 检测星点 -> 参考像素面的相似变换
+struct Similarity {
+    double scale{1.0};
+    double cosT{1.0};
+    double sinT{0.0};
+    double tx{0.0};
+    double ty{0.0};
+
+    Point apply(const Point& p) const
+    {
+        return {scale * (cosT * p.x - sinT * p.y) + tx, scale * (sinT * p.x + cosT * p.y) + ty};
+    }
+};
+
+// 以 tangent 为切点、CD 为单位阵的 TAN：像素坐标即中间世界坐标（度）
+TanWcs tangentFrame(double raDeg, double decDeg)
+{
+    TanWcs t;
+    t.crval[0] = raDeg;
+    t.crval[1] = decDeg;
+    t.cd[0][0] = 1.0;
+    t.cd[1][1] = 1.0;
+    return t;
+}
+
+// 3x3 对称方程组（Cramer），奇异返回 false
+bool solve3(const double m[3][3], const double b[3], double out[3])
+{
+    const double det = m[0][0] * (m[1][1] * m[2][2] - m[1][2] * m[2][1]) -
+                       m[0][1] * (m[1][0] * m[2][2] - m[1][2] * m[2][0]) +
+                       m[0][2] * (m[1][0] * m[2][1] - m[1][1] * m[2][0]);
+    if (!std::isfinite(det) || std::fabs(det) < 1e-12)
+        return false;
+    for (int k = 0; k < 3; ++k) {
+        double a[3][3];
+        for (int i = 0; i < 3; ++i)
+            for (int j = 0; j < 3; ++j)
+                a[i][j] = (j == k) ? b[i] : m[i][j];
+        out[k] = (a[0][0] * (a[1][1] * a[2][2] - a[1][2] * a[2][1]) - a[0][1] * (a[1][0] * a[2][2] - a[1][2] * a[2][0]) +
+                  a[0][2] * (a[1][0] * a[2][1] - a[1][1] * a[2][0])) /
+                 det;
+    }
+    return true;
+}
+
+struct Match {
+    Point pixel;    // 检测星点（1 基）
+    SkyStar sky;
+};
+
+// 固定 CRPIX，迭代拟合 CD 与切点：u = a*dx + b*dy + c，v = d*dx + e*dy + f，再把切点移到 (c,f)
+bool fitTan(const std::vector<Match>& matches, const TanWcs& start, TanWcs* out)
+{
+    TanWcs w = start;
+    for (int iter = 0; iter < 4; ++iter) {
+        const TanWcs frame = tangentFrame(w.crval[0], w.crval[1]);
+        double m[3][3] = {{0, 0, 0}, {0, 0, 0}, {0, 0, 0}};
+        double bu[3] = {0, 0, 0};
+        double bv[3] = {0, 0, 0};
+        for (const Match& mt : matches) {
+            double u = 0, v = 0;
+            if (!frame.skyToPixel(mt.sky.raDeg, mt.sky.decDeg, &u, &v))
+                return false;
+            const double r[3] = {mt.pixel.x - w.crpix[0], mt.pixel.y - w.crpix[1], 1.0};
+            for (int i = 0; i < 3; ++i) {
+                for (int j = 0; j < 3; ++j)
+                    m[i][j] += r[i] * r[j];
+                bu[i] += r[i] * u;
+                bv[i] += r[i] * v;
+            }
+        }
+        double pu[3], pv[3];
+        if (!solve3(m, bu, pu) || !solve3(m, bv, pv))
+            return false;
+        w.cd[0][0] = pu[0];
+        w.cd[0][1] = pu[1];
+        w.cd[1][0] = pv[0];
+        w.cd[1][1] = pv[1];
+        const SkyPoint c = frame.pixelToSky(pu[2], pv[2]);
+        w.crval[0] = c.raDeg;
+        w.crval[1] = c.decDeg;
+        if (std::hypot(pu[2], pv[2]) < 1e-10)
+            break;
+    }
+    if (!w.valid())
+        return false;
+    *out = w;
+    return true;
+}
+
+double residualRms(const std::vector<Match>& matches, const TanWcs& w, std::vector<double>* residuals)
+{
+    double sum = 0.0;
+    if (residuals)
+        residuals->assign(matches.size(), std::numeric_limits<double>::infinity());
+    for (size_t i = 0; i < matches.size(); ++i) {
+        double x = 0, y = 0;
+        if (!w.skyToPixel(matches[i].sky.raDeg, matches[i].sky.decDeg, &x, &y))
+            return std::numeric_limits<double>::infinity();
+        const double r = std::hypot(x - matches[i].pixel.x, y - matches[i].pixel.y);
+        if (residuals)
+            (*residuals)[i] = r;
+        sum += r * r;
+    }
+    return matches.empty() ? 0.0 : std::sqrt(sum / matches.size());
+}
+
+double elapsedMs(std::chrono::steady_clock::time_point since)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - since).count();
+}
+
+} // namespace
+
+bool StarCatalog::loadCsv(const std::string& path, double maxMag, std::string* error)
+{
+    std::ifstream in(path);
+    if (!in) {
+        if (error)
+            *error = "cannot open " + path;
+        return false;
+    }
+    std::string line;
+    std::getline(in, line);
+    size_t loaded = 0;
+    while (std::getline(in, line)) {
+        const size_t p1 = line.find(',');
+        const size_t p2 = p1 == std::string::npos ? p1 : line.find(',', p1 + 1);
+        const size_t p3 = p2 == std::string::npos ? p2 : line.find(',', p2 + 1);
+        if (p3 == std::string::npos)
+            continue;
+        char* end = nullptr;
+        SkyStar s;
+        s.raDeg = std::strtod(line.c_str() + p1 + 1, &end);
+        if (end != line.c_str() + p2)
+            continue;
+        s.decDeg = std::strtod(line.c_str() + p2 + 1, &end);
+        if (end != line.c_str() + p3)
+            continue;
+        s.mag = std::strtod(line.c_str() + p3 + 1, &end);
+        if (end == line.c_str() + p3 + 1 || !std::isfinite(s.raDeg) || !std::isfinite(s.decDeg) || s.mag > maxMag)
+            continue;
+        add(s);
+        ++loaded;
+    }
+    if (loaded == 0 && error)
+        *error = "no stars in " + path;
+    return loaded > 0;
+}
+
+void StarCatalog::add(const SkyStar& star)
+{
+    m_stars.push_back(star);
+    const double ra = star.raDeg * kDeg;
+    const double dec = star.decDeg * kDeg;
+    m_xyz.push_back({std::cos(dec) * std::cos(ra), std::cos(dec) * std::sin(ra), std::sin(dec)});
+}
+
+std::vector<SkyStar> StarCatalog::cone(double raDeg, double decDeg, double radiusDeg) const
+{
+    const double ra = raDeg * kDeg;
+    const double dec = decDeg * kDeg;
+    const double c[3] = {std::cos(dec) * std::cos(ra), std::cos(dec) * std::sin(ra), std::sin(dec)};
+    const double minDot = std::cos(radiusDeg * kDeg);
+    std::vector<SkyStar> out;
+    for (size_t i = 0; i < m_xyz.size(); ++i) {
+        if (m_xyz[i][0] * c[0] + m_xyz[i][1] * c[1] + m_xyz[i][2] * c[2] >= minDot)
+            out.push_back(m_stars[i]);
+    }
+    std::sort(out.begin(), out.end(), [](const SkyStar& a, const SkyStar& b) { return a.mag < b.mag; });
+    return out;
+}
+
+TrackingSession::TrackingSession(TrackingOptions options)
+    : m_options(options)
+{
+}
+
+void TrackingSession::reset()
+{
+    m_hasPrior = false;
+    m_prior = TanWcs();
+    m_refs.clear();
+    m_usingCatalog = false;
+    m_trackedFrames = 0;
+}
+
+void TrackingSession::anchor(const TanWcs& wcs, const XyList& stars, const StarCatalog* catalog)
+{
+    reset();
+    if (!wcs.valid() || wcs.imageWidth <= 0 || wcs.imageHeight <= 0)
+        return;
+    m_prior = wcs;
+    m_hasPrior = true;
+
+    // 视场外留出可平移的余量，旋转/平移后进入画面的星也能参与匹配
+    const double marginPx = std::min(m_options.maxShiftPx, 0.5 * std::max(wcs.imageWidth, wcs.imageHeight));
+    auto inReach = [&](double raDeg, double decDeg) {
+        double x = 0, y = 0;
+        return wcs.skyToPixel(raDeg, decDeg, &x, &y) && x > 0.5 - marginPx && y > 0.5 - marginPx &&
+               x < wcs.imageWidth + 0.5 + marginPx && y < wcs.imageHeight + 0.5 + marginPx;
+    };
+
+    if (catalog && catalog->size() > 0) {
+        const SkyPoint center = wcs.pixelToSky(wcs.crpix[0], wcs.crpix[1]);
+        const double halfDiagPx = 0.5 * std::hypot(wcs.imageWidth, wcs.imageHeight) + marginPx;
+        const double radiusDeg = halfDiagPx * wcs.pixelScaleArcsec() / 3600.0;
+        for (const SkyStar& s : catalog->cone(center.raDeg, center.decDeg, radiusDeg)) {
+            if (!inReach(s.raDeg, s.decDeg))
+                continue;
+            m_refs.push_back(s);
+            if (m_refs.size() >= m_options.maxRefStars)
+                break;
+        }
+        m_usingCatalog = m_refs.size() >= 2 * m_options.minMatches;
+        if (!m_usingCatalog)
+            m_refs.clear();
+    }
+
+    if (m_refs.empty()) {
+        // 自举：锚定帧自身的星点（0 基）经 WCS 换算到天球
+        for (const XyStar& s : stars.stars) {
+            const SkyPoint p = wcs.pixelToSky(s.x + 1.0, s.y + 1.0);
+            m_refs.push_back({p.raDeg, p.decDeg, -2.5 * std::log10(std::max(s.flux, 1e-12))});
+            if (m_refs.size() >= m_options.maxRefStars)
+                break;
+        }
+    }
+}
+
+bool TrackingSession::needsFullSolve() const
+{
+    if (!m_hasPrior || m_refs.size() < m_options.minMatches)
+        return true;
+    return m_options.reanchorEvery > 0 && m_trackedFrames >= m_options.reanchorEvery;
+}
+
+TrackingResult TrackingSession::track(const XyList& stars)
+{
+    const auto t0 = std::chrono::steady_clock::now();
+    TrackingResult result;
+    result.references = m_refs.size();
+    auto fail = [&](const std::string& why) {
+        result.error = why;
+        result.elapsedMs = elapsedMs(t0);
+        return result;
+    };
+    if (!m_hasPrior)
+        return fail("no prior");
+    if (stars.stars.size() < m_options.minMatches)
+        return fail("too few stars");
+
+    // 参考星按上一帧 WCS 投影到像素面（1 基），顺序保持最亮在前
+    std::vector<Point> refPx;
+    std::vector<size_t> refIdx;
+    for (size_t i = 0; i < m_refs.size(); ++i) {
+        double x = 0, y = 0;
+        if (m_prior.skyToPixel(m_refs[i].raDeg, m_refs[i].decDeg, &x, &y)) {
+            refPx.push_back({x, y});
+            refIdx.push_back(i);
+        }
+    }
+    if (refPx.size() < m_options.minMatches)
+        return fail("too few references in reach");
+    const KdTree tree(refPx);
+
+    std::vector<Point> det;
+    det.reserve(stars.stars.size());
+    for (const XyStar& s : stars.stars)
+        det.push_back({s.x + 1.0, s.y + 1.0});
+    const size_t verifyN = std::min(det.size(), m_options.verifyStars);
+    const double radius = m_options.matchRadiusPx;
+
+    auto score = [&](const Similarity& t, double* sumD2) {
+        size_t n = 0;
+        double sum = 0.0;
+        for (size_t k = 0; k < verifyN; ++k) {
+            const Point q = t.apply(det[k]);
+            double d2 = 0.0;
+            if (tree.nearest(q.x, q.y, radius, &d2) >= 0) {
+                ++n;
+                sum += d2;
+            }
+        }
+        *sumD2 = sum;
+        return n;
+    };
+
+    // 假设 0：先验本身就对
+    Similarity best;
+    double bestSum = 0.0;
+    size_t bestScore = score(best, &bestSum);
+    const size_t goodEnough = std::max(m_options.minMatches, (verifyN * 4) / 5);
+
+    if (bestScore < goodEnough) {
+        // 星点对 (i,j) 与参考星对 (a,b) 长度一致时确定一个相似变换
+        const size_t hd = std::min(det.size(), m_options.hypothesisStars);
+        const size_t hr = std::min(refPx.size(), 4 * m_options.hypothesisStars);
+        struct RefPair {
+            double len;
+            int a;
+            int b;
+        };
+        std::vector<RefPair> refPairs;
+        for (size_t a = 0; a < hr; ++a)
+            for (size_t b = 0; b < hr; ++b)
+                if (a != b)
+                    refPairs.push_back({std::hypot(refPx[b].x - refPx[a].x, refPx[b].y - refPx[a].y), int(a), int(b)});
+        std::sort(refPairs.begin(), refPairs.end(), [](const RefPair& l, const RefPair& r) { return l.len < r.len; });
+
+        const double maxRot = m_options.maxRotationDeg * kDeg;
+        const double cx = 0.5 * (m_prior.imageWidth + 1);
+        const double cy = 0.5 * (m_prior.imageHeight + 1);
+        const double minLen = 4.0 * radius;
+        for (size_t i = 0; i < hd && bestScore < goodEnough; ++i) {
+            for (size_t j = i + 1; j < hd && bestScore < goodEnough; ++j) {
+                const double dx = det[j].x - det[i].x;
+                const double dy = det[j].y - det[i].y;
+                const double len = std::hypot(dx, dy);
+                if (len < minLen)
+                    continue;
+                const double tol = len * m_options.maxScaleChange + radius;
+                auto it = std::lower_bound(refPairs.begin(), refPairs.end(), len - tol,
+                                           [](const RefPair& p, double v) { return p.len < v; });
+                for (; it != refPairs.end() && it->len <= len + tol; ++it) {
+                    const Point& pa = refPx[it->a];
+                    const Point& pb = refPx[it->b];
+                    double rot = std::atan2(pb.y - pa.y, pb.x - pa.x) - std::atan2(dy, dx);
+                    rot = std::remainder(rot, 2.0 * kPi);
+                    if (std::fabs(rot) > maxRot)
+                        continue;
+                    Similarity t;
+                    t.scale = it->len / len;
+                    t.cosT = std::cos(rot);
+                    t.sinT = std::sin(rot);
+                    const Point ri = Similarity{t.scale, t.cosT, t.sinT, 0.0, 0.0}.apply(det[i]);
+                    t.tx = pa.x - ri.x;
+                    t.ty = pa.y - ri.y;
+                    const Point c = t.apply({cx, cy});
+                    if (std::hypot(c.x - cx, c.y - cy) > m_options.maxShiftPx)
+                        continue;
+                    double sum = 0.0;
+                    const size_t s = score(t, &sum);
+                    if (s > bestScore || (s == bestScore && sum < bestSum)) {
+                        best = t;
+                        bestScore = s;
+                        bestSum = sum;
+                    }
+                }
+            }
+        }
+    }
+    if (bestScore < m_options.minMatches)
+        return fail("no consistent match (best " + std::to_string(bestScore) + ")");
+
+    // 在最佳变换下为全部星点找对应，每颗参考星只保留最近的一个星点
+    std::vector<int> ownerOfRef(refPx.size(), -1);
+    std::vector<double> ownerDist(refPx.size(), std::numeric_limits<double>::infinity());
+    for (size_t k = 0; k < det.size(); ++k) {
+        const Point q = best.apply(det[k]);
+        double d2 = 0.0;
+        const int r = tree.nearest(q.x, q.y, radius, &d2);
+        if (r >= 0 && d2 < ownerDist[r]) {
+            ownerOfRef[r] = int(k);
+            ownerDist[r] = d2;
+        }
+    }
+    std::vector<Match> matches;
+    for (size_t r = 0; r < refPx.size(); ++r)
+        if (ownerOfRef[r] >= 0)
+            matches.push_back({det[ownerOfRef[r]], m_refs[refIdx[r]]});
+    if (matches.size() < m_options.minMatches)
+        return fail("too few unique matches");
+
+    TanWcs fitted;
+    if (!fitTan(matches, m_prior, &fitted))
+        return fail("least-squares fit failed");
+    std::vector<double> residuals;
+    double rms = residualRms(matches, fitted, &residuals);
+
+    // 一轮 3σ 剔除后重拟
+    const double clip = std::max(3.0 * rms, 0.5);
+    std::vector<Match> kept;
+    for (size_t i = 0; i < matches.size(); ++i)
+        if (residuals[i] <= clip)
+            kept.push_back(matches[i]);
+    if (kept.size() < matches.size() && kept.size() >= m_options.minMatches) {
+        TanWcs refit;
+        if (fitTan(kept, fitted, &refit)) {
+            fitted = refit;
+            matches.swap(kept);
+            rms = residualRms(matches, fitted, nullptr);
+        }
+    }
+
+    result.matched = matches.size();
+    result.rmsPx = rms;
+    fitted.imageWidth = m_prior.imageWidth;
+    fitted.imageHeight = m_prior.imageHeight;
+    if (!(rms <= m_options.maxRmsPx))
+        return fail("rms " + std::to_string(rms) + " px too large");
+    const double scaleRatio = fitted.pixelScaleArcsec() / m_prior.pixelScaleArcsec();
+    if (std::fabs(scaleRatio - 1.0) > m_options.maxScaleChange)
+        return fail("scale changed by " + std::to_string((scaleRatio - 1.0) * 100.0) + "%");
+    if (fitted.mirrored() != m_prior.mirrored())
+        return fail("parity flipped");
+
+    double px = 0, py = 0;
+    const SkyPoint newCenter = fitted.pixelToSky(fitted.crpix[0], fitted.crpix[1]);
+    if (m_prior.skyToPixel(newCenter.raDeg, newCenter.decDeg, &px, &py))
+        result.shiftPx = std::hypot(px - m_prior.crpix[0], py - m_prior.crpix[1]);
+    result.rotationDeg = std::remainder(fitted.orientationDeg() - m_prior.orientationDeg(), 360.0);
+    result.wcs = fitted;
+    result.ok = true;
+
+    m_prior = fitted;
+    ++m_trackedFrames;
+    result.elapsedMs = elapsedMs(t0);
+    return result;
+}
+
+} // namespace solver
@@ -0,0 +1,93 @@
+#pragma once
+
+#include "TanWcs.h"
+#include "XyList.h"
+
+#include <array>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace solver {
+
+// 参考星（度、星等）
+struct SkyStar {
+    double raDeg{0.0};
+    double decDeg{0.0};
+    double mag{0.0};
+};
+
+// 本地星表（CSV：表头一行，之后 id,ra,dec,mag，与 polemaster_simulation/hip_catalog.csv 相同）
+class StarCatalog
+{
+public:
+    bool loadCsv(const std::string& path, double maxMag, std::string* error = nullptr);
+    void add(const SkyStar& star);
+    size_t size() const { return m_stars.size(); }
+    // 以 (raDeg, decDeg) 为中心、radiusDeg 内的星，按星等升序（最亮在前）
+    std::vector<SkyStar> cone(double raDeg, double decDeg, double radiusDeg) const;
+
+private:
+    std::vector<SkyStar> m_stars;
+    std::vector<std::array<double, 3>> m_xyz;
+};
+
+struct TrackingOptions {
+    double matchRadiusPx{4.0};     ///< 星点与投影参考星的匹配半径
+    double maxShiftPx{400.0};      ///< 相对上一帧 WCS 允许的最大平移
+    double maxRotationDeg{15.0};   ///< 允许的最大旋转
+    double maxScaleChange{0.02};   ///< 允许的像素尺度相对变化
+    size_t minMatches{8};
+    double maxRmsPx{1.5};
+    size_t hypothesisStars{12};    ///< 用最亮的若干星点两两配对生成变换假设
+    size_t verifyStars{60};        ///< 假设打分用的星点数
+    size_t maxRefStars{250};
+    int reanchorEvery{30};         ///< 连续跟踪这么多帧后要求一次完整解析（0 表示不限）
+};
+
+struct TrackingResult {
+    bool ok{false};
+    std::string error;
+    TanWcs wcs;
+    size_t matched{0};
+    size_t references{0};
+    double rmsPx{0.0};
+    double shiftPx{0.0};       ///< 图像中心相对上一帧的位移
+    double rotationDeg{0.0};   ///< 相对上一帧的旋转
+    double elapsedMs{0.0};
+};
+
+// 近先验跟踪解析：
+// - anchor() 在完整解析成功后调用：以该帧 WCS 为先验，从本地星表取视场内的参考星；
+//   星表缺失或星太少时改用该帧自己的星点（经 WCS 换算到天球）作为参考
+// - track() 把参考星按上一帧 WCS 投影到像素面，用 k-d 树 + 星点对生成的相似变换假设找对应，
+//   再以最小二乘重拟 TAN WCS（CD + 切点），检查匹配数/残差/尺度后更新先验
+// - 参考星始终来自锚定帧或星表，逐帧跟踪不累积误差
+class TrackingSession
+{
+public:
+    explicit TrackingSession(TrackingOptions options = TrackingOptions());
+
+    void reset();
+    void anchor(const TanWcs& wcs, const XyList& stars, const StarCatalog* catalog);
+    bool hasPrior() const { return m_hasPrior; }
+    // 没有先验或连续跟踪帧数已达上限时需要完整解析
+    bool needsFullSolve() const;
+    TrackingResult track(const XyList& stars);
+
+    const TanWcs& prior() const { return m_prior; }
+    size_t referenceCount() const { return m_refs.size(); }
+    bool usingCatalog() const { return m_usingCatalog; }
+    int trackedFrames() const { return m_trackedFrames; }
+    const TrackingOptions& options() const { return m_options; }
+
+private:
+    TrackingOptions m_options;
+    bool m_hasPrior{false};
+    TanWcs m_prior;
+    std::vector<SkyStar> m_refs;
+    bool m_usingCatalog{false};
+    int m_trackedFrames{0};
+};
+
+} // namespace solver
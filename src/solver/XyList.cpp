@@ -0,0 +1,112 @@
+#include "XyList.h"
+#include "FitsHeader.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+
+namespace solver {
+
+namespace {
+
+// FITS 二进制表为大端
+void appendFloatBE(std::string& out, double value)
+{
+    const float f = static_cast<float>(value);
+    uint32_t bits = 0;
+    std::memcpy(&bits, &f, sizeof(bits));
+    const char bytes[4] = {static_cast<char>(bits >> 24), static_cast<char>(bits >> 16), static_cast<char>(bits >> 8),
+                           static_cast<char>(bits)};
+    out.append(bytes, 4);
+}
+
+} // namespace
+
+XyList prepareXyList(std::vector<XyStar> stars, int imageWidth, int imageHeight, size_t maxStars)
+{
+    XyList list;
+    list.imageWidth = imageWidth;
+    list.imageHeight = imageHeight;
+    stars.erase(std::remove_if(stars.begin(), stars.end(),
+                               [&](const XyStar& s) {
+                                   return !std::isfinite(s.x) || !std::isfinite(s.y) || !std::isfinite(s.flux) ||
+                                          s.flux <= 0.0 || s.x < -0.5 || s.y < -0.5 || s.x > imageWidth - 0.5 ||
+                                          s.y > imageHeight - 0.5;
+                               }),
+                stars.end());
+    // 通量相同按坐标排，保证同一输入得到同一星表
+    std::sort(stars.begin(), stars.end(), [](const XyStar& a, const XyStar& b) {
+        if (a.flux != b.flux)
+            return a.flux > b.flux;
+        return a.y != b.y ? a.y < b.y : a.x < b.x;
+    });
+    if (maxStars > 0 && stars.size() > maxStars)
+        stars.resize(maxStars);
+    list.stars = std::move(stars);
+    return list;
+}
+
+bool writeXyList(const std::string& path, const XyList& list, std::string* error)
+{
+    std::string h;
+    h += fits::card("SIMPLE", "T", "Standard FITS file");
+    h += fits::card("BITPIX", "8");
+    h += fits::card("NAXIS", "0", "No image data");
+    h += fits::card("EXTEND", "T");
+    h += fits::card("IMAGEW", std::to_string(list.imageWidth), "Image width,  in pixels.");
+    h += fits::card("IMAGEH", std::to_string(list.imageHeight), "Image height, in pixels.");
+    fits::finishHeader(h);
+
+    const size_t rowBytes = 3 * 4;
+    h += fits::card("XTENSION", fits::quoted("BINTABLE"), "binary table extension");
+    h += fits::card("BITPIX", "8");
+    h += fits::card("NAXIS", "2");
+    h += fits::card("NAXIS1", std::to_string(rowBytes), "bytes per row");
+    h += fits::card("NAXIS2", std::to_string(list.stars.size()), "number of stars");
+    h += fits::card("PCOUNT", "0");
+    h += fits::card("GCOUNT", "1");
+    h += fits::card("TFIELDS", "3");
+    h += fits::card("TTYPE1", fits::quoted("X"), "1-based pixel");
+    h += fits::card("TFORM1", fits::quoted("E"));
+    h += fits::card("TUNIT1", fits::quoted("pix"));
+    h += fits::card("TTYPE2", fits::quoted("Y"), "1-based pixel");
+    h += fits::card("TFORM2", fits::quoted("E"));
+    h += fits::card("TUNIT2", fits::quoted("pix"));
+    h += fits::card("TTYPE3", fits::quoted("FLUX"));
+    h += fits::card("TFORM3", fits::quoted("E"));
+    h += fits::card("IMAGEW", std::to_string(list.imageWidth), "Image width,  in pixels.");
+    h += fits::card("IMAGEH", std::to_string(list.imageHeight), "Image height, in pixels.");
+    fits::finishHeader(h);
+
+    std::string data;
+    data.reserve(list.stars.size() * rowBytes + 2880);
+    for (const XyStar& s : list.stars) {
+        appendFloatBE(data, s.x + 1.0);
+        appendFloatBE(data, s.y + 1.0);
+        appendFloatBE(data, s.flux);
+    }
+    data.resize(((data.size() + 2879) / 2880) * 2880, '\0');
+
+    const std::string tmp = path + ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        if (!out || !out.write(h.data(), static_cast<std::streamsize>(h.size())) ||
+            !out.write(data.data(), static_cast<std::streamsize>(data.size()))) {
+            if (error)
+                *error = "write " + tmp + ": " + std::strerror(errno);
+            return false;
+        }
+    }
+    if (std::rename(tmp.c_str(), path.c_str()) != 0) {
+        if (error)
+            *error = "rename " + path + ": " + std::strerror(errno);
+        std::remove(tmp.c_str());
+        return false;
+    }
+    return true;
+}
+
+} // namespace solver
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace solver {
+
+// 星点（检测器坐标：0 基，像素中心在整数处）
+struct XyStar {
+    double x{0.0};
+    double y{0.0};
+    double flux{0.0};
+};
+
+// 交给求解器的星表：只做四边形匹配，不再重新提取
+struct XyList {
+    std::vector<XyStar> stars;  ///< 按 flux 降序
+    int imageWidth{0};
+    int imageHeight{0};
+
+    bool empty() const { return stars.empty(); }
+};
+
+// 丢弃非有限值/画面外/非正通量的点，按 flux 降序排序并只保留最亮的 maxStars 个（0 表示不限）
+XyList prepareXyList(std::vector<XyStar> stars, int imageWidth, int imageHeight, size_t maxStars);
+
+// 写成 astrometry.net xylist：主 HDU（NAXIS=0）+ BINTABLE(X,Y,FLUX)，带 IMAGEW/IMAGEH；
+// X/Y 转为 FITS 1 基，solve-field 直接读取（--x-column X --y-column Y --sort-column FLUX）
+bool writeXyList(const std::string& path, const XyList& list, std::string* error = nullptr);
+
+} // namespace solver
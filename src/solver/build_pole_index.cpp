@@ -0,0 +1,72 @@
+// 极冠星型索引生成：hip_catalog.csv → pole_index.bin（客户端从 QUARCS_POLE_INDEX 或 <prefix>/share/quarcs/ 读取）
+// CMake 配置了 QUARCS_HIP_CATALOG 时由 pole_index 目标自动生成并随 install 安装；
+// 手动构建：g++ -O2 -std=c++17 build_pole_index.cpp PoleIndex.cpp TrackingSolver.cpp TanWcs.cpp XyList.cpp -o build_pole_index
+//
+// 用法：build_pole_index <hip_catalog.csv> <pole_index.bin> [--cap 15] [--max-mag 9] [--min-field 3] [--max-field 16]
+
+#include "PoleIndex.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+namespace {
+
+void usage()
+{
+    std::cerr << "usage: build_pole_index <hip_catalog.csv> <pole_index.bin> [--cap deg] [--max-mag mag]"
+                 " [--min-field deg] [--max-field deg]"
+              << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    if (argc < 3) {
+        usage();
+        return 2;
+    }
+    const std::string catalogPath = argv[1];
+    const std::string outPath = argv[2];
+    solver::PoleIndexOptions options;
+    for (int i = 3; i + 1 < argc; i += 2) {
+        const double v = std::atof(argv[i + 1]);
+        if (std::strcmp(argv[i], "--cap") == 0)
+            options.capRadiusDeg = v;
+        else if (std::strcmp(argv[i], "--max-mag") == 0)
+            options.maxMag = v;
+        else if (std::strcmp(argv[i], "--min-field") == 0)
+            options.minFieldDeg = v;
+        else if (std::strcmp(argv[i], "--max-field") == 0)
+            options.maxFieldDeg = v;
+        else {
+            usage();
+            return 2;
+        }
+    }
+
+    solver::StarCatalog catalog;
+    std::string error;
+    if (!catalog.loadCsv(catalogPath, options.maxMag, &error)) {
+        std::cerr << error << std::endl;
+        return 1;
+    }
+
+    const auto t0 = std::chrono::steady_clock::now();
+    solver::PoleIndex index;
+    if (!index.build(catalog, options)) {
+        std::cerr << "no usable triangles in the polar caps of " << catalogPath << std::endl;
+        return 1;
+    }
+    const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    if (!index.save(outPath, &error)) {
+        std::cerr << error << std::endl;
+        return 1;
+    }
+    std::cout << outPath << ": " << index.starCount() << " stars, " << index.triangleCount() << " triangles, "
+              << index.bytes() / 1024 << " KiB (built in " << ms << " ms)" << std::endl;
+    return 0;
+}
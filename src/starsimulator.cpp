@@ -13,6 +13,7 @@ StarSimulator::StarSimulator(QObject *parent)
     : QObject(parent)
     , m_noiseLevel(0.005) // 进一步降低默认噪声水平
     , m_atmosphericTurbulence(0.05) // 进一步降低默认大气扰动
+    , m_frameIndex(0)
     , m_totalStarsGenerated(0)
     , m_validStarsGenerated(0)
     , m_randomGenerator(new QRandomGenerator())
@@ -358,40 +359,30 @@ QImage StarSimulator::generateImage(const StarImageParams &params)
             return QImage();
         }
         
-        // 创建16位灰度图像
+        // 创建16位灰度图像，渲染器直接写扫描行
         QImage image(params.imageWidth, params.imageHeight, QImage::Format_Grayscale16);
         if (image.isNull()) {
             log("错误：无法创建图像");
             return QImage();
         }
         
-        image.fill(0); // 黑色背景
+        const double exposure = qMax(0.001, params.exposureTime);
+        sim::SkyRenderOptions options;
+        options.width = params.imageWidth;
+        options.height = params.imageHeight;
+        options.backgroundE = 100.0 + 50.0 * exposure;      // 偏置以上的天光 + 暗流
+        options.readNoiseE = 2.0 + params.noiseLevel * 50.0;
+        options.biasAdu = 100.0;
+        options.seed = 0x53494D46ULL;
+        options.frameIndex = m_frameIndex++;
         
-        QPainter painter(&image);
-        if (!painter.isActive()) {
-            log("错误：无法创建画笔");
-            return QImage();
-        }
-        
-        painter.setRenderHint(QPainter::Antialiasing);
-        
-        // 绘制星点
-        for (const auto &star : m_stars) {
-            drawStar(painter, star, params.exposureTime);
-        }
-        
-        painter.end();
-        
-        // 添加大气扰动
-        if (m_atmosphericTurbulence > 0.0) {
-            applyAtmosphericTurbulence(image);
-        }
-        
-        // 添加噪声
-        addNoiseToImage(image, params.noiseLevel);
+        const std::vector<sim::StarStamp> stamps = buildStarStamps(params);
+        m_renderer.render(options, stamps, reinterpret_cast<uint16_t *>(image.bits()),
+                          static_cast<size_t>(image.bytesPerLine()) / sizeof(quint16));
         
         qint64 elapsed = timer.elapsed();
-        log(QString("图像生成完成，耗时=%1ms").arg(elapsed));
+        log(QString("图像生成完成: 星点=%1, 读出噪声=%2e-, 耗时=%3ms")
+            .arg(stamps.size()).arg(options.readNoiseE, 0, 'f', 1).arg(elapsed));
         
         return image;
         
@@ -404,147 +395,27 @@ QImage StarSimulator::generateImage(const StarImageParams &params)
     }
 }
 
-void StarSimulator::addNoiseToImage(QImage &image, double noiseLevel)
+std::vector<sim::StarStamp> StarSimulator::buildStarStamps(const StarImageParams &params)
 {
-    try {
-        int width = image.width();
-        int height = image.height();
-        
-        // 检查图像有效性
-        if (image.isNull() || width <= 0 || height <= 0) {
-            log("错误：图像无效，无法添加噪声");
-            return;
-        }
-        
-        // 进一步降低噪声水平，提高星点可见性
-        double reducedNoiseLevel = noiseLevel * 0.01; // 降低到原来的1%
-        
-        // 使用更真实的噪声模型：高斯噪声 + 泊松噪声
-        for (int y = 0; y < height; ++y) {
-            for (int x = 0; x < width; ++x) {
-                QRgb pixel = image.pixel(x, y);
-                int gray = qGray(pixel);
-                
-                // 高斯噪声（模拟电子噪声）- 进一步降低噪声水平
-                double gaussianNoise = m_normalDist(m_mtGenerator) * reducedNoiseLevel * 50; // 从200降到50
-                
-                // 泊松噪声（模拟光子噪声）- 进一步降低光子噪声
-                double photonNoise = 0.0;
-                if (gray > 0) {
-                    double photonCount = gray * 0.0001; // 从0.001降到0.0001
-                    std::poisson_distribution<int> photonDist(photonCount);
-                    int actualPhotons = photonDist(m_mtGenerator);
-                    photonNoise = (actualPhotons - photonCount) * 2.0; // 从10降到2
-                }
-                
-                // 组合噪声
-                double totalNoise = gaussianNoise + photonNoise;
-                gray += static_cast<int>(totalNoise);
-                gray = qBound(0, gray, 65535); // 16位范围
-                
-                image.setPixel(x, y, qRgb(gray, gray, gray));
-            }
-        }
-        
-        log(QString("噪声添加完成: 噪声水平=%1, 降低后=%2").arg(noiseLevel).arg(reducedNoiseLevel));
-    } catch (const std::exception &e) {
-        log(QString("添加噪声异常: %1").arg(e.what()));
-    } catch (...) {
-        log("添加噪声发生未知异常");
-    }
-}
-
-void StarSimulator::drawStar(QPainter &painter, const SimulatedStar &star, double exposureTime)
-{
-    try {
-        // 计算星点大小（基于HFR）
-        double starSize = qMax(1.0, qMin(star.hfr * 0.8, 5.0)); // 限制最大大小5像素
-        
-        // 计算亮度
-        double brightness = star.brightness * exposureTime * 8.0; // 适度亮度
-        brightness = qBound(0.6, brightness, 1.0);
-        
-        QPointF center = star.position;
-        int radius = qMax(2, static_cast<int>(starSize * 2.0)); // 增加半径以容纳虚像
-        
-        // 检查图像边界
-        QImage *image = static_cast<QImage*>(painter.device());
-        if (!image) {
-            log("错误：无法获取图像设备");
-            return;
-        }
-        
-        int imageWidth = image->width();
-        int imageHeight = image->height();
-        
-        // 绘制散焦星点：中心实点 + 周围虚像
-        for (int y = -radius; y <= radius; ++y) {
-            for (int x = -radius; x <= radius; ++x) {
-                double distance = qSqrt(x*x + y*y);
-                if (distance <= radius) {
-                    double intensity = 0.0;
-                    
-                    // 计算散焦程度（HFR越大，散焦越严重）
-                    double defocusFactor = qMin(star.hfr / 8.0, 1.0); // 归一化散焦因子
-                    
-                    if (distance <= starSize * 0.5) {
-                        // 中心实点：高亮度，小范围
-                        intensity = brightness * (1.0 - distance / (starSize * 0.5));
-                    } else if (distance <= starSize) {
-                        // 实点边缘到虚像的过渡区域
-                        double transitionFactor = (distance - starSize * 0.5) / (starSize * 0.5);
-                        double coreIntensity = brightness * (1.0 - transitionFactor);
-                        double virtualIntensity = brightness * 0.4 * (1.0 - defocusFactor) * transitionFactor;
-                        intensity = coreIntensity + virtualIntensity;
-                    } else {
-                        // 周围虚像：低亮度，大范围，随散焦程度增加
-                        double virtualRadius = starSize + defocusFactor * (radius - starSize);
-                        if (distance <= virtualRadius) {
-                            // 虚像亮度随距离和散焦程度衰减
-                            double virtualIntensity = brightness * 0.2 * (1.0 - defocusFactor) * 
-                                                    (1.0 - (distance - starSize) / (virtualRadius - starSize));
-                            intensity = virtualIntensity;
-                        }
-                    }
-                    
-                    intensity = qMax(0.0, intensity);
-                    
-                    // 转换为像素值
-                    int pixelGray = static_cast<int>(intensity * 65535);
-                    pixelGray = qBound(0, pixelGray, 65535);
-                    
-                    int pixelX = static_cast<int>(center.x()) + x;
-                    int pixelY = static_cast<int>(center.y()) + y;
-                    
-                    // 边界检查
-                    if (pixelX >= 0 && pixelX < imageWidth &&
-                        pixelY >= 0 && pixelY < imageHeight) {
-                        
-                        // 获取当前像素值并混合
-                        QRgb currentPixel = image->pixel(pixelX, pixelY);
-                        int currentGray = qGray(currentPixel);
-                        
-                        // 使用最大值混合，确保星点清晰
-                        int newGray = qMax(currentGray, pixelGray);
-                        image->setPixel(pixelX, pixelY, qRgb(newGray, newGray, newGray));
-                    }
-                }
-            }
-        }
-        
-        // 记录第一个星点的绘制详情（用于调试）
-        if (m_totalStarsGenerated == 0) {
-            double defocusFactor = qMin(star.hfr / 8.0, 1.0); // 重新计算用于日志
-            log(QString("星点绘制详情: HFR=%1, 大小=%2, 亮度=%3, 半径=%4, 散焦因子=%5")
-                .arg(star.hfr, 0, 'f', 2).arg(starSize, 0, 'f', 2)
-                .arg(brightness, 0, 'f', 3).arg(radius).arg(defocusFactor, 0, 'f', 2));
-        }
-        
-    } catch (const std::exception &e) {
-        log(QString("绘制星点异常: %1").arg(e.what()));
-    } catch (...) {
-        log("绘制星点发生未知异常");
+    std::vector<sim::StarStamp> stamps;
+    stamps.reserve(m_stars.size());
+    
+    // 合焦时峰值约为满量程的 45%~75%，离焦后总通量不变、峰值随 HFR 下降
+    const double focusedSigma = sim::sigmaFromHfr(qMax(0.5, m_focusCurve.minHFR));
+    // 大气扰动表现为亚像素级的星点位置抖动
+    const double jitterPx = (m_atmosphericTurbulence > 0.0)
+        ? m_turbulenceParams.intensity * m_turbulenceParams.scale * 0.1 : 0.0;
+    
+    for (const auto &star : m_stars) {
+        const double brightness = qBound(0.6, star.brightness * params.exposureTime * 8.0, 1.0);
+        sim::StarStamp stamp;
+        stamp.x = star.position.x() + jitterPx * m_normalDist(m_mtGenerator);
+        stamp.y = star.position.y() + jitterPx * m_normalDist(m_mtGenerator);
+        stamp.sigmaPx = sim::sigmaFromHfr(star.hfr);
+        stamp.flux = sim::fluxFromPeak(brightness * 0.75 * 65535.0, focusedSigma);
+        stamps.push_back(stamp);
     }
+    return stamps;
 }
 
 bool StarSimulator::saveImage(const QImage &image, const QString &path)
@@ -711,73 +582,6 @@ QVector<QPointF> StarSimulator::generateStarPositions(int imageWidth, int imageH
     return positions;
 } 
 
-void StarSimulator::applyAtmosphericTurbulence(QImage &image)
-{
-    int width = image.width();
-    int height = image.height();
-    
-    // 创建扰动偏移图
-    QImage turbulenceMap(width, height, QImage::Format_Grayscale16);
-    turbulenceMap.fill(0);
-    
-    // 生成扰动模式
-    for (int y = 0; y < height; y += m_turbulenceParams.scale) {
-        for (int x = 0; x < width; x += m_turbulenceParams.scale) {
-            // 生成随机扰动向量
-            double angle = m_uniformDist(m_mtGenerator) * 2 * M_PI;
-            double magnitude = m_normalDist(m_mtGenerator) * m_turbulenceParams.intensity;
-            
-            int offsetX = static_cast<int>(qCos(angle) * magnitude * m_turbulenceParams.scale);
-            int offsetY = static_cast<int>(qSin(angle) * magnitude * m_turbulenceParams.scale);
-            
-            // 应用扰动到周围区域
-            for (int dy = -m_turbulenceParams.scale/2; dy <= m_turbulenceParams.scale/2; ++dy) {
-                for (int dx = -m_turbulenceParams.scale/2; dx <= m_turbulenceParams.scale/2; ++dx) {
-                    int nx = x + dx;
-                    int ny = y + dy;
-                    
-                    if (nx >= 0 && nx < width && ny >= 0 && ny < height) {
-                        // 计算距离权重
-                        double distance = qSqrt(dx*dx + dy*dy);
-                        double weight = qMax(0.0, 1.0 - distance / (m_turbulenceParams.scale/2));
-                        
-                        int currentOffsetX = static_cast<int>(offsetX * weight);
-                        int currentOffsetY = static_cast<int>(offsetY * weight);
-                        
-                        // 设置扰动偏移（16位范围）
-                        int pixelX = qBound(0, nx + currentOffsetX, width - 1);
-                        int pixelY = qBound(0, ny + currentOffsetY, height - 1);
-                        
-                        // 将偏移值编码到RGB通道中
-                        int encodedX = qBound(0, pixelX, 65535);
-                        int encodedY = qBound(0, pixelY, 65535);
-                        turbulenceMap.setPixel(nx, ny, qRgb(encodedX, encodedY, 0));
-                    }
-                }
-            }
-        }
-    }
-    
-    // 应用扰动到原图像
-    QImage result = image.copy();
-    for (int y = 0; y < height; ++y) {
-        for (int x = 0; x < width; ++x) {
-            QRgb turbulencePixel = turbulenceMap.pixel(x, y);
-            int offsetX = qRed(turbulencePixel);
-            int offsetY = qGreen(turbulencePixel);
-            
-            // 获取扰动后的像素值
-            int sourceX = qBound(0, x + offsetX, width - 1);
-            int sourceY = qBound(0, y + offsetY, height - 1);
-            
-            QRgb sourcePixel = image.pixel(sourceX, sourceY);
-            result.setPixel(x, y, sourcePixel);
-        }
-    }
-    
-    image = result;
-} 
-
 bool StarSimulator::saveAsFITS(const QImage &image, const QString &path)
 {
     try {
@@ -825,7 +629,7 @@ bool StarSimulator::saveAsFITS(const QImage &image, const QString &path)
         headerLines << QString("NAXIS   =                    2 / Number of axes").leftJustified(80);
         headerLines << QString("NAXIS1  = %1 / Width of image").arg(image.width(), 8, 10, QChar(' ')).leftJustified(80);
         headerLines << QString("NAXIS2  = %1 / Height of image").arg(image.height(), 8, 10, QChar(' ')).leftJustified(80);
-        headerLines << QString("BZERO   =                    0 / Offset for scaling").leftJustified(80);
+        headerLines << QString("BZERO   =                32768 / Offset for unsigned 16-bit").leftJustified(80);
         headerLines << QString("BSCALE  =                    1 / Scale factor").leftJustified(80);
         headerLines << QString("OBJECT  = 'Simulated Star Field' / Object name").leftJustified(80);
         headerLines << QString("TELESCOP= 'QUARCS Simulator' / Telescope name").leftJustified(80);
@@ -873,16 +677,11 @@ bool StarSimulator::saveAsFITS(const QImage &image, const QString &path)
         imageData.reserve(image.width() * image.height() * 2);
         
         // 写入图像数据（大端序）
+        // 直接读 16 位扫描行（pixel()/qGray 会截成 8 位）；无符号值按 BZERO=32768 存为有符号 16 位
         for (int y = 0; y < image.height(); ++y) {
+            const quint16 *line = reinterpret_cast<const quint16 *>(image.constScanLine(y));
             for (int x = 0; x < image.width(); ++x) {
-                QRgb pixel = image.pixel(x, y);
-                int gray = qGray(pixel);
-                
-                // 确保值在16位范围内
-                gray = qBound(0, gray, 65535);
-                
-                // 写入16位数据（大端序）
-                quint16 value = static_cast<quint16>(gray);
+                quint16 value = line[x] ^ 0x8000;
                 imageData.append((value >> 8) & 0xFF);  // 高字节
                 imageData.append(value & 0xFF);          // 低字节
             }
@@ -21,6 +21,8 @@
 #include <stellarsolver.h> // 包含FITSImage定义
 #include <fitsio.h>
 
+#include "sim/SkyRenderer.h"
+
 // 星点结构
 struct SimulatedStar {
     QPointF position;           // 星点位置
@@ -147,17 +149,11 @@ private:
     // 计算HFR值
     double calculateHFR(int focuserPosition, const SimulatedStar &star);
     
-    // 生成图像
+    // 生成图像（共享渲染器：子像素 PSF 核落星 + 泊松/读出噪声，16 位直出）
     QImage generateImage(const StarImageParams &params);
     
-    // 添加噪声到图像
-    void addNoiseToImage(QImage &image, double noiseLevel);
-    
-    // 应用大气扰动
-    void applyAtmosphericTurbulence(QImage &image);
-    
-    // 绘制星点
-    void drawStar(QPainter &painter, const SimulatedStar &star, double exposureTime);
+    // 星点 → 渲染器落点（HFR 换算高斯 sigma，大气扰动表现为星点位置抖动）
+    std::vector<sim::StarStamp> buildStarStamps(const StarImageParams &params);
     
     // 保存图像
     bool saveImage(const QImage &image, const QString &path);
@@ -198,6 +194,10 @@ private:
     // 真实天文设备参数
     TelescopeParams m_telescopeParams;
     
+    // 共享合成星空渲染器，逐帧递增帧号得到可复现的噪声
+    sim::SkyRenderer m_renderer;
+    quint64 m_frameIndex;
+    
     // 统计信息
     int m_totalStarsGenerated;
     int m_validStarsGenerated;
@@ -0,0 +1,587 @@
+#include "ConfigStore.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace storage {
+
+namespace {
+
+std::string trim(const std::string& s)
+{
+    const size_t b = s.find_first_not_of(" \t\r\n");
+    if (b == std::string::npos)
+        return std::string();
+    const size_t e = s.find_last_not_of(" \t\r\n");
+    return s.substr(b, e - b + 1);
+}
+
+bool startsWith(const std::string& s, const std::string& prefix)
+{
+    return s.size() >= prefix.size() && s.compare(0, prefix.size(), prefix) == 0;
+}
+
+bool endsWith(const std::string& s, const std::string& suffix)
+{
+    return s.size() >= suffix.size() && s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+bool isHeader(const std::string& line)
+{
+    return line.size() >= 2 && line.front() == '[' && line.back() == ']';
+}
+
+bool isEndMarker(const std::string& line)
+{
+    return startsWith(line, "(End of") && line.back() == ')';
+}
+
+std::string errnoText(const std::string& what, const std::string& path)
+{
+    return what + " " + path + ": " + std::strerror(errno);
+}
+
+} // namespace
+
+SectionStyle defaultSectionStyle(const std::string& section)
+{
+    SectionStyle style;
+    if (section == "ClientSettings") {
+        style.separator = " = ";
+    } else if (section == "LastConnectedDevice") {
+        style.endMarker = "(End of device list)";
+        style.raw = true;
+    } else if (section == "ExpTimeList") {
+        style.endMarker = "(End of ExpTime list)";
+    } else if (startsWith(section, "CFWList(")) {
+        style.endMarker = "(End of CFW list)";
+    } else if (startsWith(section, "DSLRsInfo(")) {
+        style.endMarker = "(End of DSLR Info)";
+    } else {
+        style.endMarker = "(End of " + section + " Parameter)";
+    }
+    return style;
+}
+
+bool writeFileAtomic(const std::string& path, const std::string& content, std::string* error)
+{
+    const std::string tmp = path + ".tmp";
+    const int fd = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        if (error)
+            *error = errnoText("open", tmp);
+        return false;
+    }
+    const char* p = content.data();
+    size_t left = content.size();
+    while (left > 0) {
+        const ssize_t n = ::write(fd, p, left);
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            if (error)
+                *error = errnoText("write", tmp);
+            ::close(fd);
+            ::unlink(tmp.c_str());
+            return false;
+        }
+        p += n;
+        left -= static_cast<size_t>(n);
+    }
+    // 先让数据落到存储卡上再换名，断电时要么是旧文件要么是完整的新文件
+    if (::fsync(fd) != 0 || ::close(fd) != 0) {
+        if (error)
+            *error = errnoText("fsync", tmp);
+        ::unlink(tmp.c_str());
+        return false;
+    }
+    if (::rename(tmp.c_str(), path.c_str()) != 0) {
+        if (error)
+            *error = errnoText("rename", tmp);
+        ::unlink(tmp.c_str());
+        return false;
+    }
+    const std::string dir = std::filesystem::path(path).parent_path().string();
+    const int dfd = ::open(dir.empty() ? "." : dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (dfd >= 0) {
+        ::fsync(dfd);
+        ::close(dfd);
+    }
+    return true;
+}
+
+ConfigStore::ConfigStore(Options options) : m_options(std::move(options))
+{
+    if (!m_options.styleFor)
+        m_options.styleFor = defaultSectionStyle;
+    m_options.debounceMs = std::max(0, m_options.debounceMs);
+    m_options.maxDelayMs = std::max(m_options.debounceMs, m_options.maxDelayMs);
+    m_writer = std::thread(&ConfigStore::writerLoop, this);
+}
+
+ConfigStore::~ConfigStore()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_cv.notify_all();
+    if (m_writer.joinable())
+        m_writer.join();
+    std::string error;
+    if (!flush(&error) && m_errorHandler)
+        m_errorHandler(error);
+}
+
+ConfigStore& ConfigStore::instance()
+{
+    static ConfigStore store{Options{}};
+    return store;
+}
+
+bool ConfigStore::load(std::string* error)
+{
+    std::ifstream in(m_options.path, std::ios::in | std::ios::binary);
+    if (!in) {
+        std::error_code ec;
+        if (std::filesystem::exists(m_options.path, ec)) {
+            if (error)
+                *error = errnoText("open", m_options.path);
+            return false;
+        }
+        parse(std::string());
+        return true;
+    }
+    const std::string text((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    parse(text);
+    return true;
+}
+
+void ConfigStore::parse(const std::string& text)
+{
+    std::vector<std::string> lines;
+    {
+        std::istringstream in(text);
+        std::string line;
+        while (std::getline(in, line)) {
+            if (!line.empty() && line.back() == '\r')
+                line.pop_back();
+            lines.push_back(line);
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_preamble.clear();
+    m_sections.clear();
+    m_sectionIndex.clear();
+    m_dirty = false;
+
+    size_t i = 0;
+    for (; i < lines.size() && !isHeader(trim(lines[i])); ++i)
+        m_preamble += lines[i] + "\n";
+    if (trim(m_preamble).empty())
+        m_preamble.clear();
+
+    while (i < lines.size()) {
+        const std::string header = trim(lines[i++]);
+        const std::string name = header.substr(1, header.size() - 2);
+        // 历史 bug 可能留下同名段，合并到第一次出现的位置（后出现的值覆盖）
+        Section& section = sectionLocked(name);
+        size_t end = i;
+        while (end < lines.size() && !isHeader(trim(lines[end])))
+            ++end;
+
+        if (section.style.raw) {
+            std::string body;
+            bool marked = false;
+            for (size_t k = i; k < end; ++k) {
+                if (isEndMarker(trim(lines[k]))) {
+                    section.style.endMarker = trim(lines[k]);
+                    marked = true;
+                    break;
+                }
+                body += lines[k] + "\n";
+            }
+            // 没有结束标记时，段尾空行只是段间分隔
+            if (!marked) {
+                while (endsWith(body, "\n\n"))
+                    body.pop_back();
+                if (trim(body).empty())
+                    body.clear();
+            }
+            section.raw += body;
+        } else {
+            const bool spaced = section.style.separator != "=";
+            for (size_t k = i; k < end; ++k) {
+                const std::string& line = lines[k];
+                if (trim(line).empty())
+                    continue;
+                if (isEndMarker(trim(line))) {
+                    section.style.endMarker = trim(line);
+                    continue;
+                }
+                const size_t eq = line.find('=');
+                if (eq == std::string::npos)
+                    continue;
+                std::string key = line.substr(0, eq);
+                std::string value = line.substr(eq + 1);
+                if (spaced) {
+                    key = trim(key);
+                    value = trim(value);
+                }
+                if (!key.empty())
+                    setLocked(section, key, value);
+            }
+        }
+        i = end;
+    }
+}
+
+std::string ConfigStore::serialize() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return serializeLocked();
+}
+
+std::string ConfigStore::serializeLocked() const
+{
+    std::string out = m_preamble;
+    if (!out.empty() && out.back() != '\n')
+        out += "\n";
+    for (const Section& section : m_sections) {
+        out += "[" + section.name + "]\n";
+        if (section.style.raw) {
+            out += section.raw;
+            if (!section.raw.empty() && section.raw.back() != '\n')
+                out += "\n";
+        } else {
+            for (const auto& kv : section.entries)
+                out += kv.first + section.style.separator + kv.second + "\n";
+        }
+        if (!section.style.endMarker.empty())
+            out += section.style.endMarker + "\n";
+        out += "\n";
+    }
+    return out;
+}
+
+ConfigStore::Section& ConfigStore::sectionLocked(const std::string& name)
+{
+    const auto it = m_sectionIndex.find(name);
+    if (it != m_sectionIndex.end())
+        return m_sections[it->second];
+    Section section;
+    section.name = name;
+    section.style = m_options.styleFor(name);
+    m_sectionIndex[name] = m_sections.size();
+    m_sections.push_back(std::move(section));
+    return m_sections.back();
+}
+
+const ConfigStore::Section* ConfigStore::findLocked(const std::string& name) const
+{
+    const auto it = m_sectionIndex.find(name);
+    return it == m_sectionIndex.end() ? nullptr : &m_sections[it->second];
+}
+
+bool ConfigStore::setLocked(Section& section, const std::string& key, const std::string& value)
+{
+    const auto it = section.index.find(key);
+    if (it == section.index.end()) {
+        section.index[key] = section.entries.size();
+        section.entries.emplace_back(key, value);
+        return true;
+    }
+    std::string& current = section.entries[it->second].second;
+    if (current == value)
+        return false;
+    current = value;
+    return true;
+}
+
+bool ConfigStore::hasSection(const std::string& section) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return findLocked(section) != nullptr;
+}
+
+bool ConfigStore::contains(const std::string& section, const std::string& key) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const Section* s = findLocked(section);
+    return s && s->index.count(key) > 0;
+}
+
+std::string ConfigStore::value(const std::string& section, const std::string& key, const std::string& fallback) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const Section* s = findLocked(section);
+    if (!s)
+        return fallback;
+    const auto it = s->index.find(key);
+    return it == s->index.end() ? fallback : s->entries[it->second].second;
+}
+
+int ConfigStore::intValue(const std::string& section, const std::string& key, int fallback) const
+{
+    const std::string text = trim(value(section, key));
+    if (text.empty())
+        return fallback;
+    char* end = nullptr;
+    errno = 0;
+    const long v = std::strtol(text.c_str(), &end, 10);
+    if (errno != 0 || !end || *end != '\0' || v < INT32_MIN || v > INT32_MAX)
+        return fallback;
+    return static_cast<int>(v);
+}
+
+double ConfigStore::doubleValue(const std::string& section, const std::string& key, double fallback) const
+{
+    const std::string text = trim(value(section, key));
+    if (text.empty())
+        return fallback;
+    char* end = nullptr;
+    const double v = std::strtod(text.c_str(), &end);
+    return (end && *end == '\0') ? v : fallback;
+}
+
+bool ConfigStore::boolValue(const std::string& section, const std::string& key, bool fallback) const
+{
+    std::string text = trim(value(section, key));
+    std::transform(text.begin(), text.end(), text.begin(), [](unsigned char c) { return std::tolower(c); });
+    if (text == "true" || text == "1" || text == "yes" || text == "on")
+        return true;
+    if (text == "false" || text == "0" || text == "no" || text == "off")
+        return false;
+    return fallback;
+}
+
+ConfigStore::Entries ConfigStore::entries(const std::string& section) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const Section* s = findLocked(section);
+    return s ? s->entries : Entries();
+}
+
+std::string ConfigStore::rawSection(const std::string& section) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const Section* s = findLocked(section);
+    return s ? s->raw : std::string();
+}
+
+void ConfigStore::setValue(const std::string& section, const std::string& key, const std::string& value)
+{
+    setValues(section, Entries{{key, value}});
+}
+
+void ConfigStore::setValues(const std::string& section, const Entries& values)
+{
+    std::vector<Change> changes;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const bool existed = findLocked(section) != nullptr;
+        Section& s = sectionLocked(section);
+        for (const auto& kv : values) {
+            if (setLocked(s, kv.first, kv.second))
+                changes.push_back({section, kv.first, kv.second});
+        }
+        if (!changes.empty() || !existed)
+            markDirtyLocked();
+    }
+    notify(changes);
+}
+
+void ConfigStore::replaceSection(const std::string& section, const Entries& values)
+{
+    std::vector<Change> changes;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const bool existed = findLocked(section) != nullptr;
+        Section& s = sectionLocked(section);
+        Section fresh;
+        fresh.name = s.name;
+        fresh.style = s.style;
+        for (const auto& kv : values) {
+            setLocked(fresh, kv.first, kv.second);
+            const auto old = s.index.find(kv.first);
+            if (old == s.index.end() || s.entries[old->second].second != kv.second)
+                changes.push_back({section, kv.first, kv.second});
+        }
+        for (const auto& kv : s.entries) {
+            if (fresh.index.count(kv.first) == 0)
+                changes.push_back({section, kv.first, std::string()});
+        }
+        if (!changes.empty() || !existed) {
+            s = std::move(fresh);
+            markDirtyLocked();
+        }
+    }
+    notify(changes);
+}
+
+void ConfigStore::setRawSection(const std::string& section, const std::string& body)
+{
+    std::vector<Change> changes;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const bool existed = findLocked(section) != nullptr;
+        Section& s = sectionLocked(section);
+        s.style.raw = true;
+        if (s.raw != body || !existed) {
+            s.raw = body;
+            markDirtyLocked();
+            changes.push_back({section, std::string(), body});
+        }
+    }
+    notify(changes);
+}
+
+bool ConfigStore::removeSection(const std::string& section)
+{
+    std::vector<Change> changes;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const auto it = m_sectionIndex.find(section);
+        if (it == m_sectionIndex.end())
+            return false;
+        for (const auto& kv : m_sections[it->second].entries)
+            changes.push_back({section, kv.first, std::string()});
+        m_sections.erase(m_sections.begin() + static_cast<std::ptrdiff_t>(it->second));
+        m_sectionIndex.clear();
+        for (size_t i = 0; i < m_sections.size(); ++i)
+            m_sectionIndex[m_sections[i].name] = i;
+        markDirtyLocked();
+    }
+    notify(changes);
+    return true;
+}
+
+void ConfigStore::markDirtyLocked()
+{
+    const auto now = std::chrono::steady_clock::now();
+    ++m_generation;
+    m_lastChange = now;
+    if (!m_dirty) {
+        m_dirty = true;
+        m_firstDirty = now;
+        m_cv.notify_all();
+    }
+}
+
+int ConfigStore::subscribe(Listener listener)
+{
+    std::lock_guard<std::mutex> lock(m_listenerMutex);
+    const int token = m_nextToken++;
+    m_listeners[token] = std::move(listener);
+    return token;
+}
+
+void ConfigStore::unsubscribe(int token)
+{
+    std::lock_guard<std::mutex> lock(m_listenerMutex);
+    m_listeners.erase(token);
+}
+
+void ConfigStore::setErrorHandler(ErrorHandler handler)
+{
+    std::lock_guard<std::mutex> lock(m_writeMutex);
+    m_errorHandler = std::move(handler);
+}
+
+void ConfigStore::notify(const std::vector<Change>& changes)
+{
+    if (changes.empty())
+        return;
+    std::lock_guard<std::mutex> lock(m_listenerMutex);
+    for (const Change& c : changes) {
+        for (const auto& entry : m_listeners)
+            entry.second(c.section, c.key, c.value);
+    }
+}
+
+bool ConfigStore::flush(std::string* error)
+{
+    std::lock_guard<std::mutex> writeLock(m_writeMutex);
+    std::string content;
+    uint64_t generation = 0;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_dirty)
+            return true;
+        content = serializeLocked();
+        generation = m_generation;
+    }
+
+    const std::filesystem::path parent = std::filesystem::path(m_options.path).parent_path();
+    std::error_code ec;
+    if (!parent.empty())
+        std::filesystem::create_directories(parent, ec);
+    if (!writeFileAtomic(m_options.path, content, error))
+        return false;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ++m_saveCount;
+    // 写盘期间又有修改：保持脏，由写线程按新的期限再写
+    if (m_generation == generation)
+        m_dirty = false;
+    return true;
+}
+
+bool ConfigStore::dirty() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_dirty;
+}
+
+uint64_t ConfigStore::saveCount() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_saveCount;
+}
+
+void ConfigStore::writerLoop()
+{
+    using std::chrono::milliseconds;
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (!m_stopping) {
+        if (!m_dirty) {
+            m_cv.wait(lock, [this] { return m_stopping || m_dirty; });
+            continue;
+        }
+        const auto due = std::min(m_lastChange + milliseconds(m_options.debounceMs),
+                                  m_firstDirty + milliseconds(m_options.maxDelayMs));
+        if (std::chrono::steady_clock::now() < due) {
+            // 等待期间的新修改只推迟期限，到点后重新计算
+            m_cv.wait_until(lock, due, [this] { return m_stopping; });
+            continue;
+        }
+        lock.unlock();
+        std::string error;
+        const bool ok = flush(&error);
+        if (!ok) {
+            std::lock_guard<std::mutex> writeLock(m_writeMutex);
+            if (m_errorHandler)
+                m_errorHandler("ConfigStore | save failed: " + error);
+        }
+        lock.lock();
+        if (!ok) {
+            // 存储卡只读/写满时不要每个防抖周期都重试
+            const auto retry = std::chrono::steady_clock::now() + milliseconds(m_options.maxDelayMs);
+            m_firstDirty = retry;
+            m_lastChange = retry;
+        }
+    }
+}
+
+} // namespace storage
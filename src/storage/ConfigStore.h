@@ -0,0 +1,140 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace storage {
+
+// 段的写法。config.ini 历史上各段格式不同：
+//   [MainCamera]            key=value ... (End of MainCamera Parameter)
+//   [ClientSettings]        key = value ...（无结束标记）
+//   [CFWList(名称)]         CFWList=... (End of CFW list)
+//   [LastConnectedDevice]   多个设备块（键重复、空行分隔）... (End of device list)
+struct SectionStyle {
+    std::string endMarker;      ///< 空表示没有结束标记
+    std::string separator{"="}; ///< " = " 时读入的键和值都去掉两端空白
+    bool raw{false};            ///< 原样保存段体文本，不按键值解析（键可重复的块列表）
+};
+
+// 按段名给出写法（新建段和解析时使用），默认规则与 Tools 里各段的历史写法一致
+SectionStyle defaultSectionStyle(const std::string& section);
+
+// 写临时文件 → fsync → rename，失败时原文件保持不变
+bool writeFileAtomic(const std::string& path, const std::string& content, std::string* error = nullptr);
+
+// 配置存储：启动时解析一次，之后读写都在内存里（按段/键哈希查找）；
+// 修改只标脏，由后台线程防抖合并后整文件原子替换（最后一次修改后 debounceMs 落盘，
+// 持续修改时最迟 maxDelayMs 落盘），flush() 立即写出。值未变化的修改既不写盘也不通知。
+// 段、键保持文件中的原有顺序，新键追加在段尾，新段追加在文件尾。
+class ConfigStore
+{
+public:
+    struct Options {
+        std::string path{"config/config.ini"};
+        int debounceMs{500};
+        int maxDelayMs{3000};
+        std::function<SectionStyle(const std::string&)> styleFor{defaultSectionStyle};
+    };
+
+    using Entries = std::vector<std::pair<std::string, std::string>>;
+    // 回调在修改线程上执行，不持有存储锁；可以在回调里读，但不要 subscribe/unsubscribe
+    using Listener = std::function<void(const std::string& section, const std::string& key, const std::string& value)>;
+    using ErrorHandler = std::function<void(const std::string& message)>;
+
+    explicit ConfigStore(Options options);
+    ~ConfigStore();   // 写出未落盘的修改
+
+    ConfigStore(const ConfigStore&) = delete;
+    ConfigStore& operator=(const ConfigStore&) = delete;
+
+    // 进程内唯一的 config/config.ini 存储；构造时不读盘，由 Tools 首次使用时 load
+    static ConfigStore& instance();
+
+    // 重新从磁盘载入（丢弃未落盘的修改）；文件不存在视为空配置，返回 true
+    bool load(std::string* error = nullptr);
+    const std::string& path() const { return m_options.path; }
+
+    bool hasSection(const std::string& section) const;
+    bool contains(const std::string& section, const std::string& key) const;
+    std::string value(const std::string& section, const std::string& key, const std::string& fallback = std::string()) const;
+    int intValue(const std::string& section, const std::string& key, int fallback) const;
+    double doubleValue(const std::string& section, const std::string& key, double fallback) const;
+    bool boolValue(const std::string& section, const std::string& key, bool fallback) const;
+    Entries entries(const std::string& section) const;
+    std::string rawSection(const std::string& section) const;
+
+    void setValue(const std::string& section, const std::string& key, const std::string& value);
+    void setValues(const std::string& section, const Entries& values);
+    // 整段替换为给定键值（段不存在时新建）
+    void replaceSection(const std::string& section, const Entries& values);
+    void setRawSection(const std::string& section, const std::string& body);
+    bool removeSection(const std::string& section);
+
+    int subscribe(Listener listener);
+    // 返回后保证该回调不再被调用
+    void unsubscribe(int token);
+    // 后台落盘失败时调用（写线程上）
+    void setErrorHandler(ErrorHandler handler);
+
+    // 立即写出未落盘的修改；没有修改时直接返回 true
+    bool flush(std::string* error = nullptr);
+    bool dirty() const;
+    uint64_t saveCount() const;   ///< 实际写盘次数
+
+    // 与 load 相同的解析/序列化（不碰磁盘），便于检查格式兼容
+    void parse(const std::string& text);
+    std::string serialize() const;
+
+private:
+    struct Section {
+        std::string name;
+        SectionStyle style;
+        Entries entries;
+        std::unordered_map<std::string, size_t> index;
+        std::string raw;
+    };
+    struct Change {
+        std::string section;
+        std::string key;
+        std::string value;
+    };
+
+    Section& sectionLocked(const std::string& name);
+    const Section* findLocked(const std::string& name) const;
+    bool setLocked(Section& section, const std::string& key, const std::string& value);
+    std::string serializeLocked() const;
+    void markDirtyLocked();
+    void notify(const std::vector<Change>& changes);
+    void writerLoop();
+
+    Options m_options;
+    mutable std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::string m_preamble;                               ///< 第一个段头之前的内容
+    std::vector<Section> m_sections;
+    std::unordered_map<std::string, size_t> m_sectionIndex;
+    bool m_dirty{false};
+    uint64_t m_generation{0};                             ///< 每次修改 +1，写盘期间又有修改时保持脏
+    std::chrono::steady_clock::time_point m_firstDirty;
+    std::chrono::steady_clock::time_point m_lastChange;
+    uint64_t m_saveCount{0};
+    bool m_stopping{false};
+    std::thread m_writer;
+    std::mutex m_writeMutex;                              ///< 串行化写盘（后台线程与 flush）
+    ErrorHandler m_errorHandler;
+
+    std::mutex m_listenerMutex;
+    std::map<int, Listener> m_listeners;
+    int m_nextToken{1};
+};
+
+} // namespace storage
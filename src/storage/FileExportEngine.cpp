@@ -0,0 +1,889 @@
+#include "FileExportEngine.h"
+
+#include <fcntl.h>
+#include <sys/sendfile.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+
+namespace storage {
+
+namespace {
+
+constexpr uint64_t kPrime1 = 11400714785074694791ULL;
+constexpr uint64_t kPrime2 = 14029467366897019727ULL;
+constexpr uint64_t kPrime3 = 1609587929392839161ULL;
+constexpr uint64_t kPrime4 = 9650029242287828579ULL;
+constexpr uint64_t kPrime5 = 2870177450012600261ULL;
+
+// FAT/exFAT 的 mtime 精度为 2 秒，判断"已是完整副本"时放宽到这个范围
+constexpr int64_t kMtimeToleranceNs = 2000000000LL;
+// 续传前比对 .part 末尾与源文件对应区间的长度
+constexpr size_t kResumeTailCheckBytes = 1u << 20;
+// 最近结束的批次保留数量（供 unfinishedItems 续传查询）
+constexpr size_t kFinishedBatchesKept = 8;
+
+inline uint64_t rotl64(uint64_t x, int r) { return (x << r) | (x >> (64 - r)); }
+
+inline uint64_t read64(const unsigned char* p)
+{
+    uint64_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+inline uint32_t read32(const unsigned char* p)
+{
+    uint32_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+inline uint64_t xxhRound(uint64_t acc, uint64_t input)
+{
+    acc += input * kPrime2;
+    acc = rotl64(acc, 31);
+    return acc * kPrime1;
+}
+
+inline uint64_t xxhMerge(uint64_t acc, uint64_t val)
+{
+    acc ^= xxhRound(0, val);
+    return acc * kPrime1 + kPrime4;
+}
+
+struct FdGuard {
+    int fd{-1};
+    explicit FdGuard(int f) : fd(f) {}
+    ~FdGuard()
+    {
+        if (fd >= 0)
+            ::close(fd);
+    }
+    int release()
+    {
+        const int f = fd;
+        fd = -1;
+        return f;
+    }
+    FdGuard(const FdGuard&) = delete;
+    FdGuard& operator=(const FdGuard&) = delete;
+};
+
+double elapsedMs(std::chrono::steady_clock::time_point since)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - since).count();
+}
+
+int64_t toNs(const struct timespec& ts)
+{
+    return static_cast<int64_t>(ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+}
+
+// 目标已存在、大小一致且 mtime 与源相同（copyFile 完成时会把源 mtime 写到目标）
+bool looksLikeCompleteCopy(const struct stat& src, const std::string& destination)
+{
+    struct stat dst;
+    if (::stat(destination.c_str(), &dst) != 0 || !S_ISREG(dst.st_mode))
+        return false;
+    if (dst.st_size != src.st_size)
+        return false;
+    const int64_t diff = toNs(dst.st_mtim) - toNs(src.st_mtim);
+    return diff >= -kMtimeToleranceNs && diff <= kMtimeToleranceNs;
+}
+
+bool preadAll(int fd, unsigned char* buf, size_t len, uint64_t offset)
+{
+    size_t done = 0;
+    while (done < len) {
+        const ssize_t n = ::pread(fd, buf + done, len - done, static_cast<off_t>(offset + done));
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return false;
+        done += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+bool pwriteAll(int fd, const unsigned char* buf, size_t len, uint64_t offset)
+{
+    size_t done = 0;
+    while (done < len) {
+        const ssize_t n = ::pwrite(fd, buf + done, len - done, static_cast<off_t>(offset + done));
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0) {
+            if (n == 0)
+                errno = EIO;
+            return false;
+        }
+        done += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+// .part 末尾与源文件同一区间一致才续传；不一致（源被替换、上次写坏）从头来
+bool partTailMatches(int sourceFd, const std::string& partPath, uint64_t partBytes)
+{
+    FdGuard part(::open(partPath.c_str(), O_RDONLY | O_CLOEXEC));
+    if (part.fd < 0)
+        return false;
+    const size_t len = static_cast<size_t>(std::min<uint64_t>(partBytes, kResumeTailCheckBytes));
+    const uint64_t offset = partBytes - len;
+    std::vector<unsigned char> a(len), b(len);
+    if (!preadAll(sourceFd, a.data(), len, offset) || !preadAll(part.fd, b.data(), len, offset))
+        return false;
+    return std::memcmp(a.data(), b.data(), len) == 0;
+}
+
+void syncParentDirectory(const std::string& path)
+{
+    const std::string dir = std::filesystem::path(path).parent_path().string();
+    FdGuard fd(::open(dir.empty() ? "." : dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC));
+    if (fd.fd >= 0)
+        ::fsync(fd.fd);
+}
+
+// 目标所在设备：从目标父目录向上找到第一个已存在的目录
+dev_t destinationDevice(const std::string& destination)
+{
+    std::filesystem::path p = std::filesystem::path(destination).parent_path();
+    while (!p.empty()) {
+        struct stat st;
+        if (::stat(p.c_str(), &st) == 0)
+            return st.st_dev;
+        if (p == p.parent_path())
+            break;
+        p = p.parent_path();
+    }
+    return 0;
+}
+
+} // namespace
+
+Xxh64::Xxh64(uint64_t seed)
+    : m_seed(seed)
+{
+    m_v[0] = seed + kPrime1 + kPrime2;
+    m_v[1] = seed + kPrime2;
+    m_v[2] = seed;
+    m_v[3] = seed - kPrime1;
+}
+
+void Xxh64::update(const void* data, size_t len)
+{
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    const unsigned char* const end = p + len;
+    m_total += len;
+
+    if (m_bufLen + len < sizeof(m_buf)) {
+        std::memcpy(m_buf + m_bufLen, p, len);
+        m_bufLen += len;
+        return;
+    }
+    if (m_bufLen > 0) {
+        const size_t fill = sizeof(m_buf) - m_bufLen;
+        std::memcpy(m_buf + m_bufLen, p, fill);
+        for (int i = 0; i < 4; ++i)
+            m_v[i] = xxhRound(m_v[i], read64(m_buf + 8 * i));
+        p += fill;
+        m_bufLen = 0;
+    }
+    while (p + 32 <= end) {
+        m_v[0] = xxhRound(m_v[0], read64(p));
+        m_v[1] = xxhRound(m_v[1], read64(p + 8));
+        m_v[2] = xxhRound(m_v[2], read64(p + 16));
+        m_v[3] = xxhRound(m_v[3], read64(p + 24));
+        p += 32;
+    }
+    if (p < end) {
+        m_bufLen = static_cast<size_t>(end - p);
+        std::memcpy(m_buf, p, m_bufLen);
+    }
+}
+
+uint64_t Xxh64::digest() const
+{
+    uint64_t h;
+    if (m_total >= 32) {
+        h = rotl64(m_v[0], 1) + rotl64(m_v[1], 7) + rotl64(m_v[2], 12) + rotl64(m_v[3], 18);
+        for (int i = 0; i < 4; ++i)
+            h = xxhMerge(h, m_v[i]);
+    } else {
+        h = m_seed + kPrime5;
+    }
+    h += m_total;
+
+    const unsigned char* p = m_buf;
+    const unsigned char* const end = m_buf + m_bufLen;
+    while (p + 8 <= end) {
+        h ^= xxhRound(0, read64(p));
+        h = rotl64(h, 27) * kPrime1 + kPrime4;
+        p += 8;
+    }
+    if (p + 4 <= end) {
+        h ^= static_cast<uint64_t>(read32(p)) * kPrime1;
+        h = rotl64(h, 23) * kPrime2 + kPrime3;
+        p += 4;
+    }
+    while (p < end) {
+        h ^= static_cast<uint64_t>(*p) * kPrime5;
+        h = rotl64(h, 11) * kPrime1;
+        ++p;
+    }
+
+    h ^= h >> 33;
+    h *= kPrime2;
+    h ^= h >> 29;
+    h *= kPrime3;
+    h ^= h >> 32;
+    return h;
+}
+
+bool fileChecksum(const std::string& path, uint64_t* out, bool dropCache, std::string* error)
+{
+    FdGuard fd(::open(path.c_str(), O_RDONLY | O_CLOEXEC));
+    if (fd.fd < 0) {
+        if (error)
+            *error = "open " + path + ": " + std::strerror(errno);
+        return false;
+    }
+    if (dropCache)
+        ::posix_fadvise(fd.fd, 0, 0, POSIX_FADV_DONTNEED);
+    ::posix_fadvise(fd.fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+    Xxh64 hash;
+    std::vector<unsigned char> buf(4u << 20);
+    for (;;) {
+        const ssize_t n = ::read(fd.fd, buf.data(), buf.size());
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n < 0) {
+            if (error)
+                *error = "read " + path + ": " + std::strerror(errno);
+            return false;
+        }
+        if (n == 0)
+            break;
+        hash.update(buf.data(), static_cast<size_t>(n));
+    }
+    if (out)
+        *out = hash.digest();
+    return true;
+}
+
+const char* copyOutcomeName(CopyOutcome outcome)
+{
+    switch (outcome) {
+    case CopyOutcome::Copied:    return "copied";
+    case CopyOutcome::Resumed:   return "resumed";
+    case CopyOutcome::Skipped:   return "skipped";
+    case CopyOutcome::Failed:    return "failed";
+    case CopyOutcome::Cancelled: return "cancelled";
+    }
+    return "unknown";
+}
+
+CopyResult copyFile(const std::string& source,
+                    const std::string& destination,
+                    const CopyOptions& options,
+                    const std::function<void(uint64_t, bool)>& onBytes,
+                    const std::atomic<bool>* cancel)
+{
+    const auto t0 = std::chrono::steady_clock::now();
+    CopyResult r;
+    auto fail = [&](const std::string& what, int err) -> CopyResult {
+        r.outcome = CopyOutcome::Failed;
+        r.errorCode = err;
+        r.error = what + ": " + std::strerror(err);
+        r.ms = elapsedMs(t0);
+        return r;
+    };
+    auto report = [&](uint64_t n, bool transferred) {
+        if (onBytes && n > 0)
+            onBytes(n, transferred);
+    };
+    auto cancelled = [&]() { return cancel && cancel->load(std::memory_order_relaxed); };
+
+    FdGuard in(::open(source.c_str(), O_RDONLY | O_CLOEXEC));
+    if (in.fd < 0)
+        return fail("open " + source, errno);
+    struct stat st;
+    if (::fstat(in.fd, &st) != 0)
+        return fail("stat " + source, errno);
+    if (!S_ISREG(st.st_mode))
+        return fail(source + " is not a regular file", EINVAL);
+    const uint64_t size = static_cast<uint64_t>(st.st_size);
+    r.fileBytes = size;
+
+    const std::filesystem::path destDir = std::filesystem::path(destination).parent_path();
+    if (!destDir.empty()) {
+        std::error_code ec;
+        std::filesystem::create_directories(destDir, ec);
+        if (ec)
+            return fail("create directory " + destDir.string(), ec.value());
+    }
+
+    if (options.resume && looksLikeCompleteCopy(st, destination)) {
+        bool same = true;
+        if (options.verify) {
+            uint64_t a = 0, b = 0;
+            same = fileChecksum(source, &a) && fileChecksum(destination, &b, true) && a == b;
+            r.checksum = a;
+            r.verified = same;
+        }
+        if (same) {
+            r.outcome = CopyOutcome::Skipped;
+            r.ms = elapsedMs(t0);
+            report(size, false);
+            return r;
+        }
+    }
+
+    const std::string part = destination + ".part";
+    uint64_t offset = 0;
+    if (options.resume) {
+        struct stat ps;
+        if (::stat(part.c_str(), &ps) == 0 && S_ISREG(ps.st_mode) && ps.st_size > 0 &&
+            static_cast<uint64_t>(ps.st_size) <= size &&
+            partTailMatches(in.fd, part, static_cast<uint64_t>(ps.st_size))) {
+            offset = static_cast<uint64_t>(ps.st_size);
+        }
+    }
+
+    FdGuard out(::open(part.c_str(), O_WRONLY | O_CREAT | O_CLOEXEC, 0644));
+    if (out.fd < 0)
+        return fail("open " + part, errno);
+    if (::ftruncate(out.fd, static_cast<off_t>(offset)) != 0)
+        return fail("truncate " + part, errno);
+
+    ::posix_fadvise(in.fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+    r.resumedFrom = offset;
+    report(offset, false);
+
+    const size_t chunk = std::max<size_t>(options.chunkBytes, 64u << 10);
+    uint64_t pos = offset;
+    Xxh64 hash;
+
+    if (options.verify) {
+        // 需要源数据经过用户态计算校验，走 pread/pwrite；续传时已有部分只读不写
+        r.method = "read-write";
+        std::vector<unsigned char> buf(chunk);
+        for (uint64_t hp = 0; hp < offset;) {
+            const size_t want = static_cast<size_t>(std::min<uint64_t>(chunk, offset - hp));
+            if (!preadAll(in.fd, buf.data(), want, hp))
+                return fail("read " + source, errno ? errno : EIO);
+            hash.update(buf.data(), want);
+            hp += want;
+        }
+        while (pos < size) {
+            if (cancelled())
+                break;
+            const size_t want = static_cast<size_t>(std::min<uint64_t>(chunk, size - pos));
+            if (!preadAll(in.fd, buf.data(), want, pos))
+                return fail("read " + source, errno ? errno : EIO);
+            hash.update(buf.data(), want);
+            if (!pwriteAll(out.fd, buf.data(), want, pos))
+                return fail("write " + part, errno);
+            pos += want;
+            r.transferredBytes += want;
+            report(want, true);
+        }
+    } else {
+        enum class Mode { CopyFileRange, SendFile, ReadWrite };
+        Mode mode = Mode::CopyFileRange;
+        std::vector<unsigned char> buf;
+        while (pos < size) {
+            if (cancelled())
+                break;
+            const size_t want = static_cast<size_t>(std::min<uint64_t>(chunk, size - pos));
+            ssize_t n = 0;
+            if (mode == Mode::CopyFileRange) {
+                loff_t inOff = static_cast<loff_t>(pos);
+                loff_t outOff = static_cast<loff_t>(pos);
+                n = ::copy_file_range(in.fd, &inOff, out.fd, &outOff, want, 0);
+                if (n < 0) {
+                    if (errno == EINTR)
+                        continue;
+                    // 跨文件系统（EXDEV）或内核/文件系统不支持：退到 sendfile
+                    if (errno == EXDEV || errno == ENOSYS || errno == EINVAL || errno == EOPNOTSUPP) {
+                        mode = Mode::SendFile;
+                        continue;
+                    }
+                    return fail("copy_file_range " + source, errno);
+                }
+                r.method = "copy_file_range";
+            } else if (mode == Mode::SendFile) {
+                if (::lseek(out.fd, static_cast<off_t>(pos), SEEK_SET) < 0)
+                    return fail("seek " + part, errno);
+                off_t inOff = static_cast<off_t>(pos);
+                n = ::sendfile(out.fd, in.fd, &inOff, want);
+                if (n < 0) {
+                    if (errno == EINTR)
+                        continue;
+                    if (errno == EINVAL || errno == ENOSYS) {
+                        mode = Mode::ReadWrite;
+                        continue;
+                    }
+                    return fail("sendfile " + source, errno);
+                }
+                r.method = "sendfile";
+            } else {
+                if (buf.empty())
+                    buf.resize(chunk);
+                if (!preadAll(in.fd, buf.data(), want, pos))
+                    return fail("read " + source, errno ? errno : EIO);
+                if (!pwriteAll(out.fd, buf.data(), want, pos))
+                    return fail("write " + part, errno);
+                n = static_cast<ssize_t>(want);
+                r.method = "read-write";
+            }
+            if (n == 0)
+                break; // 源文件在复制过程中变短
+            pos += static_cast<uint64_t>(n);
+            r.transferredBytes += static_cast<uint64_t>(n);
+            report(static_cast<uint64_t>(n), true);
+        }
+    }
+
+    if (pos < size) {
+        if (cancelled()) {
+            // 保留 .part，下次 resume 从这里继续
+            if (options.syncOnClose)
+                ::fdatasync(out.fd);
+            r.outcome = CopyOutcome::Cancelled;
+            r.error = "cancelled";
+            r.ms = elapsedMs(t0);
+            return r;
+        }
+        return fail("source shrank during copy " + source, EIO);
+    }
+
+    if (options.syncOnClose && ::fdatasync(out.fd) != 0)
+        return fail("sync " + part, errno);
+    const struct timespec times[2] = {st.st_atim, st.st_mtim};
+    ::futimens(out.fd, times);
+    // 数据已落盘：丢弃目标页缓存（导出几百个文件时不挤占内存），也让后面的校验真正读设备
+    ::posix_fadvise(out.fd, 0, 0, POSIX_FADV_DONTNEED);
+    if (::close(out.release()) != 0)
+        return fail("close " + part, errno);
+
+    if (options.verify) {
+        r.checksum = hash.digest();
+        uint64_t written = 0;
+        std::string err;
+        if (!fileChecksum(part, &written, true, &err)) {
+            r.outcome = CopyOutcome::Failed;
+            r.errorCode = EIO;
+            r.error = "verify: " + err;
+            r.ms = elapsedMs(t0);
+            return r;
+        }
+        if (written != r.checksum) {
+            ::unlink(part.c_str());
+            return fail("checksum mismatch " + destination, EIO);
+        }
+        r.verified = true;
+    }
+
+    if (::rename(part.c_str(), destination.c_str()) != 0)
+        return fail("rename " + part, errno);
+    if (options.syncOnClose)
+        syncParentDirectory(destination);
+
+    r.outcome = offset > 0 ? CopyOutcome::Resumed : CopyOutcome::Copied;
+    r.ms = elapsedMs(t0);
+    return r;
+}
+
+struct FileExportEngine::Batch {
+    uint64_t id{0};
+    std::vector<ExportItem> items;
+    std::vector<uint64_t> itemBytes;
+    CopyOptions options;
+    Callbacks callbacks;
+    int progressIntervalMs{500};
+    std::chrono::steady_clock::time_point startedAt;
+    uint64_t bytesTotal{0};
+
+    std::atomic<bool> cancelled{false};
+    std::atomic<uint64_t> bytesDone{0};
+    std::atomic<uint64_t> bytesWritten{0};
+
+    mutable std::mutex mutex; // 保护以下字段
+    std::vector<char> succeeded;
+    size_t filesDone{0};
+    size_t filesSkipped{0};
+    size_t filesFailed{0};
+    size_t remaining{0};
+    bool finished{false};
+    std::chrono::steady_clock::time_point lastReportAt;
+    std::chrono::steady_clock::time_point lastSampleAt;
+    uint64_t lastSampleBytes{0};
+    double rate{0.0};
+};
+
+FileExportEngine::FileExportEngine(size_t workers, size_t perDeviceLimit)
+    : m_defaultDeviceLimit(std::max<size_t>(1, perDeviceLimit))
+{
+    const size_t n = std::max<size_t>(1, workers);
+    m_threads.reserve(n);
+    for (size_t i = 0; i < n; ++i)
+        m_threads.emplace_back(&FileExportEngine::run, this);
+}
+
+FileExportEngine::~FileExportEngine()
+{
+    stop();
+}
+
+uint64_t FileExportEngine::submit(std::vector<ExportItem> items,
+                                  const CopyOptions& options,
+                                  Callbacks callbacks,
+                                  int progressIntervalMs)
+{
+    if (items.empty())
+        return 0;
+
+    auto batch = std::make_shared<Batch>();
+    batch->options = options;
+    batch->callbacks = std::move(callbacks);
+    batch->progressIntervalMs = std::max(50, progressIntervalMs);
+    batch->itemBytes.reserve(items.size());
+    std::vector<dev_t> devices;
+    devices.reserve(items.size());
+    for (const auto& item : items) {
+        struct stat st;
+        const uint64_t bytes = (::stat(item.source.c_str(), &st) == 0) ? static_cast<uint64_t>(st.st_size) : 0;
+        batch->itemBytes.push_back(bytes);
+        batch->bytesTotal += bytes;
+        devices.push_back(destinationDevice(item.destination));
+    }
+    batch->items = std::move(items);
+    batch->succeeded.assign(batch->items.size(), 0);
+    batch->remaining = batch->items.size();
+    batch->startedAt = std::chrono::steady_clock::now();
+    batch->lastReportAt = batch->startedAt;
+    batch->lastSampleAt = batch->startedAt;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_stopping)
+            return 0;
+        batch->id = m_nextBatchId++;
+        for (size_t i = 0; i < batch->items.size(); ++i)
+            m_queue.push_back(Task{batch, i, devices[i]});
+        m_batches[batch->id] = batch;
+    }
+    m_cvWork.notify_all();
+    return batch->id;
+}
+
+bool FileExportEngine::cancel(uint64_t batchId)
+{
+    std::shared_ptr<Batch> batch;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_batches.find(batchId);
+        if (it == m_batches.end())
+            return false;
+        batch = it->second;
+    }
+    batch->cancelled.store(true);
+    m_cvWork.notify_all();
+    return true;
+}
+
+void FileExportEngine::cancelAll()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (auto& kv : m_batches)
+            kv.second->cancelled.store(true);
+    }
+    m_cvWork.notify_all();
+}
+
+void FileExportEngine::setDeviceLimit(dev_t device, size_t limit)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (limit == 0)
+            m_deviceLimits.erase(device);
+        else
+            m_deviceLimits[device] = limit;
+    }
+    m_cvWork.notify_all();
+}
+
+std::vector<ExportItem> FileExportEngine::unfinishedItems(uint64_t batchId) const
+{
+    std::shared_ptr<Batch> batch;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_batches.find(batchId);
+        if (it == m_batches.end())
+            return {};
+        batch = it->second;
+    }
+    std::vector<ExportItem> out;
+    std::lock_guard<std::mutex> lock(batch->mutex);
+    for (size_t i = 0; i < batch->items.size(); ++i) {
+        if (!batch->succeeded[i])
+            out.push_back(batch->items[i]);
+    }
+    return out;
+}
+
+bool FileExportEngine::isActive(uint64_t batchId) const
+{
+    std::shared_ptr<Batch> batch;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_batches.find(batchId);
+        if (it == m_batches.end())
+            return false;
+        batch = it->second;
+    }
+    std::lock_guard<std::mutex> lock(batch->mutex);
+    return !batch->finished;
+}
+
+bool FileExportEngine::busy() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return !m_queue.empty() || m_running > 0;
+}
+
+bool FileExportEngine::waitIdle(int timeoutMs)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    auto idle = [this]() { return m_queue.empty() && m_running == 0; };
+    if (timeoutMs < 0) {
+        m_cvIdle.wait(lock, idle);
+        return true;
+    }
+    return m_cvIdle.wait_for(lock, std::chrono::milliseconds(timeoutMs), idle);
+}
+
+void FileExportEngine::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_stopping && m_threads.empty())
+            return;
+        m_stopping = true;
+        for (auto& kv : m_batches)
+            kv.second->cancelled.store(true);
+    }
+    m_cvWork.notify_all();
+    for (auto& t : m_threads) {
+        if (t.joinable())
+            t.join();
+    }
+    m_threads.clear();
+}
+
+size_t FileExportEngine::limitFor(dev_t device) const
+{
+    auto it = m_deviceLimits.find(device);
+    return it != m_deviceLimits.end() ? it->second : m_defaultDeviceLimit;
+}
+
+bool FileExportEngine::takeTask(Task* out)
+{
+    for (auto it = m_queue.begin(); it != m_queue.end(); ++it) {
+        // 已取消批次的条目不占设备配额，直接取出结束掉
+        const bool cancelled = it->batch->cancelled.load();
+        if (cancelled || m_activePerDevice[it->device] < limitFor(it->device)) {
+            *out = std::move(*it);
+            m_queue.erase(it);
+            ++m_activePerDevice[out->device];
+            ++m_running;
+            return true;
+        }
+    }
+    return false;
+}
+
+void FileExportEngine::run()
+{
+    for (;;) {
+        Task task;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_cvWork.wait(lock, [&]() {
+                if (m_stopping) {
+                    // 停止时把剩余条目（均已标记取消）全部走完，保证每个批次都收到 onFinished
+                    return true;
+                }
+                for (const auto& t : m_queue) {
+                    if (t.batch->cancelled.load() || m_activePerDevice[t.device] < limitFor(t.device))
+                        return true;
+                }
+                return false;
+            });
+            if (!takeTask(&task)) {
+                if (m_stopping && m_queue.empty())
+                    return;
+                continue;
+            }
+        }
+
+        Batch& batch = *task.batch;
+        const ExportItem& item = batch.items[task.index];
+        CopyResult result;
+        if (batch.cancelled.load()) {
+            result.outcome = CopyOutcome::Cancelled;
+            result.error = "cancelled";
+            result.fileBytes = batch.itemBytes[task.index];
+        } else {
+            uint64_t reported = 0;
+            result = copyFile(item.source, item.destination, batch.options,
+                              [&](uint64_t n, bool transferred) {
+                                  reported += n;
+                                  batch.bytesDone.fetch_add(n, std::memory_order_relaxed);
+                                  if (transferred)
+                                      batch.bytesWritten.fetch_add(n, std::memory_order_relaxed);
+                                  reportProgress(batch, false);
+                              },
+                              &batch.cancelled);
+            if (!result.ok() && (result.errorCode == EACCES || result.errorCode == EPERM) &&
+                batch.callbacks.onPermissionDenied && !batch.cancelled.load()) {
+                std::string fallbackError;
+                if (batch.callbacks.onPermissionDenied(item, &fallbackError)) {
+                    result.outcome = CopyOutcome::Copied;
+                    result.error.clear();
+                    result.errorCode = 0;
+                    result.transferredBytes = result.fileBytes;
+                    result.method = "fallback";
+                } else {
+                    result.error += " | fallback: " + fallbackError;
+                }
+            }
+            // 失败/取消的文件按"已处理"计入，保证批次结束时进度到 100%、ETA 不被卡住
+            const uint64_t expected = batch.itemBytes[task.index];
+            if (reported < expected)
+                batch.bytesDone.fetch_add(expected - reported, std::memory_order_relaxed);
+        }
+
+        finishTask(task, result);
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            --m_activePerDevice[task.device];
+            --m_running;
+        }
+        m_cvWork.notify_all();
+        m_cvIdle.notify_all();
+    }
+}
+
+void FileExportEngine::finishTask(const Task& task, const CopyResult& result)
+{
+    Batch& batch = *task.batch;
+    bool finished = false;
+    {
+        std::lock_guard<std::mutex> lock(batch.mutex);
+        if (result.ok()) {
+            batch.succeeded[task.index] = 1;
+            ++batch.filesDone;
+            if (result.outcome == CopyOutcome::Skipped)
+                ++batch.filesSkipped;
+        } else if (result.outcome == CopyOutcome::Failed) {
+            ++batch.filesFailed;
+        }
+        finished = (--batch.remaining == 0);
+    }
+
+    if (batch.callbacks.onFileDone) {
+        ExportFileEvent ev;
+        ev.batchId = batch.id;
+        ev.index = task.index;
+        ev.item = batch.items[task.index];
+        ev.result = result;
+        batch.callbacks.onFileDone(ev);
+    }
+    if (!finished) {
+        reportProgress(batch, false);
+        return;
+    }
+
+    ExportProgress last;
+    {
+        std::lock_guard<std::mutex> lock(batch.mutex);
+        batch.finished = true;
+        last = snapshot(batch);
+    }
+    if (batch.callbacks.onProgress)
+        batch.callbacks.onProgress(last);
+    if (batch.callbacks.onFinished)
+        batch.callbacks.onFinished(last);
+
+    // 只保留最近几个已结束批次，供续传查询
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::vector<uint64_t> done;
+    for (const auto& kv : m_batches) {
+        std::lock_guard<std::mutex> batchLock(kv.second->mutex);
+        if (kv.second->finished)
+            done.push_back(kv.first);
+    }
+    for (size_t i = 0; i + kFinishedBatchesKept < done.size(); ++i)
+        m_batches.erase(done[i]);
+}
+
+ExportProgress FileExportEngine::snapshot(const Batch& batch) const
+{
+    ExportProgress p;
+    p.batchId = batch.id;
+    p.filesTotal = batch.items.size();
+    p.filesDone = batch.filesDone;
+    p.filesSkipped = batch.filesSkipped;
+    p.filesFailed = batch.filesFailed;
+    p.bytesTotal = batch.bytesTotal;
+    p.bytesDone = std::min(batch.bytesDone.load(std::memory_order_relaxed), batch.bytesTotal);
+    p.bytesPerSec = batch.rate;
+    p.elapsedSec = std::chrono::duration<double>(std::chrono::steady_clock::now() - batch.startedAt).count();
+    p.finished = batch.finished;
+    p.cancelled = batch.cancelled.load();
+    if (p.finished)
+        p.etaSec = 0.0;
+    else if (batch.rate > 0.0)
+        p.etaSec = static_cast<double>(p.bytesTotal - p.bytesDone) / batch.rate;
+    return p;
+}
+
+void FileExportEngine::reportProgress(Batch& batch, bool force)
+{
+    if (!batch.callbacks.onProgress)
+        return;
+    ExportProgress p;
+    {
+        std::lock_guard<std::mutex> lock(batch.mutex);
+        if (batch.finished)
+            return; // 最终进度由 finishTask 发送
+        const auto now = std::chrono::steady_clock::now();
+        if (!force && now - batch.lastReportAt < std::chrono::milliseconds(batch.progressIntervalMs))
+            return;
+        batch.lastReportAt = now;
+
+        // 吞吐：按上次采样以来实际写入的字节做指数平滑（跳过/续传的已有部分不计入）
+        const double dt = std::chrono::duration<double>(now - batch.lastSampleAt).count();
+        if (dt >= 0.2) {
+            const uint64_t written = batch.bytesWritten.load(std::memory_order_relaxed);
+            const double inst = static_cast<double>(written - batch.lastSampleBytes) / dt;
+            batch.rate = (batch.rate <= 0.0) ? inst : 0.7 * batch.rate + 0.3 * inst;
+            batch.lastSampleAt = now;
+            batch.lastSampleBytes = written;
+        }
+        p = snapshot(batch);
+    }
+    batch.callbacks.onProgress(p);
+}
+
+} // namespace storage
@@ -0,0 +1,188 @@
+#pragma once
+
+#include <sys/types.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace storage {
+
+// 流式 XXH64（与 xxHash 的 XXH64 seed=0 结果一致），用于导出后的校验
+class Xxh64
+{
+public:
+    explicit Xxh64(uint64_t seed = 0);
+    void update(const void* data, size_t len);
+    uint64_t digest() const;
+
+private:
+    uint64_t m_v[4];
+    uint64_t m_total{0};
+    uint64_t m_seed;
+    unsigned char m_buf[32];
+    size_t m_bufLen{0};
+};
+
+// 计算整个文件的 XXH64；dropCache=true 时先丢弃该文件的页缓存，保证读的是设备上的真实数据
+bool fileChecksum(const std::string& path, uint64_t* out, bool dropCache = false, std::string* error = nullptr);
+
+struct CopyOptions {
+    // 续传：目标已存在且大小/mtime 一致视为已完成（跳过）；存在 "<dst>.part" 时从其末尾继续
+    bool resume{true};
+    // 校验：复制时计算源 XXH64，落盘后丢弃缓存重读目标比对；不一致删除 .part 并报失败
+    bool verify{false};
+    // 单次系统调用搬运的字节数（也是进度回调粒度）
+    size_t chunkBytes{8u << 20};
+    // 关闭前 fdatasync：U 盘拔出前数据已在设备上，进度/完成消息不会"虚高"
+    bool syncOnClose{true};
+};
+
+enum class CopyOutcome {
+    Copied,    ///< 从头复制
+    Resumed,   ///< 从 .part 末尾续传
+    Skipped,   ///< 目标已是完整副本
+    Failed,
+    Cancelled, ///< 被取消，.part 保留以便续传
+};
+
+const char* copyOutcomeName(CopyOutcome outcome);
+
+struct CopyResult {
+    CopyOutcome outcome{CopyOutcome::Failed};
+    std::string error;
+    int errorCode{0};            ///< errno（失败时）
+    uint64_t fileBytes{0};       ///< 源文件大小
+    uint64_t transferredBytes{0};///< 本次实际写入的字节数
+    uint64_t resumedFrom{0};     ///< 续传起点
+    bool verified{false};
+    uint64_t checksum{0};        ///< verify 时的 XXH64
+    const char* method{"none"};  ///< copy_file_range / sendfile / read-write
+    double ms{0.0};
+
+    bool ok() const
+    {
+        return outcome == CopyOutcome::Copied || outcome == CopyOutcome::Resumed || outcome == CopyOutcome::Skipped;
+    }
+};
+
+// 同步复制单个文件（在调用线程完成）：
+// - 先写 "<dst>.part" 再 rename，读方不会看到半个文件
+// - 优先 copy_file_range，跨文件系统退到 sendfile，再退到 read/write；verify 时走 read/write 以便同时计算源校验
+// - 目标父目录不存在时自动创建
+// onBytes(n, transferred) 每搬完一个 chunk 调用一次；续传已有部分/跳过的文件以 transferred=false 报告一次
+CopyResult copyFile(const std::string& source,
+                    const std::string& destination,
+                    const CopyOptions& options,
+                    const std::function<void(uint64_t, bool)>& onBytes = {},
+                    const std::atomic<bool>* cancel = nullptr);
+
+struct ExportItem {
+    std::string source;
+    std::string destination;
+};
+
+struct ExportProgress {
+    uint64_t batchId{0};
+    size_t filesTotal{0};
+    size_t filesDone{0};     ///< 已成功（含跳过）
+    size_t filesSkipped{0};
+    size_t filesFailed{0};
+    uint64_t bytesTotal{0};
+    uint64_t bytesDone{0};   ///< 已处理字节（含跳过、续传已有部分及失败文件）
+    double bytesPerSec{0.0}; ///< 实际写入吞吐（平滑）
+    double etaSec{-1.0};     ///< <0 表示未知
+    double elapsedSec{0.0};
+    bool finished{false};
+    bool cancelled{false};
+};
+
+struct ExportFileEvent {
+    uint64_t batchId{0};
+    size_t index{0};
+    ExportItem item;
+    CopyResult result;
+};
+
+// 批量导出引擎：
+// - 少量工作线程并行复制；按目标所在设备（st_dev）限制并发，默认每个设备同一时刻只写一个文件（U 盘并行写反而更慢）
+// - 字节级进度：按 progressIntervalMs 节流回调，附带平滑吞吐与 ETA
+// - cancel() 后正在复制的文件保留 .part；unfinishedItems() 取出未完成项重新 submit 即可续传
+// 回调均在工作线程调用，调用方需要时自行切回主线程
+class FileExportEngine
+{
+public:
+    struct Callbacks {
+        std::function<void(const ExportFileEvent&)> onFileDone;
+        std::function<void(const ExportProgress&)> onProgress;
+        std::function<void(const ExportProgress&)> onFinished;
+        // 可选：复制因权限失败（EACCES/EPERM）时在工作线程调用的回退（如提权 cp），返回 true 视为已复制
+        std::function<bool(const ExportItem&, std::string* error)> onPermissionDenied;
+    };
+
+    explicit FileExportEngine(size_t workers = 3, size_t perDeviceLimit = 1);
+    ~FileExportEngine(); // 取消全部批次并等待线程退出
+
+    FileExportEngine(const FileExportEngine&) = delete;
+    FileExportEngine& operator=(const FileExportEngine&) = delete;
+
+    // 返回批次 id；items 为空或引擎已停止返回 0
+    uint64_t submit(std::vector<ExportItem> items,
+                    const CopyOptions& options,
+                    Callbacks callbacks,
+                    int progressIntervalMs = 500);
+
+    bool cancel(uint64_t batchId);
+    void cancelAll();
+
+    // 指定设备的并发上限（0 表示使用默认值）
+    void setDeviceLimit(dev_t device, size_t limit);
+
+    // 批次中尚未成功完成的条目（失败/取消/未开始），批次结束后仍可查询最近的批次
+    std::vector<ExportItem> unfinishedItems(uint64_t batchId) const;
+    bool isActive(uint64_t batchId) const;
+    bool busy() const;
+    bool waitIdle(int timeoutMs);
+
+    void stop();
+
+private:
+    struct Batch;
+    struct Task {
+        std::shared_ptr<Batch> batch;
+        size_t index{0};
+        dev_t device{0};
+    };
+
+    void run();
+    bool takeTask(Task* out); // 需持有 m_mutex
+    size_t limitFor(dev_t device) const;
+    void reportProgress(Batch& batch, bool force);
+    void finishTask(const Task& task, const CopyResult& result);
+    ExportProgress snapshot(const Batch& batch) const;
+
+    const size_t m_defaultDeviceLimit;
+    mutable std::mutex m_mutex;
+    std::condition_variable m_cvWork;
+    std::condition_variable m_cvIdle;
+    std::deque<Task> m_queue;
+    std::map<dev_t, size_t> m_activePerDevice;
+    std::map<dev_t, size_t> m_deviceLimits;
+    std::map<uint64_t, std::shared_ptr<Batch>> m_batches; // 活动批次 + 最近结束的批次（用于续传）
+    size_t m_running{0};
+    uint64_t m_nextBatchId{1};
+    bool m_stopping{false};
+    std::vector<std::thread> m_threads;
+};
+
+} // namespace storage
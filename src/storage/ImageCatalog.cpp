@@ -0,0 +1,997 @@
+#include "ImageCatalog.h"
+#include "FileExportEngine.h" // Xxh64
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <set>
+
+namespace storage {
+
+namespace {
+
+constexpr char kLogMagic[8] = {'Q', 'C', 'A', 'T', 'L', 'O', 'G', '1'};
+constexpr uint32_t kThumbMagic = 0x42485451; // "QTHB"
+constexpr size_t kMaxRecordBytes = 1u << 20;
+
+void putRaw(std::string& s, const void* p, size_t n) { s.append(static_cast<const char*>(p), n); }
+template <typename T> void put(std::string& s, T v) { putRaw(s, &v, sizeof(v)); }
+void putStr(std::string& s, const std::string& v)
+{
+    const uint16_t n = static_cast<uint16_t>(std::min<size_t>(v.size(), 0xFFFF));
+    put(s, n);
+    putRaw(s, v.data(), n);
+}
+
+struct Cursor {
+    const char* p;
+    const char* end;
+    bool ok{true};
+
+    template <typename T> T get()
+    {
+        T v{};
+        if (end - p < static_cast<ptrdiff_t>(sizeof(T))) {
+            ok = false;
+            return v;
+        }
+        std::memcpy(&v, p, sizeof(T));
+        p += sizeof(T);
+        return v;
+    }
+    std::string str()
+    {
+        const uint16_t n = get<uint16_t>();
+        if (!ok || end - p < n) {
+            ok = false;
+            return std::string();
+        }
+        std::string v(p, n);
+        p += n;
+        return v;
+    }
+};
+
+uint32_t recordCheck(uint8_t type, const char* payload, size_t len)
+{
+    Xxh64 h;
+    h.update(&type, 1);
+    h.update(payload, len);
+    return static_cast<uint32_t>(h.digest());
+}
+
+uint64_t pathHash(const std::string& relPath)
+{
+    Xxh64 h;
+    h.update(relPath.data(), relPath.size());
+    return h.digest();
+}
+
+bool writeAll(int fd, const void* data, size_t len)
+{
+    const char* p = static_cast<const char*>(data);
+    while (len > 0) {
+        const ssize_t n = ::write(fd, p, len);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return false;
+        p += n;
+        len -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+bool pwriteAllAt(int fd, const void* data, size_t len, uint64_t offset)
+{
+    const char* p = static_cast<const char*>(data);
+    while (len > 0) {
+        const ssize_t n = ::pwrite(fd, p, len, static_cast<off_t>(offset));
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return false;
+        p += n;
+        len -= static_cast<size_t>(n);
+        offset += static_cast<uint64_t>(n);
+    }
+    return true;
+}
+
+bool preadAllAt(int fd, void* data, size_t len, uint64_t offset)
+{
+    char* p = static_cast<char*>(data);
+    while (len > 0) {
+        const ssize_t n = ::pread(fd, p, len, static_cast<off_t>(offset));
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return false;
+        p += n;
+        len -= static_cast<size_t>(n);
+        offset += static_cast<uint64_t>(n);
+    }
+    return true;
+}
+
+int64_t mtimeNsOf(const struct stat& st)
+{
+    return static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000LL + st.st_mtim.tv_nsec;
+}
+
+bool isIgnoredName(const char* name)
+{
+    if (name[0] == '.')
+        return true;
+    const size_t n = std::strlen(name);
+    return n > 5 && std::strcmp(name + n - 5, ".part") == 0;
+}
+
+std::string lower(std::string s)
+{
+    std::transform(s.begin(), s.end(), s.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return s;
+}
+
+std::string encodeEntry(const CatalogEntry& e)
+{
+    std::string s;
+    putStr(s, e.category);
+    putStr(s, e.folder);
+    putStr(s, e.name);
+    put<uint64_t>(s, e.size);
+    put<int64_t>(s, e.mtimeNs);
+    put<int64_t>(s, e.meta.captureTimeMs);
+    putStr(s, e.meta.object);
+    putStr(s, e.meta.filter);
+    put<double>(s, e.meta.exposureSec);
+    putStr(s, e.meta.imageType);
+    put<int64_t>(s, e.thumbOffset);
+    put<uint32_t>(s, e.thumbBytes);
+    return s;
+}
+
+bool decodeEntry(Cursor& c, CatalogEntry* e)
+{
+    e->category = c.str();
+    e->folder = c.str();
+    e->name = c.str();
+    e->size = c.get<uint64_t>();
+    e->mtimeNs = c.get<int64_t>();
+    e->meta.captureTimeMs = c.get<int64_t>();
+    e->meta.object = c.str();
+    e->meta.filter = c.str();
+    e->meta.exposureSec = c.get<double>();
+    e->meta.imageType = c.str();
+    e->thumbOffset = c.get<int64_t>();
+    e->thumbBytes = c.get<uint32_t>();
+    return c.ok;
+}
+
+} // namespace
+
+ImageCatalog::ImageCatalog(std::string rootDir,
+                           std::vector<std::string> categories,
+                           std::string indexPath,
+                           MetaReader reader)
+    : m_root(std::filesystem::path(rootDir).lexically_normal().string())
+    , m_categories(std::move(categories))
+    , m_indexPath(indexPath)
+    , m_thumbPath(indexPath + ".thumbs")
+    , m_reader(std::move(reader))
+{
+}
+
+ImageCatalog::~ImageCatalog()
+{
+    stop();
+    if (m_logFd >= 0)
+        ::close(m_logFd);
+    if (m_thumbFd >= 0)
+        ::close(m_thumbFd);
+}
+
+bool ImageCatalog::open(std::string* error)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    // 重放期间不得追加日志（removeFolderLocked 会写记录）
+    if (m_logFd >= 0) {
+        ::close(m_logFd);
+        m_logFd = -1;
+    }
+    m_entries.clear();
+    m_folderStamps.clear();
+    m_logRecords = 0;
+
+    std::error_code ec;
+    std::filesystem::create_directories(std::filesystem::path(m_indexPath).parent_path(), ec);
+
+    int fd = ::open(m_indexPath.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        if (error)
+            *error = "open " + m_indexPath + ": " + std::strerror(errno);
+        return false;
+    }
+
+    struct stat st;
+    std::string data;
+    if (::fstat(fd, &st) == 0 && st.st_size > 0) {
+        data.resize(static_cast<size_t>(st.st_size));
+        if (!preadAllAt(fd, &data[0], data.size(), 0))
+            data.clear();
+    }
+
+    // 重放日志；遇到损坏/不完整的记录（断电时正在追加）就截断到最后一条完整记录
+    size_t good = 0;
+    if (data.size() >= sizeof(kLogMagic) && std::memcmp(data.data(), kLogMagic, sizeof(kLogMagic)) == 0) {
+        size_t pos = sizeof(kLogMagic);
+        good = pos;
+        while (data.size() - pos >= 4 + 1 + 4) {
+            uint32_t len = 0;
+            std::memcpy(&len, data.data() + pos, 4);
+            if (len > kMaxRecordBytes || data.size() - pos < 4 + 1 + static_cast<size_t>(len) + 4)
+                break;
+            const uint8_t type = static_cast<uint8_t>(data[pos + 4]);
+            const char* payload = data.data() + pos + 5;
+            uint32_t check = 0;
+            std::memcpy(&check, payload + len, 4);
+            if (check != recordCheck(type, payload, len))
+                break;
+
+            Cursor c{payload, payload + len};
+            if (type == RecUpsert) {
+                CatalogEntry e;
+                if (decodeEntry(c, &e))
+                    m_entries[e.relPath()] = std::move(e);
+            } else if (type == RecRemove) {
+                m_entries.erase(c.str());
+            } else if (type == RecFolderStamp) {
+                FolderKey key;
+                key.category = c.str();
+                key.folder = c.str();
+                const int64_t mtime = c.get<int64_t>();
+                if (c.ok)
+                    m_folderStamps[key] = mtime;
+            } else if (type == RecRemoveFolder) {
+                const std::string category = c.str();
+                const std::string folder = c.str();
+                if (c.ok)
+                    removeFolderLocked(category, folder);
+            }
+            ++m_logRecords;
+            pos += 4 + 1 + len + 4;
+            good = pos;
+        }
+    }
+
+    if (good == 0) {
+        // 新建或格式不认识：重写文件头（索引只是缓存，reconcile 会补齐）
+        if (::ftruncate(fd, 0) != 0 || !pwriteAllAt(fd, kLogMagic, sizeof(kLogMagic), 0)) {
+            if (error)
+                *error = "init " + m_indexPath + ": " + std::strerror(errno);
+            ::close(fd);
+            return false;
+        }
+    } else if (good < data.size()) {
+        if (::ftruncate(fd, static_cast<off_t>(good)) != 0) {
+            if (error)
+                *error = "truncate " + m_indexPath + ": " + std::strerror(errno);
+            ::close(fd);
+            return false;
+        }
+    }
+    ::close(fd);
+
+    m_logFd = ::open(m_indexPath.c_str(), O_WRONLY | O_APPEND | O_CLOEXEC);
+    if (m_thumbFd >= 0)
+        ::close(m_thumbFd);
+    m_thumbFd = ::open(m_thumbPath.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (m_logFd < 0 || m_thumbFd < 0) {
+        if (error)
+            *error = "open " + m_indexPath + ": " + std::strerror(errno);
+        return false;
+    }
+
+    m_thumbFileBytes = (::fstat(m_thumbFd, &st) == 0) ? static_cast<uint64_t>(st.st_size) : 0;
+    m_thumbLiveBytes = 0;
+    for (auto& kv : m_entries) {
+        CatalogEntry& e = kv.second;
+        if (e.thumbOffset >= 0 && static_cast<uint64_t>(e.thumbOffset) + e.thumbBytes > m_thumbFileBytes) {
+            e.thumbOffset = -1; // 缩略图文件比日志短（被截断/删除）
+            e.thumbBytes = 0;
+        }
+        if (e.thumbOffset >= 0)
+            m_thumbLiveBytes += e.thumbBytes;
+    }
+    maybeCompactLocked();
+    return true;
+}
+
+int ImageCatalog::splitPath(const std::string& absPath, std::string* category, std::string* folder, std::string* name) const
+{
+    const std::string p = std::filesystem::path(absPath).lexically_normal().string();
+    if (p.size() <= m_root.size() + 1 || p.compare(0, m_root.size(), m_root) != 0 || p[m_root.size()] != '/')
+        return 0;
+
+    std::vector<std::string> parts;
+    size_t start = m_root.size() + 1;
+    while (start <= p.size()) {
+        const size_t slash = p.find('/', start);
+        const size_t end = (slash == std::string::npos) ? p.size() : slash;
+        if (end > start)
+            parts.push_back(p.substr(start, end - start));
+        if (slash == std::string::npos)
+            break;
+        start = slash + 1;
+    }
+    if (parts.empty() || parts.size() > 3)
+        return 0;
+    if (std::find(m_categories.begin(), m_categories.end(), parts[0]) == m_categories.end())
+        return 0;
+
+    *category = parts[0];
+    *folder = parts.size() > 1 ? parts[1] : std::string();
+    *name = parts.size() > 2 ? parts[2] : std::string();
+    return static_cast<int>(parts.size());
+}
+
+bool ImageCatalog::buildEntry(const std::string& category, const std::string& folder, const std::string& name,
+                              CatalogEntry* out) const
+{
+    const std::string abs = m_root + "/" + category + "/" + folder + "/" + name;
+    struct stat st;
+    if (::stat(abs.c_str(), &st) != 0 || !S_ISREG(st.st_mode))
+        return false;
+
+    out->category = category;
+    out->folder = folder;
+    out->name = name;
+    out->size = static_cast<uint64_t>(st.st_size);
+    out->mtimeNs = mtimeNsOf(st);
+    out->meta = ImageMeta();
+    if (!m_reader || !m_reader(abs, &out->meta))
+        out->meta = ImageMeta();
+    if (out->meta.captureTimeMs <= 0)
+        out->meta.captureTimeMs = out->mtimeNs / 1000000;
+    return true;
+}
+
+size_t ImageCatalog::reconcile()
+{
+    size_t changes = 0;
+    for (const auto& category : m_categories) {
+        const std::string catDir = m_root + "/" + category;
+        std::set<std::string> seen;
+        if (DIR* dir = ::opendir(catDir.c_str())) {
+            while (struct dirent* de = ::readdir(dir)) {
+                if (isIgnoredName(de->d_name))
+                    continue;
+                struct stat st;
+                const std::string sub = catDir + "/" + de->d_name;
+                if (::stat(sub.c_str(), &st) != 0 || !S_ISDIR(st.st_mode))
+                    continue;
+                seen.insert(de->d_name);
+            }
+            ::closedir(dir);
+        }
+
+        std::vector<std::string> gone;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            for (const auto& kv : m_folderStamps) {
+                if (kv.first.category == category && !seen.count(kv.first.folder))
+                    gone.push_back(kv.first.folder);
+            }
+            for (const auto& folder : gone)
+                changes += removeFolderLocked(category, folder);
+        }
+
+        for (const auto& folder : seen) {
+            if (m_stopping.load())
+                return changes;
+            changes += rescanFolder(category, folder);
+        }
+    }
+    return changes;
+}
+
+size_t ImageCatalog::rescanFolder(const std::string& category, const std::string& folder)
+{
+    const std::string dirPath = m_root + "/" + category + "/" + folder;
+    const FolderKey key{category, folder};
+
+    // 先取目录 mtime 再列目录：扫描期间新增的文件会让 mtime 变化，下次对账还会再扫
+    struct stat dst;
+    if (::stat(dirPath.c_str(), &dst) != 0 || !S_ISDIR(dst.st_mode)) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return removeFolderLocked(category, folder);
+    }
+    const int64_t dirMtime = mtimeNsOf(dst);
+
+    std::map<std::string, std::pair<uint64_t, int64_t>> known; // name -> (size, mtime)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto stamp = m_folderStamps.find(key);
+        if (stamp != m_folderStamps.end() && stamp->second == dirMtime)
+            return 0;
+        const std::string prefix = category + "/" + folder + "/";
+        for (auto it = m_entries.lower_bound(prefix); it != m_entries.end() && it->first.compare(0, prefix.size(), prefix) == 0; ++it)
+            known[it->second.name] = {it->second.size, it->second.mtimeNs};
+    }
+
+    std::set<std::string> present;
+    std::vector<CatalogEntry> updates;
+    if (DIR* dir = ::opendir(dirPath.c_str())) {
+        while (struct dirent* de = ::readdir(dir)) {
+            if (isIgnoredName(de->d_name))
+                continue;
+            const std::string name = de->d_name;
+            struct stat st;
+            if (::stat((dirPath + "/" + name).c_str(), &st) != 0 || !S_ISREG(st.st_mode))
+                continue;
+            present.insert(name);
+            auto k = known.find(name);
+            if (k != known.end() && k->second.first == static_cast<uint64_t>(st.st_size) && k->second.second == mtimeNsOf(st))
+                continue;
+            CatalogEntry e;
+            if (buildEntry(category, folder, name, &e))
+                updates.push_back(std::move(e));
+        }
+        ::closedir(dir);
+    }
+
+    size_t changes = 0;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (auto& e : updates) {
+        const std::string rel = e.relPath();
+        auto it = m_entries.find(rel);
+        if (it != m_entries.end() && it->second.thumbOffset >= 0)
+            m_thumbLiveBytes -= std::min<uint64_t>(m_thumbLiveBytes, it->second.thumbBytes); // 文件变了，缩略图作废
+        appendUpsertLocked(e);
+        m_entries[rel] = std::move(e);
+        ++changes;
+    }
+    for (const auto& kv : known) {
+        if (present.count(kv.first))
+            continue;
+        const std::string rel = category + "/" + folder + "/" + kv.first;
+        auto it = m_entries.find(rel);
+        if (it == m_entries.end())
+            continue;
+        if (it->second.thumbOffset >= 0)
+            m_thumbLiveBytes -= std::min<uint64_t>(m_thumbLiveBytes, it->second.thumbBytes);
+        m_entries.erase(it);
+        appendRemoveLocked(rel);
+        ++changes;
+    }
+    m_folderStamps[key] = dirMtime;
+    appendFolderStampLocked(key, dirMtime);
+    maybeCompactLocked();
+    return changes;
+}
+
+size_t ImageCatalog::removeFolderLocked(const std::string& category, const std::string& folder)
+{
+    size_t removed = 0;
+    const std::string prefix = folder.empty() ? category + "/" : category + "/" + folder + "/";
+    for (auto it = m_entries.lower_bound(prefix); it != m_entries.end() && it->first.compare(0, prefix.size(), prefix) == 0;) {
+        if (it->second.thumbOffset >= 0)
+            m_thumbLiveBytes -= std::min<uint64_t>(m_thumbLiveBytes, it->second.thumbBytes);
+        it = m_entries.erase(it);
+        ++removed;
+    }
+    for (auto it = m_folderStamps.begin(); it != m_folderStamps.end();) {
+        if (it->first.category == category && (folder.empty() || it->first.folder == folder))
+            it = m_folderStamps.erase(it);
+        else
+            ++it;
+    }
+    if (m_logFd >= 0)
+        appendRemoveFolderLocked(FolderKey{category, folder});
+    return removed;
+}
+
+void ImageCatalog::recordFile(const std::string& absPath, const std::vector<unsigned char>* thumbnail)
+{
+    std::string category, folder, name;
+    if (splitPath(absPath, &category, &folder, &name) != 3 || isIgnoredName(name.c_str()))
+        return;
+
+    CatalogEntry e;
+    {
+        // 未变化且不带新缩略图：不重复读 FITS 头
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_entries.find(category + "/" + folder + "/" + name);
+        struct stat st;
+        if (!thumbnail && it != m_entries.end() && ::stat(absPath.c_str(), &st) == 0 &&
+            it->second.size == static_cast<uint64_t>(st.st_size) && it->second.mtimeNs == mtimeNsOf(st))
+            return;
+    }
+    if (!buildEntry(category, folder, name, &e))
+        return;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const std::string rel = e.relPath();
+    auto it = m_entries.find(rel);
+    if (it != m_entries.end() && it->second.thumbOffset >= 0) {
+        if (!thumbnail && it->second.size == e.size && it->second.mtimeNs == e.mtimeNs) {
+            e.thumbOffset = it->second.thumbOffset; // 同一文件：保留已有缩略图
+            e.thumbBytes = it->second.thumbBytes;
+        } else {
+            m_thumbLiveBytes -= std::min<uint64_t>(m_thumbLiveBytes, it->second.thumbBytes);
+        }
+    }
+    if (thumbnail && !thumbnail->empty()) {
+        const int64_t off = appendThumbnailLocked(rel, *thumbnail);
+        if (off >= 0) {
+            e.thumbOffset = off;
+            e.thumbBytes = static_cast<uint32_t>(thumbnail->size());
+            m_thumbLiveBytes += e.thumbBytes;
+        }
+    }
+    appendUpsertLocked(e);
+    m_entries[rel] = std::move(e);
+    // 目录章（folder stamp）不更新：下次对账仍会核对该目录，避免漏掉同时写入的其它文件
+    maybeCompactLocked();
+}
+
+void ImageCatalog::removePath(const std::string& absPath)
+{
+    std::string category, folder, name;
+    const int depth = splitPath(absPath, &category, &folder, &name);
+    if (depth == 0)
+        return;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (depth == 3) {
+        const std::string rel = category + "/" + folder + "/" + name;
+        auto it = m_entries.find(rel);
+        if (it == m_entries.end())
+            return;
+        if (it->second.thumbOffset >= 0)
+            m_thumbLiveBytes -= std::min<uint64_t>(m_thumbLiveBytes, it->second.thumbBytes);
+        m_entries.erase(it);
+        appendRemoveLocked(rel);
+    } else {
+        removeFolderLocked(category, depth == 2 ? folder : std::string());
+    }
+    maybeCompactLocked();
+}
+
+std::vector<CatalogFolder> ImageCatalog::folders(const std::string& category) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::map<std::string, CatalogFolder> byName;
+    for (const auto& kv : m_folderStamps) {
+        if (kv.first.category != category)
+            continue;
+        CatalogFolder& f = byName[kv.first.folder];
+        f.category = category;
+        f.name = kv.first.folder;
+    }
+    const std::string prefix = category + "/";
+    for (auto it = m_entries.lower_bound(prefix); it != m_entries.end() && it->first.compare(0, prefix.size(), prefix) == 0; ++it) {
+        const CatalogEntry& e = it->second;
+        CatalogFolder& f = byName[e.folder];
+        f.category = category;
+        f.name = e.folder;
+        ++f.files;
+        f.bytes += e.size;
+        f.latestCaptureMs = std::max(f.latestCaptureMs, e.meta.captureTimeMs);
+    }
+    std::vector<CatalogFolder> out;
+    out.reserve(byName.size());
+    for (auto& kv : byName)
+        out.push_back(std::move(kv.second));
+    return out;
+}
+
+CatalogPage ImageCatalog::query(const CatalogQuery& q) const
+{
+    const std::string objectNeedle = lower(q.object);
+    const std::string filterWanted = lower(q.filter);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::vector<const CatalogEntry*> hits;
+    auto begin = m_entries.begin();
+    std::string prefix;
+    if (!q.category.empty()) {
+        prefix = q.category + "/";
+        if (!q.folder.empty())
+            prefix += q.folder + "/";
+        begin = m_entries.lower_bound(prefix);
+    }
+    for (auto it = begin; it != m_entries.end(); ++it) {
+        if (!prefix.empty() && it->first.compare(0, prefix.size(), prefix) != 0)
+            break;
+        const CatalogEntry& e = it->second;
+        if (q.category.empty() && !q.folder.empty() && e.folder != q.folder)
+            continue;
+        if (!objectNeedle.empty() && lower(e.meta.object).find(objectNeedle) == std::string::npos)
+            continue;
+        if (!filterWanted.empty() && lower(e.meta.filter) != filterWanted)
+            continue;
+        if (q.minExposureSec >= 0 && e.meta.exposureSec < q.minExposureSec)
+            continue;
+        if (q.maxExposureSec >= 0 && (e.meta.exposureSec < 0 || e.meta.exposureSec > q.maxExposureSec))
+            continue;
+        if (q.fromMs > 0 && e.meta.captureTimeMs < q.fromMs)
+            continue;
+        if (q.toMs > 0 && e.meta.captureTimeMs > q.toMs)
+            continue;
+        hits.push_back(&e);
+    }
+
+    std::stable_sort(hits.begin(), hits.end(), [&](const CatalogEntry* a, const CatalogEntry* b) {
+        return q.newestFirst ? a->meta.captureTimeMs > b->meta.captureTimeMs
+                             : a->meta.captureTimeMs < b->meta.captureTimeMs;
+    });
+
+    CatalogPage page;
+    page.total = hits.size();
+    const size_t first = std::min(q.offset, hits.size());
+    const size_t last = std::min(hits.size(), first + q.limit);
+    page.entries.reserve(last - first);
+    for (size_t i = first; i < last; ++i)
+        page.entries.push_back(*hits[i]);
+    return page;
+}
+
+bool ImageCatalog::find(const std::string& relPath, CatalogEntry* out) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_entries.find(relPath);
+    if (it == m_entries.end())
+        return false;
+    if (out)
+        *out = it->second;
+    return true;
+}
+
+bool ImageCatalog::readThumbnail(const std::string& relPath, std::vector<unsigned char>* out) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_entries.find(relPath);
+    if (it == m_entries.end() || it->second.thumbOffset < 0 || m_thumbFd < 0)
+        return false;
+
+    // 块头：magic + 长度 + 路径哈希，防止日志与缩略图文件不同步时返回别人的缩略图
+    const uint64_t off = static_cast<uint64_t>(it->second.thumbOffset);
+    uint32_t head[2] = {0, 0};
+    uint64_t hash = 0;
+    if (!preadAllAt(m_thumbFd, head, sizeof(head), off) || !preadAllAt(m_thumbFd, &hash, sizeof(hash), off + sizeof(head)))
+        return false;
+    if (head[0] != kThumbMagic || head[1] != it->second.thumbBytes || hash != pathHash(relPath))
+        return false;
+    out->resize(head[1]);
+    return preadAllAt(m_thumbFd, out->data(), out->size(), off + sizeof(head) + sizeof(hash));
+}
+
+size_t ImageCatalog::size() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_entries.size();
+}
+
+void ImageCatalog::appendUpsertLocked(const CatalogEntry& e)
+{
+    appendRecordLocked(RecUpsert, encodeEntry(e));
+}
+
+void ImageCatalog::appendRemoveLocked(const std::string& relPath)
+{
+    std::string s;
+    putStr(s, relPath);
+    appendRecordLocked(RecRemove, s);
+}
+
+void ImageCatalog::appendFolderStampLocked(const FolderKey& key, int64_t mtimeNs)
+{
+    std::string s;
+    putStr(s, key.category);
+    putStr(s, key.folder);
+    put<int64_t>(s, mtimeNs);
+    appendRecordLocked(RecFolderStamp, s);
+}
+
+void ImageCatalog::appendRemoveFolderLocked(const FolderKey& key)
+{
+    std::string s;
+    putStr(s, key.category);
+    putStr(s, key.folder);
+    appendRecordLocked(RecRemoveFolder, s);
+}
+
+void ImageCatalog::appendRecordLocked(RecordType type, const std::string& payload)
+{
+    if (m_logFd < 0)
+        return;
+    std::string rec;
+    rec.reserve(payload.size() + 9);
+    put<uint32_t>(rec, static_cast<uint32_t>(payload.size()));
+    put<uint8_t>(rec, type);
+    rec += payload;
+    put<uint32_t>(rec, recordCheck(type, payload.data(), payload.size()));
+    // 一次 write 追加整条记录；不做 fsync：索引丢尾部只会在下次对账时补回
+    if (writeAll(m_logFd, rec.data(), rec.size()))
+        ++m_logRecords;
+}
+
+int64_t ImageCatalog::appendThumbnailLocked(const std::string& relPath, const std::vector<unsigned char>& data)
+{
+    if (m_thumbFd < 0)
+        return -1;
+    std::string blob;
+    put<uint32_t>(blob, kThumbMagic);
+    put<uint32_t>(blob, static_cast<uint32_t>(data.size()));
+    put<uint64_t>(blob, pathHash(relPath));
+    putRaw(blob, data.data(), data.size());
+    const uint64_t off = m_thumbFileBytes;
+    if (!pwriteAllAt(m_thumbFd, blob.data(), blob.size(), off))
+        return -1;
+    m_thumbFileBytes += blob.size();
+    return static_cast<int64_t>(off);
+}
+
+void ImageCatalog::maybeCompactLocked()
+{
+    const size_t live = m_entries.size() + m_folderStamps.size();
+    const bool logBloated = m_logRecords > 2 * live + 1024;
+    const bool thumbsBloated = m_thumbFileBytes > 2 * m_thumbLiveBytes + (8u << 20);
+    if (logBloated || thumbsBloated)
+        compactLocked();
+}
+
+bool ImageCatalog::compactLocked()
+{
+    // 先写新的缩略图文件（只保留仍被引用的块），再写新日志，最后依次 rename
+    const std::string thumbTmp = m_thumbPath + ".tmp";
+    const std::string logTmp = m_indexPath + ".tmp";
+
+    int tfd = ::open(thumbTmp.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (tfd < 0)
+        return false;
+    uint64_t newThumbBytes = 0;
+    std::map<std::string, std::pair<int64_t, uint32_t>> newThumbs;
+    std::vector<unsigned char> buf;
+    for (const auto& kv : m_entries) {
+        const CatalogEntry& e = kv.second;
+        if (e.thumbOffset < 0)
+            continue;
+        const size_t blobBytes = 16 + e.thumbBytes;
+        buf.resize(blobBytes);
+        if (!preadAllAt(m_thumbFd, buf.data(), blobBytes, static_cast<uint64_t>(e.thumbOffset)) ||
+            !pwriteAllAt(tfd, buf.data(), blobBytes, newThumbBytes))
+            continue;
+        newThumbs[kv.first] = {static_cast<int64_t>(newThumbBytes), e.thumbBytes};
+        newThumbBytes += blobBytes;
+    }
+
+    int lfd = ::open(logTmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (lfd < 0) {
+        ::close(tfd);
+        ::unlink(thumbTmp.c_str());
+        return false;
+    }
+    std::string out(kLogMagic, sizeof(kLogMagic));
+    size_t records = 0;
+    auto addRecord = [&](RecordType type, const std::string& payload) {
+        put<uint32_t>(out, static_cast<uint32_t>(payload.size()));
+        put<uint8_t>(out, type);
+        out += payload;
+        put<uint32_t>(out, recordCheck(type, payload.data(), payload.size()));
+        ++records;
+    };
+    for (const auto& kv : m_folderStamps) {
+        std::string s;
+        putStr(s, kv.first.category);
+        putStr(s, kv.first.folder);
+        put<int64_t>(s, kv.second);
+        addRecord(RecFolderStamp, s);
+    }
+    for (const auto& kv : m_entries) {
+        CatalogEntry e = kv.second;
+        auto t = newThumbs.find(kv.first);
+        e.thumbOffset = (t != newThumbs.end()) ? t->second.first : -1;
+        e.thumbBytes = (t != newThumbs.end()) ? t->second.second : 0;
+        addRecord(RecUpsert, encodeEntry(e));
+    }
+    const bool ok = writeAll(lfd, out.data(), out.size()) && ::fdatasync(lfd) == 0 && ::fdatasync(tfd) == 0;
+    ::close(lfd);
+    if (!ok || ::rename(thumbTmp.c_str(), m_thumbPath.c_str()) != 0 || ::rename(logTmp.c_str(), m_indexPath.c_str()) != 0) {
+        ::close(tfd);
+        ::unlink(thumbTmp.c_str());
+        ::unlink(logTmp.c_str());
+        return false;
+    }
+
+    for (auto& kv : m_entries) {
+        auto t = newThumbs.find(kv.first);
+        kv.second.thumbOffset = (t != newThumbs.end()) ? t->second.first : -1;
+        kv.second.thumbBytes = (t != newThumbs.end()) ? t->second.second : 0;
+    }
+    ::close(m_thumbFd);
+    m_thumbFd = tfd;
+    m_thumbFileBytes = newThumbBytes;
+    m_thumbLiveBytes = 0;
+    for (const auto& kv : newThumbs)
+        m_thumbLiveBytes += kv.second.second;
+
+    ::close(m_logFd);
+    m_logFd = ::open(m_indexPath.c_str(), O_WRONLY | O_APPEND | O_CLOEXEC);
+    m_logRecords = records;
+    return m_logFd >= 0;
+}
+
+bool ImageCatalog::startWatching(int debounceMs)
+{
+    if (m_thread.joinable())
+        return true;
+    m_stopping.store(false);
+    m_wakeFd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (m_wakeFd < 0)
+        return false;
+    m_thread = std::thread(&ImageCatalog::watchLoop, this, debounceMs);
+    return true;
+}
+
+void ImageCatalog::stop()
+{
+    m_stopping.store(true);
+    if (m_wakeFd >= 0) {
+        const uint64_t one = 1;
+        (void)::write(m_wakeFd, &one, sizeof(one));
+    }
+    if (m_thread.joinable())
+        m_thread.join();
+    if (m_wakeFd >= 0) {
+        ::close(m_wakeFd);
+        m_wakeFd = -1;
+    }
+}
+
+void ImageCatalog::watchLoop(int debounceMs)
+{
+    const int ifd = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    std::map<int, FolderKey> watches; // wd -> 目录（category 为空表示 root，folder 为空表示分类目录）
+    std::set<FolderKey> dirty;
+    bool fullRescan = false;
+
+    const uint32_t kFolderMask = IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_DELETE | IN_DELETE_SELF | IN_ONLYDIR;
+    const uint32_t kCategoryMask = IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF | IN_ONLYDIR;
+
+    auto addFolderWatch = [&](const std::string& category, const std::string& folder) {
+        const int wd = ::inotify_add_watch(ifd, (m_root + "/" + category + "/" + folder).c_str(), kFolderMask);
+        if (wd >= 0)
+            watches[wd] = FolderKey{category, folder};
+    };
+    auto addCategoryWatch = [&](const std::string& category) {
+        const std::string catDir = m_root + "/" + category;
+        const int wd = ::inotify_add_watch(ifd, catDir.c_str(), kCategoryMask);
+        if (wd < 0)
+            return;
+        watches[wd] = FolderKey{category, std::string()};
+        if (DIR* dir = ::opendir(catDir.c_str())) {
+            while (struct dirent* de = ::readdir(dir)) {
+                if (isIgnoredName(de->d_name))
+                    continue;
+                struct stat st;
+                if (::stat((catDir + "/" + de->d_name).c_str(), &st) == 0 && S_ISDIR(st.st_mode)) {
+                    addFolderWatch(category, de->d_name);
+                    dirty.insert(FolderKey{category, de->d_name});
+                }
+            }
+            ::closedir(dir);
+        }
+    };
+
+    // 先挂监听再对账：对账期间发生的变化会留在 inotify 队列里，随后再处理一遍
+    if (ifd >= 0) {
+        const int rootWd = ::inotify_add_watch(ifd, m_root.c_str(), IN_CREATE | IN_MOVED_TO | IN_ONLYDIR);
+        if (rootWd >= 0)
+            watches[rootWd] = FolderKey{};
+        for (const auto& category : m_categories)
+            addCategoryWatch(category);
+        dirty.clear();
+    }
+    reconcile();
+    m_ready.store(true);
+    if (ifd < 0)
+        return; // 没有 inotify 时只依赖写盘方通知与启动对账
+
+    auto deadline = std::chrono::steady_clock::time_point::max();
+    std::vector<char> buf(64 * 1024);
+    while (!m_stopping.load()) {
+        int timeout = -1;
+        if (deadline != std::chrono::steady_clock::time_point::max()) {
+            const auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now()).count();
+            timeout = static_cast<int>(std::max<long long>(0, left));
+        }
+        struct pollfd fds[2] = {{ifd, POLLIN, 0}, {m_wakeFd, POLLIN, 0}};
+        const int n = ::poll(fds, 2, timeout);
+        if (n < 0 && errno != EINTR)
+            break;
+        if (fds[1].revents & POLLIN)
+            break;
+
+        if (n > 0 && (fds[0].revents & POLLIN)) {
+            for (;;) {
+                const ssize_t len = ::read(ifd, buf.data(), buf.size());
+                if (len <= 0)
+                    break;
+                for (char* p = buf.data(); p < buf.data() + len;) {
+                    const struct inotify_event* ev = reinterpret_cast<const struct inotify_event*>(p);
+                    p += sizeof(struct inotify_event) + ev->len;
+
+                    if (ev->mask & IN_Q_OVERFLOW) {
+                        fullRescan = true;
+                        continue;
+                    }
+                    auto w = watches.find(ev->wd);
+                    if (w == watches.end())
+                        continue;
+                    if (ev->mask & IN_IGNORED) {
+                        watches.erase(w);
+                        continue;
+                    }
+                    const FolderKey key = w->second;
+                    const std::string name = ev->len ? ev->name : "";
+                    if (key.category.empty()) {
+                        // root 下新建了分类目录
+                        if ((ev->mask & IN_ISDIR) &&
+                            std::find(m_categories.begin(), m_categories.end(), name) != m_categories.end())
+                            addCategoryWatch(name);
+                    } else if (key.folder.empty()) {
+                        if (ev->mask & IN_DELETE_SELF) {
+                            dirty.insert(FolderKey{key.category, std::string()});
+                        } else if (!name.empty() && !isIgnoredName(name.c_str()) && (ev->mask & IN_ISDIR)) {
+                            if (ev->mask & (IN_CREATE | IN_MOVED_TO))
+                                addFolderWatch(key.category, name);
+                            dirty.insert(FolderKey{key.category, name});
+                        }
+                    } else if (ev->mask & IN_DELETE_SELF) {
+                        dirty.insert(key);
+                    } else if (!name.empty() && !isIgnoredName(name.c_str())) {
+                        dirty.insert(key);
+                    }
+                    deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(debounceMs);
+                }
+            }
+        }
+
+        if (std::chrono::steady_clock::now() < deadline)
+            continue;
+        deadline = std::chrono::steady_clock::time_point::max();
+        if (fullRescan) {
+            fullRescan = false;
+            dirty.clear();
+            reconcile();
+            continue;
+        }
+        for (const auto& key : dirty) {
+            if (m_stopping.load())
+                break;
+            if (key.folder.empty()) {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                removeFolderLocked(key.category, std::string());
+            } else {
+                rescanFolder(key.category, key.folder);
+            }
+        }
+        dirty.clear();
+    }
+    ::close(ifd);
+}
+
+} // namespace storage
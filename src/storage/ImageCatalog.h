@@ -0,0 +1,168 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace storage {
+
+// 图像元数据（来自 FITS 头；非 FITS 文件只有 captureTimeMs=mtime）
+struct ImageMeta {
+    int64_t captureTimeMs{0}; ///< DATE-OBS（UTC ms since epoch），缺失时为文件 mtime
+    std::string object;
+    std::string filter;
+    double exposureSec{-1.0}; ///< <0 表示未知
+    std::string imageType;
+};
+
+// 目录结构固定为 <root>/<category>/<folder>/<name>（CaptureImage/2025-01-01/xxx.fits 等）
+struct CatalogEntry {
+    std::string category;
+    std::string folder;
+    std::string name;
+    uint64_t size{0};
+    int64_t mtimeNs{0};
+    ImageMeta meta;
+    int64_t thumbOffset{-1}; ///< 缩略图在 .thumbs 文件中的偏移，-1 表示没有
+    uint32_t thumbBytes{0};
+
+    std::string relPath() const { return category + "/" + folder + "/" + name; }
+};
+
+struct CatalogFolder {
+    std::string category;
+    std::string name;
+    size_t files{0};
+    uint64_t bytes{0};
+    int64_t latestCaptureMs{0};
+};
+
+struct CatalogQuery {
+    std::string category;          ///< 空表示全部
+    std::string folder;            ///< 空表示全部
+    std::string object;            ///< 子串匹配，不区分大小写
+    std::string filter;            ///< 完全匹配，不区分大小写
+    double minExposureSec{-1.0};   ///< <0 不限
+    double maxExposureSec{-1.0};
+    int64_t fromMs{0};             ///< 0 不限
+    int64_t toMs{0};
+    bool newestFirst{true};
+    size_t offset{0};
+    size_t limit{100};
+};
+
+struct CatalogPage {
+    size_t total{0}; ///< 满足条件的总条数（分页前）
+    std::vector<CatalogEntry> entries;
+};
+
+// 图库索引：
+// - 持久化为追加日志（<indexPath>）+ 缩略图块文件（<indexPath>.thumbs），启动时重放，尾部损坏自动截断
+// - reconcile() 只重扫 mtime 变化过的目录，目录内按 size/mtime 判断文件是否需要重读 FITS 头
+// - startWatching() 用 inotify 监听分类目录与其子目录，事件合并后增量更新
+// - 写盘方写完文件后可直接 recordFile()（可附带缩略图），不必等 inotify
+// 所有公开方法线程安全
+class ImageCatalog
+{
+public:
+    // 读取元数据（FITS 头）；返回 false 时只记录 size/mtime
+    using MetaReader = std::function<bool(const std::string& absPath, ImageMeta* meta)>;
+
+    ImageCatalog(std::string rootDir,
+                 std::vector<std::string> categories,
+                 std::string indexPath,
+                 MetaReader reader);
+    ~ImageCatalog();
+
+    ImageCatalog(const ImageCatalog&) = delete;
+    ImageCatalog& operator=(const ImageCatalog&) = delete;
+
+    // 载入索引（重放日志）；索引不存在视为空
+    bool open(std::string* error = nullptr);
+
+    // 与磁盘对账，返回新增/更新/删除的条目数
+    size_t reconcile();
+
+    // 后台线程：首次 reconcile 后开始 inotify 监听；ready() 在首次对账完成后为 true
+    bool startWatching(int debounceMs = 300);
+    void stop();
+    bool ready() const { return m_ready.load(); }
+
+    // 写盘方通知：文件已写完（不在 root 下的路径忽略）
+    void recordFile(const std::string& absPath, const std::vector<unsigned char>* thumbnail = nullptr);
+    // 文件或目录被删除
+    void removePath(const std::string& absPath);
+
+    std::vector<CatalogFolder> folders(const std::string& category) const;
+    CatalogPage query(const CatalogQuery& q) const;
+    bool find(const std::string& relPath, CatalogEntry* out) const;
+    bool readThumbnail(const std::string& relPath, std::vector<unsigned char>* out) const;
+    size_t size() const;
+
+    const std::string& rootDir() const { return m_root; }
+
+private:
+    struct FolderKey {
+        std::string category;
+        std::string folder;
+        bool operator<(const FolderKey& o) const
+        {
+            return category != o.category ? category < o.category : folder < o.folder;
+        }
+    };
+
+    // 日志记录类型
+    enum RecordType : uint8_t {
+        RecUpsert = 1,
+        RecRemove = 2,
+        RecFolderStamp = 3,
+        RecRemoveFolder = 4,
+    };
+
+    // 拆成 category/folder/name，返回层数（0 表示不在 root 下或分类未知）
+    int splitPath(const std::string& absPath, std::string* category, std::string* folder, std::string* name) const;
+    // stat + 读元数据，不持锁（读 FITS 头可能较慢）
+    bool buildEntry(const std::string& category, const std::string& folder, const std::string& name,
+                    CatalogEntry* out) const;
+    // 重扫一个目录：只对 size/mtime 变化的文件读元数据；目录不存在时删除其全部条目
+    size_t rescanFolder(const std::string& category, const std::string& folder);
+    size_t removeFolderLocked(const std::string& category, const std::string& folder);
+
+    void appendUpsertLocked(const CatalogEntry& e);
+    void appendRemoveLocked(const std::string& relPath);
+    void appendFolderStampLocked(const FolderKey& key, int64_t mtimeNs);
+    void appendRemoveFolderLocked(const FolderKey& key);
+    void appendRecordLocked(RecordType type, const std::string& payload);
+    int64_t appendThumbnailLocked(const std::string& relPath, const std::vector<unsigned char>& data);
+    void maybeCompactLocked();
+    bool compactLocked();
+
+    void watchLoop(int debounceMs);
+
+    const std::string m_root;
+    const std::vector<std::string> m_categories;
+    const std::string m_indexPath;
+    const std::string m_thumbPath;
+    MetaReader m_reader;
+
+    mutable std::mutex m_mutex;
+    std::map<std::string, CatalogEntry> m_entries;       // relPath -> entry
+    std::map<FolderKey, int64_t> m_folderStamps;         // 目录 mtime（对账时跳过未变化的目录）
+    int m_logFd{-1};
+    int m_thumbFd{-1};
+    size_t m_logRecords{0};
+    uint64_t m_thumbLiveBytes{0};
+    uint64_t m_thumbFileBytes{0};
+
+    std::atomic<bool> m_ready{false};
+    std::atomic<bool> m_stopping{false};
+    int m_wakeFd{-1};
+    std::thread m_thread;
+};
+
+} // namespace storage
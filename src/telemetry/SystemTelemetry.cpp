@@ -0,0 +1,464 @@
+#include "SystemTelemetry.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+
+#include <dirent.h>
+#include <pthread.h>
+#include <sys/statvfs.h>
+#include <unistd.h>
+
+namespace telemetry {
+
+namespace {
+
+bool readFile(const std::string& path, std::string& out)
+{
+    std::ifstream in(path);
+    if (!in)
+        return false;
+    out.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    return true;
+}
+
+std::vector<std::string> listDir(const std::string& path)
+{
+    std::vector<std::string> names;
+    DIR* dir = opendir(path.c_str());
+    if (!dir)
+        return names;
+    while (dirent* e = readdir(dir)) {
+        if (e->d_name[0] != '.')
+            names.push_back(e->d_name);
+    }
+    closedir(dir);
+    std::sort(names.begin(), names.end());
+    return names;
+}
+
+bool startsWith(const std::string& s, const std::string& prefix)
+{
+    return s.size() >= prefix.size() && s.compare(0, prefix.size(), prefix) == 0;
+}
+
+double percentOf(uint64_t part, uint64_t whole)
+{
+    return whole > 0 ? 100.0 * static_cast<double>(part) / static_cast<double>(whole) : 0.0;
+}
+
+double busyPercent(const CpuTimes& now, const CpuTimes& prev)
+{
+    const uint64_t total = now.total() >= prev.total() ? now.total() - prev.total() : 0;
+    const uint64_t idle = now.idleAll() >= prev.idleAll() ? now.idleAll() - prev.idleAll() : 0;
+    return total > 0 ? percentOf(total - std::min(idle, total), total) : 0.0;
+}
+
+uint64_t counterDelta(uint64_t now, uint64_t prev)
+{
+    return now >= prev ? now - prev : 0;   // 计数器回绕或网卡重建时当作 0
+}
+
+std::string formatNumber(double v)
+{
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%.1f", v);
+    std::string s(buf);
+    if (s.size() > 2 && s.compare(s.size() - 2, 2, ".0") == 0)
+        s.resize(s.size() - 2);
+    return s;
+}
+
+std::string jsonEscape(const std::string& s)
+{
+    std::string out;
+    for (char c : s) {
+        if (c == '"' || c == '\\')
+            out.push_back('\\');
+        if (static_cast<unsigned char>(c) >= 0x20)
+            out.push_back(c);
+    }
+    return out;
+}
+
+} // namespace
+
+bool parseProcStat(const std::string& text, ProcStat& out)
+{
+    out = ProcStat{};
+    bool haveAll = false;
+    std::istringstream in(text);
+    std::string line;
+    while (std::getline(in, line)) {
+        if (!startsWith(line, "cpu"))
+            continue;
+        std::istringstream ls(line);
+        std::string label;
+        CpuTimes t;
+        ls >> label >> t.user >> t.nice >> t.system >> t.idle;
+        if (!ls)
+            continue;
+        // iowait 之后的字段在老内核上可能没有
+        ls >> t.iowait >> t.irq >> t.softirq >> t.steal;
+        if (label == "cpu") {
+            out.all = t;
+            haveAll = true;
+        } else {
+            out.cores.push_back(t);
+        }
+    }
+    return haveAll;
+}
+
+bool parseMeminfo(const std::string& text, MemInfo& out)
+{
+    out = MemInfo{};
+    uint64_t freeKb = 0, buffersKb = 0, cachedKb = 0;
+    bool haveAvailable = false;
+    std::istringstream in(text);
+    std::string key;
+    uint64_t value = 0;
+    std::string line;
+    while (std::getline(in, line)) {
+        std::istringstream ls(line);
+        if (!(ls >> key >> value))
+            continue;
+        if (key == "MemTotal:") {
+            out.totalKb = value;
+        } else if (key == "MemAvailable:") {
+            out.availableKb = value;
+            haveAvailable = true;
+        } else if (key == "MemFree:") {
+            freeKb = value;
+        } else if (key == "Buffers:") {
+            buffersKb = value;
+        } else if (key == "Cached:") {
+            cachedKb = value;
+        }
+    }
+    if (!haveAvailable)
+        out.availableKb = freeKb + buffersKb + cachedKb;
+    return out.totalKb > 0;
+}
+
+bool parseTaskStat(const std::string& text, TaskStat& out)
+{
+    out = TaskStat{};
+    const size_t open = text.find('(');
+    const size_t close = text.rfind(')');
+    if (open == std::string::npos || close == std::string::npos || close < open)
+        return false;
+    out.tid = std::atoi(text.c_str());
+    out.comm = text.substr(open + 1, close - open - 1);
+    // ')' 之后依次是 state(3) ppid pgrp session tty_nr tpgid flags minflt cminflt majflt cmajflt utime(14) stime(15)
+    std::istringstream ls(text.substr(close + 1));
+    std::string field;
+    for (int i = 3; i <= 13; ++i) {
+        if (!(ls >> field))
+            return false;
+    }
+    ls >> out.utime >> out.stime;
+    return static_cast<bool>(ls) && out.tid > 0;
+}
+
+std::vector<NetCounters> parseNetDev(const std::string& text)
+{
+    std::vector<NetCounters> out;
+    std::istringstream in(text);
+    std::string line;
+    while (std::getline(in, line)) {
+        const size_t colon = line.find(':');
+        if (colon == std::string::npos)
+            continue;   // 两行表头
+        NetCounters n;
+        std::istringstream name(line.substr(0, colon));
+        name >> n.iface;
+        std::istringstream ls(line.substr(colon + 1));
+        uint64_t skip = 0;
+        ls >> n.rxBytes;
+        for (int i = 0; i < 7; ++i)
+            ls >> skip;
+        ls >> n.txBytes;
+        if (ls && !n.iface.empty())
+            out.push_back(n);
+    }
+    return out;
+}
+
+std::vector<ThreadGroupRule> defaultThreadGroupRules()
+{
+    // 名称来自各处 setObjectName / SdkSerialExecutor 线程名（内核只保留前 15 个字符）
+    return {
+        {"Sdk", "sdk"},                     // SdkCamWorker / SdkMainCameraWorker / SdkFocuserWorker ...
+        {"QhyFocuser", "sdk"},
+        {"GuiderCore", "guider"},
+        {"PlateSolve", "solver"},
+        {"Thread (pooled)", "tiles"},       // QThreadPool / QtConcurrent：瓦片与预览处理
+        {"WebSocketThread", "ws"},
+        {"Telemetry", "telemetry"},
+    };
+}
+
+std::string classifyThread(const TaskStat& task, int pid, const std::vector<ThreadGroupRule>& rules)
+{
+    if (task.tid == pid)
+        return "gui";
+    for (const ThreadGroupRule& rule : rules) {
+        if (startsWith(task.comm, rule.prefix))
+            return rule.group;
+    }
+    return "other";
+}
+
+SystemSampler::SystemSampler(Options options) : m_options(std::move(options))
+{
+    if (m_options.pid <= 0)
+        m_options.pid = static_cast<int>(getpid());
+    if (m_options.ticksPerSecond <= 0) {
+        const long hz = sysconf(_SC_CLK_TCK);
+        m_options.ticksPerSecond = hz > 0 ? hz : 100;
+    }
+}
+
+TelemetrySample SystemSampler::sample(int64_t nowMs)
+{
+    TelemetrySample s;
+    s.timeMs = nowMs;
+    const double dtSec = m_hasPrevious ? (nowMs - m_prevMs) / 1000.0 : 0.0;
+    s.hasDelta = m_hasPrevious && dtSec > 0.0;
+    std::string text;
+
+    ProcStat stat;
+    const bool haveStat = readFile(m_options.procRoot + "/stat", text) && parseProcStat(text, stat);
+    if (haveStat && s.hasDelta) {
+        s.cpuPercent = busyPercent(stat.all, m_prevStat.all);
+        for (size_t i = 0; i < stat.cores.size(); ++i)
+            s.corePercent.push_back(i < m_prevStat.cores.size() ? busyPercent(stat.cores[i], m_prevStat.cores[i]) : 0.0);
+    }
+
+    MemInfo mem;
+    if (readFile(m_options.procRoot + "/meminfo", text) && parseMeminfo(text, mem)) {
+        s.memTotalKb = mem.totalKb;
+        s.memAvailableKb = std::min(mem.availableKb, mem.totalKb);
+        s.memUsedPercent = percentOf(mem.totalKb - s.memAvailableKb, mem.totalKb);
+    }
+
+    // 温度：与原先 cat thermal_zone0/temp 一致，但优先选 type 为 cpu/soc 的区
+    const std::string thermal = m_options.sysRoot + "/class/thermal";
+    for (const std::string& name : listDir(thermal)) {
+        if (!startsWith(name, "thermal_zone"))
+            continue;
+        if (!readFile(thermal + "/" + name + "/temp", text))
+            continue;
+        const long milli = std::atol(text.c_str());
+        TelemetrySample::Zone zone;
+        if (readFile(thermal + "/" + name + "/type", text))
+            zone.type = text.substr(0, text.find_first_of("\r\n"));
+        zone.celsius = milli / 1000.0;
+        if (zone.type.find("cpu") != std::string::npos || zone.type.find("soc") != std::string::npos ||
+            s.cpuTempC < 0.0)
+            s.cpuTempC = zone.celsius;
+        s.zones.push_back(zone);
+    }
+
+    // 本进程各线程：Δ(utime+stime) / (Δt × CLK_TCK) = 占单核的比例
+    const std::string taskDir = m_options.procRoot + "/" + std::to_string(m_options.pid) + "/task";
+    std::map<int, uint64_t> taskTicks;
+    std::map<std::string, TelemetrySample::Group> groups;
+    uint64_t processTicks = 0;
+    for (const std::string& name : listDir(taskDir)) {
+        TaskStat task;
+        if (!readFile(taskDir + "/" + name + "/stat", text) || !parseTaskStat(text, task))
+            continue;   // 线程可能在列目录和读文件之间退出
+        const uint64_t ticks = task.utime + task.stime;
+        taskTicks[task.tid] = ticks;
+        TelemetrySample::Group& g = groups[classifyThread(task, m_options.pid, m_options.rules)];
+        ++g.threads;
+        if (!s.hasDelta)
+            continue;
+        const auto prev = m_prevTaskTicks.find(task.tid);
+        // 新出现的线程没有基准，本次不计
+        const uint64_t delta = prev != m_prevTaskTicks.end() ? counterDelta(ticks, prev->second) : 0;
+        g.cpuPercent += static_cast<double>(delta);
+        processTicks += delta;
+    }
+    const double tickScale = s.hasDelta ? 100.0 / (dtSec * static_cast<double>(m_options.ticksPerSecond)) : 0.0;
+    for (auto& entry : groups) {
+        entry.second.name = entry.first;
+        entry.second.cpuPercent *= tickScale;
+        s.groups.push_back(entry.second);
+    }
+    std::stable_sort(s.groups.begin(), s.groups.end(),
+                     [](const TelemetrySample::Group& a, const TelemetrySample::Group& b) {
+                         return a.cpuPercent > b.cpuPercent;
+                     });
+    s.processCpuPercent = static_cast<double>(processTicks) * tickScale;
+
+    for (const std::string& path : m_options.diskPaths) {
+        TelemetrySample::Disk disk;
+        disk.path = path;
+        struct statvfs st;
+        if (statvfs(path.c_str(), &st) == 0) {
+            disk.availableBytes = static_cast<int64_t>(st.f_bavail) * static_cast<int64_t>(st.f_frsize);
+            disk.totalBytes = static_cast<int64_t>(st.f_blocks) * static_cast<int64_t>(st.f_frsize);
+        }
+        s.disks.push_back(disk);
+    }
+
+    std::map<std::string, NetCounters> net;
+    if (readFile(m_options.procRoot + "/net/dev", text)) {
+        for (const NetCounters& n : parseNetDev(text)) {
+            if (!m_options.includeLoopback && n.iface == "lo")
+                continue;
+            net[n.iface] = n;
+            TelemetrySample::Net rate;
+            rate.iface = n.iface;
+            const auto prev = m_prevNet.find(n.iface);
+            if (s.hasDelta && prev != m_prevNet.end()) {
+                rate.rxBytesPerSec = counterDelta(n.rxBytes, prev->second.rxBytes) / dtSec;
+                rate.txBytesPerSec = counterDelta(n.txBytes, prev->second.txBytes) / dtSec;
+            }
+            s.nets.push_back(rate);
+        }
+    }
+
+    if (haveStat)
+        m_prevStat = stat;
+    m_prevTaskTicks = std::move(taskTicks);
+    m_prevNet = std::move(net);
+    m_prevMs = nowMs;
+    m_hasPrevious = true;
+    return s;
+}
+
+std::string DeltaEncoder::encode(const TelemetrySample& sample)
+{
+    struct Field {
+        std::string key;
+        double value;
+        double threshold;
+    };
+    std::vector<Field> fields;
+    fields.push_back({"cpu", sample.cpuPercent, 0.5});
+    if (sample.cpuTempC >= 0.0)
+        fields.push_back({"temp", sample.cpuTempC, 0.5});
+    fields.push_back({"mem", sample.memUsedPercent, 0.5});
+    fields.push_back({"proc", sample.processCpuPercent, 0.5});
+    for (const TelemetrySample::Group& g : sample.groups)
+        fields.push_back({"g." + g.name, g.cpuPercent, 0.5});
+    for (const TelemetrySample::Disk& d : sample.disks) {
+        if (d.availableBytes >= 0)
+            fields.push_back({"disk." + d.path, static_cast<double>(d.availableBytes), 1024.0 * 1024.0});
+    }
+    for (const TelemetrySample::Net& n : sample.nets) {
+        fields.push_back({"rx." + n.iface, n.rxBytesPerSec, std::max(1024.0, 0.05 * n.rxBytesPerSec)});
+        fields.push_back({"tx." + n.iface, n.txBytesPerSec, std::max(1024.0, 0.05 * n.txBytesPerSec)});
+    }
+
+    const bool full = m_fullEvery <= 1 || m_count % m_fullEvery == 0;
+    ++m_count;
+    std::string out;
+    for (const Field& f : fields) {
+        const auto last = m_last.find(f.key);
+        if (!full && last != m_last.end() && std::abs(last->second - f.value) < f.threshold)
+            continue;
+        m_last[f.key] = f.value;
+        out += out.empty() ? "{" : ",";
+        out += "\"" + jsonEscape(f.key) + "\":" + formatNumber(f.value);
+    }
+    if (full)
+        out += out.empty() ? "{\"full\":1" : ",\"full\":1";
+    if (!out.empty())
+        out += "}";
+    return out;
+}
+
+void DeltaEncoder::reset()
+{
+    m_last.clear();
+    m_count = 0;
+}
+
+TelemetryService::TelemetryService(SystemSampler::Options options, int intervalMs, int fullEvery)
+    : m_sampler(std::move(options)), m_encoder(fullEvery), m_intervalMs(std::max(100, intervalMs))
+{
+}
+
+TelemetryService::~TelemetryService()
+{
+    stop();
+}
+
+void TelemetryService::start(Callback callback)
+{
+    if (m_running.load())
+        return;
+    m_callback = std::move(callback);
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopRequested = false;
+    }
+    m_running = true;
+    m_thread = std::thread(&TelemetryService::loop, this);
+}
+
+void TelemetryService::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopRequested = true;
+    }
+    m_cv.notify_all();
+    if (m_thread.joinable())
+        m_thread.join();
+    m_running = false;
+}
+
+int64_t TelemetryService::availableBytes(const std::string& path) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (const TelemetrySample::Disk& d : m_latest.disks) {
+        if (d.path == path)
+            return d.availableBytes;
+    }
+    return -1;
+}
+
+TelemetrySample TelemetryService::latest() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_latest;
+}
+
+void TelemetryService::loop()
+{
+    pthread_setname_np(pthread_self(), "Telemetry");
+    using Clock = std::chrono::steady_clock;
+    const auto epoch = Clock::now();
+    auto due = epoch;
+    for (;;) {
+        const int64_t nowMs =
+            std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - epoch).count();
+        TelemetrySample s = m_sampler.sample(nowMs);
+        const std::string delta = m_encoder.encode(s);
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_latest = s;
+        }
+        if (m_callback)
+            m_callback(s, delta);
+
+        // 采样本身变慢时不追补，从当前时刻重新计
+        due = std::max(due + std::chrono::milliseconds(m_intervalMs), Clock::now());
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if (m_cv.wait_until(lock, due, [this] { return m_stopRequested; }))
+            break;
+    }
+}
+
+} // namespace telemetry
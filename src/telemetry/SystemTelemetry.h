@@ -0,0 +1,179 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace telemetry {
+
+// ---- /proc、/sys 文本解析（与读文件分开，便于用固定文本测试） ----
+
+// /proc/stat 的 cpu 行，单位 jiffies
+struct CpuTimes {
+    uint64_t user{0};
+    uint64_t nice{0};
+    uint64_t system{0};
+    uint64_t idle{0};
+    uint64_t iowait{0};
+    uint64_t irq{0};
+    uint64_t softirq{0};
+    uint64_t steal{0};
+
+    uint64_t total() const { return user + nice + system + idle + iowait + irq + softirq + steal; }
+    uint64_t idleAll() const { return idle + iowait; }
+};
+
+struct ProcStat {
+    CpuTimes all;
+    std::vector<CpuTimes> cores;
+};
+bool parseProcStat(const std::string& text, ProcStat& out);
+
+struct MemInfo {
+    uint64_t totalKb{0};
+    uint64_t availableKb{0};
+};
+bool parseMeminfo(const std::string& text, MemInfo& out);
+
+// /proc/<pid>/task/<tid>/stat；comm 可能含空格和括号，按最后一个 ')' 切分
+struct TaskStat {
+    int tid{0};
+    std::string comm;
+    uint64_t utime{0};
+    uint64_t stime{0};
+};
+bool parseTaskStat(const std::string& text, TaskStat& out);
+
+struct NetCounters {
+    std::string iface;
+    uint64_t rxBytes{0};
+    uint64_t txBytes{0};
+};
+std::vector<NetCounters> parseNetDev(const std::string& text);
+
+// 线程名前缀 → 子系统。Linux 线程名最多 15 个字符（QThread 的 objectName 会被截断），按前缀匹配
+struct ThreadGroupRule {
+    std::string prefix;
+    std::string group;
+};
+// 主线程（tid == pid）归为 "gui"；都不匹配的归为 "other"
+std::string classifyThread(const TaskStat& task, int pid, const std::vector<ThreadGroupRule>& rules);
+std::vector<ThreadGroupRule> defaultThreadGroupRules();
+
+// ---- 一次采样（速率、占用率都来自与上次采样的计数差） ----
+
+struct TelemetrySample {
+    int64_t timeMs{0};
+    bool hasDelta{false};               ///< 第一次采样没有差值，占用率/速率为 0
+    double cpuPercent{0.0};             ///< 整机 CPU 占用（0..100）
+    std::vector<double> corePercent;
+    double cpuTempC{-1.0};              ///< CPU 温度（优先 type 含 cpu/soc 的区，否则 thermal_zone0）；<0 表示没有
+    struct Zone {
+        std::string type;
+        double celsius{0.0};
+    };
+    std::vector<Zone> zones;
+    uint64_t memTotalKb{0};
+    uint64_t memAvailableKb{0};
+    double memUsedPercent{0.0};
+    double processCpuPercent{0.0};      ///< 本进程所有线程，按单核 100% 计
+    struct Group {
+        std::string name;
+        double cpuPercent{0.0};         ///< 按单核 100% 计
+        int threads{0};
+    };
+    std::vector<Group> groups;          ///< 按 cpuPercent 降序
+    struct Disk {
+        std::string path;
+        int64_t availableBytes{-1};     ///< statvfs f_bavail × f_frsize；失败为 -1
+        int64_t totalBytes{-1};
+    };
+    std::vector<Disk> disks;
+    struct Net {
+        std::string iface;
+        double rxBytesPerSec{0.0};
+        double txBytesPerSec{0.0};
+    };
+    std::vector<Net> nets;
+};
+
+class SystemSampler
+{
+public:
+    struct Options {
+        std::string procRoot{"/proc"};
+        std::string sysRoot{"/sys"};
+        int pid{0};                             ///< 0 表示本进程
+        std::vector<ThreadGroupRule> rules{defaultThreadGroupRules()};
+        std::vector<std::string> diskPaths;
+        bool includeLoopback{false};
+        long ticksPerSecond{0};                 ///< 0 表示 sysconf(_SC_CLK_TCK)
+    };
+
+    explicit SystemSampler(Options options);
+    TelemetrySample sample(int64_t nowMs);
+
+private:
+    Options m_options;
+    bool m_hasPrevious{false};
+    int64_t m_prevMs{0};
+    ProcStat m_prevStat;
+    std::map<int, uint64_t> m_prevTaskTicks;    ///< tid → utime + stime
+    std::map<std::string, NetCounters> m_prevNet;
+};
+
+// 压缩发布：与上次发出的值比较，只输出变化超过阈值的字段（百分比/温度 0.5，速率 5% 或 1 KiB/s，
+// 磁盘 1 MiB），每 fullEvery 次输出一次全量；没有变化返回空串。输出为一行 JSON 对象，键为
+//   cpu / temp / mem / proc / g.<子系统> / disk.<路径> / rx.<网卡> / tx.<网卡>，全量时带 "full":1
+class DeltaEncoder
+{
+public:
+    explicit DeltaEncoder(int fullEvery = 20) : m_fullEvery(fullEvery) {}
+    std::string encode(const TelemetrySample& sample);
+    void reset();
+
+private:
+    std::map<std::string, double> m_last;
+    int m_count{0};
+    int m_fullEvery;
+};
+
+// 后台采样线程：每 intervalMs 采样一次并回调（回调在采样线程上执行）
+class TelemetryService
+{
+public:
+    using Callback = std::function<void(const TelemetrySample& sample, const std::string& delta)>;
+
+    TelemetryService(SystemSampler::Options options, int intervalMs, int fullEvery = 20);
+    ~TelemetryService();
+
+    void start(Callback callback);
+    void stop();
+    bool running() const { return m_running.load(); }
+
+    // 最近一次采样中某路径的可用空间（字节）；没有该路径或尚未采样返回 -1
+    int64_t availableBytes(const std::string& path) const;
+    TelemetrySample latest() const;
+
+private:
+    void loop();
+
+    SystemSampler m_sampler;
+    DeltaEncoder m_encoder;
+    int m_intervalMs;
+    Callback m_callback;
+    std::thread m_thread;
+    std::atomic<bool> m_running{false};
+    mutable std::mutex m_mutex;
+    std::condition_variable m_cv;
+    bool m_stopRequested{false};
+    TelemetrySample m_latest;
+};
+
+} // namespace telemetry
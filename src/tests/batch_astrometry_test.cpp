@@ -0,0 +1,327 @@
+// batch_astrometry_test.cpp
+// solver::BatchAstrometry 自检：与 Tools 逐点换算（getLST_Degree / full_ra_dec_to_alt_az / full_alt_az_to_ra_dec、
+// TanWcs::skyToPixel / pixelToSky）的数值一致性、岁差章动量级，以及批量与逐点路径的耗时对比
+//
+// 用法：batch_astrometry_test [点数，默认 200000]
+// 任一检查失败返回 1
+
+#include "../solver/BatchAstrometry.h"
+#include "test_util.h"
+
+#include <chrono>
+#include <cmath>
+#include <ctime>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace solver;
+
+using test_util::check;
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+constexpr double kDeg = kPi / 180.0;
+constexpr double kJ2000Unix = 946728000.0;   // 2000-01-01 12:00:00 UTC
+
+double angleDiffDeg(double a, double b)
+{
+    double d = std::fmod(a - b, 360.0);
+    if (d > 180.0)
+        d -= 360.0;
+    if (d < -180.0)
+        d += 360.0;
+    return std::fabs(d);
+}
+
+// ---- Tools 逐点实现的纯标准库副本（tools.cpp，去掉 QDateTime/日志） ----
+
+double rangeTo(double value, double max, double min)
+{
+    const double period = max - min;
+    while (value < min)
+        value += period;
+    while (value > max)
+        value -= period;
+    return value;
+}
+
+// Tools::getLST_Degree：每次调用都拆日期、重算儒略日
+double scalarLstDeg(double unixSec, double longitudeRad)
+{
+    const time_t whole = static_cast<time_t>(std::floor(unixSec));
+    const int msec = static_cast<int>(std::lround((unixSec - std::floor(unixSec)) * 1000.0));
+    std::tm t{};
+    gmtime_r(&whole, &t);
+    // QDate::toJulianDay + getJDFromDate 的 deltaTime
+    const double dayJd = std::floor(static_cast<double>(whole) / 86400.0) + 2440588.0;
+    const double jd = dayJd + t.tm_hour / 24.0 + t.tm_min / 1440.0 + t.tm_sec / 86400.0 - 0.5;
+    const double d = jd - 2451545.0;
+    const double ut = t.tm_hour + (t.tm_min * 60 + t.tm_sec + msec / 1000.0) / 3600.0;
+    const double lst = 100.46 + 0.985647 * d + longitudeRad / kDeg + 15 * ut;
+    return rangeTo(lst, 360.0, 0.0);
+}
+
+void scalarRaDecToAltAz(double haRad, double decRad, double& altRad, double& azRad, double latRad)
+{
+    const double cosLat = std::cos(latRad);
+    altRad = std::asin(std::sin(latRad) * std::sin(decRad) + cosLat * std::cos(decRad) * std::cos(haRad));
+    if (cosLat < .00001) {
+        azRad = haRad;
+    } else {
+        const double temp = std::acos((std::sin(decRad) - std::sin(altRad) * std::sin(latRad)) /
+                                      (std::cos(altRad) * cosLat));
+        azRad = std::sin(haRad) > 0 ? 2 * kPi - temp : temp;
+    }
+}
+
+void scalarFullRaDecToAltAz(double unixSec, double raRad, double decRad, double latRad, double lonRad,
+                            double& altRad, double& azRad)
+{
+    const double lst = scalarLstDeg(unixSec, lonRad);
+    const double ha = rangeTo(lst - raRad / kDeg, 360.0, 0.0);
+    scalarRaDecToAltAz(ha * kDeg, decRad, altRad, azRad, latRad);
+}
+
+void scalarAltAzToRaDec(double altRad, double azRad, double& hrRad, double& decRad, double latRad)
+{
+    const double cosLat = std::cos(latRad);
+    const double sinDec = std::sin(latRad) * std::sin(altRad) + cosLat * std::cos(altRad) * std::cos(azRad);
+    decRad = std::asin(sinDec);
+    double temp = cosLat * std::cos(decRad);
+    temp = -(std::sin(altRad) - std::sin(latRad) * sinDec) / temp;
+    temp = std::acos(std::fmin(std::fmax(temp, -1.0), 1.0));
+    hrRad = std::sin(azRad) > 0. ? kPi + temp : kPi - temp;
+}
+
+void scalarFullAltAzToRaDec(double unixSec, double altRad, double azRad, double latRad, double lonRad,
+                            double& raRad, double& decRad)
+{
+    double ha = 0;
+    scalarAltAzToRaDec(altRad, azRad, ha, decRad, latRad);
+    const double lst = scalarLstDeg(unixSec, lonRad);
+    raRad = rangeTo(lst - ha / kDeg, 360.0, 0.0) * kDeg;
+}
+
+// ---- 测试 ----
+
+struct Sample {
+    std::vector<double> ra, dec;
+};
+
+Sample randomSky(size_t n, unsigned seed)
+{
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> ra(0.0, 360.0);
+    std::uniform_real_distribution<double> z(-1.0, 1.0);
+    Sample s;
+    s.ra.resize(n);
+    s.dec.resize(n);
+    for (size_t i = 0; i < n; ++i) {
+        s.ra[i] = ra(rng);
+        s.dec[i] = std::asin(z(rng)) / kDeg;
+    }
+    return s;
+}
+
+void testTimeContext()
+{
+    std::cout << "[time]" << std::endl;
+    const double t = kJ2000Unix + 86400.0 * 9000 + 12345.678;
+    const TimeContext ctx = TimeContext::at(t, 40.0, 116.4);
+    check(angleDiffDeg(ctx.lstDeg, scalarLstDeg(t, 116.4 * kDeg)) < 1e-9, "LST matches Tools::getLST_Degree");
+    check(std::fabs(TimeContext::at(kJ2000Unix, 0, 0).jd - 2451545.0) < 1e-9, "JD at J2000.0");
+    check(std::fabs(TimeContext::at(kJ2000Unix, 0, 0).gmstDeg - 280.46061837) < 1e-6, "GMST at J2000.0");
+    check(angleDiffDeg(ctx.gmstDeg + 116.4, ctx.lstDeg) < 0.01, "both sidereal time conventions agree to 36\"");
+}
+
+void testAltAz()
+{
+    std::cout << "[alt/az]" << std::endl;
+    const double t = kJ2000Unix + 86400.0 * 9300 + 7777.25;
+    const double lat = 40.0, lon = 116.4;
+    const TimeContext ctx = TimeContext::at(t, lat, lon);
+    const Sample sky = randomSky(20000, 7);
+    const size_t n = sky.ra.size();
+    std::vector<double> alt(n), az(n);
+    raDecToAltAz(ctx, sky.ra.data(), sky.dec.data(), n, alt.data(), az.data());
+
+    double maxAlt = 0.0, maxAz = 0.0;
+    for (size_t i = 0; i < n; ++i) {
+        double a = 0, z = 0;
+        scalarFullRaDecToAltAz(t, sky.ra[i] * kDeg, sky.dec[i] * kDeg, lat * kDeg, lon * kDeg, a, z);
+        maxAlt = std::max(maxAlt, std::fabs(alt[i] - a / kDeg));
+        // acos 在天顶附近失去精度，逐点路径本身不可信，不比较
+        if (std::fabs(alt[i]) < 89.0)
+            maxAz = std::max(maxAz, angleDiffDeg(az[i], z / kDeg));
+    }
+    std::cout << "  max |dAlt| " << maxAlt * 3600 << "\"  max |dAz| " << maxAz * 3600 << "\"" << std::endl;
+    check(maxAlt < 1e-8 && maxAz < 1e-6, "batch alt/az matches the scalar path");
+
+    std::vector<double> ra(n), dec(n);
+    altAzToRaDec(ctx, alt.data(), az.data(), n, ra.data(), dec.data());
+    double maxRound = 0.0, maxScalar = 0.0;
+    for (size_t i = 0; i < n; ++i) {
+        // 弦长（小角度下 acos 精度不够）
+        const double dx = std::cos(dec[i] * kDeg) * std::cos(ra[i] * kDeg) -
+                          std::cos(sky.dec[i] * kDeg) * std::cos(sky.ra[i] * kDeg);
+        const double dy = std::cos(dec[i] * kDeg) * std::sin(ra[i] * kDeg) -
+                          std::cos(sky.dec[i] * kDeg) * std::sin(sky.ra[i] * kDeg);
+        const double dz = std::sin(dec[i] * kDeg) - std::sin(sky.dec[i] * kDeg);
+        maxRound = std::max(maxRound, std::sqrt(dx * dx + dy * dy + dz * dz) / kDeg);
+        if (std::fabs(alt[i]) < 89.0 && std::fabs(dec[i]) < 89.0) {
+            double r = 0, d = 0;
+            scalarFullAltAzToRaDec(t, alt[i] * kDeg, az[i] * kDeg, lat * kDeg, lon * kDeg, r, d);
+            maxScalar = std::max(maxScalar, std::max(angleDiffDeg(ra[i], r / kDeg), std::fabs(dec[i] - d / kDeg)));
+        }
+    }
+    check(maxRound < 1e-7, "alt/az -> ra/dec round trip");
+    check(maxScalar < 1e-6, "batch ra/dec matches Tools::full_alt_az_to_ra_dec");
+
+    // 输出可与输入同一数组
+    std::vector<double> a = sky.ra, b = sky.dec;
+    raDecToAltAz(ctx, a.data(), b.data(), n, a.data(), b.data());
+    check(a[123] == alt[123] && b[123] == az[123], "in-place conversion");
+}
+
+void testPrecession()
+{
+    std::cout << "[precession]" << std::endl;
+    double m[3][3];
+    precessionMatrix(2451545.0, m);
+    check(std::fabs(m[0][0] - 1) + std::fabs(m[1][1] - 1) + std::fabs(m[2][2] - 1) + std::fabs(m[0][1]) < 1e-15,
+          "no precession at J2000.0");
+
+    // 25 年后赤道上 RA=0 的点：Δα ≈ 46.1"/年，Δδ ≈ 20.04"/年
+    const double t = kJ2000Unix + 25 * 365.25 * 86400.0;
+    const TimeContext ctx = TimeContext::at(t, 0, 0);
+    precessionMatrix(ctx.jd, m);
+    const double x = m[0][0], y = m[1][0], z = m[2][0];
+    const double dRa = std::atan2(y, x) / kDeg * 3600;
+    const double dDec = std::asin(z) / kDeg * 3600;
+    check(std::fabs(dRa - 25 * 46.12) < 2.0 && std::fabs(dDec - 25 * 20.04) < 2.0, "25-year precession rate");
+
+    double orth = 0.0;
+    for (int i = 0; i < 3; ++i) {
+        for (int j = 0; j < 3; ++j) {
+            double dot = 0;
+            for (int k = 0; k < 3; ++k)
+                dot += ctx.toDate[i][k] * ctx.toDate[j][k];
+            orth = std::max(orth, std::fabs(dot - (i == j ? 1.0 : 0.0)));
+        }
+    }
+    // 章动用一阶小角近似，正交误差是 dpsi·deps 量级（~1e-8）
+    check(orth < 1e-7, "J2000 -> date matrix is a rotation");
+
+    // 升交点经度 Ω≈90° 时章动最大：Δψ≈-17"，赤道上 RA=0 的点 Δα≈Δψ·cosε、Δδ≈Δψ·sinε
+    const TimeContext peak = TimeContext::at(kJ2000Unix + 0.01812 * 36525 * 86400.0, 0, 0);
+    const double ra0 = 0.0, dec0 = 0.0;
+    double ra1 = 0, dec1 = 0;
+    precessToDate(peak, &ra0, &dec0, 1, &ra1, &dec1);
+    precessionMatrix(peak.jd, m);
+    const double raP = std::atan2(m[1][0], m[0][0]) / kDeg;
+    const double decP = std::asin(m[2][0]) / kDeg;
+    const double nutRa = (ra1 - raP) * 3600, nutDec = (dec1 - decP) * 3600;
+    std::cout << "  nutation at RA=0: " << nutRa << "\" " << nutDec << "\"" << std::endl;
+    check(std::fabs(nutRa + 17.2 * 0.9175) < 2.0 && std::fabs(nutDec + 17.2 * 0.3978) < 1.0,
+          "nutation term has the expected size and sign");
+}
+
+void testTan()
+{
+    std::cout << "[tan]" << std::endl;
+    const TanWcs wcs = TanWcs::fromSolution(37.95, 88.9, 12.0, 16.5, false, 1280, 960);
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<double> px(-50.0, 1330.0);
+    const size_t n = 5000;
+    std::vector<double> x(n), y(n), ra(n), dec(n);
+    for (size_t i = 0; i < n; ++i) {
+        x[i] = px(rng);
+        y[i] = px(rng) * 0.75;
+    }
+    pixelToSky(wcs, x.data(), y.data(), n, ra.data(), dec.data());
+    double maxSky = 0.0;
+    for (size_t i = 0; i < n; ++i) {
+        const SkyPoint s = wcs.pixelToSky(x[i], y[i]);
+        maxSky = std::max(maxSky, std::max(angleDiffDeg(s.raDeg, ra[i]), std::fabs(s.decDeg - dec[i])));
+    }
+    check(maxSky < 1e-10, "batch pixelToSky matches TanWcs");
+
+    std::vector<double> bx(n), by(n);
+    std::vector<uint8_t> front(n);
+    skyToPixel(wcs, ra.data(), dec.data(), n, bx.data(), by.data(), front.data());
+    double maxPx = 0.0;
+    bool allFront = true;
+    for (size_t i = 0; i < n; ++i) {
+        double sx = 0, sy = 0;
+        allFront = allFront && front[i] && wcs.skyToPixel(ra[i], dec[i], &sx, &sy);
+        maxPx = std::max(maxPx, std::max(std::fabs(sx - bx[i]), std::fabs(sy - by[i])));
+        maxPx = std::max(maxPx, std::max(std::fabs(x[i] - bx[i]), std::fabs(y[i] - by[i])));
+    }
+    check(allFront && maxPx < 1e-6, "batch skyToPixel matches TanWcs and round-trips");
+
+    const double backRa = wcs.crval[0] + 180.0, backDec = -wcs.crval[1];
+    double fx = 0, fy = 0;
+    uint8_t f = 1;
+    skyToPixel(wcs, &backRa, &backDec, 1, &fx, &fy, &f);
+    check(f == 0 && fx == -1.0 && fy == -1.0, "points behind the tangent plane are flagged");
+
+    LinearWcs lin;
+    lin.crpix[0] = 640;
+    lin.crpix[1] = 480;
+    lin.crval[0] = 10;
+    lin.crval[1] = 20;
+    lin.cd[0][0] = -0.001;
+    lin.cd[1][1] = 0.001;
+    const double cx[4] = {0, 1280, 1280, 0}, cy[4] = {0, 0, 960, 960};
+    double cra[4], cdec[4];
+    linearPixelToSky(lin, cx, cy, 4, cra, cdec);
+    check(std::fabs(cra[0] - 10.64) < 1e-12 && std::fabs(cdec[2] - 20.48) < 1e-12, "linear FOV corners");
+}
+
+void benchmark(size_t n)
+{
+    std::cout << "[benchmark] " << n << " points" << std::endl;
+    const double t = kJ2000Unix + 86400.0 * 9300 + 100.5;
+    const double lat = 40.0, lon = 116.4;
+    const Sample sky = randomSky(n, 11);
+    std::vector<double> alt(n), az(n);
+
+    using clock = std::chrono::steady_clock;
+    double sink = 0.0;
+    const auto s0 = clock::now();
+    for (size_t i = 0; i < n; ++i) {
+        double a = 0, z = 0;
+        scalarFullRaDecToAltAz(t, sky.ra[i] * kDeg, sky.dec[i] * kDeg, lat * kDeg, lon * kDeg, a, z);
+        sink += a + z;
+    }
+    const auto s1 = clock::now();
+    const TimeContext ctx = TimeContext::at(t, lat, lon);
+    raDecToAltAz(ctx, sky.ra.data(), sky.dec.data(), n, alt.data(), az.data());
+    const auto s2 = clock::now();
+    for (size_t i = 0; i < n; ++i)
+        sink += alt[i] + az[i];
+
+    const double scalarMs = std::chrono::duration<double, std::milli>(s1 - s0).count();
+    const double batchMs = std::chrono::duration<double, std::milli>(s2 - s1).count();
+    std::cout << "  scalar (per-point time) " << scalarMs << " ms, " << scalarMs * 1e6 / n << " ns/pt" << std::endl;
+    std::cout << "  batch  (one context)    " << batchMs << " ms, " << batchMs * 1e6 / n << " ns/pt" << std::endl;
+    std::cout << "  speedup " << (batchMs > 0 ? scalarMs / batchMs : 0.0) << "x  (checksum " << sink << ")" << std::endl;
+    check(std::isfinite(sink), "benchmark produced finite output");
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    const size_t n = argc > 1 ? static_cast<size_t>(std::strtoul(argv[1], nullptr, 10)) : 200000;
+    testTimeContext();
+    testAltAz();
+    testPrecession();
+    testTan();
+    benchmark(n > 0 ? n : 1);
+    return test_util::finish();
+}
@@ -0,0 +1,250 @@
+// config_store_test.cpp
+// storage::ConfigStore 自检：解析历史 config.ini 各段写法（参数段/ClientSettings/列表段/设备块）并原样写回、
+// 类型化读取、无变化不写盘不通知、修改通知与退订、防抖合并为一次原子替换、持续修改最迟落盘、
+// 析构写出、写盘失败回调、多线程并发写
+//
+// 用法：config_store_test
+// 任一检查失败返回 1
+
+#include "../storage/ConfigStore.h"
+#include "test_util.h"
+
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace storage;
+
+using test_util::check;
+
+namespace {
+
+std::string readAll(const std::string& path)
+{
+    std::ifstream in(path, std::ios::binary);
+    return std::string((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+}
+
+void sleepMs(int ms)
+{
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+// 与 Tools 历史写法一致的样例
+const char* kLegacy =
+    "[LastConnectedDevice]\n"
+    "Description=Mount\n"
+    "DeviceIndiGroup=0\n"
+    "DriverIndiName=indi_eqmod_telescope\n"
+    "\n"
+    "Description=MainCamera\n"
+    "DeviceIndiGroup=1\n"
+    "DriverIndiName=indi_qhy_ccd\n"
+    "\n"
+    "(End of device list)\n"
+    "\n"
+    "[MainCamera]\n"
+    "OffsetGain=12\n"
+    "Gain=30\n"
+    "Save Folder=local\n"
+    "(End of MainCamera Parameter)\n"
+    "\n"
+    "[CFWList(QHYCFW3)]\n"
+    "CFWList=L,R,G,B\n"
+    "(End of CFW list)\n"
+    "\n"
+    "[ExpTimeList]\n"
+    "ExpTimeList=1s,5s,10s\n"
+    "(End of ExpTime list)\n"
+    "\n"
+    "\n"
+    "[ClientSettings]\n"
+    "Coordinates = 31.2,121.5\n"
+    "  MainCameraFocalLength =  510 \n";
+
+void testParse(const std::string& dir)
+{
+    std::cout << "[parse]" << std::endl;
+    ConfigStore::Options opt;
+    opt.path = dir + "/parse.ini";
+    ConfigStore store(opt);
+    store.parse(kLegacy);
+
+    check(store.value("MainCamera", "Gain") == "30" && store.value("MainCamera", "OffsetGain") == "12",
+          "parameter section keys (no prefix confusion)");
+    check(store.value("MainCamera", "Save Folder") == "local", "keys with spaces");
+    const auto entries = store.entries("MainCamera");
+    check(entries.size() == 3 && entries[0].first == "OffsetGain" && entries[2].first == "Save Folder",
+          "entries keep file order");
+    check(store.value("CFWList(QHYCFW3)", "CFWList") == "L,R,G,B", "CFW list section");
+    check(store.value("ExpTimeList", "ExpTimeList") == "1s,5s,10s", "ExpTime list section");
+    check(store.value("ClientSettings", "Coordinates") == "31.2,121.5" &&
+              store.value("ClientSettings", "MainCameraFocalLength") == "510",
+          "ClientSettings 'key = value' trimmed");
+    const std::string devices = store.rawSection("LastConnectedDevice");
+    check(devices.find("Description=Mount\n") == 0 && devices.find("Description=MainCamera") != std::string::npos &&
+              devices.find("End of") == std::string::npos,
+          "device blocks kept verbatim without end marker");
+    check(store.value("Missing", "x", "def") == "def" && !store.hasSection("Missing"), "missing lookups");
+
+    const std::string out = store.serialize();
+    check(out.find("[MainCamera]\nOffsetGain=12\nGain=30\nSave Folder=local\n(End of MainCamera Parameter)\n\n") !=
+              std::string::npos,
+          "parameter section written with its end marker");
+    check(out.find("[ClientSettings]\nCoordinates = 31.2,121.5\nMainCameraFocalLength = 510\n") != std::string::npos,
+          "ClientSettings written as 'key = value'");
+    check(out.find("DriverIndiName=indi_qhy_ccd\n\n(End of device list)\n") != std::string::npos,
+          "device list end marker kept");
+
+    ConfigStore again(opt);
+    again.parse(out);
+    check(again.serialize() == out, "serialize/parse round trip is stable");
+
+    // 历史 bug 留下的重复段、缺结束标记
+    store.parse("[Focuser]\nStep=10\n(End of Focuser Parameter)\n\n[Focuser]\nStep=20\nSpeed=3\n"
+                "[LastConnectedDevice]\nDescription=Mount\n\n\n[Guider]\nExp=1\n");
+    check(store.value("Focuser", "Step") == "20" && store.value("Focuser", "Speed") == "3",
+          "duplicate sections merged, later value wins");
+    check(store.rawSection("LastConnectedDevice") == "Description=Mount\n", "unterminated device list trimmed");
+    check(store.serialize().find("(End of Guider Parameter)") != std::string::npos,
+          "missing end marker restored on write");
+}
+
+void testTypedAndNotify(const std::string& dir)
+{
+    std::cout << "[typed/notify]" << std::endl;
+    ConfigStore::Options opt;
+    opt.path = dir + "/typed.ini";
+    ConfigStore store(opt);
+    store.setValues("Guider", {{"Exp", "1500"}, {"Scale", "1.25"}, {"Enabled", "TRUE"}, {"Bad", "12x"}});
+    check(store.intValue("Guider", "Exp", 0) == 1500 && store.doubleValue("Guider", "Scale", 0.0) == 1.25 &&
+              store.boolValue("Guider", "Enabled", false),
+          "typed getters");
+    check(store.intValue("Guider", "Bad", -1) == -1 && store.boolValue("Guider", "Bad", true) &&
+              store.intValue("Guider", "Nope", 7) == 7,
+          "unparsable or missing -> fallback");
+
+    std::vector<std::string> seen;
+    const int token = store.subscribe([&](const std::string& section, const std::string& key, const std::string& value) {
+        seen.push_back(section + "." + key + "=" + value);
+    });
+    store.setValue("Guider", "Exp", "1500");
+    check(seen.empty(), "unchanged value -> no notification");
+    store.setValue("Guider", "Exp", "2000");
+    store.replaceSection("Guider", {{"Exp", "2000"}, {"Gain", "5"}});
+    check(seen.size() == 5 && seen[0] == "Guider.Exp=2000" && seen[1] == "Guider.Gain=5" && seen[2] == "Guider.Scale=",
+          "changes and removals notified");
+    check(store.entries("Guider").size() == 2, "replaceSection drops old keys");
+    store.unsubscribe(token);
+    store.setValue("Guider", "Exp", "3000");
+    check(seen.size() == 5, "no callbacks after unsubscribe");
+}
+
+void testPersistence(const std::string& dir)
+{
+    std::cout << "[persistence]" << std::endl;
+    const std::string path = dir + "/config/config.ini";
+    ConfigStore::Options opt;
+    opt.path = path;
+    opt.debounceMs = 60;
+    opt.maxDelayMs = 250;
+
+    {
+        ConfigStore store(opt);
+        check(store.load() && store.entries("ClientSettings").empty(), "missing file loads as empty");
+        for (int i = 0; i < 30; ++i)
+            store.setValue("ClientSettings", "Slider", std::to_string(i));
+        check(store.dirty() && store.saveCount() == 0, "changes are held in memory");
+        sleepMs(250);
+        check(store.saveCount() == 1 && !store.dirty(), "burst of 30 changes -> one write");
+        const std::string text = readAll(path);
+        check(text.find("Slider = 29\n") != std::string::npos, "last value on disk");
+        check(!std::filesystem::exists(path + ".tmp"), "temporary file renamed away");
+
+        store.setValue("ClientSettings", "Slider", "29");
+        sleepMs(120);
+        check(store.saveCount() == 1, "unchanged value -> no write");
+
+        // 一直在改（间隔小于防抖时间）也要按 maxDelayMs 落盘
+        const auto t0 = std::chrono::steady_clock::now();
+        int i = 0;
+        while (std::chrono::steady_clock::now() - t0 < std::chrono::milliseconds(600)) {
+            store.setValue("ClientSettings", "Drag", std::to_string(i++));
+            sleepMs(15);
+        }
+        const uint64_t during = store.saveCount() - 1;
+        check(during >= 1 && during <= 3, "continuous changes flushed by max delay (" + std::to_string(during) + ")");
+
+        store.setValue("MainCamera", "Gain", "40");
+        check(store.flush() && !store.dirty() && readAll(path).find("Gain=40") != std::string::npos, "flush writes now");
+        store.setValue("MainCamera", "Gain", "41");
+    }
+    check(readAll(path).find("Gain=41") != std::string::npos, "destructor writes pending changes");
+
+    ConfigStore reloaded(opt);
+    check(reloaded.load() && reloaded.value("MainCamera", "Gain") == "41" &&
+              reloaded.value("ClientSettings", "Slider") == "29",
+          "reload sees persisted values");
+
+    ConfigStore::Options badOpt = opt;
+    badOpt.path = "/proc/version/config.ini";
+    ConfigStore bad(badOpt);
+    std::atomic<int> errors{0};
+    bad.setErrorHandler([&](const std::string&) { ++errors; });
+    bad.setValue("X", "y", "1");
+    sleepMs(200);
+    std::string error;
+    check(errors.load() == 1 && bad.dirty(), "write failure reported once, change kept");
+    check(!bad.flush(&error) && !error.empty(), "flush reports the error");
+    bad.setErrorHandler(nullptr);
+}
+
+void testConcurrent(const std::string& dir)
+{
+    std::cout << "[concurrent]" << std::endl;
+    ConfigStore::Options opt;
+    opt.path = dir + "/concurrent.ini";
+    opt.debounceMs = 20;
+    ConfigStore store(opt);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&store, t] {
+            for (int i = 0; i < 500; ++i) {
+                store.setValue("T" + std::to_string(t), "k" + std::to_string(i), std::to_string(i));
+                (void)store.value("T" + std::to_string((t + 1) % 4), "k" + std::to_string(i));
+            }
+        });
+    }
+    for (auto& th : threads)
+        th.join();
+    check(store.flush(), "flush after concurrent writers");
+    ConfigStore reloaded(opt);
+    reloaded.load();
+    bool complete = true;
+    for (int t = 0; t < 4; ++t)
+        complete = complete && reloaded.entries("T" + std::to_string(t)).size() == 500;
+    check(complete, "all 2000 keys persisted");
+}
+
+} // namespace
+
+int main()
+{
+    const test_util::TempDir tmp("config_store_test");
+    if (!tmp.ok()) {
+        std::cout << "mkdtemp failed" << std::endl;
+        return 1;
+    }
+    const std::string dir = tmp.path();
+    testParse(dir);
+    testTypedAndNotify(dir);
+    testPersistence(dir);
+    testConcurrent(dir);
+    return test_util::finish();
+}
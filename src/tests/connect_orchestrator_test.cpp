@@ -0,0 +1,227 @@
+// connect_orchestrator_test.cpp
+// devices::ConnectOrchestrator 自检：独立设备并发（总耗时≈最慢设备而非之和）、依赖顺序、
+// 共享资源串行、单次超时重试、失败向下游传播、未知依赖/依赖环
+//
+// 用法：connect_orchestrator_test
+// 任一检查失败返回 1
+
+#include "../devices/ConnectOrchestrator.h"
+#include "test_util.h"
+
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+
+using namespace devices;
+
+using test_util::check;
+
+namespace {
+
+int64_t nowMs()
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+// 模拟一台 INDI 设备：start 发出连接请求，latencyMs 后 isConnected；
+// failAttempts 次之前的尝试永远连不上（模拟串口选错，补救后才成功）
+struct FakeDevice {
+    int latencyMs{0};
+    int failAttempts{0};
+    int64_t connectAt{-1};
+    int starts{0};
+    int remedies{0};
+
+    bool connected() const { return connectAt >= 0 && nowMs() >= connectAt; }
+};
+
+ConnectTask makeTask(const std::string& name, const std::shared_ptr<FakeDevice>& dev, int timeoutMs = 1000)
+{
+    ConnectTask task;
+    task.name = name;
+    task.timeoutMs = timeoutMs;
+    task.retryDelayMs = 10;
+    task.start = [dev](int attempt) {
+        ++dev->starts;
+        dev->connectAt = attempt > dev->failAttempts ? nowMs() + dev->latencyMs : -1;
+        return true;
+    };
+    task.poll = [dev]() { return dev->connected() ? ConnectPoll::Done : ConnectPoll::Pending; };
+    task.onAttemptFailed = [dev](int) {
+        ++dev->remedies;
+        return true;
+    };
+    return task;
+}
+
+std::map<std::string, ConnectReport> byName(const std::vector<ConnectReport>& reports)
+{
+    std::map<std::string, ConnectReport> out;
+    for (const auto& r : reports)
+        out[r.name] = r;
+    return out;
+}
+
+void testParallel()
+{
+    std::cout << "[parallel]" << std::endl;
+    ConnectOrchestrator orch;
+    orch.setPollIntervalMs(5);
+    const int latencies[] = {300, 250, 200, 150};
+    const char* names[] = {"Mount", "MainCamera", "Guider", "Focuser"};
+    for (int i = 0; i < 4; ++i) {
+        auto dev = std::make_shared<FakeDevice>();
+        dev->latencyMs = latencies[i];
+        orch.addTask(makeTask(names[i], dev));
+    }
+    int finishedCallbacks = 0;
+    orch.setOnFinished([&](const ConnectReport&) { ++finishedCallbacks; });
+    auto reports = byName(orch.run());
+    bool allDone = true;
+    for (const auto& kv : reports)
+        allDone = allDone && kv.second.status == ConnectStatus::Done && kv.second.attempts == 1;
+    check(allDone, "all independent devices connect on first attempt");
+    std::cout << "  total=" << orch.elapsedMs() << " ms (sequential would be 900 ms)" << std::endl;
+    check(orch.elapsedMs() < 450, "total time is close to the slowest device, not the sum");
+    check(reports["Mount"].durationMs() >= 290 && reports["Focuser"].durationMs() < 250,
+          "per-device durations are reported individually");
+    check(finishedCallbacks == 4, "onFinished fires once per task");
+}
+
+void testDependenciesAndResources()
+{
+    std::cout << "[dependencies]" << std::endl;
+    ConnectOrchestrator orch;
+    orch.setPollIntervalMs(5);
+    auto camera = std::make_shared<FakeDevice>();
+    camera->latencyMs = 100;
+    auto wheel = std::make_shared<FakeDevice>();
+    wheel->latencyMs = 50;
+    auto mount = std::make_shared<FakeDevice>();
+    mount->latencyMs = 100;
+    auto focuser = std::make_shared<FakeDevice>();
+    focuser->latencyMs = 100;
+
+    orch.addTask(makeTask("MainCamera", camera));
+    ConnectTask wheelTask = makeTask("CFW", wheel);
+    wheelTask.dependsOn = {"MainCamera"};
+    orch.addTask(wheelTask);
+    ConnectTask mountTask = makeTask("Mount", mount);
+    mountTask.resource = "ttyUSB";
+    orch.addTask(mountTask);
+    ConnectTask focuserTask = makeTask("Focuser", focuser);
+    focuserTask.resource = "ttyUSB";
+    orch.addTask(focuserTask);
+
+    auto reports = byName(orch.run());
+    check(reports["CFW"].status == ConnectStatus::Done && reports["CFW"].startMs >= reports["MainCamera"].endMs,
+          "dependent starts only after its dependency is connected");
+    check(reports["Focuser"].startMs >= reports["Mount"].endMs, "tasks sharing a resource run one at a time");
+    check(reports["MainCamera"].startMs < reports["Mount"].endMs, "unrelated chains still overlap");
+    std::cout << "  total=" << orch.elapsedMs() << " ms" << std::endl;
+    check(orch.elapsedMs() < 300, "critical path bounds total time");
+}
+
+void testRetryAndFailure()
+{
+    std::cout << "[retry]" << std::endl;
+    ConnectOrchestrator orch;
+    orch.setPollIntervalMs(5);
+    auto flaky = std::make_shared<FakeDevice>();
+    flaky->latencyMs = 20;
+    flaky->failAttempts = 1;
+    auto dead = std::make_shared<FakeDevice>();
+    dead->failAttempts = 100;
+    auto downstream = std::make_shared<FakeDevice>();
+
+    ConnectTask flakyTask = makeTask("Focuser", flaky, 80);
+    flakyTask.maxAttempts = 3;
+    orch.addTask(flakyTask);
+    ConnectTask deadTask = makeTask("Mount", dead, 60);
+    deadTask.maxAttempts = 2;
+    orch.addTask(deadTask);
+    ConnectTask downstreamTask = makeTask("MountAux", downstream);
+    downstreamTask.dependsOn = {"Mount"};
+    orch.addTask(downstreamTask);
+
+    ConnectTask gated;
+    gated.name = "NeverReady";
+    gated.timeoutMs = 40;
+    gated.maxAttempts = 1;
+    gated.ready = []() { return false; };
+    gated.start = [](int) { return true; };
+    orch.addTask(gated);
+
+    auto reports = byName(orch.run());
+    check(reports["Focuser"].status == ConnectStatus::Done && reports["Focuser"].attempts == 2 && flaky->remedies == 1,
+          "timed-out attempt is remedied and retried");
+    check(reports["Mount"].status == ConnectStatus::Failed && reports["Mount"].attempts == 2 && dead->starts == 2,
+          "attempts are capped by maxAttempts");
+    check(reports["Mount"].message.find("timeout") != std::string::npos, "failure reason is reported");
+    check(reports["MountAux"].status == ConnectStatus::Skipped && downstream->starts == 0,
+          "dependents of a failed task are skipped without starting");
+    check(reports["NeverReady"].status == ConnectStatus::Failed, "ready gate counts against the attempt timeout");
+
+    ConnectOrchestrator giveUp;
+    giveUp.setPollIntervalMs(5);
+    auto noPort = std::make_shared<FakeDevice>();
+    noPort->failAttempts = 100;
+    ConnectTask noPortTask = makeTask("Mount", noPort, 30);
+    noPortTask.maxAttempts = 5;
+    noPortTask.onAttemptFailed = [](int) { return false; };
+    giveUp.addTask(noPortTask);
+    auto giveUpReports = byName(giveUp.run());
+    check(giveUpReports["Mount"].attempts == 1 && giveUpReports["Mount"].status == ConnectStatus::Failed,
+          "onAttemptFailed returning false stops retrying");
+}
+
+void testInvalidGraphs()
+{
+    std::cout << "[graph]" << std::endl;
+    ConnectOrchestrator orch;
+    orch.setPollIntervalMs(5);
+    auto a = std::make_shared<FakeDevice>();
+    auto b = std::make_shared<FakeDevice>();
+    auto c = std::make_shared<FakeDevice>();
+    ConnectTask ta = makeTask("A", a);
+    ta.dependsOn = {"B"};
+    ConnectTask tb = makeTask("B", b);
+    tb.dependsOn = {"A"};
+    ConnectTask tc = makeTask("C", c);
+    tc.dependsOn = {"Missing"};
+    orch.addTask(ta);
+    orch.addTask(tb);
+    orch.addTask(tc);
+    auto reports = byName(orch.run(2000));
+    check(reports["A"].status == ConnectStatus::Failed && reports["B"].status == ConnectStatus::Failed &&
+              reports["A"].message == "dependency cycle",
+          "dependency cycle is reported instead of hanging");
+    check(reports["C"].status == ConnectStatus::Failed && reports["C"].message.find("Missing") != std::string::npos,
+          "unknown dependency is reported");
+    check(a->starts == 0 && b->starts == 0 && c->starts == 0, "nothing in an invalid graph is started");
+    check(orch.elapsedMs() < 500, "invalid graph returns promptly");
+
+    ConnectOrchestrator overall;
+    overall.setPollIntervalMs(5);
+    auto slow = std::make_shared<FakeDevice>();
+    slow->latencyMs = 10000;
+    overall.addTask(makeTask("Slow", slow, 20000));
+    auto overallReports = byName(overall.run(100));
+    check(overallReports["Slow"].status == ConnectStatus::Failed && overall.elapsedMs() < 500,
+          "overall timeout bounds the run");
+}
+
+} // namespace
+
+int main()
+{
+    testParallel();
+    testDependenciesAndResources();
+    testRetryAndFailure();
+    testInvalidGraphs();
+    return test_util::finish();
+}
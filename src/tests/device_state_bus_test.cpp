@@ -0,0 +1,150 @@
+// device_state_bus_test.cpp
+// devices::DeviceStateBus 自检：角色绑定/SDK 槽位、waitFor 的唤醒延迟与超时、cancelWaits、
+// 订阅回调与 unsubscribe、常用等待条件
+//
+// 用法：device_state_bus_test
+// 任一检查失败返回 1
+
+#include "../devices/DeviceStateBus.h"
+#include "test_util.h"
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+
+using namespace devices;
+
+using test_util::check;
+
+namespace {
+
+double elapsedMs(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void testBinding()
+{
+    std::cout << "[binding]" << std::endl;
+    DeviceStateBus& bus = DeviceStateBus::instance();
+    bus.clear();
+
+    bus.update("EQMod Mount", [](DeviceState& s) {
+        s.mount.hasCoord = true;
+        s.mount.raHours = 5.5;
+        s.mount.eqState = PropState::Ok;
+    });
+    check(!bus.hasState(DeviceRole::Mount), "unbound device not visible by role");
+    bus.bindRole(DeviceRole::Mount, "EQMod Mount");
+    const DeviceState mount = bus.snapshot(DeviceRole::Mount);
+    check(bus.hasState(DeviceRole::Mount) && mount.mount.raHours == 5.5, "state written before binding visible after");
+    check(mount.deviceName == "EQMod Mount" && mount.version == 1, "device name and version");
+
+    bus.updateRole(DeviceRole::MainCamera, [](DeviceState& s) { s.camera.imageSeq = 3; });
+    check(bus.snapshot(DeviceRole::MainCamera).camera.imageSeq == 3, "sdk role slot without device name");
+
+    bus.bindRole(DeviceRole::Mount, std::string());
+    check(!bus.hasState(DeviceRole::Mount), "unbind hides device state");
+}
+
+void testWaitWakeup()
+{
+    std::cout << "[waitFor]" << std::endl;
+    DeviceStateBus& bus = DeviceStateBus::instance();
+    bus.clear();
+    bus.bindRole(DeviceRole::Mount, "Mount");
+    bus.update("Mount", [](DeviceState& s) { s.mount.eqState = PropState::Busy; });
+
+    check(!cond::mountIdle()(bus.snapshot(DeviceRole::Mount)), "busy mount is not idle");
+
+    auto start = std::chrono::steady_clock::now();
+    check(!bus.waitFor(DeviceRole::Mount, cond::mountIdle(), 50), "wait times out while slewing");
+    const double timeoutMs = elapsedMs(start);
+    check(timeoutMs >= 45.0 && timeoutMs < 500.0, "timeout honoured (" + std::to_string(timeoutMs) + " ms)");
+
+    std::atomic<double> wakeLatencyMs{-1.0};
+    std::chrono::steady_clock::time_point changedAt;
+    std::thread waiter([&]() {
+        DeviceState out;
+        if (bus.waitFor(DeviceRole::Mount, cond::mountIdle(), 5000, &out))
+            wakeLatencyMs = elapsedMs(changedAt);
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(30));
+    changedAt = std::chrono::steady_clock::now();
+    bus.update("Mount", [](DeviceState& s) { s.mount.eqState = PropState::Ok; });
+    waiter.join();
+    check(wakeLatencyMs >= 0.0 && wakeLatencyMs < 50.0,
+          "waiter wakes on state change (" + std::to_string(wakeLatencyMs.load()) + " ms)");
+
+    // 已满足的条件立即返回
+    start = std::chrono::steady_clock::now();
+    check(bus.waitFor(DeviceRole::Mount, cond::mountIdle(), 1000) && elapsedMs(start) < 5.0,
+          "already satisfied returns immediately");
+
+    // 手动移动同样算忙
+    bus.update("Mount", [](DeviceState& s) { s.mount.motionNS = PropState::Busy; });
+    check(!cond::mountIdle()(bus.snapshot(DeviceRole::Mount)), "manual NS motion is not idle");
+
+    std::atomic<bool> cancelled{false};
+    std::thread cancelWaiter([&]() {
+        cancelled = !bus.waitFor(DeviceRole::Mount, cond::mountIdle(), 5000);
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    start = std::chrono::steady_clock::now();
+    bus.cancelWaits();
+    cancelWaiter.join();
+    check(cancelled && elapsedMs(start) < 100.0, "cancelWaits releases waiters");
+}
+
+void testConditions()
+{
+    std::cout << "[conditions]" << std::endl;
+    DeviceState s;
+    check(!cond::mountIdle()(s), "mount with no coordinate property is unknown, not idle");
+
+    s.camera.imageSeq = 4;
+    check(!cond::exposureDone(4)(s) && cond::exposureDone(3)(s), "exposureDone compares sequence");
+
+    s.focuser.hasPosition = true;
+    s.focuser.position = 1005;
+    s.focuser.state = PropState::Busy;
+    check(!cond::focuserAt(1000, 10)(s), "busy focuser not at position");
+    s.focuser.state = PropState::Ok;
+    check(cond::focuserAt(1000, 10)(s) && !cond::focuserAt(1000, 2)(s), "focuserAt tolerance");
+}
+
+void testListeners()
+{
+    std::cout << "[subscribe]" << std::endl;
+    DeviceStateBus& bus = DeviceStateBus::instance();
+    bus.clear();
+    bus.bindRole(DeviceRole::Focuser, "Focuser");
+
+    int calls = 0;
+    DeviceRole lastRole = DeviceRole::Count;
+    const int token = bus.subscribe([&](DeviceRole role, const DeviceState& state) {
+        ++calls;
+        lastRole = role;
+        (void)state;
+    });
+    bus.update("Focuser", [](DeviceState& s) { s.focuser.position = 10; });
+    bus.update("Unbound", [](DeviceState& s) { s.focuser.position = 20; });
+    check(calls == 1 && lastRole == DeviceRole::Focuser, "listener called for bound role only");
+
+    bus.unsubscribe(token);
+    bus.update("Focuser", [](DeviceState& s) { s.focuser.position = 30; });
+    check(calls == 1, "no callback after unsubscribe");
+}
+
+} // namespace
+
+int main()
+{
+    testBinding();
+    testWaitWakeup();
+    testConditions();
+    testListeners();
+    return test_util::finish();
+}
@@ -0,0 +1,312 @@
+// file_export_engine_test.cpp
+// storage::FileExportEngine 自检：XXH64 向量、单文件复制/续传/跳过/校验、批量导出进度与取消续传、权限失败回退
+//
+// 用法：file_export_engine_test [workDir]
+// 默认在 /tmp 下创建临时目录，结束后删除；任一检查失败返回 1
+//
+// 也可以把 workDir 指到 U 盘上的目录，顺便看一下 copy_file_range/sendfile 的实际吞吐：
+//   file_export_engine_test /media/quarcs/<U盘>/export_test
+
+#include "../storage/FileExportEngine.h"
+#include "test_util.h"
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+using test_util::check;
+
+namespace {
+
+uint64_t xxh64Of(const std::string& s)
+{
+    storage::Xxh64 h;
+    h.update(s.data(), s.size());
+    return h.digest();
+}
+
+void writeRandomFile(const std::string& path, size_t bytes, unsigned seed)
+{
+    std::mt19937_64 rng(seed);
+    std::vector<uint64_t> data((bytes + 7) / 8);
+    for (auto& v : data)
+        v = rng();
+    std::ofstream out(path, std::ios::binary);
+    out.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(bytes));
+}
+
+bool sameContent(const std::string& a, const std::string& b)
+{
+    uint64_t ha = 0, hb = 0;
+    return storage::fileChecksum(a, &ha) && storage::fileChecksum(b, &hb) && ha == hb &&
+           fs::file_size(a) == fs::file_size(b);
+}
+
+void testXxh64()
+{
+    std::cout << "[xxh64]" << std::endl;
+    check(xxh64Of("") == 0xEF46DB3751D8E999ULL, "empty string");
+    check(xxh64Of("a") == 0xD24EC4F1A98C6E5BULL, "\"a\"");
+    check(xxh64Of("abc") == 0x44BC2CF5AD770999ULL, "\"abc\"");
+    check(xxh64Of("Nobody inspects the spammish repetition") == 0xFBCEA83C8A378BF1ULL, "39-byte string");
+
+    // 分块 update 与一次性 update 结果一致
+    std::string big(100000, '\0');
+    for (size_t i = 0; i < big.size(); ++i)
+        big[i] = static_cast<char>((i * 131) ^ (i >> 7));
+    storage::Xxh64 chunked;
+    for (size_t pos = 0; pos < big.size();) {
+        const size_t n = std::min<size_t>(1 + (pos % 61), big.size() - pos);
+        chunked.update(big.data() + pos, n);
+        pos += n;
+    }
+    check(chunked.digest() == xxh64Of(big), "streaming == one-shot");
+}
+
+void testCopyFile(const std::string& dir)
+{
+    std::cout << "[copyFile]" << std::endl;
+    const std::string src = dir + "/src.fits";
+    const std::string dst = dir + "/out/sub/dst.fits";
+    writeRandomFile(src, (24u << 20) + 12345, 1);
+
+    storage::CopyOptions opt;
+    opt.chunkBytes = 1u << 20;
+    uint64_t reported = 0;
+    auto r = storage::copyFile(src, dst, opt, [&](uint64_t n, bool) { reported += n; });
+    check(r.outcome == storage::CopyOutcome::Copied, std::string("fresh copy (") + r.method + ", " + r.error + ")");
+    check(sameContent(src, dst), "content identical");
+    check(reported == r.fileBytes, "progress covers whole file");
+    check(!fs::exists(dst + ".part"), "no .part left behind");
+
+    r = storage::copyFile(src, dst, opt);
+    check(r.outcome == storage::CopyOutcome::Skipped, "second copy skipped");
+
+    // 模拟中断：截一段写成 .part，再续传
+    fs::remove(dst);
+    {
+        std::ifstream in(src, std::ios::binary);
+        std::vector<char> head(9u << 20);
+        in.read(head.data(), static_cast<std::streamsize>(head.size()));
+        std::ofstream part(dst + ".part", std::ios::binary);
+        part.write(head.data(), static_cast<std::streamsize>(head.size()));
+    }
+    r = storage::copyFile(src, dst, opt);
+    check(r.outcome == storage::CopyOutcome::Resumed && r.resumedFrom == (9u << 20), "resumed from .part");
+    check(r.transferredBytes == r.fileBytes - r.resumedFrom, "only the tail transferred");
+    check(sameContent(src, dst), "resumed content identical");
+
+    // .part 与源不一致时从头复制
+    fs::remove(dst);
+    writeRandomFile(dst + ".part", 3u << 20, 99);
+    r = storage::copyFile(src, dst, opt);
+    check(r.outcome == storage::CopyOutcome::Copied && r.resumedFrom == 0, "stale .part discarded");
+    check(sameContent(src, dst), "content identical after stale .part");
+
+    // 校验模式
+    fs::remove(dst);
+    opt.verify = true;
+    r = storage::copyFile(src, dst, opt);
+    uint64_t expected = 0;
+    storage::fileChecksum(src, &expected);
+    check(r.ok() && r.verified && r.checksum == expected, "verified copy checksum");
+
+    r = storage::copyFile(dir + "/missing.fits", dst, opt);
+    check(r.outcome == storage::CopyOutcome::Failed && r.errorCode == ENOENT, "missing source reports ENOENT");
+}
+
+void testBatch(const std::string& dir)
+{
+    std::cout << "[batch]" << std::endl;
+    std::vector<storage::ExportItem> items;
+    for (int i = 0; i < 12; ++i) {
+        const std::string src = dir + "/batch_src/img_" + std::to_string(i) + ".fits";
+        fs::create_directories(fs::path(src).parent_path());
+        writeRandomFile(src, (4u << 20) + static_cast<size_t>(i) * 4099, 100 + i);
+        items.push_back({src, dir + "/batch_dst/night/img_" + std::to_string(i) + ".fits"});
+    }
+
+    storage::FileExportEngine engine(3, 1);
+    storage::CopyOptions opt;
+    opt.chunkBytes = 256u << 10;
+
+    std::mutex mu;
+    size_t fileEvents = 0;
+    size_t progressEvents = 0;
+    uint64_t lastBytes = 0;
+    bool monotonic = true;
+    storage::ExportProgress final;
+    bool finished = false;
+
+    storage::FileExportEngine::Callbacks cb;
+    cb.onFileDone = [&](const storage::ExportFileEvent&) {
+        std::lock_guard<std::mutex> lock(mu);
+        ++fileEvents;
+    };
+    cb.onProgress = [&](const storage::ExportProgress& p) {
+        std::lock_guard<std::mutex> lock(mu);
+        ++progressEvents;
+        if (p.bytesDone < lastBytes)
+            monotonic = false;
+        lastBytes = p.bytesDone;
+    };
+    cb.onFinished = [&](const storage::ExportProgress& p) {
+        std::lock_guard<std::mutex> lock(mu);
+        final = p;
+        finished = true;
+    };
+
+    const uint64_t id = engine.submit(items, opt, cb, 50);
+    check(id != 0, "batch submitted");
+    check(engine.waitIdle(60000), "batch drained");
+    {
+        std::lock_guard<std::mutex> lock(mu);
+        check(finished && final.filesDone == items.size() && final.filesFailed == 0, "all files exported");
+        check(final.bytesDone == final.bytesTotal, "bytes complete");
+        check(fileEvents == items.size(), "one file event per item");
+        check(progressEvents > 0 && monotonic, "progress reported and monotonic");
+    }
+    bool allSame = true;
+    for (const auto& it : items)
+        allSame = allSame && sameContent(it.source, it.destination);
+    check(allSame, "batch content identical");
+    check(engine.unfinishedItems(id).empty(), "nothing left to resume");
+
+    // 取消后续传：第二次只补剩下的，已完成的跳过
+    for (const auto& it : items)
+        fs::remove(it.destination);
+    finished = false;
+    std::atomic<int> doneBeforeCancel{0};
+    storage::FileExportEngine::Callbacks cancelCb;
+    uint64_t cancelId = 0;
+    cancelCb.onFileDone = [&](const storage::ExportFileEvent& ev) {
+        if (ev.result.ok() && ++doneBeforeCancel == 3)
+            engine.cancel(ev.batchId);
+    };
+    cancelId = engine.submit(items, opt, cancelCb, 50);
+    engine.waitIdle(60000);
+    const auto left = engine.unfinishedItems(cancelId);
+    check(!left.empty() && left.size() < items.size(), "cancel leaves unfinished items (" + std::to_string(left.size()) + ")");
+
+    std::atomic<int> skipped{0};
+    storage::FileExportEngine::Callbacks resumeCb;
+    resumeCb.onFileDone = [&](const storage::ExportFileEvent& ev) {
+        if (ev.result.outcome == storage::CopyOutcome::Skipped)
+            ++skipped;
+    };
+    const uint64_t resumeId = engine.submit(items, opt, resumeCb, 50);
+    engine.waitIdle(60000);
+    check(engine.unfinishedItems(resumeId).empty(), "resubmitted batch completes");
+    check(skipped.load() >= 3, "completed files skipped on resume");
+    allSame = true;
+    for (const auto& it : items)
+        allSame = allSame && sameContent(it.source, it.destination);
+    check(allSame, "resumed batch content identical");
+}
+
+// 目标目录不可写（EACCES）时走 onPermissionDenied 回退；这里用普通复制代替 sudo cp
+void testPermissionFallback(const std::string& dir)
+{
+    std::cout << "[permission fallback]" << std::endl;
+    if (::geteuid() == 0) {
+        std::cout << "  skip (running as root, directory permissions are not enforced)" << std::endl;
+        return;
+    }
+    const std::string src = dir + "/perm_src.fits";
+    const std::string lockedDir = dir + "/perm_locked";
+    writeRandomFile(src, 1u << 20, 7);
+    fs::create_directories(lockedDir);
+    ::chmod(lockedDir.c_str(), 0555);
+    const std::vector<storage::ExportItem> items{{src, lockedDir + "/a.fits"}, {src, lockedDir + "/b.fits"}};
+
+    storage::FileExportEngine engine(2, 1);
+    std::mutex mu;
+    std::vector<std::string> fallbackCalls;
+    std::vector<storage::CopyResult> results;
+    bool failFallback = false;
+    storage::FileExportEngine::Callbacks cb;
+    cb.onPermissionDenied = [&](const storage::ExportItem& item, std::string* error) {
+        std::lock_guard<std::mutex> lock(mu);
+        fallbackCalls.push_back(item.destination);
+        if (failFallback) {
+            *error = "denied";
+            return false;
+        }
+        ::chmod(lockedDir.c_str(), 0755);
+        const auto r = storage::copyFile(item.source, item.destination, storage::CopyOptions());
+        ::chmod(lockedDir.c_str(), 0555);
+        return r.ok();
+    };
+    cb.onFileDone = [&](const storage::ExportFileEvent& ev) {
+        std::lock_guard<std::mutex> lock(mu);
+        results.push_back(ev.result);
+    };
+    engine.submit(items, storage::CopyOptions(), cb, 50);
+    engine.waitIdle(60000);
+    {
+        std::lock_guard<std::mutex> lock(mu);
+        check(fallbackCalls.size() == items.size(), "fallback called for every denied file");
+        bool allOk = results.size() == items.size();
+        for (const auto& r : results)
+            allOk = allOk && r.ok() && std::string(r.method) == "fallback";
+        check(allOk, "fallback copies reported as copied");
+        fallbackCalls.clear();
+        results.clear();
+        failFallback = true;
+    }
+    check(sameContent(src, lockedDir + "/a.fits") && sameContent(src, lockedDir + "/b.fits"), "fallback content identical");
+
+    const std::vector<storage::ExportItem> more{{src, lockedDir + "/c.fits"}};
+    engine.submit(more, storage::CopyOptions(), cb, 50);
+    engine.waitIdle(60000);
+    {
+        std::lock_guard<std::mutex> lock(mu);
+        check(results.size() == 1 && !results[0].ok() && results[0].errorCode == EACCES &&
+                  results[0].error.find("fallback: denied") != std::string::npos,
+              "failed fallback keeps EACCES and appends its error");
+    }
+    ::chmod(lockedDir.c_str(), 0755);
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    std::string dir;
+    std::unique_ptr<test_util::TempDir> tmp;  // 未指定 workDir 时用临时目录，退出时删除
+    if (argc > 1) {
+        dir = argv[1];
+        fs::create_directories(dir);
+    } else {
+        tmp = std::make_unique<test_util::TempDir>("file_export_engine_test");
+        if (!tmp->ok()) {
+            std::perror("mkdtemp");
+            return 2;
+        }
+        dir = tmp->path();
+    }
+
+    const auto t0 = std::chrono::steady_clock::now();
+    testXxh64();
+    testCopyFile(dir);
+    testBatch(dir);
+    testPermissionFallback(dir);
+    const double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    return test_util::finish(std::to_string(sec) + " s");
+}
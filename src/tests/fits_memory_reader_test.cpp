@@ -0,0 +1,144 @@
+// fits_memory_reader_test.cpp
+// fits::readFitsFromMemory 自检：fits::writeFrame 写出的 16bit/8bit、RICE 压缩 FITS 整体读入内存后解码，
+// 核对尺寸/像素/头关键字，以及非法缓冲区的失败路径
+//
+// 用法：fits_memory_reader_test [临时目录，默认 /tmp]
+// 任一检查失败返回 1
+
+#include "../fits/FitsMemoryReader.h"
+#include "test_util.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+using test_util::check;
+
+namespace {
+
+std::vector<char> readAll(const std::string& path)
+{
+    std::ifstream in(path, std::ios::binary);
+    return std::vector<char>(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+}
+
+SdkFrameData makeFrame16(int width, int height)
+{
+    SdkFrameData frame;
+    frame.width = width;
+    frame.height = height;
+    frame.bpp = 16;
+    frame.channels = 1;
+    frame.pixels.resize(static_cast<size_t>(width) * height);
+    for (size_t i = 0; i < frame.pixels.size(); ++i)
+        frame.pixels[i] = static_cast<uint16_t>((i * 2654435761u) >> 16);
+    return frame;
+}
+
+SdkFrameData makeFrame8(int width, int height)
+{
+    SdkFrameData frame;
+    frame.width = width;
+    frame.height = height;
+    frame.bpp = 8;
+    frame.channels = 1;
+    auto raw = std::make_shared<std::vector<unsigned char>>(static_cast<size_t>(width) * height);
+    for (size_t i = 0; i < raw->size(); ++i)
+        (*raw)[i] = static_cast<unsigned char>(i * 7);
+    frame.rawBytes = raw->size();
+    frame.rawBuffer = raw;
+    return frame;
+}
+
+fits::HeaderTemplate makeHeader()
+{
+    fits::HeaderTemplate header;
+    header.setDouble("EXPTIME", 2.5, "Exposure time [s]");
+    header.setString("INSTRUME", "QHY CCD Test", "Camera");
+    header.setLong("GAIN", 30, "Gain");
+    header.setLogical("ROWORDER", true, "");
+    return header;
+}
+
+const fits::HeaderTemplate::Card* findCard(const fits::HeaderTemplate& header, const std::string& key)
+{
+    for (const auto& card : header.cards()) {
+        if (card.key == key)
+            return &card;
+    }
+    return nullptr;
+}
+
+void testRoundTrip(const std::string& dir, const std::string& name, const SdkFrameData& source,
+                   fits::Compression compression)
+{
+    std::cout << "[" << name << "]" << std::endl;
+    const std::string path = dir + "/fits_memory_reader_test_" + name + ".fits";
+    fits::WriteOptions options;
+    options.compression = compression;
+    fits::WriteResult result;
+    check(fits::writeFrame(source, path, makeHeader(), options, &result), "writeFrame " + result.error);
+
+    const std::vector<char> bytes = readAll(path);
+    std::remove(path.c_str());
+
+    SdkFrameData decoded;
+    fits::HeaderTemplate header;
+    std::string error;
+    const bool ok = fits::readFitsFromMemory(bytes.data(), bytes.size(), decoded, &header, &error);
+    check(ok, "decode from memory " + error);
+    if (!ok)
+        return;
+
+    check(decoded.width == source.width && decoded.height == source.height && decoded.channels == 1,
+          "dimensions match");
+    check(decoded.bpp == source.bpp, "bpp matches");
+    if (source.bpp == 16) {
+        check(decoded.pixels == source.pixels, "16bit pixels identical");
+    } else {
+        check(decoded.pixels.empty() && decoded.rawBuffer && *decoded.rawBuffer == *source.rawBuffer &&
+                  decoded.rawBytes == source.rawBytes,
+              "8bit pixels identical in rawBuffer");
+    }
+
+    const auto* exptime = findCard(header, "EXPTIME");
+    const auto* instrument = findCard(header, "INSTRUME");
+    const auto* gain = findCard(header, "GAIN");
+    const auto* roworder = findCard(header, "ROWORDER");
+    check(exptime && exptime->kind == fits::HeaderTemplate::Card::Kind::Double && exptime->d == 2.5, "EXPTIME copied");
+    check(instrument && instrument->s == "QHY CCD Test", "INSTRUME copied");
+    check(gain && gain->kind == fits::HeaderTemplate::Card::Kind::Long && gain->l == 30, "GAIN copied");
+    check(roworder && roworder->kind == fits::HeaderTemplate::Card::Kind::Logical && roworder->l != 0,
+          "ROWORDER copied");
+    check(!header.contains("BITPIX") && !header.contains("NAXIS1") && !header.contains("BZERO") &&
+              !header.contains("ZCMPTYPE"),
+          "structural keys are not copied");
+}
+
+void testInvalid()
+{
+    std::cout << "[invalid]" << std::endl;
+    SdkFrameData frame;
+    std::string error;
+    check(!fits::readFitsFromMemory(nullptr, 0, frame, nullptr, &error) && !error.empty(), "null buffer rejected");
+    const std::vector<char> garbage(2880 * 2, 'x');
+    error.clear();
+    check(!fits::readFitsFromMemory(garbage.data(), garbage.size(), frame, nullptr, &error) && !error.empty(),
+          "non-FITS buffer rejected");
+    check(frame.width == 0 && frame.pixels.empty(), "output untouched on failure");
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    const std::string dir = argc > 1 ? argv[1] : "/tmp";
+    testRoundTrip(dir, "u16", makeFrame16(317, 211), fits::Compression::None);
+    testRoundTrip(dir, "u16_rice", makeFrame16(640, 480), fits::Compression::Rice);
+    testRoundTrip(dir, "u8", makeFrame8(123, 77), fits::Compression::None);
+    testInvalid();
+    return test_util::finish();
+}
@@ -0,0 +1,130 @@
+// focus_timeline_test.cpp
+// focus::FocusTimeline 自检：串行扫描不计省时、流水线下分析与移动/曝光重叠的省时、
+// join 等待扣除、移动区间按最近未结束的一段收尾、越界序号忽略
+//
+// 用法：focus_timeline_test
+// 任一检查失败返回 1
+
+#include "../focus/FocusTimeline.h"
+#include "test_util.h"
+
+#include <iostream>
+#include <string>
+
+using namespace focus;
+
+using test_util::check;
+
+namespace {
+
+// 曝光 2 s、分析 1.5 s、移动 3 s，共 4 点
+constexpr int64_t kExposure = 2000;
+constexpr int64_t kAnalysis = 1500;
+constexpr int64_t kMove = 3000;
+
+void testSequential()
+{
+    std::cout << "[sequential]" << std::endl;
+    FocusTimeline t;
+    t.reset(0);
+    int64_t now = 0;
+    for (int i = 0; i < 4; ++i) {
+        const int p = t.addPoint(1000 - i * 100, now);
+        now += kExposure;
+        t.exposureDone(p, now);
+        // 串行：提交后立刻等结果
+        t.analysisSpan(p, now, now + kAnalysis);
+        t.addJoinWait(p, kAnalysis);
+        now += kAnalysis;
+        if (i < 3) {
+            t.moveStarted(p, now);
+            now += kMove;
+            t.moveDone(now);
+        }
+    }
+    const FocusTimeline::Report r = t.report(now);
+    check(r.points.size() == 4 && r.wallMs == 4 * (kExposure + kAnalysis) + 3 * kMove, "wall time");
+    check(r.savedMs == 0 && r.sequentialMs == r.wallMs, "nothing saved when every analysis is waited for");
+    check(r.moveMs == 3 * kMove && r.points[3].moveMs == 0, "last point has no move");
+}
+
+void testPipelined()
+{
+    std::cout << "[pipelined]" << std::endl;
+    FocusTimeline t;
+    t.reset(0);
+    int64_t now = 0;
+    int prev = -1;
+    for (int i = 0; i < 4; ++i) {
+        const int p = t.addPoint(1000 - i * 100, now);
+        now += kExposure;
+        t.exposureDone(p, now);
+        // 上一点的分析早已在移动中完成，不用等
+        if (prev >= 0)
+            t.addJoinWait(prev, 0);
+        t.analysisSpan(p, now, now + kAnalysis);
+        prev = p;
+        if (i < 3) {
+            t.moveStarted(p, now);
+            now += kMove;
+            t.moveDone(now);
+        }
+    }
+    // 阶段收尾：最后一点的分析要等满
+    t.addJoinWait(prev, kAnalysis);
+    now += kAnalysis;
+
+    const FocusTimeline::Report r = t.report(now);
+    check(r.wallMs == 4 * kExposure + 3 * kMove + kAnalysis, "only the tail analysis is on the wall clock");
+    check(r.savedMs == 3 * kAnalysis && r.sequentialMs == 4 * (kExposure + kAnalysis) + 3 * kMove,
+          "saved = analyses hidden behind moves, sequential estimate matches the serial run");
+    check(r.points[0].savedMs == kAnalysis && r.points[3].savedMs == 0 && r.points[3].joinWaitMs == kAnalysis,
+          "per-point saving");
+    check(r.savedPerPointSec == 3 * kAnalysis / 1000.0 / 4, "seconds saved per point");
+
+    // 分析比移动还慢：只省下移动那一段
+    FocusTimeline slow;
+    slow.reset(0);
+    const int a = slow.addPoint(500, 0);
+    slow.exposureDone(a, 2000);
+    slow.analysisSpan(a, 2000, 7000);
+    slow.moveStarted(a, 2000);
+    slow.moveDone(5000);
+    const int b = slow.addPoint(400, 5000);
+    slow.exposureDone(b, 7000);
+    slow.addJoinWait(a, 0);       // 第二张曝光结束时第一张分析刚好完成
+    slow.analysisSpan(b, 7000, 8000);
+    slow.addJoinWait(b, 1000);
+    const FocusTimeline::Report sr = slow.report(8000);
+    check(sr.points[0].savedMs == 5000 && sr.savedMs == 5000 && sr.sequentialMs == 13000,
+          "analysis overlapped with both the move and the next exposure");
+}
+
+void testEdges()
+{
+    std::cout << "[edges]" << std::endl;
+    FocusTimeline t;
+    check(!t.started() && t.report(100).points.empty() && t.report(100).wallMs == 0, "report before reset is empty");
+    t.reset(1000);
+    t.exposureDone(5, 2000);
+    t.analysisSpan(-1, 0, 10);
+    t.moveDone(3000);             // 没有进行中的移动
+    check(t.size() == 0, "out-of-range indices are ignored");
+    const int p = t.addPoint(10, 1000);
+    t.moveStarted(p, 1500);
+    t.moveDone(1200);             // 时钟倒退按 0 计
+    const FocusTimeline::Report r = t.report(2000);
+    check(r.points[0].moveMs == 0 && r.points[0].exposureMs == 0, "unfinished or backwards spans count as zero");
+    t.addJoinWait(p, 500);
+    check(t.report(2000).points[0].joinWaitMs == 0, "join wait never exceeds the analysis time");
+}
+
+} // namespace
+
+int main()
+{
+    testSequential();
+    testPipelined();
+    testEdges();
+    return test_util::finish();
+}
@@ -0,0 +1,303 @@
+// image_catalog_test.cpp
+// storage::ImageCatalog 自检：首次扫描、重启重放、增量对账（只重读变化的文件）、删除、查询过滤/分页、
+// 缩略图读写、日志尾部损坏恢复、inotify 增量
+//
+// 用法：image_catalog_test [workDir]
+// 默认在 /tmp 下创建临时目录，结束后删除；任一检查失败返回 1
+//
+// 元数据读取用假的 MetaReader（文件内容 "OBJECT|FILTER|EXPTIME|epochMs"），不依赖 cfitsio
+
+#include "../storage/ImageCatalog.h"
+#include "test_util.h"
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+using test_util::check;
+
+namespace {
+
+std::atomic<int> g_reads{0};
+
+bool fakeReader(const std::string& path, storage::ImageMeta* meta)
+{
+    ++g_reads;
+    std::ifstream in(path);
+    std::string line;
+    if (!std::getline(in, line))
+        return false;
+    std::stringstream ss(line);
+    std::string exp, ms;
+    std::getline(ss, meta->object, '|');
+    std::getline(ss, meta->filter, '|');
+    std::getline(ss, exp, '|');
+    std::getline(ss, ms, '|');
+    if (exp.empty() || ms.empty())
+        return false;
+    meta->exposureSec = std::stod(exp);
+    meta->captureTimeMs = std::stoll(ms);
+    meta->imageType = "Light";
+    return true;
+}
+
+void writeImage(const std::string& path, const std::string& object, const std::string& filter, double exp, long long ms)
+{
+    fs::create_directories(fs::path(path).parent_path());
+    std::ofstream out(path);
+    out << object << "|" << filter << "|" << exp << "|" << ms << "\n";
+}
+
+std::vector<std::string> categories()
+{
+    return {"CaptureImage", "ScheduleImage"};
+}
+
+bool waitFor(const std::function<bool()>& pred, int timeoutMs)
+{
+    const auto until = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+    while (std::chrono::steady_clock::now() < until) {
+        if (pred())
+            return true;
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+    return pred();
+}
+
+void testScanAndReload(const std::string& root, const std::string& index)
+{
+    std::cout << "[scan/reload]" << std::endl;
+    for (int i = 0; i < 20; ++i)
+        writeImage(root + "/CaptureImage/2025-01-0" + std::to_string(1 + i % 3) + "/img_" + std::to_string(i) + ".fits",
+                   i % 2 ? "M31" : "NGC 7000", i % 4 < 2 ? "Ha" : "OIII", 30.0 + i, 1700000000000LL + i * 1000);
+    for (int i = 0; i < 5; ++i)
+        writeImage(root + "/ScheduleImage/2025-01-02 21h (M42)/m42_" + std::to_string(i) + ".fits", "M42", "L", 120.0,
+                   1700001000000LL + i * 1000);
+    writeImage(root + "/CaptureImage/2025-01-01/.hidden.fits", "X", "L", 1, 1);
+    writeImage(root + "/CaptureImage/2025-01-01/partial.fits.part", "X", "L", 1, 1);
+
+    {
+        storage::ImageCatalog cat(root, categories(), index, fakeReader);
+        std::string err;
+        check(cat.open(&err), "open empty index " + err);
+        g_reads = 0;
+        const size_t changes = cat.reconcile();
+        check(cat.size() == 25 && changes == 25, "initial scan finds 25 images (" + std::to_string(cat.size()) + ")");
+        check(g_reads.load() == 25, "each image read once");
+
+        const auto folders = cat.folders("CaptureImage");
+        size_t files = 0;
+        for (const auto& f : folders)
+            files += f.files;
+        check(folders.size() == 3 && files == 20, "three capture folders with 20 files");
+
+        std::vector<unsigned char> thumb(3000);
+        for (size_t i = 0; i < thumb.size(); ++i)
+            thumb[i] = static_cast<unsigned char>(i * 7);
+        cat.recordFile(root + "/CaptureImage/2025-01-01/img_0.fits", &thumb);
+        std::vector<unsigned char> back;
+        check(cat.readThumbnail("CaptureImage/2025-01-01/img_0.fits", &back) && back == thumb, "thumbnail round trip");
+    }
+
+    storage::ImageCatalog cat(root, categories(), index, fakeReader);
+    check(cat.open(), "reopen index");
+    check(cat.size() == 25, "replayed 25 entries");
+    g_reads = 0;
+    check(cat.reconcile() == 0 && g_reads.load() == 0, "unchanged tree: no rescans, no header reads");
+    std::vector<unsigned char> back;
+    check(cat.readThumbnail("CaptureImage/2025-01-01/img_0.fits", &back) && back.size() == 3000, "thumbnail survives reload");
+}
+
+void testIncremental(const std::string& root, const std::string& index)
+{
+    std::cout << "[incremental]" << std::endl;
+    storage::ImageCatalog cat(root, categories(), index, fakeReader);
+    cat.open();
+
+    // 目录 mtime 分辨率可能较粗：等一下再改，保证变化能被看到
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    writeImage(root + "/CaptureImage/2025-01-01/new_a.fits", "M101", "L", 60, 1700002000000LL);
+    fs::remove(root + "/CaptureImage/2025-01-02/img_1.fits");
+    fs::remove_all(root + "/ScheduleImage/2025-01-02 21h (M42)");
+
+    g_reads = 0;
+    const size_t changes = cat.reconcile();
+    check(changes == 1 + 1 + 5, "add + delete + removed folder (" + std::to_string(changes) + " changes)");
+    check(g_reads.load() == 1, "only the new file is read (" + std::to_string(g_reads.load()) + ")");
+    check(cat.size() == 20, "20 entries after changes");
+    check(cat.folders("ScheduleImage").empty(), "removed schedule folder forgotten");
+
+    storage::CatalogEntry e;
+    check(cat.find("CaptureImage/2025-01-01/new_a.fits", &e) && e.meta.object == "M101" && e.meta.exposureSec == 60,
+          "new entry metadata");
+
+    cat.removePath(root + "/CaptureImage/2025-01-01/new_a.fits");
+    check(!cat.find("CaptureImage/2025-01-01/new_a.fits", nullptr), "removePath drops entry");
+    fs::remove(root + "/CaptureImage/2025-01-01/new_a.fits");
+
+    // 空日期目录（刚建好还没拍、或文件全被删掉）也要出现在文件夹列表里，GetAllFile 与直接列目录一致
+    fs::create_directories(root + "/CaptureImage/2025-01-05");
+    cat.reconcile();
+    auto hasEmptyFolder = [&](const storage::ImageCatalog& c) {
+        for (const auto& f : c.folders("CaptureImage"))
+            if (f.name == "2025-01-05")
+                return f.files == 0;
+        return false;
+    };
+    check(hasEmptyFolder(cat), "empty date folder listed");
+    {
+        storage::ImageCatalog reopened(root, categories(), index, fakeReader);
+        reopened.open();
+        check(hasEmptyFolder(reopened), "empty date folder survives reload");
+    }
+    fs::remove(root + "/CaptureImage/2025-01-05");
+    cat.reconcile();
+    check(cat.folders("CaptureImage").size() == 3, "removed empty folder forgotten");
+}
+
+void testQuery(const std::string& root, const std::string& index)
+{
+    std::cout << "[query]" << std::endl;
+    storage::ImageCatalog cat(root, categories(), index, fakeReader);
+    cat.open();
+    cat.reconcile();
+
+    storage::CatalogQuery q;
+    q.category = "CaptureImage";
+    q.limit = 5;
+    auto page = cat.query(q);
+    bool sorted = true;
+    for (size_t i = 1; i < page.entries.size(); ++i)
+        sorted = sorted && page.entries[i - 1].meta.captureTimeMs >= page.entries[i].meta.captureTimeMs;
+    check(page.total == 19 && page.entries.size() == 5 && sorted, "first page newest first");
+
+    q.offset = 15;
+    page = cat.query(q);
+    check(page.entries.size() == 4, "last page partial");
+
+    storage::CatalogQuery f;
+    f.object = "m3";
+    f.filter = "ha";
+    page = cat.query(f);
+    bool match = !page.entries.empty();
+    for (const auto& e : page.entries)
+        match = match && e.meta.object == "M31" && e.meta.filter == "Ha";
+    check(match, "object substring + filter, case-insensitive (" + std::to_string(page.total) + ")");
+
+    storage::CatalogQuery x;
+    x.minExposureSec = 40;
+    x.maxExposureSec = 45;
+    x.folder = "2025-01-02";
+    page = cat.query(x);
+    match = true;
+    for (const auto& e : page.entries)
+        match = match && e.meta.exposureSec >= 40 && e.meta.exposureSec <= 45 && e.folder == "2025-01-02";
+    check(match && page.total > 0, "exposure range within folder");
+}
+
+void testTornTail(const std::string& root, const std::string& index)
+{
+    std::cout << "[torn tail]" << std::endl;
+    const auto before = fs::file_size(index);
+    {
+        std::ofstream out(index, std::ios::binary | std::ios::app);
+        const char junk[] = "\x40\x00\x00\x00\x01garbage-record";
+        out.write(junk, sizeof(junk) - 1);
+    }
+    storage::ImageCatalog cat(root, categories(), index, fakeReader);
+    check(cat.open(), "open with torn tail");
+    check(fs::file_size(index) == before, "torn tail truncated");
+    check(cat.size() == 19, "entries intact");
+
+    // 日志被整个破坏：当作空索引重建
+    {
+        std::ofstream out(index, std::ios::binary | std::ios::trunc);
+        out << "not a catalog";
+    }
+    storage::ImageCatalog fresh(root, categories(), index, fakeReader);
+    check(fresh.open() && fresh.size() == 0, "unknown file reset");
+    fresh.reconcile();
+    check(fresh.size() == 19, "rebuilt from disk");
+}
+
+void testWatch(const std::string& root, const std::string& index)
+{
+    std::cout << "[inotify]" << std::endl;
+    storage::ImageCatalog cat(root, categories(), index, fakeReader);
+    cat.open();
+    check(cat.startWatching(50), "watcher started");
+    check(waitFor([&] { return cat.ready(); }, 5000), "ready after initial reconcile");
+
+    writeImage(root + "/CaptureImage/2025-01-03/live.fits", "M33", "L", 10, 1700003000000LL);
+    check(waitFor([&] { return cat.find("CaptureImage/2025-01-03/live.fits", nullptr); }, 5000), "new file picked up");
+
+    writeImage(root + "/CaptureImage/2025-02-01/first.fits", "M81", "L", 10, 1700004000000LL);
+    check(waitFor([&] { return cat.find("CaptureImage/2025-02-01/first.fits", nullptr); }, 5000), "file in new folder picked up");
+
+    fs::create_directories(root + "/ScheduleImage/2025-02-01 22h (M51)");
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    writeImage(root + "/ScheduleImage/2025-02-01 22h (M51)/m51.fits", "M51", "L", 300, 1700005000000LL);
+    check(waitFor([&] { return cat.find("ScheduleImage/2025-02-01 22h (M51)/m51.fits", nullptr); }, 5000),
+          "new schedule folder picked up");
+
+    fs::remove(root + "/CaptureImage/2025-01-03/live.fits");
+    check(waitFor([&] { return !cat.find("CaptureImage/2025-01-03/live.fits", nullptr); }, 5000), "deletion picked up");
+
+    fs::create_directories(root + "/CaptureImage/2025-03-01");
+    check(waitFor([&] {
+              for (const auto& f : cat.folders("CaptureImage"))
+                  if (f.name == "2025-03-01")
+                      return f.files == 0;
+              return false;
+          }, 5000),
+          "new empty folder picked up");
+
+    fs::remove_all(root + "/CaptureImage/2025-02-01");
+    fs::remove(root + "/CaptureImage/2025-03-01");
+    check(waitFor([&] { return cat.folders("CaptureImage").size() == 3; }, 5000), "folder deletion picked up");
+    cat.stop();
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    std::string dir;
+    std::unique_ptr<test_util::TempDir> tmp;  // 未指定 workDir 时用临时目录，退出时删除
+    if (argc > 1) {
+        dir = argv[1];
+        fs::create_directories(dir);
+    } else {
+        tmp = std::make_unique<test_util::TempDir>("image_catalog_test");
+        if (!tmp->ok()) {
+            std::perror("mkdtemp");
+            return 2;
+        }
+        dir = tmp->path();
+    }
+    const std::string root = dir + "/QUARCS_ImageSave";
+    const std::string index = root + "/.quarcs_catalog.idx";
+
+    const auto t0 = std::chrono::steady_clock::now();
+    testScanAndReload(root, index);
+    testIncremental(root, index);
+    testQuery(root, index);
+    testTornTail(root, index);
+    testWatch(root, index);
+    const double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    return test_util::finish(std::to_string(sec) + " s");
+}
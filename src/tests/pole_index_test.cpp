@@ -0,0 +1,177 @@
+// pole_index_test.cpp
+// solver::PoleIndex 自检：合成极冠星表建索引、存盘/读回一致、北/南天极与镜像画面的解算精度与耗时、
+// 像素尺度未知时也能解、极冠外或无关星场必须拒绝（不能给出错误解）
+//
+// 用法：pole_index_test
+// 任一检查失败返回 1
+
+#include "../solver/PoleIndex.h"
+#include "test_util.h"
+
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+
+using test_util::check;
+
+namespace {
+
+// 两个极冠内均匀撒星，星等分布 N(<m) ∝ 10^(0.5m)，最暗 11 等（索引只收 9 等以内）
+std::vector<solver::SkyStar> makeCaps(double capDeg, int brightPerCap, uint32_t seed)
+{
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> u(0.0, 1.0);
+    const double zMin = std::cos(capDeg * M_PI / 180.0);
+    const int perCap = brightPerCap * 10;
+    std::vector<solver::SkyStar> stars;
+    for (int sign : {1, -1}) {
+        for (int i = 0; i < perCap; ++i) {
+            const double z = zMin + (1.0 - zMin) * u(rng);
+            const double dec = std::asin(z) * 180.0 / M_PI * sign;
+            const double mag = std::max(1.0, 11.0 + 2.0 * std::log10(std::max(1e-9, u(rng))));
+            stars.push_back({360.0 * u(rng), dec, mag});
+        }
+    }
+    return stars;
+}
+
+// 按真实 WCS 生成检测星表：11 等以内可见、0 基坐标、位置噪声、漏检、假星
+solver::XyList observe(const std::vector<solver::SkyStar>& sky, const solver::TanWcs& truth, uint32_t seed)
+{
+    std::mt19937 rng(seed);
+    std::normal_distribution<double> noise(0.0, 0.3);
+    std::uniform_real_distribution<double> m(0.0, 1.0);
+    std::vector<solver::XyStar> stars;
+    for (const auto& s : sky) {
+        double x = 0, y = 0;
+        if (!truth.skyToPixel(s.raDeg, s.decDeg, &x, &y))
+            continue;
+        if (x < 0.5 || y < 0.5 || x > truth.imageWidth + 0.5 || y > truth.imageHeight + 0.5 || m(rng) < 0.15)
+            continue;
+        stars.push_back({x - 1.0 + noise(rng), y - 1.0 + noise(rng), std::pow(10.0, -0.4 * (s.mag - 12.0))});
+    }
+    for (int i = 0; i < 15; ++i)
+        stars.push_back({m(rng) * truth.imageWidth, m(rng) * truth.imageHeight, m(rng) * 20.0});
+    return solver::prepareXyList(stars, truth.imageWidth, truth.imageHeight, 200);
+}
+
+// 天极在真实与解算 WCS 下的像素差
+double poleErrorPx(const solver::TanWcs& truth, const solver::TanWcs& solved, int hemisphere)
+{
+    const double poleDec = hemisphere > 0 ? 90.0 : -90.0;
+    double tx = 0, ty = 0, sx = 0, sy = 0;
+    if (!truth.skyToPixel(0.0, poleDec, &tx, &ty) || !solved.skyToPixel(0.0, poleDec, &sx, &sy))
+        return 1e9;
+    return std::hypot(tx - sx, ty - sy);
+}
+
+void testBuildAndRoundTrip(const std::vector<solver::SkyStar>& sky, solver::PoleIndex& index)
+{
+    std::cout << "[build / save / load]" << std::endl;
+    const auto t0 = std::chrono::steady_clock::now();
+    const bool built = index.build(sky);
+    const double buildMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    check(built && index.starCount() > 1000, "built: " + std::to_string(index.starCount()) + " stars, " +
+                                                 std::to_string(index.triangleCount()) + " triangles in " +
+                                                 std::to_string(buildMs) + " ms");
+    check(index.bytes() < 1024 * 1024, "index size " + std::to_string(index.bytes() / 1024) + " KiB");
+
+    const test_util::TempDir tmp("pole_index_test");
+    const std::string path = tmp.file("pole_index.bin");
+    std::string error;
+    check(index.save(path, &error), "saved " + error);
+    solver::PoleIndex loaded;
+    check(loaded.load(path, &error), "loaded " + error);
+    check(loaded.starCount() == index.starCount() && loaded.triangleCount() == index.triangleCount(),
+          "round trip keeps stars and triangles");
+
+    const auto truth = solver::TanWcs::fromSolution(40.0, 87.5, 30.0, 32.0, false, 1280, 960);
+    const auto xy = observe(sky, truth, 1);
+    const auto a = index.solve(xy);
+    const auto b = loaded.solve(xy);
+    check(a.ok && b.ok && std::fabs(a.wcs.crval[0] - b.wcs.crval[0]) < 1e-9 &&
+              std::fabs(a.wcs.crval[1] - b.wcs.crval[1]) < 1e-9 && a.hypotheses == b.hypotheses,
+          "loaded index solves identically");
+
+    {
+        std::ofstream junk(path, std::ios::binary | std::ios::trunc);
+        junk << "not an index";
+    }
+    const bool rejected = !loaded.load(path, &error);
+    check(rejected, "garbage file rejected (" + error + ")");
+}
+
+void testSolve(const solver::PoleIndex& index, const std::vector<solver::SkyStar>& sky, const char* label,
+               double ra, double dec, double orientationDeg, double scaleArcsec, bool mirrored,
+               double fieldLow, double fieldHigh, int hemisphere)
+{
+    std::cout << "[" << label << "]" << std::endl;
+    const int w = 1280, h = 960;
+    double maxPoleErr = 0.0, maxMs = 0.0;
+    bool allOk = true;
+    for (int trial = 0; trial < 5; ++trial) {
+        const auto truth = solver::TanWcs::fromSolution(ra + 47.0 * trial, dec - 0.4 * trial, orientationDeg + 61.0 * trial,
+                                                        scaleArcsec, mirrored, w, h);
+        solver::PoleSolveOptions opts;
+        opts.fieldLowDeg = fieldLow;
+        opts.fieldHighDeg = fieldHigh;
+        opts.hemisphere = hemisphere;
+        const auto r = index.solve(observe(sky, truth, 10 + trial), opts);
+        if (!r.ok) {
+            check(false, "trial " + std::to_string(trial) + ": " + r.error);
+            allOk = false;
+            continue;
+        }
+        maxPoleErr = std::max(maxPoleErr, poleErrorPx(truth, r.wcs, dec > 0 ? 1 : -1));
+        maxMs = std::max(maxMs, r.elapsedMs);
+        if (r.wcs.mirrored() != mirrored || r.hemisphere != (dec > 0 ? 1 : -1)) {
+            check(false, "trial " + std::to_string(trial) + ": parity/hemisphere wrong");
+            allOk = false;
+        }
+    }
+    if (allOk) {
+        check(maxPoleErr < 0.5, "pole pixel error " + std::to_string(maxPoleErr) + " px");
+        check(maxMs < 250.0, "per-solve " + std::to_string(maxMs) + " ms");
+    }
+}
+
+void testReject(const solver::PoleIndex& index)
+{
+    std::cout << "[reject]" << std::endl;
+    // 极冠外（赤纬 50°）与随机星点：都必须失败，交给 solve-field
+    std::vector<solver::SkyStar> far;
+    std::mt19937 rng(5);
+    std::uniform_real_distribution<double> u(0.0, 1.0);
+    for (int i = 0; i < 4000; ++i)
+        far.push_back({150.0 + 20.0 * (u(rng) - 0.5), 50.0 + 15.0 * (u(rng) - 0.5),
+                       std::max(1.0, 11.0 + 2.0 * std::log10(std::max(1e-9, u(rng))))});
+    const auto farTruth = solver::TanWcs::fromSolution(150.0, 50.0, 0.0, 32.0, false, 1280, 960);
+    const auto r = index.solve(observe(far, farTruth, 3));
+    check(!r.ok, "field outside the polar caps rejected (" + r.error + ")");
+
+    solver::XyList noise;
+    noise.imageWidth = 1280;
+    noise.imageHeight = 960;
+    for (int i = 0; i < 80; ++i)
+        noise.stars.push_back({u(rng) * 1279.0, u(rng) * 959.0, 100.0 - i});
+    const auto n = index.solve(noise);
+    check(!n.ok, "random star field rejected (" + n.error + ")");
+}
+
+} // namespace
+
+int main()
+{
+    const auto sky = makeCaps(16.0, 1500, 7);
+    solver::PoleIndex index;
+    testBuildAndRoundTrip(sky, index);
+    testSolve(index, sky, "north polemaster 32\"/px", 10.0, 88.5, 20.0, 32.0, false, 10.0, 12.0, 1);
+    testSolve(index, sky, "south mirrored 32\"/px", 200.0, -87.0, -40.0, 32.0, true, 10.0, 12.0, -1);
+    testSolve(index, sky, "north main scope 12\"/px", 300.0, 86.0, 75.0, 12.0, false, 3.5, 5.0, 1);
+    testSolve(index, sky, "scale and hemisphere unknown", 120.0, -88.0, 5.0, 32.0, false, 0.0, 0.0, 0);
+    testReject(index);
+    return test_util::finish();
+}
@@ -0,0 +1,355 @@
+// pole_motion_tracker_test.cpp
+// polar::estimateRigidRansac / PoleMotionTracker 自检：刚体拟合与逆变换、含离群点的 RANSAC 精度与内点划分、
+// 无关点集拒绝、固定种子可复现；多星跟踪下天极位置相对锚定帧无累积漂移、出画星被补足、
+// 跟踪崩溃时请求板解且保留上一次极点、稳态 update 不分配内存，以及每帧耗时
+//
+// 用法：pole_motion_tracker_test
+// 任一检查失败返回 1
+
+#include "../polar/PoleMotionTracker.h"
+#include "test_util.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace polar;
+
+// 统计堆分配次数，用于检查稳态 update 不分配
+static std::atomic<long> g_allocations{0};
+
+void* operator new(std::size_t size)
+{
+    ++g_allocations;
+    if (void* p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+using test_util::check;
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+constexpr int kWidth = 1280;
+constexpr int kHeight = 960;
+
+double dist(const Point2& a, const Point2& b)
+{
+    return std::hypot(a.x - b.x, a.y - b.y);
+}
+
+RigidMotion motionDeg(double deg, double tx, double ty)
+{
+    RigidMotion m;
+    m.angleRad = deg * kPi / 180.0;
+    m.tx = tx;
+    m.ty = ty;
+    return m;
+}
+
+// 绕 center 旋转 deg 再平移 (tx, ty)
+RigidMotion aboutPoint(const Point2& center, double deg, double tx, double ty)
+{
+    RigidMotion m = motionDeg(deg, 0.0, 0.0);
+    const Point2 rc = m.apply(center);
+    m.tx = center.x - rc.x + tx;
+    m.ty = center.y - rc.y + ty;
+    return m;
+}
+
+std::vector<Point2> randomField(size_t n, unsigned seed, double margin = 20.0)
+{
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> ux(margin, kWidth - margin);
+    std::uniform_real_distribution<double> uy(margin, kHeight - margin);
+    std::vector<Point2> pts;
+    while (pts.size() < n) {
+        const Point2 p{ux(rng), uy(rng)};
+        bool ok = true;
+        for (const Point2& q : pts)
+            ok = ok && dist(p, q) > 20.0;
+        if (ok)
+            pts.push_back(p);
+    }
+    return pts;
+}
+
+void testRigid()
+{
+    std::cout << "rigid" << std::endl;
+    const std::vector<Point2> src = randomField(20, 1);
+    const RigidMotion truth = motionDeg(3.7, -41.5, 18.25);
+    std::vector<Point2> dst;
+    for (const Point2& p : src)
+        dst.push_back(truth.apply(p));
+
+    RigidMotion fit;
+    check(fitRigid(src, dst, nullptr, fit), "fitRigid succeeds on exact data");
+    check(std::fabs(fit.rotationDeg() - 3.7) < 1e-9 && std::fabs(fit.tx + 41.5) < 1e-7 && std::fabs(fit.ty - 18.25) < 1e-7,
+          "fitRigid recovers rotation and translation exactly");
+
+    const RigidMotion inv = truth.inverse();
+    double maxErr = 0.0;
+    for (const Point2& p : src)
+        maxErr = std::max(maxErr, dist(inv.apply(truth.apply(p)), p));
+    check(maxErr < 1e-9, "inverse() undoes the motion");
+
+    std::vector<uint8_t> one(src.size(), 0);
+    one[3] = 1;
+    check(!fitRigid(src, dst, &one, fit), "fitRigid rejects fewer than 2 points");
+}
+
+void testRansac()
+{
+    std::cout << "ransac" << std::endl;
+    const size_t n = 30;
+    const std::vector<Point2> src = randomField(n, 2);
+    const RigidMotion truth = aboutPoint({640.0, 480.0}, -1.8, 12.0, -7.5);
+    std::mt19937 rng(3);
+    std::normal_distribution<double> noise(0.0, 0.2);
+    std::uniform_real_distribution<double> far(-200.0, 200.0);
+    std::vector<Point2> dst;
+    std::vector<bool> outlier(n, false);
+    for (size_t i = 0; i < n; ++i) {
+        Point2 p = truth.apply(src[i]);
+        if (i % 3 == 1) {   // 1/3 离群（错配到别的星）
+            p.x += 20.0 + std::fabs(far(rng));
+            p.y += far(rng);
+            outlier[i] = true;
+        } else {
+            p.x += noise(rng);
+            p.y += noise(rng);
+        }
+        dst.push_back(p);
+    }
+
+    RigidRansacOptions opt;
+    RigidRansacResult r;
+    check(estimateRigidRansac(src, dst, opt, r), "RANSAC succeeds with 1/3 outliers");
+    check(std::fabs(r.motion.rotationDeg() + 1.8) < 0.02, "rotation within 0.02 deg (" + std::to_string(r.motion.rotationDeg()) + ")");
+    const Point2 probe{100.0, 900.0};
+    check(dist(r.motion.apply(probe), truth.apply(probe)) < 0.3,
+          "far-field point within 0.3 px (" + std::to_string(dist(r.motion.apply(probe), truth.apply(probe))) + ")");
+    size_t wrong = 0;
+    for (size_t i = 0; i < n; ++i)
+        wrong += (r.inlierMask[i] != 0) == outlier[i] ? 1 : 0;
+    check(wrong == 0, "inlier mask marks exactly the outliers");
+    check(r.inliers == 20 && r.rmsPx < 0.5, "inliers=20, rms " + std::to_string(r.rmsPx) + " px");
+    check(r.iterations < opt.maxIterations, "adaptive stop after " + std::to_string(r.iterations) + " iterations");
+
+    RigidRansacResult again;
+    estimateRigidRansac(src, dst, opt, again);
+    check(again.motion.angleRad == r.motion.angleRad && again.motion.tx == r.motion.tx, "same seed gives identical result");
+
+    // 无关点集：不应给出刚体解
+    const std::vector<Point2> unrelated = randomField(n, 99);
+    RigidRansacResult bad;
+    check(!estimateRigidRansac(src, unrelated, opt, bad), "unrelated point sets are rejected");
+
+    // 超过允许旋转的运动被拒绝
+    std::vector<Point2> spun;
+    const RigidMotion big = aboutPoint({640.0, 480.0}, 45.0, 0.0, 0.0);
+    for (const Point2& p : src)
+        spun.push_back(big.apply(p));
+    check(!estimateRigidRansac(src, spun, opt, bad), "rotation beyond maxRotationDeg is rejected");
+}
+
+// 模拟调极轴：天区以 poleTruth 为参考按 motion(t) 平移/旋转；光流输出 = 真值 + 噪声（少数失败），识星 = 真值 + 小噪声
+struct Scene {
+    std::vector<Point2> sky;     // 锚定帧中的全部星
+    Point2 pole{700.0, 420.0};
+    std::mt19937 rng{7};
+
+    RigidMotion motionAt(int frame) const
+    {
+        // 先向右下平移约 150px 并慢慢旋转 2°，模拟方位/高度调整
+        const double t = frame / 60.0;
+        return aboutPoint({640.0, 480.0}, 2.0 * t, 150.0 * t, 90.0 * t);
+    }
+
+    std::vector<Point2> candidates(int frame, double sigma)
+    {
+        std::normal_distribution<double> n(0.0, sigma);
+        const RigidMotion m = motionAt(frame);
+        std::vector<Point2> out;
+        for (const Point2& s : sky) {
+            Point2 p = m.apply(s);
+            if (p.x < 0 || p.y < 0 || p.x >= kWidth || p.y >= kHeight)
+                continue;
+            p.x += n(rng);
+            p.y += n(rng);
+            out.push_back(p);
+        }
+        return out;
+    }
+
+    void flow(int frame, const std::vector<Point2>& prev, std::vector<Point2>& out, std::vector<uint8_t>& status, double sigma)
+    {
+        // 光流：把上一帧位置按真实帧间运动推过去并加噪声，约 5% 失败
+        const RigidMotion step = [&] {
+            const RigidMotion a = motionAt(frame - 1).inverse();
+            const RigidMotion b = motionAt(frame);
+            RigidMotion c;
+            c.angleRad = b.angleRad + a.angleRad;
+            const Point2 o = b.apply(a.apply({0.0, 0.0}));
+            c.tx = o.x;
+            c.ty = o.y;
+            return c;
+        }();
+        std::normal_distribution<double> n(0.0, sigma);
+        std::uniform_real_distribution<double> u(0.0, 1.0);
+        out.resize(prev.size());
+        status.resize(prev.size());
+        for (size_t i = 0; i < prev.size(); ++i) {
+            out[i] = step.apply(prev[i]);
+            out[i].x += n(rng);
+            out[i].y += n(rng);
+            status[i] = u(rng) > 0.05 ? 1 : 0;
+        }
+    }
+};
+
+void testTracker()
+{
+    std::cout << "tracker" << std::endl;
+    Scene scene;
+    scene.sky = randomField(80, 11);
+
+    PoleTrackOptions opt;
+    opt.imageWidth = kWidth;
+    opt.imageHeight = kHeight;
+    opt.maxStars = 30;
+    PoleMotionTracker tracker(opt);
+
+    std::vector<Point2> initial = scene.candidates(0, 0.05);
+    check(tracker.anchor(initial, scene.pole, initial.front()), "anchor on solved frame");
+    check(tracker.trackPoints().size() == 30, "anchor keeps maxStars spread stars");
+
+    std::vector<Point2> tracked;
+    std::vector<uint8_t> status;
+    double maxPoleErr = 0.0;
+    double minConfidence = 1.0;
+    bool anySolveRequest = false;
+    size_t minTracked = 1000;
+    const int frames = 60;
+    for (int f = 1; f <= frames; ++f) {
+        const std::vector<Point2> cands = scene.candidates(f, 0.05);
+        scene.flow(f, tracker.trackPoints(), tracked, status, 0.3);
+        const PoleTrackResult& r = tracker.update(tracked, status, cands);
+        const Point2 truePole = scene.motionAt(f).apply(scene.pole);
+        if (r.ok)
+            maxPoleErr = std::max(maxPoleErr, dist(r.polePx, truePole));
+        minConfidence = std::min(minConfidence, r.confidence);
+        anySolveRequest = anySolveRequest || r.solveRequested;
+        minTracked = std::min(minTracked, r.tracked);
+    }
+    const PoleTrackResult& last = tracker.last();
+    const Point2 finalTruth = scene.motionAt(frames).apply(scene.pole);
+    check(last.ok && std::fabs(last.motion.rotationDeg() - 2.0) < 0.05,
+          "rotation relative to anchor " + std::to_string(last.motion.rotationDeg()) + " deg (truth 2)");
+    check(maxPoleErr < 0.5, "pole within 0.5 px over 60 frames, 180 px travel (max " + std::to_string(maxPoleErr) + ")");
+    check(dist(last.polePx, finalTruth) < 0.3, "no accumulated drift at end (" + std::to_string(dist(last.polePx, finalTruth)) + " px)");
+    check(minTracked >= 20, "stars leaving the field are replenished (min tracked " + std::to_string(minTracked) + ")");
+    check(minConfidence > opt.minConfidence && !anySolveRequest,
+          "confidence stays high (min " + std::to_string(minConfidence) + "), no solve requested");
+
+    // 跟踪崩溃（光流输出全是垃圾）：保留上一次极点，连续 lowConfidenceFrames 帧后请求板解
+    const Point2 poleBefore = last.polePx;
+    std::mt19937 rng(5);
+    std::uniform_real_distribution<double> ux(20.0, kWidth - 20.0);
+    std::uniform_real_distribution<double> uy(20.0, kHeight - 20.0);
+    bool requested = false;
+    bool firstRequested = true;
+    for (int k = 0; k < opt.lowConfidenceFrames; ++k) {
+        std::vector<Point2> junk(tracker.trackPoints().size());
+        for (Point2& p : junk)
+            p = {ux(rng), uy(rng)};
+        std::vector<uint8_t> allOk(junk.size(), 1);
+        const PoleTrackResult& r = tracker.update(junk, allOk, {});
+        if (k == 0)
+            firstRequested = r.solveRequested;
+        requested = r.solveRequested;
+        check(!r.ok && dist(r.polePx, poleBefore) < 1e-9, "garbage frame " + std::to_string(k + 1) + ": not ok, pole kept");
+    }
+    check(!firstRequested && requested, "solve requested after " + std::to_string(opt.lowConfidenceFrames) + " bad frames");
+
+    // 板解后重新锚定，恢复正常
+    const std::vector<Point2> solved = scene.candidates(frames, 0.05);
+    check(tracker.anchor(solved, finalTruth, solved.front()) && !tracker.last().solveRequested &&
+              tracker.lowConfidenceStreak() == 0,
+          "re-anchor clears the solve request");
+
+    // 稳态 update 不分配
+    Scene still;
+    still.sky = scene.sky;
+    PoleMotionTracker steady(opt);
+    std::vector<Point2> c0 = still.candidates(0, 0.05);
+    steady.anchor(c0, still.pole, c0.front());
+    std::vector<Point2> cands = still.candidates(1, 0.05);
+    still.flow(1, steady.trackPoints(), tracked, status, 0.3);
+    steady.update(tracked, status, cands);
+    tracked.reserve(64);
+    status.reserve(64);
+    long allocs = 0;
+    for (int f = 2; f < 20; ++f) {
+        cands.clear();
+        for (const Point2& p : still.candidates(f, 0.05))   // 构造输入不计入
+            cands.push_back(p);
+        still.flow(f, steady.trackPoints(), tracked, status, 0.3);
+        const long before = g_allocations.load();
+        steady.update(tracked, status, cands);
+        allocs += g_allocations.load() - before;
+    }
+    check(allocs == 0, "steady-state update performs no heap allocation (" + std::to_string(allocs) + ")");
+}
+
+void bench()
+{
+    std::cout << "bench" << std::endl;
+    Scene scene;
+    scene.sky = randomField(120, 21);
+    PoleTrackOptions opt;
+    opt.imageWidth = kWidth;
+    opt.imageHeight = kHeight;
+    PoleMotionTracker tracker(opt);
+    std::vector<Point2> c0 = scene.candidates(0, 0.05);
+    tracker.anchor(c0, scene.pole, c0.front());
+
+    std::vector<Point2> tracked;
+    std::vector<uint8_t> status;
+    const int frames = 60;
+    std::vector<std::vector<Point2>> cands;
+    for (int f = 1; f <= frames; ++f)
+        cands.push_back(scene.candidates(f, 0.05));
+    double totalUs = 0.0;
+    for (int f = 1; f <= frames; ++f) {
+        scene.flow(f, tracker.trackPoints(), tracked, status, 0.3);
+        const auto t0 = std::chrono::steady_clock::now();
+        tracker.update(tracked, status, cands[f - 1]);
+        totalUs += std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count();
+    }
+    std::cout << "  30 tracked stars, ~100 detections: " << totalUs / frames << " us/frame" << std::endl;
+    check(totalUs / frames < 5000.0, "per-frame update well under a camera frame");
+}
+
+} // namespace
+
+int main()
+{
+    testRigid();
+    testRansac();
+    testTracker();
+    bench();
+    return test_util::finish();
+}
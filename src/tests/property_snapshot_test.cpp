@@ -0,0 +1,103 @@
+// property_snapshot_test.cpp
+// devices::PropertySnapshotStore 自检：槽位分配、值不变不升版本、版本全局单调、reset 作废、
+// 并发写读一致性与单次读取耗时
+//
+// 用法：property_snapshot_test
+// 任一检查失败返回 1
+
+#include "../devices/PropertySnapshot.h"
+#include "test_util.h"
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+
+using namespace devices;
+
+using test_util::check;
+
+namespace {
+
+void testVersions()
+{
+    std::cout << "[versions]" << std::endl;
+    PropertySnapshotStore store;
+    const int mount = store.slotFor("EQMod Mount");
+    const int camera = store.slotFor("QHY CCD");
+    check(mount != camera && store.slotFor("EQMod Mount") == mount, "one slot per device name");
+    check(store.findSlot("nope") == -1, "findSlot does not allocate");
+
+    check(!store.get(mount, &PropertySnapshot::eqCoord).valid(), "unset value is invalid");
+    check(store.set(mount, &PropertySnapshot::eqCoord, EqCoord{5.5, 30.0}), "first set reports change");
+    const uint64_t v1 = store.get(mount, &PropertySnapshot::eqCoord).version;
+    check(!store.set(mount, &PropertySnapshot::eqCoord, EqCoord{5.5, 30.0}), "same value reports no change");
+    check(store.get(mount, &PropertySnapshot::eqCoord).version == v1, "same value keeps version");
+
+    store.set(camera, &PropertySnapshot::ccdTemperature, -10.0);
+    store.set(mount, &PropertySnapshot::eqCoord, EqCoord{5.6, 30.0});
+    const Versioned<EqCoord> coord = store.get(mount, &PropertySnapshot::eqCoord);
+    check(coord.version > v1 + 1 && coord.value.raHours == 5.6, "versions are global and monotonic");
+
+    store.set(mount, &PropertySnapshot::parked, false);
+    check(store.get(mount, &PropertySnapshot::parked).valid() && !store.get(mount, &PropertySnapshot::parked).value,
+          "false is a valid stored value");
+
+    store.reset(mount);
+    check(!store.get(mount, &PropertySnapshot::eqCoord).valid() &&
+              store.get(camera, &PropertySnapshot::ccdTemperature).valid(),
+          "reset clears only that device");
+    store.set(mount, &PropertySnapshot::eqCoord, EqCoord{5.6, 30.0});
+    check(store.get(mount, &PropertySnapshot::eqCoord).version > coord.version, "value after reset gets a new version");
+    check(!store.get(99, &PropertySnapshot::eqCoord).valid(), "out of range slot is invalid");
+}
+
+void testConcurrent()
+{
+    std::cout << "[concurrent]" << std::endl;
+    PropertySnapshotStore store;
+    const int slot = store.slotFor("Mount");
+    std::atomic<bool> done{false};
+    std::atomic<bool> readerReady{false};
+    std::thread writer([&]() {
+        while (!readerReady)
+            std::this_thread::yield();
+        for (int i = 1; i <= 200000; ++i)
+            store.set(slot, &PropertySnapshot::eqCoord, EqCoord{static_cast<double>(i), static_cast<double>(-i)});
+        done = true;
+    });
+
+    bool consistent = true;
+    bool monotonic = true;
+    uint64_t lastVersion = 0;
+    size_t reads = 0;
+    const auto start = std::chrono::steady_clock::now();
+    readerReady = true;
+    while (!done) {
+        const Versioned<EqCoord> coord = store.get(slot, &PropertySnapshot::eqCoord);
+        if (coord.valid() && coord.value.raHours != -coord.value.decDeg)
+            consistent = false;
+        if (coord.version < lastVersion)
+            monotonic = false;
+        lastVersion = coord.version;
+        ++reads;
+    }
+    const double elapsedUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    writer.join();
+
+    check(consistent, "reader never sees a torn RA/DEC pair");
+    check(monotonic, "reader sees non-decreasing versions");
+    const double perReadUs = reads > 0 ? elapsedUs / static_cast<double>(reads) : 0.0;
+    std::cout << "  reads=" << reads << " avg=" << perReadUs << " us" << std::endl;
+    check(reads > 0 && perReadUs < 20.0, "read cost is small");
+}
+
+} // namespace
+
+int main()
+{
+    testVersions();
+    testConcurrent();
+    return test_util::finish();
+}
@@ -0,0 +1,198 @@
+// schedule_planner_test.cpp
+// schedule::buildPlan 自检：星历（GMST/时角/高度/上中天）、时间线（等待/转动/对焦/滤镜/曝光/间隔）、
+// 翻转只排在两帧之间且在过中天之后、无观测站时只排时长、从中间行重排
+//
+// 用法：schedule_planner_test
+// 任一检查失败返回 1
+
+#include "../schedule/SchedulePlanner.h"
+#include "test_util.h"
+
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace schedule;
+
+using test_util::check;
+
+namespace {
+
+constexpr double kJ2000Unix = 946728000.0;   // 2000-01-01 12:00:00 UTC
+
+Site makeSite()
+{
+    Site site;
+    site.latitudeDeg = 40.0;
+    site.longitudeDeg = 116.4;
+    site.valid = true;
+    return site;
+}
+
+// 构造一个在 t0 后 hoursToTransit 小时上中天的目标
+TargetSpec targetTransitingIn(double t0, const Site& site, double hoursToTransit)
+{
+    TargetSpec spec;
+    spec.name = "T";
+    spec.raHours = std::fmod(lstHours(t0, site.longitudeDeg) + hoursToTransit * 1.00273790935 + 24.0, 24.0);
+    spec.decDeg = 30.0;
+    return spec;
+}
+
+size_t countSteps(const TargetPlan& plan, StepKind kind)
+{
+    size_t n = 0;
+    for (const PlanStep& s : plan.steps)
+        n += s.kind == kind ? 1 : 0;
+    return n;
+}
+
+void testEphemeris()
+{
+    std::cout << "[ephemeris]" << std::endl;
+    check(std::fabs(gmstHours(kJ2000Unix) - 18.697374558) < 1e-6, "GMST at J2000.0");
+    check(std::fabs(hourAngleHours(1.0, 23.0) - 2.0) < 1e-9 && std::fabs(hourAngleHours(23.0, 1.0) + 2.0) < 1e-9,
+          "hour angle wraps to [-12, 12)");
+
+    const Site site = makeSite();
+    const double t0 = kJ2000Unix + 86400.0 * 9000;
+    const TargetSpec spec = targetTransitingIn(t0, site, 2.0);
+    const double transit = nextTransitUnix(t0, spec.raHours, site.longitudeDeg);
+    check(std::fabs(transit - t0 - 7200.0) < 1.0, "next transit found 2 h ahead");
+    check(std::fabs(hourAngleHours(lstHours(transit, site.longitudeDeg), spec.raHours)) < 1e-4,
+          "hour angle is zero at transit");
+    check(std::fabs(altitudeDeg(transit, spec.raHours, spec.decDeg, site) - 80.0) < 1e-3,
+          "transit altitude is 90 - |lat - dec|");
+    check(altitudeDeg(transit - 3600, spec.raHours, spec.decDeg, site) < 80.0 &&
+              std::fabs(altitudeDeg(transit - 3600, spec.raHours, spec.decDeg, site) -
+                        altitudeDeg(transit + 3600, spec.raHours, spec.decDeg, site)) < 0.05,
+          "altitude curve is symmetric about transit");
+    const double after = nextTransitUnix(transit + 60, spec.raHours, site.longitudeDeg);
+    check(std::fabs(after - transit - 86164.09) < 2.0, "transit just passed -> next one a sidereal day later");
+}
+
+void testTimeline()
+{
+    std::cout << "[timeline]" << std::endl;
+    PlanOptions options;
+    const double t0 = kJ2000Unix + 86400.0 * 9000;
+
+    std::vector<TargetSpec> targets(3);
+    targets[0].name = "M31";
+    targets[0].notBeforeUnix = t0 + 600;
+    targets[0].exposureMs = 60000;
+    targets[0].repeat = 3;
+    targets[0].exposureDelayMs = 5000;
+    targets[0].filter = 2;
+    targets[0].refocus = true;
+    targets[1].name = "M42";
+    targets[1].exposureMs = 30000;
+    targets[1].repeat = 2;
+    targets[1].filter = 2;
+    targets[2].name = "M45";
+    targets[2].notBeforeUnix = t0 - 3600;   // 已过去的时间约束不等待
+    targets[2].exposureMs = 1000;
+    targets[2].repeat = 1;
+    targets[2].filter = 3;
+
+    const Plan plan = buildPlan(targets, Site(), t0, options);
+    check(plan.targets.size() == 3, "one plan entry per row");
+    const TargetPlan& a = plan.targets[0];
+    check(!a.steps.empty() && a.steps[0].kind == StepKind::Wait && a.steps[0].endUnix == t0 + 600,
+          "waits until the row's start time");
+    check(a.steps[1].kind == StepKind::Slew && a.steps[2].kind == StepKind::Focus && a.steps[3].kind == StepKind::Filter,
+          "slew, refocus, filter in execution order");
+    check(countSteps(a, StepKind::Exposure) == 3 && countSteps(a, StepKind::Delay) == 2,
+          "exposures with delays only between frames");
+    const double expected = 600 + options.slewSec + options.refocusSec + options.filterChangeSec +
+                            3 * (60 + options.downloadSec) + 2 * 5;
+    check(std::fabs(a.durationSec() - expected) < 1e-6, "estimated duration sums the steps");
+    bool contiguous = true;
+    for (size_t i = 1; i < a.steps.size(); ++i)
+        contiguous = contiguous && a.steps[i].startUnix == a.steps[i - 1].endUnix;
+    check(contiguous && a.steps.back().endUnix == a.endUnix, "steps are contiguous");
+
+    check(plan.targets[1].startUnix == a.endUnix && countSteps(plan.targets[1], StepKind::Filter) == 0,
+          "same filter on the next row is not changed again");
+    check(countSteps(plan.targets[2], StepKind::Wait) == 0 && countSteps(plan.targets[2], StepKind::Filter) == 1,
+          "past start time does not wait; new filter is changed");
+    check(plan.endUnix == plan.targets[2].endUnix, "plan end is the last row's end");
+    check(a.altitude.empty() && a.transitUnix == 0 && a.flipBeforeFrame == 0, "no site -> no ephemerides, no flip");
+
+    const Plan tail = buildPlan(targets, Site(), t0, options, 1);
+    check(tail.targets.size() == 2 && tail.targets[0].index == 1 && tail.target(2) != nullptr && tail.target(0) == nullptr,
+          "replanning from a middle row keeps table indices");
+}
+
+void testFlip()
+{
+    std::cout << "[flip]" << std::endl;
+    const Site site = makeSite();
+    PlanOptions options;
+    options.pastMeridianMin = 5;
+    const double t0 = kJ2000Unix + 86400.0 * 9000;
+
+    std::vector<TargetSpec> targets{targetTransitingIn(t0, site, 1.0)};
+    targets[0].exposureMs = 300000;
+    targets[0].repeat = 20;
+    const Plan plan = buildPlan(targets, site, t0, options);
+    const TargetPlan& tp = plan.targets[0];
+
+    check(tp.eastAtStart && std::fabs(tp.transitUnix - t0 - 3600.0) < 1.0, "target rises to the meridian inside the window");
+    check(tp.flipBeforeFrame > 1 && tp.flipBeforeFrame <= 20, "flip is planned between two frames");
+    check(tp.flipUnix >= tp.transitUnix - 1e-6, "flip starts only after the target crossed the meridian");
+    bool framesOk = true;
+    bool flipBetweenFrames = false;
+    for (size_t i = 0; i < tp.steps.size(); ++i) {
+        const PlanStep& s = tp.steps[i];
+        if (s.kind == StepKind::Exposure && s.frame < tp.flipBeforeFrame)
+            framesOk = framesOk && s.endUnix <= tp.transitUnix + options.pastMeridianMin * 60.0;
+        if (s.kind == StepKind::Flip)
+            flipBetweenFrames = i + 1 < tp.steps.size() && tp.steps[i + 1].kind == StepKind::Exposure &&
+                                tp.steps[i + 1].frame == tp.flipBeforeFrame;
+    }
+    check(framesOk, "every frame before the flip ends within the past-meridian limit");
+    check(flipBetweenFrames && countSteps(tp, StepKind::Flip) == 1, "exactly one flip, right before its frame");
+    check(tp.maxAltDeg >= tp.transitAltDeg - 1e-9 && tp.minAltDeg < tp.maxAltDeg && tp.altitude.size() >= 2,
+          "altitude curve covers the transit");
+    check(tp.altitude.front().unix == tp.startUnix && tp.altitude.back().unix == tp.endUnix,
+          "altitude samples span the target window");
+
+    std::cout << "  flip before frame " << tp.flipBeforeFrame << ", "
+              << (tp.flipUnix - tp.transitUnix) << " s after transit" << std::endl;
+
+    check(!flipDueBeforeNextFrame(tp, options, tp.transitUnix - 1000, 300) &&
+              flipDueBeforeNextFrame(tp, options, tp.transitUnix, 400),
+          "live check flips only when the next frame would cross the limit");
+
+    std::vector<TargetSpec> west{targetTransitingIn(t0, site, -1.0)};
+    west[0].exposureMs = 300000;
+    west[0].repeat = 20;
+    const Plan westPlan = buildPlan(west, site, t0, options);
+    check(!westPlan.targets[0].eastAtStart && westPlan.targets[0].flipBeforeFrame == 0,
+          "target already west of the meridian never flips");
+
+    std::vector<TargetSpec> shortRun{targetTransitingIn(t0, site, 3.0)};
+    shortRun[0].exposureMs = 60000;
+    shortRun[0].repeat = 10;
+    const Plan shortPlan = buildPlan(shortRun, site, t0, options);
+    check(shortPlan.targets[0].flipBeforeFrame == 0 && shortPlan.targets[0].transitUnix > shortPlan.targets[0].endUnix,
+          "transit after the window needs no flip");
+
+    std::vector<TargetSpec> low{targetTransitingIn(t0, site, 6.0)};
+    low[0].decDeg = -40.0;
+    options.minAltitudeDeg = 15.0;
+    const Plan lowPlan = buildPlan(low, site, t0, options);
+    check(lowPlan.targets[0].lowAltitude, "target below the altitude limit is flagged");
+}
+
+} // namespace
+
+int main()
+{
+    testEphemeris();
+    testTimeline();
+    testFlip();
+    return test_util::finish();
+}
@@ -0,0 +1,223 @@
+// sdk_frame_payload_bench.cpp
+// SdkResult::frame 类型化通道的分配基准：Live 稳态下每帧的堆分配次数应为 0
+//
+// 用法：sdk_frame_payload_bench [frames] [width] [height]
+// 例如：sdk_frame_payload_bench 2000 3856 2180
+//
+// 说明：
+// - 使用一个假驱动（不依赖相机），其缓冲池行为与 QHYCCD.cpp 的 acquireLiveBuffer 一致（双缓冲 + use_count 判空闲）
+// - 取帧命令预解析后走 SdkManager::call()，调用方 std::move 取出 SdkFrameData，与 MainWindow 的 Live 循环一致
+// - 通过替换全局 operator new 统计分配次数；预热若干帧后开始计数
+// - 稳态每帧分配数 > 0 时返回非 0，便于脚本化回归
+
+#include "../sdks/SdkManager.h"
+#include "../Logger.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+
+static std::atomic<unsigned long long> g_allocCount{0};
+static std::atomic<unsigned long long> g_allocBytes{0};
+
+void* operator new(std::size_t size)
+{
+    g_allocCount.fetch_add(1, std::memory_order_relaxed);
+    g_allocBytes.fetch_add(size, std::memory_order_relaxed);
+    if (size == 0)
+        size = 1;
+    if (void* p = std::malloc(size))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+namespace {
+
+// 假相机驱动：只实现 GetLiveFrame，一帧数据写入池中的空闲 buffer 后经 rawBuffer 零拷贝返回
+class BenchCameraDriver : public ISdkDriver
+{
+public:
+    static constexpr SdkCommandId kGetLiveFrame = 0;
+
+    BenchCameraDriver(int width, int height)
+        : m_width(width), m_height(height)
+    {
+        m_length = static_cast<size_t>(width) * static_cast<size_t>(height) * sizeof(uint16_t);
+    }
+
+    std::vector<std::string> driverNames() const override { return {"BenchCamera"}; }
+
+    std::vector<SdkCommandInfo> commandList() const override
+    {
+        return {{"GetLiveFrame", "读取一帧模拟 Live 图像，SdkFrameData 经 SdkResult::frame 返回"}};
+    }
+
+    SdkResult openDevice(const std::any& /*openParam*/) override
+    {
+        SdkResult r;
+        r.success = true;
+        r.payload = reinterpret_cast<SdkDeviceHandle>(this);
+        return r;
+    }
+
+    SdkResult closeDevice(SdkDeviceHandle /*handle*/) override
+    {
+        SdkResult r;
+        r.success = true;
+        return r;
+    }
+
+    SdkResult execute(SdkDeviceHandle handle, const SdkCommand& cmd) override
+    {
+        return executeById(handle, resolveCommand(cmd.name), cmd);
+    }
+
+    SdkCommandId resolveCommand(const std::string& name) const override
+    {
+        return name == "GetLiveFrame" ? kGetLiveFrame : kSdkInvalidCommandId;
+    }
+
+    unsigned commandFlags(SdkCommandId id) const override
+    {
+        return id == kGetLiveFrame ? SdkCommandFlagQuiet : SdkCommandFlagNone;
+    }
+
+    SdkResult executeById(SdkDeviceHandle /*handle*/, SdkCommandId id, const SdkCommand& /*cmd*/) override
+    {
+        SdkResult r;
+        if (id != kGetLiveFrame) {
+            r.success = false;
+            r.errorCode = SdkErrorCode::NotImplemented;
+            r.message = "Unsupported bench command";
+            return r;
+        }
+
+        auto buffer = acquireBuffer();
+        // 模拟 SDK 写入：只动首尾，避免把 memset 的耗时算进基准
+        (*buffer)[0] = static_cast<unsigned char>(m_seq);
+        (*buffer)[m_length - 1] = static_cast<unsigned char>(m_seq >> 8);
+        ++m_seq;
+
+        SdkFrameData frame;
+        frame.width     = m_width;
+        frame.height    = m_height;
+        frame.bpp       = 16;
+        frame.channels  = 1;
+        frame.rawBuffer = std::move(buffer);
+        frame.rawBytes  = m_length;
+
+        r.success = true;
+        r.frame   = std::move(frame);
+        return r;
+    }
+
+private:
+    // 与 QHYCCD.cpp acquireLiveBuffer 相同的复用策略：找 use_count()==1 的空闲块，池未满才新建
+    std::shared_ptr<std::vector<unsigned char>> acquireBuffer()
+    {
+        static constexpr size_t kMaxPool = 2;
+        for (auto& b : m_pool) {
+            if (b.use_count() == 1)
+                return b;
+        }
+        if (m_pool.size() < kMaxPool) {
+            m_pool.push_back(std::make_shared<std::vector<unsigned char>>(m_length));
+            return m_pool.back();
+        }
+        return m_pool.front();
+    }
+
+    int m_width;
+    int m_height;
+    size_t m_length{0};
+    unsigned m_seq{0};
+    std::vector<std::shared_ptr<std::vector<unsigned char>>> m_pool;
+};
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    const int frames = (argc > 1) ? std::max(1, std::atoi(argv[1])) : 2000;
+    const int width  = (argc > 2) ? std::max(1, std::atoi(argv[2])) : 3856;
+    const int height = (argc > 3) ? std::max(1, std::atoi(argv[3])) : 2180;
+    const int warmup = 16;
+
+    Logger::SetDebugLogging(false);
+
+    SdkManager& mgr = SdkManager::instance();
+    mgr.registerDriver("BenchCamera", std::make_unique<BenchCameraDriver>(width, height));
+
+    SdkResult openRes = mgr.open("BenchCamera", std::any());
+    if (!openRes.success) {
+        std::cerr << "openDevice failed: " << openRes.message << std::endl;
+        return 2;
+    }
+    const SdkDeviceHandle handle = std::any_cast<SdkDeviceHandle>(openRes.payload);
+
+    SdkCommand getCmd{SdkCommandType::Custom, "GetLiveFrame", {}};
+    if (!mgr.resolveCommand("BenchCamera", getCmd)) {
+        std::cerr << "resolveCommand(GetLiveFrame) failed" << std::endl;
+        return 2;
+    }
+    const std::string driverName = "BenchCamera";
+
+    // 消费端：与 MainWindow Live 循环一致，移动取出后只保留到下一帧（模拟 mailbox 覆盖）
+    SdkFrameData latest;
+    size_t checksum = 0;
+    unsigned long long allocsAtStart = 0;
+    unsigned long long bytesAtStart = 0;
+    auto tStart = std::chrono::steady_clock::now();
+
+    for (int i = 0; i < warmup + frames; ++i) {
+        if (i == warmup) {
+            allocsAtStart = g_allocCount.load(std::memory_order_relaxed);
+            bytesAtStart = g_allocBytes.load(std::memory_order_relaxed);
+            tStart = std::chrono::steady_clock::now();
+        }
+
+        latest = SdkFrameData{};
+        SdkResult res = mgr.call(driverName, handle, getCmd);
+        if (!res.success || !res.frame) {
+            std::cerr << "GetLiveFrame failed at frame " << i << ": " << res.message << std::endl;
+            return 2;
+        }
+        latest = std::move(*res.frame);
+        checksum += (*latest.rawBuffer)[0];
+    }
+
+    const auto elapsedUs = std::chrono::duration_cast<std::chrono::microseconds>(
+                               std::chrono::steady_clock::now() - tStart).count();
+    const unsigned long long allocs = g_allocCount.load(std::memory_order_relaxed) - allocsAtStart;
+    const unsigned long long bytes = g_allocBytes.load(std::memory_order_relaxed) - bytesAtStart;
+    const double allocsPerFrame = static_cast<double>(allocs) / frames;
+
+    std::cout << std::fixed << std::setprecision(3)
+              << "frames=" << frames
+              << " size=" << width << "x" << height
+              << " allocs=" << allocs
+              << " allocBytes=" << bytes
+              << " allocsPerFrame=" << allocsPerFrame
+              << " usPerFrame=" << (static_cast<double>(elapsedUs) / frames)
+              << " checksum=" << checksum
+              << std::endl;
+
+    mgr.close("BenchCamera", handle);
+
+    if (allocs != 0) {
+        std::cerr << "FAIL: steady-state live frames allocate on the heap" << std::endl;
+        return 1;
+    }
+    std::cout << "PASS: zero heap allocations per live frame" << std::endl;
+    return 0;
+}
@@ -0,0 +1,270 @@
+// sky_renderer_test.cpp
+// sim::SkyRenderer 自检：子像素核归一化与质心、落星总通量/亚像素位置/HFR、行带边界与跨画面边缘、
+// 同种子同帧逐位一致且与线程数/行带无关、泊松与读出噪声统计、暗角、饱和截断与行跨度，最后打印全幅渲染吞吐
+//
+// 用法：sky_renderer_test [frames]
+// 任一检查失败返回 1
+
+#include "../sim/SkyRenderer.h"
+#include "test_util.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace sim;
+
+using test_util::check;
+
+namespace {
+
+struct Moments {
+    double sum{0.0};
+    double x{0.0};
+    double y{0.0};
+    double hfr{0.0};
+};
+
+// 减去背景后求总量、质心和 HFR = Σ(I·r)/ΣI
+Moments moments(const std::vector<float>& img, int w, int h, double bg)
+{
+    Moments m;
+    for (int y = 0; y < h; ++y)
+        for (int x = 0; x < w; ++x) {
+            const double v = img[static_cast<size_t>(y) * w + x] - bg;
+            m.sum += v;
+            m.x += v * x;
+            m.y += v * y;
+        }
+    m.x /= m.sum;
+    m.y /= m.sum;
+    for (int y = 0; y < h; ++y)
+        for (int x = 0; x < w; ++x) {
+            const double v = img[static_cast<size_t>(y) * w + x] - bg;
+            m.hfr += v * std::hypot(x - m.x, y - m.y);
+        }
+    m.hfr /= m.sum;
+    return m;
+}
+
+void testKernels()
+{
+    std::cout << "[kernels]" << std::endl;
+    PsfKernelCache cache(16, 4.0);
+    bool normalized = true;
+    bool centred = true;
+    for (double sigma : {0.6, 1.0, 2.3, 4.0}) {
+        const auto& p = cache.profile(sigma);
+        const int size = 2 * p.radius + 1;
+        for (int phase = 0; phase < cache.subpixelSteps(); ++phase) {
+            double sum = 0.0;
+            double c = 0.0;
+            for (int i = 0; i < size; ++i) {
+                const double v = p.weights[static_cast<size_t>(phase) * size + i];
+                sum += v;
+                c += v * (i - p.radius);
+            }
+            normalized = normalized && std::fabs(sum - 1.0) < 1e-5;
+            const double expect = static_cast<double>(phase) / cache.subpixelSteps() - 0.5;
+            centred = centred && std::fabs(c - expect) < 2e-3;
+        }
+    }
+    check(normalized, "every phase sums to 1");
+    check(centred, "profile centroid equals sub-pixel phase");
+    const size_t before = cache.size();
+    cache.profile(2.3 + 0.004);
+    check(cache.size() == before, "near-identical sigma reuses the cached profile");
+
+    int carry = 0;
+    const int p0 = cache.phaseIndex(-0.5, &carry);
+    const int p1 = cache.phaseIndex(0.49, &carry);
+    check(p0 == 0 && p1 == 0 && carry == 1, "phase rounding to +0.5 carries to the next pixel");
+}
+
+void testStamp()
+{
+    std::cout << "[stamp]" << std::endl;
+    SkyRenderer renderer;
+    SkyRenderOptions opt;
+    opt.width = 96;
+    opt.height = 80;
+    opt.backgroundE = 10.0;
+    opt.bandRows = 7;       // 让星跨多个行带
+    std::vector<float> img(static_cast<size_t>(opt.width) * opt.height);
+
+    const double sigma = 2.0;
+    renderer.renderElectrons(opt, {{40.37, 33.81, 50000.0, sigma}}, img.data());
+    const Moments m = moments(img, opt.width, opt.height, opt.backgroundE);
+    check(std::fabs(m.sum - 50000.0) < 50000.0 * 1e-4, "total flux preserved (" + std::to_string(m.sum) + ")");
+    check(std::fabs(m.x - 40.37) < 0.04 && std::fabs(m.y - 33.81) < 0.04,
+          "sub-pixel centroid (" + std::to_string(m.x) + ", " + std::to_string(m.y) + ")");
+    // 像素积分与核截断让实测 HFR 略大于解析值
+    const double hfr = sigma * std::sqrt(2.0 * std::log(2.0));
+    check(std::fabs(m.hfr - hfr) < 0.1 * hfr, "HFR matches sigma (" + std::to_string(m.hfr) + " vs " + std::to_string(hfr) + ")");
+    check(std::fabs(sigmaFromHfr(hfr) - sigma) < 1e-12 && std::fabs(fluxFromPeak(1.0, 1.0) - 2.0 * M_PI) < 1e-12,
+          "flux/HFR conversions");
+
+    renderer.renderElectrons(opt, {{-1.0, 20.0, 1000.0, 1.5}, {1e12, 5.0, 1000.0, 1.5}, {50.0, 50.0, 0.0, 1.5}},
+                             img.data());
+    double edge = 0.0;
+    for (int y = 0; y < opt.height; ++y)
+        edge += img[static_cast<size_t>(y) * opt.width] - opt.backgroundE;
+    double far = 0.0;
+    for (float v : img)
+        far += v - opt.backgroundE;
+    check(edge > 100.0 && edge < 500.0 && std::fabs(far - edge) < 500.0,
+          "star off the left edge only lights its visible wing; far-away and zero-flux stars skipped");
+}
+
+void testDeterminism()
+{
+    std::cout << "[determinism]" << std::endl;
+    SkyRenderOptions opt;
+    opt.width = 321;
+    opt.height = 203;
+    opt.backgroundE = 150.0;
+    opt.readNoiseE = 4.0;
+    opt.biasAdu = 100.0;
+    opt.seed = 42;
+    opt.frameIndex = 7;
+    std::vector<StarStamp> stars;
+    for (int i = 0; i < 60; ++i)
+        stars.push_back({5.3 * i, 3.1 * i + 2.0, 2000.0 + 300.0 * i, 0.8 + 0.05 * i});
+
+    std::vector<uint16_t> a(static_cast<size_t>(opt.width) * opt.height);
+    std::vector<uint16_t> b(a.size());
+    SkyRenderer r1;
+    SkyRenderer r2;
+    opt.threads = 1;
+    opt.bandRows = 64;
+    r1.render(opt, stars, a.data());
+    opt.threads = 8;
+    opt.bandRows = 5;
+    r2.render(opt, stars, b.data());
+    check(a == b, "same seed/frame -> identical frame regardless of threads and band size");
+
+    opt.frameIndex = 8;
+    r2.render(opt, stars, b.data());
+    size_t differ = 0;
+    for (size_t i = 0; i < a.size(); ++i)
+        differ += a[i] != b[i];
+    check(differ > a.size() / 2, "next frame index -> fresh noise");
+}
+
+void testNoise()
+{
+    std::cout << "[noise]" << std::endl;
+    SkyRenderer renderer;
+    SkyRenderOptions opt;
+    opt.width = 400;
+    opt.height = 300;
+    opt.seed = 1;
+
+    auto stats = [&](double lambda, double readNoise, double gain, double& mean, double& var) {
+        opt.backgroundE = lambda;
+        opt.readNoiseE = readNoise;
+        opt.gainEPerAdu = gain;
+        opt.biasAdu = 500.0;
+        std::vector<uint16_t> img(static_cast<size_t>(opt.width) * opt.height);
+        renderer.render(opt, {}, img.data());
+        double s = 0.0;
+        double s2 = 0.0;
+        for (uint16_t v : img) {
+            s += v;
+            s2 += static_cast<double>(v) * v;
+        }
+        mean = s / img.size();
+        var = s2 / img.size() - mean * mean;
+    };
+
+    double mean = 0.0;
+    double var = 0.0;
+    stats(400.0, 5.0, 1.0, mean, var);
+    check(std::fabs(mean - 900.0) < 0.5 && std::fabs(var - 425.0) < 0.03 * 425.0,
+          "bright sky: mean " + std::to_string(mean) + ", var " + std::to_string(var) + " (expect 900 / 425)");
+    stats(3.0, 0.0, 1.0, mean, var);
+    check(std::fabs(mean - 503.0) < 0.05 && std::fabs(var - 3.0) < 0.15,
+          "faint sky, exact Poisson: mean " + std::to_string(mean) + ", var " + std::to_string(var));
+    stats(1000.0, 0.0, 4.0, mean, var);
+    check(std::fabs(mean - 750.0) < 0.2 && std::fabs(var - (1000.0 / 16.0 + 1.0 / 12.0)) < 0.05 * 62.5,
+          "gain 4 e/ADU scales mean and variance");
+
+    CounterRng rng(CounterRng::mix(9, 9));
+    double s = 0.0;
+    double s2 = 0.0;
+    const int n = 200000;
+    for (int i = 0; i < n; ++i) {
+        const double v = rng.normal();
+        s += v;
+        s2 += v * v;
+    }
+    check(std::fabs(s / n) < 0.01 && std::fabs(s2 / n - 1.0) < 0.01, "normal() has unit variance");
+}
+
+void testOutput()
+{
+    std::cout << "[output]" << std::endl;
+    SkyRenderer renderer;
+    SkyRenderOptions opt;
+    opt.width = 64;
+    opt.height = 48;
+    opt.backgroundE = 1000.0;
+    opt.vignette = 0.4;
+    opt.poisson = false;
+    opt.saturationAdu = 60000.0;
+    const size_t stride = 80;
+    std::vector<uint16_t> img(stride * opt.height, 0xBEEF);
+    renderer.render(opt, {{32.0, 24.0, 1e8, 1.0}}, img.data(), stride);
+
+    check(img[24 * stride + 32] == 60000, "saturated core clipped at saturationAdu");
+    check(img[0] == 600 && img[(opt.height - 1) * stride + opt.width - 1] == 600, "vignette darkens corners by 40%");
+    bool padding = true;
+    for (int y = 0; y < opt.height; ++y)
+        for (size_t x = opt.width; x < stride; ++x)
+            padding = padding && img[y * stride + x] == 0xBEEF;
+    check(padding, "row padding beyond width untouched");
+}
+
+void bench(int frames)
+{
+    std::cout << "[bench]" << std::endl;
+    SkyRenderer renderer;
+    SkyRenderOptions opt;
+    opt.width = 1920;
+    opt.height = 1080;
+    opt.backgroundE = 200.0;
+    opt.readNoiseE = 3.0;
+    opt.biasAdu = 100.0;
+    std::vector<StarStamp> stars;
+    CounterRng rng(123);
+    for (int i = 0; i < 300; ++i)
+        stars.push_back({rng.uniform() * opt.width, rng.uniform() * opt.height, 1e3 + rng.uniform() * 2e5,
+                         0.8 + rng.uniform() * 2.5});
+    std::vector<uint16_t> img(static_cast<size_t>(opt.width) * opt.height);
+
+    const auto t0 = std::chrono::steady_clock::now();
+    for (int f = 0; f < frames; ++f) {
+        opt.frameIndex = static_cast<uint64_t>(f);
+        renderer.render(opt, stars, img.data());
+    }
+    const double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    std::cout << "  1920x1080, 300 stars: " << frames << " frames in " << sec << " s ("
+              << (sec > 0 ? frames / sec * 60.0 : 0.0) << " frames/min)" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    const int frames = argc > 1 ? std::max(1, std::atoi(argv[1])) : 20;
+    testKernels();
+    testStamp();
+    testDeterminism();
+    testNoise();
+    testOutput();
+    bench(frames);
+    return test_util::finish();
+}
@@ -0,0 +1,129 @@
+// stage_pipeline_test.cpp
+// schedule::StagePipeline 自检：依赖规则与可并行规则一致（设备动作不与前置阶段并行、无环）、
+// OverheadTracker 在串行/流水线两种时间线下的墙钟、空闲、省掉的开销统计
+//
+// 用法：stage_pipeline_test
+// 任一检查失败返回 1
+
+#include "../schedule/StagePipeline.h"
+#include "test_util.h"
+
+#include <iostream>
+#include <string>
+
+using namespace schedule;
+
+using test_util::check;
+
+namespace {
+
+const Stage kAll[] = {Stage::Slew, Stage::Filter, Stage::Focus, Stage::Exposure, Stage::Write, Stage::Solve};
+
+void testRules()
+{
+    std::cout << "[rules]" << std::endl;
+    bool deviceExclusive = true;
+    bool symmetric = true;
+    bool acyclic = true;
+    for (Stage a : kAll) {
+        for (Stage b : kAll) {
+            // 设备动作之间：有依赖就不能并行
+            const bool device = a != Stage::Write && a != Stage::Solve && b != Stage::Write && b != Stage::Solve;
+            if (device && mayOverlap(a, b) && (dependsOn(a, b) || dependsOn(b, a)))
+                deviceExclusive = false;
+            if (mayOverlap(a, b) != mayOverlap(b, a))
+                symmetric = false;
+            if (dependsOn(a, b) && dependsOn(b, a))
+                acyclic = false;
+        }
+        if (mayOverlap(a, a) || dependsOn(a, a))
+            deviceExclusive = false;
+    }
+    check(deviceExclusive, "device stages never overlap their own prerequisites");
+    check(symmetric, "overlap rule is symmetric");
+    check(acyclic, "dependency rules have no cycles");
+    check(mayOverlap(Stage::Slew, Stage::Filter), "filter wheel moves during slew");
+    check(mayOverlap(Stage::Exposure, Stage::Write) && mayOverlap(Stage::Exposure, Stage::Solve),
+          "write and solve of frame N run during exposure N+1");
+    check(!mayOverlap(Stage::Exposure, Stage::Slew) && !mayOverlap(Stage::Exposure, Stage::Filter) &&
+              !mayOverlap(Stage::Exposure, Stage::Focus),
+          "nothing moves the optics during an exposure");
+    check(dependsOn(Stage::Focus, Stage::Filter) && dependsOn(Stage::Focus, Stage::Slew),
+          "focus runs on target in the imaging filter");
+    check(dependsOn(Stage::Solve, Stage::Write) && !mayOverlap(Stage::Solve, Stage::Solve),
+          "solve waits for the archived file, one at a time");
+    check(std::string(stageName(Stage::Solve)) == "solve", "stage names");
+}
+
+void testSequential()
+{
+    std::cout << "[sequential]" << std::endl;
+    OverheadTracker t;
+    t.reset(1000);
+    t.begin(Stage::Slew, 0, 1000);
+    t.end(Stage::Slew, 0, 61000);
+    t.begin(Stage::Filter, 0, 61500);   // 500 ms 轮询间隙
+    t.end(Stage::Filter, 0, 69500);
+    t.begin(Stage::Exposure, 1, 70000);
+    t.end(Stage::Exposure, 1, 130000);
+    t.begin(Stage::Write, 1, 130000);
+    t.end(Stage::Write, 1, 132000);
+    t.finish(132000);
+
+    const OverheadTracker::Report r = t.report();
+    check(r.wallMs == 131000, "wall time from row start to finish");
+    check(r.idleMs == 1000 && r.busyMs == 130000, "polling gaps are idle time");
+    check(r.removedMs == 0 && r.sequentialMs == r.wallMs, "nothing overlapped -> nothing removed");
+    check(r.exposureMs == 60000 && r.overheadMs == 71000, "overhead is wall time not spent exposing");
+    check(r.stageCount[static_cast<int>(Stage::Filter)] == 1 && r.stageMs[static_cast<int>(Stage::Filter)] == 8000,
+          "per-stage totals");
+}
+
+void testPipelined()
+{
+    std::cout << "[pipelined]" << std::endl;
+    OverheadTracker t;
+    t.reset(0);
+    t.begin(Stage::Slew, 0, 0);
+    t.begin(Stage::Filter, 0, 0);
+    t.end(Stage::Filter, 0, 8000);
+    t.end(Stage::Slew, 0, 60000);
+    t.begin(Stage::Exposure, 1, 60000);
+    t.end(Stage::Exposure, 1, 120000);
+    t.begin(Stage::Write, 1, 120000);
+    t.begin(Stage::Exposure, 2, 120000);
+    t.end(Stage::Write, 1, 122000);
+    t.begin(Stage::Solve, 1, 122000);
+    t.end(Stage::Solve, 1, 127000);
+    t.end(Stage::Exposure, 2, 180000);
+    t.finish(180000);
+    t.begin(Stage::Write, 2, 180000);
+    check(!t.idle() && t.isOpen(Stage::Write, 2), "tail write still open after the last exposure");
+    t.end(Stage::Write, 2, 182000);
+    t.noteSkippedSolve();
+    t.end(Stage::Write, 2, 190000);   // 重复结束忽略
+    check(t.idle(), "idle once the tail write finished");
+
+    const OverheadTracker::Report r = t.report();
+    check(r.wallMs == 180000 && r.idleMs == 0, "wall time stops at the last exposure");
+    check(r.exposureMs == 120000 && r.overheadMs == 60000, "exposure and overhead");
+    check(r.removedMs == 8000 + 2000 + 5000 + 2000, "removed = filter + writes + solve hidden behind other stages");
+    check(r.sequentialMs == r.wallMs + r.removedMs, "sequential estimate");
+    check(r.skippedSolves == 1, "skipped solves are reported");
+
+    OverheadTracker open;
+    open.reset(0);
+    open.begin(Stage::Slew, 0, 0);
+    const OverheadTracker::Report partial = open.report();
+    check(partial.wallMs == 0 && partial.stageCount[0] == 0, "open spans are not counted");
+}
+
+} // namespace
+
+int main()
+{
+    testRules();
+    testSequential();
+    testPipelined();
+    return test_util::finish();
+}
@@ -0,0 +1,232 @@
+// star_roi_test.cpp
+// focus::planStarRois / measureRoiHfr 自检：选星（排除饱和/靠边/有近邻的星、K 颗分散在读出子帧内）、
+// 读出子帧面积上限、窗口 HFR 与高斯星宽度成正比、子帧与全幅测量一致、窗口跟随漂移，
+// 以及每个对焦点读出/分析的像素量与全幅之比
+//
+// 用法：star_roi_test
+// 任一检查失败返回 1
+
+#include "../focus/StarRoi.h"
+#include "test_util.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace focus;
+
+using test_util::check;
+
+namespace {
+
+struct Frame {
+    int width{0};
+    int height{0};
+    std::vector<uint16_t> pixels;
+};
+
+Frame blank(int w, int h, double background, double noise, unsigned seed)
+{
+    Frame f;
+    f.width = w;
+    f.height = h;
+    f.pixels.resize(static_cast<size_t>(w) * h);
+    std::mt19937 rng(seed);
+    std::normal_distribution<double> n(background, noise);
+    for (uint16_t& p : f.pixels)
+        p = static_cast<uint16_t>(std::clamp(n(rng), 0.0, 65535.0));
+    return f;
+}
+
+void addStar(Frame& f, double cx, double cy, double amplitude, double sigma)
+{
+    const int r = static_cast<int>(std::ceil(6.0 * sigma));
+    for (int y = std::max(0, static_cast<int>(cy) - r); y <= std::min(f.height - 1, static_cast<int>(cy) + r); ++y) {
+        for (int x = std::max(0, static_cast<int>(cx) - r); x <= std::min(f.width - 1, static_cast<int>(cx) + r); ++x) {
+            const double d2 = (x - cx) * (x - cx) + (y - cy) * (y - cy);
+            uint16_t& p = f.pixels[static_cast<size_t>(y) * f.width + x];
+            p = static_cast<uint16_t>(std::min(65535.0, p + amplitude * std::exp(-d2 / (2.0 * sigma * sigma))));
+        }
+    }
+}
+
+Frame crop(const Frame& f, const RoiRect& r)
+{
+    Frame c;
+    c.width = r.width;
+    c.height = r.height;
+    c.pixels.resize(static_cast<size_t>(r.width) * r.height);
+    for (int y = 0; y < r.height; ++y)
+        for (int x = 0; x < r.width; ++x)
+            c.pixels[static_cast<size_t>(y) * r.width + x] = f.pixels[static_cast<size_t>(y + r.y) * f.width + x + r.x];
+    return c;
+}
+
+void testPlan()
+{
+    std::cout << "[plan]" << std::endl;
+    const int W = 9576, H = 6388;   // 60 MP
+    std::vector<StarCandidate> cands;
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<double> ux(0.0, W), uy(0.0, H), uf(1000.0, 20000.0);
+    for (int i = 0; i < 400; ++i)
+        cands.push_back({ux(rng), uy(rng), uf(rng), 20000.0, 2.5, 30.0});
+    // 画面中心附近放几颗应被排除的星
+    cands.push_back({W / 2.0, H / 2.0, 1e6, 65535.0, 2.5, 200.0});             // 饱和
+    cands.push_back({W / 2.0 + 300.0, H / 2.0, 50000.0, 30000.0, 2.5, 80.0});  // 与下一颗互为近邻
+    cands.push_back({W / 2.0 + 310.0, H / 2.0, 40000.0, 30000.0, 2.5, 80.0});
+    cands.push_back({5.0, H / 2.0, 50000.0, 30000.0, 2.5, 80.0});              // 靠边
+    cands.push_back({W / 2.0, H / 2.0 + 400.0, 50000.0, 30000.0, 2.5, 2.0});   // 低信噪比
+
+    StarRoiOptions opt;
+    opt.imageWidth = W;
+    opt.imageHeight = H;
+    opt.starCount = 8;
+    const StarRoiPlan plan = planStarRois(cands, opt);
+    check(plan.ok && plan.stars.size() == 8 && plan.windows.size() == 8, "K stars chosen");
+    check(plan.windowSize == 40, "window size from the median HFR (16 x 2.5)");
+    check(plan.readoutFraction <= 0.25 + 1e-9, "readout sub-frame within the area budget");
+    check(plan.readout.x % 4 == 0 && plan.readout.y % 4 == 0 && plan.readout.width % 4 == 0 &&
+              plan.readout.x + plan.readout.width <= W && plan.readout.y + plan.readout.height <= H,
+          "readout aligned and inside the sensor");
+    bool inside = true;
+    bool excluded = true;
+    for (size_t i = 0; i < plan.stars.size(); ++i) {
+        inside = inside && plan.readout.contains(plan.windows[i]);
+        const StarCandidate& s = plan.stars[i];
+        excluded = excluded && s.peak < opt.saturationAdu && s.snr >= opt.minSnr && s.x > 100.0 &&
+                   std::abs(s.x - (W / 2.0 + 305.0)) > 20.0;
+    }
+    check(inside, "every window inside the readout");
+    check(excluded, "saturated, blended, edge and faint stars rejected");
+
+    // 分散：最近两颗的距离不小于子帧对角线的 1/6
+    double minDist = 1e18;
+    for (size_t i = 0; i < plan.stars.size(); ++i)
+        for (size_t j = i + 1; j < plan.stars.size(); ++j)
+            minDist = std::min(minDist, std::hypot(plan.stars[i].x - plan.stars[j].x, plan.stars[i].y - plan.stars[j].y));
+    const double diag = std::hypot(plan.readout.width, plan.readout.height);
+    check(minDist > diag / 6.0, "stars spread across the readout (min spacing " + std::to_string(minDist) + " px)");
+
+    std::vector<StarCandidate> few(cands.begin(), cands.begin() + 2);
+    check(!planStarRois(few, opt).ok, "too few stars -> no ROI mode");
+
+    StarRoiOptions whole = opt;
+    whole.maxReadoutFraction = 1.0;
+    const StarRoiPlan wide = planStarRois(cands, whole);
+    check(wide.ok && wide.readoutFraction > plan.readoutFraction, "full-frame budget spreads stars wider");
+}
+
+void testMeasure()
+{
+    std::cout << "[measure]" << std::endl;
+    Frame frame = blank(1200, 900, 1000.0, 20.0, 5);
+    const double xs[] = {200.3, 600.7, 1000.1, 300.5, 900.9};
+    const double ys[] = {200.2, 150.6, 300.4, 700.8, 650.1};
+    for (int i = 0; i < 5; ++i)
+        addStar(frame, xs[i], ys[i], 20000.0, 2.0);
+    addStar(frame, 450.0, 450.0, 200000.0, 2.0);   // 饱和
+
+    std::vector<StarCandidate> cands;
+    for (int i = 0; i < 5; ++i)
+        cands.push_back({xs[i], ys[i], 1.0e5, 21000.0, 2.4, 100.0});
+    cands.push_back({450.0, 450.0, 1.0e6, 65535.0, 2.4, 300.0});
+
+    StarRoiOptions opt;
+    opt.imageWidth = frame.width;
+    opt.imageHeight = frame.height;
+    opt.starCount = 5;
+    opt.maxReadoutFraction = 1.0;
+    StarRoiPlan plan = planStarRois(cands, opt);
+    check(plan.ok && plan.stars.size() == 5, "five unsaturated stars planned");
+
+    const WindowMeasure one = measureWindow(frame.pixels.data(), frame.width, frame.height, 0, 0, plan.windows[0]);
+    check(one.ok && std::abs(one.x - plan.stars[0].x) < 0.2 && std::abs(one.y - plan.stars[0].y) < 0.2,
+          "centroid on the star");
+
+    StarRoiPlan full = plan;
+    const RoiHfrResult r1 = measureRoiHfr(frame.pixels.data(), frame.width, frame.height, 0, 0, full, 60000.0, false);
+    const Frame sub = crop(frame, plan.readout);
+    StarRoiPlan subPlan = plan;
+    const RoiHfrResult r2 = measureRoiHfr(sub.pixels.data(), sub.width, sub.height, plan.readout.x, plan.readout.y,
+                                          subPlan, 60000.0, false);
+    check(r1.ok && r2.ok && r1.measured == 5 && std::abs(r1.medianHfr - r2.medianHfr) < 1e-12,
+          "sub-frame and full-frame give the same HFR");
+
+    Frame wider = blank(1200, 900, 1000.0, 20.0, 6);
+    for (int i = 0; i < 5; ++i)
+        addStar(wider, xs[i], ys[i], 5000.0, 4.0);
+    StarRoiPlan widerPlan = plan;
+    const RoiHfrResult r3 = measureRoiHfr(wider.pixels.data(), wider.width, wider.height, 0, 0, widerPlan, 60000.0, false);
+    const double ratio = r3.medianHfr / r1.medianHfr;
+    check(r3.ok && ratio > 1.6 && ratio < 2.4, "HFR scales with star width (ratio " + std::to_string(ratio) + ")");
+
+    Frame saturated = blank(1200, 900, 1000.0, 20.0, 7);
+    for (int i = 0; i < 5; ++i)
+        addStar(saturated, xs[i], ys[i], i < 2 ? 200000.0 : 20000.0, 2.0);
+    StarRoiPlan satPlan = plan;
+    const RoiHfrResult r4 = measureRoiHfr(saturated.pixels.data(), saturated.width, saturated.height, 0, 0, satPlan,
+                                          60000.0, false);
+    check(r4.saturated == 2 && r4.measured == 3, "saturated stars left out of the median");
+
+    Frame drifted = blank(1200, 900, 1000.0, 20.0, 8);
+    for (int i = 0; i < 5; ++i)
+        addStar(drifted, xs[i] + 6.0, ys[i] - 4.0, 20000.0, 2.0);
+    StarRoiPlan driftPlan = plan;
+    measureRoiHfr(drifted.pixels.data(), drifted.width, drifted.height, 0, 0, driftPlan, 60000.0, true);
+    const RoiRect& w = driftPlan.windows[0];
+    check(std::abs(w.x + w.width / 2 - (xs[0] + 6.0)) <= 1.0 && std::abs(w.y + w.height / 2 - (ys[0] - 4.0)) <= 1.0,
+          "windows follow drift");
+
+    Frame empty = blank(1200, 900, 1000.0, 20.0, 9);
+    StarRoiPlan emptyPlan = plan;
+    check(!measureRoiHfr(empty.pixels.data(), empty.width, empty.height, 0, 0, emptyPlan, 60000.0).ok,
+          "no stars -> not ok");
+}
+
+void testCost()
+{
+    std::cout << "[cost]" << std::endl;
+    const int W = 9576, H = 6388;
+    Frame frame = blank(W, H, 1000.0, 20.0, 10);
+    std::vector<StarCandidate> cands;
+    std::mt19937 rng(12);
+    std::uniform_real_distribution<double> ux(100.0, W - 100.0), uy(100.0, H - 100.0);
+    for (int i = 0; i < 300; ++i) {
+        const double x = ux(rng), y = uy(rng);
+        addStar(frame, x, y, 15000.0, 2.0);
+        cands.push_back({x, y, 1.0e5, 16000.0, 2.4, 50.0});
+    }
+    StarRoiOptions opt;
+    opt.imageWidth = W;
+    opt.imageHeight = H;
+    StarRoiPlan plan = planStarRois(cands, opt);
+    const Frame sub = crop(frame, plan.readout);
+
+    const auto t0 = std::chrono::steady_clock::now();
+    const RoiHfrResult r = measureRoiHfr(sub.pixels.data(), sub.width, sub.height, plan.readout.x, plan.readout.y,
+                                         plan, 60000.0);
+    const auto t1 = std::chrono::steady_clock::now();
+    long long analysed = 0;
+    for (const RoiRect& w : plan.windows)
+        analysed += w.area();
+    std::cout << "  readout " << plan.readout.width << "x" << plan.readout.height << " ("
+              << plan.readoutFraction * 100.0 << "% of 60 MP), analysed " << analysed << " px in "
+              << std::chrono::duration<double, std::milli>(t1 - t0).count() << " ms" << std::endl;
+    check(r.ok && r.measured == static_cast<int>(plan.windows.size()), "all windows measured on the sub-frame");
+    check(analysed < static_cast<long long>(W) * H / 1000, "analysis touches < 0.1% of the sensor");
+}
+
+} // namespace
+
+int main()
+{
+    testPlan();
+    testMeasure();
+    testCost();
+    return test_util::finish();
+}
@@ -0,0 +1,274 @@
+// system_telemetry_test.cpp
+// telemetry::SystemSampler / DeltaEncoder / TelemetryService 自检：/proc 文本解析、
+// 在临时目录伪造的 /proc、/sys 上按差值计算整机/单核/各子系统线程的 CPU 占用、内存、温度、网速，
+// 压缩增量只输出变化字段并定期全量，后台采样线程按间隔回调并能及时停止
+//
+// 用法：system_telemetry_test
+// 任一检查失败返回 1
+
+#include "../telemetry/SystemTelemetry.h"
+#include "test_util.h"
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace telemetry;
+
+using test_util::check;
+using test_util::near;
+
+namespace {
+
+void writeFile(const std::string& path, const std::string& text)
+{
+    std::ofstream(path) << text;
+}
+
+void makeDirs(const std::string& path)
+{
+    std::string partial;
+    for (size_t i = 0; i <= path.size(); ++i) {
+        if (i == path.size() || (path[i] == '/' && i > 0)) {
+            partial = path.substr(0, i);
+            mkdir(partial.c_str(), 0755);
+        }
+    }
+}
+
+std::string procStat(uint64_t busy, uint64_t idle)
+{
+    // 两个核各占一半
+    return "cpu  " + std::to_string(busy) + " 0 0 " + std::to_string(idle) + " 0 0 0 0 0 0\n" +
+           "cpu0 " + std::to_string(busy / 2) + " 0 0 " + std::to_string(idle / 2) + " 0 0 0 0 0 0\n" +
+           "cpu1 " + std::to_string(busy / 2) + " 0 0 " + std::to_string(idle / 2) + " 0 0 0 0 0 0\n" +
+           "intr 123\nctxt 456\n";
+}
+
+std::string taskStat(int tid, const std::string& comm, uint64_t utime, uint64_t stime)
+{
+    return std::to_string(tid) + " (" + comm + ") S 1 1 1 0 -1 4194560 10 0 0 0 " + std::to_string(utime) + " " +
+           std::to_string(stime) + " 0 0 20 0 1 0 100 0 0\n";
+}
+
+std::string netDev(uint64_t rx, uint64_t tx)
+{
+    return "Inter-|   Receive                                                |  Transmit\n"
+           " face |bytes    packets errs drop fifo frame compressed multicast|bytes    packets errs drop fifo colls carrier compressed\n"
+           "    lo: 999 1 0 0 0 0 0 0 999 1 0 0 0 0 0 0\n"
+           "  eth0: " + std::to_string(rx) + " 10 0 0 0 0 0 0 " + std::to_string(tx) + " 5 0 0 0 0 0 0\n";
+}
+
+void testParsers()
+{
+    std::cout << "[parsers]" << std::endl;
+    ProcStat ps;
+    check(parseProcStat(procStat(300, 700), ps) && ps.all.total() == 1000 && ps.all.idleAll() == 700 &&
+              ps.cores.size() == 2,
+          "/proc/stat totals and per-core lines");
+    check(!parseProcStat("intr 1\n", ps), "no cpu line -> false");
+    check(parseProcStat("cpu 1 2 3 4\n", ps) && ps.all.total() == 10, "old kernels without iowait fields");
+
+    MemInfo mem;
+    check(parseMeminfo("MemTotal:  1000 kB\nMemFree:  100 kB\nMemAvailable:  400 kB\n", mem) &&
+              mem.totalKb == 1000 && mem.availableKb == 400,
+          "MemAvailable preferred");
+    check(parseMeminfo("MemTotal: 1000 kB\nMemFree: 100 kB\nBuffers: 50 kB\nCached: 150 kB\n", mem) &&
+              mem.availableKb == 300,
+          "fallback to free + buffers + cached");
+
+    TaskStat t;
+    check(parseTaskStat(taskStat(42, "Sdk (Main) Wo", 17, 5), t) && t.tid == 42 && t.comm == "Sdk (Main) Wo" &&
+              t.utime == 17 && t.stime == 5,
+          "task stat with spaces and parentheses in comm");
+    check(!parseTaskStat("42 (x) S 1 2", t), "truncated task stat -> false");
+
+    const auto nets = parseNetDev(netDev(5000, 7000));
+    check(nets.size() == 2 && nets[1].iface == "eth0" && nets[1].rxBytes == 5000 && nets[1].txBytes == 7000,
+          "/proc/net/dev rx/tx bytes");
+
+    const auto rules = defaultThreadGroupRules();
+    TaskStat task;
+    task.tid = 10;
+    check(classifyThread(task, 10, rules) == "gui", "main thread -> gui");
+    task.tid = 11;
+    task.comm = "SdkMainCameraWo";
+    check(classifyThread(task, 10, rules) == "sdk", "truncated executor name -> sdk");
+    task.comm = "GuiderCoreThrea";
+    check(classifyThread(task, 10, rules) == "guider", "guider core thread");
+    task.comm = "Thread (pooled)";
+    check(classifyThread(task, 10, rules) == "tiles", "Qt pool -> tiles");
+    task.comm = "QUARCS";
+    check(classifyThread(task, 10, rules) == "other", "unnamed thread -> other");
+}
+
+void testSampler()
+{
+    std::cout << "[sampler]" << std::endl;
+    const test_util::TempDir tmp("telemetry_test");
+    if (!tmp.ok()) {
+        check(false, "mkdtemp");
+        return;
+    }
+    const std::string root = tmp.path();
+    const std::string proc = root + "/proc";
+    const std::string sys = root + "/sys";
+    makeDirs(proc + "/500/task/500");
+    makeDirs(proc + "/500/task/501");
+    makeDirs(proc + "/500/task/502");
+    makeDirs(proc + "/net");
+    makeDirs(sys + "/class/thermal/thermal_zone0");
+    makeDirs(sys + "/class/thermal/thermal_zone1");
+    makeDirs(sys + "/class/thermal/cooling_device0");
+    writeFile(sys + "/class/thermal/thermal_zone0/type", "gpu-thermal\n");
+    writeFile(sys + "/class/thermal/thermal_zone0/temp", "38000\n");
+    writeFile(sys + "/class/thermal/thermal_zone1/type", "cpu-thermal\n");
+    writeFile(sys + "/class/thermal/thermal_zone1/temp", "51234\n");
+    writeFile(proc + "/meminfo", "MemTotal: 4000000 kB\nMemAvailable: 1000000 kB\n");
+
+    writeFile(proc + "/stat", procStat(1000, 9000));
+    writeFile(proc + "/500/task/500/stat", taskStat(500, "QUARCS", 100, 0));
+    writeFile(proc + "/500/task/501/stat", taskStat(501, "SdkMainCameraWo", 200, 0));
+    writeFile(proc + "/500/task/502/stat", taskStat(502, "Thread (pooled)", 50, 0));
+    writeFile(proc + "/net/dev", netDev(10000, 20000));
+
+    SystemSampler::Options opt;
+    opt.procRoot = proc;
+    opt.sysRoot = sys;
+    opt.pid = 500;
+    opt.ticksPerSecond = 100;
+    opt.diskPaths = {root, root + "/missing"};
+    SystemSampler sampler(opt);
+
+    const TelemetrySample first = sampler.sample(0);
+    check(!first.hasDelta && first.cpuPercent == 0.0 && first.processCpuPercent == 0.0,
+          "first sample has no rates");
+    check(near(first.cpuTempC, 51.234) && first.zones.size() == 2, "cpu thermal zone preferred over zone0");
+    check(near(first.memUsedPercent, 75.0) && first.memTotalKb == 4000000, "memory used percent");
+    check(first.disks.size() == 2 && first.disks[0].availableBytes > 0 && first.disks[1].availableBytes == -1,
+          "statvfs for existing path, -1 for missing");
+    check(first.nets.size() == 1 && first.nets[0].iface == "eth0", "loopback skipped");
+
+    // 2 秒后：整机 +400 busy / +600 idle；GUI 线程 +20 ticks，SDK +150，瓦片线程退出，新线程 503 出现
+    writeFile(proc + "/stat", procStat(1400, 9600));
+    writeFile(proc + "/500/task/500/stat", taskStat(500, "QUARCS", 110, 10));
+    writeFile(proc + "/500/task/501/stat", taskStat(501, "SdkMainCameraWo", 300, 50));
+    unlink((proc + "/500/task/502/stat").c_str());
+    rmdir((proc + "/500/task/502").c_str());
+    makeDirs(proc + "/500/task/503");
+    writeFile(proc + "/500/task/503/stat", taskStat(503, "GuiderCoreThrea", 900, 0));
+    writeFile(proc + "/net/dev", netDev(30000, 21000));
+
+    const TelemetrySample second = sampler.sample(2000);
+    check(second.hasDelta && near(second.cpuPercent, 40.0), "overall CPU from /proc/stat deltas");
+    check(second.corePercent.size() == 2 && near(second.corePercent[0], 40.0), "per-core CPU");
+    double gui = -1.0, sdk = -1.0, guider = -1.0, tiles = -1.0;
+    for (const auto& g : second.groups) {
+        if (g.name == "gui")
+            gui = g.cpuPercent;
+        else if (g.name == "sdk")
+            sdk = g.cpuPercent;
+        else if (g.name == "guider")
+            guider = g.cpuPercent;
+        else if (g.name == "tiles")
+            tiles = g.cpuPercent;
+    }
+    check(near(gui, 10.0) && near(sdk, 75.0), "per-subsystem CPU in percent of one core");
+    check(near(guider, 0.0), "thread without a baseline is not charged its lifetime ticks");
+    check(tiles < 0.0, "exited thread disappears");
+    check(!second.groups.empty() && second.groups.front().name == "sdk", "groups sorted by load");
+    check(near(second.processCpuPercent, 85.0), "process CPU is the sum of thread deltas");
+    check(near(second.nets[0].rxBytesPerSec, 10000.0) && near(second.nets[0].txBytesPerSec, 500.0),
+          "network bytes per second");
+
+    writeFile(proc + "/net/dev", netDev(100, 100));
+    const TelemetrySample third = sampler.sample(3000);
+    check(third.nets[0].rxBytesPerSec == 0.0, "counter reset -> zero rate, not negative");
+
+    for (const char* f : {"/stat", "/meminfo", "/net/dev"})
+        unlink((proc + f).c_str());
+    const TelemetrySample bare = sampler.sample(4000);
+    check(bare.cpuPercent == 0.0 && bare.memTotalKb == 0 && bare.nets.empty(), "missing /proc files degrade to empty");
+}
+
+void testEncoder()
+{
+    std::cout << "[encoder]" << std::endl;
+    DeltaEncoder enc(3);
+    TelemetrySample s;
+    s.cpuPercent = 12.34;
+    s.cpuTempC = 50.0;
+    s.memUsedPercent = 40.0;
+    s.groups.push_back({"sdk", 30.0, 2});
+    TelemetrySample::Disk disk;
+    disk.path = "/data";
+    disk.availableBytes = 1000LL * 1024 * 1024;
+    s.disks.push_back(disk);
+
+    const std::string full = enc.encode(s);
+    check(full.find("\"cpu\":12.3") != std::string::npos && full.find("\"g.sdk\":30") != std::string::npos &&
+              full.find("\"disk./data\":1048576000") != std::string::npos && full.find("\"full\":1") != std::string::npos,
+          "first message is a full snapshot: " + full);
+
+    s.cpuPercent = 12.5;
+    s.groups[0].cpuPercent = 45.0;
+    const std::string delta = enc.encode(s);
+    check(delta == "{\"g.sdk\":45}", "only fields beyond the threshold: " + delta);
+
+    check(enc.encode(s).empty(), "unchanged sample -> empty message");
+    const std::string again = enc.encode(s);
+    check(again.find("\"cpu\":12.5") != std::string::npos && again.find("\"full\":1") != std::string::npos,
+          "every fullEvery-th message is a full snapshot");
+
+    s.cpuPercent = 13.0;   // 与上次发出的 12.5 比较，不是与上一帧比较
+    check(enc.encode(s) == "{\"cpu\":13}", "drift accumulates against the last published value");
+}
+
+void testService()
+{
+    std::cout << "[service]" << std::endl;
+    SystemSampler::Options opt;
+    opt.diskPaths = {"/"};
+    TelemetryService service(opt, 100);
+    std::atomic<int> calls{0};
+    std::atomic<bool> sawFull{false};
+    service.start([&](const TelemetrySample&, const std::string& delta) {
+        if (delta.find("\"full\":1") != std::string::npos)
+            sawFull = true;
+        ++calls;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(450));
+    check(service.running(), "running after start");
+    const auto t0 = std::chrono::steady_clock::now();
+    service.stop();
+    const auto stopMs =
+        std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - t0).count();
+    check(calls >= 3 && calls <= 6, "about one sample per interval (" + std::to_string(calls.load()) + ")");
+    check(sawFull.load(), "first delta is a full snapshot");
+    check(stopMs < 100 && !service.running(), "stop wakes the sampling thread");
+    check(service.availableBytes("/") > 0 && service.availableBytes("/nope") == -1, "cached disk space lookup");
+
+    bool sawSelf = false;
+    for (const auto& g : service.latest().groups)
+        sawSelf = sawSelf || (g.name == "gui" && g.threads == 1);
+    check(sawSelf, "real /proc/self/task sampled");
+}
+
+} // namespace
+
+int main()
+{
+    testParsers();
+    testSampler();
+    testEncoder();
+    testService();
+    return test_util::finish();
+}
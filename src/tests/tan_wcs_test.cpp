@@ -0,0 +1,130 @@
+// tan_wcs_test.cpp
+// solver::TanWcs 自检：像素<->天球往返、方向角/镜像/像素尺度与 astrometry.net 约定一致、天极附近、.wcs 文件写入/读回
+//
+// 用法：tan_wcs_test
+// 任一检查失败返回 1
+
+#include "../solver/TanWcs.h"
+#include "test_util.h"
+
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+using test_util::check;
+using test_util::near;
+
+namespace {
+
+double wrap180(double d)
+{
+    while (d > 180.0)
+        d -= 360.0;
+    while (d <= -180.0)
+        d += 360.0;
+    return d;
+}
+
+void testRoundTrip()
+{
+    std::cout << "[round trip]" << std::endl;
+    const double centers[][2] = {{10.68, 41.27}, {83.82, -5.39}, {359.9, 0.1}, {37.95, 89.26}, {0.0, -89.9}};
+    for (const auto& c : centers) {
+        for (double orient : {0.0, 37.5, -120.0, 179.0}) {
+            for (bool mirrored : {false, true}) {
+                const auto w = solver::TanWcs::fromSolution(c[0], c[1], orient, 3.76, mirrored, 3000, 2000);
+                double maxErr = 0.0;
+                for (double x : {1.0, 777.7, 1500.5, 3000.0}) {
+                    for (double y : {1.0, 1000.5, 2000.0}) {
+                        const auto s = w.pixelToSky(x, y);
+                        double bx = 0, by = 0;
+                        if (!w.skyToPixel(s.raDeg, s.decDeg, &bx, &by)) {
+                            maxErr = 1e9;
+                            continue;
+                        }
+                        maxErr = std::max(maxErr, std::hypot(bx - x, by - y));
+                    }
+                }
+                const auto center = w.pixelToSky(w.crpix[0], w.crpix[1]);
+                const bool ok = maxErr < 1e-6 && solver::angularSeparationDeg(center.raDeg, center.decDeg, c[0], c[1]) < 1e-9 &&
+                                near(wrap180(w.orientationDeg() - orient), 0.0, 1e-9) && w.mirrored() == mirrored &&
+                                near(w.pixelScaleArcsec(), 3.76, 1e-9);
+                if (!ok) {
+                    check(false, "ra=" + std::to_string(c[0]) + " dec=" + std::to_string(c[1]) + " orient=" +
+                                     std::to_string(orient) + " mirrored=" + std::to_string(mirrored) +
+                                     " err=" + std::to_string(maxErr));
+                    return;
+                }
+            }
+        }
+    }
+    check(true, "pixel->sky->pixel < 1e-6 px; orientation/parity/scale recovered");
+}
+
+void testConventions()
+{
+    std::cout << "[conventions]" << std::endl;
+    // orientation 0、非镜像：北在上（+y）、东在左（-x）
+    const auto w = solver::TanWcs::fromSolution(180.0, 20.0, 0.0, 10.0, false, 1000, 1000);
+    const auto up = w.pixelToSky(w.crpix[0], w.crpix[1] + 100);
+    const auto left = w.pixelToSky(w.crpix[0] - 100, w.crpix[1]);
+    check(up.decDeg > 20.0 && near(up.raDeg, 180.0, 1e-9), "+y points north");
+    check(left.raDeg > 180.0 && near(left.decDeg, 20.0, 0.01), "-x points east");
+    check(near(w.fieldWidthDeg(), 1000 * 10.0 / 3600.0, 1e-9), "field width from scale");
+
+    // 与 astrometry.net 的 CD 直接对比（orientation = -atan2(parity*cd21 - cd12, parity*cd11 + cd22)）
+    solver::TanWcs a;
+    a.cd[0][0] = -2.7e-4;
+    a.cd[0][1] = 1.1e-4;
+    a.cd[1][0] = 1.1e-4;
+    a.cd[1][1] = 2.7e-4;
+    const double expected = -std::atan2(-1.0 * a.cd[1][0] - a.cd[0][1], -1.0 * a.cd[0][0] + a.cd[1][1]) * 180.0 / M_PI;
+    check(near(a.orientationDeg(), expected, 1e-12) && !a.mirrored(), "orientation matches tan_get_orientation");
+
+    const double sep = solver::angularSeparationDeg(0.0, 89.0, 180.0, 89.0);
+    check(near(sep, 2.0, 1e-9), "separation across the pole");
+}
+
+void testWcsFile()
+{
+    std::cout << "[wcs file]" << std::endl;
+    const test_util::TempDir tmp("tan_wcs_test");
+    const std::string path = tmp.file("frame.wcs");
+    const auto w = solver::TanWcs::fromSolution(37.95, 89.26, 12.5, 27.8, false, 1280, 960);
+    std::string err;
+    check(solver::writeWcsFile(path, w, &err), "write .wcs " + err);
+
+    std::ifstream in(path, std::ios::binary);
+    std::string data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    check(data.size() == 2880, "one 2880-byte header block");
+    check(data.compare(0, 30, "SIMPLE  =                    T") == 0, "starts with SIMPLE card");
+    bool cardsOk = true;
+    bool hasEnd = false;
+    for (size_t i = 0; i + 80 <= data.size(); i += 80) {
+        const std::string c = data.substr(i, 80);
+        if (c.compare(0, 3, "END") == 0 && c.find_first_not_of(' ', 3) == std::string::npos)
+            hasEnd = true;
+        for (char ch : c)
+            cardsOk = cardsOk && ch >= 0x20 && ch <= 0x7e;
+    }
+    check(cardsOk && hasEnd, "printable 80-char cards with END");
+    check(data.find("CTYPE1  = 'RA---TAN'") != std::string::npos && data.find("IMAGEW  =                 1280") != std::string::npos,
+          "CTYPE and IMAGEW cards");
+
+    solver::TanWcs back;
+    const bool readOk = solver::readWcsFile(path, &back, &err);
+    check(readOk && back.imageWidth == 1280 && back.imageHeight == 960 && near(back.crval[1], w.crval[1], 1e-12) &&
+              near(back.cd[0][1], w.cd[0][1], 1e-14) && near(back.crpix[0], w.crpix[0], 1e-12),
+          "read back .wcs " + err);
+}
+
+} // namespace
+
+int main()
+{
+    testRoundTrip();
+    testConventions();
+    testWcsFile();
+    return test_util::finish();
+}
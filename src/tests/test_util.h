@@ -0,0 +1,80 @@
+// test_util.h
+// 独立自检程序（tests/*_test.cpp）共用的小工具：逐项检查与失败计数、统一的 PASS/FAIL 收尾、
+// 近似比较，以及退出时自动删除的临时目录。只依赖标准库，和各测试一样不进 client
+//
+// 每项检查输出 "  ok   <说明>" 或 "  FAIL <说明>"，最后一行 "PASS/FAIL (N failures)"，任一失败返回 1
+
+#pragma once
+
+#include <cmath>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include <stdlib.h>
+
+namespace test_util {
+
+inline int& failures()
+{
+    static int count = 0;
+    return count;
+}
+
+inline void check(bool cond, const std::string& what)
+{
+    if (cond) {
+        std::cout << "  ok   " << what << std::endl;
+    } else {
+        std::cout << "  FAIL " << what << std::endl;
+        ++failures();
+    }
+}
+
+inline bool near(double a, double b, double tol = 1e-6)
+{
+    return std::abs(a - b) <= tol;
+}
+
+// 打印总结行并返回进程退出码；note 非空时附在失败数后面（如耗时）
+inline int finish(const std::string& note = std::string())
+{
+    const int n = failures();
+    std::cout << (n == 0 ? "PASS" : "FAIL") << " (" << n << " failures" << (note.empty() ? "" : ", " + note) << ")"
+              << std::endl;
+    return n == 0 ? 0 : 1;
+}
+
+// /tmp/<prefix>.XXXXXX 临时目录，析构时连同内容删除；创建失败时 ok() 为 false
+class TempDir
+{
+public:
+    explicit TempDir(const std::string& prefix)
+    {
+        std::string tmpl = "/tmp/" + prefix + ".XXXXXX";
+        std::vector<char> buf(tmpl.begin(), tmpl.end());
+        buf.push_back('\0');
+        if (::mkdtemp(buf.data()))
+            m_path = buf.data();
+    }
+    ~TempDir()
+    {
+        if (!m_path.empty()) {
+            std::error_code ec;
+            std::filesystem::remove_all(m_path, ec);
+        }
+    }
+    TempDir(const TempDir&) = delete;
+    TempDir& operator=(const TempDir&) = delete;
+
+    bool ok() const { return !m_path.empty(); }
+    const std::string& path() const { return m_path; }
+    std::string file(const std::string& name) const { return m_path + "/" + name; }
+
+private:
+    std::string m_path;
+};
+
+} // namespace test_util
@@ -0,0 +1,242 @@
+// tile_stats_test.cpp
+// image::TileStatsGrid 自检：逐瓦片统计与逐像素暴力统计一致（计数/和/平方和/min/max/直方图）、
+// 四叉树合并出的任意视口与暴力统计一致、线程数不影响结果、非整瓦片尺寸与行跨距、
+// 自动拉伸与旧 calculateGPM 口径一致、各 CFA 相位的白平衡增益、G1/G2 失衡与 Mono 不做白平衡，附整帧耗时
+//
+// 用法：tile_stats_test
+// 任一检查失败返回 1
+
+#include "../image/TileStats.h"
+#include "test_util.h"
+
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using test_util::check;
+
+namespace {
+
+struct Frame {
+    int width{0};
+    int height{0};
+    size_t stride{0};
+    std::vector<uint16_t> pixels;
+};
+
+// 合成 Bayer 帧：四个相位各自的天光电平 + 噪声 + 少量亮星（饱和）
+Frame makeFrame(int width, int height, size_t stride, const double level[4], uint32_t seed, int starCount = 200)
+{
+    Frame f;
+    f.width = width;
+    f.height = height;
+    f.stride = stride;
+    f.pixels.assign(stride * height, 0xBEEF);  // 跨距外的填充值不应被统计
+    std::mt19937 rng(seed);
+    std::normal_distribution<double> noise(0.0, 40.0);
+    std::uniform_real_distribution<double> u(0.0, 1.0);
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            const double v = level[(x & 1) + 2 * (y & 1)] + noise(rng) + 3.0 * std::sin(x * 0.01) * std::cos(y * 0.013);
+            f.pixels[static_cast<size_t>(y) * stride + x] = static_cast<uint16_t>(std::max(0.0, std::min(65535.0, v)));
+        }
+    }
+    for (int i = 0; i < starCount; ++i) {
+        const int cx = static_cast<int>(u(rng) * width), cy = static_cast<int>(u(rng) * height);
+        for (int dy = -2; dy <= 2; ++dy) {
+            for (int dx = -2; dx <= 2; ++dx) {
+                const int x = cx + dx, y = cy + dy;
+                if (x >= 0 && y >= 0 && x < width && y < height)
+                    f.pixels[static_cast<size_t>(y) * stride + x] = static_cast<uint16_t>(65535 - 300 * (dx * dx + dy * dy));
+            }
+        }
+    }
+    return f;
+}
+
+// 逐像素暴力统计矩形 [x0,x1)×[y0,y1)
+image::RegionStats bruteForce(const Frame& f, image::CfaLayout cfa, int bins, int x0, int y0, int x1, int y1)
+{
+    static const int maps[5][4] = {{0, 0, 0, 0}, {0, 1, 2, 3}, {1, 0, 3, 2}, {1, 3, 0, 2}, {3, 1, 2, 0}};
+    const int* map = maps[static_cast<int>(cfa)];
+    image::RegionStats s;
+    s.reset(cfa == image::CfaLayout::Mono ? 1 : 4, bins);
+    const int shift = 16 - static_cast<int>(std::log2(bins));
+    for (int y = y0; y < y1; ++y) {
+        for (int x = x0; x < x1; ++x) {
+            const uint16_t v = f.pixels[static_cast<size_t>(y) * f.stride + x];
+            const int c = map[(x & 1) + 2 * (y & 1)];
+            image::ChannelStats one;
+            one.count = 1;
+            one.sum = v;
+            one.sumSq = static_cast<uint64_t>(v) * v;
+            one.minValue = one.maxValue = v;
+            s.channel[c].merge(one);
+            ++s.histogram[static_cast<size_t>(c) * bins + (v >> shift)];
+        }
+    }
+    return s;
+}
+
+bool sameStats(const image::RegionStats& a, const image::RegionStats& b)
+{
+    if (a.channels != b.channels || a.bins != b.bins || a.histogram != b.histogram)
+        return false;
+    for (int c = 0; c < a.channels; ++c) {
+        const auto& x = a.channel[c];
+        const auto& y = b.channel[c];
+        if (x.count != y.count || x.sum != y.sum || x.sumSq != y.sumSq || x.minValue != y.minValue ||
+            x.maxValue != y.maxValue)
+            return false;
+    }
+    return true;
+}
+
+void testExactness()
+{
+    std::cout << "[per-tile / merged stats vs brute force]" << std::endl;
+    const double level[4] = {1200, 2000, 2000, 1500};
+    // 非整瓦片尺寸、奇数宽、带行跨距
+    const Frame f = makeFrame(1301, 777, 1320, level, 1);
+    image::TileStatsOptions opts;
+    opts.tileSize = 128;
+    image::TileStatsGrid grid;
+    check(grid.build(f.pixels.data(), f.width, f.height, f.stride, image::CfaLayout::RGGB, opts), "build");
+    check(grid.tilesX() == 11 && grid.tilesY() == 7 && grid.levels() == 5,
+          "tiles " + std::to_string(grid.tilesX()) + "x" + std::to_string(grid.tilesY()) + ", levels " +
+              std::to_string(grid.levels()));
+
+    const auto all = bruteForce(f, image::CfaLayout::RGGB, grid.bins(), 0, 0, f.width, f.height);
+    check(sameStats(grid.global(), all), "global == brute force (counts, sums, min/max, histogram)");
+    check(sameStats(grid.tile(10, 6), bruteForce(f, image::CfaLayout::RGGB, grid.bins(), 1280, 768, 1301, 777)),
+          "edge tile == brute force");
+
+    // 视口：向外取整到整瓦片
+    bool regionsOk = true;
+    const int rects[][4] = {{0, 0, 1301, 777}, {130, 140, 300, 200}, {500, 0, 1, 1}, {1200, 700, 500, 500}, {-50, -50, 200, 130}};
+    for (const auto& r : rects) {
+        const int T = opts.tileSize;
+        const int x0 = std::max(0, r[0]) / T * T, y0 = std::max(0, r[1]) / T * T;
+        const int x1 = std::min(f.width, ((std::min(f.width, r[0] + r[2]) - 1) / T + 1) * T);
+        const int y1 = std::min(f.height, ((std::min(f.height, r[1] + r[3]) - 1) / T + 1) * T);
+        if (!sameStats(grid.region(r[0], r[1], r[2], r[3]), bruteForce(f, image::CfaLayout::RGGB, grid.bins(), x0, y0, x1, y1)))
+            regionsOk = false;
+    }
+    check(regionsOk, "viewport regions == brute force over covering tiles");
+    check(grid.region(5000, 5000, 10, 10).empty(), "viewport outside the image is empty");
+
+    image::TileStatsOptions one = opts;
+    one.threads = 1;
+    image::TileStatsGrid serial;
+    serial.build(f.pixels.data(), f.width, f.height, f.stride, image::CfaLayout::RGGB, one);
+    check(sameStats(serial.global(), grid.global()), "1 thread == N threads");
+
+    const double median = grid.global().percentile(image::ChannelG1, 0.5);
+    check(std::fabs(median - 2000.0) < 40.0, "G1 median " + std::to_string(median));
+}
+
+void testStretch()
+{
+    std::cout << "[auto stretch]" << std::endl;
+    const double level[4] = {3000, 3000, 3000, 3000};
+    const Frame f = makeFrame(1024, 768, 1024, level, 2, 20);
+    image::TileStatsGrid grid;
+    grid.build(f.pixels.data(), f.width, f.height, f.stride, image::CfaLayout::Mono);
+
+    // 旧 calculateGPM / GetAutoStretch(mode=0)：mean−3σ / mean+5σ，σ 为全图标准差
+    const auto all = grid.global().combined();
+    const double mean = all.mean(), sd = all.stdDev();
+    const auto levels = image::autoStretch(grid.global());
+    check(levels.black == std::llround(std::max(0.0, mean - 3 * sd)) &&
+              levels.white == std::llround(std::min(65535.0, mean + 5 * sd)),
+          "mono black/white " + std::to_string(levels.black) + "/" + std::to_string(levels.white));
+
+    // 彩色：通道电平差不应拉大 σ
+    const double bayer[4] = {1000, 3000, 3000, 2000};
+    const Frame c = makeFrame(1024, 768, 1024, bayer, 3, 0);
+    image::TileStatsGrid colour;
+    colour.build(c.pixels.data(), c.width, c.height, c.stride, image::CfaLayout::RGGB);
+    double m = 0, s = 0;
+    image::displayMeanStdDev(colour.global(), &m, &s);
+    check(std::fabs(m - 2250.0) < 30.0 && s < colour.global().combined().stdDev() * 0.5,
+          "colour display mean " + std::to_string(m) + ", sigma " + std::to_string(s) + " (raw " +
+              std::to_string(colour.global().combined().stdDev()) + ")");
+
+    std::vector<uint16_t> bright(256 * 256, 60000);
+    image::TileStatsGrid sat;
+    sat.build(bright.data(), 256, 256, 256, image::CfaLayout::Mono);
+    const auto satLevels = image::autoStretch(sat.global());
+    check(satLevels.white == 65535 && satLevels.black <= 32767, "saturated frame keeps a bright window");
+}
+
+void testWhiteBalance()
+{
+    std::cout << "[white balance]" << std::endl;
+    const double wanted[4] = {1200, 2000, 2000, 1600};  // R G1 G2 B
+    const struct { const char* name; image::CfaLayout cfa; int map[4]; } layouts[] = {
+        {"RGGB", image::CfaLayout::RGGB, {0, 1, 2, 3}},
+        {"GRBG", image::CfaLayout::GRBG, {1, 0, 3, 2}},
+        {"GBRG", image::CfaLayout::GBRG, {1, 3, 0, 2}},
+        {"BGGR", image::CfaLayout::BGGR, {3, 1, 2, 0}},
+    };
+    const uint16_t offset = 200;
+    for (const auto& l : layouts) {
+        double phase[4];
+        for (int p = 0; p < 4; ++p)
+            phase[p] = wanted[l.map[p]] + offset;
+        const Frame f = makeFrame(1024, 768, 1024, phase, 4);
+        image::TileStatsGrid grid;
+        grid.build(f.pixels.data(), f.width, f.height, f.stride, image::cfaLayoutFromName(l.name));
+        const auto wb = image::whiteBalance(grid.global(), offset);
+        const double er = wb.gainR / (2000.0 / 1200.0) - 1.0, eb = wb.gainB / (2000.0 / 1600.0) - 1.0;
+        check(wb.applied && std::fabs(er) < 0.02 && std::fabs(eb) < 0.02,
+              std::string(l.name) + " gains " + std::to_string(wb.gainR) + "/" + std::to_string(wb.gainB));
+    }
+
+    const double unbalanced[4] = {1200, 2000, 2600, 1600};
+    const Frame bad = makeFrame(512, 512, 512, unbalanced, 5);
+    image::TileStatsGrid grid;
+    grid.build(bad.pixels.data(), bad.width, bad.height, bad.stride, image::CfaLayout::RGGB);
+    const auto wb = image::whiteBalance(grid.global());
+    check(!wb.applied && wb.gainR == 1.0 && wb.gainB == 1.0, "G1/G2 mismatch skipped (" + wb.reason + ")");
+
+    image::TileStatsGrid mono;
+    mono.build(bad.pixels.data(), bad.width, bad.height, bad.stride, image::cfaLayoutFromName("null"));
+    check(!image::whiteBalance(mono.global()).applied && mono.channels() == 1, "mono has no white balance");
+}
+
+void testThroughput()
+{
+    std::cout << "[throughput]" << std::endl;
+    const double level[4] = {1200, 2000, 2000, 1500};
+    const Frame f = makeFrame(6252, 4176, 6252, level, 6);  // 26MP
+    image::TileStatsGrid grid;
+    auto t0 = std::chrono::steady_clock::now();
+    grid.build(f.pixels.data(), f.width, f.height, f.stride, image::CfaLayout::RGGB);
+    const double buildMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+
+    t0 = std::chrono::steady_clock::now();
+    double sink = 0.0;
+    for (int i = 0; i < 100; ++i) {
+        const auto r = grid.region(37 * i, 23 * i, 2400, 1350);
+        sink += image::autoStretch(r).white + image::whiteBalance(r).gainR;
+    }
+    const double regionUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count() / 100.0;
+    check(sink > 0.0, "26MP grid " + std::to_string(grid.tilesX()) + "x" + std::to_string(grid.tilesY()) + " built in " +
+                          std::to_string(buildMs) + " ms, " + std::to_string(grid.bytes() / 1024) + " KiB");
+    check(regionUs < 5000.0, "viewport stretch+WB " + std::to_string(regionUs) + " us");
+}
+
+} // namespace
+
+int main()
+{
+    testExactness();
+    testStretch();
+    testWhiteBalance();
+    testThroughput();
+    return test_util::finish();
+}
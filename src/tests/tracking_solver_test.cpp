@@ -0,0 +1,216 @@
+// tracking_solver_test.cpp
+// solver::TrackingSession 自检：星表/自举参考星两种锚定、平移+旋转后的跟踪精度与耗时、
+// 天极附近、无关星场必须拒绝（不能给出错误解）
+//
+// 用法：tracking_solver_test
+// 任一检查失败返回 1
+
+#include "../solver/TrackingSolver.h"
+#include "test_util.h"
+
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <string>
+
+using test_util::check;
+
+namespace {
+
+// 天球单位向量与 Rodrigues 旋转
+struct Vec3 {
+    double x, y, z;
+};
+
+Vec3 toVec(double raDeg, double decDeg)
+{
+    const double ra = raDeg * M_PI / 180.0, dec = decDeg * M_PI / 180.0;
+    return {std::cos(dec) * std::cos(ra), std::cos(dec) * std::sin(ra), std::sin(dec)};
+}
+
+solver::SkyPoint toSky(const Vec3& v)
+{
+    double ra = std::atan2(v.y, v.x) * 180.0 / M_PI;
+    if (ra < 0)
+        ra += 360.0;
+    return {ra, std::asin(std::max(-1.0, std::min(1.0, v.z))) * 180.0 / M_PI};
+}
+
+Vec3 rotate(const Vec3& v, Vec3 k, double angle)
+{
+    const double n = std::sqrt(k.x * k.x + k.y * k.y + k.z * k.z);
+    if (n < 1e-15)
+        return v;
+    k = {k.x / n, k.y / n, k.z / n};
+    const double c = std::cos(angle), s = std::sin(angle), d = k.x * v.x + k.y * v.y + k.z * v.z;
+    const Vec3 cr = {k.y * v.z - k.z * v.y, k.z * v.x - k.x * v.z, k.x * v.y - k.y * v.x};
+    return {v.x * c + cr.x * s + k.x * d * (1 - c), v.y * c + cr.y * s + k.y * d * (1 - c), v.z * c + cr.z * s + k.z * d * (1 - c)};
+}
+
+// 相机随赤道仪刚性转动：画面中心移到 (cx+dx, cy+dy) 原来看到的天区，并绕视轴滚转 rollDeg。
+// 刚体旋转把以 T 为切点的 TAN 映射成以 R·T 为切点的 TAN，CD 由两条像素基线精确求出
+solver::TanWcs moveRigid(const solver::TanWcs& prev, double dx, double dy, double rollDeg)
+{
+    const Vec3 c0 = toVec(prev.crval[0], prev.crval[1]);
+    const auto target = prev.pixelToSky(prev.crpix[0] + dx, prev.crpix[1] + dy);
+    const Vec3 c1 = toVec(target.raDeg, target.decDeg);
+    const Vec3 axis = {c0.y * c1.z - c0.z * c1.y, c0.z * c1.x - c0.x * c1.z, c0.x * c1.y - c0.y * c1.x};
+    const double angle = solver::angularSeparationDeg(prev.crval[0], prev.crval[1], target.raDeg, target.decDeg) * M_PI / 180.0;
+    auto apply = [&](const solver::SkyPoint& p) {
+        return toSky(rotate(rotate(toVec(p.raDeg, p.decDeg), axis, angle), c1, rollDeg * M_PI / 180.0));
+    };
+    solver::TanWcs next = prev;
+    next.crval[0] = target.raDeg;
+    next.crval[1] = target.decDeg;
+    solver::TanWcs frame;
+    frame.crval[0] = target.raDeg;
+    frame.crval[1] = target.decDeg;
+    frame.cd[0][0] = frame.cd[1][1] = 1.0;
+    const double base = 100.0;
+    for (int axisIdx = 0; axisIdx < 2; ++axisIdx) {
+        const auto p = apply(prev.pixelToSky(prev.crpix[0] + (axisIdx == 0 ? base : 0), prev.crpix[1] + (axisIdx == 1 ? base : 0)));
+        double u = 0, v = 0;
+        frame.skyToPixel(p.raDeg, p.decDeg, &u, &v);
+        next.cd[0][axisIdx] = u / base;
+        next.cd[1][axisIdx] = v / base;
+    }
+    return next;
+}
+
+// 在 (ra,dec) 周围 radius 内随机撒星（星等 4~11，越暗越多）
+solver::StarCatalog makeCatalog(double ra, double dec, double radiusDeg, int count, uint32_t seed)
+{
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> u(-1.0, 1.0);
+    std::uniform_real_distribution<double> m(0.0, 1.0);
+    const auto frame = solver::TanWcs::fromSolution(ra, dec, 0.0, 3600.0, false, 2, 2);
+    solver::StarCatalog cat;
+    for (int i = 0; i < count; ++i) {
+        double x = 0, y = 0;
+        do {
+            x = u(rng);
+            y = u(rng);
+        } while (x * x + y * y > 1.0);
+        // fromSolution 的尺度为 1 度/像素，中心像素 1.5
+        const auto p = frame.pixelToSky(1.5 + x * radiusDeg, 1.5 + y * radiusDeg);
+        cat.add({p.raDeg, p.decDeg, 4.0 + 7.0 * std::pow(m(rng), 0.35)});
+    }
+    return cat;
+}
+
+// 按真实 WCS 生成检测星表：0 基坐标、位置噪声、漏检、假星
+solver::XyList observe(const solver::StarCatalog& cat, const solver::TanWcs& truth, double ra, double dec, uint32_t seed)
+{
+    std::mt19937 rng(seed);
+    std::normal_distribution<double> noise(0.0, 0.25);
+    std::uniform_real_distribution<double> m(0.0, 1.0);
+    std::vector<solver::XyStar> stars;
+    for (const auto& s : cat.cone(ra, dec, 30.0)) {
+        double x = 0, y = 0;
+        if (!truth.skyToPixel(s.raDeg, s.decDeg, &x, &y))
+            continue;
+        if (m(rng) < 0.15)
+            continue;
+        stars.push_back({x - 1.0 + noise(rng), y - 1.0 + noise(rng), std::pow(10.0, -0.4 * (s.mag - 12.0))});
+    }
+    for (int i = 0; i < 15; ++i)
+        stars.push_back({m(rng) * truth.imageWidth, m(rng) * truth.imageHeight, m(rng) * 5.0});
+    return solver::prepareXyList(stars, truth.imageWidth, truth.imageHeight, 200);
+}
+
+void testCatalogTracking(const char* label, double ra, double dec, double scaleArcsec, int w, int h)
+{
+    std::cout << "[" << label << "]" << std::endl;
+    const double fovDeg = std::hypot(w, h) * scaleArcsec / 3600.0;
+    const auto cat = makeCatalog(ra, dec, fovDeg * 1.5, 2500, 7);
+    const auto anchorWcs = solver::TanWcs::fromSolution(ra, dec, 25.0, scaleArcsec, false, w, h);
+
+    solver::TrackingSession session;
+    session.anchor(anchorWcs, solver::XyList(), &cat);
+    check(session.usingCatalog() && session.referenceCount() >= 50, "anchored on catalog patch (" +
+                                                                         std::to_string(session.referenceCount()) + " refs)");
+
+    // 每帧在像素面内漂移几十像素并带 0.4° 旋转（调极轴时画面的实际运动）
+    double maxCenterErrArcsec = 0.0, maxCornerErrPx = 0.0, maxMs = 0.0;
+    bool allOk = true;
+    solver::TanWcs truth = anchorWcs;
+    for (int frame = 1; frame <= 6; ++frame) {
+        truth = moveRigid(truth, 37.0 * (frame % 2 ? 1 : -0.6), 21.0, 0.4);
+        const auto r = session.track(observe(cat, truth, truth.crval[0], truth.crval[1], 100 + frame));
+        if (!r.ok) {
+            check(false, "frame " + std::to_string(frame) + ": " + r.error);
+            allOk = false;
+            break;
+        }
+        const auto center = r.wcs.pixelToSky(truth.crpix[0], truth.crpix[1]);
+        maxCenterErrArcsec = std::max(maxCenterErrArcsec,
+                                      solver::angularSeparationDeg(center.raDeg, center.decDeg, truth.crval[0], truth.crval[1]) * 3600.0);
+        // 天极附近方向角对中心位置极敏感，改用四角的像素误差衡量
+        for (double x : {1.0, double(w)}) {
+            for (double y : {1.0, double(h)}) {
+                const auto p = truth.pixelToSky(x, y);
+                double fx = 0, fy = 0;
+                r.wcs.skyToPixel(p.raDeg, p.decDeg, &fx, &fy);
+                maxCornerErrPx = std::max(maxCornerErrPx, std::hypot(fx - x, fy - y));
+            }
+        }
+        maxMs = std::max(maxMs, r.elapsedMs);
+    }
+    if (allOk) {
+        check(maxCenterErrArcsec < 0.2 * scaleArcsec, "center error " + std::to_string(maxCenterErrArcsec) + " arcsec");
+        check(maxCornerErrPx < 0.3, "corner error " + std::to_string(maxCornerErrPx) + " px");
+        check(maxMs < 100.0, "per-frame " + std::to_string(maxMs) + " ms");
+    }
+}
+
+void testBootstrapAndReject()
+{
+    std::cout << "[bootstrap / reject]" << std::endl;
+    const double ra = 120.0, dec = 30.0, scale = 2.0;
+    const int w = 1600, h = 1200;
+    const auto cat = makeCatalog(ra, dec, 2.0, 3000, 11);
+    const auto anchorWcs = solver::TanWcs::fromSolution(ra, dec, -70.0, scale, true, w, h);
+
+    // 没有星表：用锚定帧自身星点作参考
+    solver::TrackingSession session;
+    session.anchor(anchorWcs, observe(cat, anchorWcs, ra, dec, 1), nullptr);
+    check(!session.usingCatalog() && session.referenceCount() >= 50, "anchored on own stars");
+    const auto truth = moveRigid(anchorWcs, -55.0, 80.0, 1.0);
+    const solver::SkyPoint moved{truth.crval[0], truth.crval[1]};
+    const auto r = session.track(observe(cat, truth, moved.raDeg, moved.decDeg, 2));
+    check(r.ok, "bootstrap track " + r.error);
+    if (r.ok) {
+        const auto c = r.wcs.pixelToSky(truth.crpix[0], truth.crpix[1]);
+        const double err = solver::angularSeparationDeg(c.raDeg, c.decDeg, moved.raDeg, moved.decDeg) * 3600.0;
+        check(err < 1.0 && r.wcs.mirrored(), "bootstrap center error " + std::to_string(err) + " arcsec, parity kept");
+        check(std::fabs(r.shiftPx - std::hypot(55.0, 80.0)) < 2.0, "reported shift " + std::to_string(r.shiftPx) + " px");
+    }
+
+    // 完全不相干的星场：必须失败，交给完整解析
+    const auto farCat = makeCatalog(300.0, -40.0, 2.0, 3000, 13);
+    const auto farTruth = solver::TanWcs::fromSolution(300.0, -40.0, 10.0, scale, false, w, h);
+    solver::XyList unrelated = observe(farCat, farTruth, 300.0, -40.0, 3);
+    unrelated.imageWidth = w;
+    unrelated.imageHeight = h;
+    const auto bad = session.track(unrelated);
+    check(!bad.ok, "unrelated field rejected (" + bad.error + ")");
+
+    check(!session.needsFullSolve(), "no full solve needed right after tracking");
+    solver::TrackingOptions opts;
+    opts.reanchorEvery = 1;
+    solver::TrackingSession limited(opts);
+    limited.anchor(anchorWcs, observe(cat, anchorWcs, ra, dec, 1), nullptr);
+    limited.track(observe(cat, truth, moved.raDeg, moved.decDeg, 2));
+    check(limited.needsFullSolve(), "reanchorEvery forces a full solve");
+}
+
+} // namespace
+
+int main()
+{
+    testCatalogTracking("main scope 1.2\"/px", 83.82, -5.39, 1.2, 3000, 2000);
+    testCatalogTracking("polemaster near pole 40\"/px", 37.95, 89.26, 40.0, 1280, 960);
+    testBootstrapAndReject();
+    return test_util::finish();
+}
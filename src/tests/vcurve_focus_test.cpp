@@ -0,0 +1,202 @@
+// vcurve_focus_test.cpp
+// focus::fitHyperbola / AdaptiveFocusSampler 自检：双曲线拟合与不确定度、临界焦区换算、
+// 自适应采样在带噪声的模拟 V 曲线上用的点数少于原 9 点固定网格且最佳位置误差不变差
+//
+// 用法：vcurve_focus_test
+// 任一检查失败返回 1
+
+#include "../focus/VCurveFocus.h"
+#include "test_util.h"
+
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace focus;
+
+using test_util::check;
+
+namespace {
+
+double curve(double a, double b, double c, double x)
+{
+    const double u = (x - c) / b;
+    return a * std::sqrt(1.0 + u * u);
+}
+
+void testFit()
+{
+    std::cout << "[fit]" << std::endl;
+    std::vector<FocusSample> pts;
+    for (int k = -4; k <= 4; ++k)
+        pts.push_back({20000.0 + k * 50.0, curve(2.0, 120.0, 20037.0, 20000.0 + k * 50.0)});
+    const HyperbolaFit exact = fitHyperbola(pts);
+    check(exact.ok && std::abs(exact.c - 20037.0) < 1e-3 && std::abs(exact.a - 2.0) < 1e-6 &&
+              std::abs(exact.b - 120.0) < 1e-3,
+          "exact V curve recovered at large focuser positions");
+    check(exact.sigmaC < 1e-3 && exact.rms < 1e-6, "no residual -> no uncertainty");
+
+    double pa = 0.0, pb = 0.0, pc = 0.0;
+    exact.toParabola(pa, pb, pc);
+    const double vertex = -pb / (2.0 * pa);
+    check(std::abs(vertex - exact.c) < 1e-6 && std::abs(pa * vertex * vertex + pb * vertex + pc - exact.a) < 1e-6,
+          "osculating parabola shares the vertex");
+    check(std::abs(exact.toleranceZoneSteps(0.1) - 2.0 * 120.0 * std::sqrt(0.21)) < 1e-3,
+          "tolerance zone from the model width");
+
+    std::mt19937 rng(7);
+    std::normal_distribution<double> noise(0.0, 0.03);
+    int inside = 0;
+    const int trials = 200;
+    for (int t = 0; t < trials; ++t) {
+        std::vector<FocusSample> noisy;
+        for (const FocusSample& p : pts)
+            noisy.push_back({p.position, p.hfr * (1.0 + noise(rng))});
+        const HyperbolaFit f = fitHyperbola(noisy);
+        if (f.ok && std::abs(f.c - 20037.0) <= 2.0 * f.sigmaC)
+            ++inside;
+    }
+    check(inside > trials * 0.85, "2-sigma interval covers the true focus (" + std::to_string(inside) + "/200)");
+
+    std::vector<FocusSample> few(pts.begin(), pts.begin() + 3);
+    few.push_back({20100.0, 0.0});   // 无效点不计入
+    check(!fitHyperbola(few).ok, "fewer than 4 valid points -> not ok");
+
+    check(std::abs(criticalFocusZoneSteps(5.0, 1.0) - 4.88 * 0.55 * 25.0) < 1e-9, "CFZ = 4.88 lambda F^2");
+    check(criticalFocusZoneSteps(0.0, 1.0) == 0.0, "CFZ needs optics");
+}
+
+struct RunResult {
+    int attempts{0};
+    double error{0.0};
+    AdaptiveFocusSampler::Decision decision{AdaptiveFocusSampler::Decision::Sample};
+};
+
+RunResult runAdaptive(double trueC, double noiseLevel, std::mt19937& rng, double zone = 0.0)
+{
+    std::normal_distribution<double> noise(0.0, noiseLevel);
+    AdaptiveFocusSampler sampler;
+    AdaptiveFocusSampler::Options opt;
+    opt.center = 10000.0;
+    opt.step = 50.0;
+    opt.minPosition = 0.0;
+    opt.maxPosition = 60000.0;
+    opt.criticalZoneSteps = zone;
+    sampler.reset(opt);
+
+    RunResult r;
+    double pos = 0.0;
+    for (;;) {
+        r.decision = sampler.next(pos);
+        if (r.decision != AdaptiveFocusSampler::Decision::Sample)
+            break;
+        sampler.addSample(pos, curve(2.0, 150.0, trueC, pos) * (1.0 + noise(rng)));
+    }
+    r.attempts = sampler.attempts();
+    r.error = sampler.fit().ok ? std::abs(sampler.fit().c - trueC) : 1e9;
+    return r;
+}
+
+double runFixedGrid(double trueC, double noiseLevel, std::mt19937& rng)
+{
+    std::normal_distribution<double> noise(0.0, noiseLevel);
+    std::vector<FocusSample> pts;
+    for (int k = -4; k <= 4; ++k) {
+        const double x = 10000.0 + k * 50.0;
+        pts.push_back({x, curve(2.0, 150.0, trueC, x) * (1.0 + noise(rng))});
+    }
+    const HyperbolaFit f = fitHyperbola(pts);
+    return f.ok ? std::abs(f.c - trueC) : 1e9;
+}
+
+void testSampler()
+{
+    std::cout << "[sampler]" << std::endl;
+    std::mt19937 rng(11);
+    std::uniform_real_distribution<double> offset(-100.0, 100.0);
+    const int trials = 300;
+    int adaptiveShots = 0;
+    int converged = 0;
+    double adaptiveErr = 0.0;
+    double gridErr = 0.0;
+    int withinStep = 0;
+    for (int t = 0; t < trials; ++t) {
+        const double c = 10000.0 + offset(rng);
+        const RunResult r = runAdaptive(c, 0.02, rng);
+        adaptiveShots += r.attempts;
+        adaptiveErr += r.error;
+        gridErr += runFixedGrid(c, 0.02, rng);
+        if (r.decision == AdaptiveFocusSampler::Decision::Converged)
+            ++converged;
+        if (r.error < 50.0)
+            ++withinStep;
+    }
+    const double meanShots = static_cast<double>(adaptiveShots) / trials;
+    std::cout << "  adaptive " << meanShots << " points, mean error " << adaptiveErr / trials
+              << " steps; fixed grid 9 points, mean error " << gridErr / trials << " steps" << std::endl;
+    check(meanShots < 8.0, "adaptive placement needs fewer points than the 9-point grid");
+    check(converged > trials * 0.8, "most runs stop on the confidence rule");
+    check(adaptiveErr / trials < 1.5 * gridErr / trials + 2.0, "best-position error comparable to the full grid");
+    check(withinStep > trials * 0.97, "best position within one step");
+
+    int noisyShots = 0;
+    for (int t = 0; t < 100; ++t)
+        noisyShots += runAdaptive(10000.0 + offset(rng), 0.10, rng).attempts;
+    std::cout << "  10% noise: " << noisyShots / 100.0 << " points" << std::endl;
+    check(noisyShots > 100 * meanShots && noisyShots <= 100 * 9, "noisier curves take more points, never over budget");
+
+    const RunResult strict = runAdaptive(10020.0, 0.02, rng, 0.01);
+    check(strict.decision == AdaptiveFocusSampler::Decision::Exhausted && strict.attempts == 9,
+          "unreachable zone -> stops at the sample budget");
+
+    // 焦点离中心 5 步：先向外找坡
+    AdaptiveFocusSampler far;
+    AdaptiveFocusSampler::Options opt;
+    opt.center = 10000.0;
+    opt.step = 50.0;
+    opt.minPosition = 0.0;
+    opt.maxPosition = 60000.0;
+    far.reset(opt);
+    double pos = 0.0;
+    std::vector<double> visited;
+    while (far.next(pos) == AdaptiveFocusSampler::Decision::Sample) {
+        visited.push_back(pos);
+        far.addSample(pos, curve(2.0, 150.0, 10250.0, pos));
+    }
+    bool expandedRight = false;
+    for (double p : visited)
+        expandedRight = expandedRight || p > 10100.0;
+    check(expandedRight && far.fit().ok && std::abs(far.fit().c - 10250.0) < 1.0, "off-center focus is bracketed");
+
+    // 无效点占用名额但不重复采
+    AdaptiveFocusSampler bad;
+    bad.reset(opt);
+    std::vector<double> tried;
+    while (bad.next(pos) == AdaptiveFocusSampler::Decision::Sample) {
+        tried.push_back(pos);
+        bad.addSample(pos, 0.0);
+    }
+    check(bad.attempts() == 3 && std::string(bad.reason()) == "no valid HFR", "all-invalid run ends after the start points");
+
+    AdaptiveFocusSampler edge;
+    opt.center = 30.0;
+    opt.maxPosition = 1000.0;
+    edge.reset(opt);
+    bool inRange = true;
+    while (edge.next(pos) == AdaptiveFocusSampler::Decision::Sample) {
+        inRange = inRange && pos >= 0.0 && pos <= 1000.0;
+        edge.addSample(pos, curve(2.0, 150.0, 0.0, pos));
+    }
+    check(inRange && edge.attempts() <= 9, "positions stay inside the focuser range");
+}
+
+} // namespace
+
+int main()
+{
+    testFit();
+    testSampler();
+    return test_util::finish();
+}
@@ -0,0 +1,270 @@
+// virtual_rig_test.cpp
+// sim::VirtualRig 自检（假时钟快进）：电调插值/中止/速度档/反向/V 曲线、滤镜轮转动中无位置与到位时间、
+// 单帧曝光剩余时间与读出、ROI/Bin 尺寸、焦点处星像更锐、Live 节拍与不补发积压帧、制冷收敛、
+// 帧尺寸解析与环境变量配置，最后用真实时钟打印默认主相机单帧渲染吞吐
+//
+// 用法：virtual_rig_test [frames]
+// 任一检查失败返回 1
+
+#include "../sim/VirtualRig.h"
+#include "test_util.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace sim;
+
+using test_util::check;
+
+namespace {
+
+struct FakeClock {
+    double now{1000.0};
+    ClockMs fn() { return [this]() { return now; }; }
+};
+
+VirtualRigConfig smallConfig()
+{
+    VirtualRigConfig config = VirtualRigConfig::defaults();
+    config.cameras[0].width = 640;
+    config.cameras[0].height = 480;
+    config.cameras[0].starCount = 60;
+    config.cameras[1].width = 320;
+    config.cameras[1].height = 240;
+    return config;
+}
+
+uint16_t peakOf(const std::vector<uint16_t>& img)
+{
+    return *std::max_element(img.begin(), img.end());
+}
+
+void testFocuser()
+{
+    std::cout << "[focuser]" << std::endl;
+    FakeClock clock;
+    VirtualFocuser::Params params;
+    params.stepsPerSec = 1000.0;
+    params.startPosition = 1000;
+    VirtualFocuser f(params, clock.fn());
+
+    check(f.position() == 1000 && !f.moving(), "starts at startPosition, idle");
+    f.moveTo(2000);
+    clock.now += 250.0;
+    check(f.position() == 1250 && f.moving(), "interpolates 250 steps after 250 ms");
+    f.abort();
+    clock.now += 1000.0;
+    check(f.position() == 1250 && !f.moving(), "abort stops at interpolated position");
+
+    f.setSpeed(1);
+    check(f.speed() == 1, "speed stored");
+    f.moveBy(100);
+    clock.now += 100.0;
+    check(f.position() == 1300, "speed 1 halves the rate (50 steps / 100 ms)");
+    clock.now += 1000.0;
+    check(f.position() == 1350 && !f.moving(), "relative move arrives");
+
+    f.setReverse(true);
+    f.moveBy(100);
+    clock.now += 1000.0;
+    check(f.position() == 1250, "reverse flips relative direction");
+    f.setSpeed(42);
+    check(f.speed() == 8, "speed clamps to 8");
+
+    f.sync(5000);
+    check(f.position() == 5000 && !f.moving(), "sync rewrites position without moving");
+
+    const double best = f.hfrAt(params.bestPosition);
+    check(std::fabs(best - params.hfrMinPx) < 1e-9, "HFR minimum at best focus");
+    check(std::fabs(f.hfrAt(params.bestPosition + 500) - f.hfrAt(params.bestPosition - 500)) < 1e-9,
+          "V curve symmetric");
+    check(f.hfrAt(params.bestPosition + 2000) > f.hfrAt(params.bestPosition + 500), "HFR grows with defocus");
+}
+
+void testFilterWheel()
+{
+    std::cout << "[filter wheel]" << std::endl;
+    FakeClock clock;
+    VirtualFilterWheel w(7, 400.0, clock.fn());
+    check(w.position() == 0 && !w.moving(), "starts at slot 0");
+    check(!w.setPosition(7) && !w.setPosition(-1), "out-of-range rejected");
+    check(w.setPosition(3), "set slot 3");
+    clock.now += 1000.0;
+    check(w.position() == -1 && w.moving(), "reports -1 while turning");
+    clock.now += 200.0;
+    check(w.position() == 3 && !w.moving(), "arrives after 3 slots x 400 ms");
+    w.setPosition(1);
+    clock.now += 5 * 400.0 - 1.0;
+    check(w.position() == -1, "turns one way only (3 -> 1 is 5 slots)");
+    clock.now += 1.0;
+    check(w.position() == 1, "arrives at slot 1");
+    check(w.throughput(0) == 1.0 && w.throughput(4) < 0.1 && w.throughput(9) == 1.0, "throughput table");
+}
+
+void testCamera()
+{
+    std::cout << "[camera]" << std::endl;
+    FakeClock clock;
+    VirtualRig rig(smallConfig(), clock.fn());
+    check(rig.cameraCount() == 2, "two cameras");
+    VirtualCamera* cam = rig.cameraById("QHY268M-SIM0001");
+    check(cam != nullptr && cam == rig.camera(0), "lookup by id");
+    check(rig.cameraById("nope") == nullptr && rig.camera(5) == nullptr, "unknown camera is null");
+    check(cam->filterWheel() == &rig.filterWheel(), "main camera owns the wheel");
+    check(rig.camera(1)->filterWheel() == nullptr, "guider has no wheel");
+
+    cam->setExposureUs(2e6);
+    const double readout = cam->readoutMs();
+    check(readout > 0.0, "readout time positive");
+    std::vector<uint16_t> img(cam->frameBytes() / sizeof(uint16_t));
+    VirtualCamera::Frame frame;
+    check(!cam->readSingleFrame(img.data(), &frame), "read without exposure fails");
+    cam->startExposure();
+    check(cam->exposing() && std::fabs(cam->remainingMs() - (2000.0 + readout)) < 1e-6,
+          "remaining = exposure + readout");
+    clock.now += 1500.0;
+    check(!cam->readSingleFrame(img.data(), &frame), "read before end fails");
+    clock.now += 600.0;
+    check(cam->remainingMs() == 0.0, "remaining reaches 0");
+    check(cam->readSingleFrame(img.data(), &frame) && frame.width == 640 && frame.height == 480 && frame.index == 1,
+          "single frame read");
+    check(!cam->exposing() && !cam->readSingleFrame(img.data(), &frame), "frame consumed once");
+
+    cam->startExposure();
+    cam->cancelExposure();
+    clock.now += 5000.0;
+    check(!cam->readSingleFrame(img.data(), &frame), "cancelled exposure yields no frame");
+
+    check(!cam->setRoi(600, 0, 100, 100), "ROI out of bounds rejected");
+    check(cam->setRoi(100, 50, 400, 300) && cam->setBin(2, 2), "ROI + bin 2");
+    check(cam->outputWidth() == 200 && cam->outputHeight() == 150 && cam->frameBytes() == 200u * 150u * 2u,
+          "output size follows ROI / bin");
+    check(!cam->setBin(5, 5), "bin > 4 rejected");
+    cam->setRoi(0, 0, 640, 480);
+    cam->setBin(1, 1);
+
+    // 焦点处峰值应明显高于离焦位置
+    VirtualFocuser& focuser = rig.focuser();
+    const int best = focuser.params().bestPosition;
+    focuser.sync(best);
+    img.assign(cam->frameBytes() / sizeof(uint16_t), 0);
+    cam->startExposure();
+    clock.now += 3000.0;
+    cam->readSingleFrame(img.data(), &frame);
+    const uint16_t sharp = peakOf(img);
+    focuser.sync(best + 3000);
+    cam->startExposure();
+    clock.now += 3000.0;
+    cam->readSingleFrame(img.data(), &frame);
+    const uint16_t blurred = peakOf(img);
+    check(sharp > 2 * blurred, "in-focus peak " + std::to_string(sharp) + " > 2x defocused " + std::to_string(blurred));
+
+    // 窄带滤镜下背景更暗
+    focuser.sync(best);
+    auto median = [](std::vector<uint16_t> v) {
+        std::nth_element(v.begin(), v.begin() + v.size() / 2, v.end());
+        return v[v.size() / 2];
+    };
+    cam->setOffset(0);
+    cam->startExposure();
+    clock.now += 3000.0;
+    cam->readSingleFrame(img.data(), &frame);
+    const uint16_t bgL = median(img);
+    rig.filterWheel().setPosition(4);
+    clock.now += 10000.0;
+    cam->startExposure();
+    clock.now += 3000.0;
+    cam->readSingleFrame(img.data(), &frame);
+    const uint16_t bgHa = median(img);
+    check(bgHa < bgL, "Ha background " + std::to_string(bgHa) + " < L " + std::to_string(bgL));
+
+    // Live 节拍：max(曝光, 读出)；取帧慢时不补发积压
+    cam->setExposureUs(100e3);
+    cam->beginLive();
+    check(cam->live() && !cam->readLiveFrame(img.data(), &frame), "no live frame before first period");
+    clock.now += 100.0;
+    check(cam->readLiveFrame(img.data(), &frame), "live frame after one period");
+    check(!cam->readLiveFrame(img.data(), &frame), "no second frame within the period");
+    clock.now += 1000.0;
+    check(cam->readLiveFrame(img.data(), &frame), "frame after a long stall");
+    check(!cam->readLiveFrame(img.data(), &frame), "backlog not replayed");
+    cam->stopLive();
+    clock.now += 1000.0;
+    check(!cam->readLiveFrame(img.data(), &frame), "stopped live yields nothing");
+    check(cam->framesRendered() == frame.index, "frame counter matches");
+
+    // 制冷：60s 时间常数，不低于环境 - 40
+    check(std::fabs(cam->temperatureC() - 20.0) < 1e-9 && cam->coolerPowerPercent() == 0.0, "starts at ambient");
+    cam->setCoolerTarget(-10.0);
+    clock.now += 60000.0;
+    const double t1 = cam->temperatureC();
+    check(std::fabs(t1 - (-10.0 + 30.0 * std::exp(-1.0))) < 1e-6, "one time constant reaches 63%");
+    clock.now += 600000.0;
+    check(std::fabs(cam->temperatureC() + 10.0) < 0.01 && cam->coolerPowerPercent() > 70.0, "converges, power up");
+    cam->setCoolerTarget(-80.0);
+    clock.now += 3600000.0;
+    check(std::fabs(cam->temperatureC() + 20.0) < 0.01, "limited to ambient - 40");
+}
+
+void testConfig()
+{
+    std::cout << "[config]" << std::endl;
+    int w = 0, h = 0;
+    check(parseFrameSize("3200x2136", &w, &h) && w == 3200 && h == 2136, "parse WxH");
+    check(parseFrameSize("800X600", &w, &h) && w == 800 && h == 600, "parse upper-case X");
+    check(!parseFrameSize("800", &w, &h) && !parseFrameSize("x600", &w, &h) && !parseFrameSize("800x", &w, &h) &&
+              !parseFrameSize("800x600z", &w, &h) && !parseFrameSize("0x600", &w, &h),
+          "malformed sizes rejected");
+
+    setenv("QUARCS_VO_MAIN_SIZE", "1024x768", 1);
+    setenv("QUARCS_VO_GUIDER_SIZE", "bogus", 1);
+    setenv("QUARCS_VO_BEST_FOCUS", "12345", 1);
+    const VirtualRigConfig config = VirtualRigConfig::fromEnvironment();
+    const VirtualRigConfig defaults = VirtualRigConfig::defaults();
+    check(config.cameras[0].width == 1024 && config.cameras[0].height == 768, "main size from env");
+    check(config.cameras[1].width == defaults.cameras[1].width, "bad guider size ignored");
+    check(config.focuser.bestPosition == 12345, "best focus from env");
+    unsetenv("QUARCS_VO_MAIN_SIZE");
+    unsetenv("QUARCS_VO_GUIDER_SIZE");
+    unsetenv("QUARCS_VO_BEST_FOCUS");
+}
+
+void benchThroughput(int frames)
+{
+    std::cout << "[bench]" << std::endl;
+    VirtualRig rig(VirtualRigConfig::defaults());
+    VirtualCamera* cam = rig.camera(0);
+    cam->setExposureUs(0);
+    std::vector<uint16_t> img(cam->frameBytes() / sizeof(uint16_t));
+    VirtualCamera::Frame frame;
+    const auto t0 = std::chrono::steady_clock::now();
+    int done = 0;
+    for (int i = 0; i < frames; ++i) {
+        cam->startExposure();
+        while (cam->remainingMs() > 0.0) {}
+        if (cam->readSingleFrame(img.data(), &frame))
+            ++done;
+    }
+    const double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    std::cout << "  " << frame.width << "x" << frame.height << ": " << done << " frames in " << sec << " s, "
+              << done / sec << " frames/s (readout model " << cam->readoutMs() << " ms)" << std::endl;
+    check(done == frames, "all bench frames read");
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    const int frames = argc > 1 ? std::max(1, std::atoi(argv[1])) : 5;
+    testFocuser();
+    testFilterWheel();
+    testCamera();
+    testConfig();
+    benchThroughput(frames);
+    return test_util::finish();
+}
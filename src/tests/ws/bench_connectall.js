@@ -0,0 +1,78 @@
+// 启动基准：用 INDI 模拟器反复跑“全部连接”，统计端到端耗时与各设备连接耗时
+// 配置：Mount=indi_simulator_telescope，MainCamera=indi_simulator_ccd，Guider=indi_simulator_guide，
+//       Focuser=indi_simulator_focus，CFW=indi_simulator_wheel（均走 INDI，不需要真实设备）
+// 采集：后端每台设备连完发 ConnectTiming:<设备>:<状态>:<ms>:<尝试次数>，
+//       全部结束发 ConnectAllTiming:<ms>（从收到 connectAllDevice 算起）
+// 用法: node bench_connectall.js <host> [轮数=5]
+// 任一轮未收到 ConnectAllDeviceComplete 或有设备未连上时退出码 1
+const WebSocket = require('/home/q/workspace_origin/QUARCS_stellarium-web-engine/apps/web-frontend/node_modules/ws');
+
+const host = process.argv[2] || '172.24.217.51';
+const rounds = parseInt(process.argv[3] || '5', 10);
+const ws = new WebSocket(`ws://${host}:8600`);
+const send = (c) => ws.send(JSON.stringify({ type: 'Vue_Command', message: c, msgid: 'bench-' + Date.now() }));
+const wait = (ms) => new Promise(r => setTimeout(r, ms));
+
+let log = [];
+ws.on('message', d => { let s = d.toString(); try { const o = JSON.parse(s); if (o && o.message != null) s = String(o.message); } catch (e) {} log.push(s); });
+
+const waitFor = async (re, timeoutMs) => {
+  const deadline = Date.now() + timeoutMs;
+  while (Date.now() < deadline) {
+    if (log.some(x => re.test(x))) return true;
+    await wait(100);
+  }
+  return false;
+};
+
+const median = (xs) => { const s = [...xs].sort((a, b) => a - b); return s.length ? s[Math.floor(s.length / 2)] : NaN; };
+
+const SIMULATORS = [
+  ['indi_simulator_telescope', 0, 'Mount'],
+  ['indi_simulator_guide', 1, 'Guider'],
+  ['indi_simulator_ccd', 20, 'MainCamera'],
+  ['indi_simulator_wheel', 21, 'CFW'],
+  ['indi_simulator_focus', 22, 'Focuser'],
+];
+
+ws.on('open', async () => {
+  console.log(`connected ws://${host}:8600, ${rounds} rounds`);
+  send('disconnectAllDevice'); await wait(12000);
+  for (const [driver, slot, role] of SIMULATORS) {
+    send(`SetConnectionMode:${role}:INDI`); await wait(800);
+    send(`ConfirmIndiDriver:${driver}:9600:${slot}`); await wait(800);
+  }
+
+  const totals = [];
+  const perDevice = {};
+  let failed = 0;
+  for (let r = 1; r <= rounds; ++r) {
+    log = [];
+    const t0 = Date.now();
+    send('connectAllDevice');
+    const done = await waitFor(/^ConnectAllDeviceComplete/, 120000);
+    const wallMs = Date.now() - t0;
+    const backend = log.filter(x => /^ConnectAllTiming:/.test(x)).map(x => parseInt(x.split(':')[1], 10));
+    const timings = log.filter(x => /^ConnectTiming:/.test(x)).map(x => x.split(':'));
+    const notDone = timings.filter(t => t[t.length - 3] !== 'Done');
+    if (!done || notDone.length) failed++;
+    totals.push(backend.length ? backend[0] : wallMs);
+    for (const t of timings) {
+      // 设备名本身可能含冒号：状态/耗时/次数从尾部取
+      const name = t.slice(1, t.length - 3).join(':');
+      (perDevice[name] = perDevice[name] || []).push(parseInt(t[t.length - 2], 10));
+    }
+    console.log(`round ${r}: ${done ? 'complete' : 'TIMEOUT'} backend=${backend[0] ?? '-'}ms wall=${wallMs}ms ` +
+                `devices=${timings.length} notConnected=${notDone.map(t => t.slice(1, t.length - 3).join(':')).join(',') || '-'}`);
+    send('disconnectAllDevice'); await wait(12000);
+  }
+
+  console.log('\n' + '='.repeat(58));
+  console.log(`connect all: median=${median(totals)}ms min=${Math.min(...totals)}ms max=${Math.max(...totals)}ms`);
+  for (const [name, xs] of Object.entries(perDevice))
+    console.log(`  ${name.padEnd(28)} median=${median(xs)}ms`);
+  console.log(`failed rounds: ${failed}/${rounds}`);
+  ws.close(); process.exit(failed ? 1 : 0);
+});
+
+ws.on('error', (e) => { console.log(`ERROR ${e.message}`); process.exit(2); });
@@ -0,0 +1,363 @@
+// 虚拟天文台长时压测：对着 QUARCS_VIRTUAL_OBSERVATORY=ON 构建的 client（模拟 QHY 相机/CFW/电调 + 模拟导星），
+// 循环跑 单帧拍摄 → CFW 换片 → 电调移动 → Live → 导星 → 计划任务，持续数小时，统计：
+//   - 出帧率（ExposureCompleted/s）、Live 的 LiveFPS / LiveProcessFPS
+//   - 瓦片延迟：发 takeExposure → ExposureCompleted → TileGPM → TileGenerationComplete 各段耗时
+//     （Live 下后一帧 GPM 先到时前一帧记为 superseded；单帧拍摄等不到 TileGenerationComplete 记为 dropped）
+//   - 丢消息：每条 Vue_Command 是否收到对应 msgid 的 QT_Confirm；各阶段等待回包超时次数
+//   - 资源：client 进程 RSS / 线程数 / fd 数（读 /proc，需同机运行），按最小二乘给出每小时增长
+// 不需要真实设备，也不需要 INDI；赤道仪可选（--mount 时连 indi_simulator_telescope，
+// 否则计划任务跳过 GOTO，只跑拍摄/换片）。
+//
+// 用法: node soak_virtual_observatory.js [host=127.0.0.1] [--hours 2] [--relay] [--spawn <client>] [--pid <pid>]
+//                                      [--mount] [--live-sec 60] [--guide-sec 120] [--report soak.json]
+//   --relay   在本机 :8600 起一个广播转发器（代替 NodeJs-Transponder），client 用 QUARCS_WS_HOST=127.0.0.1 连进来
+//   --spawn   由脚本启动 client（环境变量透传，自动得到 pid）；--pid 则监控已在运行的 client
+// 有 dropped 帧、未确认的命令、阶段超时/失败或 client 退出时退出码 1
+const path = require('path');
+const fs = require('fs');
+const { spawn } = require('child_process');
+const WebSocket = require(process.env.QUARCS_WS_MODULE ||
+  '/home/q/workspace_origin/QUARCS_stellarium-web-engine/apps/web-frontend/node_modules/ws');
+
+// ---------------- 参数 ----------------
+const argv = process.argv.slice(2);
+const flag = (name) => argv.includes(name);
+const opt = (name, def) => { const i = argv.indexOf(name); return i >= 0 && i + 1 < argv.length ? argv[i + 1] : def; };
+const host = argv[0] && !argv[0].startsWith('--') ? argv[0] : '127.0.0.1';
+const hours = parseFloat(opt('--hours', '2'));
+const liveSec = parseInt(opt('--live-sec', '60'), 10);
+const guideSec = parseInt(opt('--guide-sec', '120'), 10);
+const reportPath = opt('--report', '');
+const useMount = flag('--mount');
+
+const wait = (ms) => new Promise(r => setTimeout(r, ms));
+const now = () => Date.now();
+const median = (xs) => { const s = [...xs].sort((a, b) => a - b); return s.length ? s[Math.floor(s.length / 2)] : NaN; };
+const pct = (xs, p) => { const s = [...xs].sort((a, b) => a - b); return s.length ? s[Math.min(s.length - 1, Math.floor(s.length * p))] : NaN; };
+
+// ---------------- 可选：本机转发器 ----------------
+let relay = null;
+if (flag('--relay')) {
+  relay = new WebSocket.Server({ port: 8600 });
+  relay.on('connection', (sock) => {
+    sock.on('message', (data) => {
+      const text = data.toString();
+      for (const peer of relay.clients)
+        if (peer !== sock && peer.readyState === WebSocket.OPEN) peer.send(text);
+    });
+  });
+  console.log('relay listening on :8600');
+}
+
+// ---------------- 可选：启动 client ----------------
+let clientPid = opt('--pid', '') ? parseInt(opt('--pid', ''), 10) : 0;
+let clientExited = null;
+const spawnPath = opt('--spawn', '');
+if (spawnPath) {
+  const child = spawn(path.resolve(spawnPath), [], {
+    env: { ...process.env, QUARCS_WS_HOST: process.env.QUARCS_WS_HOST || host },
+    stdio: 'ignore',
+  });
+  clientPid = child.pid;
+  child.on('exit', (code, sig) => { clientExited = `code=${code} signal=${sig}`; });
+  console.log(`spawned client pid=${clientPid}`);
+}
+
+// ---------------- 统计 ----------------
+const stats = {
+  commandsSent: 0,
+  unconfirmed: [],            // 10s 内没收到 QT_Confirm 的命令
+  timeouts: {},               // 阶段名 -> 等待超时次数
+  failures: [],               // 阶段内收到的 *Failed 回包
+  exposures: 0,               // ExposureCompleted 次数
+  singleShots: 0,
+  gpm: 0,
+  tilesComplete: 0,
+  superseded: 0,
+  dropped: 0,
+  latency: { exposureToGpm: [], gpmToComplete: [], sendToComplete: [] },
+  liveFps: [],
+  liveProcessFps: [],
+  liveFrames: 0,
+  guiderStatus: 0,
+  scheduleSaved: 0,
+  cycles: 0,
+  procSamples: [],            // {t, rssKb, threads, fds}
+};
+const bump = (name) => { stats.timeouts[name] = (stats.timeouts[name] || 0) + 1; };
+
+// ---------------- WS ----------------
+const ws = new WebSocket(`ws://${host}:8600`);
+const pendingConfirm = new Map();   // msgid -> {cmd, t}
+const waiters = [];                 // {re, resolve, timer}
+let lastExposureT = 0;
+const gpmByFrame = new Map();       // frameId -> {t, exposureT, complete}
+let lastGpmFrame = null;
+
+let seq = 0;
+const send = (cmd) => {
+  const msgid = `soak-${now()}-${++seq}`;
+  pendingConfirm.set(msgid, { cmd, t: now() });
+  ws.send(JSON.stringify({ type: 'Vue_Command', message: cmd, msgid }));
+  stats.commandsSent++;
+  return msgid;
+};
+
+// 等下一条匹配的回包（只看注册之后到达的消息）；超时返回 null 并记到阶段名下
+const expect = (re, timeoutMs, phase) => new Promise((resolve) => {
+  const w = { re, resolve };
+  w.timer = setTimeout(() => {
+    waiters.splice(waiters.indexOf(w), 1);
+    if (phase) bump(phase);
+    resolve(null);
+  }, timeoutMs);
+  waiters.push(w);
+});
+
+const onText = (s) => {
+  const t = now();
+  if (s === 'ExposureCompleted') { stats.exposures++; lastExposureT = t; }
+  else if (s.startsWith('TileGPM:')) {
+    const f = s.split(':');
+    const frameId = f[14];
+    stats.gpm++;
+    if (lastExposureT) stats.latency.exposureToGpm.push(t - lastExposureT);
+    if (lastGpmFrame && gpmByFrame.has(lastGpmFrame) && !gpmByFrame.get(lastGpmFrame).complete) {
+      stats.superseded++;
+      gpmByFrame.delete(lastGpmFrame);
+    }
+    gpmByFrame.set(frameId, { t, exposureT: lastExposureT, complete: false });
+    lastGpmFrame = frameId;
+  } else if (s.startsWith('TileGenerationComplete:')) {
+    try {
+      const o = JSON.parse(s.slice('TileGenerationComplete:'.length));
+      const g = gpmByFrame.get(String(o.frameId));
+      if (g && !g.complete) {
+        g.complete = true;
+        stats.tilesComplete++;
+        stats.latency.gpmToComplete.push(t - g.t);
+      }
+    } catch (e) {}
+  } else if (s.startsWith('LiveFPS:')) stats.liveFps.push(parseFloat(s.split(':')[1]));
+  else if (s.startsWith('LiveProcessFPS:')) stats.liveProcessFps.push(parseFloat(s.split(':')[1]));
+  else if (s.startsWith('GuiderStatus:')) stats.guiderStatus++;
+  else if (s === 'CaptureImageSaveStatus:Success') stats.scheduleSaved++;
+
+  for (const w of [...waiters]) {
+    if (w.re.test(s)) {
+      if (w.sticky) { w.resolve(s); continue; }
+      clearTimeout(w.timer);
+      waiters.splice(waiters.indexOf(w), 1);
+      w.resolve(s);
+    }
+  }
+};
+
+ws.on('message', (d) => {
+  let o = null;
+  try { o = JSON.parse(d.toString()); } catch (e) { return; }
+  if (!o) return;
+  if (o.type === 'QT_Confirm') { pendingConfirm.delete(String(o.msgid)); return; }
+  if (o.message != null) onText(String(o.message));
+});
+
+// 确认超时与 /proc 采样
+const housekeeping = setInterval(() => {
+  const t = now();
+  for (const [msgid, p] of pendingConfirm) {
+    if (t - p.t > 10000) { stats.unconfirmed.push(p.cmd); pendingConfirm.delete(msgid); }
+  }
+}, 2000);
+
+const sampleProc = () => {
+  if (!clientPid) return;
+  try {
+    const status = fs.readFileSync(`/proc/${clientPid}/status`, 'utf8');
+    const rssKb = parseInt((status.match(/VmRSS:\s+(\d+)/) || [])[1] || '0', 10);
+    const threads = parseInt((status.match(/Threads:\s+(\d+)/) || [])[1] || '0', 10);
+    const fds = fs.readdirSync(`/proc/${clientPid}/fd`).length;
+    stats.procSamples.push({ t: now(), rssKb, threads, fds });
+  } catch (e) {
+    if (!clientExited) clientExited = `/proc/${clientPid} unreadable: ${e.code || e.message}`;
+  }
+};
+const procTimer = setInterval(sampleProc, 10000);
+
+// 最小二乘斜率（每小时），跳过前 10% 的预热样本
+const slopePerHour = (key) => {
+  const xs = stats.procSamples.slice(Math.floor(stats.procSamples.length * 0.1));
+  if (xs.length < 3) return NaN;
+  const t0 = xs[0].t;
+  const mx = xs.reduce((a, s) => a + (s.t - t0), 0) / xs.length;
+  const my = xs.reduce((a, s) => a + s[key], 0) / xs.length;
+  let num = 0, den = 0;
+  for (const s of xs) { num += (s.t - t0 - mx) * (s[key] - my); den += (s.t - t0 - mx) ** 2; }
+  return den > 0 ? num / den * 3600e3 : NaN;
+};
+
+// ---------------- 阶段 ----------------
+async function setup() {
+  send('disconnectAllDevice'); await wait(8000);
+  for (const role of ['MainCamera', 'Guider', 'Focuser']) { send(`SetConnectionMode:${role}:SDK`); await wait(500); }
+  send('ConfirmIndiDriver:indi_qhy_ccd:9600:20'); await wait(800);
+  send('ConfirmIndiDriver:indi_qhy_ccd:9600:1'); await wait(800);
+  send('ConfirmIndiDriver:indi_qhy_focuser:9600:22'); await wait(800);
+  // 模拟电调不访问串口，但连接流程要求端口存在且可读
+  send('SetSerialPort:Focuser:/dev/null'); await wait(500);
+  if (useMount) {
+    send('SetConnectionMode:Mount:INDI'); await wait(500);
+    send('ConfirmIndiDriver:indi_simulator_telescope:9600:0'); await wait(800);
+  }
+
+  // 相机：连接后按候选类别绑定（主相机 QHY268M → 类别 OTHER，导星 QHY5III178M → 5III）
+  const candidates = [];
+  const grab = (s) => { if (s.startsWith('DeviceToBeAllocated:CCD:')) candidates.push(s.split(':')); };
+  waiters.push({ re: /^DeviceToBeAllocated:CCD:/, resolve: grab, timer: null, sticky: true });
+  send('ConnectDriver:indi_qhy_ccd:MainCamera:SDK'); await wait(8000);
+  const bindBy = async (role, pred) => {
+    const c = candidates.find(pred);
+    if (!c) { stats.failures.push(`setup: no candidate for ${role}`); return false; }
+    send(`BindingDevice:${role}:${c[2]}`);
+    const ok = await expect(new RegExp(`^ConnectSuccess:${role}`), 30000, 'setup');
+    return !!ok;
+  };
+  const mainOk = await bindBy('MainCamera', c => c[4] !== '5III');
+  send('ConnectDriver:indi_qhy_ccd:Guider:SDK'); await wait(8000);
+  const guiderOk = await bindBy('Guider', c => c[4] === '5III');
+  send('ConnectDriver:indi_qhy_focuser:Focuser:SDK');
+  const focuserOk = !!(await expect(/^ConnectSuccess:Focuser/, 30000, 'setup'));
+  if (useMount) { send('ConnectDriver:indi_simulator_telescope:Mount:INDI'); await expect(/^ConnectSuccess:Mount/, 60000, 'setup'); }
+  console.log(`setup: main=${mainOk} guider=${guiderOk} focuser=${focuserOk} mount=${useMount ? 'indi sim' : 'none'}`);
+  return mainOk;
+}
+
+async function phaseSingle(n, expMs) {
+  for (let i = 0; i < n; ++i) {
+    const t0 = now();
+    const done = expect(/^TileGenerationComplete:/, expMs + 60000, 'single');
+    send(`takeExposure:${expMs}:soak${t0}`);
+    stats.singleShots++;
+    const s = await done;
+    if (s) stats.latency.sendToComplete.push(now() - t0);
+    else stats.dropped++;
+  }
+}
+
+async function phaseCfw() {
+  for (const pos of [2, 5, 1]) {
+    send(`SetCFWPosition:${pos}`);
+    const s = await expect(/^SetCFWPosition(Success|Failed):/, 20000, 'cfw');
+    if (s && s.startsWith('SetCFWPositionFailed')) stats.failures.push(`cfw: ${s}`);
+  }
+}
+
+async function phaseFocuser() {
+  for (const dir of ['Right', 'Left']) {
+    send(`focusMoveStep:${dir}:500`);
+    await expect(/^FocusMoveDone:/, 30000, 'focuser');
+  }
+}
+
+async function phaseLive() {
+  const before = stats.exposures;
+  send('SetMainCameraCaptureMode:Live');
+  if (!(await expect(/^SetMainCameraCaptureModeSuccess:Live/, 10000, 'live'))) return;
+  await wait(liveSec * 1000);
+  send('SetMainCameraCaptureMode:Single');
+  await expect(/^SetMainCameraCaptureModeSuccess:Single/, 10000, 'live');
+  stats.liveFrames += stats.exposures - before;
+  await wait(3000);   // 让最后一帧的瓦片收尾，再开始下一阶段的单帧统计
+}
+
+async function phaseGuiding() {
+  const before = stats.guiderStatus;
+  send('GuiderLoopExpSwitch:true'); await wait(5000);
+  send('GuiderSwitch:true');
+  await wait(guideSec * 1000);
+  send('GuiderSwitch:false'); await wait(2000);
+  send('GuiderLoopExpSwitch:false'); await wait(2000);
+  if (stats.guiderStatus === before) bump('guiding');
+}
+
+async function phaseSchedule() {
+  // 一行：Light 2s × 3，滤镜 1，不重新对焦，无延迟；无赤道仪时 GOTO 被跳过
+  send('ScheduleTabelData:[1,SoakTarget,Ra:1.2,Dec:0.5,Now,2 s,1,3,Light,OFF,0 s,');
+  await expect(/^ScheduleComplete/, 5 * 60000, 'schedule');
+}
+
+// ---------------- 主流程 ----------------
+const report = () => {
+  const elapsedH = (now() - startT) / 3600e3;
+  const last = stats.procSamples[stats.procSamples.length - 1] || {};
+  const first = stats.procSamples[0] || {};
+  const lat = stats.latency;
+  const timeouts = Object.values(stats.timeouts).reduce((a, b) => a + b, 0);
+  const result = {
+    hours: +elapsedH.toFixed(3),
+    cycles: stats.cycles,
+    framesPerSec: +(stats.exposures / Math.max(1, (now() - startT) / 1000)).toFixed(3),
+    exposures: stats.exposures, liveFrames: stats.liveFrames, singleShots: stats.singleShots,
+    gpm: stats.gpm, tilesComplete: stats.tilesComplete, superseded: stats.superseded, dropped: stats.dropped,
+    latencyMs: {
+      exposureToGpm: { p50: median(lat.exposureToGpm), p95: pct(lat.exposureToGpm, 0.95) },
+      gpmToComplete: { p50: median(lat.gpmToComplete), p95: pct(lat.gpmToComplete, 0.95) },
+      sendToComplete: { p50: median(lat.sendToComplete), p95: pct(lat.sendToComplete, 0.95) },
+    },
+    liveFps: median(stats.liveFps), liveProcessFps: median(stats.liveProcessFps),
+    commandsSent: stats.commandsSent, unconfirmed: stats.unconfirmed.length, timeouts: stats.timeouts,
+    failures: stats.failures.length, guiderStatus: stats.guiderStatus, scheduleSaved: stats.scheduleSaved,
+    rssMb: { first: (first.rssKb || 0) / 1024, last: (last.rssKb || 0) / 1024, slopePerHour: slopePerHour('rssKb') / 1024 },
+    threads: { first: first.threads, last: last.threads, slopePerHour: slopePerHour('threads') },
+    fds: { first: first.fds, last: last.fds, slopePerHour: slopePerHour('fds') },
+    clientExited,
+  };
+  console.log('\n' + '='.repeat(66));
+  console.log(`soak ${result.hours} h, ${result.cycles} cycles, ${result.framesPerSec} frames/s ` +
+              `(single ${result.singleShots}, live ${result.liveFrames})`);
+  console.log(`tiles: gpm=${result.gpm} complete=${result.tilesComplete} superseded=${result.superseded} dropped=${result.dropped}`);
+  for (const [k, v] of Object.entries(result.latencyMs)) console.log(`  ${k.padEnd(15)} p50=${v.p50}ms p95=${v.p95}ms`);
+  console.log(`live: LiveFPS=${result.liveFps} LiveProcessFPS=${result.liveProcessFps}`);
+  console.log(`ws: sent=${result.commandsSent} unconfirmed=${result.unconfirmed} timeouts=${timeouts} ${JSON.stringify(stats.timeouts)}`);
+  console.log(`rss: ${result.rssMb.first.toFixed(1)} -> ${result.rssMb.last.toFixed(1)} MB (${result.rssMb.slopePerHour.toFixed(2)} MB/h), ` +
+              `threads ${result.threads.first} -> ${result.threads.last}, fds ${result.fds.first} -> ${result.fds.last}`);
+  if (stats.unconfirmed.length) console.log(`  unconfirmed: ${[...new Set(stats.unconfirmed)].slice(0, 5).join(' | ')}`);
+  stats.failures.slice(0, 10).forEach(f => console.log(`  FAIL ${f}`));
+  if (clientExited) console.log(`  client exited: ${clientExited}`);
+  if (reportPath) fs.writeFileSync(reportPath, JSON.stringify(result, null, 2));
+  return result.dropped || result.unconfirmed || timeouts || result.failures || clientExited ? 1 : 0;
+};
+
+let startT = now();
+ws.on('open', async () => {
+  console.log(`connected ws://${host}:8600, soak ${hours} h`);
+  // 等 client 连上转发器（或已在线）
+  await wait(relay ? 15000 : 1000);
+  let code = 1;
+  try {
+    if (!(await setup())) {
+      stats.failures.push('setup: main camera not bound');
+    } else {
+      startT = now();
+      const deadline = startT + hours * 3600e3;
+      while (now() < deadline && !clientExited) {
+        await phaseSingle(5, 1000);
+        await phaseCfw();
+        await phaseFocuser();
+        await phaseLive();
+        await phaseGuiding();
+        await phaseSchedule();
+        stats.cycles++;
+        console.log(`cycle ${stats.cycles}: frames=${stats.exposures} tiles=${stats.tilesComplete} dropped=${stats.dropped} ` +
+                    `rss=${((stats.procSamples.slice(-1)[0] || {}).rssKb / 1024 || 0).toFixed(1)}MB`);
+      }
+    }
+  } catch (e) { stats.failures.push(`exception: ${e.message}`); }
+  sampleProc();
+  code = report();
+  send('disconnectAllDevice'); await wait(2000);
+  clearInterval(housekeeping); clearInterval(procTimer);
+  ws.close(); if (relay) relay.close();
+  process.exit(code);
+});
+
+ws.on('error', (e) => { console.log(`ERROR ${e.message}`); process.exit(2); });
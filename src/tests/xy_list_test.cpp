@@ -0,0 +1,98 @@
+// xy_list_test.cpp
+// solver::XyList 自检：过滤/排序/截断、1 基坐标、BINTABLE 布局（大端 float、2880 字节对齐）
+//
+// 用法：xy_list_test
+// 任一检查失败返回 1
+
+#include "../solver/XyList.h"
+#include "test_util.h"
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <string>
+
+using test_util::check;
+
+namespace {
+
+float readFloatBE(const std::string& data, size_t offset)
+{
+    const auto* p = reinterpret_cast<const unsigned char*>(data.data() + offset);
+    const uint32_t bits = (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 8) | uint32_t(p[3]);
+    float f = 0.0f;
+    std::memcpy(&f, &bits, sizeof(f));
+    return f;
+}
+
+void testPrepare()
+{
+    std::cout << "[prepare]" << std::endl;
+    std::vector<solver::XyStar> in = {
+        {10.0, 10.0, 5.0},
+        {20.0, 20.0, 50.0},
+        {-3.0, 10.0, 100.0},                                      // 画面外
+        {30.0, std::numeric_limits<double>::quiet_NaN(), 80.0},   // NaN
+        {40.0, 40.0, 0.0},                                        // 无通量
+        {50.0, 50.0, 20.0},
+        {60.0, 60.0, 20.0},
+        {99.4, 79.4, 1.0},                                        // 贴边仍在画面内
+    };
+    const auto all = solver::prepareXyList(in, 100, 80, 0);
+    check(all.stars.size() == 5, "drops off-frame / non-finite / zero-flux stars");
+    bool sorted = true;
+    for (size_t i = 1; i < all.stars.size(); ++i)
+        sorted = sorted && all.stars[i - 1].flux >= all.stars[i].flux;
+    check(sorted && all.stars.front().flux == 50.0, "sorted by flux, brightest first");
+    check(all.stars[1].x == 50.0 && all.stars[2].x == 60.0, "ties ordered deterministically");
+
+    const auto capped = solver::prepareXyList(in, 100, 80, 3);
+    check(capped.stars.size() == 3 && capped.stars.back().flux == 20.0, "capped at brightest N");
+    check(capped.imageWidth == 100 && capped.imageHeight == 80, "image size carried");
+}
+
+void testWrite()
+{
+    std::cout << "[write]" << std::endl;
+    const test_util::TempDir tmp("xy_list_test");
+    const std::string path = tmp.file("frame.xyls");
+
+    std::vector<solver::XyStar> in;
+    for (int i = 0; i < 300; ++i)
+        in.push_back({i * 3.0 + 0.25, i * 2.0 + 0.5, 1000.0 - i});
+    const auto list = solver::prepareXyList(in, 1280, 960, 250);
+    std::string err;
+    check(solver::writeXyList(path, list, &err), "write .xyls " + err);
+
+    std::ifstream f(path, std::ios::binary);
+    std::string data((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+    check(data.size() % 2880 == 0, "file is a whole number of 2880-byte blocks");
+    check(data.compare(0, 30, "SIMPLE  =                    T") == 0, "primary header first");
+    check(data.compare(2880, 20, "XTENSION= 'BINTABLE'") == 0, "binary table extension at block 2");
+    check(data.find("NAXIS2  =                  250") != std::string::npos, "row count = capped star count");
+    check(data.find("TTYPE3  = 'FLUX    '") != std::string::npos && data.find("IMAGEW  =                 1280") != std::string::npos,
+          "FLUX column and IMAGEW card");
+
+    // 扩展头占 1 个块，数据从 5760 开始，每行 12 字节
+    const size_t row0 = 5760;
+    const size_t rowLast = row0 + 249 * 12;
+    check(data.size() >= rowLast + 12, "data block present");
+    if (data.size() >= rowLast + 12) {
+        check(readFloatBE(data, row0) == 1.25f && readFloatBE(data, row0 + 4) == 1.5f &&
+                  readFloatBE(data, row0 + 8) == 1000.0f,
+              "first row is brightest, 1-based big-endian X/Y");
+        check(std::fabs(readFloatBE(data, rowLast + 8) - 751.0f) < 1e-3f, "last row is the Nth brightest");
+    }
+}
+
+} // namespace
+
+int main()
+{
+    testPrepare();
+    testWrite();
+    return test_util::finish();
+}
@@ -11,6 +11,10 @@
 #include <fstream>
 #include <qxmlstream.h>
 #include "fitsio.h"
+#include "fits/FitsWriter.h"
+#include "solver/PlateSolveService.h"
+#include "solver/BatchAstrometry.h"
+#include "storage/ConfigStore.h"
 #include <filesystem>
 #include <QObject>
 #include <QDebug>
@@ -18,6 +22,8 @@
 #include <QThread>
 #include <atomic>
 #include <limits>
+#include <mutex>
+#include <sstream>
 #include <cmath>
 #include <cerrno>
 #include <cstring>
@@ -26,6 +32,11 @@
 
 // #define ImageDebug
 
+// 随程序安装的数据文件目录（CMake 按安装前缀定义，见 CMakeLists.txt）
+#ifndef QUARCS_DATA_DIR
+#define QUARCS_DATA_DIR "/usr/local/share/quarcs"
+#endif
+
 namespace {
 DriversList driversList_{};
 
@@ -53,6 +64,38 @@ static inline void disableIndiFifoOnce(const QString &why)
         Logger::Log("INDI FIFO disabled: " + why.toStdString(), LogLevel::WARNING, DeviceType::MAIN);
     }
 }
+
+// config/config.ini 的内存存储：首次使用时载入，后台写盘失败记日志
+storage::ConfigStore& configStore()
+{
+    static std::once_flag once;
+    storage::ConfigStore &store = storage::ConfigStore::instance();
+    std::call_once(once, [&store]() {
+        store.setErrorHandler([](const std::string &message) {
+            Logger::Log(message, LogLevel::ERROR, DeviceType::MAIN);
+        });
+        std::string error;
+        if (!store.load(&error))
+            Logger::Log("configStore | Failed to load " + store.path() + ": " + error, LogLevel::ERROR, DeviceType::MAIN);
+    });
+    return store;
+}
+
+// 从 solve-field 后端配置中取出 "index <name>" 行（常驻求解服务据此限制索引）
+static std::vector<std::string> indexFilesFromBackendConfig(const QString &path)
+{
+    std::vector<std::string> names;
+    QFile file(path.trimmed());
+    if (path.trimmed().isEmpty() || !file.open(QIODevice::ReadOnly | QIODevice::Text))
+        return names;
+    for (const QString &line : QString::fromUtf8(file.readAll()).split('\n'))
+    {
+        const QString t = line.trimmed();
+        if (t.startsWith(QLatin1String("index ")))
+            names.push_back(t.mid(6).trimmed().toStdString());
+    }
+    return names;
+}
 }  // namespace
 
 Tools* Tools::instance_ = new Tools();
@@ -232,6 +275,20 @@ double Tools::getLastMedianHFR()
  * @return 是否执行成功（成功则可通过 getLastSNR() 获取数值）
  */
 bool Tools::findSNRByPython_Process(QString filename)
+{
+    double snr = 0.0;
+    if (!findSNRByPython_Process(filename, snr))
+        return false;
+    g_lastSNR = snr;
+    return true;
+}
+
+/**
+ * @brief 同上，结果直接返回、不写 getLastSNR() 的共享值，可在工作线程中调用
+ *
+ * cancel 被置位时 kill 脚本并返回 false（每 100 ms 检查一次），供停止自动对焦时收回后台分析
+ */
+bool Tools::findSNRByPython_Process(QString filename, double &snr, const std::atomic_bool *cancel)
 {
     QString program = "python3";
     QStringList arguments;
@@ -245,10 +302,20 @@ bool Tools::findSNRByPython_Process(QString filename)
         return false;
     }
 
-    if (!process.waitForFinished(-1)) // -1: wait indefinitely
+    while (!process.waitForFinished(100))
     {
-        qDebug() << "Python SNR script did not finish.";
-        return false;
+        if (process.state() == QProcess::NotRunning)
+        {
+            qDebug() << "Python SNR script did not finish.";
+            return false;
+        }
+        if (cancel && cancel->load())
+        {
+            qDebug() << "Python SNR script cancelled.";
+            process.kill();
+            process.waitForFinished(1000);
+            return false;
+        }
     }
 
     QByteArray output = process.readAllStandardOutput();
@@ -330,7 +397,7 @@ bool Tools::findSNRByPython_Process(QString filename)
         parsedSNR = 0.0;
     }
 
-    g_lastSNR = parsedSNR;
+    snr = parsedSNR;
     return true;
 }
 
@@ -839,114 +906,28 @@ void Tools::makeImageFolder() {
 }
 
 void Tools::saveSystemDeviceList(SystemDeviceList deviceList) {
-    std::string directory = "config";  // 配置文件夹名
-    std::string filename = directory + "/config.ini";  // 配置文件路径
-
-    // 检查文件夹是否存在，如果不存在就创建
-    if (!std::filesystem::exists(directory)) {
-        if (!std::filesystem::create_directory(directory)) {
-            Logger::Log("saveSystemDeviceList | An error occurred while creating the configuration folder: " + directory, LogLevel::ERROR, DeviceType::MAIN);
-            return;
-        }
-    }
-
-    // 读取现有配置文件的内容
-    std::ifstream infile(filename);
-    std::stringstream fileContent;
-    std::string line;
-    bool isInLastConnectedDeviceSection = false;
-
-    // 读取现有文件内容
-    while (std::getline(infile, line)) {
-        fileContent << line << "\n";
-        // 如果遇到 [LastConnectedDevice] 部分，标记为开始位置
-        if (line == "[LastConnectedDevice]") {
-            isInLastConnectedDeviceSection = true;
-        }
-        // 如果已经在 [LastConnectedDevice] 部分，直到遇到空行或另一个部分则跳出
-        if (isInLastConnectedDeviceSection && line.empty()) {
-            isInLastConnectedDeviceSection = false;
-        }
-    }
-    infile.close();
-
-    // 移除旧的 [LastConnectedDevice] 部分（若存在）。
-    // 说明：历史实现用 find(endMarker)+len 再与 npos 比较，find 失败时会回绕成
-    // 一个很小的偏移使 !=npos 恒真、erase 越界，把整段甚至后续内容乱擦，最终
-    // [LastConnectedDevice] 段被写丢（现网现象：config.ini 长期缺该段）。这里改为
-    // 稳健定位：找到段头后删除到结束标记之后（含其后换行/空行）；找不到结束标记则删到文件末尾。
-    std::string content = fileContent.str();
-    const std::string endMarker = "(End of device list)";
-    size_t pos = content.find("[LastConnectedDevice]");
-    if (pos != std::string::npos) {
-        size_t endPos = content.find(endMarker, pos);
-        if (endPos != std::string::npos) {
-            endPos += endMarker.length();  // 跳过结束标记本身
-            while (endPos < content.size() && (content[endPos] == '\n' || content[endPos] == '\r')) {
-                ++endPos;  // 连同其后的换行/空行一并吃掉，避免残留空段
-            }
-            content.erase(pos, endPos - pos);
-        } else {
-            content.erase(pos);  // 历史损坏：只有段头没有结束标记，直接删到文件末尾
-        }
-    }
-
-    // 防御：确保前置内容以换行结尾，避免新段头拼接到上一行末尾
-    if (!content.empty() && content.back() != '\n') {
-        content += "\n";
-    }
-
-    // 打开文件进行写入（覆盖模式）
-    std::ofstream outfile(filename, std::ios::out | std::ios::trunc);  // 打开文件以覆盖内容
-    if (!outfile.is_open()) {
-        Logger::Log("saveSystemDeviceList | An error occurred while opening the configuration file for writing: " + filename, LogLevel::ERROR, DeviceType::MAIN);
-        return;
-    }
-
-    // 先写入文件的原始内容（去掉 [LastConnectedDevice] 部分）
-    outfile << content;
-
-    // 写入新的 [LastConnectedDevice] 部分
-    outfile << "[LastConnectedDevice]\n";
-
-    // 遍历设备列表并写入到配置文件
+    // 设备块里的键每台设备重复一次，整段原样保存：设备之间空一行，段尾由存储补上 (End of device list)
+    std::ostringstream body;
     for (const auto& device : deviceList.system_devices) {
-        QByteArray descriptionUtf8 = device.Description.toUtf8();
-        QByteArray deviceIndiNameUtf8 = device.DeviceIndiName.toUtf8();
-        QByteArray driverIndiNameUtf8 = device.DriverIndiName.toUtf8();
-        QByteArray driverFromUtf8 = device.DriverFrom.toUtf8();
-        QByteArray sdkDriverNameUtf8 = device.SDKDriverName.toUtf8();
-
-        // 写入设备信息到配置文件
-        outfile << "Description=" << descriptionUtf8.constData() << "\n";
-        outfile << "DeviceIndiGroup=" << device.DeviceIndiGroup << "\n";
-        outfile << "DeviceIndiName=" << deviceIndiNameUtf8.constData() << "\n";
-        outfile << "DriverIndiName=" << driverIndiNameUtf8.constData() << "\n";
-        outfile << "DriverFrom=" << driverFromUtf8.constData() << "\n";
-        outfile << "SDKDriverName=" << sdkDriverNameUtf8.constData() << "\n";
-        outfile << "BaudRate=" << device.BaudRate << "\n";
-        outfile << "isSDKConnect=" << (device.isSDKConnect ? "true" : "false") << "\n";
-        outfile << "\n";  // 每个设备之间空一行，便于阅读
-    }
-    outfile << "(End of device list)\n\n";
-
-    // 关闭文件
-    outfile.close();
-    Logger::Log("saveSystemDeviceList | The device list has been saved to the configuration file: " + filename, LogLevel::INFO, DeviceType::MAIN);
+        body << "Description=" << device.Description.toUtf8().constData() << "\n";
+        body << "DeviceIndiGroup=" << device.DeviceIndiGroup << "\n";
+        body << "DeviceIndiName=" << device.DeviceIndiName.toUtf8().constData() << "\n";
+        body << "DriverIndiName=" << device.DriverIndiName.toUtf8().constData() << "\n";
+        body << "DriverFrom=" << device.DriverFrom.toUtf8().constData() << "\n";
+        body << "SDKDriverName=" << device.SDKDriverName.toUtf8().constData() << "\n";
+        body << "BaudRate=" << device.BaudRate << "\n";
+        body << "isSDKConnect=" << (device.isSDKConnect ? "true" : "false") << "\n";
+        body << "\n";  // 每个设备之间空一行，便于阅读
+    }
+    configStore().setRawSection("LastConnectedDevice", body.str());
+    Logger::Log("saveSystemDeviceList | The device list has been saved to the configuration store", LogLevel::INFO, DeviceType::MAIN);
 }
 
 SystemDeviceList Tools::readSystemDeviceList() {
     SystemDeviceList deviceList;
-    std::string filename = "config/config.ini"; // INI 配置文件路径
-    std::ifstream infile(filename);
-
-    if (!infile.is_open()) {
-        Logger::Log("readSystemDeviceList | Error occurred while opening file for reading: " + filename, LogLevel::ERROR, DeviceType::MAIN);
-        return deviceList;
-    }
+    std::istringstream infile(configStore().rawSection("LastConnectedDevice"));
 
     std::string line;
-    bool inLastConnectedDeviceSection = false;
     SystemDevice currentDevice;
     std::map<std::string, std::string> sectionData;
     auto flushCurrentDevice = [&]() {
@@ -1007,386 +988,63 @@ SystemDeviceList Tools::readSystemDeviceList() {
         sectionData.clear();
     };
 
-    // 逐行读取 INI 文件
+    // 段体按行解析：空行分隔设备
     while (std::getline(infile, line)) {
-        // 检查是否进入了 [LastConnectedDevice] 部分
-        if (line.find("[LastConnectedDevice]") != std::string::npos) {
-            inLastConnectedDeviceSection = true;
-            sectionData.clear();
-            continue; // 跳过这一行，开始读取数据
-        }
-
-        if (inLastConnectedDeviceSection) {
-            // 遇到设备分隔空行、结束标记或新的 section，提交当前设备
-            if (line.empty() || line == "(End of device list)" || line[0] == '[') {
-                flushCurrentDevice();
-
-                if (!line.empty() && line[0] == '[') {
-                    // 如果遇到新的节，跳出循环
-                    break;
-                }
-            } else {
-                // 解析键值对
-                std::string key, value;
-                std::istringstream lineStream(line);
-                if (std::getline(std::getline(lineStream, key, '='), value)) {
-                    sectionData[key] = value;
-                }
+        if (line.empty() || line == "(End of device list)") {
+            flushCurrentDevice();
+        } else {
+            // 解析键值对
+            std::string key, value;
+            std::istringstream lineStream(line);
+            if (std::getline(std::getline(lineStream, key, '='), value)) {
+                sectionData[key] = value;
             }
         }
     }
 
-    // 处理文件结尾处最后一个设备块
-    if (inLastConnectedDeviceSection)
-        flushCurrentDevice();
-
-    infile.close();
+    // 处理段尾最后一个设备块
+    flushCurrentDevice();
     return deviceList;
 }
 
 void Tools::saveExpTimeList(QString List)
 {
-    std::string directory = "config";  // 配置文件夹名
-    std::string filename = directory + "/config.ini";  // 配置文件路径
-
-    // 检查文件夹是否存在，如果不存在就创建
-    if (!std::filesystem::exists(directory)) {
-        if (!std::filesystem::create_directory(directory)) {
-            Logger::Log("saveExpTimeList | An error occurred while creating the configuration folder: " + directory, LogLevel::ERROR, DeviceType::MAIN);
-            return;
-        }
-    }
-
-    // 读取现有配置文件的内容
-    std::ifstream infile(filename);
-    std::stringstream fileContent;
-    std::string line;
-    bool isInExpTimeListSection = false;
-
-    // 读取现有文件内容
-    while (std::getline(infile, line)) {
-        fileContent << line << "\n";
-        // 如果遇到 [ExpTimeList] 部分，标记为开始位置
-        if (line == "[ExpTimeList]") {
-            isInExpTimeListSection = true;
-        }
-        // 如果已经在 [LastConnectedDevice] 部分，直到遇到空行或另一个部分则跳出
-        if (isInExpTimeListSection && line.empty()) {
-            isInExpTimeListSection = false;
-        }
-    }
-    infile.close();
-
-    // 如果文件已经包含了 [LastConnectedDevice] 部分，则移除旧的内容
-    std::string content = fileContent.str();
-    size_t pos = content.find("[ExpTimeList]");
-    if (pos != std::string::npos) {
-        size_t endPos = content.find("(End of ExpTime list)\n\n", pos) + std::string("(End of ExpTime list)\n\n").length();  // 找到 [ExpTimeList] 部分结束的位置
-        if (endPos != std::string::npos) {
-            content.erase(pos, endPos - pos);  // 删除旧的设备列表部分
-        }
-    }
-
-    // 打开文件进行写入（覆盖模式）
-    std::ofstream outfile(filename, std::ios::out | std::ios::trunc);  // 打开文件以覆盖内容
-    if (!outfile.is_open()) {
-        Logger::Log("saveExpTimeList | An error occurred while opening the configuration file for writing: " + filename, LogLevel::ERROR, DeviceType::MAIN);
-        return;
-    }
-
-    // 先写入文件的原始内容（去掉 [LastConnectedDevice] 部分）
-    outfile << content;
-
-    // 写入新的 [LastConnectedDevice] 部分
-    outfile << "[ExpTimeList]\n";
-
-    QByteArray ExpTimeListUtf8 = List.toUtf8();
-
-    // 将 QString 转换为 UTF-8 格式的字符串，并保存
-    outfile << "ExpTimeList=" << ExpTimeListUtf8.constData() << "\n";
-
-    outfile << "(End of ExpTime list)\n\n";
-
-    outfile.close();
+    configStore().replaceSection("ExpTimeList", {{"ExpTimeList", List.toUtf8().toStdString()}});
 }
 
 void Tools::saveParameter(const QString& deviceCategory, const QString& functionCategory, const QString& parameterValue) {
-    std::string directory = "config";  // 配置文件夹名
-    std::string filename = directory + "/config.ini";  // 配置文件路径
-
-    // 检查文件夹是否存在，如果不存在就创建
-    if (!std::filesystem::exists(directory)) {
-        if (!std::filesystem::create_directory(directory)) {
-            Logger::Log("saveParameter | An error occurred while creating the configuration folder: " + directory, LogLevel::ERROR, DeviceType::MAIN);
-            return;
-        }
-    }
-
-    // 读取现有配置文件的内容
-    std::ifstream infile(filename);
-    std::stringstream fileContent;
-    std::string line;
-    bool isInSection = false;
-    std::string sectionHeader = "[" + deviceCategory.toStdString() + "]";
-    std::string endMarker = "(End of " + deviceCategory.toStdString() + " Parameter)";
-
-    // 读取现有文件内容
-    while (std::getline(infile, line)) {
-        fileContent << line << "\n";
-    }
-    infile.close();
-
-    // 查找并更新指定部分
-    std::string content = fileContent.str();
-    size_t pos = content.find(sectionHeader);
-    if (pos != std::string::npos) {
-        size_t endPos = content.find(endMarker, pos);
-        if (endPos != std::string::npos) {
-            // 查找并更新现有参数
-            size_t paramPos = content.find(functionCategory.toStdString() + "=", pos);
-            if (paramPos != std::string::npos && paramPos < endPos) {
-                size_t lineEnd = content.find("\n", paramPos);
-                content.replace(paramPos, lineEnd - paramPos, functionCategory.toStdString() + "=" + parameterValue.toStdString());
-            } else {
-                // 在结束标记之前插入新的参数
-                content.insert(endPos, functionCategory.toStdString() + "=" + parameterValue.toStdString() + "\n");
-            }
-        } else {
-            // 如果没有找到结束标记，添加新的参数和结束标记
-            content += sectionHeader + "\n" + functionCategory.toStdString() + "=" + parameterValue.toStdString() + "\n" + endMarker + "\n";
-        }
-    } else {
-        // 如果没有找到该部分，添加新的部分
-        content += sectionHeader + "\n" + functionCategory.toStdString() + "=" + parameterValue.toStdString() + "\n" + endMarker + "\n\n";
-    }
-
-    // 打开文件进行写入（覆盖模式）
-    std::ofstream outfile(filename, std::ios::out | std::ios::trunc);  // 打开文件以覆盖内容
-    if (!outfile.is_open()) {
-        Logger::Log("saveParameter | An error occurred while opening the configuration file for writing: " + filename, LogLevel::ERROR, DeviceType::MAIN);
-        return;
-    }
-
-    // 写入更新后的内容
-    outfile << content;
-    outfile.close();
+    configStore().setValue(deviceCategory.toStdString(), functionCategory.toStdString(), parameterValue.toStdString());
 }
 
 QMap<QString, QString> Tools::readParameters(const QString& deviceCategory) {
-    std::string filename = "config/config.ini";  // 配置文件路径
-    std::ifstream infile(filename);
-
     QMap<QString, QString> parameters;
-
-    if (!infile.is_open()) {
-        Logger::Log("readParameters | Error occurred while opening file for reading: " + filename, LogLevel::ERROR, DeviceType::MAIN);
-        return parameters;
+    for (const auto& kv : configStore().entries(deviceCategory.toStdString())) {
+        parameters.insert(QString::fromStdString(kv.first), QString::fromStdString(kv.second));
     }
-
-    std::string line;
-    bool inSection = false;
-    std::string sectionHeader = "[" + deviceCategory.toStdString() + "]";
-    std::string endMarker = "(End of " + deviceCategory.toStdString() + " Parameter)";
-
-    // 逐行读取 INI 文件
-    while (std::getline(infile, line)) {
-        // 检查是否进入了指定的部分
-        if (line == sectionHeader) {
-            inSection = true;
-            continue; // 跳过这一行，开始读取数据
-        }
-
-        if (inSection) {
-            // 遇到结束标记或下一个部分，停止读取当前部分
-            if (line.empty() || line == endMarker || line[0] == '[') {
-                break;
-            }
-
-            // 解析键值对
-            std::string key, value;
-            std::istringstream lineStream(line);
-            if (std::getline(std::getline(lineStream, key, '='), value)) {
-                parameters.insert(QString::fromStdString(key), QString::fromStdString(value));
-            }
-        }
-    }
-
-    infile.close();
     return parameters;
 }
 
 QString Tools::readExpTimeList()
 {
-    QString ExpTimeList;
-    std::string filename = "config/config.ini"; // INI 配置文件路径
-    std::ifstream infile(filename);
-
-    if (!infile.is_open()) {
-        Logger::Log("readExpTimeList | Error occurred while opening file for reading: " + filename, LogLevel::ERROR, DeviceType::MAIN);
-        return QString();
-    }
-
-    std::string line;
-    bool inExpTimeListSection = false;
-    SystemDevice currentDevice;
-    std::map<std::string, std::string> sectionData;
-
-    // 逐行读取 INI 文件
-    while (std::getline(infile, line)) {
-        // 检查是否进入了 [LastConnectedDevice] 部分
-        if (line.find("[ExpTimeList]") != std::string::npos) {
-            inExpTimeListSection = true;
-            continue; // 跳过这一行，开始读取数据
-        }
-
-        if (inExpTimeListSection) {
-            // 遇到下一个部分或空行，停止读取当前部分
-            if (line.empty() || line[0] == '[') {
-                // 这里保存当前设备并重置
-                if (!sectionData.empty()) {
-                    // 用 sectionData 填充当前设备
-                    ExpTimeList = QString::fromStdString(sectionData["ExpTimeList"]);
-                }
-                // 重置
-                sectionData.clear();
-
-                if (!line.empty() && line[0] == '[') {
-                    // 如果遇到新的节，跳出循环
-                    break;
-                }
-            } else {
-                // 解析键值对
-                std::string key, value;
-                std::istringstream lineStream(line);
-                if (std::getline(std::getline(lineStream, key, '='), value)) {
-                    sectionData[key] = value;
-                }
-            }
-        }
-    }
-
-    infile.close();
-    return ExpTimeList;
+    return QString::fromStdString(configStore().value("ExpTimeList", "ExpTimeList"));
 }
 
 void Tools::saveCFWList(QString Name, QString List)
 {
-    std::string directory = "config";  // 配置文件夹名
-    std::string filename = directory + "/config.ini";  // 配置文件路径
-
-    // 检查文件夹是否存在，如果不存在就创建
-    if (!std::filesystem::exists(directory)) {
-        if (!std::filesystem::create_directory(directory)) {
-            Logger::Log("saveCFWList | An error occurred while creating the configuration folder: " + directory, LogLevel::ERROR, DeviceType::MAIN);
-            return;
-        }
-    }
-
-    // 读取现有配置文件的内容
-    std::ifstream infile(filename);
-    std::stringstream fileContent;
-    std::string line;
-    bool isInCFWListSection = false;
-
-    // 读取现有文件内容
-    while (std::getline(infile, line)) {
-        fileContent << line << "\n";
-        // 如果遇到 [CFWList] 部分，标记为开始位置
-        if (line == "[CFWList(" + Name.toStdString() +")]") {
-            isInCFWListSection = true;
-        }
-        // 如果已经在 [LastConnectedDevice] 部分，直到遇到空行或另一个部分则跳出
-        if (isInCFWListSection && line.empty()) {
-            isInCFWListSection = false;
-        }
-    }
-    infile.close();
-
-    // 如果文件已经包含了 [LastConnectedDevice] 部分，则移除旧的内容
-    std::string content = fileContent.str();
-    size_t pos = content.find("[CFWList(" + Name.toStdString() +")]");
-    if (pos != std::string::npos) {
-        size_t endPos = content.find("(End of CFW list)\n\n", pos) + std::string("(End of CFW list)\n\n").length();  
-        if (endPos != std::string::npos) {
-            content.erase(pos, endPos - pos);  // 删除旧的设备列表部分
-        }
-    }
-
-    // 打开文件进行写入（覆盖模式）
-    std::ofstream outfile(filename, std::ios::out | std::ios::trunc);  // 打开文件以覆盖内容
-    if (!outfile.is_open()) {
-        Logger::Log("saveCFWList | An error occurred while opening the configuration file for writing: " + filename, LogLevel::ERROR, DeviceType::MAIN);
-        return;
-    }
-
-    // 先写入文件的原始内容（去掉 [LastConnectedDevice] 部分）
-    outfile << content;
-
-    // 写入新的 [LastConnectedDevice] 部分
-    outfile << "[CFWList(" + Name.toStdString() +")]\n";
-
-    QByteArray CFWListUtf8 = List.toUtf8();
-
-    // 将 QString 转换为 UTF-8 格式的字符串，并保存
-    outfile << "CFWList=" << CFWListUtf8.constData() << "\n";
-
-    outfile << "(End of CFW list)\n\n";
-
-    outfile.close();
+    configStore().replaceSection("CFWList(" + Name.toStdString() + ")", {{"CFWList", List.toUtf8().toStdString()}});
 }
 
 QString Tools::readCFWList(QString Name)
 {
-    QString CFWList;
-    std::string filename = "config/config.ini"; // INI 配置文件路径
-    std::ifstream infile(filename);
-
-    if (!infile.is_open()) {
-        Logger::Log("readCFWList | Error occurred while opening file for reading: " + filename, LogLevel::ERROR, DeviceType::MAIN);
-        return QString();
-    }
-
-    std::string line;
-    bool inCFWListSection = false;
-    SystemDevice currentDevice;
-    std::map<std::string, std::string> sectionData;
-
-    // 逐行读取 INI 文件
-    while (std::getline(infile, line)) {
-        // 检查是否进入了 [LastConnectedDevice] 部分
-        if (line.find("[CFWList(" + Name.toStdString() +")]") != std::string::npos) {
-            inCFWListSection = true;
-            continue; // 跳过这一行，开始读取数据
-        }
-
-        if (inCFWListSection) {
-            // 遇到下一个部分或空行，停止读取当前部分
-            if (line.empty() || line[0] == '[') {
-                // 这里保存当前设备并重置
-                if (!sectionData.empty()) {
-                    // 用 sectionData 填充当前设备
-                    CFWList = QString::fromStdString(sectionData["CFWList"]);
-                }
-                // 重置
-                sectionData.clear();
+    return QString::fromStdString(configStore().value("CFWList(" + Name.toStdString() + ")", "CFWList"));
+}
 
-                if (!line.empty() && line[0] == '[') {
-                    // 如果遇到新的节，跳出循环
-                    break;
-                }
-            } else {
-                // 解析键值对
-                std::string key, value;
-                std::istringstream lineStream(line);
-                if (std::getline(std::getline(lineStream, key, '='), value)) {
-                    sectionData[key] = value;
-                }
-            }
-        }
+void Tools::flushConfig()
+{
+    std::string error;
+    if (!configStore().flush(&error)) {
+        Logger::Log("flushConfig | Failed to save configuration: " + error, LogLevel::ERROR, DeviceType::MAIN);
     }
-
-    infile.close();
-    return CFWList;
 }
 
 // ---------- Schedule presets (任务计划表预设) ----------
@@ -1424,18 +1082,14 @@ void Tools::saveSchedulePreset(const QString &name, const QString &data)
 
     std::string filename = schedDir + "/" + safeName.toStdString() + ".sched";
 
-    std::ofstream outfile(filename, std::ios::out | std::ios::trunc);
-    if (!outfile.is_open())
+    // 直接将原始调度数据写入文件（与 StagingScheduleData: 后面的部分一致）；先写临时文件再换名，断电不留半个预设
+    std::string error;
+    if (!storage::writeFileAtomic(filename, data.toUtf8().toStdString(), &error))
     {
-        Logger::Log("saveSchedulePreset | Failed to open file for writing: " + filename, LogLevel::ERROR, DeviceType::MAIN);
+        Logger::Log("saveSchedulePreset | Failed to write preset: " + error, LogLevel::ERROR, DeviceType::MAIN);
         return;
     }
 
-    // 直接将原始调度数据写入文件（与 StagingScheduleData: 后面的部分一致）
-    QByteArray utf8 = data.toUtf8();
-    outfile.write(utf8.constData(), utf8.size());
-    outfile.close();
-
     Logger::Log("saveSchedulePreset | Saved schedule preset: " + filename, LogLevel::DEBUG, DeviceType::MAIN);
 }
 
@@ -1532,258 +1186,56 @@ bool Tools::deleteSchedulePreset(const QString &name)
 
 void Tools::saveDSLRsInfo(DSLRsInfo DSLRsInfo)
 {
-  std::string directory = "config";                 // 配置文件夹名
-  std::string filename = directory + "/config.ini"; // 配置文件路径
-
-  // 检查文件夹是否存在，如果不存在就创建
-  if (!std::filesystem::exists(directory))
-  {
-    if (!std::filesystem::create_directory(directory))
-    {
-      Logger::Log("saveDSLRsInfo | An error occurred while creating the configuration folder: " + directory, LogLevel::ERROR, DeviceType::MAIN);
-      return;
-    }
-  }
-
-  // 读取现有配置文件的内容
-  std::ifstream infile(filename);
-  std::stringstream fileContent;
-  std::string line;
-  bool isInDSLRsInfoSection = false;
-
-  // 读取现有文件内容
-  while (std::getline(infile, line))
-  {
-    fileContent << line << "\n";
-    // 如果遇到 [DSLRsInfo] 部分，标记为开始位置
-    if (line == "[DSLRsInfo(" + DSLRsInfo.Name.toStdString() + ")]")
-    {
-      isInDSLRsInfoSection = true;
-    }
-    // 如果已经在 [DSLRsInfo] 部分，直到遇到空行或另一个部分则跳出
-    if (isInDSLRsInfoSection && line.empty())
-    {
-      isInDSLRsInfoSection = false;
-    }
-  }
-  infile.close();
-
-  // 如果文件已经包含了 [DSLRsInfo] 部分，则移除旧的内容
-  std::string content = fileContent.str();
-  size_t pos = content.find("[DSLRsInfo(" + DSLRsInfo.Name.toStdString() + ")]");
-  if (pos != std::string::npos)
-  {
-    size_t endPos = content.find("(End of DSLR Info)\n\n", pos) + std::string("(End of DSLR Info)\n\n").length();
-    if (endPos != std::string::npos)
-    {
-      content.erase(pos, endPos - pos); // 删除旧的设备列表部分
-    }
-  }
-
-  // 打开文件进行写入（覆盖模式）
-  std::ofstream outfile(filename, std::ios::out | std::ios::trunc); // 打开文件以覆盖内容
-  if (!outfile.is_open())
-  {
-    Logger::Log("saveDSLRsInfo | An error occurred while opening the configuration file for writing: " + filename, LogLevel::ERROR, DeviceType::MAIN);
-    return;
-  }
-
-  // 先写入文件的原始内容（去掉 [DSLRsInfo] 部分）
-  outfile << content;
-
-  // 写入新的 [DSLRsInfo] 部分
-  outfile << "[DSLRsInfo(" + DSLRsInfo.Name.toStdString() + ")]\n";
-
-  // 将 QString 转换为 UTF-8 格式的字符串，并保存
-  outfile << "DSLRsSizeX=" << DSLRsInfo.SizeX << "\n";
-  outfile << "DSLRsSizeY=" << DSLRsInfo.SizeY << "\n";
-  outfile << "DSLRsPixelSize=" << DSLRsInfo.PixelSize << "\n";
-
-  outfile << "(End of DSLR Info)\n\n";
-
-  outfile.close();
+  configStore().replaceSection("DSLRsInfo(" + DSLRsInfo.Name.toStdString() + ")",
+                               {{"DSLRsSizeX", std::to_string(DSLRsInfo.SizeX)},
+                                {"DSLRsSizeY", std::to_string(DSLRsInfo.SizeY)},
+                                {"DSLRsPixelSize", QString::number(DSLRsInfo.PixelSize).toStdString()}});
 }
 DSLRsInfo Tools::readDSLRsInfo(QString Name)
 {
   DSLRsInfo DSLRsInfo;
   DSLRsInfo.Name = "";
-  std::string filename = "config/config.ini"; // INI 配置文件路径
-  std::ifstream infile(filename);
-
-  if (!infile.is_open())
+  const std::string section = "DSLRsInfo(" + Name.toStdString() + ")";
+  storage::ConfigStore &store = configStore();
+  if (!store.hasSection(section))
   {
-    Logger::Log("readDSLRsInfo | Error occurred while opening file for reading: " + filename, LogLevel::ERROR, DeviceType::MAIN);
     return DSLRsInfo;
   }
 
-  std::string line;
-  bool inDSLRsInfoSection = false;
-  std::map<std::string, std::string> sectionData;
-
-  // 逐行读取 INI 文件
-  while (std::getline(infile, line))
-  {
-    // 检查是否进入了 [DSLRsInfo] 部分
-    if (line.find("[DSLRsInfo(" + Name.toStdString() + ")]") != std::string::npos)
-    {
-      inDSLRsInfoSection = true;
-      DSLRsInfo.Name = Name;
-      continue; // 跳过这一行，开始读取数据
-    }
-
-    if (inDSLRsInfoSection)
-    {
-      // 遇到下一个部分或空行，停止读取当前部分
-      if (line.empty() || line[0] == '[')
-      {
-        // 这里保存当前设备并重置
-        if (!sectionData.empty())
-        {
-          // 用 sectionData 填充当前设备
-          DSLRsInfo.SizeX = sectionData.count("DSLRsSizeX") ? QString::fromStdString(sectionData["DSLRsSizeX"]).toInt() : 0;
-          DSLRsInfo.SizeY = sectionData.count("DSLRsSizeY") ? QString::fromStdString(sectionData["DSLRsSizeY"]).toInt() : 0;
-          DSLRsInfo.PixelSize = sectionData.count("DSLRsPixelSize") ? QString::fromStdString(sectionData["DSLRsPixelSize"]).toDouble() : 0.0;
-        }
-        // 重置
-        sectionData.clear();
-
-        if (!line.empty() && line[0] == '[')
-        {
-          // 如果遇到新的节，跳出循环
-          break;
-        }
-      }
-      else
-      {
-        // 解析键值对
-        std::string key, value;
-        std::istringstream lineStream(line);
-        if (std::getline(std::getline(lineStream, key, '='), value))
-        {
-          sectionData[key] = value;
-        }
-      }
-    }
-  }
-
-  infile.close();
+  DSLRsInfo.Name = Name;
+  DSLRsInfo.SizeX = store.intValue(section, "DSLRsSizeX", 0);
+  DSLRsInfo.SizeY = store.intValue(section, "DSLRsSizeY", 0);
+  DSLRsInfo.PixelSize = store.doubleValue(section, "DSLRsPixelSize", 0.0);
   return DSLRsInfo;
 }
 
 void Tools::readClientSettings(const std::string& fileName, std::unordered_map<std::string, std::string>& config) {
-    std::ifstream file(fileName);
-    if (!file.is_open()) {
-        Logger::Log("readClientSettings | Error occurred while opening file for reading: " + fileName, LogLevel::ERROR, DeviceType::MAIN);
-        return;
+    // config/config.ini 由 ConfigStore 统一持有；fileName 仅为兼容旧调用保留
+    storage::ConfigStore &store = configStore();
+    if (fileName != store.path()) {
+        Logger::Log("readClientSettings | " + fileName + " is not the configuration store file, reading " + store.path(), LogLevel::WARNING, DeviceType::MAIN);
     }
-
-    std::string line;
-    std::string currentSection;
-
-    while (std::getline(file, line)) {
-        // 去除空白字符
-        line.erase(0, line.find_first_not_of(" \t\n\r"));
-        line.erase(line.find_last_not_of(" \t\n\r") + 1);
-
-        if (line.empty()) continue;  // 跳过空行
-
-        // 处理区块头，找到[ClientSettings]等部分
-        if (line[0] == '[' && line[line.length() - 1] == ']') {
-            currentSection = line.substr(1, line.length() - 2);
-            continue;
-        }
-
-        // 处理[ClientSettings]中的内容
-        if (currentSection == "ClientSettings") {
-            size_t pos = line.find("=");
-            if (pos != std::string::npos) {
-                std::string key = line.substr(0, pos);
-                std::string value = line.substr(pos + 1);
-                // 去除多余的空格
-                key.erase(0, key.find_first_not_of(" \t"));
-                key.erase(key.find_last_not_of(" \t") + 1);
-                value.erase(0, value.find_first_not_of(" \t"));
-                value.erase(value.find_last_not_of(" \t") + 1);
-                config[key] = value;
-            }
-        }
+    for (const auto &pair : store.entries("ClientSettings")) {
+        config[pair.first] = pair.second;
     }
-
-    file.close();
 }
 
 void Tools::saveClientSettings(const std::string& fileName, const std::unordered_map<std::string, std::string>& config) {
-  // 读取文件内容
-  std::ifstream inputFile(fileName);
-  std::stringstream fileContents;
-  fileContents << inputFile.rdbuf();
-  inputFile.close();
-
-  std::string content = fileContents.str();
-  // 确保文件末尾有换行，避免追加时粘连
-  if (!content.empty() && content.back() != '\n') content.push_back('\n');
-
-  const std::string sectionHeader = "[ClientSettings]";
-  // 兼容查找：允许后面有或没有换行
-  size_t sectionPos = content.find(sectionHeader);
-
-  if (sectionPos == std::string::npos)
+  storage::ConfigStore &store = configStore();
+  if (fileName != store.path())
   {
-    // 如果没有找到 [ClientSettings] 部分，则添加段头并写入全部键值
-    content += "\n" + sectionHeader + "\n";
-    for (const auto &pair : config)
-    {
-      content += pair.first + " = " + pair.second + "\n";
-      Logger::Log("addClientSettings | " + pair.first + " = " + pair.second, LogLevel::INFO, DeviceType::MAIN);
-    }
+    Logger::Log("saveClientSettings | " + fileName + " is not the configuration store file, writing " + store.path(), LogLevel::WARNING, DeviceType::MAIN);
   }
-  else
-  {
-    // 找到 [ClientSettings] 部分后，定位到此部分结束的位置
-    // 跳过段头本行
-    size_t headerLineEnd = content.find('\n', sectionPos);
-    if (headerLineEnd == std::string::npos) headerLineEnd = content.size();
-    size_t sectionEnd = content.find("\n[", headerLineEnd);
-    if (sectionEnd == std::string::npos)
-    {
-      sectionEnd = content.size();
-    }
-
-    // 进入 [ClientSettings] 部分并将配置项读取到内存中
-    std::string clientSettingsSection = content.substr(sectionPos, sectionEnd - sectionPos);
-
-    // 更新配置项
-    for (const auto &pair : config)
-    {
-      // 查找是否已有该配置项
-      size_t pos = clientSettingsSection.find(pair.first + " = ");
-      if (pos != std::string::npos)
-      {
-        // 找到了该项，更新其值
-        size_t endPos = clientSettingsSection.find('\n', pos);
-        if (endPos == std::string::npos) endPos = clientSettingsSection.size();
-        clientSettingsSection.replace(pos + pair.first.size() + 3, endPos - pos - pair.first.size() - 3, pair.second);
-        Logger::Log("updateClientSettings | " + pair.first + " = " + pair.second, LogLevel::INFO, DeviceType::MAIN);
-      }
-      else
-      {
-        // 没有找到该项，添加新的配置项
-        if (!clientSettingsSection.empty() && clientSettingsSection.back() != '\n') clientSettingsSection.push_back('\n');
-        clientSettingsSection += pair.first + " = " + pair.second + "\n";
-        Logger::Log("addClientSettings | " + pair.first + " = " + pair.second, LogLevel::INFO, DeviceType::MAIN);
-      }
-    }
 
-    // 替换原来的部分
-    content.replace(sectionPos, sectionEnd - sectionPos, clientSettingsSection);
+  storage::ConfigStore::Entries values;
+  for (const auto &pair : config)
+  {
+    const bool exists = store.contains("ClientSettings", pair.first);
+    Logger::Log(std::string(exists ? "updateClientSettings | " : "addClientSettings | ") + pair.first + " = " + pair.second, LogLevel::INFO, DeviceType::MAIN);
+    values.emplace_back(pair.first, pair.second);
   }
-
-  // 将更新后的内容写回到文件
-  std::ofstream outputFile(fileName);
-  // 最终保证文件末尾换行
-  if (!content.empty() && content.back() != '\n') content.push_back('\n');
-  outputFile << content;
-  outputFile.close();
+  // 只改内存，后台防抖后整文件原子替换
+  store.setValues("ClientSettings", values);
 }
 
 void Tools::clearSystemDeviceListItem(SystemDeviceList &s,int index){
@@ -2073,7 +1525,7 @@ int Tools::readFits(const char* fileName, cv::Mat& image) {
     void* array = nullptr;
 
     // 打开 FITS 文件
-    if (fits_open_file(&fptr, fileName, READONLY, &status)) {
+    if (fits_open_image(&fptr, fileName, READONLY, &status)) {
         return status;
     }
 
@@ -2125,7 +1577,7 @@ QString Tools::getFitsCaptureTime(const char* fileName) {
     char dateObs[30]; // 用于存储拍摄时间字符串
 
     // 打开 FITS 文件
-    if (fits_open_file(&fptr, fileName, READONLY, &status)) {
+    if (fits_open_image(&fptr, fileName, READONLY, &status)) {
         return QString(); // 返回空 QString 以表示错误
     }
 
@@ -2146,7 +1598,7 @@ int Tools::readFits_(const char* fileName, cv::Mat& image) {
     fitsfile *fptr;
     int status = 0;
 
-    fits_open_file(&fptr, fileName, READONLY, &status);
+    fits_open_image(&fptr, fileName, READONLY, &status);
     if (status != 0) {
         fits_report_error(stderr, status);
         return false;
@@ -3434,6 +2886,46 @@ QList<FITSImage::Star> Tools::FindStarsByFocusedCppFromFile(const QString &fileN
   return out;
 }
 
+bool Tools::DetectSolveStarList(const QString &fileName, solver::XyList &out, size_t maxStars)
+{
+  out = solver::XyList();
+  if (maxStars == 0)
+  {
+    bool ok = false;
+    const int envMax = qEnvironmentVariableIntValue("QUARCS_SOLVE_MAX_STARS", &ok);
+    maxStars = (ok && envMax > 0) ? static_cast<size_t>(envMax) : 200;
+  }
+
+  loadFitsResult result = loadFits(fileName);
+  if (!result.success)
+  {
+    Logger::Log("DetectSolveStarList | Error in loading FITS file: " + fileName.toStdString(),
+                LogLevel::WARNING, DeviceType::MAIN);
+    return false;
+  }
+  const FITSImage::Statistic &st = result.imageStats;
+  const int cvType = (st.bytesPerPixel == 2) ? CV_16UC(st.channels) : CV_8UC(st.channels);
+  cv::Mat src(st.height, st.width, cvType, result.imageBuffer);
+  cv::Mat gray;
+  if (st.channels == 1)
+    src.copyTo(gray);
+  else
+    cv::cvtColor(src, gray, cv::COLOR_RGB2GRAY);
+  delete[] result.imageBuffer;
+
+  const std::vector<Tools::FocusedStar> fs = Tools::DetectFocusedStars(gray, 3.5, 3, 200, 3.0, 51, 1.0, false);
+  std::vector<solver::XyStar> stars;
+  stars.reserve(fs.size());
+  for (const auto &s : fs)
+    stars.push_back({s.x, s.y, s.flux});
+  out = solver::prepareXyList(std::move(stars), st.width, st.height, maxStars);
+  Logger::Log("DetectSolveStarList | " + std::to_string(fs.size()) + " detected, " +
+                  std::to_string(out.stars.size()) + " kept for solve, image=" +
+                  std::to_string(st.width) + "x" + std::to_string(st.height),
+              LogLevel::INFO, DeviceType::MAIN);
+  return true;
+}
+
 int Tools::FindStarsCountFromFile(QString fileName, bool AllStars, bool runHFR)
 {
   Q_UNUSED(AllStars);
@@ -5096,46 +4588,20 @@ void Tools::SaveMatToFITS(const cv::Mat& image) {
         gray = image;
     }
 
-    // 根据图像类型动态设置 bitpix 和数据类型
-    int bitpix;
-    int datatype;
-    if (gray.depth() == CV_8U) {
-        bitpix = BYTE_IMG;   // 8 位无符号整型
-        datatype = TBYTE;
-    } else if (gray.depth() == CV_16U) {
-        // 使用 USHORT/TUSHORT，保证输出 FITS 为无符号 16 位
-        bitpix = USHORT_IMG;
-        datatype = TUSHORT;
-    } else {
+    if (gray.depth() != CV_8U && gray.depth() != CV_16U) {
         Logger::Log("不支持的图像位深度！", LogLevel::ERROR, DeviceType::MAIN);
         return;
     }
 
-    // FITS文件要求图像数据是二维的
-    long naxes[2] = {gray.cols, gray.rows};
-
-    // 创建FITS文件，使用 '!' 来覆盖已存在的文件
-    fitsfile* fptr;
-    int status = 0;  // 状态变量必须初始化为0
-    std::string filename = "!/dev/shm/MatToFITS.fits";  // 加 ! 来覆盖文件
-    fits_create_file(&fptr, filename.c_str(), &status);
-    fits_create_img(fptr, bitpix, 2, naxes, &status);
-
-    // 将图像数据写入FITS文件
-    if (gray.depth() == CV_8U) {
-        fits_write_img(fptr, datatype, 1, gray.total(), gray.ptr<uchar>(), &status);
-    } else if (gray.depth() == CV_16U) {
-        fits_write_img(fptr, datatype, 1, gray.total(), gray.ptr<ushort>(), &status);
-    }
-
-    // 关闭FITS文件
-    fits_close_file(fptr, &status);
-
-    if (status) {
-        fits_report_error(stderr, status);  // 输出错误信息
+    // 写入统一走 fits::writeMat（8bit->BYTE_IMG，16bit->USHORT_IMG），调用方随后立即读回，保持同步
+    const std::string filename = "/dev/shm/MatToFITS.fits";
+    fits::WriteResult r;
+    if (!fits::writeMat(gray, filename, fits::HeaderTemplate(), fits::WriteOptions(), &r)) {
+        Logger::Log("保存 FITS 失败: " + r.error, LogLevel::ERROR, DeviceType::MAIN);
     } else {
         Logger::Log("成功保存图像到 " + filename +
-                    " | bitpix=" + std::to_string(bitpix),
+                    " | depth=" + std::to_string(gray.depth()) +
+                    " | totalMs=" + std::to_string(static_cast<int>(r.timing.totalMs)),
                     LogLevel::INFO, DeviceType::MAIN);
     }
 }
@@ -5817,7 +5283,7 @@ bool Tools::isSolveImageFinish() {
 bool Tools::isPlateSolveInProgress() {
   return PlateSolveInProgress;
 }
-bool Tools::PlateSolve(QString filename, int FocalLength, double CameraSize_width, double CameraSize_height, bool USEQHYCCDSDK, int mode, double lastRA, double lastDEC, double searchRadiusDeg, const QString &backendConfigPath, int solveTimeoutMs)
+bool Tools::PlateSolve(QString filename, int FocalLength, double CameraSize_width, double CameraSize_height, bool USEQHYCCDSDK, int mode, double lastRA, double lastDEC, double searchRadiusDeg, const QString &backendConfigPath, int solveTimeoutMs, const solver::XyList *starList)
 {
     // 参数说明：
     // mode: 0=基础模式, 1=包含视场参数, 2=包含视场和位置参数
@@ -5833,6 +5299,8 @@ bool Tools::PlateSolve(QString filename, int FocalLength, double CameraSize_widt
     
     PlateSolveInProgress = true;
     isSolveImageFinished = false;
+    // 上一次对同一路径的解析结果作废（同名文件已被新曝光覆盖）
+    solver::PlateSolveService::instance().forget(filename.toStdString());
 
     MinMaxFOV FOV = calculateFOV(FocalLength, CameraSize_width, CameraSize_height);
 
@@ -5913,6 +5381,41 @@ bool Tools::PlateSolve(QString filename, int FocalLength, double CameraSize_widt
         }
     });
 
+    // 星表足够时只做四边形匹配：常驻服务直接吃星表（不再读图、不重新提取）；
+    // 同时写 <name>.xyls（与原图同名，.wcs 仍落在原位置）供回退的 solve-field 使用；QUARCS_SOLVE_FROM_STARS=0 时忽略星表
+    constexpr size_t kMinSolveStars = 8;
+    QString solveInput = filename;
+    bool solveFromStars = false;
+    if (starList != nullptr && qgetenv("QUARCS_SOLVE_FROM_STARS") == "0")
+        starList = nullptr;
+    if (!USEQHYCCDSDK && starList != nullptr && starList->stars.size() >= kMinSolveStars &&
+        starList->imageWidth > 0 && starList->imageHeight > 0)
+    {
+        const QFileInfo fitsInfo(filename);
+        const QString xylsPath = fitsInfo.dir().filePath(fitsInfo.completeBaseName() + ".xyls");
+        std::string err;
+        if (solver::writeXyList(xylsPath.toStdString(), *starList, &err))
+        {
+            solveFromStars = true;
+            solveInput = xylsPath +
+                         " --width " + QString::number(starList->imageWidth) +
+                         " --height " + QString::number(starList->imageHeight) +
+                         " --x-column X --y-column Y --sort-column FLUX";
+            Logger::Log("PlateSolve: 使用已检测星表解析 stars=" + std::to_string(starList->stars.size()) +
+                            " xyls=" + xylsPath.toStdString(),
+                        LogLevel::INFO, DeviceType::MAIN);
+        }
+        else
+        {
+            Logger::Log("PlateSolve: 写星表失败(" + err + ")，按原图解析", LogLevel::WARNING, DeviceType::MAIN);
+        }
+    }
+    else if (starList != nullptr)
+    {
+        Logger::Log("PlateSolve: 星表星数不足(" + std::to_string(starList->stars.size()) + ")，按原图解析",
+                    LogLevel::INFO, DeviceType::MAIN);
+    }
+
     QString command_qstr;
     if (!USEQHYCCDSDK)
     {
@@ -5962,7 +5465,7 @@ bool Tools::PlateSolve(QString filename, int FocalLength, double CameraSize_widt
             case 1:
                 // 模式1：基础命令 + 新参数 + 视场参数
                 command_qstr =
-                    "solve-field " + filename +
+                    "solve-field " + solveInput +
                     " --overwrite"
                     " --no-plots"
                     " --uniformize 0"
@@ -5983,7 +5486,7 @@ bool Tools::PlateSolve(QString filename, int FocalLength, double CameraSize_widt
                 // --radius 5 表示在指定RA/DEC周围5度半径的圆形区域内搜索
                 // 注意：solve-field的--ra参数接受度制或hh:mm:ss格式，--dec接受度制或[+-]dd:mm:ss格式
                 command_qstr =
-                    "solve-field " + filename +
+                    "solve-field " + solveInput +
                     " --overwrite"
                     " --no-plots"
                     " --uniformize 0"
@@ -6006,7 +5509,7 @@ bool Tools::PlateSolve(QString filename, int FocalLength, double CameraSize_widt
             default:
                 // 模式0：基础命令 + 新参数（不使用视场与位置约束）
                 command_qstr =
-                    "solve-field " + filename +
+                    "solve-field " + solveInput +
                     " --overwrite"
                     " --no-plots"
                     " --uniformize 0"
@@ -6019,6 +5522,44 @@ bool Tools::PlateSolve(QString filename, int FocalLength, double CameraSize_widt
                 Logger::Log("使用模式0解析（默认模式）", LogLevel::INFO, DeviceType::MAIN);
                 break;
         }
+
+        // 常驻求解服务可用时在进程内解析：没有 solve-field 进程启动、FITS 重读与索引冷加载；
+        // 服务读图失败等（Error）才继续走 solve-field
+        solver::PlateSolveService &service = solver::PlateSolveService::instance();
+        if (service.available() && qgetenv("QUARCS_PLATE_SOLVER") != "solve-field")
+        {
+            solver::SolveRequest request;
+            request.imagePath = filename.toStdString();
+            if (solveFromStars)
+                request.stars = *starList;
+            if (actualMode >= 1)
+            {
+                request.scaleLowDeg = MinFOV.toDouble();
+                request.scaleHighDeg = MaxFOV.toDouble();
+            }
+            if (actualMode == 2)
+            {
+                request.usePosition = true;
+                request.raDeg = lastRA;
+                request.decDeg = lastDEC;
+                request.radiusDeg = solveSearchRadiusDeg;
+            }
+            request.indexFiles = indexFilesFromBackendConfig(backendConfigPath);
+            request.timeoutMs = solveTimeoutMs > 0 ? solveTimeoutMs : 10000;
+            request.tag = "mode" + std::to_string(actualMode) + (solveFromStars ? "-stars" : "");
+
+            const solver::SolveResult r = service.solve(request);
+            if (r.status != solver::SolveStatus::Error)
+            {
+                emit instance_->parseInfoEmitted(QString("solve %1 in %2 ms")
+                                                     .arg(solver::solveStatusName(r.status))
+                                                     .arg(r.timing.totalMs, 0, 'f', 0));
+                PlateSolveInProgress = false;
+                isSolveImageFinished = r.solved();
+                return r.solved();
+            }
+            Logger::Log("常驻求解服务不可用(" + r.error + ")，回退到 solve-field", LogLevel::WARNING, DeviceType::MAIN);
+        }
     }
     else
     {
@@ -6062,11 +5603,230 @@ bool Tools::PlateSolve(QString filename, int FocalLength, double CameraSize_widt
 
     return true;
 }
+const solver::StarCatalog *Tools::TrackingCatalog()
+{
+  static const std::unique_ptr<solver::StarCatalog> catalog = []() -> std::unique_ptr<solver::StarCatalog> {
+    QStringList candidates;
+    const QString envPath = QString::fromLocal8Bit(qgetenv("QUARCS_STAR_CATALOG")).trimmed();
+    if (!envPath.isEmpty())
+      candidates << envPath;
+    candidates << QStringLiteral(QUARCS_DATA_DIR "/hip_catalog.csv");
+    for (const QString &path : candidates)
+    {
+      if (!QFileInfo::exists(path))
+        continue;
+      auto c = std::make_unique<solver::StarCatalog>();
+      std::string err;
+      if (c->loadCsv(path.toStdString(), 12.0, &err))
+      {
+        Logger::Log("TrackingCatalog: loaded " + std::to_string(c->size()) + " stars from " + path.toStdString(),
+                    LogLevel::INFO, DeviceType::MAIN);
+        return c;
+      }
+      Logger::Log("TrackingCatalog: " + err, LogLevel::WARNING, DeviceType::MAIN);
+    }
+    Logger::Log("TrackingCatalog: no local catalog, tracking solve anchors on solved frames' own stars",
+                LogLevel::INFO, DeviceType::MAIN);
+    return nullptr;
+  }();
+  return catalog.get();
+}
+
+bool Tools::AnchorTracking(const QString &filename, const solver::XyList &stars, solver::TrackingSession &session)
+{
+  solver::TanWcs wcs;
+  solver::SolveResult cached;
+  std::string err;
+  if (solver::PlateSolveService::instance().lastSolved(filename.toStdString(), &cached))
+  {
+    wcs = cached.wcs;
+  }
+  else
+  {
+    const QFileInfo fitsInfo(filename);
+    const QString wcsPath = fitsInfo.dir().filePath(fitsInfo.completeBaseName() + ".wcs");
+    if (!solver::readWcsFile(wcsPath.toStdString(), &wcs, &err))
+    {
+      session.reset();
+      Logger::Log("AnchorTracking: " + err, LogLevel::WARNING, DeviceType::MAIN);
+      return false;
+    }
+  }
+  if (wcs.imageWidth <= 0 || wcs.imageHeight <= 0)
+  {
+    wcs.imageWidth = stars.imageWidth;
+    wcs.imageHeight = stars.imageHeight;
+  }
+  session.anchor(wcs, stars, TrackingCatalog());
+  Logger::Log("AnchorTracking: anchored on " + filename.toStdString() + " refs=" +
+                  std::to_string(session.referenceCount()) + (session.usingCatalog() ? " (catalog)" : " (own stars)"),
+              LogLevel::INFO, DeviceType::MAIN);
+  return session.hasPrior();
+}
+
+bool Tools::TrackSolve(const QString &filename, const solver::XyList &stars, solver::TrackingSession &session)
+{
+  if (session.needsFullSolve())
+    return false;
+
+  solver::PlateSolveService &service = solver::PlateSolveService::instance();
+  service.forget(filename.toStdString());
+  const solver::TrackingResult r = session.track(stars);
+  if (!r.ok)
+  {
+    Logger::Log("TrackSolve: " + r.error + " after " + std::to_string(r.elapsedMs) + " ms, falling back to full solve",
+                LogLevel::INFO, DeviceType::MAIN);
+    return false;
+  }
+
+  if (!PublishInProcessSolve(filename, r.wcs, r.elapsedMs, "TrackSolve"))
+    return false;
+
+  Logger::Log("TrackSolve: matched " + std::to_string(r.matched) + "/" + std::to_string(r.references) +
+                  " rms=" + std::to_string(r.rmsPx) + "px shift=" + std::to_string(r.shiftPx) +
+                  "px rot=" + std::to_string(r.rotationDeg) + "deg in " + std::to_string(r.elapsedMs) + " ms",
+              LogLevel::INFO, DeviceType::MAIN);
+  emit instance_->parseInfoEmitted(QString("tracking solve in %1 ms").arg(r.elapsedMs, 0, 'f', 1));
+  PlateSolveInProgress = false;
+  isSolveImageFinished = true;
+  return true;
+}
+
+bool Tools::PublishInProcessSolve(const QString &filename, const solver::TanWcs &wcs, double elapsedMs, const char *tag)
+{
+  const QFileInfo fitsInfo(filename);
+  const QString wcsPath = fitsInfo.dir().filePath(fitsInfo.completeBaseName() + ".wcs");
+  std::string err;
+  if (!solver::writeWcsFile(wcsPath.toStdString(), wcs, &err))
+  {
+    Logger::Log(std::string(tag) + ": " + err, LogLevel::WARNING, DeviceType::MAIN);
+    return false;
+  }
+
+  solver::SolveResult result;
+  result.status = solver::SolveStatus::Solved;
+  result.imagePath = filename.toStdString();
+  result.wcsPath = wcsPath.toStdString();
+  result.wcs = wcs;
+  const solver::SkyPoint center = wcs.pixelToSky(0.5 + wcs.imageWidth / 2.0, 0.5 + wcs.imageHeight / 2.0);
+  result.raDeg = center.raDeg;
+  result.decDeg = center.decDeg;
+  result.orientationDeg = wcs.orientationDeg();
+  result.pixelScaleArcsec = wcs.pixelScaleArcsec();
+  result.mirrored = wcs.mirrored();
+  result.timing.solveMs = elapsedMs;
+  result.timing.totalMs = elapsedMs;
+  solver::PlateSolveService::instance().publish(result);
+  return true;
+}
+
+const solver::PoleIndex *Tools::PoleStarIndex()
+{
+  static const std::unique_ptr<solver::PoleIndex> index = []() -> std::unique_ptr<solver::PoleIndex> {
+    QStringList candidates;
+    const QString envPath = QString::fromLocal8Bit(qgetenv("QUARCS_POLE_INDEX")).trimmed();
+    if (!envPath.isEmpty())
+      candidates << envPath;
+    candidates << QStringLiteral(QUARCS_DATA_DIR "/pole_index.bin");
+    for (const QString &path : candidates)
+    {
+      if (!QFileInfo::exists(path))
+        continue;
+      auto idx = std::make_unique<solver::PoleIndex>();
+      std::string err;
+      if (idx->load(path.toStdString(), &err))
+      {
+        Logger::Log("PoleStarIndex: loaded " + std::to_string(idx->starCount()) + " stars / " +
+                        std::to_string(idx->triangleCount()) + " triangles from " + path.toStdString(),
+                    LogLevel::INFO, DeviceType::MAIN);
+        return idx;
+      }
+      Logger::Log("PoleStarIndex: " + err, LogLevel::WARNING, DeviceType::MAIN);
+    }
+    // 没有预建文件：用跟踪星表现场构建（约百毫秒，只做一次）
+    if (const solver::StarCatalog *catalog = TrackingCatalog())
+    {
+      auto idx = std::make_unique<solver::PoleIndex>();
+      if (idx->build(*catalog))
+      {
+        Logger::Log("PoleStarIndex: built " + std::to_string(idx->triangleCount()) + " triangles from tracking catalog",
+                    LogLevel::INFO, DeviceType::MAIN);
+        return idx;
+      }
+    }
+    Logger::Log("PoleStarIndex: no pole index, polar solves go through solve-field", LogLevel::INFO, DeviceType::MAIN);
+    return nullptr;
+  }();
+  return index.get();
+}
+
+bool Tools::PoleIndexSolve(const QString &filename, const solver::XyList &stars, double fovLowDeg, double fovHighDeg, int hemisphere)
+{
+  const solver::PoleIndex *index = PoleStarIndex();
+  if (!index)
+    return false;
+
+  solver::PlateSolveService::instance().forget(filename.toStdString());
+  solver::PoleSolveOptions options;
+  if (fovLowDeg > 0.0 && fovHighDeg >= fovLowDeg)
+  {
+    options.fieldLowDeg = fovLowDeg;
+    options.fieldHighDeg = fovHighDeg;
+  }
+  options.hemisphere = hemisphere;
+  const solver::PoleSolveResult r = index->solve(stars, options);
+  if (!r.ok)
+  {
+    Logger::Log("PoleIndexSolve: " + r.error + " after " + std::to_string(r.elapsedMs) + " ms, falling back to solve-field",
+                LogLevel::INFO, DeviceType::MAIN);
+    return false;
+  }
+  if (!PublishInProcessSolve(filename, r.wcs, r.elapsedMs, "PoleIndexSolve"))
+    return false;
+
+  Logger::Log("PoleIndexSolve: " + std::string(r.hemisphere > 0 ? "north" : "south") + " cap, verified " +
+                  std::to_string(r.verified) + ", matched " + std::to_string(r.matched) + " rms=" +
+                  std::to_string(r.rmsPx) + "px after " + std::to_string(r.hypotheses) + " hypotheses in " +
+                  std::to_string(r.elapsedMs) + " ms",
+              LogLevel::INFO, DeviceType::MAIN);
+  emit instance_->parseInfoEmitted(QString("pole index solve in %1 ms").arg(r.elapsedMs, 0, 'f', 1));
+  PlateSolveInProgress = false;
+  isSolveImageFinished = true;
+  return true;
+}
+
 SloveResults Tools::ReadSolveResult(QString filename, int imageWidth, int imageHeight) {
   isSolveImageFinished = false;
-  sleep(1);
 
   SloveResults result;
+
+  // 常驻求解服务刚解析过这张图：直接用内存里的 WCS，不再等待落盘、不再调用 wcsinfo/wcs-xy2rd
+  solver::SolveResult cached;
+  if (solver::PlateSolveService::instance().lastSolved(filename.toStdString(), &cached))
+  {
+    const solver::TanWcs &wcs = cached.wcs;
+    const double w = wcs.imageWidth;
+    const double h = wcs.imageHeight;
+    // 与 wcs-xy2rd 相同的 1 基像素坐标
+    const solver::SkyPoint c0 = wcs.pixelToSky(0, 0);
+    const solver::SkyPoint c1 = wcs.pixelToSky(w, 0);
+    const solver::SkyPoint c2 = wcs.pixelToSky(w, h);
+    const solver::SkyPoint c3 = wcs.pixelToSky(0, h);
+    result.RA_0 = c0.raDeg; result.DEC_0 = c0.decDeg;
+    result.RA_1 = c1.raDeg; result.DEC_1 = c1.decDeg;
+    result.RA_2 = c2.raDeg; result.DEC_2 = c2.decDeg;
+    result.RA_3 = c3.raDeg; result.DEC_3 = c3.decDeg;
+    result.RA_Degree = cached.raDeg;
+    result.DEC_Degree = cached.decDeg;
+    result.pixelScaleArcsecPerPixel = cached.pixelScaleArcsec;
+    Logger::Log("RA DEC Rotation(degree) " + std::to_string(cached.raDeg) + " " + std::to_string(cached.decDeg) + " " +
+                    std::to_string(cached.orientationDeg) + " (in-process solve)",
+                LogLevel::INFO, DeviceType::MAIN);
+    PlateSolveInProgress = false;
+    return result;
+  }
+
+  sleep(1);
   filename = filename.chopped(5);  // 移除文件名的最后五个字符
 
   QProcess* cmd_test = new QProcess();
@@ -6336,10 +6096,24 @@ std::vector<SphericalCoordinates> Tools::getFOVCorners(const WCSParams& wcs, int
                 std::to_string(wcs.cd12) + "," + std::to_string(wcs.cd21) + 
                 "," + std::to_string(wcs.cd22), LogLevel::INFO, DeviceType::MAIN);
     
-    corners[0] = pixelToRaDec(0, 0, wcs);                  // Bottom-left
-    corners[1] = pixelToRaDec(imageWidth, 0, wcs);         // Bottom-right
-    corners[2] = pixelToRaDec(imageWidth, imageHeight, wcs); // Top-right
-    corners[3] = pixelToRaDec(0, imageHeight, wcs);        // Top-left
+    // 左下、右下、右上、左上，一次批量换算
+    solver::LinearWcs linear;
+    linear.crpix[0] = wcs.crpix0;
+    linear.crpix[1] = wcs.crpix1;
+    linear.crval[0] = wcs.crval0;
+    linear.crval[1] = wcs.crval1;
+    linear.cd[0][0] = wcs.cd11;
+    linear.cd[0][1] = wcs.cd12;
+    linear.cd[1][0] = wcs.cd21;
+    linear.cd[1][1] = wcs.cd22;
+    const double xs[4] = {0.0, static_cast<double>(imageWidth), static_cast<double>(imageWidth), 0.0};
+    const double ys[4] = {0.0, 0.0, static_cast<double>(imageHeight), static_cast<double>(imageHeight)};
+    double ras[4];
+    double decs[4];
+    solver::linearPixelToSky(linear, xs, ys, 4, ras, decs);
+    for (int i = 0; i < 4; i++) {
+        corners[i] = {ras[i], decs[i]};
+    }
     
     // 检查计算出的坐标是否相似
     bool tooSimilar = true;
@@ -1,6 +1,7 @@
 #ifndef TOOLS_HPP
 #define TOOLS_HPP
 
+#include <atomic>
 #include <cstdint>
 #include <cmath>
 #include <QtCore/QtCore>
@@ -29,6 +30,9 @@
 #include "Logger.h"
 
 #include <stellarsolver.h>
+#include "solver/XyList.h"
+#include "solver/TrackingSolver.h"
+#include "solver/PoleIndex.h"
 
 namespace quarcs_cv_compat {
 #if defined(CV_AA)
@@ -355,6 +359,13 @@ class Tools : public QObject {
   static void saveCFWList(QString Name, QString List);
   static QString readCFWList(QString Name);
 
+  /**
+   * @brief 立即把未落盘的配置修改写入 config/config.ini
+   *
+   * 配置读写都在内存中（storage::ConfigStore），修改由后台防抖后整文件原子替换；退出前调用以免丢失最后的修改
+   */
+  static void flushConfig();
+
   // ---------- Schedule presets (任务计划表预设) ----------
   /**
    * @brief 保存任务计划表预设到独立文件
@@ -496,6 +507,12 @@ class Tools : public QObject {
   // 基于当前 ROI 简化识星算法的星点识别（仿照上面两个接口）
   static QList<FITSImage::Star> FindStarsByFocusedCpp(bool AllStars, bool runHFR);
   static QList<FITSImage::Star> FindStarsByFocusedCppFromFile(const QString &fileName, bool AllStars, bool runHFR);
+  /**
+   * @brief 用本地 C++ 合焦识星生成解析星表（按 flux 降序，只保留最亮的 maxStars 个，带图像尺寸）
+   * @param maxStars 0 表示取 QUARCS_SOLVE_MAX_STARS（默认 200）
+   * @return 读图失败返回 false；星数不足由 PlateSolve 判断
+   */
+  static bool DetectSolveStarList(const QString &fileName, solver::XyList &out, size_t maxStars = 0);
   
   /**
    * @brief 从文件路径读取FITS图像并识别星点数量
@@ -525,6 +542,8 @@ class Tools : public QObject {
 
   // 使用新的 findstars.py 脚本计算 avg_top50_snr（用于粗调/精调）
   static bool findSNRByPython_Process(QString filename);
+  // 线程安全版本；cancel 非空且被置位时终止脚本并返回 false
+  static bool findSNRByPython_Process(QString filename, double &snr, const std::atomic_bool *cancel = nullptr);
   static double getLastSNR();
 
   static loadFitsResult loadFits(QString fileName);
@@ -609,13 +628,37 @@ class Tools : public QObject {
   static bool WaitForPlateSolveToComplete();
   static bool isSolveImageFinish();
   static bool isPlateSolveInProgress();
-  static bool PlateSolve(QString filename, int FocalLength,double CameraSize_width,double CameraSize_height, bool USEQHYCCDSDK, int mode = 1, double lastRA = 0.0, double lastDEC = 0.0, double searchRadiusDeg = -1.0, const QString &backendConfigPath = QString(), int solveTimeoutMs = 10000);
+  static bool PlateSolve(QString filename, int FocalLength,double CameraSize_width,double CameraSize_height, bool USEQHYCCDSDK, int mode = 1, double lastRA = 0.0, double lastDEC = 0.0, double searchRadiusDeg = -1.0, const QString &backendConfigPath = QString(), int solveTimeoutMs = 10000, const solver::XyList *starList = nullptr);
   // mode: 0=基础模式, 1=包含视场参数, 2=包含视场和位置参数
   // lastRA: 上次解析的赤经，单位为度 (0-360°)
   // lastDEC: 上次解析的赤纬，单位为度 (-90° to +90°)
   // searchRadiusDeg: 模式2时的搜索半径（度），<=0 表示使用内部默认值
   // backendConfigPath: solve-field --backend-config 文件路径（空表示不限制索引）
+  // starList: 已检测的星表（见 DetectSolveStarList）；星数足够时直接交给常驻求解服务（回退时写成 <name>.xyls 交给 solve-field），
+  //           只做四边形匹配、不再对整幅 FITS 重新读取与提取；为空或星数不足时按原图解析
   // 智能回退: 模式2→1→0, 模式1→0, 根据参数可用性自动选择最优模式
+
+  /**
+   * @brief 近先验跟踪解析：按 session 里的上一帧 WCS 投影本地参考星，与 stars 匹配后最小二乘重拟 WCS
+   * 成功时写 <name>.wcs、登记到解析缓存并置位解析完成标志（之后 ReadSolveResult 照常使用），返回 true；
+   * 失败返回 false，调用方改走 PlateSolve 完整解析
+   */
+  static bool TrackSolve(const QString &filename, const solver::XyList &stars, solver::TrackingSession &session);
+  // 完整解析成功后以该帧 WCS（解析缓存或 <name>.wcs）锚定 session
+  static bool AnchorTracking(const QString &filename, const solver::XyList &stars, solver::TrackingSession &session);
+  // 跟踪解析用的本地星表：QUARCS_STAR_CATALOG 或安装目录（QUARCS_DATA_DIR）下的 hip_catalog.csv，首次调用时加载；没有返回 nullptr
+  static const solver::StarCatalog *TrackingCatalog();
+  /**
+   * @brief 天极区域索引解析：用预建的极冠星型索引（PoleStarIndex）在进程内解析天极附近的画面
+   * fovLowDeg/fovHighDeg 为视场宽边范围（都 <=0 表示未知），hemisphere 1 北、-1 南、0 不限。
+   * 成功时与 TrackSolve 一样写 <name>.wcs、登记到解析缓存并置位解析完成标志，返回 true；
+   * 索引缺失、画面不在极冠内或匹配失败返回 false，调用方改走 PlateSolve
+   */
+  static bool PoleIndexSolve(const QString &filename, const solver::XyList &stars, double fovLowDeg, double fovHighDeg, int hemisphere);
+  // 极冠星型索引：QUARCS_POLE_INDEX 或安装目录（QUARCS_DATA_DIR）下的 pole_index.bin，没有时由 TrackingCatalog 现场构建；都没有返回 nullptr
+  static const solver::PoleIndex *PoleStarIndex();
+  // 进程内解析（跟踪/极区索引）的公共收尾：写 <name>.wcs 并登记到 PlateSolveService
+  static bool PublishInProcessSolve(const QString &filename, const solver::TanWcs &wcs, double elapsedMs, const char *tag);
   static SloveResults ReadSolveResult(QString filename, int imageWidth, int imageHeight);
   static WCSParams extractWCSParams(const QString& wcsInfo);
   static FieldOfView extractFieldOfViewFromWcsInfo(const QString& wcsInfo);
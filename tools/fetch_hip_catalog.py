@@ -0,0 +1,100 @@
+#!/usr/bin/env python3
+"""Download the Hipparcos extract used to build pole_index.bin.
+
+Writes src/polemaster_simulation/hip_catalog.csv (header line, then id,ra,dec,mag
+with ra/dec in degrees ICRS and mag = Hipparcos V) from the VizieR copy of the
+Hipparcos main catalogue (I/239/hip_main). CMake picks the file up through
+QUARCS_HIP_CATALOG, builds pole_index.bin from it and installs both to
+share/quarcs.
+
+By default only the two polar caps are fetched (|dec| >= 90 - cap); the pole
+index itself uses a 15 deg cap, the extra margin keeps the PoleMaster simulator
+fields near the pole covered. Use --cap 90 for the whole sky.
+
+Usage: fetch_hip_catalog.py [--cap 20] [--max-mag 9.5] [--output PATH] [--server HOST]
+"""
+
+from __future__ import annotations
+
+import argparse
+import sys
+import urllib.parse
+import urllib.request
+from pathlib import Path
+
+DEFAULT_OUTPUT = Path(__file__).resolve().parent.parent / "src" / "polemaster_simulation" / "hip_catalog.csv"
+COLUMNS = ("HIP", "RAICRS", "DEICRS", "Vmag")
+
+
+def query_vizier(server: str, constraints: dict[str, str], timeout: float) -> str:
+    params: list[tuple[str, str]] = [("-source", "I/239/hip_main"), ("-out.max", "unlimited")]
+    params += [("-out", c) for c in COLUMNS]
+    params += list(constraints.items())
+    url = f"https://{server}/viz-bin/asu-tsv?" + urllib.parse.urlencode(params)
+    with urllib.request.urlopen(url, timeout=timeout) as resp:
+        return resp.read().decode("utf-8", errors="replace")
+
+
+def parse_tsv(text: str) -> list[tuple[int, float, float, float]]:
+    """VizieR asu-tsv: '#' comments, a column-name line, a unit line, a dashes line, then rows."""
+    lines = [ln for ln in text.splitlines() if ln.strip() and not ln.startswith("#")]
+    if not lines:
+        return []
+    header = [h.strip() for h in lines[0].split("\t")]
+    try:
+        idx = [header.index(c) for c in COLUMNS]
+    except ValueError as exc:
+        raise RuntimeError(f"unexpected VizieR columns: {header}") from exc
+
+    stars: list[tuple[int, float, float, float]] = []
+    for line in lines[1:]:
+        fields = line.split("\t")
+        if len(fields) < len(header) or set(fields[idx[0]].strip()) <= {"-"}:
+            continue  # unit / separator line
+        try:
+            hip = int(fields[idx[0]])
+            ra, dec, mag = (float(fields[i]) for i in idx[1:])
+        except ValueError:
+            continue  # missing astrometry or magnitude
+        stars.append((hip, ra, dec, mag))
+    return stars
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser(description=__doc__.split("\n\n")[0])
+    parser.add_argument("--cap", type=float, default=20.0, help="cap radius around each celestial pole [deg]")
+    parser.add_argument("--max-mag", type=float, default=9.5, help="faintest V magnitude kept")
+    parser.add_argument("--output", type=Path, default=DEFAULT_OUTPUT)
+    parser.add_argument("--server", default="vizier.cds.unistra.fr", help="VizieR mirror host")
+    parser.add_argument("--timeout", type=float, default=120.0)
+    args = parser.parse_args()
+
+    mag = f"<{args.max_mag:g}"
+    if args.cap >= 90.0:
+        queries = [{"Vmag": mag}]
+    else:
+        edge = 90.0 - args.cap
+        queries = [{"DEICRS": f">{edge:g}", "Vmag": mag}, {"DEICRS": f"<{-edge:g}", "Vmag": mag}]
+
+    stars: dict[int, tuple[int, float, float, float]] = {}
+    for constraints in queries:
+        for star in parse_tsv(query_vizier(args.server, constraints, args.timeout)):
+            stars[star[0]] = star
+    if not stars:
+        print("no stars returned by VizieR", file=sys.stderr)
+        return 1
+
+    args.output.parent.mkdir(parents=True, exist_ok=True)
+    tmp = args.output.with_suffix(args.output.suffix + ".part")
+    with tmp.open("w", encoding="ascii") as out:
+        out.write("id,ra,dec,mag\n")
+        for hip in sorted(stars):
+            _, ra, dec, vmag = stars[hip]
+            out.write(f"{hip},{ra:.8f},{dec:.8f},{vmag:.2f}\n")
+    tmp.replace(args.output)
+    print(f"wrote {len(stars)} stars to {args.output}")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())